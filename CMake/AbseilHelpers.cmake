@@ -146,6 +146,48 @@ endfunction()
 
 
 
+#
+# create an abseil benchmark binary
+#
+# parameters
+# TARGET: target name prefix
+# SOURCES: sources files for the benchmark
+# PUBLIC_LIBRARIES: targets and flags for linking phase.
+# PRIVATE_COMPILE_FLAGS: compile flags for the benchmark. Will not be exported.
+#
+# create a target associated to <NAME>_bin
+#
+# benchmarks are only built when the project declares the `benchmark` and
+# `benchmark_main` targets (https://github.com/google/benchmark), and they
+# are not registered with add_test(): run them by hand.
+#
+function(absl_benchmark)
+
+  cmake_parse_arguments(ABSL_BENCHMARK
+    ""
+    "TARGET"
+    "SOURCES;PUBLIC_LIBRARIES;PRIVATE_COMPILE_FLAGS;PUBLIC_INCLUDE_DIRS"
+    ${ARGN}
+  )
+
+
+  if(TARGET benchmark AND TARGET benchmark_main)
+
+    set(_NAME ${ABSL_BENCHMARK_TARGET})
+
+    add_executable(${_NAME}_bin ${ABSL_BENCHMARK_SOURCES})
+
+    target_compile_options(${_NAME}_bin PRIVATE ${ABSL_COMPILE_CXXFLAGS} ${ABSL_BENCHMARK_PRIVATE_COMPILE_FLAGS})
+    target_link_libraries(${_NAME}_bin PUBLIC ${ABSL_BENCHMARK_PUBLIC_LIBRARIES} benchmark_main benchmark ${CMAKE_THREAD_LIBS_INIT})
+    target_include_directories(${_NAME}_bin
+      PUBLIC ${ABSL_COMMON_INCLUDE_DIRS} ${ABSL_BENCHMARK_PUBLIC_INCLUDE_DIRS}
+    )
+  endif(TARGET benchmark AND TARGET benchmark_main)
+
+endfunction()
+
+
+
 
 function(check_target my_target)
 
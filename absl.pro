@@ -22,10 +22,26 @@ HEADERS += absl/algorithm/algorithm.h \
            absl/base/policy_checks.h \
            absl/base/port.h \
            absl/base/thread_annotations.h \
+           absl/container/bit_vector.h \
+           absl/container/btree_map.h \
+           absl/container/btree_set.h \
+           absl/container/circular_buffer.h \
            absl/container/fixed_array.h \
+           absl/container/flat_hash_map.h \
+           absl/container/flat_hash_set.h \
+           absl/container/flat_map.h \
+           absl/container/flat_set.h \
            absl/container/inlined_vector.h \
+           absl/container/node_hash_map.h \
+           absl/container/node_hash_set.h \
+           absl/container/segmented_vector.h \
+           absl/debugging/cpu_profiler.h \
+           absl/debugging/failure_signal_handler.h \
            absl/debugging/leak_check.h \
+           absl/debugging/leak_check_registry.h \
            absl/debugging/stacktrace.h \
+           absl/debugging/symbolize.h \
+           absl/memory/arena.h \
            absl/memory/memory.h \
            absl/meta/type_traits.h \
            absl/numeric/int128.h \
@@ -47,6 +63,7 @@ HEADERS += absl/algorithm/algorithm.h \
            absl/synchronization/mutex.h \
            absl/synchronization/notification.h \
            absl/time/clock.h \
+           absl/time/rolling_window.h \
            absl/time/time.h \
            absl/types/any.h \
            absl/types/bad_any_cast.h \
@@ -55,6 +72,7 @@ HEADERS += absl/algorithm/algorithm.h \
            absl/types/span.h \
            absl/utility/utility.h \
            absl/base/internal/atomic_hook.h \
+           absl/base/internal/bits.h \
            absl/base/internal/cycleclock.h \
            absl/base/internal/endian.h \
            absl/base/internal/exception_safety_testing.h \
@@ -84,9 +102,22 @@ HEADERS += absl/algorithm/algorithm.h \
            absl/base/internal/tsan_mutex_interface.h \
            absl/base/internal/unaligned_access.h \
            absl/base/internal/unscaledcycleclock.h \
+           absl/container/internal/btree.h \
+           absl/container/internal/btree_container.h \
+           absl/container/internal/common.h \
+           absl/container/internal/container_memory.h \
+           absl/container/internal/flat_container.h \
+           absl/container/internal/hash_function_defaults.h \
+           absl/container/internal/node_hash_policy.h \
+           absl/container/internal/raw_hash_map.h \
+           absl/container/internal/raw_hash_set.h \
            absl/container/internal/test_instance_tracker.h \
            absl/debugging/internal/address_is_readable.h \
+           absl/debugging/internal/demangle.h \
            absl/debugging/internal/elf_mem_image.h \
+           absl/debugging/internal/examine_stack.h \
+           absl/debugging/internal/profile_builder.h \
+           absl/debugging/internal/stack_depot.h \
            absl/debugging/internal/stacktrace_aarch64-inl.h \
            absl/debugging/internal/stacktrace_arm-inl.h \
            absl/debugging/internal/stacktrace_config.h \
@@ -95,6 +126,8 @@ HEADERS += absl/algorithm/algorithm.h \
            absl/debugging/internal/stacktrace_unimplemented-inl.h \
            absl/debugging/internal/stacktrace_win32-inl.h \
            absl/debugging/internal/stacktrace_x86-inl.h \
+           absl/debugging/internal/symbolize_elf-inl.h \
+           absl/debugging/internal/symbolize_unimplemented-inl.h \
            absl/debugging/internal/vdso_support.h \
            absl/strings/internal/char_map.h \
            absl/strings/internal/escaping_test_common.h \
@@ -129,13 +162,42 @@ SOURCES += absl/algorithm/algorithm_test.cc \
            absl/base/raw_logging_test.cc \
            absl/base/spinlock_test_common.cc \
            absl/base/throw_delegate_test.cc \
+           absl/container/bit_vector.cc \
+           absl/container/bit_vector_benchmark.cc \
+           absl/container/bit_vector_test.cc \
+           absl/container/btree_test.cc \
+           absl/container/circular_buffer_benchmark.cc \
+           absl/container/circular_buffer_test.cc \
            absl/container/fixed_array_test.cc \
+           absl/container/flat_hash_map_test.cc \
+           absl/container/flat_hash_set_test.cc \
+           absl/container/flat_map_benchmark.cc \
+           absl/container/flat_map_test.cc \
+           absl/container/flat_set_test.cc \
+           absl/container/inlined_vector_benchmark.cc \
            absl/container/inlined_vector_test.cc \
+           absl/container/node_hash_map_test.cc \
+           absl/container/node_hash_set_test.cc \
+           absl/container/segmented_vector_benchmark.cc \
+           absl/container/segmented_vector_test.cc \
+           absl/debugging/cpu_profiler.cc \
+           absl/debugging/cpu_profiler_test.cc \
+           absl/debugging/failure_signal_handler.cc \
+           absl/debugging/failure_signal_handler_test.cc \
            absl/debugging/leak_check.cc \
            absl/debugging/leak_check_disable.cc \
            absl/debugging/leak_check_fail_test.cc \
+           absl/debugging/leak_check_registry.cc \
+           absl/debugging/leak_check_registry_test.cc \
            absl/debugging/leak_check_test.cc \
            absl/debugging/stacktrace.cc \
+           absl/debugging/stacktrace_backtrace_test.cc \
+           absl/debugging/stacktrace_benchmark.cc \
+           absl/debugging/stacktrace_test.cc \
+           absl/debugging/symbolize.cc \
+           absl/debugging/symbolize_test.cc \
+           absl/memory/arena.cc \
+           absl/memory/arena_test.cc \
            absl/memory/memory_test.cc \
            absl/meta/type_traits_test.cc \
            absl/numeric/int128.cc \
@@ -171,12 +233,19 @@ SOURCES += absl/algorithm/algorithm_test.cc \
            absl/synchronization/notification.cc \
            absl/synchronization/notification_test.cc \
            absl/time/clock.cc \
+           absl/time/clock_accuracy_test.cc \
+           absl/time/clock_benchmark.cc \
            absl/time/clock_test.cc \
            absl/time/duration.cc \
+           absl/time/duration_benchmark.cc \
            absl/time/duration_test.cc \
            absl/time/format.cc \
+           absl/time/format_benchmark.cc \
            absl/time/format_test.cc \
+           absl/time/rolling_window.cc \
+           absl/time/rolling_window_test.cc \
            absl/time/time.cc \
+           absl/time/time_benchmark.cc \
            absl/time/time_norm_test.cc \
            absl/time/time_test.cc \
            absl/time/time_zone_test.cc \
@@ -189,6 +258,7 @@ SOURCES += absl/algorithm/algorithm_test.cc \
            absl/types/span_test.cc \
            absl/utility/utility.cc \
            absl/utility/utility_test.cc \
+           absl/base/internal/bits_test.cc \
            absl/base/internal/cycleclock.cc \
            absl/base/internal/endian_test.cc \
            absl/base/internal/exception_safety_testing.cc \
@@ -206,11 +276,22 @@ SOURCES += absl/algorithm/algorithm_test.cc \
            absl/base/internal/thread_identity_test.cc \
            absl/base/internal/throw_delegate.cc \
            absl/base/internal/unscaledcycleclock.cc \
+           absl/container/internal/btree_benchmark.cc \
+           absl/container/internal/raw_hash_set_benchmark.cc \
+           absl/container/internal/raw_hash_set_test.cc \
            absl/container/internal/test_instance_tracker.cc \
            absl/container/internal/test_instance_tracker_test.cc \
            absl/debugging/internal/address_is_readable.cc \
+           absl/debugging/internal/address_is_readable_test.cc \
+           absl/debugging/internal/demangle.cc \
+           absl/debugging/internal/demangle_test.cc \
            absl/debugging/internal/elf_mem_image.cc \
+           absl/debugging/internal/examine_stack.cc \
+           absl/debugging/internal/profile_builder.cc \
+           absl/debugging/internal/stack_depot.cc \
+           absl/debugging/internal/stack_depot_test.cc \
            absl/debugging/internal/vdso_support.cc \
+           absl/debugging/internal/vdso_support_test.cc \
            absl/strings/internal/char_map_test.cc \
            absl/strings/internal/memutil.cc \
            absl/strings/internal/memutil_test.cc \
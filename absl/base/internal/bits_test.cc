@@ -0,0 +1,123 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/base/internal/bits.h"
+
+#include <cstdint>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace absl {
+namespace base_internal {
+namespace {
+
+int CountLeadingZeros64Reference(uint64_t n) {
+  int zeroes = 0;
+  for (uint64_t bit = uint64_t{1} << 63; bit != 0 && (n & bit) == 0;
+       bit >>= 1) {
+    ++zeroes;
+  }
+  return zeroes;
+}
+
+int CountTrailingZeros64Reference(uint64_t n) {
+  int zeroes = 0;
+  for (uint64_t bit = 1; bit != 0 && (n & bit) == 0; bit <<= 1) ++zeroes;
+  return zeroes;
+}
+
+int Popcount64Reference(uint64_t n) {
+  int count = 0;
+  for (; n != 0; n >>= 1) count += n & 1;
+  return count;
+}
+
+TEST(BitsTest, CountLeadingZeros64) {
+  EXPECT_EQ(64, CountLeadingZeros64(0));
+  EXPECT_EQ(64, CountLeadingZeros64Slow(0));
+  EXPECT_EQ(63, CountLeadingZeros64(1));
+  EXPECT_EQ(0, CountLeadingZeros64(~uint64_t{0}));
+  for (int i = 0; i < 64; ++i) {
+    uint64_t n = uint64_t{1} << i;
+    EXPECT_EQ(63 - i, CountLeadingZeros64(n));
+    EXPECT_EQ(63 - i, CountLeadingZeros64Slow(n));
+    EXPECT_EQ(63 - i, CountLeadingZeros64(n | 1));
+  }
+}
+
+TEST(BitsTest, CountLeadingZeros32) {
+  EXPECT_EQ(32, CountLeadingZeros32(0));
+  EXPECT_EQ(32, CountLeadingZeros32Slow(0));
+  for (int i = 0; i < 32; ++i) {
+    uint32_t n = uint32_t{1} << i;
+    EXPECT_EQ(31 - i, CountLeadingZeros32(n));
+    EXPECT_EQ(31 - i, CountLeadingZeros32Slow(n));
+  }
+}
+
+TEST(BitsTest, CountTrailingZerosNonZero) {
+  for (int i = 0; i < 64; ++i) {
+    uint64_t n = uint64_t{1} << i;
+    EXPECT_EQ(i, CountTrailingZerosNonZero64(n));
+    EXPECT_EQ(i, CountTrailingZerosNonZero64Slow(n));
+    EXPECT_EQ(i, CountTrailingZerosNonZero64(n | (n << 1)));
+  }
+  for (int i = 0; i < 32; ++i) {
+    uint32_t n = uint32_t{1} << i;
+    EXPECT_EQ(i, CountTrailingZerosNonZero32(n));
+    EXPECT_EQ(i, CountTrailingZerosNonZero32Slow(n));
+  }
+}
+
+TEST(BitsTest, Popcount) {
+  EXPECT_EQ(0, Popcount64(0));
+  EXPECT_EQ(64, Popcount64(~uint64_t{0}));
+  EXPECT_EQ(64, Popcount64Slow(~uint64_t{0}));
+  EXPECT_EQ(0, Popcount32(0));
+  EXPECT_EQ(32, Popcount32(~uint32_t{0}));
+  EXPECT_EQ(32, Popcount32Slow(~uint32_t{0}));
+}
+
+TEST(BitsTest, MatchesReferenceOnRandomValues) {
+  std::mt19937_64 rng(12345);
+  for (int i = 0; i < 10000; ++i) {
+    // Shift so that leading and trailing zero counts vary.
+    uint64_t n = rng() >> (i % 64);
+    n <<= (i / 64) % 64;
+    EXPECT_EQ(CountLeadingZeros64Reference(n), CountLeadingZeros64(n));
+    EXPECT_EQ(CountLeadingZeros64Reference(n), CountLeadingZeros64Slow(n));
+    EXPECT_EQ(Popcount64Reference(n), Popcount64(n));
+    EXPECT_EQ(Popcount64Reference(n), Popcount64Slow(n));
+    const uint32_t n32 = static_cast<uint32_t>(n);
+    EXPECT_EQ(Popcount64Reference(n32), Popcount32(n32));
+    EXPECT_EQ(Popcount64Reference(n32), Popcount32Slow(n32));
+    if (n != 0) {
+      EXPECT_EQ(CountTrailingZeros64Reference(n),
+                CountTrailingZerosNonZero64(n));
+      EXPECT_EQ(CountTrailingZeros64Reference(n),
+                CountTrailingZerosNonZero64Slow(n));
+    }
+    if (n32 != 0) {
+      EXPECT_EQ(CountTrailingZeros64Reference(n32),
+                CountTrailingZerosNonZero32(n32));
+      EXPECT_EQ(CountLeadingZeros64Reference(n32) - 32,
+                CountLeadingZeros32(n32));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace base_internal
+}  // namespace absl
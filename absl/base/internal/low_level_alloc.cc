@@ -263,6 +263,18 @@ LowLevelAlloc::Arena *UnhookedAsyncSigSafeArena() {
 }
 #endif
 
+// Hooks set with SetRegionHooks().
+std::atomic<LowLevelAlloc::RegionHook> region_map_hook(nullptr);
+std::atomic<LowLevelAlloc::RegionHook> region_unmap_hook(nullptr);
+
+void ReportRegion(const std::atomic<LowLevelAlloc::RegionHook> &hook,
+                  const LowLevelAlloc::Arena *arena, const void *region,
+                  size_t size) {
+  if ((arena->flags & LowLevelAlloc::kReportRegions) == 0) return;
+  LowLevelAlloc::RegionHook fn = hook.load(std::memory_order_acquire);
+  if (fn != nullptr) (*fn)(region, size);
+}
+
 }  // namespace
 
 // Returns the default arena, as used by LowLevelAlloc::Alloc() and friends.
@@ -271,6 +283,11 @@ LowLevelAlloc::Arena *LowLevelAlloc::DefaultArena() {
   return reinterpret_cast<LowLevelAlloc::Arena*>(&default_arena_storage);
 }
 
+void LowLevelAlloc::SetRegionHooks(RegionHook on_map, RegionHook on_unmap) {
+  region_map_hook.store(on_map, std::memory_order_release);
+  region_unmap_hook.store(on_unmap, std::memory_order_release);
+}
+
 // magic numbers to identify allocated and unallocated blocks
 static const uintptr_t kMagicAllocated = 0x4c833e95U;
 static const uintptr_t kMagicUnallocated = ~kMagicAllocated;
@@ -362,6 +379,8 @@ LowLevelAlloc::Arena *LowLevelAlloc::NewArena(int32_t flags) {
   Arena *meta_data_arena = DefaultArena();
 #ifndef ABSL_LOW_LEVEL_ALLOC_ASYNC_SIGNAL_SAFE_MISSING
   if ((flags & LowLevelAlloc::kAsyncSignalSafe) != 0) {
+    ABSL_RAW_CHECK((flags & LowLevelAlloc::kReportRegions) == 0,
+                   "kReportRegions arenas can't be async-signal-safe");
     meta_data_arena = UnhookedAsyncSigSafeArena();
   } else  // NOLINT(readability/braces)
 #endif
@@ -396,6 +415,7 @@ bool LowLevelAlloc::DeleteArena(Arena *arena) {
                    "empty arena has non-page-aligned block size");
     ABSL_RAW_CHECK(reinterpret_cast<uintptr_t>(region) % arena->pagesize == 0,
                    "empty arena has non-page-aligned block");
+    ReportRegion(region_unmap_hook, arena, region, size);
     int munmap_result;
 #ifdef _WIN32
     munmap_result = VirtualFree(region, 0, MEM_RELEASE);
@@ -560,6 +580,7 @@ static void *DoAllocWithArena(size_t request, LowLevelAlloc::Arena *arena) {
         ABSL_RAW_LOG(FATAL, "mmap error: %d", errno);
       }
 #endif
+      ReportRegion(region_map_hook, arena, new_pages, new_pages_size);
       arena->mu.Lock();
       s = reinterpret_cast<AllocList *>(new_pages);
       s->header.size = new_pages_size;
@@ -94,6 +94,11 @@ class LowLevelAlloc {
     // DefaultArena(). Not supported on all platforms.
     kAsyncSignalSafe = 0x0002,
 #endif
+
+    // Report the regions of memory that the arena maps from the system, and
+    // those it returns, to the hooks set with SetRegionHooks(). Not set in
+    // DefaultArena(). May not be combined with kAsyncSignalSafe.
+    kReportRegions = 0x0004,
   };
   // Construct a new arena.  The allocation of the underlying metadata honors
   // the provided flags.  For example, the call NewArena(kAsyncSignalSafe)
@@ -111,6 +116,18 @@ class LowLevelAlloc {
   // The default arena that always exists.
   static Arena *DefaultArena();
 
+  // Sets the functions called with each region, of "size" bytes at "region",
+  // that an arena created with kReportRegions maps from the system
+  // ("on_map") and returns to it ("on_unmap").  Either may be nullptr.
+  // "on_map" is called before any of the region is allocated, without the
+  // arena's lock held; "on_unmap" is called from DeleteArena() with it held.
+  // A returned region may span several mapped ones.  The hooks may allocate
+  // only from arenas without kReportRegions.  They need not be
+  // async-signal-safe, as NewArena() rejects kReportRegions together with
+  // kAsyncSignalSafe.
+  typedef void (*RegionHook)(const void *region, size_t size);
+  static void SetRegionHooks(RegionHook on_map, RegionHook on_unmap);
+
  private:
   LowLevelAlloc();      // no instances
 };
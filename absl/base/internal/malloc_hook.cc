@@ -527,18 +527,12 @@ int MallocHook::GetCallerStackTrace(void** result, int max_depth,
 // of course, to doing what these functions normally do).
 
 // The ABSL_MALLOC_HOOK_MMAP_DISABLE macro disables mmap/munmap interceptors.
-// Dynamic tools that intercept mmap/munmap can't be linked together with
-// malloc_hook interceptors. We disable the malloc_hook interceptors for the
-// widely-used dynamic tools, i.e. ThreadSanitizer and MemorySanitizer, but
-// still allow users to disable this in special cases that can't be easily
-// detected during compilation, via -DABSL_MALLOC_HOOK_MMAP_DISABLE or #define
-// ABSL_MALLOC_HOOK_MMAP_DISABLE.
+// See ABSL_HAVE_MMAP_HOOKS in malloc_hook.h.
 //
 // TODO(absl-team): Remove MALLOC_HOOK_MMAP_DISABLE in CROSSTOOL for tsan and
 // msan config; Replace MALLOC_HOOK_MMAP_DISABLE with
 // ABSL_MALLOC_HOOK_MMAP_DISABLE for other special cases.
-#if !defined(THREAD_SANITIZER) && !defined(MEMORY_SANITIZER) && \
-    !defined(ABSL_MALLOC_HOOK_MMAP_DISABLE) && defined(__linux__)
+#ifdef ABSL_HAVE_MMAP_HOOKS
 #include "absl/base/internal/malloc_hook_mmap_linux.h"
 
 #elif ABSL_HAVE_MMAP
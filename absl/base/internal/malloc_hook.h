@@ -60,6 +60,24 @@
 #include "absl/base/internal/malloc_hook_c.h"
 #include "absl/base/port.h"
 
+// ABSL_HAVE_MMAP_HOOKS
+//
+// Defined when this library interposes mmap(), munmap() and mremap(), so that
+// calls made through them invoke the (Pre)Mmap, Munmap and Mremap hooks.
+//
+// Dynamic tools that intercept mmap/munmap can't be linked together with
+// malloc_hook interceptors. We disable the malloc_hook interceptors for the
+// widely-used dynamic tools, i.e. ThreadSanitizer and MemorySanitizer, but
+// still allow users to disable this in special cases that can't be easily
+// detected during compilation, via -DABSL_MALLOC_HOOK_MMAP_DISABLE or #define
+// ABSL_MALLOC_HOOK_MMAP_DISABLE.
+#ifdef ABSL_HAVE_MMAP_HOOKS
+#error ABSL_HAVE_MMAP_HOOKS cannot be directly set
+#elif !defined(THREAD_SANITIZER) && !defined(MEMORY_SANITIZER) && \
+    !defined(ABSL_MALLOC_HOOK_MMAP_DISABLE) && defined(__linux__)
+#define ABSL_HAVE_MMAP_HOOKS 1
+#endif
+
 namespace absl {
 namespace base_internal {
 
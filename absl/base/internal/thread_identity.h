@@ -128,7 +128,7 @@ struct PerThreadSynch {
   // Mutex waiter list.
   bool cond_waiter;
 
-  // Locks held; used during deadlock detection.
+  // Locks held; used during deadlock detection and held-lock tracking.
   // Allocated in Synch_GetAllLocks() and freed in ReclaimThreadIdentity().
   SynchLocksHeld *all_locks;
 };
@@ -0,0 +1,232 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/bit_vector.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+namespace absl {
+namespace {
+
+// Word kernels
+//
+// Each kernel handles four words at a time: as one 256-bit vector when
+// compiled for AVX2, and otherwise as four independent scalar operations that
+// the compiler can schedule in parallel or vectorize itself.
+
+struct AndOp {
+  static uint64_t Apply(uint64_t a, uint64_t b) { return a & b; }
+#ifdef __AVX2__
+  static __m256i Apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+};
+
+struct OrOp {
+  static uint64_t Apply(uint64_t a, uint64_t b) { return a | b; }
+#ifdef __AVX2__
+  static __m256i Apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+};
+
+struct XorOp {
+  static uint64_t Apply(uint64_t a, uint64_t b) { return a ^ b; }
+#ifdef __AVX2__
+  static __m256i Apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+};
+
+struct AndNotOp {
+  static uint64_t Apply(uint64_t a, uint64_t b) { return a & ~b; }
+#ifdef __AVX2__
+  // Note the order: _mm256_andnot_si256(x, y) computes ~x & y.
+  static __m256i Apply(__m256i a, __m256i b) {
+    return _mm256_andnot_si256(b, a);
+  }
+#endif
+};
+
+// Sets dst[i] = Op(dst[i], src[i]) for i < n.
+template <typename Op>
+void CombineWords(uint64_t* dst, const uint64_t* src, size_t n) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 4 <= n; i += 4) {
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    const __m256i* s = reinterpret_cast<const __m256i*>(src + i);
+    _mm256_storeu_si256(
+        d, Op::Apply(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+  }
+#else
+  for (; i + 4 <= n; i += 4) {
+    dst[i] = Op::Apply(dst[i], src[i]);
+    dst[i + 1] = Op::Apply(dst[i + 1], src[i + 1]);
+    dst[i + 2] = Op::Apply(dst[i + 2], src[i + 2]);
+    dst[i + 3] = Op::Apply(dst[i + 3], src[i + 3]);
+  }
+#endif
+  for (; i < n; ++i) dst[i] = Op::Apply(dst[i], src[i]);
+}
+
+// Returns the number of set bits in words[0, n).
+size_t PopcountWords(const uint64_t* words, size_t n) {
+  size_t i = 0;
+  uint64_t total = 0;
+#ifdef __AVX2__
+  // Counts the bits of each nibble with a table lookup, then sums the bytes of
+  // each 64-bit lane. See Mula, Kurz and Lemire, "Faster Population Counts
+  // Using AVX2 Instructions".
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,  //
+                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                           _mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc,
+                           _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  total += static_cast<uint64_t>(_mm256_extract_epi64(acc, 0)) +
+           static_cast<uint64_t>(_mm256_extract_epi64(acc, 1)) +
+           static_cast<uint64_t>(_mm256_extract_epi64(acc, 2)) +
+           static_cast<uint64_t>(_mm256_extract_epi64(acc, 3));
+#else
+  uint64_t t1 = 0, t2 = 0, t3 = 0;
+  for (; i + 4 <= n; i += 4) {
+    total += base_internal::Popcount64(words[i]);
+    t1 += base_internal::Popcount64(words[i + 1]);
+    t2 += base_internal::Popcount64(words[i + 2]);
+    t3 += base_internal::Popcount64(words[i + 3]);
+  }
+  total += t1 + t2 + t3;
+#endif
+  for (; i < n; ++i) total += base_internal::Popcount64(words[i]);
+  return total;
+}
+
+// Returns the position of the set bit with rank `k` in `word`.
+// REQUIRES: k < Popcount64(word)
+int SelectInWord(uint64_t word, size_t k) {
+#ifdef __BMI2__
+  return base_internal::CountTrailingZerosNonZero64(
+      _pdep_u64(uint64_t{1} << k, word));
+#else
+  for (; k > 0; --k) word &= word - 1;
+  return base_internal::CountTrailingZerosNonZero64(word);
+#endif
+}
+
+}  // namespace
+
+constexpr BitVector::size_type BitVector::kWordBits;
+
+BitVector::BitVector(size_type n, bool value)
+    : words_(NumWords(n), value ? ~uint64_t{0} : 0), size_(n) {
+  ClearUnusedBits();
+}
+
+void BitVector::set() {
+  std::fill(words_.begin(), words_.end(), ~uint64_t{0});
+  ClearUnusedBits();
+}
+
+void BitVector::flip() {
+  for (uint64_t& word : words_) word = ~word;
+  ClearUnusedBits();
+}
+
+void BitVector::resize(size_type n, bool value) {
+  const size_type old_size = size_;
+  words_.resize(NumWords(n), value ? ~uint64_t{0} : 0);
+  size_ = n;
+  if (value && n > old_size && old_size % kWordBits != 0) {
+    // The rest of the last old word, which is zero.
+    words_[old_size / kWordBits] |= ~uint64_t{0} << (old_size % kWordBits);
+  }
+  ClearUnusedBits();
+}
+
+BitVector::size_type BitVector::count() const {
+  return PopcountWords(words_.data(), words_.size());
+}
+
+bool BitVector::any() const {
+  return std::any_of(words_.begin(), words_.end(),
+                     [](uint64_t word) { return word != 0; });
+}
+
+BitVector& BitVector::operator&=(const BitVector& other) {
+  assert(size_ == other.size_);
+  CombineWords<AndOp>(words_.data(), other.words_.data(), words_.size());
+  return *this;
+}
+
+BitVector& BitVector::operator|=(const BitVector& other) {
+  assert(size_ == other.size_);
+  CombineWords<OrOp>(words_.data(), other.words_.data(), words_.size());
+  return *this;
+}
+
+BitVector& BitVector::operator^=(const BitVector& other) {
+  assert(size_ == other.size_);
+  CombineWords<XorOp>(words_.data(), other.words_.data(), words_.size());
+  return *this;
+}
+
+BitVector& BitVector::and_not(const BitVector& other) {
+  assert(size_ == other.size_);
+  CombineWords<AndNotOp>(words_.data(), other.words_.data(), words_.size());
+  return *this;
+}
+
+constexpr RankSelect::size_type RankSelect::kBlockWords;
+
+RankSelect::RankSelect(const BitVector& bits) : bits_(&bits) {
+  absl::Span<const uint64_t> words = bits.words();
+  const size_type num_blocks = (words.size() + kBlockWords - 1) / kBlockWords;
+  block_ranks_.reserve(num_blocks + 1);
+  size_type r = 0;
+  for (size_type b = 0; b < num_blocks; ++b) {
+    block_ranks_.push_back(r);
+    const size_type begin = b * kBlockWords;
+    r += PopcountWords(words.data() + begin,
+                       std::min(kBlockWords, words.size() - begin));
+  }
+  block_ranks_.push_back(r);
+}
+
+RankSelect::size_type RankSelect::select(size_type k) const {
+  assert(k < num_set());
+  // The last block whose rank is at most k.
+  const size_type b =
+      std::upper_bound(block_ranks_.begin(), block_ranks_.end(), k) -
+      block_ranks_.begin() - 1;
+  k -= block_ranks_[b];
+  absl::Span<const uint64_t> words = bits_->words();
+  for (size_type w = b * kBlockWords;; ++w) {
+    const size_type c = base_internal::Popcount64(words[w]);
+    if (k < c) return w * BitVector::kWordBits + SelectInWord(words[w], k);
+    k -= c;
+  }
+}
+
+}  // namespace absl
@@ -0,0 +1,311 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: bit_vector.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::BitVector` is a resizable sequence of bits packed into 64-bit
+// words, for dense sets of small integers such as row or document IDs. Unlike
+// `std::vector<bool>`, it works a word at a time wherever it can: the bulk
+// operations (`&=`, `|=`, `^=`, `and_not()`) and `count()` process whole words,
+// with AVX2 kernels when the library is compiled for AVX2, and
+// `find_next_set()` and `for_each_set()` skip zero words and jump to set bits
+// with a count-trailing-zeros instruction:
+//
+//   absl::BitVector matches(num_rows);
+//   ...
+//   matches &= other_filter;
+//   matches.for_each_set([&](size_t row) { Emit(row); });
+//
+// An `absl::RankSelect` is a read-only index over a `BitVector` that answers
+// rank queries (how many bits are set before a position) in constant time and
+// select queries (where is the kth set bit) in logarithmic time, for a space
+// overhead of one eighth of the bit vector.
+
+#ifndef ABSL_CONTAINER_BIT_VECTOR_H_
+#define ABSL_CONTAINER_BIT_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/internal/bits.h"
+#include "absl/types/span.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// BitVector
+// -----------------------------------------------------------------------------
+//
+// Bits past `size()` in the last word are always zero, so that whole-word
+// operations need no masking.
+class BitVector {
+ public:
+  using size_type = size_t;
+
+  static constexpr size_type kWordBits = 64;
+
+  BitVector() = default;
+
+  // Creates a vector of `n` bits, all equal to `value`.
+  explicit BitVector(size_type n, bool value = false);
+
+  // BitVector::size()
+  //
+  // Returns the number of bits.
+  size_type size() const { return size_; }
+
+  // BitVector::empty()
+  //
+  // Returns whether the vector has no bits.
+  bool empty() const { return size_ == 0; }
+
+  // BitVector::test()
+  //
+  // Returns the `i`th bit.
+  // REQUIRES: i < size()
+  bool test(size_type i) const {
+    assert(i < size_);
+    return (words_[i / kWordBits] & Bit(i)) != 0;
+  }
+
+  bool operator[](size_type i) const { return test(i); }
+
+  // BitVector::set()
+  //
+  // Sets the `i`th bit, or to `value`. Without arguments, sets all bits.
+  // REQUIRES: i < size()
+  void set(size_type i) {
+    assert(i < size_);
+    words_[i / kWordBits] |= Bit(i);
+  }
+
+  void set(size_type i, bool value) {
+    if (value) {
+      set(i);
+    } else {
+      reset(i);
+    }
+  }
+
+  void set();
+
+  // BitVector::reset()
+  //
+  // Clears the `i`th bit. Without arguments, clears all bits.
+  // REQUIRES: i < size()
+  void reset(size_type i) {
+    assert(i < size_);
+    words_[i / kWordBits] &= ~Bit(i);
+  }
+
+  void reset() { std::fill(words_.begin(), words_.end(), 0); }
+
+  // BitVector::flip()
+  //
+  // Flips the `i`th bit. Without arguments, flips all bits.
+  // REQUIRES: i < size()
+  void flip(size_type i) {
+    assert(i < size_);
+    words_[i / kWordBits] ^= Bit(i);
+  }
+
+  void flip();
+
+  // BitVector::push_back()
+  //
+  // Appends a bit.
+  void push_back(bool value) {
+    if (size_ % kWordBits == 0) words_.push_back(0);
+    ++size_;
+    if (value) set(size_ - 1);
+  }
+
+  // BitVector::resize()
+  //
+  // Resizes the vector to `n` bits. New bits are equal to `value`.
+  void resize(size_type n, bool value = false);
+
+  // BitVector::reserve()
+  //
+  // Allocates room for `n` bits.
+  void reserve(size_type n) { words_.reserve(NumWords(n)); }
+
+  // BitVector::clear()
+  //
+  // Removes all bits.
+  void clear() {
+    words_.clear();
+    size_ = 0;
+  }
+
+  // BitVector::count()
+  //
+  // Returns the number of set bits.
+  size_type count() const;
+
+  // BitVector::any()
+  //
+  // Returns whether any bit is set.
+  bool any() const;
+
+  // BitVector::none()
+  //
+  // Returns whether no bit is set.
+  bool none() const { return !any(); }
+
+  // BitVector::all()
+  //
+  // Returns whether all bits are set.
+  bool all() const { return count() == size_; }
+
+  // BitVector::find_next_set()
+  //
+  // Returns the position of the first set bit at or after `pos`, or `size()`
+  // if there is none.
+  size_type find_next_set(size_type pos = 0) const {
+    if (pos >= size_) return size_;
+    size_type w = pos / kWordBits;
+    uint64_t word = words_[w] & (~uint64_t{0} << (pos % kWordBits));
+    while (word == 0) {
+      if (++w == words_.size()) return size_;
+      word = words_[w];
+    }
+    return w * kWordBits + base_internal::CountTrailingZerosNonZero64(word);
+  }
+
+  // BitVector::for_each_set()
+  //
+  // Calls `f(i)` for the position `i` of each set bit, in increasing order.
+  template <typename F>
+  void for_each_set(F f) const {
+    for (size_type w = 0; w < words_.size(); ++w) {
+      for (uint64_t word = words_[w]; word != 0; word &= word - 1) {
+        f(w * kWordBits + base_internal::CountTrailingZerosNonZero64(word));
+      }
+    }
+  }
+
+  // Bulk operations
+  //
+  // Combine the bits of two vectors of the same size, a word at a time.
+  // `and_not()` clears the bits that are set in `other`.
+  BitVector& operator&=(const BitVector& other);
+  BitVector& operator|=(const BitVector& other);
+  BitVector& operator^=(const BitVector& other);
+  BitVector& and_not(const BitVector& other);
+
+  friend BitVector operator&(BitVector a, const BitVector& b) {
+    return a &= b;
+  }
+  friend BitVector operator|(BitVector a, const BitVector& b) {
+    return a |= b;
+  }
+  friend BitVector operator^(BitVector a, const BitVector& b) {
+    return a ^= b;
+  }
+
+  // BitVector::words()
+  //
+  // Returns the bits as 64-bit words, bit `i` being bit `i % 64` of word
+  // `i / 64`.
+  absl::Span<const uint64_t> words() const { return words_; }
+
+  friend bool operator==(const BitVector& a, const BitVector& b) {
+    return a.size_ == b.size_ && a.words_ == b.words_;
+  }
+  friend bool operator!=(const BitVector& a, const BitVector& b) {
+    return !(a == b);
+  }
+
+ private:
+  static uint64_t Bit(size_type i) { return uint64_t{1} << (i % kWordBits); }
+  static size_type NumWords(size_type n) {
+    return (n + kWordBits - 1) / kWordBits;
+  }
+
+  // Restores the invariant that bits past `size()` are zero.
+  void ClearUnusedBits() {
+    if (size_ % kWordBits != 0) {
+      words_.back() &= ~(~uint64_t{0} << (size_ % kWordBits));
+    }
+  }
+
+  std::vector<uint64_t> words_;
+  size_type size_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// RankSelect
+// -----------------------------------------------------------------------------
+//
+// A rank/select index over a `BitVector`, which must outlive the index and
+// must not change while it is used.
+//
+// The index stores the number of set bits before each block of 512 bits.
+// `rank()` adds to that the set bits of at most eight words. `select()`
+// binary searches the blocks and then scans one of them.
+class RankSelect {
+ public:
+  using size_type = BitVector::size_type;
+
+  explicit RankSelect(const BitVector& bits);
+
+  // RankSelect::rank()
+  //
+  // Returns the number of set bits before position `pos`.
+  // REQUIRES: pos <= bits.size()
+  size_type rank(size_type pos) const {
+    assert(pos <= bits_->size());
+    absl::Span<const uint64_t> words = bits_->words();
+    const size_type w = pos / BitVector::kWordBits;
+    size_type r = block_ranks_[w / kBlockWords];
+    for (size_type i = w - w % kBlockWords; i < w; ++i) {
+      r += base_internal::Popcount64(words[i]);
+    }
+    if (pos % BitVector::kWordBits != 0) {
+      r += base_internal::Popcount64(
+          words[w] & ~(~uint64_t{0} << (pos % BitVector::kWordBits)));
+    }
+    return r;
+  }
+
+  // RankSelect::select()
+  //
+  // Returns the position of the set bit with rank `k`, that is, the `k + 1`th
+  // set bit.
+  // REQUIRES: k < num_set()
+  size_type select(size_type k) const;
+
+  // RankSelect::num_set()
+  //
+  // Returns the number of set bits.
+  size_type num_set() const { return block_ranks_.back(); }
+
+ private:
+  static constexpr size_type kBlockWords = 8;
+
+  const BitVector* bits_;
+  // block_ranks_[b] is the number of set bits before block `b`. The last entry
+  // is the total.
+  std::vector<size_type> block_ranks_;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_BIT_VECTOR_H_
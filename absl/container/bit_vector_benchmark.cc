@@ -0,0 +1,117 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/container/bit_vector.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+std::vector<bool> RandomBits(size_t n, double density, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution bit(density);
+  std::vector<bool> bits(n);
+  for (size_t i = 0; i < n; ++i) bits[i] = bit(rng);
+  return bits;
+}
+
+absl::BitVector ToBitVector(const std::vector<bool>& bits) {
+  absl::BitVector v;
+  for (bool b : bits) v.push_back(b);
+  return v;
+}
+
+void BM_VectorBoolAnd(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<bool> a = RandomBits(n, 0.5, 1);
+  const std::vector<bool> b = RandomBits(n, 0.5, 2);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) a[i] = a[i] && b[i];
+    benchmark::DoNotOptimize(a);
+  }
+}
+BENCHMARK(BM_VectorBoolAnd)->Arg(1 << 16);
+
+void BM_BitVectorAnd(benchmark::State& state) {
+  const size_t n = state.range(0);
+  absl::BitVector a = ToBitVector(RandomBits(n, 0.5, 1));
+  const absl::BitVector b = ToBitVector(RandomBits(n, 0.5, 2));
+  for (auto _ : state) {
+    a &= b;
+    benchmark::DoNotOptimize(a);
+  }
+}
+BENCHMARK(BM_BitVectorAnd)->Arg(1 << 16);
+
+void BM_VectorBoolCount(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const std::vector<bool> a = RandomBits(n, 0.5, 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::count(a.begin(), a.end(), true));
+  }
+}
+BENCHMARK(BM_VectorBoolCount)->Arg(1 << 16);
+
+void BM_BitVectorCount(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const absl::BitVector a = ToBitVector(RandomBits(n, 0.5, 1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.count());
+  }
+}
+BENCHMARK(BM_BitVectorCount)->Arg(1 << 16);
+
+// Visits the set bits of a sparse vector.
+void BM_VectorBoolIterate(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const std::vector<bool> a = RandomBits(n, 0.01, 1);
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (a[i]) sum += i;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_VectorBoolIterate)->Arg(1 << 16);
+
+void BM_BitVectorIterate(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const absl::BitVector a = ToBitVector(RandomBits(n, 0.01, 1));
+  for (auto _ : state) {
+    size_t sum = 0;
+    a.for_each_set([&](size_t i) { sum += i; });
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_BitVectorIterate)->Arg(1 << 16);
+
+void BM_RankSelectSelect(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const absl::BitVector a = ToBitVector(RandomBits(n, 0.5, 1));
+  const absl::RankSelect index(a);
+  const size_t num_set = index.num_set();
+  size_t k = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.select(k));
+    k = (k + 7919) % num_set;
+  }
+}
+BENCHMARK(BM_RankSelectSelect)->Arg(1 << 20);
+
+}  // namespace
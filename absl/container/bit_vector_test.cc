@@ -0,0 +1,197 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/bit_vector.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<bool> RandomBits(size_t n, double density, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::bernoulli_distribution bit(density);
+  std::vector<bool> bits(n);
+  for (size_t i = 0; i < n; ++i) bits[i] = bit(rng);
+  return bits;
+}
+
+absl::BitVector ToBitVector(const std::vector<bool>& bits) {
+  absl::BitVector v;
+  for (bool b : bits) v.push_back(b);
+  return v;
+}
+
+std::vector<size_t> SetPositions(const absl::BitVector& v) {
+  std::vector<size_t> positions;
+  v.for_each_set([&](size_t i) { positions.push_back(i); });
+  return positions;
+}
+
+TEST(BitVectorTest, SetTestResetFlip) {
+  absl::BitVector v(130);
+  EXPECT_EQ(v.size(), 130u);
+  EXPECT_TRUE(v.none());
+  v.set(0);
+  v.set(64);
+  v.set(129);
+  EXPECT_TRUE(v.test(0));
+  EXPECT_TRUE(v[64]);
+  EXPECT_FALSE(v[63]);
+  EXPECT_EQ(v.count(), 3u);
+  v.reset(64);
+  v.flip(1);
+  v.set(2, true);
+  v.set(0, false);
+  EXPECT_THAT(SetPositions(v), ElementsAre(1, 2, 129));
+}
+
+TEST(BitVectorTest, WholeVectorOperationsKeepUnusedBitsClear) {
+  absl::BitVector v(70, true);
+  EXPECT_EQ(v.count(), 70u);
+  EXPECT_TRUE(v.all());
+  EXPECT_EQ(v.words()[1], (uint64_t{1} << 6) - 1);
+
+  v.flip();
+  EXPECT_TRUE(v.none());
+  EXPECT_EQ(v.words()[1], 0u);
+
+  v.set();
+  EXPECT_EQ(v.count(), 70u);
+  v.reset();
+  EXPECT_TRUE(v.none());
+}
+
+TEST(BitVectorTest, Resize) {
+  absl::BitVector v(3, true);
+  v.resize(100, false);
+  EXPECT_EQ(v.count(), 3u);
+  v.resize(200, true);
+  EXPECT_EQ(v.count(), 103u);
+  EXPECT_FALSE(v[99]);
+  EXPECT_TRUE(v[100]);
+  EXPECT_TRUE(v[199]);
+  v.resize(101);
+  EXPECT_EQ(v.count(), 4u);
+  v.resize(110);
+  EXPECT_EQ(v.count(), 4u);
+  v.clear();
+  EXPECT_TRUE(v.empty());
+}
+
+TEST(BitVectorTest, PushBackMatchesVectorOfBool) {
+  const std::vector<bool> bits = RandomBits(1000, 0.3, 1);
+  const absl::BitVector v = ToBitVector(bits);
+  ASSERT_EQ(v.size(), bits.size());
+  size_t count = 0;
+  for (size_t i = 0; i < bits.size(); ++i) {
+    EXPECT_EQ(v[i], bits[i]) << i;
+    count += bits[i];
+  }
+  EXPECT_EQ(v.count(), count);
+}
+
+TEST(BitVectorTest, FindNextSet) {
+  absl::BitVector v(300);
+  EXPECT_EQ(v.find_next_set(), 300u);
+  v.set(5);
+  v.set(64);
+  v.set(299);
+  EXPECT_EQ(v.find_next_set(), 5u);
+  EXPECT_EQ(v.find_next_set(5), 5u);
+  EXPECT_EQ(v.find_next_set(6), 64u);
+  EXPECT_EQ(v.find_next_set(65), 299u);
+  EXPECT_EQ(v.find_next_set(300), 300u);
+  EXPECT_EQ(v.find_next_set(1000), 300u);
+
+  std::vector<size_t> positions;
+  for (size_t i = v.find_next_set(); i < v.size(); i = v.find_next_set(i + 1)) {
+    positions.push_back(i);
+  }
+  EXPECT_THAT(positions, ElementsAre(5, 64, 299));
+  EXPECT_EQ(SetPositions(v), positions);
+}
+
+TEST(BitVectorTest, BulkOperations) {
+  for (size_t n : {0, 1, 63, 64, 65, 255, 256, 1000}) {
+    const std::vector<bool> a = RandomBits(n, 0.5, 2);
+    const std::vector<bool> b = RandomBits(n, 0.5, 3);
+    const absl::BitVector va = ToBitVector(a);
+    const absl::BitVector vb = ToBitVector(b);
+    absl::BitVector and_not = va;
+    and_not.and_not(vb);
+    const absl::BitVector ands = va & vb;
+    const absl::BitVector ors = va | vb;
+    const absl::BitVector xors = va ^ vb;
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(ands[i], a[i] && b[i]);
+      EXPECT_EQ(ors[i], a[i] || b[i]);
+      EXPECT_EQ(xors[i], a[i] != b[i]);
+      EXPECT_EQ(and_not[i], a[i] && !b[i]);
+    }
+    EXPECT_EQ(ands.count() + xors.count(), ors.count());
+  }
+}
+
+TEST(BitVectorTest, Equality) {
+  absl::BitVector a(10), b(10), c(11);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  b.set(3);
+  EXPECT_NE(a, b);
+  a.set(3);
+  EXPECT_EQ(a, b);
+}
+
+TEST(RankSelectTest, Empty) {
+  absl::BitVector v;
+  absl::RankSelect index(v);
+  EXPECT_EQ(index.num_set(), 0u);
+  EXPECT_EQ(index.rank(0), 0u);
+}
+
+TEST(RankSelectTest, MatchesNaiveRankAndSelect) {
+  for (double density : {0.001, 0.1, 0.5, 0.99}) {
+    for (size_t n : {1, 64, 511, 512, 513, 5000}) {
+      const absl::BitVector v = ToBitVector(RandomBits(n, density, 4));
+      const absl::RankSelect index(v);
+      size_t rank = 0;
+      for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(index.rank(i), rank);
+        if (v[i]) {
+          EXPECT_EQ(index.select(rank), i);
+          ++rank;
+        }
+      }
+      EXPECT_EQ(index.rank(n), rank);
+      EXPECT_EQ(index.num_set(), v.count());
+    }
+  }
+}
+
+TEST(RankSelectTest, AllSet) {
+  const absl::BitVector v(2000, true);
+  const absl::RankSelect index(v);
+  EXPECT_EQ(index.num_set(), 2000u);
+  EXPECT_EQ(index.rank(1234), 1234u);
+  EXPECT_EQ(index.select(1999), 1999u);
+}
+
+}  // namespace
@@ -0,0 +1,78 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: btree_map.h
+// -----------------------------------------------------------------------------
+//
+// `absl::btree_map<K, V>` and `absl::btree_multimap<K, V>` are ordered
+// containers with the interfaces of `std::map` and `std::multimap`, plus
+// `contains()`, stored in a B-tree; see `btree_set.h`. As there, inserting
+// or erasing invalidates all iterators, pointers and references into the
+// container.
+//
+// Example:
+//
+//   absl::btree_map<std::string, int> index;
+//   index["b"] = 2;
+//   index.try_emplace("a", 1);
+//   for (const auto& kv : index) ...  // "a", then "b".
+
+#ifndef ABSL_CONTAINER_BTREE_MAP_H_
+#define ABSL_CONTAINER_BTREE_MAP_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/container/internal/btree.h"
+#include "absl/container/internal/btree_container.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// absl::btree_map
+// -----------------------------------------------------------------------------
+template <class Key, class Value, class Compare = std::less<Key>,
+          class Alloc = std::allocator<std::pair<const Key, Value>>>
+class btree_map
+    : public container_internal::btree_map_container<
+          container_internal::btree<container_internal::map_params<
+              Key, Value, Compare, Alloc, /*Multi=*/false>>> {
+  using Base = typename btree_map::btree_map_container;
+
+ public:
+  btree_map() {}
+  using Base::Base;
+};
+
+// -----------------------------------------------------------------------------
+// absl::btree_multimap
+// -----------------------------------------------------------------------------
+template <class Key, class Value, class Compare = std::less<Key>,
+          class Alloc = std::allocator<std::pair<const Key, Value>>>
+class btree_multimap
+    : public container_internal::btree_multimap_container<
+          container_internal::btree<container_internal::map_params<
+              Key, Value, Compare, Alloc, /*Multi=*/true>>> {
+  using Base = typename btree_multimap::btree_multimap_container;
+
+ public:
+  btree_multimap() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_BTREE_MAP_H_
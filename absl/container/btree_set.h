@@ -0,0 +1,86 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: btree_set.h
+// -----------------------------------------------------------------------------
+//
+// `absl::btree_set<T>` and `absl::btree_multiset<T>` are ordered containers
+// with the interfaces of `std::set` and `std::multiset`, stored in a B-tree:
+// each node holds as many values as fit in 256 bytes, so that a lookup takes
+// a cache miss or two per 30-odd values instead of one per value, and a
+// small key takes a little over its own size instead of the 32 bytes of
+// pointers and color of a red-black tree node.
+//
+// They differ from the standard containers in that:
+//
+//   * Inserting or erasing invalidates all iterators, pointers and
+//     references into the container: values move between nodes.
+//   * Values must be movable; they are moved when nodes are rebalanced.
+//
+// Sets of `std::string` look up any string-like key without converting it.
+// Inserting a sorted range, or inserting each value with `end()` as the
+// hint, appends in constant time per value and leaves the nodes full.
+//
+// Example:
+//
+//   absl::btree_set<int64_t> ids = {5, 1, 3};
+//   auto it = ids.lower_bound(2);  // Points at 3.
+
+#ifndef ABSL_CONTAINER_BTREE_SET_H_
+#define ABSL_CONTAINER_BTREE_SET_H_
+
+#include <functional>
+#include <memory>
+
+#include "absl/container/internal/btree.h"
+#include "absl/container/internal/btree_container.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// absl::btree_set
+// -----------------------------------------------------------------------------
+template <class Key, class Compare = std::less<Key>,
+          class Alloc = std::allocator<Key>>
+class btree_set
+    : public container_internal::btree_set_container<
+          container_internal::btree<container_internal::set_params<
+              Key, Compare, Alloc, /*Multi=*/false>>> {
+  using Base = typename btree_set::btree_set_container;
+
+ public:
+  btree_set() {}
+  using Base::Base;
+};
+
+// -----------------------------------------------------------------------------
+// absl::btree_multiset
+// -----------------------------------------------------------------------------
+template <class Key, class Compare = std::less<Key>,
+          class Alloc = std::allocator<Key>>
+class btree_multiset
+    : public container_internal::btree_multiset_container<
+          container_internal::btree<container_internal::set_params<
+              Key, Compare, Alloc, /*Multi=*/true>>> {
+  using Base = typename btree_multiset::btree_multiset_container;
+
+ public:
+  btree_multiset() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_BTREE_SET_H_
@@ -0,0 +1,352 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/internal/test_instance_tracker.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::absl::test_internal::CopyableMovableInstance;
+using ::absl::test_internal::InstanceTracker;
+using ::absl::test_internal::MovableOnlyInstance;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+// Applies the same random inserts and erases to a btree container and the
+// standard one it mirrors, and checks that they agree.
+template <class Tree, class Ref, class MakeValue>
+void RandomOps(int ops, int keys, MakeValue make_value) {
+  std::mt19937 gen(17);
+  Tree tree;
+  Ref ref;
+  for (int i = 0; i < ops; ++i) {
+    const auto v = make_value(gen() % keys);
+    // Grow for the first half, and shrink for the second.
+    if (gen() % 4 < (i < ops / 2 ? 3u : 1u)) {
+      tree.insert(v);
+      ref.insert(v);
+    } else {
+      ASSERT_EQ(ref.erase(v), tree.erase(v));
+    }
+    if (i % 997 == 0) tree.verify();
+  }
+  tree.verify();
+  ASSERT_EQ(ref.size(), tree.size());
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), tree.begin()));
+  EXPECT_TRUE(std::equal(ref.rbegin(), ref.rend(), tree.rbegin()));
+  for (int k = 0; k < keys; ++k) {
+    const auto v = make_value(k);
+    ASSERT_EQ(ref.count(v), tree.count(v));
+    ASSERT_EQ(std::distance(ref.begin(), ref.lower_bound(v)),
+              std::distance(tree.begin(), tree.lower_bound(v)));
+    ASSERT_EQ(std::distance(ref.begin(), ref.upper_bound(v)),
+              std::distance(tree.begin(), tree.upper_bound(v)));
+  }
+}
+
+int64_t Identity(int k) { return k; }
+
+TEST(Btree, SetMatchesStdSet) {
+  RandomOps<absl::btree_set<int64_t>, std::set<int64_t>>(100000, 5000,
+                                                         Identity);
+}
+
+TEST(Btree, MultisetMatchesStdMultiset) {
+  RandomOps<absl::btree_multiset<int64_t>, std::multiset<int64_t>>(
+      100000, 500, Identity);
+}
+
+TEST(Btree, StringSetMatchesStdSet) {
+  RandomOps<absl::btree_set<std::string>, std::set<std::string>>(
+      50000, 5000, [](int k) { return "key" + std::to_string(k); });
+}
+
+// A value too large for more than the minimum of 3 per node, which makes
+// for a deep tree that exercises every merge and rebalance.
+struct Big {
+  int64_t key;
+  char padding[200];
+
+  friend bool operator<(const Big& a, const Big& b) { return a.key < b.key; }
+  friend bool operator==(const Big& a, const Big& b) {
+    return a.key == b.key;
+  }
+};
+
+TEST(Btree, BigValuesMatchStdSet) {
+  RandomOps<absl::btree_set<Big>, std::set<Big>>(20000, 2000, [](int k) {
+    Big b;
+    b.key = k;
+    return b;
+  });
+}
+
+TEST(Btree, MapMatchesStdMap) {
+  std::mt19937 gen(3);
+  absl::btree_map<int, int> tree;
+  std::map<int, int> ref;
+  for (int i = 0; i < 50000; ++i) {
+    const int k = gen() % 3000;
+    if (gen() % 3) {
+      tree[k] += i;
+      ref[k] += i;
+    } else {
+      ASSERT_EQ(ref.erase(k), tree.erase(k));
+    }
+  }
+  tree.verify();
+  EXPECT_TRUE(std::equal(ref.begin(), ref.end(), tree.begin()));
+}
+
+TEST(Btree, IterateBothWays) {
+  absl::btree_set<int> s;
+  for (int i = 999; i >= 0; --i) s.insert(i);
+  int expected = 0;
+  for (int v : s) EXPECT_EQ(expected++, v);
+  EXPECT_EQ(1000, expected);
+  auto it = s.end();
+  while (it != s.begin()) EXPECT_EQ(--expected, *--it);
+  EXPECT_EQ(0, expected);
+}
+
+TEST(Btree, EraseWhileIterating) {
+  absl::btree_set<int> s;
+  for (int i = 0; i < 10000; ++i) s.insert(i);
+  for (auto it = s.begin(); it != s.end();) {
+    if (*it % 3 != 0) {
+      it = s.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  s.verify();
+  ASSERT_EQ(3334, s.size());
+  int expected = 0;
+  for (int v : s) {
+    EXPECT_EQ(expected, v);
+    expected += 3;
+  }
+}
+
+TEST(Btree, EraseRange) {
+  absl::btree_set<int> s;
+  for (int i = 0; i < 1000; ++i) s.insert(i);
+  auto it = s.erase(s.find(100), s.find(900));
+  EXPECT_EQ(900, *it);
+  s.verify();
+  EXPECT_EQ(200, s.size());
+  EXPECT_EQ(s.end(), s.erase(s.begin(), s.end()));
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(Btree, Bounds) {
+  absl::btree_multiset<int> s = {1, 3, 3, 3, 5};
+  EXPECT_EQ(3, *s.lower_bound(2));
+  EXPECT_EQ(5, *s.upper_bound(3));
+  EXPECT_EQ(s.end(), s.lower_bound(6));
+  auto range = s.equal_range(3);
+  EXPECT_EQ(3, std::distance(range.first, range.second));
+  EXPECT_EQ(3, s.count(3));
+  EXPECT_EQ(3, s.erase(3));
+  EXPECT_THAT(s, ElementsAre(1, 5));
+}
+
+TEST(Btree, HeterogeneousStringLookup) {
+  absl::btree_map<std::string, int> m = {{"huey", 1}, {"dewey", 2}};
+  EXPECT_EQ(1, m.find("huey")->second);
+  EXPECT_EQ(2, m.at(absl::string_view("dewey")));
+  EXPECT_TRUE(m.contains("dewey"));
+  EXPECT_EQ(0, m.count("louie"));
+  EXPECT_EQ("huey", m.lower_bound(absl::string_view("e"))->first);
+  // Only the key is converted, and only when inserted.
+  m.try_emplace(absl::string_view("louie"), 3);
+  EXPECT_THAT(m, ElementsAre(Pair("dewey", 2), Pair("huey", 1),
+                             Pair("louie", 3)));
+}
+
+TEST(Btree, MapInterface) {
+  absl::btree_map<int, std::unique_ptr<int>> m;
+  std::unique_ptr<int> p(new int(1));
+  EXPECT_TRUE(m.try_emplace(1, std::move(p)).second);
+  EXPECT_EQ(nullptr, p);
+  std::unique_ptr<int> q(new int(2));
+  // A present key leaves the arguments alone.
+  EXPECT_FALSE(m.try_emplace(1, std::move(q)).second);
+  EXPECT_NE(nullptr, q);
+  EXPECT_FALSE(m.insert_or_assign(1, std::move(q)).second);
+  EXPECT_EQ(2, *m.at(1));
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(m.at(2), std::out_of_range,
+                                 "absl::btree_map::at");
+  EXPECT_EQ(nullptr, m[3]);
+  EXPECT_EQ(2, m.size());
+}
+
+TEST(Btree, Multimap) {
+  absl::btree_multimap<int, std::string> m;
+  m.insert({1, "a"});
+  m.emplace(2, "c");
+  m.emplace(1, "b");
+  // Equal keys keep their order of insertion.
+  EXPECT_THAT(m, ElementsAre(Pair(1, "a"), Pair(1, "b"), Pair(2, "c")));
+  EXPECT_EQ(2, m.erase(1));
+}
+
+TEST(Btree, HintedInsert) {
+  absl::btree_set<int> s;
+  for (int i = 0; i < 100; i += 2) s.insert(s.end(), i);
+  // A wrong hint still inserts in the right place.
+  s.insert(s.begin(), 51);
+  auto it = s.insert(s.find(60), 59);
+  EXPECT_EQ(59, *it);
+  EXPECT_EQ(s.find(40), s.insert(s.begin(), 40));
+  s.verify();
+  EXPECT_EQ(52, s.size());
+  EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+}
+
+TEST(Btree, CopyMoveAssign) {
+  absl::btree_map<int, std::string> a;
+  for (int i = 0; i < 1000; ++i) a[i] = std::to_string(i);
+  absl::btree_map<int, std::string> b = a;
+  b.verify();
+  EXPECT_TRUE(a == b);
+  b[1000] = "x";
+  EXPECT_TRUE(a != b);
+  EXPECT_TRUE(a < b);
+  absl::btree_map<int, std::string> c = std::move(b);
+  EXPECT_TRUE(b.empty());  // NOLINT: use after move is intended.
+  EXPECT_EQ(1001, c.size());
+  b = c;
+  a = std::move(c);
+  EXPECT_TRUE(a == b);
+  swap(a, c);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(1001, c.size());
+}
+
+TEST(Btree, ElementsAreDestroyed) {
+  InstanceTracker tracker;
+  struct Less {
+    bool operator()(const MovableOnlyInstance& a,
+                    const MovableOnlyInstance& b) const {
+      return a.value() < b.value();
+    }
+  };
+  {
+    absl::btree_set<MovableOnlyInstance, Less> s;
+    for (int i = 0; i < 1000; ++i) s.insert(MovableOnlyInstance(i));
+    for (int i = 0; i < 1000; i += 2) s.erase(MovableOnlyInstance(i));
+    EXPECT_EQ(500, tracker.live_instances());
+    absl::btree_set<MovableOnlyInstance, Less> moved = std::move(s);
+    EXPECT_EQ(500, moved.size());
+    EXPECT_EQ(500, tracker.live_instances());
+  }
+  EXPECT_EQ(0, tracker.instances());
+}
+
+TEST(Btree, EmplaceBuildsOnce) {
+  InstanceTracker tracker;
+  struct Less {
+    bool operator()(const CopyableMovableInstance& a,
+                    const CopyableMovableInstance& b) const {
+      return a.value() < b.value();
+    }
+  };
+  absl::btree_set<CopyableMovableInstance, Less> s;
+  const CopyableMovableInstance one(1);
+  s.insert(one);
+  tracker.ResetCopiesMovesSwaps();
+  // Present: looked up without a copy.
+  EXPECT_FALSE(s.insert(one).second);
+  EXPECT_EQ(0, tracker.copies());
+}
+
+template <class T>
+struct CountingAllocator : std::allocator<T> {
+  template <class U>
+  struct rebind {
+    using other = CountingAllocator<U>;
+  };
+
+  explicit CountingAllocator(int64_t* bytes) : bytes(bytes) {}
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>& x) : bytes(x.bytes) {}
+
+  T* allocate(size_t n) {
+    *bytes += n * sizeof(T);
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    *bytes -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  template <class U>
+  friend bool operator==(const CountingAllocator& a,
+                         const CountingAllocator<U>& b) {
+    return a.bytes == b.bytes;
+  }
+  template <class U>
+  friend bool operator!=(const CountingAllocator& a,
+                         const CountingAllocator<U>& b) {
+    return a.bytes != b.bytes;
+  }
+
+  int64_t* bytes;
+};
+
+TEST(Btree, SortedInputPacksNodes) {
+  std::vector<int64_t> keys(100000);
+  for (size_t i = 0; i < keys.size(); ++i) keys[i] = 2 * i;
+  int64_t btree_bytes = 0;
+  int64_t set_bytes = 0;
+  {
+    using Alloc = CountingAllocator<int64_t>;
+    absl::btree_set<int64_t, std::less<int64_t>, Alloc> s(
+        keys.begin(), keys.end(), std::less<int64_t>(), Alloc(&btree_bytes));
+    std::set<int64_t, std::less<int64_t>, Alloc> ref(
+        keys.begin(), keys.end(), std::less<int64_t>(), Alloc(&set_bytes));
+    s.verify();
+    // Full leaves of 30 8-byte keys in 256 bytes.
+    EXPECT_LE(btree_bytes, static_cast<int64_t>(keys.size()) * 9);
+    EXPECT_LT(btree_bytes * 4, set_bytes);
+
+    // Random insertion leaves the nodes at least half full.
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    const int64_t packed = btree_bytes;
+    s.clear();
+    for (int64_t k : keys) s.insert(k + 1);
+    s.verify();
+    EXPECT_LE(btree_bytes, 2 * packed + 1024);
+  }
+  EXPECT_EQ(0, btree_bytes);
+  EXPECT_EQ(0, set_bytes);
+}
+
+}  // namespace
@@ -0,0 +1,713 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: circular_buffer.h
+// -----------------------------------------------------------------------------
+//
+// A `CircularBuffer<T, N>` is a ring buffer holding at most `N` elements,
+// stored inline like those of a small `FixedArray`. A `CircularBuffer<T>`
+// holds at most a capacity chosen at run time, stored on the heap.
+//
+// Elements are appended at the back and removed from the front. Appending to
+// a full buffer either overwrites the oldest element (`push_back()`,
+// `append()`) or fails (`try_push_back()`, `try_append()`), so the same type
+// serves as a "last N events" history and as a bounded queue:
+//
+//   absl::CircularBuffer<Event, 64> recent;
+//   recent.push_back(event);  // Forgets the oldest event once there are 64.
+//
+// The elements occupy at most two contiguous runs of the underlying array,
+// which `segments()` returns as `absl::Span`s, oldest first. A consumer can
+// process them in bulk without copying and then drop them with
+// `pop_front(n)`:
+//
+//   auto segments = buffer.segments();
+//   Write(segments.first);
+//   Write(segments.second);
+//   buffer.pop_front(segments.first.size() + segments.second.size());
+//
+// A `CircularBuffer` is not thread-safe.
+
+#ifndef ABSL_CONTAINER_CIRCULAR_BUFFER_H_
+#define ABSL_CONTAINER_CIRCULAR_BUFFER_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "absl/algorithm/algorithm.h"
+#include "absl/base/internal/throw_delegate.h"
+#include "absl/base/optimization.h"
+#include "absl/types/span.h"
+
+namespace absl {
+namespace circular_buffer_internal {
+
+// Storage
+//
+// Uninitialized space for `N` elements, stored inline.
+template <typename T, size_t N, typename A>
+class Storage {
+ public:
+  explicit Storage(const A&) {}
+
+  T* data() { return reinterpret_cast<T*>(space_.data()); }
+  const T* data() const { return reinterpret_cast<const T*>(space_.data()); }
+  size_t capacity() const { return N; }
+  A get_allocator() const { return A(); }
+
+ private:
+  std::array<typename std::aligned_storage<sizeof(T), alignof(T)>::type, N>
+      space_;
+};
+
+// Specialization for a capacity chosen at run time: uninitialized space
+// allocated with `A`, which takes no room when it is empty.
+template <typename T, typename A>
+class Storage<T, 0, A> : private A {
+  using AllocatorTraits = std::allocator_traits<A>;
+
+ public:
+  explicit Storage(const A& a) : A(a) {}
+  Storage(const A& a, size_t capacity) : A(a) { Allocate(capacity); }
+  Storage(const Storage&) = delete;
+  Storage& operator=(const Storage&) = delete;
+  ~Storage() { Deallocate(); }
+
+  T* data() const { return data_; }
+  size_t capacity() const { return capacity_; }
+  A get_allocator() const { return *this; }
+
+  // Replaces the space with uninitialized space for `capacity` elements. The
+  // old space must hold no element.
+  void Reset(size_t capacity) {
+    Deallocate();
+    Allocate(capacity);
+  }
+
+  void Swap(Storage& other) noexcept {
+    using std::swap;
+    swap(allocator(), other.allocator());
+    std::swap(data_, other.data_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+ private:
+  A& allocator() { return *this; }
+
+  void Allocate(size_t capacity) {
+    if (capacity != 0) data_ = AllocatorTraits::allocate(allocator(), capacity);
+    capacity_ = capacity;
+  }
+
+  void Deallocate() {
+    if (data_ != nullptr) {
+      AllocatorTraits::deallocate(allocator(), data_, capacity_);
+      data_ = nullptr;
+    }
+    capacity_ = 0;
+  }
+
+  T* data_ = nullptr;
+  size_t capacity_ = 0;
+};
+
+}  // namespace circular_buffer_internal
+
+// -----------------------------------------------------------------------------
+// CircularBuffer
+// -----------------------------------------------------------------------------
+//
+// With `N > 0`, the buffer holds up to `N` elements inline and `A` is unused.
+// With `N == 0`, the capacity is passed to the constructor and the elements
+// live in space allocated with `A`. As with `FixedArray`, the allocator only
+// provides memory: elements are constructed and destroyed in place.
+//
+// Element 0 is the oldest. Pointers and references to an element stay valid
+// until it is removed or overwritten. Iterators instead hold a position
+// counted from the oldest element, so `pop_front()`, `clear()`, and appends
+// that overwrite elements invalidate all of them. Appends that fit invalidate
+// only `end()`, and `pop_back()` only iterators to the removed element and
+// `end()`.
+template <typename T, size_t N = 0, typename A = std::allocator<T>>
+class CircularBuffer {
+  static constexpr bool kDynamic = N == 0;
+
+  template <bool IsConst>
+  class Iterator;
+
+ public:
+  using value_type = T;
+  using allocator_type = A;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Creates an empty buffer. A buffer with a run-time capacity has capacity 0
+  // until it is assigned to or `set_capacity()` is called.
+  CircularBuffer() : storage_(allocator_type()) {}
+
+  // Creates an empty buffer with room for `capacity` elements.
+  // REQUIRES: N == 0
+  explicit CircularBuffer(size_type capacity,
+                          const allocator_type& a = allocator_type())
+      : storage_(a, capacity) {
+    static_assert(kDynamic, "Only CircularBuffer<T> has a run-time capacity");
+  }
+
+  CircularBuffer(const CircularBuffer& other)
+      : storage_(std::allocator_traits<allocator_type>::
+                     select_on_container_copy_construction(
+                         other.get_allocator())) {
+    CopyFrom(other, std::integral_constant<bool, kDynamic>());
+  }
+
+  // Moves the elements of `other`, or takes its space when it is allocated.
+  // Leaves `other` empty.
+  CircularBuffer(CircularBuffer&& other) noexcept(
+      kDynamic || std::is_nothrow_move_constructible<value_type>::value)
+      : storage_(other.get_allocator()) {
+    MoveFrom(other, std::integral_constant<bool, kDynamic>());
+  }
+
+  ~CircularBuffer() { clear(); }
+
+  CircularBuffer& operator=(const CircularBuffer& other) {
+    if (this != &other) {
+      clear();
+      CopyFrom(other, std::integral_constant<bool, kDynamic>());
+    }
+    return *this;
+  }
+
+  CircularBuffer& operator=(CircularBuffer&& other) noexcept(
+      kDynamic || std::is_nothrow_move_constructible<value_type>::value) {
+    if (this != &other) {
+      clear();
+      MoveFrom(other, std::integral_constant<bool, kDynamic>());
+    }
+    return *this;
+  }
+
+  // CircularBuffer::size()
+  //
+  // Returns the number of elements in the buffer.
+  size_type size() const { return size_; }
+
+  // CircularBuffer::capacity()
+  //
+  // Returns the number of elements the buffer can hold.
+  size_type capacity() const { return storage_.capacity(); }
+
+  // CircularBuffer::empty()
+  //
+  // Returns whether the buffer holds no element.
+  bool empty() const { return size() == 0; }
+
+  // CircularBuffer::full()
+  //
+  // Returns whether appending to the buffer overwrites or fails.
+  bool full() const { return size() == capacity(); }
+
+  // CircularBuffer::max_size()
+  //
+  // Returns the largest possible capacity.
+  size_type max_size() const {
+    return std::numeric_limits<difference_type>::max() / sizeof(value_type);
+  }
+
+  // CircularBuffer::operator[]
+  //
+  // Returns a reference to the `i`th oldest element.
+  // REQUIRES: i < size()
+  reference operator[](size_type i) {
+    assert(i < size());
+    return *Slot(i);
+  }
+
+  const_reference operator[](size_type i) const {
+    assert(i < size());
+    return *Slot(i);
+  }
+
+  // CircularBuffer::at()
+  //
+  // Returns a reference to the `i`th oldest element, or throws
+  // `std::out_of_range`.
+  reference at(size_type i) {
+    if (ABSL_PREDICT_FALSE(i >= size())) {
+      base_internal::ThrowStdOutOfRange(
+          "CircularBuffer::at() failed bounds check");
+    }
+    return *Slot(i);
+  }
+
+  const_reference at(size_type i) const {
+    if (ABSL_PREDICT_FALSE(i >= size())) {
+      base_internal::ThrowStdOutOfRange(
+          "CircularBuffer::at() failed bounds check");
+    }
+    return *Slot(i);
+  }
+
+  // CircularBuffer::front()
+  //
+  // Returns a reference to the oldest element.
+  reference front() {
+    assert(!empty());
+    return *Slot(0);
+  }
+
+  const_reference front() const {
+    assert(!empty());
+    return *Slot(0);
+  }
+
+  // CircularBuffer::back()
+  //
+  // Returns a reference to the newest element.
+  reference back() {
+    assert(!empty());
+    return *Slot(size() - 1);
+  }
+
+  const_reference back() const {
+    assert(!empty());
+    return *Slot(size() - 1);
+  }
+
+  // CircularBuffer::begin()
+  //
+  // Returns an iterator to the oldest element.
+  iterator begin() { return iterator(this, 0); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator cbegin() const { return begin(); }
+
+  // CircularBuffer::end()
+  //
+  // Returns an iterator past the newest element.
+  iterator end() { return iterator(this, size()); }
+  const_iterator end() const { return const_iterator(this, size()); }
+  const_iterator cend() const { return end(); }
+
+  // CircularBuffer::rbegin()
+  //
+  // Returns a reverse iterator from the newest element.
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  // CircularBuffer::rend()
+  //
+  // Returns a reverse iterator past the oldest element.
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const { return rend(); }
+
+  // CircularBuffer::segments()
+  //
+  // Returns the elements as two contiguous runs, oldest first. The second is
+  // empty unless the elements wrap around the end of the underlying array.
+  std::pair<absl::Span<value_type>, absl::Span<value_type>> segments() {
+    const size_type first = std::min(size(), capacity() - head_);
+    return {absl::Span<value_type>(storage_.data() + head_, first),
+            absl::Span<value_type>(storage_.data(), size() - first)};
+  }
+
+  std::pair<absl::Span<const value_type>, absl::Span<const value_type>>
+  segments() const {
+    const size_type first = std::min(size(), capacity() - head_);
+    return {absl::Span<const value_type>(storage_.data() + head_, first),
+            absl::Span<const value_type>(storage_.data(), size() - first)};
+  }
+
+  // CircularBuffer::push_back()
+  //
+  // Appends `v`. If the buffer is full, `v` is assigned to the oldest element,
+  // which becomes the newest.
+  // REQUIRES: capacity() > 0
+  void push_back(const_reference v) {
+    if (ABSL_PREDICT_FALSE(full())) {
+      Overwrite(v);
+    } else {
+      Construct(v);
+    }
+  }
+
+  void push_back(value_type&& v) {
+    if (ABSL_PREDICT_FALSE(full())) {
+      Overwrite(std::move(v));
+    } else {
+      Construct(std::move(v));
+    }
+  }
+
+  // CircularBuffer::emplace_back()
+  //
+  // Constructs an element from `args` at the back. If the buffer is full, the
+  // new element is move-assigned to the oldest one, which becomes the newest.
+  // REQUIRES: capacity() > 0
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (ABSL_PREDICT_FALSE(full())) {
+      Overwrite(value_type(std::forward<Args>(args)...));
+    } else {
+      Construct(std::forward<Args>(args)...);
+    }
+    return back();
+  }
+
+  // CircularBuffer::try_push_back()
+  //
+  // Appends `v` and returns true, or returns false if the buffer is full.
+  bool try_push_back(const_reference v) { return try_emplace_back(v); }
+  bool try_push_back(value_type&& v) { return try_emplace_back(std::move(v)); }
+
+  // CircularBuffer::try_emplace_back()
+  //
+  // Constructs an element from `args` at the back and returns true, or returns
+  // false if the buffer is full.
+  template <typename... Args>
+  bool try_emplace_back(Args&&... args) {
+    if (ABSL_PREDICT_FALSE(full())) return false;
+    Construct(std::forward<Args>(args)...);
+    return true;
+  }
+
+  // CircularBuffer::append()
+  //
+  // Appends copies of `values`, overwriting the oldest elements as needed. If
+  // there are more values than the capacity, only the newest are kept.
+  void append(absl::Span<const value_type> values) {
+    if (values.size() > capacity()) {
+      values.remove_prefix(values.size() - capacity());
+    }
+    if (values.size() > capacity() - size()) {
+      pop_front(values.size() - (capacity() - size()));
+    }
+    CopyToBack(values);
+  }
+
+  // CircularBuffer::try_append()
+  //
+  // Appends copies of as many of `values` as fit, in order, and returns how
+  // many were appended.
+  size_type try_append(absl::Span<const value_type> values) {
+    values = values.subspan(0, capacity() - size());
+    CopyToBack(values);
+    return values.size();
+  }
+
+  // CircularBuffer::pop_front()
+  //
+  // Destroys the oldest element, or the `n` oldest ones.
+  // REQUIRES: !empty(), or n <= size()
+  void pop_front() {
+    assert(!empty());
+    Slot(0)->~value_type();
+    head_ = Wrap(head_ + 1);
+    --size_;
+  }
+
+  void pop_front(size_type n) {
+    assert(n <= size());
+    DestroyFront(n);
+  }
+
+  // CircularBuffer::pop_back()
+  //
+  // Destroys the newest element.
+  // REQUIRES: !empty()
+  void pop_back() {
+    assert(!empty());
+    --size_;
+    Slot(size_)->~value_type();
+  }
+
+  // CircularBuffer::clear()
+  //
+  // Destroys all elements. The capacity is unchanged.
+  void clear() { DestroyFront(size()); }
+
+  // CircularBuffer::set_capacity()
+  //
+  // Changes the capacity to `capacity`, keeping the newest elements that fit.
+  // REQUIRES: N == 0
+  void set_capacity(size_type capacity) {
+    static_assert(kDynamic, "Only CircularBuffer<T> has a run-time capacity");
+    if (capacity == this->capacity()) return;
+    if (size() > capacity) pop_front(size() - capacity);
+    CircularBuffer resized(capacity, get_allocator());
+    for (auto& v : *this) resized.Construct(std::move(v));
+    *this = std::move(resized);
+  }
+
+  // CircularBuffer::swap()
+  //
+  // Swaps the contents of two buffers. Buffers with a run-time capacity swap
+  // their space; others swap their elements.
+  void swap(CircularBuffer& other) {
+    SwapImpl(other, std::integral_constant<bool, kDynamic>());
+  }
+
+  // CircularBuffer::get_allocator()
+  //
+  // Returns a copy of the allocator.
+  allocator_type get_allocator() const { return storage_.get_allocator(); }
+
+ private:
+  size_type Wrap(size_type i) const {
+    return i >= capacity() ? i - capacity() : i;
+  }
+
+  // Returns the address of the `i`th oldest element, which need not be
+  // constructed.
+  pointer Slot(size_type i) {
+    return storage_.data() + Wrap(head_ + i);
+  }
+  const_pointer Slot(size_type i) const {
+    return storage_.data() + Wrap(head_ + i);
+  }
+
+  // Constructs an element at the back of a buffer that is not full.
+  template <typename... Args>
+  void Construct(Args&&... args) {
+    assert(!full());
+    ::new (static_cast<void*>(Slot(size_)))
+        value_type(std::forward<Args>(args)...);
+    ++size_;
+  }
+
+  // Makes the oldest element of a full buffer the newest one, with value `v`.
+  template <typename U>
+  void Overwrite(U&& v) {
+    assert(full() && capacity() > 0);
+    *Slot(0) = std::forward<U>(v);
+    head_ = Wrap(head_ + 1);
+  }
+
+  // Copies `values`, which fit, to the back.
+  void CopyToBack(absl::Span<const value_type> values) {
+    assert(values.size() <= capacity() - size());
+    const size_type tail = Wrap(head_ + size_);
+    const size_type first = std::min(values.size(), capacity() - tail);
+    std::uninitialized_copy_n(values.data(), first, storage_.data() + tail);
+    size_ += first;
+    std::uninitialized_copy_n(values.data() + first, values.size() - first,
+                              storage_.data());
+    size_ += values.size() - first;
+  }
+
+  void DestroyFront(size_type n) {
+    for (size_type i = 0; i < n; ++i) Slot(i)->~value_type();
+    head_ = size_ == n ? 0 : Wrap(head_ + n);
+    size_ -= n;
+  }
+
+  void CopyFrom(const CircularBuffer& other, std::true_type /* dynamic */) {
+    if (capacity() != other.capacity()) storage_.Reset(other.capacity());
+    CopyFrom(other, std::false_type());
+  }
+
+  void CopyFrom(const CircularBuffer& other, std::false_type) {
+    auto segments = other.segments();
+    CopyToBack(segments.first);
+    CopyToBack(segments.second);
+  }
+
+  void MoveFrom(CircularBuffer& other, std::true_type /* dynamic */) {
+    storage_.Reset(0);
+    storage_.Swap(other.storage_);
+    std::swap(head_, other.head_);
+    std::swap(size_, other.size_);
+  }
+
+  void MoveFrom(CircularBuffer& other, std::false_type) {
+    for (auto& v : other) Construct(std::move(v));
+    other.clear();
+  }
+
+  void SwapImpl(CircularBuffer& other, std::true_type /* dynamic */) {
+    storage_.Swap(other.storage_);
+    std::swap(head_, other.head_);
+    std::swap(size_, other.size_);
+  }
+
+  void SwapImpl(CircularBuffer& other, std::false_type) {
+    CircularBuffer tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  circular_buffer_internal::Storage<value_type, N, allocator_type> storage_;
+  // Index of the oldest element in `storage_`.
+  size_type head_ = 0;
+  size_type size_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// CircularBuffer::Iterator
+// -----------------------------------------------------------------------------
+//
+// A random access iterator holding the buffer and an index from the oldest
+// element. Removing elements from the front moves every index onto another
+// element, so the iterator is then invalid.
+template <typename T, size_t N, typename A>
+template <bool IsConst>
+class CircularBuffer<T, N, A>::Iterator {
+  using Container = typename std::conditional<IsConst, const CircularBuffer,
+                                              CircularBuffer>::type;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename CircularBuffer::value_type;
+  using difference_type = typename CircularBuffer::difference_type;
+  using pointer =
+      typename std::conditional<IsConst, typename CircularBuffer::const_pointer,
+                                typename CircularBuffer::pointer>::type;
+  using reference = typename std::conditional<
+      IsConst, typename CircularBuffer::const_reference,
+      typename CircularBuffer::reference>::type;
+
+  Iterator() = default;
+
+  // Converts an iterator to a const_iterator.
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  Iterator(const Iterator<false>& it)  // NOLINT(runtime/explicit)
+      : b_(it.b_), i_(it.i_) {}
+
+  reference operator*() const { return (*b_)[i_]; }
+  pointer operator->() const { return &(*b_)[i_]; }
+  reference operator[](difference_type n) const { return (*b_)[i_ + n]; }
+
+  Iterator& operator++() {
+    ++i_;
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator tmp = *this;
+    ++i_;
+    return tmp;
+  }
+  Iterator& operator--() {
+    --i_;
+    return *this;
+  }
+  Iterator operator--(int) {
+    Iterator tmp = *this;
+    --i_;
+    return tmp;
+  }
+  Iterator& operator+=(difference_type n) {
+    i_ += n;
+    return *this;
+  }
+  Iterator& operator-=(difference_type n) {
+    i_ -= n;
+    return *this;
+  }
+
+  friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+  friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+  friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const Iterator& a, const Iterator& b) {
+    return static_cast<difference_type>(a.i_) -
+           static_cast<difference_type>(b.i_);
+  }
+
+  friend bool operator==(const Iterator& a, const Iterator& b) {
+    return a.i_ == b.i_;
+  }
+  friend bool operator!=(const Iterator& a, const Iterator& b) {
+    return a.i_ != b.i_;
+  }
+  friend bool operator<(const Iterator& a, const Iterator& b) {
+    return a.i_ < b.i_;
+  }
+  friend bool operator>(const Iterator& a, const Iterator& b) {
+    return a.i_ > b.i_;
+  }
+  friend bool operator<=(const Iterator& a, const Iterator& b) {
+    return a.i_ <= b.i_;
+  }
+  friend bool operator>=(const Iterator& a, const Iterator& b) {
+    return a.i_ >= b.i_;
+  }
+
+ private:
+  friend class CircularBuffer;
+  friend class Iterator<!IsConst>;
+
+  Iterator(Container* b, size_type i) : b_(b), i_(i) {}
+
+  Container* b_ = nullptr;
+  size_type i_ = 0;
+};
+
+template <typename T, size_t N, typename A>
+constexpr bool CircularBuffer<T, N, A>::kDynamic;
+
+// -----------------------------------------------------------------------------
+// CircularBuffer Non-Member Functions
+// -----------------------------------------------------------------------------
+
+// swap()
+//
+// Swaps the contents of two circular buffers.
+template <typename T, size_t N, typename A>
+void swap(CircularBuffer<T, N, A>& a, CircularBuffer<T, N, A>& b) {
+  a.swap(b);
+}
+
+// operator==()
+//
+// Tests the equivalence of the contents of two circular buffers, oldest
+// elements first.
+template <typename T, size_t N, typename A>
+bool operator==(const CircularBuffer<T, N, A>& a,
+                const CircularBuffer<T, N, A>& b) {
+  return absl::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// operator!=()
+//
+// Tests the inequality of the contents of two circular buffers.
+template <typename T, size_t N, typename A>
+bool operator!=(const CircularBuffer<T, N, A>& a,
+                const CircularBuffer<T, N, A>& b) {
+  return !(a == b);
+}
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_CIRCULAR_BUFFER_H_
@@ -0,0 +1,94 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "absl/container/circular_buffer.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+constexpr size_t kHistory = 64;
+
+template <class T>
+T MakeElement(int i);
+
+template <>
+int64_t MakeElement<int64_t>(int i) {
+  return i;
+}
+
+template <>
+std::string MakeElement<std::string>(int i) {
+  return std::string(i % 32, 'x');
+}
+
+// Keeps the last kHistory elements.
+template <class T>
+void BM_DequeHistory(benchmark::State& state) {
+  std::deque<T> history;
+  int i = 0;
+  while (state.KeepRunning()) {
+    if (history.size() == kHistory) history.pop_front();
+    history.push_back(MakeElement<T>(i++));
+    benchmark::DoNotOptimize(&history.back());
+  }
+}
+BENCHMARK_TEMPLATE(BM_DequeHistory, int64_t);
+BENCHMARK_TEMPLATE(BM_DequeHistory, std::string);
+
+template <class T>
+void BM_CircularBufferHistory(benchmark::State& state) {
+  absl::CircularBuffer<T, kHistory> history;
+  int i = 0;
+  while (state.KeepRunning()) {
+    history.push_back(MakeElement<T>(i++));
+    benchmark::DoNotOptimize(&history.back());
+  }
+}
+BENCHMARK_TEMPLATE(BM_CircularBufferHistory, int64_t);
+BENCHMARK_TEMPLATE(BM_CircularBufferHistory, std::string);
+
+// Produces batches of 16 elements and consumes everything buffered.
+void BM_DequeBatches(benchmark::State& state) {
+  std::deque<int64_t> queue;
+  int64_t batch[16] = {};
+  while (state.KeepRunning()) {
+    queue.insert(queue.end(), std::begin(batch), std::end(batch));
+    int64_t sum = 0;
+    for (int64_t v : queue) sum += v;
+    queue.clear();
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_DequeBatches);
+
+void BM_CircularBufferBatches(benchmark::State& state) {
+  absl::CircularBuffer<int64_t, kHistory> queue;
+  int64_t batch[16] = {};
+  while (state.KeepRunning()) {
+    queue.try_append(batch);
+    int64_t sum = 0;
+    auto segments = queue.segments();
+    for (int64_t v : segments.first) sum += v;
+    for (int64_t v : segments.second) sum += v;
+    queue.pop_front(segments.first.size() + segments.second.size());
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_CircularBufferBatches);
+
+}  // namespace
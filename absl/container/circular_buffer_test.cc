@@ -0,0 +1,275 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/circular_buffer.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/internal/test_instance_tracker.h"
+
+namespace {
+
+using absl::test_internal::CopyableMovableInstance;
+using absl::test_internal::InstanceTracker;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+template <typename Buffer>
+std::vector<int> Contents(const Buffer& b) {
+  return std::vector<int>(b.begin(), b.end());
+}
+
+TEST(CircularBufferTest, InlineStorage) {
+  absl::CircularBuffer<int, 4> b;
+  EXPECT_EQ(b.capacity(), 4u);
+  EXPECT_GE(sizeof(b), 4 * sizeof(int));
+  EXPECT_TRUE(b.empty());
+  EXPECT_FALSE(b.full());
+}
+
+TEST(CircularBufferTest, PushBackOverwritesOldest) {
+  absl::CircularBuffer<int, 3> b;
+  b.push_back(1);
+  b.push_back(2);
+  EXPECT_THAT(b, ElementsAre(1, 2));
+  b.push_back(3);
+  EXPECT_TRUE(b.full());
+  b.push_back(4);
+  b.push_back(5);
+  EXPECT_THAT(b, ElementsAre(3, 4, 5));
+  EXPECT_EQ(b.front(), 3);
+  EXPECT_EQ(b.back(), 5);
+  EXPECT_EQ(b[1], 4);
+  EXPECT_EQ(b.size(), 3u);
+}
+
+TEST(CircularBufferTest, PushBackOfOwnElementWhenFull) {
+  absl::CircularBuffer<std::string, 2> b;
+  b.push_back("a");
+  b.push_back("b");
+  b.push_back(b.front());
+  EXPECT_THAT(b, ElementsAre("b", "a"));
+  b.emplace_back(b.front());
+  EXPECT_THAT(b, ElementsAre("a", "b"));
+}
+
+TEST(CircularBufferTest, TryPushBackRejectsWhenFull) {
+  absl::CircularBuffer<int, 2> b;
+  EXPECT_TRUE(b.try_push_back(1));
+  EXPECT_TRUE(b.try_emplace_back(2));
+  EXPECT_FALSE(b.try_push_back(3));
+  EXPECT_THAT(b, ElementsAre(1, 2));
+  b.pop_front();
+  EXPECT_TRUE(b.try_push_back(3));
+  EXPECT_THAT(b, ElementsAre(2, 3));
+}
+
+TEST(CircularBufferTest, PopFrontAndBack) {
+  absl::CircularBuffer<int, 4> b;
+  for (int i = 0; i < 6; ++i) b.push_back(i);
+  b.pop_front();
+  EXPECT_THAT(b, ElementsAre(3, 4, 5));
+  b.pop_back();
+  EXPECT_THAT(b, ElementsAre(3, 4));
+  b.pop_front(2);
+  EXPECT_THAT(b, IsEmpty());
+}
+
+TEST(CircularBufferTest, Segments) {
+  absl::CircularBuffer<int, 4> b;
+  auto segments = b.segments();
+  EXPECT_THAT(segments.first, IsEmpty());
+  EXPECT_THAT(segments.second, IsEmpty());
+
+  b.push_back(0);
+  b.push_back(1);
+  segments = b.segments();
+  EXPECT_THAT(segments.first, ElementsAre(0, 1));
+  EXPECT_THAT(segments.second, IsEmpty());
+
+  for (int i = 2; i < 7; ++i) b.push_back(i);
+  segments = b.segments();
+  EXPECT_THAT(segments.first, ElementsAre(3));
+  EXPECT_THAT(segments.second, ElementsAre(4, 5, 6));
+
+  const auto& cb = b;
+  auto const_segments = cb.segments();
+  EXPECT_EQ(const_segments.first.size() + const_segments.second.size(), 4u);
+
+  b.pop_front(segments.first.size() + segments.second.size());
+  EXPECT_TRUE(b.empty());
+}
+
+TEST(CircularBufferTest, Append) {
+  absl::CircularBuffer<int, 4> b;
+  b.append({1, 2});
+  EXPECT_THAT(b, ElementsAre(1, 2));
+  b.append({3, 4, 5});
+  EXPECT_THAT(b, ElementsAre(2, 3, 4, 5));
+  b.append({6, 7, 8, 9, 10, 11});
+  EXPECT_THAT(b, ElementsAre(8, 9, 10, 11));
+  b.append({});
+  EXPECT_THAT(b, ElementsAre(8, 9, 10, 11));
+}
+
+TEST(CircularBufferTest, TryAppend) {
+  absl::CircularBuffer<int, 4> b;
+  b.push_back(0);
+  b.pop_front();
+  EXPECT_EQ(b.try_append({1, 2, 3}), 3u);
+  EXPECT_EQ(b.try_append({4, 5, 6}), 1u);
+  EXPECT_THAT(b, ElementsAre(1, 2, 3, 4));
+  EXPECT_EQ(b.try_append({7}), 0u);
+  auto segments = b.segments();
+  EXPECT_THAT(segments.first, ElementsAre(1, 2, 3));
+  EXPECT_THAT(segments.second, ElementsAre(4));
+}
+
+TEST(CircularBufferTest, Iterators) {
+  absl::CircularBuffer<int, 5> b;
+  for (int i = 0; i < 8; ++i) b.push_back(i);
+  EXPECT_EQ(b.end() - b.begin(), 5);
+  EXPECT_EQ(b.begin()[2], 5);
+  absl::CircularBuffer<int, 5>::const_iterator it = b.begin();
+  EXPECT_TRUE(it == b.cbegin());
+  EXPECT_EQ(*(it + 4), 7);
+  EXPECT_THAT(std::vector<int>(b.rbegin(), b.rend()),
+              ElementsAre(7, 6, 5, 4, 3));
+  std::sort(b.begin(), b.end(), [](int x, int y) { return x > y; });
+  EXPECT_THAT(b, ElementsAre(7, 6, 5, 4, 3));
+}
+
+TEST(CircularBufferTest, IteratorAndReferenceValidity) {
+  absl::CircularBuffer<int, 4> b;
+  b.push_back(1);
+  b.push_back(2);
+  absl::CircularBuffer<int, 4>::iterator it = b.begin() + 1;
+  int& two = b[1];
+  // Appends that fit, and pop_back(), leave iterators short of end() valid.
+  b.push_back(3);
+  EXPECT_EQ(&*it, &two);
+  b.pop_back();
+  EXPECT_EQ(&*it, &two);
+  // References outlive removals from the front and overwrites of other
+  // elements; iterators don't, so they are taken again.
+  b.pop_front();
+  EXPECT_EQ(&b.front(), &two);
+  b.push_back(3);
+  b.push_back(4);
+  b.push_back(5);
+  int& three = b[1];
+  b.push_back(6);
+  EXPECT_EQ(&b.front(), &three);
+  EXPECT_EQ(&*b.begin(), &three);
+  EXPECT_THAT(b, ElementsAre(3, 4, 5, 6));
+}
+
+TEST(CircularBufferTest, At) {
+  absl::CircularBuffer<int, 2> b;
+  b.push_back(1);
+  EXPECT_EQ(b.at(0), 1);
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(b.at(1), std::out_of_range,
+                                 "failed bounds check");
+}
+
+TEST(CircularBufferTest, DynamicCapacity) {
+  absl::CircularBuffer<int> b(3);
+  EXPECT_EQ(b.capacity(), 3u);
+  for (int i = 0; i < 5; ++i) b.push_back(i);
+  EXPECT_THAT(b, ElementsAre(2, 3, 4));
+
+  b.set_capacity(5);
+  EXPECT_EQ(b.capacity(), 5u);
+  b.push_back(5);
+  EXPECT_THAT(b, ElementsAre(2, 3, 4, 5));
+
+  b.set_capacity(2);
+  EXPECT_THAT(b, ElementsAre(4, 5));
+
+  absl::CircularBuffer<int> empty;
+  EXPECT_EQ(empty.capacity(), 0u);
+  EXPECT_FALSE(empty.try_push_back(1));
+  EXPECT_EQ(empty.try_append({1, 2}), 0u);
+}
+
+TEST(CircularBufferTest, CopyAndMoveInline) {
+  absl::CircularBuffer<std::string, 3> b;
+  for (const char* s : {"a", "b", "c", "d"}) b.push_back(s);
+  absl::CircularBuffer<std::string, 3> copy(b);
+  EXPECT_EQ(copy, b);
+  copy.push_back("e");
+  EXPECT_NE(copy, b);
+  b = copy;
+  EXPECT_THAT(b, ElementsAre("c", "d", "e"));
+
+  absl::CircularBuffer<std::string, 3> moved(std::move(copy));
+  EXPECT_THAT(moved, ElementsAre("c", "d", "e"));
+  EXPECT_TRUE(copy.empty());  // NOLINT(bugprone-use-after-move)
+
+  absl::CircularBuffer<std::string, 3> other;
+  other.push_back("x");
+  swap(other, moved);
+  EXPECT_THAT(other, ElementsAre("c", "d", "e"));
+  EXPECT_THAT(moved, ElementsAre("x"));
+}
+
+TEST(CircularBufferTest, CopyAndMoveDynamic) {
+  absl::CircularBuffer<int> b(3);
+  b.append({1, 2, 3, 4});
+  absl::CircularBuffer<int> copy(b);
+  EXPECT_EQ(copy.capacity(), 3u);
+  EXPECT_EQ(copy, b);
+
+  absl::CircularBuffer<int> small(1);
+  small = b;
+  EXPECT_EQ(small.capacity(), 3u);
+  EXPECT_THAT(small, ElementsAre(2, 3, 4));
+
+  const int* p = &b[0];
+  absl::CircularBuffer<int> moved(std::move(b));
+  EXPECT_EQ(&moved[0], p);
+  EXPECT_EQ(b.capacity(), 0u);  // NOLINT(bugprone-use-after-move)
+
+  absl::CircularBuffer<int> other(10);
+  swap(other, moved);
+  EXPECT_EQ(&other[0], p);
+  EXPECT_EQ(moved.capacity(), 10u);
+}
+
+TEST(CircularBufferTest, ConstructsAndDestroysElements) {
+  InstanceTracker tracker;
+  {
+    absl::CircularBuffer<CopyableMovableInstance, 4> b;
+    for (int i = 0; i < 10; ++i) b.emplace_back(i);
+    EXPECT_EQ(tracker.instances(), 4);
+    EXPECT_EQ(b.front().value(), 6);
+    b.pop_front(2);
+    EXPECT_EQ(tracker.instances(), 2);
+
+    absl::CircularBuffer<CopyableMovableInstance> d(3);
+    d.emplace_back(1);
+    d.set_capacity(8);
+    EXPECT_EQ(tracker.instances(), 3);
+  }
+  EXPECT_EQ(tracker.instances(), 0);
+}
+
+}  // namespace
@@ -72,14 +72,19 @@ constexpr static auto kFixedArrayUseDefault = static_cast<size_t>(-1);
 // This matches the behavior of c-style arrays and `std::array`, but not
 // `std::vector`.
 //
-// Note that `FixedArray` does not provide a public allocator; if it requires a
-// heap allocation, it will do so with global `::operator new[]()` and
-// `::operator delete[]()`, even if T provides class-scope overrides for these
-// operators.
-template <typename T, size_t inlined = kFixedArrayUseDefault>
+// Arrays too large to be stored inline are allocated with the allocator `A`,
+// which defaults to `std::allocator<T>`. The allocator only provides memory:
+// elements are always constructed and destroyed in place, without going
+// through `std::allocator_traits<A>::construct()` and `destroy()`. An
+// `absl::ArenaAllocator` (see absl/memory/arena.h) lets short-lived arrays that
+// outgrow their inline space come from an arena rather than the heap.
+template <typename T, size_t inlined = kFixedArrayUseDefault,
+          typename A = std::allocator<T>>
 class FixedArray {
   static constexpr size_t kInlineBytesDefault = 256;
 
+  using AllocatorTraits = std::allocator_traits<A>;
+
   // std::iterator_traits isn't guaranteed to be SFINAE-friendly until C++17,
   // but this seems to be mostly pedantic.
   template <typename Iter>
@@ -92,6 +97,7 @@ class FixedArray {
  public:
   // For playing nicely with stl:
   using value_type = T;
+  using allocator_type = A;
   using iterator = T*;
   using const_iterator = const T*;
   using reverse_iterator = std::reverse_iterator<iterator>;
@@ -108,31 +114,40 @@ class FixedArray {
           ? kInlineBytesDefault / sizeof(value_type)
           : inlined;
 
-  FixedArray(const FixedArray& other) : rep_(other.begin(), other.end()) {}
+  FixedArray(const FixedArray& other)
+      : FixedArray(other, AllocatorTraits::select_on_container_copy_construction(
+                              other.get_allocator())) {}
+  FixedArray(const FixedArray& other, const allocator_type& a)
+      : rep_(other.begin(), other.end(), a) {}
   FixedArray(FixedArray&& other) noexcept(
   // clang-format off
-      absl::allocator_is_nothrow<std::allocator<value_type>>::value &&
+      absl::allocator_is_nothrow<allocator_type>::value &&
   // clang-format on
           std::is_nothrow_move_constructible<value_type>::value)
       : rep_(std::make_move_iterator(other.begin()),
-             std::make_move_iterator(other.end())) {}
+             std::make_move_iterator(other.end()), other.get_allocator()) {}
 
   // Creates an array object that can store `n` elements.
   // Note that trivially constructible elements will be uninitialized.
-  explicit FixedArray(size_type n) : rep_(n) {}
+  explicit FixedArray(size_type n, const allocator_type& a = allocator_type())
+      : rep_(n, a) {}
 
   // Creates an array initialized with `n` copies of `val`.
-  FixedArray(size_type n, const value_type& val) : rep_(n, val) {}
+  FixedArray(size_type n, const value_type& val,
+             const allocator_type& a = allocator_type())
+      : rep_(n, val, a) {}
 
   // Creates an array initialized with the elements from the input
   // range. The array's size will always be `std::distance(first, last)`.
   // REQUIRES: Iter must be a forward_iterator or better.
   template <typename Iter, EnableIfForwardIterator<Iter> = 0>
-  FixedArray(Iter first, Iter last) : rep_(first, last) {}
+  FixedArray(Iter first, Iter last, const allocator_type& a = allocator_type())
+      : rep_(first, last, a) {}
 
   // Creates the array from an initializer_list.
-  FixedArray(std::initializer_list<T> init_list)
-      : FixedArray(init_list.begin(), init_list.end()) {}
+  FixedArray(std::initializer_list<T> init_list,
+             const allocator_type& a = allocator_type())
+      : FixedArray(init_list.begin(), init_list.end(), a) {}
 
   ~FixedArray() {}
 
@@ -141,6 +156,11 @@ class FixedArray {
   void operator=(FixedArray&&) = delete;
   void operator=(const FixedArray&) = delete;
 
+  // FixedArray::get_allocator()
+  //
+  // Returns a copy of the allocator that the fixed array allocates with.
+  allocator_type get_allocator() const { return rep_.get_allocator(); }
+
   // FixedArray::size()
   //
   // Returns the length of the fixed array.
@@ -429,17 +449,55 @@ class FixedArray {
     void AnnotateDestruct(size_t) const {}
   };
 
+  // The allocator, rebound to allocate `Holder`s.
+  using HolderAllocator =
+      typename AllocatorTraits::template rebind_alloc<Holder>;
+  using HolderAllocatorTraits = std::allocator_traits<HolderAllocator>;
+
+  // AllocatorStorage
+  //
+  // Holds an allocator as a base class, so that it takes no space when it is
+  // empty. An allocator that isn't empty, or is final and so can't be
+  // derived from, is held as a member instead.
+  //
+  // NOTE: __is_final is a compiler extension, as std::is_final is C++14.
+  template <typename Alloc,
+            bool = std::is_empty<Alloc>::value && !__is_final(Alloc)>
+  class AllocatorStorage : private Alloc {
+   public:
+    explicit AllocatorStorage(const Alloc& a) : Alloc(a) {}
+    Alloc& allocator() { return *this; }
+    const Alloc& allocator() const { return *this; }
+  };
+
+  template <typename Alloc>
+  class AllocatorStorage<Alloc, false> {
+   public:
+    explicit AllocatorStorage(const Alloc& a) : alloc_(a) {}
+    Alloc& allocator() { return alloc_; }
+    const Alloc& allocator() const { return alloc_; }
+
+   private:
+    Alloc alloc_;
+  };
+
   // Rep
   //
-  // A const Rep object holds FixedArray's size and data pointer.
+  // A const Rep object holds FixedArray's size and data pointer, and the
+  // allocator, which takes no space when it is empty.
   //
-  class Rep : public InlineSpace<inline_elements> {
+  class Rep : public InlineSpace<inline_elements>,
+              private AllocatorStorage<HolderAllocator> {
+    using AllocatorBase = AllocatorStorage<HolderAllocator>;
+
    public:
-    Rep(size_type n, const value_type& val) : n_(n), p_(MakeHolder(n)) {
+    Rep(size_type n, const value_type& val, const allocator_type& a)
+        : AllocatorBase(HolderAllocator(a)), n_(n), p_(MakeHolder(n)) {
       std::uninitialized_fill_n(p_, n, val);
     }
 
-    explicit Rep(size_type n) : n_(n), p_(MakeHolder(n)) {
+    Rep(size_type n, const allocator_type& a)
+        : AllocatorBase(HolderAllocator(a)), n_(n), p_(MakeHolder(n)) {
       // Loop optimizes to nothing for trivially constructible T.
       for (Holder* p = p_; p != p_ + n; ++p)
         // Note: no parens: default init only.
@@ -448,8 +506,10 @@ class FixedArray {
     }
 
     template <typename Iter>
-    Rep(Iter first, Iter last)
-        : n_(std::distance(first, last)), p_(MakeHolder(n_)) {
+    Rep(Iter first, Iter last, const allocator_type& a)
+        : AllocatorBase(HolderAllocator(a)),
+          n_(std::distance(first, last)),
+          p_(MakeHolder(n_)) {
       std::uninitialized_copy(first, last, AsValue(p_));
     }
 
@@ -458,7 +518,7 @@ class FixedArray {
       // Loop optimizes to nothing for trivially destructible T.
       for (Holder* p = end(); p != begin();) (--p)->~Holder();
       if (IsAllocated(size())) {
-        ::operator delete[](begin());
+        HolderAllocatorTraits::deallocate(allocator(), begin(), size());
       } else {
         this->AnnotateDestruct(size());
       }
@@ -466,8 +526,11 @@ class FixedArray {
     Holder* begin() const { return p_; }
     Holder* end() const { return p_ + n_; }
     size_type size() const { return n_; }
+    allocator_type get_allocator() const { return allocator_type(allocator()); }
 
    private:
+    using AllocatorBase::allocator;
+
     Holder* MakeHolder(size_type n) {
       if (IsAllocated(n)) {
         return Allocate(n);
@@ -478,7 +541,7 @@ class FixedArray {
     }
 
     Holder* Allocate(size_type n) {
-      return static_cast<Holder*>(::operator new[](n * sizeof(Holder)));
+      return HolderAllocatorTraits::allocate(allocator(), n);
     }
 
     bool IsAllocated(size_type n) const { return n > inline_elements; }
@@ -492,11 +555,11 @@ class FixedArray {
   Rep rep_;
 };
 
-template <typename T, size_t N>
-constexpr size_t FixedArray<T, N>::inline_elements;
+template <typename T, size_t N, typename A>
+constexpr size_t FixedArray<T, N, A>::inline_elements;
 
-template <typename T, size_t N>
-constexpr size_t FixedArray<T, N>::kInlineBytesDefault;
+template <typename T, size_t N, typename A>
+constexpr size_t FixedArray<T, N, A>::kInlineBytesDefault;
 
 }  // namespace absl
 #endif  // ABSL_CONTAINER_FIXED_ARRAY_H_
@@ -15,6 +15,7 @@
 #include "absl/container/fixed_array.h"
 
 #include <stdio.h>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <numeric>
@@ -25,6 +26,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/base/internal/exception_testing.h"
+#include "absl/memory/arena.h"
 #include "absl/memory/memory.h"
 
 using ::testing::ElementsAreArray;
@@ -504,6 +506,128 @@ struct PickyDelete {
 
 TEST(FixedArrayTest, UsesGlobalAlloc) { absl::FixedArray<PickyDelete, 0> a(5); }
 
+// CountingAllocator counts the bytes it has allocated and not yet freed.
+template <typename T>
+class CountingAllocator : public std::allocator<T> {
+ public:
+  template <typename U>
+  struct rebind {
+    using other = CountingAllocator<U>;
+  };
+
+  explicit CountingAllocator(int64_t* bytes) : bytes_(bytes) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other)  // NOLINT
+      : bytes_(other.bytes_) {}
+
+  T* allocate(size_t n) {
+    *bytes_ += n * sizeof(T);
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    *bytes_ -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  template <typename U>
+  friend class CountingAllocator;
+
+  friend bool operator==(const CountingAllocator& a,
+                         const CountingAllocator& b) {
+    return a.bytes_ == b.bytes_;
+  }
+  friend bool operator!=(const CountingAllocator& a,
+                         const CountingAllocator& b) {
+    return !(a == b);
+  }
+
+ private:
+  int64_t* bytes_;
+};
+
+TEST(AllocatorSupportTest, CountingAllocator) {
+  using Alloc = CountingAllocator<int>;
+  using AllocFxdArr = absl::FixedArray<int, 4, Alloc>;
+  int64_t allocated = 0;
+  {
+    AllocFxdArr inlined(3, 7, Alloc(&allocated));
+    EXPECT_EQ(allocated, 0);
+    EXPECT_THAT(inlined, ElementsAreArray({7, 7, 7}));
+
+    AllocFxdArr heap({1, 2, 3, 4, 5, 6}, Alloc(&allocated));
+    EXPECT_EQ(allocated, 6 * sizeof(int));
+    EXPECT_THAT(heap, ElementsAreArray({1, 2, 3, 4, 5, 6}));
+    EXPECT_TRUE(heap.get_allocator() == Alloc(&allocated));
+
+    AllocFxdArr copy(heap);
+    EXPECT_EQ(allocated, 12 * sizeof(int));
+    EXPECT_TRUE(copy.get_allocator() == Alloc(&allocated));
+
+    int64_t other_allocated = 0;
+    AllocFxdArr other_copy(heap, Alloc(&other_allocated));
+    EXPECT_EQ(allocated, 12 * sizeof(int));
+    EXPECT_EQ(other_allocated, 6 * sizeof(int));
+
+    AllocFxdArr moved(std::move(copy));
+    EXPECT_EQ(allocated, 18 * sizeof(int));
+  }
+  EXPECT_EQ(allocated, 0);
+}
+
+TEST(AllocatorSupportTest, ArrayOfArrays) {
+  using Alloc = CountingAllocator<int[2]>;
+  int64_t allocated = 0;
+  {
+    absl::FixedArray<int[2], 1, Alloc> a(3, Alloc(&allocated));
+    EXPECT_EQ(allocated, 3 * sizeof(int[2]));
+    a[2][1] = 5;
+    EXPECT_EQ(a.data()[2][1], 5);
+  }
+  EXPECT_EQ(allocated, 0);
+}
+
+TEST(AllocatorSupportTest, ArenaAllocator) {
+  absl::Arena arena;
+  using Alloc = absl::ArenaAllocator<std::string>;
+  absl::FixedArray<std::string, 2, Alloc> a(
+      {"first", "second", "a string long enough to allocate"}, Alloc(&arena));
+  EXPECT_EQ(arena.bytes_allocated(), 3 * sizeof(std::string));
+  EXPECT_EQ(a[2], "a string long enough to allocate");
+  EXPECT_EQ(a.get_allocator().arena(), &arena);
+
+  absl::FixedArray<std::string, 2, Alloc> inlined(2, "x", Alloc(&arena));
+  EXPECT_EQ(arena.bytes_allocated(), 3 * sizeof(std::string));
+  EXPECT_THAT(inlined, ElementsAreArray({"x", "x"}));
+}
+
+TEST(AllocatorSupportTest, SizeofUnchangedByDefaultAllocator) {
+  EXPECT_EQ(sizeof(absl::FixedArray<int, 0>),
+            sizeof(absl::FixedArray<int, 0, std::allocator<int>>));
+  EXPECT_EQ(sizeof(absl::FixedArray<int, 0>), 2 * sizeof(void*));
+}
+
+// An empty allocator that can't be derived from.
+template <typename T>
+class FinalAllocator final : public std::allocator<T> {
+ public:
+  template <typename U>
+  struct rebind {
+    using other = FinalAllocator<U>;
+  };
+
+  FinalAllocator() = default;
+  template <typename U>
+  FinalAllocator(const FinalAllocator<U>&) {}  // NOLINT
+};
+
+TEST(AllocatorSupportTest, FinalAllocator) {
+  using Alloc = FinalAllocator<int>;
+  absl::FixedArray<int, 2, Alloc> allocated(4, 7);
+  EXPECT_THAT(allocated, ElementsAreArray({7, 7, 7, 7}));
+  absl::FixedArray<int, 2, Alloc> inlined(2, 3, allocated.get_allocator());
+  EXPECT_THAT(inlined, ElementsAreArray({3, 3}));
+}
+
 TEST(FixedArrayTest, Data) {
   static const int kInput[] = { 2, 3, 5, 7, 11, 13, 17 };
   absl::FixedArray<int> fa(std::begin(kInput), std::end(kInput));
@@ -0,0 +1,93 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: flat_hash_map.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::flat_hash_map<K, V>` is an unordered associative container,
+// designed to be a faster, more memory-efficient replacement for
+// `std::unordered_map`. It stores its `std::pair<const K, V>` elements in one
+// open-addressing array, with a byte of metadata per slot, and probes the
+// metadata of up to 16 slots at once.
+//
+// Unlike `std::unordered_map`:
+//
+//   * Elements are moved when the map rehashes, so neither pointers nor
+//     iterators to them are stable across insertions. For pointer
+//     stability, use `absl::node_hash_map`.
+//   * `erase(iterator)` returns nothing; see `raw_hash_set::erase()`.
+//   * `max_load_factor()` is fixed.
+//
+// Maps keyed by `std::string` and `absl::string_view` look up any string-like
+// key without converting it; see `hash_function_defaults.h`.
+//
+// Example:
+//
+//   absl::flat_hash_map<std::string, int> ages = {{"huey", 8}};
+//   ages["dewey"] = 8;
+//   auto it = ages.find("huey");
+
+#ifndef ABSL_CONTAINER_FLAT_HASH_MAP_H_
+#define ABSL_CONTAINER_FLAT_HASH_MAP_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/container/internal/container_memory.h"
+#include "absl/container/internal/hash_function_defaults.h"
+#include "absl/container/internal/raw_hash_map.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class K, class V>
+struct FlatHashMapPolicy : map_slot_policy<K, V> {
+  using key_type = K;
+  using mapped_type = V;
+  using init_type = std::pair<K, V>;
+  static constexpr bool kConstantIterators = false;
+
+  template <class P>
+  static const K& key(const P& p) {
+    return p.first;
+  }
+};
+
+}  // namespace container_internal
+
+// -----------------------------------------------------------------------------
+// absl::flat_hash_map
+// -----------------------------------------------------------------------------
+//
+// The interface is that of `std::unordered_map`, less the bucket interface,
+// plus `contains()`. Lookups take any key type when both `Hash` and `Eq`
+// define `is_transparent`.
+template <class K, class V,
+          class Hash = container_internal::hash_default_hash<K>,
+          class Eq = container_internal::hash_default_eq<K>,
+          class Allocator = std::allocator<std::pair<const K, V>>>
+class flat_hash_map : public container_internal::raw_hash_map<
+                          container_internal::FlatHashMapPolicy<K, V>, Hash,
+                          Eq, Allocator> {
+  using Base = typename flat_hash_map::raw_hash_map;
+
+ public:
+  flat_hash_map() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_FLAT_HASH_MAP_H_
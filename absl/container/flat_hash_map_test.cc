@@ -0,0 +1,134 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/flat_hash_map.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/internal/test_instance_tracker.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::absl::test_internal::CopyableMovableInstance;
+using ::absl::test_internal::InstanceTracker;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(FlatHashMap, InsertFindErase) {
+  absl::flat_hash_map<int, std::string> m;
+  EXPECT_TRUE(m.insert({1, "one"}).second);
+  EXPECT_FALSE(m.insert({1, "uno"}).second);
+  EXPECT_TRUE(m.emplace(2, "two").second);
+  EXPECT_TRUE(m.insert(std::make_pair(3, "three")).second);
+  EXPECT_THAT(m, UnorderedElementsAre(Pair(1, "one"), Pair(2, "two"),
+                                      Pair(3, "three")));
+  EXPECT_EQ("two", m.find(2)->second);
+  EXPECT_EQ(1, m.erase(2));
+  EXPECT_TRUE(m.find(2) == m.end());
+}
+
+TEST(FlatHashMap, Subscript) {
+  absl::flat_hash_map<std::string, int> m;
+  m["a"] = 1;
+  ++m["a"];
+  ++m[std::string("b")];
+  EXPECT_THAT(m, UnorderedElementsAre(Pair("a", 2), Pair("b", 1)));
+}
+
+TEST(FlatHashMap, At) {
+  absl::flat_hash_map<int, int> m = {{1, 10}};
+  EXPECT_EQ(10, m.at(1));
+  const auto& cm = m;
+  EXPECT_EQ(10, cm.at(1));
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(m.at(2), std::out_of_range,
+                                 "raw_hash_map<>::at");
+}
+
+TEST(FlatHashMap, TryEmplace) {
+  absl::flat_hash_map<int, std::unique_ptr<int>> m;
+  std::unique_ptr<int> p(new int(1));
+  EXPECT_TRUE(m.try_emplace(1, std::move(p)).second);
+  EXPECT_EQ(nullptr, p);
+  std::unique_ptr<int> q(new int(2));
+  // A present key leaves the arguments alone.
+  EXPECT_FALSE(m.try_emplace(1, std::move(q)).second);
+  EXPECT_NE(nullptr, q);
+  EXPECT_EQ(1, *m[1]);
+}
+
+TEST(FlatHashMap, InsertOrAssign) {
+  absl::flat_hash_map<std::string, int> m;
+  EXPECT_TRUE(m.insert_or_assign("a", 1).second);
+  EXPECT_FALSE(m.insert_or_assign("a", 2).second);
+  const std::string b = "b";
+  int three = 3;
+  EXPECT_TRUE(m.insert_or_assign(b, three).second);
+  EXPECT_THAT(m, UnorderedElementsAre(Pair("a", 2), Pair("b", 3)));
+}
+
+TEST(FlatHashMap, HeterogeneousStringLookup) {
+  absl::flat_hash_map<std::string, int> m = {{"huey", 1}, {"dewey", 2}};
+  EXPECT_EQ(1, m.find("huey")->second);
+  EXPECT_EQ(2, m.at(absl::string_view("dewey")));
+  EXPECT_EQ(0, m.count("louie"));
+  // Only the key is converted, and only when inserted.
+  m.try_emplace(absl::string_view("louie"), 3);
+  EXPECT_EQ(3, m["louie"]);
+}
+
+TEST(FlatHashMap, RehashMovesKeys) {
+  // Growing moves each element once, keys included.
+  InstanceTracker tracker;
+  struct Hash {
+    size_t operator()(const CopyableMovableInstance& v) const {
+      return std::hash<int>()(v.value());
+    }
+  };
+  struct Eq {
+    bool operator()(const CopyableMovableInstance& a,
+                    const CopyableMovableInstance& b) const {
+      return a.value() == b.value();
+    }
+  };
+  absl::flat_hash_map<CopyableMovableInstance, int, Hash, Eq> m;
+  for (int i = 0; i < 100; ++i) m.try_emplace(CopyableMovableInstance(i), i);
+  tracker.ResetCopiesMovesSwaps();
+  m.reserve(1000);
+  EXPECT_EQ(0, tracker.copies());
+  EXPECT_EQ(100, tracker.moves());
+}
+
+TEST(FlatHashMap, IterationMutatesValues) {
+  absl::flat_hash_map<int, int> m;
+  for (int i = 0; i < 100; ++i) m[i] = i;
+  for (auto& kv : m) kv.second *= 2;
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(2 * i, m[i]);
+}
+
+TEST(FlatHashMap, Equality) {
+  absl::flat_hash_map<int, int> a = {{1, 1}, {2, 2}};
+  absl::flat_hash_map<int, int> b = {{2, 2}, {1, 1}};
+  EXPECT_TRUE(a == b);
+  b[2] = 3;
+  EXPECT_TRUE(a != b);
+}
+
+}  // namespace
@@ -0,0 +1,87 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: flat_hash_set.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::flat_hash_set<T>` is an unordered associative container of
+// unique values, designed to be a faster, more memory-efficient replacement
+// for `std::unordered_set`. It stores its values in one open-addressing
+// array, with a byte of metadata per slot, and probes the metadata of up to
+// 16 slots at once.
+//
+// Unlike `std::unordered_set`:
+//
+//   * Values are moved when the set rehashes, so neither pointers nor
+//     iterators to them are stable across insertions. For pointer
+//     stability, use `absl::node_hash_set`.
+//   * `erase(iterator)` returns nothing; see `raw_hash_set::erase()`.
+//   * `max_load_factor()` is fixed.
+//
+// Sets of `std::string` and `absl::string_view` look up any string-like key
+// without converting it; see `hash_function_defaults.h`.
+//
+// Example:
+//
+//   absl::flat_hash_set<std::string> ducks = {"huey", "dewey"};
+//   ducks.insert("louie");
+//   if (ducks.contains("dewey")) ...
+
+#ifndef ABSL_CONTAINER_FLAT_HASH_SET_H_
+#define ABSL_CONTAINER_FLAT_HASH_SET_H_
+
+#include <memory>
+
+#include "absl/container/internal/container_memory.h"
+#include "absl/container/internal/hash_function_defaults.h"
+#include "absl/container/internal/raw_hash_set.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class T>
+struct FlatHashSetPolicy : set_slot_policy<T> {
+  using key_type = T;
+  using init_type = T;
+  static constexpr bool kConstantIterators = true;
+
+  static const T& key(const T& v) { return v; }
+};
+
+}  // namespace container_internal
+
+// -----------------------------------------------------------------------------
+// absl::flat_hash_set
+// -----------------------------------------------------------------------------
+//
+// The interface is that of `std::unordered_set`, less the bucket interface,
+// plus `contains()`. Lookups take any key type when both `Hash` and `Eq`
+// define `is_transparent`.
+template <class T, class Hash = container_internal::hash_default_hash<T>,
+          class Eq = container_internal::hash_default_eq<T>,
+          class Allocator = std::allocator<T>>
+class flat_hash_set
+    : public container_internal::raw_hash_set<
+          container_internal::FlatHashSetPolicy<T>, Hash, Eq, Allocator> {
+  using Base = typename flat_hash_set::raw_hash_set;
+
+ public:
+  flat_hash_set() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_FLAT_HASH_SET_H_
@@ -0,0 +1,213 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/flat_hash_set.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/internal/test_instance_tracker.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::absl::test_internal::CopyableMovableInstance;
+using ::absl::test_internal::InstanceTracker;
+using ::absl::test_internal::MovableOnlyInstance;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+TEST(FlatHashSet, InsertFindErase) {
+  absl::flat_hash_set<int> s;
+  EXPECT_TRUE(s.insert(1).second);
+  EXPECT_FALSE(s.insert(1).second);
+  EXPECT_TRUE(s.emplace(2).second);
+  EXPECT_THAT(s, UnorderedElementsAre(1, 2));
+  EXPECT_EQ(1, *s.find(1));
+  EXPECT_EQ(1, s.count(2));
+  EXPECT_EQ(0, s.count(3));
+  EXPECT_EQ(1, s.erase(1));
+  EXPECT_THAT(s, UnorderedElementsAre(2));
+}
+
+TEST(FlatHashSet, Constructors) {
+  std::vector<int> values = {1, 2, 3, 2, 1};
+  absl::flat_hash_set<int> from_range(values.begin(), values.end());
+  EXPECT_THAT(from_range, UnorderedElementsAre(1, 2, 3));
+  absl::flat_hash_set<int> from_list = {4, 5, 6};
+  EXPECT_THAT(from_list, UnorderedElementsAre(4, 5, 6));
+  absl::flat_hash_set<int> with_buckets(100);
+  EXPECT_TRUE(with_buckets.empty());
+  EXPECT_GE(with_buckets.bucket_count(), 100);
+}
+
+TEST(FlatHashSet, HeterogeneousStringLookup) {
+  absl::flat_hash_set<std::string> s = {"huey", "dewey"};
+  EXPECT_TRUE(s.contains("huey"));
+  EXPECT_TRUE(s.contains(absl::string_view("dewey")));
+  EXPECT_FALSE(s.contains("louie"));
+  const char buf[] = "dewey and louie";
+  EXPECT_EQ("dewey", *s.find(absl::string_view(buf, 5)));
+  EXPECT_EQ(1, s.erase(absl::string_view("huey")));
+  EXPECT_THAT(s, UnorderedElementsAre("dewey"));
+
+  absl::flat_hash_set<absl::string_view> views = {"a", "bc"};
+  EXPECT_TRUE(views.contains(std::string("bc")));
+}
+
+TEST(FlatHashSet, ManyStrings) {
+  absl::flat_hash_set<std::string> s;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 10000; ++i) {
+    expected.push_back(std::to_string(i * 7919));
+    s.insert(expected.back());
+  }
+  EXPECT_THAT(s, UnorderedElementsAreArray(expected));
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_FALSE(s.contains(std::to_string(i * 7919 + 1)));
+  }
+}
+
+TEST(FlatHashSet, MoveOnlyValues) {
+  absl::flat_hash_set<std::unique_ptr<int>> s;
+  for (int i = 0; i < 100; ++i) s.insert(std::unique_ptr<int>(new int(i)));
+  EXPECT_EQ(100, s.size());
+  int sum = 0;
+  for (const auto& p : s) sum += *p;
+  EXPECT_EQ(4950, sum);
+}
+
+struct TrackedHash {
+  size_t operator()(const CopyableMovableInstance& v) const {
+    return std::hash<int>()(v.value());
+  }
+};
+
+struct TrackedEq {
+  bool operator()(const CopyableMovableInstance& a,
+                  const CopyableMovableInstance& b) const {
+    return a.value() == b.value();
+  }
+};
+
+TEST(FlatHashSet, DestroysEveryElement) {
+  InstanceTracker tracker;
+  {
+    absl::flat_hash_set<CopyableMovableInstance, TrackedHash, TrackedEq> s;
+    for (int i = 0; i < 1000; ++i) s.emplace(i);
+    for (int i = 0; i < 1000; i += 3) s.erase(CopyableMovableInstance(i));
+    EXPECT_EQ(666, tracker.live_instances());
+    auto copy = s;
+    EXPECT_EQ(2 * 666, tracker.live_instances());
+    s.clear();
+    EXPECT_EQ(666, tracker.live_instances());
+  }
+  EXPECT_EQ(0, tracker.instances());
+}
+
+TEST(FlatHashSet, InsertMovesAndCopiesOnce) {
+  InstanceTracker tracker;
+  absl::flat_hash_set<CopyableMovableInstance, TrackedHash, TrackedEq> s;
+  s.reserve(10);
+  CopyableMovableInstance v(1);
+  tracker.ResetCopiesMovesSwaps();
+  s.insert(v);
+  EXPECT_EQ(1, tracker.copies());
+  EXPECT_EQ(0, tracker.moves());
+  s.insert(CopyableMovableInstance(2));
+  EXPECT_EQ(1, tracker.copies());
+  EXPECT_EQ(1, tracker.moves());
+  // A present value is neither copied nor moved.
+  s.insert(v);
+  EXPECT_EQ(1, tracker.copies());
+  EXPECT_EQ(1, tracker.moves());
+}
+
+// Counts the live bytes allocated through it.
+template <class T>
+struct CountingAllocator : std::allocator<T> {
+  template <class U>
+  struct rebind {
+    using other = CountingAllocator<U>;
+  };
+
+  explicit CountingAllocator(int64_t* bytes) : bytes(bytes) {}
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>& x) : bytes(x.bytes) {}
+
+  T* allocate(size_t n) {
+    *bytes += n * sizeof(T);
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    *bytes -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  template <class U>
+  friend bool operator==(const CountingAllocator& a,
+                         const CountingAllocator<U>& b) {
+    return a.bytes == b.bytes;
+  }
+  template <class U>
+  friend bool operator!=(const CountingAllocator& a,
+                         const CountingAllocator<U>& b) {
+    return a.bytes != b.bytes;
+  }
+
+  int64_t* bytes;
+};
+
+TEST(FlatHashSet, AllocatesThroughAllocator) {
+  int64_t bytes = 0;
+  {
+    absl::flat_hash_set<int64_t, std::hash<int64_t>, std::equal_to<int64_t>,
+                        CountingAllocator<int64_t>>
+        s(0, std::hash<int64_t>(), std::equal_to<int64_t>(),
+          CountingAllocator<int64_t>(&bytes));
+    for (int64_t i = 0; i < 1000; ++i) s.insert(i);
+    // About 9 bytes per slot, at a load of at least 7/16.
+    EXPECT_GE(bytes, 1000 * 9);
+    EXPECT_LE(bytes, 1000 * 9 * 16 / 7 + 64);
+  }
+  EXPECT_EQ(0, bytes);
+}
+
+TEST(FlatHashSet, MoveOnlyInstances) {
+  InstanceTracker tracker;
+  struct Hash {
+    size_t operator()(const MovableOnlyInstance& v) const {
+      return std::hash<int>()(v.value());
+    }
+  };
+  struct Eq {
+    bool operator()(const MovableOnlyInstance& a,
+                    const MovableOnlyInstance& b) const {
+      return a.value() == b.value();
+    }
+  };
+  {
+    absl::flat_hash_set<MovableOnlyInstance, Hash, Eq> s;
+    for (int i = 0; i < 100; ++i) s.insert(MovableOnlyInstance(i));
+    absl::flat_hash_set<MovableOnlyInstance, Hash, Eq> moved = std::move(s);
+    EXPECT_EQ(100, moved.size());
+    EXPECT_EQ(100, tracker.live_instances());
+  }
+  EXPECT_EQ(0, tracker.instances());
+}
+
+}  // namespace
@@ -0,0 +1,64 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: flat_map.h
+// -----------------------------------------------------------------------------
+//
+// `absl::flat_map<K, V>` is an ordered container with the interface of
+// `std::map`, plus `contains()`, stored as a sorted sequence of pairs in a
+// contiguous container; see `flat_set.h`. As there, inserting or erasing one
+// element takes linear time and invalidates all iterators, pointers and
+// references into the container.
+//
+// The elements are `std::pair<K, V>`, not `std::pair<const K, V>`, since they
+// are moved when others are inserted or erased. Do not modify keys through
+// iterators.
+//
+// Example:
+//
+//   // Built once from unsorted input; lookups are binary searches.
+//   const absl::flat_map<int, std::string> codes = {
+//       {404, "Not Found"}, {200, "OK"}, {500, "Internal Server Error"}};
+//   auto it = codes.find(status);
+
+#ifndef ABSL_CONTAINER_FLAT_MAP_H_
+#define ABSL_CONTAINER_FLAT_MAP_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/internal/flat_container.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// absl::flat_map
+// -----------------------------------------------------------------------------
+template <class Key, class Value, class Compare = std::less<Key>,
+          class Container = std::vector<std::pair<Key, Value>>>
+class flat_map : public container_internal::flat_map_container<
+                     container_internal::flat_map_params<Key, Value>, Compare,
+                     Container> {
+  using Base = typename flat_map::flat_map_container;
+
+ public:
+  flat_map() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_FLAT_MAP_H_
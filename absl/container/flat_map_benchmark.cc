@@ -0,0 +1,82 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_map.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Keys spread out so that about half the lookups miss.
+std::vector<int> MakeKeys(int n) {
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; ++i) keys[i] = 2 * i;
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+  return keys;
+}
+
+template <class Map>
+void BM_Find(benchmark::State& state) {
+  const int n = state.range(0);
+  Map m;
+  for (int key : MakeKeys(n)) m.emplace(key, key);
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> key(0, 2 * n);
+  std::vector<int> lookups(1024);
+  for (int& k : lookups) k = key(rng);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(m.find(lookups[i++ % lookups.size()]));
+  }
+}
+BENCHMARK_TEMPLATE(BM_Find, std::map<int, int>)->Range(8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_Find, absl::flat_map<int, int>)->Range(8, 1 << 14);
+
+template <class Map>
+void BM_BuildFromUnsorted(benchmark::State& state) {
+  const int n = state.range(0);
+  std::vector<std::pair<int, int>> input;
+  for (int key : MakeKeys(n)) input.emplace_back(key, key);
+  for (auto _ : state) {
+    Map m(input.begin(), input.end());
+    benchmark::DoNotOptimize(m);
+  }
+}
+BENCHMARK_TEMPLATE(BM_BuildFromUnsorted, std::map<int, int>)
+    ->Range(8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_BuildFromUnsorted, absl::flat_map<int, int>)
+    ->Range(8, 1 << 14);
+
+// Walks all elements, as when dumping a table.
+template <class Map>
+void BM_Iterate(benchmark::State& state) {
+  const int n = state.range(0);
+  Map m;
+  for (int key : MakeKeys(n)) m.emplace(key, key);
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto& kv : m) sum += kv.second;
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK_TEMPLATE(BM_Iterate, std::map<int, int>)->Arg(1 << 10);
+BENCHMARK_TEMPLATE(BM_Iterate, absl::flat_map<int, int>)->Arg(1 << 10);
+
+}  // namespace
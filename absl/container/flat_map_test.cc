@@ -0,0 +1,129 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/flat_map.h"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::Pair;
+
+TEST(FlatMapTest, BuildsFromUnsortedInput) {
+  // Of equivalent keys, the first one wins.
+  const absl::flat_map<int, std::string> m = {
+      {3, "c"}, {1, "a"}, {2, "b"}, {1, "x"}};
+  EXPECT_THAT(m, ElementsAre(Pair(1, "a"), Pair(2, "b"), Pair(3, "c")));
+  EXPECT_EQ(m.at(2), "b");
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(m.at(4), std::out_of_range,
+                                 "absl::flat_map::at");
+}
+
+TEST(FlatMapTest, SubscriptTryEmplaceInsertOrAssign) {
+  absl::flat_map<std::string, int> m;
+  m["b"] = 2;
+  m["a"] = 1;
+  ++m["b"];
+  EXPECT_THAT(m, ElementsAre(Pair("a", 1), Pair("b", 3)));
+
+  auto res = m.try_emplace("a", 7);
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(res.first->second, 1);
+  res = m.try_emplace("c", 7);
+  EXPECT_TRUE(res.second);
+  EXPECT_EQ(res.first->second, 7);
+
+  res = m.insert_or_assign("a", 10);
+  EXPECT_FALSE(res.second);
+  res = m.insert_or_assign("d", 4);
+  EXPECT_TRUE(res.second);
+  EXPECT_THAT(m, ElementsAre(Pair("a", 10), Pair("b", 3), Pair("c", 7),
+                             Pair("d", 4)));
+
+  // Mapped values can be changed through iterators.
+  m.find("c")->second = 8;
+  EXPECT_EQ(m.at("c"), 8);
+}
+
+TEST(FlatMapTest, TryEmplaceLeavesArgumentsIfPresent) {
+  absl::flat_map<int, std::unique_ptr<int>> m;
+  std::unique_ptr<int> p(new int(1));
+  EXPECT_TRUE(m.try_emplace(1, std::move(p)).second);
+  EXPECT_EQ(p, nullptr);
+  p.reset(new int(2));
+  EXPECT_FALSE(m.try_emplace(1, std::move(p)).second);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(*m.at(1), 1);
+}
+
+TEST(FlatMapTest, BatchInsertMatchesStdMap) {
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> key(0, 499);
+  absl::flat_map<int, int> m;
+  std::map<int, int> expected;
+  int next = 0;
+  for (int batch = 0; batch < 40; ++batch) {
+    std::vector<std::pair<int, int>> values(batch);
+    for (auto& kv : values) kv = {key(rng), next++};
+    m.insert(values.begin(), values.end());
+    expected.insert(values.begin(), values.end());
+    ASSERT_THAT(m, ElementsAreArray(expected));
+  }
+}
+
+struct TransparentLess {
+  using is_transparent = void;
+  bool operator()(absl::string_view a, absl::string_view b) const {
+    return a < b;
+  }
+};
+
+TEST(FlatMapTest, HeterogeneousLookup) {
+  absl::flat_map<std::string, int, TransparentLess> m = {{"x", 1}, {"y", 2}};
+  const absl::string_view key = "y";
+  EXPECT_EQ(m.at(key), 2);
+  EXPECT_EQ(m.find(key)->second, 2);
+  EXPECT_TRUE(m.contains(absl::string_view("x")));
+  m[absl::string_view("z")] = 3;
+  EXPECT_EQ(m.at("z"), 3);
+  EXPECT_TRUE(m.try_emplace(absl::string_view("w"), 0).second);
+  EXPECT_EQ(m.erase(absl::string_view("w")), 1u);
+  // Erasing by iterator still picks the iterator overload.
+  m.erase(m.begin());
+  EXPECT_THAT(m, ElementsAre(Pair("y", 2), Pair("z", 3)));
+}
+
+TEST(FlatMapTest, InlinedVectorContainer) {
+  using Map = absl::flat_map<int, int, std::less<int>,
+                             absl::InlinedVector<std::pair<int, int>, 4>>;
+  Map m = {{2, 20}, {1, 10}};
+  m[3] = 30;
+  EXPECT_THAT(m, ElementsAre(Pair(1, 10), Pair(2, 20), Pair(3, 30)));
+  EXPECT_EQ(m.capacity(), 4u);
+}
+
+}  // namespace
@@ -0,0 +1,71 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: flat_set.h
+// -----------------------------------------------------------------------------
+//
+// `absl::flat_set<T>` is an ordered container with the interface of
+// `std::set`, plus `contains()`, stored as a sorted sequence in a contiguous
+// container: `std::vector<T>` by default, or an `absl::InlinedVector` so that
+// small sets need no allocation. A lookup is a binary search over adjacent
+// values, with no pointers to chase and no per-value allocation, so a small
+// set fits in a few cache lines.
+//
+// It differs from `std::set` in that:
+//
+//   * Inserting or erasing one value takes linear time, as the values after
+//     it are shifted, and invalidates all iterators, pointers and references
+//     into the container.
+//   * Values must be movable.
+//
+// It suits sets that are built once and then mostly read. Build it from a
+// range or container, which need not be sorted, or insert a batch of values
+// with the range `insert()`: both sort the values and merge them in at once.
+// Lookups take any key type when the comparator defines `is_transparent`.
+//
+// Example:
+//
+//   absl::flat_set<int64_t> ids = {5, 1, 3, 1};  // 1, 3, 5.
+//   ids.insert(new_ids.begin(), new_ids.end());
+//   if (ids.contains(id)) ...
+
+#ifndef ABSL_CONTAINER_FLAT_SET_H_
+#define ABSL_CONTAINER_FLAT_SET_H_
+
+#include <functional>
+#include <vector>
+
+#include "absl/container/internal/flat_container.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// absl::flat_set
+// -----------------------------------------------------------------------------
+template <class Key, class Compare = std::less<Key>,
+          class Container = std::vector<Key>>
+class flat_set : public container_internal::flat_container<
+                     container_internal::flat_set_params<Key>, Compare,
+                     Container> {
+  using Base = typename flat_set::flat_container;
+
+ public:
+  flat_set() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_FLAT_SET_H_
@@ -0,0 +1,175 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/flat_set.h"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+TEST(FlatSetTest, BuildsFromUnsortedInput) {
+  absl::flat_set<int> s = {5, 1, 3, 1, 5};
+  EXPECT_THAT(s, ElementsAre(1, 3, 5));
+
+  std::vector<int> input = {9, 7, 8, 7};
+  absl::flat_set<int> from_range(input.begin(), input.end());
+  EXPECT_THAT(from_range, ElementsAre(7, 8, 9));
+
+  absl::flat_set<int> from_container(std::move(input));
+  EXPECT_THAT(from_container, ElementsAre(7, 8, 9));
+}
+
+TEST(FlatSetTest, Lookup) {
+  const absl::flat_set<int> s = {10, 20, 30};
+  EXPECT_TRUE(s.contains(20));
+  EXPECT_FALSE(s.contains(25));
+  EXPECT_EQ(s.count(10), 1u);
+  EXPECT_EQ(s.count(11), 0u);
+  EXPECT_EQ(s.find(25), s.end());
+  EXPECT_EQ(*s.find(30), 30);
+  EXPECT_EQ(*s.lower_bound(15), 20);
+  EXPECT_EQ(*s.lower_bound(20), 20);
+  EXPECT_EQ(*s.upper_bound(20), 30);
+  EXPECT_EQ(s.upper_bound(30), s.end());
+
+  auto range = s.equal_range(20);
+  EXPECT_EQ(*range.first, 20);
+  EXPECT_EQ(*range.second, 30);
+  range = s.equal_range(25);
+  EXPECT_EQ(range.first, range.second);
+  EXPECT_EQ(*range.first, 30);
+}
+
+TEST(FlatSetTest, InsertAndErase) {
+  absl::flat_set<int> s;
+  EXPECT_TRUE(s.insert(3).second);
+  EXPECT_TRUE(s.insert(1).second);
+  auto res = s.insert(3);
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(*res.first, 3);
+  EXPECT_TRUE(s.emplace(2).second);
+  // A correct hint, and a wrong one.
+  EXPECT_EQ(*s.insert(s.end(), 4), 4);
+  EXPECT_EQ(*s.insert(s.begin(), 0), 0);
+  EXPECT_EQ(*s.emplace_hint(s.begin(), 5), 5);
+  EXPECT_THAT(s, ElementsAre(0, 1, 2, 3, 4, 5));
+
+  EXPECT_EQ(s.erase(2), 1u);
+  EXPECT_EQ(s.erase(2), 0u);
+  auto it = s.erase(s.find(3));
+  EXPECT_EQ(*it, 4);
+  s.erase(s.begin(), s.begin() + 2);
+  EXPECT_THAT(s, ElementsAre(4, 5));
+  s.clear();
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(FlatSetTest, BatchInsertKeepsPresentElements) {
+  // Equivalent under the comparator, but distinguishable.
+  struct CaseInsensitiveLess {
+    bool operator()(const std::string& a, const std::string& b) const {
+      return std::lexicographical_compare(
+          a.begin(), a.end(), b.begin(), b.end(),
+          [](char x, char y) { return std::tolower(x) < std::tolower(y); });
+    }
+  };
+  absl::flat_set<std::string, CaseInsensitiveLess> s = {"b", "d"};
+  const std::vector<std::string> batch = {"E", "B", "a", "A", "c", "e"};
+  s.insert(batch.begin(), batch.end());
+  EXPECT_THAT(s, ElementsAre("a", "b", "c", "d", "E"));
+}
+
+TEST(FlatSetTest, BatchInsertMatchesStdSet) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> value(0, 999);
+  absl::flat_set<int> s;
+  std::set<int> expected;
+  for (int batch = 0; batch < 50; ++batch) {
+    std::vector<int> values(batch);
+    for (int& v : values) v = value(rng);
+    s.insert(values.begin(), values.end());
+    expected.insert(values.begin(), values.end());
+    ASSERT_THAT(s, ElementsAreArray(expected));
+  }
+  // Appending larger values skips the merge.
+  std::vector<int> larger = {1002, 1001, 1000};
+  s.insert(larger.begin(), larger.end());
+  expected.insert(larger.begin(), larger.end());
+  EXPECT_THAT(s, ElementsAreArray(expected));
+}
+
+TEST(FlatSetTest, CustomComparator) {
+  absl::flat_set<int, std::greater<int>> s = {1, 3, 2};
+  EXPECT_THAT(s, ElementsAre(3, 2, 1));
+  EXPECT_EQ(*s.lower_bound(4), 3);
+  EXPECT_TRUE(s.contains(2));
+}
+
+struct TransparentLess {
+  using is_transparent = void;
+  bool operator()(absl::string_view a, absl::string_view b) const {
+    return a < b;
+  }
+};
+
+TEST(FlatSetTest, HeterogeneousLookup) {
+  absl::flat_set<std::string, TransparentLess> s = {"alpha", "beta"};
+  const absl::string_view key = "beta";
+  EXPECT_TRUE(s.contains(key));
+  EXPECT_EQ(*s.find(key), "beta");
+  EXPECT_EQ(s.count("gamma"), 0u);
+  EXPECT_EQ(*s.lower_bound(absl::string_view("b")), "beta");
+  EXPECT_EQ(s.erase(absl::string_view("alpha")), 1u);
+  EXPECT_THAT(s, ElementsAre("beta"));
+}
+
+TEST(FlatSetTest, InlinedVectorContainer) {
+  absl::flat_set<int, std::less<int>, absl::InlinedVector<int, 8>> s = {
+      4, 2, 6};
+  s.insert(5);
+  const std::vector<int> batch = {1, 3};
+  s.insert(batch.begin(), batch.end());
+  EXPECT_THAT(s, ElementsAre(1, 2, 3, 4, 5, 6));
+  EXPECT_EQ(s.capacity(), 8u);
+}
+
+TEST(FlatSetTest, CopyMoveSwapCompare) {
+  absl::flat_set<int> a = {1, 2};
+  absl::flat_set<int> b = a;
+  EXPECT_EQ(a, b);
+  b.insert(3);
+  EXPECT_NE(a, b);
+  EXPECT_LT(a, b);
+  absl::flat_set<int> c = std::move(b);
+  EXPECT_THAT(c, ElementsAre(1, 2, 3));
+  swap(a, c);
+  EXPECT_THAT(a, ElementsAre(1, 2, 3));
+  EXPECT_THAT(c, ElementsAre(1, 2));
+}
+
+}  // namespace
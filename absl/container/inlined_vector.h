@@ -51,8 +51,33 @@
 #include "absl/base/optimization.h"
 #include "absl/base/port.h"
 #include "absl/memory/memory.h"
+#include "absl/meta/type_traits.h"
 
 namespace absl {
+namespace inlined_vector_internal {
+
+// Whether the allocator `A` defines construct() or destroy() for `T`. If it
+// defines neither, std::allocator_traits use placement new and the destructor.
+template <typename A, typename T, typename = void>
+struct HasConstruct : std::false_type {};
+
+template <typename A, typename T>
+struct HasConstruct<
+    A, T,
+    absl::void_t<decltype(std::declval<A&>().construct(std::declval<T*>(),
+                                                       std::declval<T&&>()))>>
+    : std::true_type {};
+
+template <typename A, typename T, typename = void>
+struct HasDestroy : std::false_type {};
+
+template <typename A, typename T>
+struct HasDestroy<
+    A, T,
+    absl::void_t<decltype(std::declval<A&>().destroy(std::declval<T*>()))>>
+    : std::true_type {};
+
+}  // namespace inlined_vector_internal
 
 // -----------------------------------------------------------------------------
 // InlinedVector
@@ -64,6 +89,12 @@ namespace absl {
 // size, it will trigger an initial allocation on the heap, and will behave as a
 // `std:vector`. The API of the `absl::InlinedVector` within this file is
 // designed to cover the same API footprint as covered by `std::vector`.
+//
+// With an allocator whose `size_type` is 32 bits wide, a 64-bit build keeps
+// the heap capacity next to the size, and only the heap pointer in the inlined
+// space. `absl::InlinedVector<int32_t, 2, A>` then takes 16 bytes instead of
+// 24, which matters for large arrays of small vectors. Such vectors hold fewer
+// than 2^31 elements.
 template <typename T, size_t N, typename A = std::allocator<T> >
 class InlinedVector {
   using AllocatorTraits = std::allocator_traits<A>;
@@ -253,7 +284,7 @@ class InlinedVector {
   // inlined vectors which exceed this capacity, they will no longer be inlined,
   // and `capacity()` will equal its capacity on the allocated heap.
   size_type capacity() const noexcept {
-    return allocated() ? allocation().capacity() : N;
+    return allocated() ? allocated_capacity(CompactLayout()) : N;
   }
 
   // InlinedVector::max_size()
@@ -543,10 +574,7 @@ class InlinedVector {
     assert(position >= begin());
     assert(position < end());
 
-    iterator pos = const_cast<iterator>(position);
-    std::move(pos + 1, end(), pos);
-    pop_back();
-    return pos;
+    return erase(position, position + 1);
   }
 
   // Overload of InlinedVector::erase() for erasing all elements in the
@@ -589,6 +617,15 @@ class InlinedVector {
       return;
     }
 
+    if (s <= N && RelocateWithMemcpy::value) {
+      // Copy the allocation out before the inlined storage overwrites it.
+      Allocation old_allocation = allocation();
+      UninitializedRelocate(old_allocation.buffer(), s, inlined_space());
+      old_allocation.Dealloc(allocator());
+      tag().set_inline_size(s);
+      return;
+    }
+
     if (s <= N) {
       // Move the elements to the inlined storage.
       // We have to do this using a temporary, because inlined_storage and
@@ -603,9 +640,7 @@ class InlinedVector {
     // We can't simply use the same approach as above, because assign() would
     // call into reserve() internally and reserve larger capacity than we need.
     Allocation new_allocation(allocator(), s);
-    UninitializedCopy(std::make_move_iterator(allocated_space()),
-                      std::make_move_iterator(allocated_space() + s),
-                      new_allocation.buffer());
+    UninitializedRelocate(allocated_space(), s, new_allocation.buffer());
     ResetAllocation(new_allocation, s);
   }
 
@@ -622,12 +657,20 @@ class InlinedVector {
  private:
   static_assert(N > 0, "inlined vector with nonpositive size");
 
+  // Whether the heap capacity is kept in the tag, next to the size, instead of
+  // next to the heap pointer. That takes two size_types that together fit in
+  // a pointer, so it is chosen for allocators with a 32-bit size_type on
+  // 64-bit platforms; the allocated representation then shrinks to a single
+  // pointer.
+  using CompactLayout =
+      std::integral_constant<bool, 2 * sizeof(size_type) <= sizeof(pointer)>;
+
   // It holds whether the vector is allocated or not in the lowest bit.
   // The size is held in the high bits:
   //   size_ = (size << 1) | is_allocated;
-  class Tag {
+  class WideTag {
    public:
-    Tag() : size_(0) {}
+    WideTag() : size_(0) {}
     size_type size() const { return size_ >> 1; }
     void add_size(size_type n) { size_ += n << 1; }
     void set_inline_size(size_type n) { size_ = n << 1; }
@@ -638,6 +681,21 @@ class InlinedVector {
     size_type size_;
   };
 
+  // The tag of the compact layout, which also holds the heap capacity. Setting
+  // the size leaves the capacity alone.
+  class CompactTag : public WideTag {
+   public:
+    CompactTag() : capacity_(0) {}
+    size_type capacity() const { return capacity_; }
+    void set_capacity(size_type n) { capacity_ = n; }
+
+   private:
+    size_type capacity_;
+  };
+
+  using Tag = typename std::conditional<CompactLayout::value, CompactTag,
+                                        WideTag>::type;
+
   // Derives from allocator_type to use the empty base class optimization.
   // If the allocator_type is stateless, we can 'store'
   // our instance of it for free.
@@ -660,6 +718,8 @@ class InlinedVector {
                size_type capacity)
         : capacity_(capacity),
           buffer_(AllocatorTraits::allocate(a, capacity_)) {}
+    Allocation(value_type* buffer, size_type capacity)
+        : capacity_(capacity), buffer_(buffer) {}
 
     void Dealloc(allocator_type& a) {  // NOLINT(runtime/references)
       AllocatorTraits::deallocate(a, buffer(), capacity());
@@ -674,17 +734,57 @@ class InlinedVector {
     value_type* buffer_;
   };
 
+  // The heap pointer alone, which is what the compact layout keeps in `rep_`.
+  class CompactAllocation {
+   public:
+    explicit CompactAllocation(value_type* buffer) : buffer_(buffer) {}
+
+    const value_type* buffer() const { return buffer_; }
+    value_type* buffer() { return buffer_; }
+
+   private:
+    value_type* buffer_;
+  };
+
+  // What `rep_` holds while the vector is allocated.
+  using StoredAllocation =
+      typename std::conditional<CompactLayout::value, CompactAllocation,
+                                Allocation>::type;
+
   const Tag& tag() const { return allocator_and_tag_.tag(); }
   Tag& tag() { return allocator_and_tag_.tag(); }
 
-  Allocation& allocation() {
-    return reinterpret_cast<Allocation&>(rep_.allocation_storage.allocation);
+  // The stored allocation. Copying it together with the tag moves the whole
+  // allocation in either layout.
+  StoredAllocation& stored_allocation() {
+    return reinterpret_cast<StoredAllocation&>(
+        rep_.allocation_storage.allocation);
   }
-  const Allocation& allocation() const {
-    return reinterpret_cast<const Allocation&>(
+  const StoredAllocation& stored_allocation() const {
+    return reinterpret_cast<const StoredAllocation&>(
         rep_.allocation_storage.allocation);
   }
+
+  Allocation allocation() const {
+    return Allocation(const_cast<value_type*>(stored_allocation().buffer()),
+                      allocated_capacity(CompactLayout()));
+  }
+  size_type allocated_capacity(std::true_type) const {
+    return tag().capacity();
+  }
+  size_type allocated_capacity(std::false_type) const {
+    return stored_allocation().capacity();
+  }
+
   void init_allocation(const Allocation& allocation) {
+    InitAllocation(allocation, CompactLayout());
+  }
+  void InitAllocation(const Allocation& allocation, std::true_type) {
+    new (&rep_.allocation_storage.allocation)
+        CompactAllocation(const_cast<value_type*>(allocation.buffer()));
+    tag().set_capacity(allocation.capacity());
+  }
+  void InitAllocation(const Allocation& allocation, std::false_type) {
     new (&rep_.allocation_storage.allocation) Allocation(allocation);
   }
 
@@ -696,10 +796,10 @@ class InlinedVector {
   }
 
   value_type* allocated_space() {
-    return allocation().buffer();
+    return stored_allocation().buffer();
   }
   const value_type* allocated_space() const {
-    return allocation().buffer();
+    return stored_allocation().buffer();
   }
 
   const allocator_type& allocator() const {
@@ -711,6 +811,19 @@ class InlinedVector {
 
   bool allocated() const { return tag().allocated(); }
 
+  // Whether elements can be moved around with memcpy() and memmove() instead
+  // of their move constructors and destructors. That bypasses the allocator's
+  // construct() and destroy(), so it is only done for std::allocator and for
+  // allocators that don't define them.
+  using RelocateWithMemcpy = std::integral_constant<
+      bool,
+      absl::is_trivially_relocatable<value_type>::value &&
+          (std::is_same<allocator_type, std::allocator<value_type>>::value ||
+           !(inlined_vector_internal::HasConstruct<allocator_type,
+                                                   value_type>::value ||
+             inlined_vector_internal::HasDestroy<allocator_type,
+                                                 value_type>::value))>;
+
   // Enlarge the underlying representation so we can store size_ + delta elems.
   // The size is not changed, and any newly added memory is not initialized.
   void EnlargeBy(size_type delta);
@@ -726,16 +839,13 @@ class InlinedVector {
   std::pair<iterator, iterator> ShiftRight(const_iterator position,
                                            size_type n);
 
+  // Switches to `new_allocation`, to which the elements have already been
+  // relocated, and frees the old allocation if there is one.
   void ResetAllocation(Allocation new_allocation, size_type new_size) {
     if (allocated()) {
-      Destroy(allocated_space(), allocated_space() + size());
-      assert(begin() == allocated_space());
       allocation().Dealloc(allocator());
-      allocation() = new_allocation;
-    } else {
-      Destroy(inlined_space(), inlined_space() + size());
-      init_allocation(new_allocation);  // bug: only init once
     }
+    init_allocation(new_allocation);
     tag().set_allocated_size(new_size);
   }
 
@@ -748,9 +858,7 @@ class InlinedVector {
 
     value_type& new_element =
         Construct(new_allocation.buffer() + s, std::forward<Args>(args)...);
-    UninitializedCopy(std::make_move_iterator(data()),
-                      std::make_move_iterator(data() + s),
-                      new_allocation.buffer());
+    UninitializedRelocate(data(), s, new_allocation.buffer());
 
     ResetAllocation(new_allocation, s + 1);
 
@@ -771,6 +879,41 @@ class InlinedVector {
     for (; src != src_last; ++dst, ++src) Construct(dst, *src);
   }
 
+  // Moves the `n` elements at `src` to the uninitialized memory at `dst`, which
+  // must not overlap them, and destroys the originals.
+  void UninitializedRelocate(value_type* src, size_type n, value_type* dst) {
+    UninitializedRelocate(src, n, dst, RelocateWithMemcpy());
+  }
+  void UninitializedRelocate(value_type* src, size_type n, value_type* dst,
+                             std::true_type) {
+    if (n != 0) {
+      memcpy(static_cast<void*>(dst), static_cast<const void*>(src),
+             n * sizeof(value_type));
+    }
+  }
+  void UninitializedRelocate(value_type* src, size_type n, value_type* dst,
+                             std::false_type) {
+    UninitializedCopy(std::make_move_iterator(src),
+                      std::make_move_iterator(src + n), dst);
+    Destroy(src, src + n);
+  }
+
+  // Transfers the `n` elements at `src`, in the inlined space of `from`, to the
+  // uninitialized memory at `dst` in this vector, on behalf of swap().
+  void TransferForSwap(InlinedVector* from, value_type* src, size_type n,
+                       value_type* dst) {
+    TransferForSwap(from, src, n, dst, RelocateWithMemcpy());
+  }
+  void TransferForSwap(InlinedVector*, value_type* src, size_type n,
+                       value_type* dst, std::true_type) {
+    UninitializedRelocate(src, n, dst, std::true_type());
+  }
+  void TransferForSwap(InlinedVector* from, value_type* src, size_type n,
+                       value_type* dst, std::false_type) {
+    UninitializedCopy(src, src + n, dst);
+    from->Destroy(src, src + n);
+  }
+
   template <typename... Args>
   void UninitializedFill(value_type* dst, value_type* dst_last,
                          const Args&... args) {
@@ -829,8 +972,8 @@ class InlinedVector {
                                     alignof(value_type)>::type inlined[N];
     } inlined_storage;
     struct {
-      typename std::aligned_storage<sizeof(Allocation),
-                                    alignof(Allocation)>::type allocation;
+      typename std::aligned_storage<sizeof(StoredAllocation),
+                                    alignof(StoredAllocation)>::type allocation;
     } allocation_storage;
   } rep_;
 };
@@ -1096,8 +1239,16 @@ typename InlinedVector<T, N, A>::iterator InlinedVector<T, N, A>::erase(
       space = inlined_space();
       tag().set_inline_size(s - erase_gap);
     }
-    std::move(range_end, space + s, range_start);
-    Destroy(space + s - erase_gap, space + s);
+    if (RelocateWithMemcpy::value) {
+      // Destroy the erased elements and slide the tail over them.
+      Destroy(range_start, range_end);
+      memmove(static_cast<void*>(range_start),
+              static_cast<const void*>(range_end),
+              (space + s - range_end) * sizeof(value_type));
+    } else {
+      std::move(range_end, space + s, range_start);
+      Destroy(space + s - erase_gap, space + s);
+    }
   }
   return range_start;
 }
@@ -1111,7 +1262,7 @@ void InlinedVector<T, N, A>::swap(InlinedVector& other) {
   if (allocated() && other.allocated()) {
     // Both out of line, so just swap the tag, allocation, and allocator.
     swap(tag(), other.tag());
-    swap(allocation(), other.allocation());
+    swap(stored_allocation(), other.stored_allocation());
     swap(allocator(), other.allocator());
     return;
   }
@@ -1132,10 +1283,8 @@ void InlinedVector<T, N, A>::swap(InlinedVector& other) {
                      b->inlined_space());
 
     // Move the remaining elements: A[b_size,a_size) -> B[b_size,a_size)
-    b->UninitializedCopy(a->inlined_space() + b_size,
-                         a->inlined_space() + a_size,
-                         b->inlined_space() + b_size);
-    a->Destroy(a->inlined_space() + b_size, a->inlined_space() + a_size);
+    b->TransferForSwap(a, a->inlined_space() + b_size, a_size - b_size,
+                       b->inlined_space() + b_size);
 
     swap(a->tag(), b->tag());
     swap(a->allocator(), b->allocator());
@@ -1164,13 +1313,12 @@ void InlinedVector<T, N, A>::swap(InlinedVector& other) {
   swap(a->tag(), b->tag());
 
   // Copy b_allocation out before b's union gets clobbered by inline_space.
-  Allocation b_allocation = b->allocation();
+  // With the compact layout, its capacity has moved with the tag already.
+  StoredAllocation b_allocation = b->stored_allocation();
 
-  b->UninitializedCopy(a->inlined_space(), a->inlined_space() + a_size,
-                       b->inlined_space());
-  a->Destroy(a->inlined_space(), a->inlined_space() + a_size);
+  b->TransferForSwap(a, a->inlined_space(), a_size, b->inlined_space());
 
-  a->allocation() = b_allocation;
+  a->stored_allocation() = b_allocation;
 
   if (a->allocator() != b->allocator()) {
     swap(a->allocator(), b->allocator());
@@ -1195,11 +1343,7 @@ void InlinedVector<T, N, A>::EnlargeBy(size_type delta) {
   }
 
   Allocation new_allocation(allocator(), new_capacity);
-
-  UninitializedCopy(std::make_move_iterator(data()),
-                    std::make_move_iterator(data() + s),
-                    new_allocation.buffer());
-
+  UninitializedRelocate(data(), s, new_allocation.buffer());
   ResetAllocation(new_allocation, s);
 }
 
@@ -1221,18 +1365,23 @@ auto InlinedVector<T, N, A>::ShiftRight(const_iterator position, size_type n)
     // requested shift.
     Allocation new_allocation(allocator(), new_capacity);
     size_type index = position - begin();
-    UninitializedCopy(std::make_move_iterator(data()),
-                      std::make_move_iterator(data() + index),
-                      new_allocation.buffer());
-    UninitializedCopy(std::make_move_iterator(data() + index),
-                      std::make_move_iterator(data() + s),
-                      new_allocation.buffer() + index + n);
+    UninitializedRelocate(data(), index, new_allocation.buffer());
+    UninitializedRelocate(data() + index, s - index,
+                          new_allocation.buffer() + index + n);
     ResetAllocation(new_allocation, s);
 
     // New allocation means our iterator is invalid, so we'll recalculate.
     // Since the entire gap is in new space, there's no used space to reuse.
     start_raw = begin() + index;
     start_used = start_raw;
+  } else if (RelocateWithMemcpy::value) {
+    // Slide the tail over in one memmove(), which leaves the whole gap as raw
+    // space.
+    iterator pos = const_cast<iterator>(position);
+    memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos),
+            (end() - pos) * sizeof(value_type));
+    start_used = pos;
+    start_raw = pos;
   } else {
     // If we had enough space, it's a two-part move. Elements going into
     // previously-unoccupied space need an UninitializedCopy. Elements
@@ -0,0 +1,88 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+template <class T>
+T MakeElement(int i);
+
+template <>
+int MakeElement<int>(int i) {
+  return i;
+}
+
+template <>
+std::unique_ptr<int> MakeElement<std::unique_ptr<int>>(int i) {
+  return absl::make_unique<int>(i);
+}
+
+template <>
+std::string MakeElement<std::string>(int i) {
+  return std::string(i % 32, 'x');
+}
+
+// Grows from the inlined space through several reallocations.
+template <class T>
+void BM_PushBack(benchmark::State& state) {
+  const int n = state.range(0);
+  while (state.KeepRunning()) {
+    absl::InlinedVector<T, 4> v;
+    for (int i = 0; i < n; ++i) v.push_back(MakeElement<T>(i));
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, int)->Range(8, 1024);
+BENCHMARK_TEMPLATE(BM_PushBack, std::unique_ptr<int>)->Range(8, 1024);
+BENCHMARK_TEMPLATE(BM_PushBack, std::string)->Range(8, 1024);
+
+// Each insertion at the front shifts every element over by one.
+template <class T>
+void BM_InsertFrontEraseFront(benchmark::State& state) {
+  const int n = state.range(0);
+  absl::InlinedVector<T, 4> v;
+  for (int i = 0; i < n; ++i) v.push_back(MakeElement<T>(i));
+  T t = MakeElement<T>(0);
+  while (state.KeepRunning()) {
+    v.insert(v.begin(), std::move(t));
+    t = std::move(v.front());
+    v.erase(v.begin());
+  }
+}
+BENCHMARK_TEMPLATE(BM_InsertFrontEraseFront, int)->Range(8, 1024);
+BENCHMARK_TEMPLATE(BM_InsertFrontEraseFront, std::unique_ptr<int>)
+    ->Range(8, 1024);
+BENCHMARK_TEMPLATE(BM_InsertFrontEraseFront, std::string)->Range(8, 1024);
+
+// Swaps an inlined vector with an allocated one.
+template <class T>
+void BM_SwapInlinedWithAllocated(benchmark::State& state) {
+  absl::InlinedVector<T, 8> a, b;
+  for (int i = 0; i < 8; ++i) a.push_back(MakeElement<T>(i));
+  for (int i = 0; i < 16; ++i) b.push_back(MakeElement<T>(i));
+  while (state.KeepRunning()) {
+    a.swap(b);
+    benchmark::DoNotOptimize(a.data());
+  }
+}
+BENCHMARK_TEMPLATE(BM_SwapInlinedWithAllocated, std::unique_ptr<int>);
+
+}  // namespace
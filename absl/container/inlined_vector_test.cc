@@ -31,9 +31,36 @@
 #include "absl/base/internal/raw_logging.h"
 #include "absl/base/macros.h"
 #include "absl/container/internal/test_instance_tracker.h"
+#include "absl/memory/arena.h"
 #include "absl/memory/memory.h"
+#include "absl/meta/type_traits.h"
 #include "absl/strings/str_cat.h"
 
+// Counts its moves and destructions. It opts in to trivial relocation, so
+// InlinedVector should do neither when it only relocates elements.
+struct Relocatable {
+  static int moves;
+  static int destructions;
+
+  explicit Relocatable(int v) : value(v) {}
+  Relocatable(Relocatable&& r) : value(r.value) { ++moves; }
+  Relocatable& operator=(Relocatable&& r) {
+    value = r.value;
+    ++moves;
+    return *this;
+  }
+  ~Relocatable() { ++destructions; }
+
+  int value;
+};
+int Relocatable::moves = 0;
+int Relocatable::destructions = 0;
+
+namespace absl {
+template <>
+struct is_trivially_relocatable<Relocatable> : std::true_type {};
+}  // namespace absl
+
 namespace {
 
 using absl::test_internal::CopyableMovableInstance;
@@ -788,6 +815,116 @@ TEST(OverheadTest, Storage) {
             sizeof(absl::InlinedVector<int*, 8>) - 8 * sizeof(int*));
 }
 
+// An allocator with a 32-bit size_type, which selects the compact layout.
+template <typename T>
+class SmallSizeAllocator {
+ public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = uint32_t;
+  using difference_type = int32_t;
+
+  template <typename U>
+  struct rebind {
+    using other = SmallSizeAllocator<U>;
+  };
+
+  SmallSizeAllocator() = default;
+  template <typename U>
+  SmallSizeAllocator(const SmallSizeAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_type n) { return std::allocator<T>().allocate(n); }
+  void deallocate(T* p, size_type n) { std::allocator<T>().deallocate(p, n); }
+
+  friend bool operator==(SmallSizeAllocator, SmallSizeAllocator) {
+    return true;
+  }
+  friend bool operator!=(SmallSizeAllocator, SmallSizeAllocator) {
+    return false;
+  }
+};
+
+template <typename T, size_t N>
+using CompactVec = absl::InlinedVector<T, N, SmallSizeAllocator<T>>;
+
+TEST(OverheadTest, CompactLayout) {
+  if (sizeof(void*) != 8) return;
+  EXPECT_EQ(16, sizeof(CompactVec<int32_t, 1>));
+  EXPECT_EQ(16, sizeof(CompactVec<int32_t, 2>));
+  EXPECT_EQ(24, sizeof(CompactVec<int32_t, 4>));
+  EXPECT_EQ(16, sizeof(CompactVec<int16_t, 4>));
+  EXPECT_EQ(16, sizeof(CompactVec<int*, 1>));
+  EXPECT_EQ(24, sizeof(absl::InlinedVector<int32_t, 2>));
+}
+
+TEST(CompactLayout, MatchesStdVector) {
+  CompactVec<int32_t, 2> v;
+  std::vector<int32_t> expected;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(i);
+    expected.push_back(i);
+    ASSERT_GE(v.capacity(), v.size());
+  }
+  EXPECT_THAT(v, ElementsAreArray(expected));
+  EXPECT_EQ(128, v.capacity());
+
+  v.insert(v.begin() + 10, 5, -1);
+  expected.insert(expected.begin() + 10, 5, -1);
+  v.erase(v.begin(), v.begin() + 3);
+  expected.erase(expected.begin(), expected.begin() + 3);
+  EXPECT_THAT(v, ElementsAreArray(expected));
+
+  v.reserve(1000);
+  EXPECT_GE(v.capacity(), 1000);
+  v.shrink_to_fit();
+  EXPECT_EQ(v.size(), v.capacity());
+  EXPECT_THAT(v, ElementsAreArray(expected));
+
+  v.resize(2);
+  v.shrink_to_fit();
+  EXPECT_EQ(2, v.capacity());
+  EXPECT_THAT(v, ElementsAre(3, 4));
+
+  v.clear();
+  EXPECT_EQ(2, v.capacity());
+  EXPECT_EQ(0, v.size());
+}
+
+TEST(CompactLayout, CopyMoveAndSwap) {
+  for (int l1 = 0; l1 < 6; ++l1) {
+    SCOPED_TRACE(l1);
+    for (int l2 = 0; l2 < 6; ++l2) {
+      SCOPED_TRACE(l2);
+      CompactVec<int32_t, 2> a, b;
+      for (int i = 0; i < l1; ++i) a.push_back(i);
+      for (int i = 0; i < l2; ++i) b.push_back(100 + i);
+      const auto a_capacity = a.capacity();
+      const auto b_capacity = b.capacity();
+
+      a.swap(b);
+      EXPECT_EQ(l2, a.size());
+      EXPECT_EQ(l1, b.size());
+      EXPECT_EQ(b_capacity, a.capacity());
+      EXPECT_EQ(a_capacity, b.capacity());
+      for (int i = 0; i < l2; ++i) EXPECT_EQ(100 + i, a[i]);
+      for (int i = 0; i < l1; ++i) EXPECT_EQ(i, b[i]);
+
+      CompactVec<int32_t, 2> c(a);
+      EXPECT_EQ(a, c);
+      CompactVec<int32_t, 2> d(std::move(c));
+      EXPECT_EQ(a, d);
+      c = std::move(b);
+      EXPECT_EQ(l1, c.size());
+      for (int i = 0; i < l1; ++i) EXPECT_EQ(i, c[i]);
+      c = d;
+      EXPECT_EQ(a, c);
+    }
+  }
+}
+
 TEST(IntVec, Clear) {
   for (int len = 0; len < 20; len++) {
     SCOPED_TRACE(len);
@@ -1763,4 +1900,94 @@ TEST(AllocatorSupportTest, ScopedAllocatorWorks) {
   EXPECT_EQ(allocated, 0);
 }
 
+TEST(AllocatorSupportTest, ArenaAllocatorWorks) {
+  absl::Arena arena;
+  absl::ArenaAllocator<int> alloc(&arena);
+  absl::InlinedVector<int, 4, absl::ArenaAllocator<int>> vec(alloc);
+  for (int i = 0; i < 4; ++i) vec.push_back(i);
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+
+  // Growing reallocates from the arena. The buffers grown out of are not the
+  // arena's most recent allocation, so they stay until the arena goes away.
+  for (int i = 4; i < 100; ++i) vec.push_back(i);
+  EXPECT_EQ(vec.size(), 100u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(vec[i], i);
+  EXPECT_GE(arena.bytes_allocated(), 100 * sizeof(int));
+  EXPECT_EQ(vec.get_allocator().arena(), &arena);
+
+  absl::InlinedVector<int, 4, absl::ArenaAllocator<int>> copy(vec, alloc);
+  EXPECT_EQ(copy, vec);
+}
+
+TEST(TriviallyRelocatableTest, NoMovesWhenGrowingShiftingOrErasing) {
+  Relocatable::moves = 0;
+  Relocatable::destructions = 0;
+  {
+    absl::InlinedVector<Relocatable, 4> v;
+    for (int i = 0; i < 100; ++i) v.emplace_back(i);
+    EXPECT_EQ(0, Relocatable::moves);
+    EXPECT_EQ(0, Relocatable::destructions);
+
+    // Inserting moves the new element into place once, from the temporary
+    // that emplace() builds, but leaves the shifted elements alone.
+    v.emplace(v.begin(), -1);
+    v.emplace(v.begin() + 50, -2);
+    EXPECT_EQ(2, Relocatable::moves);
+    EXPECT_EQ(2, Relocatable::destructions);
+
+    // Erasing destroys the erased elements only.
+    v.erase(v.begin() + 50);
+    v.erase(v.begin(), v.begin() + 10);
+    EXPECT_EQ(2, Relocatable::moves);
+    EXPECT_EQ(13, Relocatable::destructions);
+    ASSERT_EQ(91, v.size());
+    for (int i = 0; i < 91; ++i) EXPECT_EQ(i + 9, v[i].value);
+
+    v.erase(v.begin() + 3, v.end());
+    v.shrink_to_fit();
+    EXPECT_EQ(4, v.capacity());
+    EXPECT_EQ(2, Relocatable::moves);
+    EXPECT_EQ(101, Relocatable::destructions);
+    ASSERT_EQ(3, v.size());
+    EXPECT_EQ(9, v[0].value);
+    EXPECT_EQ(10, v[1].value);
+    EXPECT_EQ(11, v[2].value);
+
+    absl::InlinedVector<Relocatable, 4> w;
+    for (int i = 0; i < 10; ++i) w.emplace_back(100 + i);
+    v.swap(w);
+    EXPECT_EQ(2, Relocatable::moves);
+    EXPECT_EQ(101, Relocatable::destructions);
+    ASSERT_EQ(10, v.size());
+    ASSERT_EQ(3, w.size());
+    EXPECT_EQ(100, v[0].value);
+    EXPECT_EQ(9, w[0].value);
+  }
+  EXPECT_EQ(114, Relocatable::destructions);
+}
+
+TEST(TriviallyRelocatableTest, UniquePtr) {
+  using Vec = absl::InlinedVector<std::unique_ptr<int>, 2>;
+  Vec v;
+  for (int i = 0; i < 10; ++i) v.push_back(absl::make_unique<int>(i));
+  v.insert(v.begin() + 3, absl::make_unique<int>(-1));
+  v.erase(v.begin());
+  ASSERT_EQ(10, v.size());
+  EXPECT_EQ(1, *v[0]);
+  EXPECT_EQ(2, *v[1]);
+  EXPECT_EQ(-1, *v[2]);
+  EXPECT_EQ(9, *v[9]);
+
+  Vec w;
+  w.push_back(absl::make_unique<int>(42));
+  v.swap(w);
+  ASSERT_EQ(1, v.size());
+  EXPECT_EQ(42, *v[0]);
+  ASSERT_EQ(10, w.size());
+  w.erase(w.begin() + 1, w.end());
+  w.shrink_to_fit();
+  ASSERT_EQ(1, w.size());
+  EXPECT_EQ(1, *w[0]);
+}
+
 }  // anonymous namespace
@@ -0,0 +1,1372 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A B-tree of values sorted by key, the implementation of `absl::btree_set`
+// and the other ordered containers.
+//
+// A node holds up to `kNodeValues` values in sorted order, as many as fit in
+// about `kTargetNodeSize` bytes: 30 for 8-byte keys, where a red-black tree
+// holds one per node. An internal node also holds `count() + 1` pointers to
+// children, where child `i` holds the values between values `i - 1` and `i`.
+// All leaves are at the same depth. Each node points at its parent and knows
+// its position in it, which is all that iterators need to walk the tree.
+//
+//   node:  [ parent position count max_count leaf | v[0] ... v[n - 1] ]
+//   internal nodes add                            [ c[0] ... c[n] ]
+//
+// Lookups search each node on the way down, linearly for arithmetic keys
+// under `std::less` or `std::greater`, where comparing is cheaper than a
+// mispredicted branch, and by bisection otherwise.
+//
+// A full node is split in two, and its middle value moves up to the parent,
+// unless a sibling has room for some of its values. The split favors the
+// end being inserted at, so that appending in order leaves the nodes full:
+// inserting a sorted sequence with `end()` as the hint takes constant time
+// per value and builds a tree as compact as it gets. A node left with fewer
+// than `kMinNodeValues` values by erase() takes some from a sibling, or is
+// merged into it.
+//
+// A root leaf starts with room for one value and doubles up to `kNodeValues`,
+// so that small trees don't pay for a whole node.
+//
+// Values live in slots, which the containers' params build, move and key:
+//
+//   struct Params {
+//     using key_type = ...;
+//     using key_compare = ...;
+//     using value_type = ...;
+//     using init_type = ...;      // What insert({...}) builds.
+//     using allocator_type = ...;
+//     using slot_policy = ...;    // See container_memory.h.
+//     using slot_type = typename slot_policy::slot_type;
+//     static constexpr int kTargetNodeSize = ...;
+//     static constexpr bool kIsMulti = ...;          // Duplicate keys?
+//     static constexpr bool kConstantIterators = ...;
+//     // The key of a value_type or an init_type.
+//     template <class V>
+//     static const key_type& key(const V& v);
+//   };
+
+#ifndef ABSL_CONTAINER_INTERNAL_BTREE_H_
+#define ABSL_CONTAINER_INTERNAL_BTREE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "absl/container/internal/common.h"
+#include "absl/strings/string_view.h"
+
+namespace absl {
+namespace container_internal {
+
+// The default comparisons of string keys, made transparent so that lookups
+// take any string-like key without converting it to the key type.
+struct StringBtreeDefaultLess {
+  using is_transparent = void;
+
+  StringBtreeDefaultLess() = default;
+  // Compatible with the comparators it replaces.
+  StringBtreeDefaultLess(std::less<std::string>) {}        // NOLINT
+  StringBtreeDefaultLess(std::less<absl::string_view>) {}  // NOLINT
+
+  bool operator()(absl::string_view lhs, absl::string_view rhs) const {
+    return lhs < rhs;
+  }
+};
+
+struct StringBtreeDefaultGreater {
+  using is_transparent = void;
+
+  StringBtreeDefaultGreater() = default;
+  StringBtreeDefaultGreater(std::greater<std::string>) {}        // NOLINT
+  StringBtreeDefaultGreater(std::greater<absl::string_view>) {}  // NOLINT
+
+  bool operator()(absl::string_view lhs, absl::string_view rhs) const {
+    return lhs > rhs;
+  }
+};
+
+// The comparator a tree keeps for the `Compare` its container was given.
+template <class Compare>
+struct BtreeKeyCompare {
+  using type = Compare;
+};
+template <>
+struct BtreeKeyCompare<std::less<std::string>> {
+  using type = StringBtreeDefaultLess;
+};
+template <>
+struct BtreeKeyCompare<std::less<absl::string_view>> {
+  using type = StringBtreeDefaultLess;
+};
+template <>
+struct BtreeKeyCompare<std::greater<std::string>> {
+  using type = StringBtreeDefaultGreater;
+};
+template <>
+struct BtreeKeyCompare<std::greater<absl::string_view>> {
+  using type = StringBtreeDefaultGreater;
+};
+
+// Whether a node is searched linearly rather than by bisection.
+template <class Key, class Compare>
+struct BtreeUseLinearSearch
+    : std::integral_constant<
+          bool, std::is_arithmetic<Key>::value &&
+                    (std::is_same<Compare, std::less<Key>>::value ||
+                     std::is_same<Compare, std::greater<Key>>::value)> {};
+
+// The fields at the start of every node.
+struct btree_node_header {
+  void* parent;       // Null for the root.
+  uint8_t position;   // Of the node among its parent's children.
+  uint8_t count;      // Of values.
+  uint8_t max_count;  // Of values the node has room for.
+  bool leaf;
+};
+
+template <class Params>
+class btree_node {
+  using slot_policy = typename Params::slot_policy;
+
+ public:
+  using key_type = typename Params::key_type;
+  using value_type = typename Params::value_type;
+  using slot_type = typename Params::slot_type;
+  using key_compare = typename Params::key_compare;
+  using allocator_type = typename Params::allocator_type;
+
+ private:
+  static constexpr size_t RoundUp(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+  }
+
+  static constexpr size_t kValuesOffset =
+      RoundUp(sizeof(btree_node_header), alignof(slot_type));
+  static constexpr size_t kTargetValues =
+      Params::kTargetNodeSize > kValuesOffset
+          ? (Params::kTargetNodeSize - kValuesOffset) / sizeof(slot_type)
+          : 0;
+
+ public:
+  // At least 3, so that a split leaves a value on each side of the one that
+  // moves up; at most what a uint8_t counts.
+  static constexpr int kNodeValues =
+      kTargetValues < 3 ? 3 : kTargetValues > 255 ? 255 : kTargetValues;
+  static constexpr int kMinNodeValues = kNodeValues / 2;
+
+  static constexpr size_t kAlignment =
+      alignof(slot_type) > alignof(btree_node_header)
+          ? alignof(slot_type)
+          : alignof(btree_node_header);
+
+ private:
+  static constexpr size_t kChildrenOffset = RoundUp(
+      kValuesOffset + kNodeValues * sizeof(slot_type), alignof(btree_node*));
+
+ public:
+  // The bytes taken by a leaf with room for `max_count` values, and by an
+  // internal node.
+  static constexpr size_t LeafSize(int max_count) {
+    return kValuesOffset + max_count * sizeof(slot_type);
+  }
+  static constexpr size_t kInternalSize =
+      kChildrenOffset + (kNodeValues + 1) * sizeof(btree_node*);
+
+  // Formats `mem` as an empty node.
+  static btree_node* InitLeaf(void* mem, btree_node* parent, int max_count) {
+    btree_node* n = new (mem) btree_node;
+    n->header_.parent = parent;
+    n->header_.position = 0;
+    n->header_.count = 0;
+    n->header_.max_count = static_cast<uint8_t>(max_count);
+    n->header_.leaf = true;
+    return n;
+  }
+  static btree_node* InitInternal(void* mem, btree_node* parent) {
+    btree_node* n = InitLeaf(mem, parent, kNodeValues);
+    n->header_.leaf = false;
+    return n;
+  }
+
+  btree_node* parent() const {
+    return static_cast<btree_node*>(header_.parent);
+  }
+  bool is_root() const { return parent() == nullptr; }
+  void make_root() {
+    header_.parent = nullptr;
+    header_.position = 0;
+  }
+  int position() const { return header_.position; }
+  int count() const { return header_.count; }
+  int max_count() const { return header_.max_count; }
+  bool leaf() const { return header_.leaf; }
+  void set_count(int n) { header_.count = static_cast<uint8_t>(n); }
+
+  slot_type* slot(int i) const {
+    return reinterpret_cast<slot_type*>(
+               reinterpret_cast<char*>(const_cast<btree_node*>(this)) +
+               kValuesOffset) +
+           i;
+  }
+  value_type& value(int i) const { return slot_policy::element(slot(i)); }
+  const key_type& key(int i) const { return Params::key(value(i)); }
+
+  btree_node* child(int i) const { return children()[i]; }
+  // Points child `i` at `c`, and tells `c` where it is.
+  void init_child(int i, btree_node* c) {
+    children()[i] = c;
+    c->header_.parent = this;
+    c->header_.position = static_cast<uint8_t>(i);
+  }
+
+  // The position of the first value not less than `k`, or count().
+  template <class K>
+  int lower_bound(const K& k, const key_compare& comp) const {
+    return lower_bound(
+        k, comp, BtreeUseLinearSearch<key_type, key_compare>());
+  }
+  // The position of the first value greater than `k`, or count().
+  template <class K>
+  int upper_bound(const K& k, const key_compare& comp) const {
+    return upper_bound(
+        k, comp, BtreeUseLinearSearch<key_type, key_compare>());
+  }
+
+  // Moves the value in `src` to position `i`, shifting the values from `i`
+  // on, and the children after them, one position up. In an internal node,
+  // child `i + 1` is left for the caller to set.
+  void insert_value(int i, allocator_type* alloc, slot_type* src) {
+    assert(i <= count());
+    assert(count() < max_count());
+    for (int j = count(); j > i; --j) {
+      slot_policy::transfer(alloc, slot(j), slot(j - 1));
+    }
+    slot_policy::transfer(alloc, slot(i), src);
+    if (!leaf()) {
+      for (int j = count(); j > i; --j) init_child(j + 1, child(j));
+    }
+    set_count(count() + 1);
+  }
+
+  // Removes the slot at `i`, which the caller has emptied, and child `i + 1`,
+  // shifting the values and children after them down.
+  void remove_slot(int i, allocator_type* alloc) {
+    assert(i < count());
+    for (int j = i + 1; j < count(); ++j) {
+      slot_policy::transfer(alloc, slot(j - 1), slot(j));
+    }
+    if (!leaf()) {
+      for (int j = i + 1; j < count(); ++j) init_child(j, child(j + 1));
+    }
+    set_count(count() - 1);
+  }
+
+  void remove_value(int i, allocator_type* alloc) {
+    slot_policy::destroy(alloc, slot(i));
+    remove_slot(i, alloc);
+  }
+
+  // Moves this node's last values, and the one between it and `dest` in the
+  // parent, to the new right sibling `dest`; this node's new last value
+  // moves up to the parent. Leaves room at `insert_position` on whichever
+  // side it ends up.
+  void split(int insert_position, btree_node* dest, allocator_type* alloc) {
+    assert(dest->count() == 0);
+    assert(count() == kNodeValues);
+    // Appending or prepending leaves this node or `dest` full, and the other
+    // with just the value about to be inserted.
+    int to_move;
+    if (insert_position == 0) {
+      to_move = count() - 1;
+    } else if (insert_position == kNodeValues) {
+      to_move = 0;
+    } else {
+      to_move = count() / 2;
+    }
+    const int keep = count() - to_move;
+    for (int i = 0; i < to_move; ++i) {
+      slot_policy::transfer(alloc, dest->slot(i), slot(keep + i));
+    }
+    dest->set_count(to_move);
+    set_count(keep - 1);
+    parent()->insert_value(position(), alloc, slot(keep - 1));
+    parent()->init_child(position() + 1, dest);
+    if (!leaf()) {
+      for (int i = 0; i <= to_move; ++i) dest->init_child(i, child(keep + i));
+    }
+  }
+
+  // Moves the value between this node and its right sibling `src` in the
+  // parent, and then all of `src`, to the end of this node, leaving `src`
+  // empty for the caller to delete.
+  void merge(btree_node* src, allocator_type* alloc) {
+    assert(parent() == src->parent());
+    assert(position() + 1 == src->position());
+    slot_policy::transfer(alloc, slot(count()), parent()->slot(position()));
+    for (int i = 0; i < src->count(); ++i) {
+      slot_policy::transfer(alloc, slot(count() + 1 + i), src->slot(i));
+    }
+    if (!leaf()) {
+      for (int i = 0; i <= src->count(); ++i) {
+        init_child(count() + 1 + i, src->child(i));
+      }
+    }
+    set_count(count() + 1 + src->count());
+    src->set_count(0);
+    parent()->remove_slot(position(), alloc);
+  }
+
+  // Rotates `to_move` values from the front of the right sibling `right`,
+  // through the parent, to the end of this node.
+  void rebalance_right_to_left(int to_move, btree_node* right,
+                               allocator_type* alloc) {
+    assert(parent() == right->parent());
+    assert(position() + 1 == right->position());
+    assert(to_move >= 1 && to_move <= right->count());
+    assert(count() + to_move <= max_count());
+    btree_node* p = parent();
+    slot_policy::transfer(alloc, slot(count()), p->slot(position()));
+    for (int i = 0; i < to_move - 1; ++i) {
+      slot_policy::transfer(alloc, slot(count() + 1 + i), right->slot(i));
+    }
+    slot_policy::transfer(alloc, p->slot(position()),
+                          right->slot(to_move - 1));
+    for (int i = to_move; i < right->count(); ++i) {
+      slot_policy::transfer(alloc, right->slot(i - to_move), right->slot(i));
+    }
+    if (!leaf()) {
+      for (int i = 0; i < to_move; ++i) {
+        init_child(count() + 1 + i, right->child(i));
+      }
+      for (int i = to_move; i <= right->count(); ++i) {
+        right->init_child(i - to_move, right->child(i));
+      }
+    }
+    set_count(count() + to_move);
+    right->set_count(right->count() - to_move);
+  }
+
+  // Rotates `to_move` values from the end of this node, through the parent,
+  // to the front of the right sibling `right`.
+  void rebalance_left_to_right(int to_move, btree_node* right,
+                               allocator_type* alloc) {
+    assert(parent() == right->parent());
+    assert(position() + 1 == right->position());
+    assert(to_move >= 1 && to_move <= count());
+    assert(right->count() + to_move <= right->max_count());
+    btree_node* p = parent();
+    for (int i = right->count() - 1; i >= 0; --i) {
+      slot_policy::transfer(alloc, right->slot(i + to_move), right->slot(i));
+    }
+    slot_policy::transfer(alloc, right->slot(to_move - 1),
+                          p->slot(position()));
+    const int first = count() - to_move;
+    for (int i = 1; i < to_move; ++i) {
+      slot_policy::transfer(alloc, right->slot(i - 1), slot(first + i));
+    }
+    slot_policy::transfer(alloc, p->slot(position()), slot(first));
+    if (!leaf()) {
+      for (int i = right->count(); i >= 0; --i) {
+        right->init_child(i + to_move, right->child(i));
+      }
+      for (int i = 1; i <= to_move; ++i) {
+        right->init_child(i - 1, child(first + i));
+      }
+    }
+    set_count(first);
+    right->set_count(right->count() + to_move);
+  }
+
+  // Moves all values to `dest`, an empty leaf with room for them.
+  void transfer_all(btree_node* dest, allocator_type* alloc) {
+    assert(leaf() && dest->leaf() && dest->count() == 0);
+    for (int i = 0; i < count(); ++i) {
+      slot_policy::transfer(alloc, dest->slot(i), slot(i));
+    }
+    dest->set_count(count());
+    set_count(0);
+  }
+
+  void destroy_values(allocator_type* alloc) {
+    for (int i = 0; i < count(); ++i) slot_policy::destroy(alloc, slot(i));
+    set_count(0);
+  }
+
+ private:
+  btree_node() = default;
+
+  btree_node** children() const {
+    assert(!leaf());
+    return reinterpret_cast<btree_node**>(
+        reinterpret_cast<char*>(const_cast<btree_node*>(this)) +
+        kChildrenOffset);
+  }
+
+  template <class K>
+  int lower_bound(const K& k, const key_compare& comp, std::true_type) const {
+    int i = 0;
+    while (i < count() && comp(key(i), k)) ++i;
+    return i;
+  }
+  template <class K>
+  int lower_bound(const K& k, const key_compare& comp,
+                  std::false_type) const {
+    int lo = 0, hi = count();
+    while (lo != hi) {
+      const int mid = (lo + hi) >> 1;
+      if (comp(key(mid), k)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  template <class K>
+  int upper_bound(const K& k, const key_compare& comp, std::true_type) const {
+    int i = 0;
+    while (i < count() && !comp(k, key(i))) ++i;
+    return i;
+  }
+  template <class K>
+  int upper_bound(const K& k, const key_compare& comp,
+                  std::false_type) const {
+    int lo = 0, hi = count();
+    while (lo != hi) {
+      const int mid = (lo + hi) >> 1;
+      if (comp(k, key(mid))) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+
+  btree_node_header header_;
+};
+
+template <class Params>
+constexpr int btree_node<Params>::kNodeValues;
+template <class Params>
+constexpr int btree_node<Params>::kMinNodeValues;
+template <class Params>
+constexpr size_t btree_node<Params>::kInternalSize;
+
+// Points at value `position` of `node`. end() points one past the last value
+// of the rightmost leaf.
+template <class Node, class Reference, class Pointer>
+struct btree_iterator {
+  using key_type = typename Node::key_type;
+  using value_type = typename Node::value_type;
+  using difference_type = ptrdiff_t;
+  using reference = Reference;
+  using pointer = Pointer;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  using iterator = btree_iterator<Node, value_type&, value_type*>;
+  using const_iterator =
+      btree_iterator<Node, const value_type&, const value_type*>;
+
+  btree_iterator() : node(nullptr), position(-1) {}
+  btree_iterator(Node* n, int p) : node(n), position(p) {}
+  // Implicit construction of a const_iterator from an iterator.
+  template <class It,
+            typename std::enable_if<std::is_same<It, iterator>::value &&
+                                        !std::is_same<It, btree_iterator>::value,
+                                    int>::type = 0>
+  btree_iterator(const It& x)  // NOLINT
+      : node(x.node), position(x.position) {}
+
+  reference operator*() const { return node->value(position); }
+  pointer operator->() const { return &node->value(position); }
+  const key_type& key() const { return node->key(position); }
+
+  btree_iterator& operator++() {
+    increment();
+    return *this;
+  }
+  btree_iterator operator++(int) {
+    btree_iterator tmp = *this;
+    increment();
+    return tmp;
+  }
+  btree_iterator& operator--() {
+    decrement();
+    return *this;
+  }
+  btree_iterator operator--(int) {
+    btree_iterator tmp = *this;
+    decrement();
+    return tmp;
+  }
+
+  bool operator==(const iterator& x) const {
+    return node == x.node && position == x.position;
+  }
+  bool operator==(const const_iterator& x) const {
+    return node == x.node && position == x.position;
+  }
+  bool operator!=(const iterator& x) const { return !(*this == x); }
+  bool operator!=(const const_iterator& x) const { return !(*this == x); }
+
+  void increment() {
+    if (node->leaf() && ++position < node->count()) return;
+    increment_slow();
+  }
+  void decrement() {
+    if (node->leaf() && --position >= 0) return;
+    decrement_slow();
+  }
+
+  Node* node;
+  int position;
+
+ private:
+  void increment_slow() {
+    if (node->leaf()) {
+      // Past the last value of a leaf: the next value is in the first
+      // ancestor this leaf is not in the last subtree of. From the last
+      // leaf, there is none, and the iterator stays at end().
+      assert(position >= node->count());
+      btree_iterator save(*this);
+      while (position == node->count() && !node->is_root()) {
+        position = node->position();
+        node = node->parent();
+      }
+      if (position == node->count()) *this = save;
+    } else {
+      // The next value is the first of the subtree after this one.
+      node = node->child(position + 1);
+      while (!node->leaf()) node = node->child(0);
+      position = 0;
+    }
+  }
+
+  void decrement_slow() {
+    if (node->leaf()) {
+      assert(position <= -1);
+      btree_iterator save(*this);
+      while (position < 0 && !node->is_root()) {
+        position = node->position() - 1;
+        node = node->parent();
+      }
+      if (position < 0) *this = save;
+    } else {
+      node = node->child(position);
+      while (!node->leaf()) node = node->child(node->count());
+      position = node->count() - 1;
+    }
+  }
+};
+
+template <class Params>
+class btree {
+  using node_type = btree_node<Params>;
+  using slot_policy = typename Params::slot_policy;
+  using slot_type = typename Params::slot_type;
+  using AllocTraits = std::allocator_traits<typename Params::allocator_type>;
+
+  template <size_t Align>
+  struct alignas(Align) AlignedType {};
+  using NodeAlloc = typename AllocTraits::template rebind_alloc<
+      AlignedType<node_type::kAlignment>>;
+  using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+  static constexpr int kNodeValues = node_type::kNodeValues;
+  static constexpr int kMinNodeValues = node_type::kMinNodeValues;
+
+ public:
+  using params_type = Params;
+  using key_type = typename Params::key_type;
+  using value_type = typename Params::value_type;
+  using init_type = typename Params::init_type;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using key_compare = typename Params::key_compare;
+  using allocator_type = typename Params::allocator_type;
+  using reference =
+      typename std::conditional<Params::kConstantIterators,
+                                const value_type&, value_type&>::type;
+  using const_reference = const value_type&;
+  using pointer = typename std::remove_reference<reference>::type*;
+  using const_pointer = const value_type*;
+  using iterator = btree_iterator<node_type, reference, pointer>;
+  using const_iterator =
+      btree_iterator<node_type, const_reference, const_pointer>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  btree(const key_compare& comp, const allocator_type& alloc)
+      : comp_(comp), alloc_(alloc) {}
+
+  btree(const btree& x)
+      : btree(x, AllocTraits::select_on_container_copy_construction(
+                     x.alloc_)) {}
+
+  btree(const btree& x, const allocator_type& alloc)
+      : btree(x.comp_, alloc) {
+    // The values are in order, so each one is appended.
+    for (const_iterator it = x.begin(); it != x.end(); ++it) {
+      append(*it);
+    }
+  }
+
+  btree(btree&& x) noexcept
+      : root_(x.root_),
+        leftmost_(x.leftmost_),
+        rightmost_(x.rightmost_),
+        size_(x.size_),
+        comp_(x.comp_),
+        alloc_(x.alloc_) {
+    x.reset_to_empty();
+  }
+
+  btree(btree&& x, const allocator_type& alloc) : btree(x.comp_, alloc) {
+    if (alloc_ == x.alloc_) {
+      swap_storage(x);
+    } else {
+      for (iterator it = x.begin(); it != x.end(); ++it) {
+        append(std::move(*it));
+      }
+    }
+  }
+
+  btree& operator=(const btree& x) {
+    btree tmp(x, AllocTraits::propagate_on_container_copy_assignment::value
+                     ? x.alloc_
+                     : alloc_);
+    assign(tmp);
+    return *this;
+  }
+
+  btree& operator=(btree&& x) noexcept(
+      AllocTraits::propagate_on_container_move_assignment::value) {
+    btree tmp(std::move(x),
+              AllocTraits::propagate_on_container_move_assignment::value
+                  ? x.alloc_
+                  : alloc_);
+    assign(tmp);
+    return *this;
+  }
+
+  ~btree() { clear(); }
+
+  iterator begin() { return iterator(leftmost_, 0); }
+  const_iterator begin() const { return const_iterator(leftmost_, 0); }
+  iterator end() {
+    return iterator(rightmost_, rightmost_ ? rightmost_->count() : 0);
+  }
+  const_iterator end() const {
+    return const_iterator(rightmost_, rightmost_ ? rightmost_->count() : 0);
+  }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  template <class K>
+  iterator lower_bound(const K& key) {
+    return internal_end(internal_last(internal_lower_bound(key)));
+  }
+  template <class K>
+  const_iterator lower_bound(const K& key) const {
+    return const_cast<btree*>(this)->lower_bound(key);
+  }
+
+  template <class K>
+  iterator upper_bound(const K& key) {
+    return internal_end(internal_last(internal_upper_bound(key)));
+  }
+  template <class K>
+  const_iterator upper_bound(const K& key) const {
+    return const_cast<btree*>(this)->upper_bound(key);
+  }
+
+  template <class K>
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    iterator lower = lower_bound(key);
+    if (Params::kIsMulti) return {lower, upper_bound(key)};
+    if (lower == end() || comp_(key, lower.key())) return {lower, lower};
+    return {lower, std::next(lower)};
+  }
+  template <class K>
+  std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+    return const_cast<btree*>(this)->equal_range(key);
+  }
+
+  template <class K>
+  iterator find(const K& key) {
+    iterator it = lower_bound(key);
+    if (it == end() || comp_(key, it.key())) return end();
+    return it;
+  }
+  template <class K>
+  const_iterator find(const K& key) const {
+    return const_cast<btree*>(this)->find(key);
+  }
+
+  template <class K>
+  size_type count(const K& key) const {
+    if (!Params::kIsMulti) return find(key) != end();
+    auto range = equal_range(key);
+    return std::distance(range.first, range.second);
+  }
+
+  // Inserts an element built from `args` unless one with `key` is present,
+  // which `args` must build. `args` are left untouched if it is.
+  template <class K, class... Args>
+  std::pair<iterator, bool> insert_unique(const K& key, Args&&... args) {
+    auto res = find_or_prepare_insert_unique(key);
+    if (!res.second) return res;
+    return {emplace_at(res.first, std::forward<Args>(args)...), true};
+  }
+
+  // The same, trying the position before `hint` first.
+  template <class K, class... Args>
+  std::pair<iterator, bool> insert_hint_unique(iterator hint, const K& key,
+                                               Args&&... args) {
+    auto res = find_or_prepare_insert_hint_unique(hint, key);
+    if (!res.second) return res;
+    return {emplace_at(res.first, std::forward<Args>(args)...), true};
+  }
+
+  // Inserts an element built from `args` unless one with its key is present.
+  // The element is built before its key is looked up, unless `args` is a
+  // single value_type or init_type.
+  template <class... Args>
+  std::pair<iterator, bool> emplace_unique(Args&&... args) {
+    return emplace_unique_impl(IsKeyed<Params, Args...>(),
+                               std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace_hint_unique(iterator hint,
+                                                Args&&... args) {
+    return emplace_hint_unique_impl(IsKeyed<Params, Args...>(), hint,
+                                    std::forward<Args>(args)...);
+  }
+
+  // Inserts an element built from `args` after the elements with its key.
+  template <class... Args>
+  iterator emplace_multi(Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    slot_policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    iterator it = internal_upper_bound(Params::key(slot_policy::element(slot)));
+    return internal_emplace(it, slot);
+  }
+
+  // The same, at `hint` if the element goes there.
+  template <class... Args>
+  iterator emplace_hint_multi(iterator hint, Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    slot_policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    const key_type& key = Params::key(slot_policy::element(slot));
+    if (!empty()) {
+      if (hint == end() || !comp_(hint.key(), key)) {
+        iterator prev = hint;
+        if (hint == begin() || !comp_(key, (--prev).key())) {
+          return internal_emplace(hint, slot);
+        }
+      } else {
+        iterator next = hint;
+        ++next;
+        if (next == end() || !comp_(next.key(), key)) {
+          return internal_emplace(next, slot);
+        }
+      }
+    }
+    return internal_emplace(internal_upper_bound(key), slot);
+  }
+
+  // Erases the element at `iter`, and returns an iterator to the next one.
+  iterator erase(iterator iter) {
+    assert(iter != end());
+    bool internal_delete = false;
+    if (!iter.node->leaf()) {
+      // The value in an internal node is replaced by its predecessor, which
+      // is in a leaf, and the predecessor's slot is erased instead.
+      iterator internal_iter = iter;
+      --iter;
+      assert(iter.node->leaf());
+      slot_type* target = internal_iter.node->slot(internal_iter.position);
+      slot_policy::destroy(&alloc_, target);
+      slot_policy::transfer(&alloc_, target, iter.node->slot(iter.position));
+      iter.node->remove_slot(iter.position, &alloc_);
+      internal_delete = true;
+    } else {
+      iter.node->remove_value(iter.position, &alloc_);
+    }
+    --size_;
+
+    // `iter` now points at the value after the erased slot, which the
+    // rebalancing can move. After an internal erase, that value is the
+    // predecessor that replaced the erased one, so the next is after it.
+    iterator res = rebalance_after_delete(iter);
+    if (internal_delete) ++res;
+    return res;
+  }
+
+  iterator erase(iterator first, iterator last) {
+    difference_type n = std::distance(first, last);
+    if (static_cast<size_type>(n) == size_) {
+      clear();
+      return end();
+    }
+    while (n-- > 0) first = erase(first);
+    return first;
+  }
+
+  template <class K>
+  size_type erase_unique(const K& key) {
+    iterator it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  template <class K>
+  size_type erase_multi(const K& key) {
+    auto range = equal_range(key);
+    const size_type n = std::distance(range.first, range.second);
+    erase(range.first, range.second);
+    return n;
+  }
+
+  void clear() {
+    if (root_ != nullptr) internal_clear(root_);
+    reset_to_empty();
+  }
+
+  void swap(btree& x) noexcept {
+    using std::swap;
+    swap_storage(x);
+    swap(comp_, x.comp_);
+    if (AllocTraits::propagate_on_container_swap::value) {
+      swap(alloc_, x.alloc_);
+    }
+  }
+
+  const key_compare& key_comp() const { return comp_; }
+  allocator_type get_allocator() const { return alloc_; }
+  size_type size() const { return size_; }
+  size_type max_size() const { return (std::numeric_limits<size_t>::max)(); }
+  bool empty() const { return size_ == 0; }
+
+  // Checks the invariants of the tree, for tests.
+  void verify() const {
+    assert(root_ == nullptr || root_->is_root());
+    assert((root_ == nullptr) == (size_ == 0));
+    if (root_ == nullptr) return;
+    const node_type* leftmost = root_;
+    while (!leftmost->leaf()) leftmost = leftmost->child(0);
+    const node_type* rightmost = root_;
+    while (!rightmost->leaf()) rightmost = rightmost->child(rightmost->count());
+    assert(leftmost == leftmost_);
+    assert(rightmost == rightmost_);
+    int leaf_depth = -1;
+    const size_type n = internal_verify(root_, nullptr, nullptr, 0,
+                                        &leaf_depth);
+    assert(n == size_);
+    (void)leftmost;
+    (void)rightmost;
+    (void)n;
+  }
+
+ private:
+  template <class T>
+  std::pair<iterator, bool> emplace_unique_impl(std::true_type, T&& v) {
+    return insert_unique(Params::key(v), std::forward<T>(v));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace_unique_impl(std::false_type,
+                                                Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    slot_policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    auto res =
+        find_or_prepare_insert_unique(Params::key(slot_policy::element(slot)));
+    if (!res.second) {
+      slot_policy::destroy(&alloc_, slot);
+      return res;
+    }
+    return {internal_emplace(res.first, slot), true};
+  }
+
+  template <class T>
+  std::pair<iterator, bool> emplace_hint_unique_impl(std::true_type,
+                                                     iterator hint, T&& v) {
+    return insert_hint_unique(hint, Params::key(v), std::forward<T>(v));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace_hint_unique_impl(std::false_type,
+                                                     iterator hint,
+                                                     Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    slot_policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    auto res = find_or_prepare_insert_hint_unique(
+        hint, Params::key(slot_policy::element(slot)));
+    if (!res.second) {
+      slot_policy::destroy(&alloc_, slot);
+      return res;
+    }
+    return {internal_emplace(res.first, slot), true};
+  }
+
+  // Builds an element from `args` aside, so that the tree is left as it was
+  // if that throws, and inserts it at `iter`.
+  template <class... Args>
+  iterator emplace_at(iterator iter, Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    slot_policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    return internal_emplace(iter, slot);
+  }
+
+  // Inserts an element built from `args` after the last one.
+  template <class... Args>
+  void append(Args&&... args) {
+    emplace_at(end(), std::forward<Args>(args)...);
+  }
+
+  // The element with `key`, and false; or where to insert one, and true.
+  template <class K>
+  std::pair<iterator, bool> find_or_prepare_insert_unique(const K& key) {
+    iterator iter = internal_lower_bound_leaf(key);
+    iterator last = internal_last(iter);
+    if (last.node != nullptr && !comp_(key, last.key())) return {last, false};
+    return {iter, true};
+  }
+
+  template <class K>
+  std::pair<iterator, bool> find_or_prepare_insert_hint_unique(
+      iterator hint, const K& key) {
+    if (!empty()) {
+      if (hint == end() || comp_(key, hint.key())) {
+        iterator prev = hint;
+        if (hint == begin() || comp_((--prev).key(), key)) {
+          // prev.key() < key < hint.key()
+          return {hint, true};
+        }
+      } else if (comp_(hint.key(), key)) {
+        ++hint;
+        if (hint == end() || comp_(key, hint.key())) {
+          // The original hint.key() < key < hint.key()
+          return {hint, true};
+        }
+      } else {
+        return {hint, false};
+      }
+    }
+    return find_or_prepare_insert_unique(key);
+  }
+
+  // Moves the element in `slot` into the tree before `iter`.
+  iterator internal_emplace(iterator iter, slot_type* slot) {
+    if (root_ == nullptr) {
+      root_ = leftmost_ = rightmost_ = new_leaf_node(nullptr, 1);
+      iter = iterator(root_, 0);
+    } else if (!iter.node->leaf()) {
+      // Before a value of an internal node is after the last value of the
+      // subtree before it, which is in a leaf.
+      --iter;
+      ++iter.position;
+    }
+    const int max_count = iter.node->max_count();
+    if (iter.node->count() == max_count) {
+      if (max_count < kNodeValues) {
+        // Only a root leaf is smaller than a full node.
+        assert(iter.node == root_);
+        node_type* grown = new_leaf_node(
+            nullptr, 2 * max_count < kNodeValues ? 2 * max_count
+                                                 : static_cast<int>(kNodeValues));
+        root_->transfer_all(grown, &alloc_);
+        delete_leaf_node(root_);
+        root_ = leftmost_ = rightmost_ = iter.node = grown;
+      } else {
+        rebalance_or_split(&iter);
+      }
+    }
+    iter.node->insert_value(iter.position, &alloc_, slot);
+    ++size_;
+    return iter;
+  }
+
+  // Makes room in the full node of `iter` for a value at its position, and
+  // points `iter` at where that is now.
+  void rebalance_or_split(iterator* iter) {
+    node_type*& node = iter->node;
+    int& insert_position = iter->position;
+    assert(node->count() == node->max_count());
+    node_type* parent = node->parent();
+    if (node != root_) {
+      if (node->position() > 0) {
+        // Try moving values to the left sibling: all the room there when
+        // appending, else half of it.
+        node_type* left = parent->child(node->position() - 1);
+        if (left->count() < kNodeValues) {
+          int to_move = (kNodeValues - left->count()) /
+                        (1 + (insert_position < kNodeValues));
+          to_move = std::max(1, to_move);
+          if (insert_position - to_move >= 0 ||
+              left->count() + to_move < kNodeValues) {
+            left->rebalance_right_to_left(to_move, node, &alloc_);
+            insert_position -= to_move;
+            if (insert_position < 0) {
+              insert_position += left->count() + 1;
+              node = left;
+            }
+            return;
+          }
+        }
+      }
+      if (node->position() < parent->count()) {
+        // Try moving values to the right sibling: all the room there when
+        // prepending, else half of it.
+        node_type* right = parent->child(node->position() + 1);
+        if (right->count() < kNodeValues) {
+          int to_move =
+              (kNodeValues - right->count()) / (1 + (insert_position > 0));
+          to_move = std::max(1, to_move);
+          if (insert_position <= node->count() - to_move ||
+              right->count() + to_move < kNodeValues) {
+            node->rebalance_left_to_right(to_move, right, &alloc_);
+            if (insert_position > node->count()) {
+              insert_position -= node->count() + 1;
+              node = right;
+            }
+            return;
+          }
+        }
+      }
+      // The split moves a value up to the parent, which needs room for it.
+      if (parent->count() == kNodeValues) {
+        iterator parent_iter(parent, node->position());
+        rebalance_or_split(&parent_iter);
+      }
+    } else {
+      // The root splits under a new root.
+      parent = new_internal_node(nullptr);
+      parent->init_child(0, root_);
+      root_ = parent;
+    }
+
+    node_type* split_node;
+    if (node->leaf()) {
+      split_node = new_leaf_node(node->parent(), kNodeValues);
+      node->split(insert_position, split_node, &alloc_);
+      if (rightmost_ == node) rightmost_ = split_node;
+    } else {
+      split_node = new_internal_node(node->parent());
+      node->split(insert_position, split_node, &alloc_);
+    }
+    if (insert_position > node->count()) {
+      insert_position -= node->count() + 1;
+      node = split_node;
+    }
+  }
+
+  // Merges or rebalances the nodes left with too few values by an erase at
+  // `iter`, from its leaf up, and returns an iterator to the value that was
+  // after the erased one.
+  iterator rebalance_after_delete(iterator iter) {
+    iterator res = iter;
+    bool first_iteration = true;
+    for (;;) {
+      if (iter.node == root_) {
+        try_shrink();
+        if (empty()) return end();
+        break;
+      }
+      if (iter.node->count() >= kMinNodeValues) break;
+      const bool merged = try_merge_or_rebalance(&iter);
+      // Merging or rebalancing the leaf moves the values after the erased
+      // one along with `iter`.
+      if (first_iteration) {
+        res = iter;
+        first_iteration = false;
+      }
+      if (!merged) break;
+      iter.position = iter.node->position();
+      iter.node = iter.node->parent();
+    }
+    if (res.position == res.node->count()) {
+      res.position = res.node->count() - 1;
+      ++res;
+    }
+    return res;
+  }
+
+  // Merges the node of `iter` with a sibling if they fit in one node, and
+  // returns true; else moves values over from a sibling with more than it
+  // needs. Keeps `iter` pointing at the same value.
+  bool try_merge_or_rebalance(iterator* iter) {
+    node_type* node = iter->node;
+    node_type* parent = node->parent();
+    if (node->position() > 0) {
+      node_type* left = parent->child(node->position() - 1);
+      if (1 + left->count() + node->count() <= kNodeValues) {
+        iter->position += 1 + left->count();
+        merge_nodes(left, node);
+        iter->node = left;
+        return true;
+      }
+    }
+    if (node->position() < parent->count()) {
+      node_type* right = parent->child(node->position() + 1);
+      if (1 + node->count() + right->count() <= kNodeValues) {
+        merge_nodes(node, right);
+        return true;
+      }
+      // Erasing from the front of a node is common when draining a tree in
+      // order; refilling it from the right each time would be wasted work.
+      if (right->count() > kMinNodeValues &&
+          (node->count() == 0 || iter->position > 0)) {
+        int to_move = (right->count() - node->count()) / 2;
+        to_move = std::min(to_move, right->count() - 1);
+        node->rebalance_right_to_left(to_move, right, &alloc_);
+        return false;
+      }
+    }
+    if (node->position() > 0) {
+      // Likewise for erasing from the back.
+      node_type* left = parent->child(node->position() - 1);
+      if (left->count() > kMinNodeValues &&
+          (node->count() == 0 || iter->position < node->count())) {
+        int to_move = (left->count() - node->count()) / 2;
+        to_move = std::min(to_move, left->count() - 1);
+        left->rebalance_left_to_right(to_move, node, &alloc_);
+        iter->position += to_move;
+        return false;
+      }
+    }
+    return false;
+  }
+
+  void merge_nodes(node_type* left, node_type* right) {
+    left->merge(right, &alloc_);
+    if (right->leaf()) {
+      if (rightmost_ == right) rightmost_ = left;
+      delete_leaf_node(right);
+    } else {
+      delete_internal_node(right);
+    }
+  }
+
+  // Drops a root left without values, making its only child the root.
+  void try_shrink() {
+    if (root_->count() > 0) return;
+    if (root_->leaf()) {
+      assert(size_ == 0);
+      delete_leaf_node(root_);
+      reset_to_empty();
+    } else {
+      node_type* child = root_->child(0);
+      child->make_root();
+      delete_internal_node(root_);
+      root_ = child;
+    }
+  }
+
+  // A leaf iterator to where `key` goes before any equal keys.
+  template <class K>
+  iterator internal_lower_bound_leaf(const K& key) const {
+    node_type* node = root_;
+    if (node == nullptr) return iterator(nullptr, 0);
+    for (;;) {
+      const int pos = node->lower_bound(key, comp_);
+      if (node->leaf()) return iterator(node, pos);
+      node = node->child(pos);
+    }
+  }
+
+  // The first value not less than `key`, or a position past the end of a
+  // leaf; see internal_last(). A set stops at an equal key on the way down.
+  template <class K>
+  iterator internal_lower_bound(const K& key) const {
+    node_type* node = root_;
+    if (node == nullptr) return iterator(nullptr, 0);
+    for (;;) {
+      const int pos = node->lower_bound(key, comp_);
+      if (node->leaf()) return iterator(node, pos);
+      if (!Params::kIsMulti && pos < node->count() &&
+          !comp_(key, node->key(pos))) {
+        return iterator(node, pos);
+      }
+      node = node->child(pos);
+    }
+  }
+
+  // A leaf iterator to where `key` goes after any equal keys.
+  template <class K>
+  iterator internal_upper_bound(const K& key) const {
+    node_type* node = root_;
+    if (node == nullptr) return iterator(nullptr, 0);
+    for (;;) {
+      const int pos = node->upper_bound(key, comp_);
+      if (node->leaf()) return iterator(node, pos);
+      node = node->child(pos);
+    }
+  }
+
+  // Moves an iterator past the end of its leaf up to the value it stands
+  // for, or to a null node past the last value.
+  static iterator internal_last(iterator iter) {
+    while (iter.node != nullptr && iter.position == iter.node->count()) {
+      iter.position = iter.node->position();
+      iter.node = iter.node->parent();
+    }
+    return iter;
+  }
+
+  iterator internal_end(iterator iter) {
+    return iter.node != nullptr ? iter : end();
+  }
+
+  node_type* new_leaf_node(node_type* parent, int max_count) {
+    return node_type::InitLeaf(allocate(node_type::LeafSize(max_count)),
+                               parent, max_count);
+  }
+  node_type* new_internal_node(node_type* parent) {
+    return node_type::InitInternal(allocate(node_type::kInternalSize),
+                                   parent);
+  }
+
+  void delete_leaf_node(node_type* node) {
+    node->destroy_values(&alloc_);
+    deallocate(node, node_type::LeafSize(node->max_count()));
+  }
+  void delete_internal_node(node_type* node) {
+    node->destroy_values(&alloc_);
+    deallocate(node, node_type::kInternalSize);
+  }
+
+  void internal_clear(node_type* node) {
+    if (!node->leaf()) {
+      for (int i = 0; i <= node->count(); ++i) internal_clear(node->child(i));
+      delete_internal_node(node);
+    } else {
+      delete_leaf_node(node);
+    }
+  }
+
+  // Checks the subtree at `node`, whose keys are between `lo` and `hi` when
+  // those are given, and returns its number of values.
+  size_type internal_verify(const node_type* node, const key_type* lo,
+                            const key_type* hi, int depth,
+                            int* leaf_depth) const {
+    assert(node->count() > 0);
+    assert(node->count() <= node->max_count());
+    if (lo != nullptr) assert(!comp_(node->key(0), *lo));
+    if (hi != nullptr) assert(!comp_(*hi, node->key(node->count() - 1)));
+    for (int i = 1; i < node->count(); ++i) {
+      assert(!comp_(node->key(i), node->key(i - 1)));
+    }
+    size_type n = node->count();
+    if (node->leaf()) {
+      if (*leaf_depth < 0) *leaf_depth = depth;
+      assert(*leaf_depth == depth);
+      return n;
+    }
+    for (int i = 0; i <= node->count(); ++i) {
+      const node_type* child = node->child(i);
+      assert(child->parent() == node);
+      assert(child->position() == i);
+      n += internal_verify(child, i == 0 ? lo : &node->key(i - 1),
+                           i == node->count() ? hi : &node->key(i),
+                           depth + 1, leaf_depth);
+    }
+    return n;
+  }
+
+  node_type* allocate(size_t bytes) {
+    NodeAlloc alloc(alloc_);
+    return reinterpret_cast<node_type*>(
+        NodeAllocTraits::allocate(alloc, AllocUnits(bytes)));
+  }
+  void deallocate(node_type* node, size_t bytes) {
+    NodeAlloc alloc(alloc_);
+    NodeAllocTraits::deallocate(
+        alloc,
+        reinterpret_cast<AlignedType<node_type::kAlignment>*>(node),
+        AllocUnits(bytes));
+  }
+  static size_t AllocUnits(size_t bytes) {
+    return (bytes + node_type::kAlignment - 1) / node_type::kAlignment;
+  }
+
+  void reset_to_empty() {
+    root_ = leftmost_ = rightmost_ = nullptr;
+    size_ = 0;
+  }
+
+  void swap_storage(btree& x) {
+    using std::swap;
+    swap(root_, x.root_);
+    swap(leftmost_, x.leftmost_);
+    swap(rightmost_, x.rightmost_);
+    swap(size_, x.size_);
+  }
+
+  // Takes the contents of `tmp`, with the allocator they were allocated
+  // with, and leaves it ours to destroy.
+  void assign(btree& tmp) {
+    using std::swap;
+    swap_storage(tmp);
+    swap(comp_, tmp.comp_);
+    swap(alloc_, tmp.alloc_);
+  }
+
+  node_type* root_ = nullptr;
+  node_type* leftmost_ = nullptr;
+  node_type* rightmost_ = nullptr;
+  size_type size_ = 0;
+  key_compare comp_;
+  allocator_type alloc_;
+};
+
+template <class Params>
+constexpr int btree<Params>::kNodeValues;
+template <class Params>
+constexpr int btree<Params>::kMinNodeValues;
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_BTREE_H_
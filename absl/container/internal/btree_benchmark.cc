@@ -0,0 +1,111 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+std::vector<uint64_t> RandomKeys(size_t n, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> keys(n);
+  for (auto& k : keys) k = gen();
+  return keys;
+}
+
+template <class Set>
+void BM_FindHit(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  Set set(keys.begin(), keys.end());
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(set.find(keys[i]));
+    if (++i == keys.size()) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_FindHit, absl::btree_set<uint64_t>)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindHit, std::set<uint64_t>)->Range(16, 1 << 20);
+
+template <class Set>
+void BM_InsertRandom(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  while (state.KeepRunning()) {
+    Set set;
+    for (uint64_t k : keys) set.insert(k);
+    benchmark::DoNotOptimize(set);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_InsertRandom, absl::btree_set<uint64_t>)
+    ->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_InsertRandom, std::set<uint64_t>)->Range(16, 1 << 16);
+
+// Building from sorted input takes the end() hint on every insertion and
+// leaves the btree's nodes full.
+template <class Set>
+void BM_InsertSorted(benchmark::State& state) {
+  auto keys = RandomKeys(state.range(0), 1);
+  std::sort(keys.begin(), keys.end());
+  while (state.KeepRunning()) {
+    Set set(keys.begin(), keys.end());
+    benchmark::DoNotOptimize(set);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_InsertSorted, absl::btree_set<uint64_t>)
+    ->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_InsertSorted, std::set<uint64_t>)->Range(16, 1 << 16);
+
+template <class Set>
+void BM_Iterate(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  Set set(keys.begin(), keys.end());
+  while (state.KeepRunning()) {
+    uint64_t sum = 0;
+    for (uint64_t k : set) sum += k;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_Iterate, absl::btree_set<uint64_t>)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Iterate, std::set<uint64_t>)->Range(16, 1 << 20);
+
+template <class Map>
+void BM_StringFindHit(benchmark::State& state) {
+  const auto ints = RandomKeys(state.range(0), 1);
+  std::vector<std::string> keys;
+  for (uint64_t k : ints) keys.push_back(std::to_string(k));
+  Map map;
+  for (const auto& k : keys) map[k] = 0;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(map.find(keys[i]));
+    if (++i == keys.size()) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_StringFindHit, absl::btree_map<std::string, int>)
+    ->Range(16, 1 << 18);
+BENCHMARK_TEMPLATE(BM_StringFindHit, std::map<std::string, int>)
+    ->Range(16, 1 << 18);
+
+}  // namespace
@@ -0,0 +1,599 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The interfaces of `std::set`, `std::multiset`, `std::map` and
+// `std::multimap`, over a `btree`.
+
+#ifndef ABSL_CONTAINER_INTERNAL_BTREE_CONTAINER_H_
+#define ABSL_CONTAINER_INTERNAL_BTREE_CONTAINER_H_
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "absl/base/internal/throw_delegate.h"
+#include "absl/container/internal/btree.h"
+#include "absl/container/internal/common.h"
+#include "absl/container/internal/container_memory.h"
+
+namespace absl {
+namespace container_internal {
+
+// The nodes of the public containers take about four cache lines.
+constexpr int kBtreeTargetNodeSize = 256;
+
+template <class Key, class Compare, class Alloc, bool Multi>
+struct set_params {
+  using key_type = Key;
+  using key_compare = typename BtreeKeyCompare<Compare>::type;
+  using value_compare = key_compare;
+  using value_type = Key;
+  using init_type = Key;
+  using allocator_type = Alloc;
+  using slot_policy = set_slot_policy<Key>;
+  using slot_type = typename slot_policy::slot_type;
+  static constexpr int kTargetNodeSize = kBtreeTargetNodeSize;
+  static constexpr bool kIsMulti = Multi;
+  static constexpr bool kConstantIterators = true;
+
+  static const Key& key(const Key& v) { return v; }
+};
+
+template <class Key, class Data, class Compare, class Alloc, bool Multi>
+struct map_params {
+  using key_type = Key;
+  using mapped_type = Data;
+  using key_compare = typename BtreeKeyCompare<Compare>::type;
+  using value_type = std::pair<const Key, Data>;
+  using init_type = std::pair<Key, Data>;
+  using allocator_type = Alloc;
+  using slot_policy = map_slot_policy<Key, Data>;
+  using slot_type = typename slot_policy::slot_type;
+  static constexpr int kTargetNodeSize = kBtreeTargetNodeSize;
+  static constexpr bool kIsMulti = Multi;
+  static constexpr bool kConstantIterators = false;
+
+  template <class P>
+  static const Key& key(const P& p) {
+    return p.first;
+  }
+
+  class value_compare {
+   public:
+    explicit value_compare(const key_compare& comp) : comp_(comp) {}
+
+    bool operator()(const value_type& a, const value_type& b) const {
+      return comp_(a.first, b.first);
+    }
+
+   private:
+    key_compare comp_;
+  };
+};
+
+// What all four containers share.
+template <class Tree>
+class btree_container {
+ protected:
+  template <class K>
+  using key_arg = typename KeyArg<IsTransparent<
+      typename Tree::key_compare>::value>::template type<K,
+                                                         typename Tree::
+                                                             key_type>;
+
+ public:
+  using key_type = typename Tree::key_type;
+  using value_type = typename Tree::value_type;
+  using size_type = typename Tree::size_type;
+  using difference_type = typename Tree::difference_type;
+  using key_compare = typename Tree::key_compare;
+  using allocator_type = typename Tree::allocator_type;
+  using reference = typename Tree::reference;
+  using const_reference = typename Tree::const_reference;
+  using pointer = typename Tree::pointer;
+  using const_pointer = typename Tree::const_pointer;
+  using iterator = typename Tree::iterator;
+  using const_iterator = typename Tree::const_iterator;
+  using reverse_iterator = typename Tree::reverse_iterator;
+  using const_reverse_iterator = typename Tree::const_reverse_iterator;
+
+  btree_container() : tree_(key_compare(), allocator_type()) {}
+  explicit btree_container(const key_compare& comp,
+                           const allocator_type& alloc = allocator_type())
+      : tree_(comp, alloc) {}
+  explicit btree_container(const allocator_type& alloc)
+      : tree_(key_compare(), alloc) {}
+
+  btree_container(const btree_container& x) = default;
+  btree_container(btree_container&& x) noexcept = default;
+  btree_container(const btree_container& x, const allocator_type& alloc)
+      : tree_(x.tree_, alloc) {}
+  btree_container(btree_container&& x, const allocator_type& alloc)
+      : tree_(std::move(x.tree_), alloc) {}
+
+  btree_container& operator=(const btree_container& x) = default;
+  btree_container& operator=(btree_container&& x) = default;
+
+  iterator begin() { return tree_.begin(); }
+  const_iterator begin() const { return tree_.begin(); }
+  const_iterator cbegin() const { return tree_.begin(); }
+  iterator end() { return tree_.end(); }
+  const_iterator end() const { return tree_.end(); }
+  const_iterator cend() const { return tree_.end(); }
+  reverse_iterator rbegin() { return tree_.rbegin(); }
+  const_reverse_iterator rbegin() const { return tree_.rbegin(); }
+  const_reverse_iterator crbegin() const { return tree_.rbegin(); }
+  reverse_iterator rend() { return tree_.rend(); }
+  const_reverse_iterator rend() const { return tree_.rend(); }
+  const_reverse_iterator crend() const { return tree_.rend(); }
+
+  // Lookups take any key type when `key_compare` defines `is_transparent`,
+  // which it does for string keys under the default comparator.
+  template <class K = key_type>
+  iterator find(const key_arg<K>& key) {
+    return tree_.find(key);
+  }
+  template <class K = key_type>
+  const_iterator find(const key_arg<K>& key) const {
+    return tree_.find(key);
+  }
+  template <class K = key_type>
+  bool contains(const key_arg<K>& key) const {
+    return find(key) != end();
+  }
+  template <class K = key_type>
+  size_type count(const key_arg<K>& key) const {
+    return tree_.count(key);
+  }
+  template <class K = key_type>
+  iterator lower_bound(const key_arg<K>& key) {
+    return tree_.lower_bound(key);
+  }
+  template <class K = key_type>
+  const_iterator lower_bound(const key_arg<K>& key) const {
+    return tree_.lower_bound(key);
+  }
+  template <class K = key_type>
+  iterator upper_bound(const key_arg<K>& key) {
+    return tree_.upper_bound(key);
+  }
+  template <class K = key_type>
+  const_iterator upper_bound(const key_arg<K>& key) const {
+    return tree_.upper_bound(key);
+  }
+  template <class K = key_type>
+  std::pair<iterator, iterator> equal_range(const key_arg<K>& key) {
+    return tree_.equal_range(key);
+  }
+  template <class K = key_type>
+  std::pair<const_iterator, const_iterator> equal_range(
+      const key_arg<K>& key) const {
+    return tree_.equal_range(key);
+  }
+
+  // Erases the element at `pos`, and returns an iterator to the next one.
+  // Erasing invalidates all iterators.
+  iterator erase(const_iterator pos) { return tree_.erase(MakeMutable(pos)); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(MakeMutable(first), MakeMutable(last));
+  }
+
+  void clear() { tree_.clear(); }
+  void swap(btree_container& x) { tree_.swap(x.tree_); }
+
+  size_type size() const { return tree_.size(); }
+  size_type max_size() const { return tree_.max_size(); }
+  bool empty() const { return tree_.empty(); }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  allocator_type get_allocator() const { return tree_.get_allocator(); }
+
+  // Checks the invariants of the tree, for tests.
+  void verify() const { tree_.verify(); }
+
+  friend bool operator==(const btree_container& x,
+                         const btree_container& y) {
+    return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+  }
+  friend bool operator!=(const btree_container& x,
+                         const btree_container& y) {
+    return !(x == y);
+  }
+  friend bool operator<(const btree_container& x, const btree_container& y) {
+    return std::lexicographical_compare(x.begin(), x.end(), y.begin(),
+                                        y.end());
+  }
+  friend bool operator>(const btree_container& x, const btree_container& y) {
+    return y < x;
+  }
+  friend bool operator<=(const btree_container& x,
+                         const btree_container& y) {
+    return !(y < x);
+  }
+  friend bool operator>=(const btree_container& x,
+                         const btree_container& y) {
+    return !(x < y);
+  }
+
+ protected:
+  static iterator MakeMutable(const_iterator it) {
+    return iterator(it.node, it.position);
+  }
+
+  Tree tree_;
+};
+
+template <class Tree>
+void swap(btree_container<Tree>& x, btree_container<Tree>& y) {
+  x.swap(y);
+}
+
+// The interface of `std::set`.
+template <class Tree>
+class btree_set_container : public btree_container<Tree> {
+  using Base = btree_container<Tree>;
+
+ protected:
+  using init_type = typename Tree::init_type;
+  template <class K>
+  using key_arg = typename Base::template key_arg<K>;
+
+ private:
+  template <class T>
+  using RequiresInsertable = typename std::enable_if<
+      std::is_constructible<typename Base::value_type, T&&>::value,
+      int>::type;
+
+ public:
+  using typename Base::allocator_type;
+  using typename Base::const_iterator;
+  using typename Base::iterator;
+  using typename Base::key_compare;
+  using typename Base::key_type;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  using Base::Base;
+
+  key_compare value_comp() const { return this->key_comp(); }
+
+  template <class InputIterator>
+  btree_set_container(InputIterator first, InputIterator last,
+                      const key_compare& comp = key_compare(),
+                      const allocator_type& alloc = allocator_type())
+      : Base(comp, alloc) {
+    insert(first, last);
+  }
+  template <class InputIterator>
+  btree_set_container(InputIterator first, InputIterator last,
+                      const allocator_type& alloc)
+      : btree_set_container(first, last, key_compare(), alloc) {}
+
+  btree_set_container(std::initializer_list<init_type> init,
+                      const key_compare& comp = key_compare(),
+                      const allocator_type& alloc = allocator_type())
+      : btree_set_container(init.begin(), init.end(), comp, alloc) {}
+  btree_set_container(std::initializer_list<init_type> init,
+                      const allocator_type& alloc)
+      : btree_set_container(init.begin(), init.end(), alloc) {}
+
+  // Inserts `value` unless an element with its key is present. Returns an
+  // iterator to the element with the key, and whether it was inserted.
+  template <class T, RequiresInsertable<T> = 0>
+  std::pair<iterator, bool> insert(T&& value) {
+    return this->tree_.emplace_unique(std::forward<T>(value));
+  }
+  std::pair<iterator, bool> insert(const init_type& value) {
+    return this->tree_.emplace_unique(value);
+  }
+  std::pair<iterator, bool> insert(init_type&& value) {
+    return this->tree_.emplace_unique(std::move(value));
+  }
+
+  // The same, in constant time if the element goes right before `hint`.
+  template <class T, RequiresInsertable<T> = 0>
+  iterator insert(const_iterator hint, T&& value) {
+    return this->tree_
+        .emplace_hint_unique(Base::MakeMutable(hint), std::forward<T>(value))
+        .first;
+  }
+  iterator insert(const_iterator hint, const init_type& value) {
+    return this->tree_.emplace_hint_unique(Base::MakeMutable(hint), value)
+        .first;
+  }
+  iterator insert(const_iterator hint, init_type&& value) {
+    return this->tree_
+        .emplace_hint_unique(Base::MakeMutable(hint), std::move(value))
+        .first;
+  }
+
+  // Each element is tried at the end first, so that sorted input is
+  // appended in constant time per element, and leaves the nodes full.
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      this->tree_.emplace_hint_unique(this->tree_.end(), *first);
+    }
+  }
+  void insert(std::initializer_list<init_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return this->tree_.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args&&... args) {
+    return this->tree_
+        .emplace_hint_unique(Base::MakeMutable(hint),
+                             std::forward<Args>(args)...)
+        .first;
+  }
+
+  using Base::erase;
+  // Erases the element with `key`, if any, and returns the number erased.
+  template <class K = key_type>
+  size_type erase(const key_arg<K>& key) {
+    return this->tree_.erase_unique(key);
+  }
+};
+
+// The interface of `std::map`.
+template <class Tree>
+class btree_map_container : public btree_set_container<Tree> {
+  using Base = btree_set_container<Tree>;
+
+ protected:
+  template <class K>
+  using key_arg = typename Base::template key_arg<K>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::iterator;
+  using typename Base::key_type;
+  using mapped_type = typename Tree::params_type::mapped_type;
+  using value_compare = typename Tree::params_type::value_compare;
+
+  using Base::Base;
+
+  value_compare value_comp() const { return value_compare(this->key_comp()); }
+
+  // Inserts the element, or assigns `v` to the mapped value of the element
+  // with key `k`.
+  template <class K = key_type, class V = mapped_type, K* = nullptr,
+            V* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K>&& k, V&& v) {
+    return insert_or_assign_impl(std::forward<K>(k), std::forward<V>(v));
+  }
+  template <class K = key_type, class V = mapped_type, K* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K>&& k, const V& v) {
+    return insert_or_assign_impl(std::forward<K>(k), v);
+  }
+  template <class K = key_type, class V = mapped_type, V* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(const key_arg<K>& k, V&& v) {
+    return insert_or_assign_impl(k, std::forward<V>(v));
+  }
+  template <class K = key_type, class V = mapped_type>
+  std::pair<iterator, bool> insert_or_assign(const key_arg<K>& k,
+                                             const V& v) {
+    return insert_or_assign_impl(k, v);
+  }
+
+  // Inserts an element with key `k` and a mapped value built from `args`,
+  // unless the key is present, in which case `args` are left untouched.
+  template <class K = key_type, class... Args,
+            typename std::enable_if<
+                !std::is_convertible<K, const_iterator>::value, int>::type = 0,
+            K* = nullptr>
+  std::pair<iterator, bool> try_emplace(key_arg<K>&& k, Args&&... args) {
+    return try_emplace_impl(std::forward<K>(k), std::forward<Args>(args)...);
+  }
+  template <class K = key_type, class... Args,
+            typename std::enable_if<
+                !std::is_convertible<K, const_iterator>::value, int>::type = 0>
+  std::pair<iterator, bool> try_emplace(const key_arg<K>& k, Args&&... args) {
+    return try_emplace_impl(k, std::forward<Args>(args)...);
+  }
+  template <class K = key_type, class... Args, K* = nullptr>
+  iterator try_emplace(const_iterator hint, key_arg<K>&& k, Args&&... args) {
+    return try_emplace_hint_impl(hint, std::forward<K>(k),
+                                 std::forward<Args>(args)...);
+  }
+  template <class K = key_type, class... Args>
+  iterator try_emplace(const_iterator hint, const key_arg<K>& k,
+                       Args&&... args) {
+    return try_emplace_hint_impl(hint, k, std::forward<Args>(args)...);
+  }
+
+  template <class K = key_type, K* = nullptr>
+  mapped_type& operator[](key_arg<K>&& key) {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+  template <class K = key_type>
+  mapped_type& operator[](const key_arg<K>& key) {
+    return try_emplace(key).first->second;
+  }
+
+  template <class K = key_type>
+  mapped_type& at(const key_arg<K>& key) {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      base_internal::ThrowStdOutOfRange("absl::btree_map::at");
+    }
+    return it->second;
+  }
+  template <class K = key_type>
+  const mapped_type& at(const key_arg<K>& key) const {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      base_internal::ThrowStdOutOfRange("absl::btree_map::at");
+    }
+    return it->second;
+  }
+
+ private:
+  template <class K, class V>
+  std::pair<iterator, bool> insert_or_assign_impl(K&& k, V&& v) {
+    // `v` is only used if the key is present; `k` only if it isn't.
+    auto res =
+        this->tree_.insert_unique(k, std::forward<K>(k), std::forward<V>(v));
+    if (!res.second) res.first->second = std::forward<V>(v);
+    return res;
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+    return this->tree_.insert_unique(
+        k, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(k)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class K, class... Args>
+  iterator try_emplace_hint_impl(const_iterator hint, K&& k,
+                                 Args&&... args) {
+    return this->tree_
+        .insert_hint_unique(Base::MakeMutable(hint), k,
+                            std::piecewise_construct,
+                            std::forward_as_tuple(std::forward<K>(k)),
+                            std::forward_as_tuple(std::forward<Args>(args)...))
+        .first;
+  }
+};
+
+// The interface of `std::multiset`.
+template <class Tree>
+class btree_multiset_container : public btree_container<Tree> {
+  using Base = btree_container<Tree>;
+
+ protected:
+  using init_type = typename Tree::init_type;
+  template <class K>
+  using key_arg = typename Base::template key_arg<K>;
+
+ private:
+  template <class T>
+  using RequiresInsertable = typename std::enable_if<
+      std::is_constructible<typename Base::value_type, T&&>::value,
+      int>::type;
+
+ public:
+  using typename Base::allocator_type;
+  using typename Base::const_iterator;
+  using typename Base::iterator;
+  using typename Base::key_compare;
+  using typename Base::key_type;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  using Base::Base;
+
+  key_compare value_comp() const { return this->key_comp(); }
+
+  template <class InputIterator>
+  btree_multiset_container(InputIterator first, InputIterator last,
+                           const key_compare& comp = key_compare(),
+                           const allocator_type& alloc = allocator_type())
+      : Base(comp, alloc) {
+    insert(first, last);
+  }
+  template <class InputIterator>
+  btree_multiset_container(InputIterator first, InputIterator last,
+                           const allocator_type& alloc)
+      : btree_multiset_container(first, last, key_compare(), alloc) {}
+
+  btree_multiset_container(std::initializer_list<init_type> init,
+                           const key_compare& comp = key_compare(),
+                           const allocator_type& alloc = allocator_type())
+      : btree_multiset_container(init.begin(), init.end(), comp, alloc) {}
+  btree_multiset_container(std::initializer_list<init_type> init,
+                           const allocator_type& alloc)
+      : btree_multiset_container(init.begin(), init.end(), alloc) {}
+
+  // Inserts `value` after the elements with its key.
+  template <class T, RequiresInsertable<T> = 0>
+  iterator insert(T&& value) {
+    return this->tree_.emplace_multi(std::forward<T>(value));
+  }
+  iterator insert(const init_type& value) {
+    return this->tree_.emplace_multi(value);
+  }
+  iterator insert(init_type&& value) {
+    return this->tree_.emplace_multi(std::move(value));
+  }
+
+  // The same, at `hint` if the element goes there.
+  template <class T, RequiresInsertable<T> = 0>
+  iterator insert(const_iterator hint, T&& value) {
+    return this->tree_.emplace_hint_multi(Base::MakeMutable(hint),
+                                          std::forward<T>(value));
+  }
+  iterator insert(const_iterator hint, const init_type& value) {
+    return this->tree_.emplace_hint_multi(Base::MakeMutable(hint), value);
+  }
+  iterator insert(const_iterator hint, init_type&& value) {
+    return this->tree_.emplace_hint_multi(Base::MakeMutable(hint),
+                                          std::move(value));
+  }
+
+  // See btree_set_container::insert().
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      this->tree_.emplace_hint_multi(this->tree_.end(), *first);
+    }
+  }
+  void insert(std::initializer_list<init_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  template <class... Args>
+  iterator emplace(Args&&... args) {
+    return this->tree_.emplace_multi(std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args&&... args) {
+    return this->tree_.emplace_hint_multi(Base::MakeMutable(hint),
+                                          std::forward<Args>(args)...);
+  }
+
+  using Base::erase;
+  // Erases the elements with `key`, and returns the number erased.
+  template <class K = key_type>
+  size_type erase(const key_arg<K>& key) {
+    return this->tree_.erase_multi(key);
+  }
+};
+
+// The interface of `std::multimap`.
+template <class Tree>
+class btree_multimap_container : public btree_multiset_container<Tree> {
+  using Base = btree_multiset_container<Tree>;
+
+ public:
+  using mapped_type = typename Tree::params_type::mapped_type;
+  using value_compare = typename Tree::params_type::value_compare;
+
+  using Base::Base;
+
+  value_compare value_comp() const { return value_compare(this->key_comp()); }
+};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_BTREE_CONTAINER_H_
@@ -0,0 +1,63 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Traits shared by the hash and B-tree containers.
+
+#ifndef ABSL_CONTAINER_INTERNAL_COMMON_H_
+#define ABSL_CONTAINER_INTERNAL_COMMON_H_
+
+#include <type_traits>
+
+#include "absl/meta/type_traits.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class T, class = void>
+struct IsTransparent : std::false_type {};
+template <class T>
+struct IsTransparent<T, absl::void_t<typename T::is_transparent>>
+    : std::true_type {};
+
+// The type that lookup functions take keys as: any `K` if the functions that
+// compare keys are transparent, else `key_type`.
+template <bool is_transparent>
+struct KeyArg {
+  template <class K, class key_type>
+  using type = key_type;
+};
+
+template <>
+struct KeyArg<true> {
+  template <class K, class key_type>
+  using type = K;
+};
+
+// Whether `insert()` and `emplace()` with `Ts` can look up the key of the
+// element before building it: from a single value_type or init_type of
+// `Policy`.
+template <class Policy, class... Ts>
+struct IsKeyed : std::false_type {};
+template <class Policy, class T>
+struct IsKeyed<Policy, T>
+    : std::integral_constant<
+          bool, std::is_same<typename std::decay<T>::type,
+                             typename Policy::value_type>::value ||
+                    std::is_same<typename std::decay<T>::type,
+                                 typename Policy::init_type>::value> {};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_COMMON_H_
@@ -0,0 +1,126 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// How the containers that store their elements in place build, destroy and
+// move them: the slot half of a container policy, shared by the hash and
+// B-tree containers.
+
+#ifndef ABSL_CONTAINER_INTERNAL_CONTAINER_MEMORY_H_
+#define ABSL_CONTAINER_INTERNAL_CONTAINER_MEMORY_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace absl {
+namespace container_internal {
+
+// A slot holds a `std::pair<const K, V>`, but is moved from as a
+// `std::pair<K, V>` when the two have the same layout, so that moving an
+// element between slots moves its key instead of copying it.
+template <class K, class V>
+union map_slot_type {
+  map_slot_type() {}
+  ~map_slot_type() = delete;
+  using value_type = std::pair<const K, V>;
+  using mutable_value_type = std::pair<K, V>;
+
+  value_type value;
+  mutable_value_type mutable_value;
+};
+
+template <class K, class V>
+struct IsLayoutCompatible
+    : std::integral_constant<
+          bool, std::is_standard_layout<std::pair<K, V>>::value &&
+                    std::is_standard_layout<std::pair<const K, V>>::value &&
+                    sizeof(std::pair<K, V>) ==
+                        sizeof(std::pair<const K, V>) &&
+                    alignof(std::pair<K, V>) ==
+                        alignof(std::pair<const K, V>)> {};
+
+template <class K, class V>
+struct map_slot_policy {
+  using slot_type = map_slot_type<K, V>;
+  using value_type = std::pair<const K, V>;
+
+  template <class Alloc, class... Args>
+  static void construct(Alloc* alloc, slot_type* slot, Args&&... args) {
+    std::allocator_traits<Alloc>::construct(*alloc, &slot->value,
+                                            std::forward<Args>(args)...);
+  }
+
+  template <class Alloc>
+  static void destroy(Alloc* alloc, slot_type* slot) {
+    std::allocator_traits<Alloc>::destroy(*alloc, &slot->value);
+  }
+
+  // Moves the element in `old_slot` to `new_slot`, leaving `old_slot`
+  // uninitialized.
+  template <class Alloc>
+  static void transfer(Alloc* alloc, slot_type* new_slot,
+                       slot_type* old_slot) {
+    transfer(alloc, new_slot, old_slot, IsLayoutCompatible<K, V>());
+  }
+
+  static value_type& element(slot_type* slot) { return slot->value; }
+
+ private:
+  template <class Alloc>
+  static void transfer(Alloc* alloc, slot_type* new_slot, slot_type* old_slot,
+                       std::true_type) {
+    std::allocator_traits<Alloc>::construct(
+        *alloc, &new_slot->mutable_value, std::move(old_slot->mutable_value));
+    destroy(alloc, old_slot);
+  }
+
+  template <class Alloc>
+  static void transfer(Alloc* alloc, slot_type* new_slot, slot_type* old_slot,
+                       std::false_type) {
+    construct(alloc, new_slot, std::move(old_slot->value));
+    destroy(alloc, old_slot);
+  }
+};
+
+// The same for a slot that holds a `T`.
+template <class T>
+struct set_slot_policy {
+  using slot_type = T;
+  using value_type = T;
+
+  template <class Alloc, class... Args>
+  static void construct(Alloc* alloc, slot_type* slot, Args&&... args) {
+    std::allocator_traits<Alloc>::construct(*alloc, slot,
+                                            std::forward<Args>(args)...);
+  }
+
+  template <class Alloc>
+  static void destroy(Alloc* alloc, slot_type* slot) {
+    std::allocator_traits<Alloc>::destroy(*alloc, slot);
+  }
+
+  template <class Alloc>
+  static void transfer(Alloc* alloc, slot_type* new_slot,
+                       slot_type* old_slot) {
+    construct(alloc, new_slot, std::move(*old_slot));
+    destroy(alloc, old_slot);
+  }
+
+  static value_type& element(slot_type* slot) { return *slot; }
+};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_CONTAINER_MEMORY_H_
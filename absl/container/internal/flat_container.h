@@ -0,0 +1,475 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The interfaces of `std::set` and `std::map`, over a sorted sequence
+// container.
+
+#ifndef ABSL_CONTAINER_INTERNAL_FLAT_CONTAINER_H_
+#define ABSL_CONTAINER_INTERNAL_FLAT_CONTAINER_H_
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/internal/throw_delegate.h"
+#include "absl/container/internal/common.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class Key>
+struct flat_set_params {
+  using key_type = Key;
+  using value_type = Key;
+  static constexpr bool kConstantIterators = true;
+
+  static const Key& key(const Key& v) { return v; }
+};
+
+template <class Key, class Value>
+struct flat_map_params {
+  using key_type = Key;
+  using mapped_type = Value;
+  // Not `std::pair<const Key, Value>`: the elements are moved around when
+  // others are inserted or erased.
+  using value_type = std::pair<Key, Value>;
+  static constexpr bool kConstantIterators = false;
+
+  static const Key& key(const value_type& v) { return v.first; }
+};
+
+// What sets and maps share. The elements of `Container` are kept sorted by
+// key, without two equivalent keys.
+template <class Params, class Compare, class Container>
+class flat_container {
+ protected:
+  template <class K>
+  using key_arg = typename KeyArg<IsTransparent<Compare>::value>::template type<
+      K, typename Params::key_type>;
+
+ public:
+  using key_type = typename Params::key_type;
+  using value_type = typename Params::value_type;
+  using key_compare = Compare;
+  using container_type = Container;
+  using size_type = typename Container::size_type;
+  using difference_type = typename Container::difference_type;
+  using reference = typename Container::reference;
+  using const_reference = typename Container::const_reference;
+  using const_iterator = typename Container::const_iterator;
+  using iterator =
+      typename std::conditional<Params::kConstantIterators, const_iterator,
+                                typename Container::iterator>::type;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+
+  class value_compare {
+   public:
+    explicit value_compare(const key_compare& comp) : comp_(comp) {}
+
+    bool operator()(const value_type& a, const value_type& b) const {
+      return comp_(Params::key(a), Params::key(b));
+    }
+
+   private:
+    key_compare comp_;
+  };
+
+  flat_container() = default;
+  explicit flat_container(const key_compare& comp) : comp_(comp) {}
+
+  // Builds the container from unsorted input in O(n log n): the elements are
+  // appended, sorted, and deduplicated in one pass. Of equivalent keys, the
+  // first one wins, as with `std::map`.
+  template <class InputIterator>
+  flat_container(InputIterator first, InputIterator last,
+                 const key_compare& comp = key_compare())
+      : comp_(comp), c_(first, last) {
+    MergeAppended(0);
+  }
+  flat_container(std::initializer_list<value_type> init,
+                 const key_compare& comp = key_compare())
+      : flat_container(init.begin(), init.end(), comp) {}
+
+  // Takes over the elements of `c`, which need not be sorted.
+  explicit flat_container(container_type c,
+                          const key_compare& comp = key_compare())
+      : comp_(comp), c_(std::move(c)) {
+    MergeAppended(0);
+  }
+
+  flat_container(const flat_container&) = default;
+  flat_container(flat_container&&) = default;
+  flat_container& operator=(const flat_container&) = default;
+  flat_container& operator=(flat_container&&) = default;
+
+  iterator begin() { return c_.begin(); }
+  const_iterator begin() const { return c_.begin(); }
+  const_iterator cbegin() const { return c_.begin(); }
+  iterator end() { return c_.end(); }
+  const_iterator end() const { return c_.end(); }
+  const_iterator cend() const { return c_.end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const { return rend(); }
+
+  // Lookups are binary searches, and take any key type when `key_compare`
+  // defines `is_transparent`.
+  template <class K = key_type>
+  iterator find(const key_arg<K>& key) {
+    auto it = LowerBound(key);
+    return it != c_.end() && !comp_(key, Params::key(*it)) ? it : c_.end();
+  }
+  template <class K = key_type>
+  const_iterator find(const key_arg<K>& key) const {
+    auto it = LowerBound(key);
+    return it != c_.end() && !comp_(key, Params::key(*it)) ? it : c_.end();
+  }
+  template <class K = key_type>
+  bool contains(const key_arg<K>& key) const {
+    return find(key) != end();
+  }
+  template <class K = key_type>
+  size_type count(const key_arg<K>& key) const {
+    return contains(key) ? 1 : 0;
+  }
+  template <class K = key_type>
+  iterator lower_bound(const key_arg<K>& key) {
+    return LowerBound(key);
+  }
+  template <class K = key_type>
+  const_iterator lower_bound(const key_arg<K>& key) const {
+    return LowerBound(key);
+  }
+  template <class K = key_type>
+  iterator upper_bound(const key_arg<K>& key) {
+    return UpperBound(key);
+  }
+  template <class K = key_type>
+  const_iterator upper_bound(const key_arg<K>& key) const {
+    return UpperBound(key);
+  }
+  template <class K = key_type>
+  std::pair<iterator, iterator> equal_range(const key_arg<K>& key) {
+    iterator it = LowerBound(key);
+    if (it == end() || comp_(key, Params::key(*it))) return {it, it};
+    return {it, std::next(it)};
+  }
+  template <class K = key_type>
+  std::pair<const_iterator, const_iterator> equal_range(
+      const key_arg<K>& key) const {
+    const_iterator it = LowerBound(key);
+    if (it == end() || comp_(key, Params::key(*it))) return {it, it};
+    return {it, std::next(it)};
+  }
+
+  // Inserts `value` unless an element with its key is present. Returns an
+  // iterator to the element with the key, and whether it was inserted.
+  // Elements after the insertion point are shifted, so inserting n elements
+  // one at a time takes O(n^2); prefer the range `insert()`.
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return InsertUnique(value);
+  }
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return InsertUnique(std::move(value));
+  }
+
+  // The same, without a search if the element goes right before `hint`.
+  iterator insert(const_iterator hint, const value_type& value) {
+    return InsertHintUnique(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type&& value) {
+    return InsertHintUnique(hint, std::move(value));
+  }
+
+  // Inserts a batch of elements in O(n + m log m): the new elements are
+  // appended, sorted and deduplicated, those whose key is already present
+  // are dropped, and the rest are merged in.
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    const size_type old_size = c_.size();
+    c_.insert(c_.end(), first, last);
+    MergeAppended(old_size);
+  }
+  void insert(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return InsertUnique(value_type(std::forward<Args>(args)...));
+  }
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args&&... args) {
+    return InsertHintUnique(hint, value_type(std::forward<Args>(args)...));
+  }
+
+  // Erases the element at `pos`, and returns an iterator to the next one.
+  // Erasing invalidates the iterators at and after `pos`.
+  iterator erase(const_iterator pos) { return c_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return c_.erase(first, last);
+  }
+  // Erases the element with `key`, if any, and returns the number erased.
+  template <class K = key_type,
+            typename std::enable_if<
+                !std::is_convertible<K, const_iterator>::value, int>::type = 0>
+  size_type erase(const key_arg<K>& key) {
+    auto it = find(key);
+    if (it == end()) return 0;
+    c_.erase(it);
+    return 1;
+  }
+
+  void clear() { c_.clear(); }
+  void reserve(size_type n) { c_.reserve(n); }
+  void swap(flat_container& x) {
+    using std::swap;
+    swap(comp_, x.comp_);
+    swap(c_, x.c_);
+  }
+
+  size_type size() const { return c_.size(); }
+  size_type max_size() const { return c_.max_size(); }
+  size_type capacity() const { return c_.capacity(); }
+  bool empty() const { return c_.empty(); }
+
+  key_compare key_comp() const { return comp_; }
+  value_compare value_comp() const { return value_compare(comp_); }
+
+  friend bool operator==(const flat_container& x, const flat_container& y) {
+    return x.c_ == y.c_;
+  }
+  friend bool operator!=(const flat_container& x, const flat_container& y) {
+    return !(x == y);
+  }
+  friend bool operator<(const flat_container& x, const flat_container& y) {
+    return x.c_ < y.c_;
+  }
+  friend bool operator>(const flat_container& x, const flat_container& y) {
+    return y < x;
+  }
+  friend bool operator<=(const flat_container& x, const flat_container& y) {
+    return !(y < x);
+  }
+  friend bool operator>=(const flat_container& x, const flat_container& y) {
+    return !(x < y);
+  }
+
+ protected:
+  template <class K>
+  typename Container::iterator LowerBound(const K& key) {
+    return absl::c_lower_bound(
+        c_, key, [this](const value_type& v, const K& k) {
+          return comp_(Params::key(v), k);
+        });
+  }
+  template <class K>
+  const_iterator LowerBound(const K& key) const {
+    return absl::c_lower_bound(
+        c_, key, [this](const value_type& v, const K& k) {
+          return comp_(Params::key(v), k);
+        });
+  }
+  template <class K>
+  typename Container::iterator UpperBound(const K& key) {
+    return absl::c_upper_bound(
+        c_, key, [this](const K& k, const value_type& v) {
+          return comp_(k, Params::key(v));
+        });
+  }
+  template <class K>
+  const_iterator UpperBound(const K& key) const {
+    return absl::c_upper_bound(
+        c_, key, [this](const K& k, const value_type& v) {
+          return comp_(k, Params::key(v));
+        });
+  }
+
+  typename Container::iterator MakeMutable(const_iterator it) {
+    return c_.begin() + (it - c_.cbegin());
+  }
+
+  template <class V>
+  std::pair<iterator, bool> InsertUnique(V&& value) {
+    auto it = LowerBound(Params::key(value));
+    if (it != c_.end() && !comp_(Params::key(value), Params::key(*it))) {
+      return {it, false};
+    }
+    return {c_.insert(it, std::forward<V>(value)), true};
+  }
+
+  template <class V>
+  iterator InsertHintUnique(const_iterator hint, V&& value) {
+    const key_type& key = Params::key(value);
+    if ((hint == c_.cbegin() || comp_(Params::key(*std::prev(hint)), key)) &&
+        (hint == c_.cend() || comp_(key, Params::key(*hint)))) {
+      return c_.insert(MakeMutable(hint), std::forward<V>(value));
+    }
+    return InsertUnique(std::forward<V>(value)).first;
+  }
+
+  // Restores the invariant after elements were appended at `old_size`, given
+  // that the elements before it are sorted and unique.
+  void MergeAppended(size_type old_size) {
+    const value_compare comp = value_comp();
+    auto middle = c_.begin() + old_size;
+    std::stable_sort(middle, c_.end(), comp);
+    // The elements are sorted, so `b` is equivalent to the `a` before it
+    // unless a < b.
+    auto new_end = std::unique(
+        middle, c_.end(),
+        [&comp](const value_type& a, const value_type& b) {
+          return !comp(a, b);
+        });
+    if (old_size != 0) {
+      new_end = std::remove_if(middle, new_end, [&](const value_type& v) {
+        return std::binary_search(c_.begin(), c_.begin() + old_size, v, comp);
+      });
+    }
+    c_.erase(new_end, c_.end());
+    middle = c_.begin() + old_size;
+    if (middle != c_.begin() && middle != c_.end() &&
+        comp(*middle, *std::prev(middle))) {
+      std::inplace_merge(c_.begin(), middle, c_.end(), comp);
+    }
+  }
+
+  key_compare comp_;
+  Container c_;
+};
+
+template <class Params, class Compare, class Container>
+void swap(flat_container<Params, Compare, Container>& x,
+          flat_container<Params, Compare, Container>& y) {
+  x.swap(y);
+}
+
+// The additions of `std::map`.
+template <class Params, class Compare, class Container>
+class flat_map_container : public flat_container<Params, Compare, Container> {
+  using Base = flat_container<Params, Compare, Container>;
+
+ protected:
+  template <class K>
+  using key_arg = typename Base::template key_arg<K>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::iterator;
+  using typename Base::key_type;
+  using mapped_type = typename Params::mapped_type;
+
+  using Base::Base;
+
+  // Inserts the element, or assigns `v` to the mapped value of the element
+  // with key `k`.
+  template <class K = key_type, class V = mapped_type, K* = nullptr,
+            V* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K>&& k, V&& v) {
+    return insert_or_assign_impl(std::forward<K>(k), std::forward<V>(v));
+  }
+  template <class K = key_type, class V = mapped_type, K* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(key_arg<K>&& k, const V& v) {
+    return insert_or_assign_impl(std::forward<K>(k), v);
+  }
+  template <class K = key_type, class V = mapped_type, V* = nullptr>
+  std::pair<iterator, bool> insert_or_assign(const key_arg<K>& k, V&& v) {
+    return insert_or_assign_impl(k, std::forward<V>(v));
+  }
+  template <class K = key_type, class V = mapped_type>
+  std::pair<iterator, bool> insert_or_assign(const key_arg<K>& k,
+                                             const V& v) {
+    return insert_or_assign_impl(k, v);
+  }
+
+  // Inserts an element with key `k` and a mapped value built from `args`,
+  // unless the key is present, in which case `args` are left untouched.
+  template <class K = key_type, class... Args,
+            typename std::enable_if<
+                !std::is_convertible<K, const_iterator>::value, int>::type = 0,
+            K* = nullptr>
+  std::pair<iterator, bool> try_emplace(key_arg<K>&& k, Args&&... args) {
+    return try_emplace_impl(std::forward<K>(k), std::forward<Args>(args)...);
+  }
+  template <class K = key_type, class... Args,
+            typename std::enable_if<
+                !std::is_convertible<K, const_iterator>::value, int>::type = 0>
+  std::pair<iterator, bool> try_emplace(const key_arg<K>& k, Args&&... args) {
+    return try_emplace_impl(k, std::forward<Args>(args)...);
+  }
+
+  template <class K = key_type, K* = nullptr>
+  mapped_type& operator[](key_arg<K>&& key) {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+  template <class K = key_type>
+  mapped_type& operator[](const key_arg<K>& key) {
+    return try_emplace(key).first->second;
+  }
+
+  template <class K = key_type>
+  mapped_type& at(const key_arg<K>& key) {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      base_internal::ThrowStdOutOfRange("absl::flat_map::at");
+    }
+    return it->second;
+  }
+  template <class K = key_type>
+  const mapped_type& at(const key_arg<K>& key) const {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      base_internal::ThrowStdOutOfRange("absl::flat_map::at");
+    }
+    return it->second;
+  }
+
+ private:
+  template <class K, class V>
+  std::pair<iterator, bool> insert_or_assign_impl(K&& k, V&& v) {
+    auto res = try_emplace_impl(std::forward<K>(k), std::forward<V>(v));
+    if (!res.second) res.first->second = std::forward<V>(v);
+    return res;
+  }
+
+  // `args` are only used if the key is absent.
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(K&& k, Args&&... args) {
+    auto it = this->LowerBound(k);
+    if (it != this->c_.end() && !this->comp_(k, it->first)) {
+      return {it, false};
+    }
+    return {this->c_.emplace(it, std::piecewise_construct,
+                             std::forward_as_tuple(std::forward<K>(k)),
+                             std::forward_as_tuple(std::forward<Args>(args)...)),
+            true};
+  }
+};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_FLAT_CONTAINER_H_
@@ -0,0 +1,105 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The default hash and equality functions of the hash containers.
+//
+// Keys of type `std::string` and `absl::string_view` get transparent
+// functions, so that a table keyed by strings can be searched with a
+// `string_view` or a `const char*` without building a `std::string`:
+//
+//   absl::flat_hash_set<std::string> names = ...;
+//   if (names.contains(absl::string_view(buf, len))) ...
+//
+// Other keys use `std::hash` and `std::equal_to`.
+
+#ifndef ABSL_CONTAINER_INTERNAL_HASH_FUNCTION_DEFAULTS_H_
+#define ABSL_CONTAINER_INTERNAL_HASH_FUNCTION_DEFAULTS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "absl/base/internal/endian.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace absl {
+namespace container_internal {
+
+// The hash of `n` bytes at `p`: 8-byte words, then the remaining bytes, each
+// folded in with a 64x64->128 bit multiply.
+inline size_t HashBytes(const char* p, size_t n) {
+  constexpr uint64_t kMul = 0x9ddfea08eb382d69ULL;
+  const auto mix = [](uint64_t v) {
+    const absl::uint128 m = absl::uint128(v) * kMul;
+    return absl::Uint128High64(m) ^ absl::Uint128Low64(m);
+  };
+  uint64_t h = mix(n ^ 0xc3a5c85c97cb3127ULL);
+  for (; n > 8; p += 8, n -= 8) {
+    h = mix(h ^ little_endian::Load64(p));
+  }
+  uint64_t tail = 0;
+  if (n >= 4) {
+    tail = little_endian::Load32(p) |
+           uint64_t{little_endian::Load32(p + n - 4)} << 32;
+  } else if (n > 0) {
+    tail = static_cast<uint8_t>(p[0]) |
+           uint64_t{static_cast<uint8_t>(p[n / 2])} << 8 |
+           uint64_t{static_cast<uint8_t>(p[n - 1])} << 16;
+  }
+  return static_cast<size_t>(mix(h ^ tail));
+}
+
+struct StringHash {
+  using is_transparent = void;
+
+  size_t operator()(absl::string_view v) const {
+    return HashBytes(v.data(), v.size());
+  }
+};
+
+struct StringEq {
+  using is_transparent = void;
+
+  bool operator()(absl::string_view lhs, absl::string_view rhs) const {
+    return lhs == rhs;
+  }
+};
+
+template <class T, class E = void>
+struct HashEq {
+  using Hash = std::hash<T>;
+  using Eq = std::equal_to<T>;
+};
+
+struct StringHashEq {
+  using Hash = StringHash;
+  using Eq = StringEq;
+};
+template <>
+struct HashEq<std::string> : StringHashEq {};
+template <>
+struct HashEq<absl::string_view> : StringHashEq {};
+
+template <class T>
+using hash_default_hash = typename HashEq<T>::Hash;
+
+template <class T>
+using hash_default_eq = typename HashEq<T>::Eq;
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_HASH_FUNCTION_DEFAULTS_H_
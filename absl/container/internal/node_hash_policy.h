@@ -0,0 +1,62 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The slot handling of a `raw_hash_set` policy whose elements each live in a
+// node of their own: a slot holds a pointer to the node, so moving elements
+// between slots when the table rehashes moves only pointers, and the
+// elements themselves never move.
+//
+// Nodes are allocated with the table's allocator, which must return plain
+// pointers.
+
+#ifndef ABSL_CONTAINER_INTERNAL_NODE_HASH_POLICY_H_
+#define ABSL_CONTAINER_INTERNAL_NODE_HASH_POLICY_H_
+
+#include <memory>
+#include <utility>
+
+namespace absl {
+namespace container_internal {
+
+template <class T>
+struct NodeHashPolicy {
+  using slot_type = T*;
+
+  template <class Alloc, class... Args>
+  static void construct(Alloc* alloc, slot_type* slot, Args&&... args) {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    T* node = AllocTraits::allocate(*alloc, 1);
+    AllocTraits::construct(*alloc, node, std::forward<Args>(args)...);
+    *slot = node;
+  }
+
+  template <class Alloc>
+  static void destroy(Alloc* alloc, slot_type* slot) {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    AllocTraits::destroy(*alloc, *slot);
+    AllocTraits::deallocate(*alloc, *slot, 1);
+  }
+
+  template <class Alloc>
+  static void transfer(Alloc*, slot_type* new_slot, slot_type* old_slot) {
+    *new_slot = *old_slot;
+  }
+
+  static T& element(slot_type* slot) { return **slot; }
+};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_NODE_HASH_POLICY_H_
@@ -0,0 +1,1179 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// An open-addressing hash table with a byte of metadata per slot, the
+// implementation of `absl::flat_hash_set` and the other hash containers.
+//
+// The table is an array of `capacity` slots and a parallel array of control
+// bytes. A control byte is `kEmpty`, `kDeleted` (a tombstone left by erase()),
+// or, for a full slot, the low 7 bits of the hash of its element ("H2"). The
+// rest of the hash ("H1") picks where probing starts. Probing reads the
+// control bytes a `Group` at a time, 16 with SSE2 and 8 otherwise, and
+// compares all of them to H2 at once, so that keys are compared only for
+// slots whose 7 bits match: in a well-distributed table, about one in 128.
+// A group with an empty slot in it ends the probe.
+//
+//   ctrl:  [ c[0] ... c[capacity - 1] kSentinel c[0] ... c[kWidth - 2] ]
+//   slots: [ s[0] ... s[capacity - 1] ]
+//
+// The capacity is always a power of 2 minus 1, so that the control bytes of
+// any slot can be read as a whole group. The first `kWidth - 1` control bytes
+// are cloned after the sentinel, so groups read at the end of the table wrap
+// around; the sentinel ends iteration. Both arrays are one allocation.
+//
+// Erasing an element leaves a tombstone unless no probe could have passed
+// its slot, that is, unless its group as seen from any start has an empty
+// slot in it. Tombstones count against the load; when the table fills up
+// with them, they are dropped by rehashing in place instead of growing.
+//
+// What a slot holds, and how elements are built in it, moved out of it and
+// keyed, is up to a policy:
+//
+//   struct Policy {
+//     using slot_type = ...;   // What a slot stores.
+//     using key_type = ...;
+//     using value_type = ...;  // What iterators point at.
+//     using init_type = ...;   // What insert({...}) builds.
+//     static constexpr bool kConstantIterators = ...;
+//
+//     template <class Alloc, class... Args>
+//     static void construct(Alloc* alloc, slot_type* slot, Args&&... args);
+//     template <class Alloc>
+//     static void destroy(Alloc* alloc, slot_type* slot);
+//     // Moves the element in `old_slot` to `new_slot`, leaving `old_slot`
+//     // uninitialized.
+//     template <class Alloc>
+//     static void transfer(Alloc* alloc, slot_type* new_slot,
+//                          slot_type* old_slot);
+//     static value_type& element(slot_type* slot);
+//     // The key of a value_type or an init_type.
+//     template <class V>
+//     static const key_type& key(const V& v);
+//   };
+
+#ifndef ABSL_CONTAINER_INTERNAL_RAW_HASH_SET_H_
+#define ABSL_CONTAINER_INTERNAL_RAW_HASH_SET_H_
+
+#ifndef ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+#if defined(__SSE2__) || \
+    (defined(_MSC_VER) && \
+     (defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2)))
+#define ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2 1
+#else
+#define ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2 0
+#endif
+#endif
+
+#if ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "absl/base/internal/endian.h"
+#include "absl/base/optimization.h"
+#include "absl/container/internal/common.h"
+#include "absl/meta/type_traits.h"
+#include "absl/numeric/int128.h"
+
+namespace absl {
+namespace container_internal {
+
+template <typename T>
+int TrailingZeros(T x) {
+  static_assert(std::is_unsigned<T>::value, "T must be unsigned");
+#if defined(__GNUC__)
+  return sizeof(T) == 8 ? __builtin_ctzll(static_cast<uint64_t>(x))
+                        : __builtin_ctz(static_cast<uint32_t>(x));
+#else
+  int n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+template <typename T>
+int LeadingZeros(T x) {
+  static_assert(std::is_unsigned<T>::value, "T must be unsigned");
+#if defined(__GNUC__)
+  return sizeof(T) == 8
+             ? __builtin_clzll(static_cast<uint64_t>(x))
+             : __builtin_clz(static_cast<uint32_t>(x)) - (32 - 8 * sizeof(T));
+#else
+  int n = 0;
+  for (T bit = T{1} << (8 * sizeof(T) - 1); (x & bit) == 0; bit >>= 1) ++n;
+  return n;
+#endif
+}
+
+// The bits of a mask that are set, one per slot of a group, as slot indices.
+// Only every `1 << Shift`-th bit is significant. Iterating yields the indices
+// in increasing order:
+//
+//   for (int i : group.Match(h2)) ...
+template <class T, int SignificantBits, int Shift = 0>
+class BitMask {
+  static_assert(std::is_unsigned<T>::value, "T must be unsigned");
+  static_assert(Shift == 0 || Shift == 3, "");
+
+ public:
+  using value_type = int;
+  using iterator = BitMask;
+  using const_iterator = BitMask;
+
+  explicit BitMask(T mask) : mask_(mask) {}
+  BitMask& operator++() {
+    mask_ &= (mask_ - 1);
+    return *this;
+  }
+  explicit operator bool() const { return mask_ != 0; }
+  int operator*() const { return LowestBitSet(); }
+  int LowestBitSet() const {
+    return container_internal::TrailingZeros(mask_) >> Shift;
+  }
+  int HighestBitSet() const {
+    return (static_cast<int>(sizeof(T) * 8) - 1 -
+            container_internal::LeadingZeros(mask_)) >>
+           Shift;
+  }
+
+  BitMask begin() const { return *this; }
+  BitMask end() const { return BitMask(0); }
+
+  // The number of slots before the first one set, from either end. The mask
+  // must not be empty.
+  int TrailingZeros() const {
+    return container_internal::TrailingZeros(mask_) >> Shift;
+  }
+  int LeadingZeros() const {
+    constexpr int total_significant_bits = SignificantBits << Shift;
+    constexpr int extra_bits = sizeof(T) * 8 - total_significant_bits;
+    return container_internal::LeadingZeros(
+               static_cast<T>(mask_ << extra_bits)) >>
+           Shift;
+  }
+
+ private:
+  friend bool operator==(const BitMask& a, const BitMask& b) {
+    return a.mask_ == b.mask_;
+  }
+  friend bool operator!=(const BitMask& a, const BitMask& b) {
+    return a.mask_ != b.mask_;
+  }
+
+  T mask_;
+};
+
+using ctrl_t = signed char;
+using h2_t = uint8_t;
+
+// The special control bytes all have the sign bit set; a full slot's never
+// does. kEmpty and kDeleted sort below kSentinel, so that a signed comparison
+// tells empty or deleted slots from full ones and the sentinel.
+enum Ctrl : ctrl_t {
+  kEmpty = -128,   // 0b10000000
+  kDeleted = -2,   // 0b11111110
+  kSentinel = -1,  // 0b11111111
+};
+static_assert(
+    kEmpty & kDeleted & kSentinel & 0x80,
+    "Special markers need to have the MSB to make checking for them efficient");
+static_assert(kEmpty < kSentinel && kDeleted < kSentinel,
+              "kEmpty and kDeleted must be smaller than kSentinel to make the "
+              "SIMD test of IsEmptyOrDeleted() efficient");
+static_assert(kSentinel == -1,
+              "kSentinel must be -1 to elide loading it from memory into SIMD "
+              "registers (pcmpeqd xmm, xmm)");
+static_assert(kEmpty == -128,
+              "kEmpty must be -128 to make the SIMD check for its "
+              "existence efficient (psignb xmm, xmm)");
+static_assert(~kEmpty & ~kDeleted & kSentinel & 0x7F,
+              "kEmpty and kDeleted must share an unset bit that is not shared "
+              "by kSentinel to make the scalar test for MatchEmptyOrDeleted() "
+              "efficient");
+
+inline bool IsEmpty(ctrl_t c) { return c == kEmpty; }
+inline bool IsFull(ctrl_t c) { return c >= 0; }
+inline bool IsDeleted(ctrl_t c) { return c == kDeleted; }
+inline bool IsEmptyOrDeleted(ctrl_t c) { return c < kSentinel; }
+
+// The position in the control bytes that probing starts from, and the byte
+// stored for a full slot.
+inline size_t H1(size_t hash) { return hash >> 7; }
+inline h2_t H2(size_t hash) { return hash & 0x7F; }
+
+// Spreads the entropy of `hash` over all its bits. Many hash functions, such
+// as std::hash for integers, are the identity; the table takes both H1 and H2
+// from the mixed hash.
+inline size_t MixHash(size_t hash) {
+  constexpr uint64_t kMul = sizeof(size_t) == 4 ? uint64_t{0xcc9e2d51}
+                                                : uint64_t{0x9ddfea08eb382d69};
+  const absl::uint128 m = absl::uint128(hash) * kMul;
+  return static_cast<size_t>(absl::Uint128High64(m) ^
+                             absl::Uint128Low64(m));
+}
+
+// The control bytes of a table with no slots: a sentinel to end iteration,
+// and empty slots to end probing.
+inline ctrl_t* EmptyGroup() {
+  alignas(16) static constexpr ctrl_t empty_group[] = {
+      kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+      kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty};
+  return const_cast<ctrl_t*>(empty_group);
+}
+
+#if ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+
+struct GroupSse2Impl {
+  static constexpr size_t kWidth = 16;  // The number of slots in a group.
+
+  explicit GroupSse2Impl(const ctrl_t* pos) {
+    ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+  }
+
+  // The slots whose control byte is `hash`.
+  BitMask<uint32_t, kWidth> Match(h2_t hash) const {
+    auto match = _mm_set1_epi8(hash);
+    return BitMask<uint32_t, kWidth>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(match, ctrl)));
+  }
+
+  BitMask<uint32_t, kWidth> MatchEmpty() const {
+    return Match(static_cast<h2_t>(kEmpty));
+  }
+
+  BitMask<uint32_t, kWidth> MatchEmptyOrDeleted() const {
+    auto special = _mm_set1_epi8(kSentinel);
+    return BitMask<uint32_t, kWidth>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(special, ctrl)));
+  }
+
+  // The number of empty or deleted slots before the first full one or the
+  // sentinel.
+  uint32_t CountLeadingEmptyOrDeleted() const {
+    auto special = _mm_set1_epi8(kSentinel);
+    return TrailingZeros(static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(special, ctrl)) + 1));
+  }
+
+  // Stores the group at `dst` with deleted slots and the sentinel made empty,
+  // and full slots made deleted.
+  void ConvertSpecialToEmptyAndFullToDeleted(ctrl_t* dst) const {
+    auto msbs = _mm_set1_epi8(static_cast<char>(-128));
+    auto x126 = _mm_set1_epi8(126);
+    auto special = _mm_cmpgt_epi8(_mm_setzero_si128(), ctrl);
+    auto res = _mm_or_si128(_mm_andnot_si128(special, x126), msbs);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), res);
+  }
+
+  __m128i ctrl;
+};
+
+#endif  // ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+
+// The same operations on 8 control bytes in a 64-bit word. Match() can
+// report a false positive for a byte that follows one that matched, which
+// only costs a key comparison.
+struct GroupPortableImpl {
+  static constexpr size_t kWidth = 8;
+
+  explicit GroupPortableImpl(const ctrl_t* pos)
+      : ctrl(little_endian::Load64(pos)) {}
+
+  BitMask<uint64_t, kWidth, 3> Match(h2_t hash) const {
+    // For the technique, see:
+    // http://graphics.stanford.edu/~seander/bithacks.html##ValueInWord
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    constexpr uint64_t lsbs = 0x0101010101010101ULL;
+    auto x = ctrl ^ (lsbs * hash);
+    return BitMask<uint64_t, kWidth, 3>((x - lsbs) & ~x & msbs);
+  }
+
+  BitMask<uint64_t, kWidth, 3> MatchEmpty() const {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    return BitMask<uint64_t, kWidth, 3>((ctrl & (~ctrl << 6)) & msbs);
+  }
+
+  BitMask<uint64_t, kWidth, 3> MatchEmptyOrDeleted() const {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    return BitMask<uint64_t, kWidth, 3>((ctrl & (~ctrl << 7)) & msbs);
+  }
+
+  uint32_t CountLeadingEmptyOrDeleted() const {
+    constexpr uint64_t gaps = 0x00FEFEFEFEFEFEFEULL;
+    return (TrailingZeros(((~ctrl & (ctrl >> 7)) | gaps) + 1) + 7) >> 3;
+  }
+
+  void ConvertSpecialToEmptyAndFullToDeleted(ctrl_t* dst) const {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    constexpr uint64_t lsbs = 0x0101010101010101ULL;
+    auto x = ctrl & msbs;
+    auto res = (~x + (x >> 7)) & ~lsbs;
+    little_endian::Store64(dst, res);
+  }
+
+  uint64_t ctrl;
+};
+
+#if ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+using Group = GroupSse2Impl;
+#else
+using Group = GroupPortableImpl;
+#endif
+
+// The sequence of groups that a probe for `hash` reads: triangular steps of
+// whole groups, which visit every group of a table whose number of groups is
+// a power of 2.
+template <size_t Width>
+class probe_seq {
+ public:
+  probe_seq(size_t hash, size_t mask) : mask_(mask), offset_(hash & mask) {}
+  size_t offset() const { return offset_; }
+  size_t offset(size_t i) const { return (offset_ + i) & mask_; }
+
+  void next() {
+    index_ += Width;
+    offset_ += index_;
+    offset_ &= mask_;
+  }
+  // The distance probed so far.
+  size_t index() const { return index_; }
+
+ private:
+  size_t mask_;
+  size_t offset_;
+  size_t index_ = 0;
+};
+
+inline bool IsValidCapacity(size_t n) { return ((n + 1) & n) == 0 && n > 0; }
+
+// The number of control bytes cloned after the sentinel.
+inline size_t NumClonedBytes() { return Group::kWidth - 1; }
+
+// The smallest valid capacity of at least `n`.
+inline size_t NormalizeCapacity(size_t n) {
+  return n ? ~size_t{} >> LeadingZeros(n) : 1;
+}
+
+// The number of elements a table of `capacity` holds before it grows: 7/8 of
+// it, less one for a table of one group, which always needs an empty slot.
+inline size_t CapacityToGrowth(size_t capacity) {
+  assert(IsValidCapacity(capacity));
+  if (Group::kWidth == 8 && capacity == 7) return 6;
+  return capacity - capacity / 8;
+}
+
+// The smallest capacity that holds `growth` elements without growing, before
+// normalization.
+inline size_t GrowthToLowerboundCapacity(size_t growth) {
+  if (Group::kWidth == 8 && growth == 7) return 8;
+  return growth + static_cast<size_t>((static_cast<int64_t>(growth) - 1) / 7);
+}
+
+// Policy: see the comment at the top of this file.
+// Hash, Eq: the hash and equality functions of keys.
+// Alloc: an allocator of Policy::value_type.
+template <class Policy, class Hash, class Eq, class Alloc>
+class raw_hash_set {
+  using AllocTraits = std::allocator_traits<Alloc>;
+  using slot_type = typename Policy::slot_type;
+
+  template <size_t Align>
+  struct alignas(Align) AlignedType {};
+  using SlotAlloc = typename AllocTraits::template rebind_alloc<
+      AlignedType<alignof(slot_type)>>;
+  using SlotAllocTraits = std::allocator_traits<SlotAlloc>;
+
+ public:
+  using init_type = typename Policy::init_type;
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = Eq;
+  using allocator_type = Alloc;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = typename AllocTraits::pointer;
+  using const_pointer = typename AllocTraits::const_pointer;
+
+ protected:
+  template <class K>
+  using key_arg = typename KeyArg<IsTransparent<Eq>::value &&
+                                  IsTransparent<Hash>::value>::template type<K,
+                                                                       key_type>;
+
+ private:
+  template <class T>
+  using RequiresInsertable = typename std::enable_if<
+      std::is_constructible<value_type, T&&>::value, int>::type;
+
+ public:
+  class iterator {
+    friend class raw_hash_set;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename raw_hash_set::value_type;
+    using reference =
+        typename std::conditional<Policy::kConstantIterators,
+                                  const value_type&, value_type&>::type;
+    using pointer = typename std::remove_reference<reference>::type*;
+    using difference_type = typename raw_hash_set::difference_type;
+
+    iterator() {}
+
+    reference operator*() const { return Policy::element(slot_); }
+    pointer operator->() const { return &operator*(); }
+
+    iterator& operator++() {
+      ++ctrl_;
+      ++slot_;
+      skip_empty_or_deleted();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.ctrl_ == b.ctrl_;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    iterator(ctrl_t* ctrl, slot_type* slot) : ctrl_(ctrl), slot_(slot) {}
+
+    // Moves to the next full slot, or to end() at the sentinel.
+    void skip_empty_or_deleted() {
+      while (IsEmptyOrDeleted(*ctrl_)) {
+        uint32_t shift = Group(ctrl_).CountLeadingEmptyOrDeleted();
+        ctrl_ += shift;
+        slot_ += shift;
+      }
+      if (ABSL_PREDICT_FALSE(*ctrl_ == kSentinel)) ctrl_ = nullptr;
+    }
+
+    ctrl_t* ctrl_ = nullptr;
+    slot_type* slot_ = nullptr;
+  };
+
+  class const_iterator {
+    friend class raw_hash_set;
+
+   public:
+    using iterator_category = typename iterator::iterator_category;
+    using value_type = typename raw_hash_set::value_type;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+    using difference_type = typename raw_hash_set::difference_type;
+
+    const_iterator() {}
+    // Implicit construction from iterator.
+    const_iterator(iterator i) : inner_(std::move(i)) {}
+
+    reference operator*() const { return *inner_; }
+    pointer operator->() const { return inner_.operator->(); }
+
+    const_iterator& operator++() {
+      ++inner_;
+      return *this;
+    }
+    const_iterator operator++(int) { return inner_++; }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b) {
+      return a.inner_ == b.inner_;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    const_iterator(const ctrl_t* ctrl, const slot_type* slot)
+        : inner_(const_cast<ctrl_t*>(ctrl), const_cast<slot_type*>(slot)) {}
+
+    iterator inner_;
+  };
+
+  raw_hash_set() noexcept(
+      std::is_nothrow_default_constructible<hasher>::value &&
+      std::is_nothrow_default_constructible<key_equal>::value &&
+      std::is_nothrow_default_constructible<allocator_type>::value) {}
+
+  explicit raw_hash_set(size_t bucket_count, const hasher& hash = hasher(),
+                        const key_equal& eq = key_equal(),
+                        const allocator_type& alloc = allocator_type())
+      : hash_(hash), eq_(eq), alloc_(alloc) {
+    if (bucket_count) {
+      capacity_ = NormalizeCapacity(bucket_count);
+      initialize_slots();
+    }
+  }
+
+  raw_hash_set(size_t bucket_count, const hasher& hash,
+               const allocator_type& alloc)
+      : raw_hash_set(bucket_count, hash, key_equal(), alloc) {}
+
+  raw_hash_set(size_t bucket_count, const allocator_type& alloc)
+      : raw_hash_set(bucket_count, hasher(), key_equal(), alloc) {}
+
+  explicit raw_hash_set(const allocator_type& alloc)
+      : raw_hash_set(0, hasher(), key_equal(), alloc) {}
+
+  template <class InputIter>
+  raw_hash_set(InputIter first, InputIter last, size_t bucket_count = 0,
+               const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+               const allocator_type& alloc = allocator_type())
+      : raw_hash_set(bucket_count, hash, eq, alloc) {
+    insert(first, last);
+  }
+
+  template <class InputIter>
+  raw_hash_set(InputIter first, InputIter last, size_t bucket_count,
+               const hasher& hash, const allocator_type& alloc)
+      : raw_hash_set(first, last, bucket_count, hash, key_equal(), alloc) {}
+
+  template <class InputIter>
+  raw_hash_set(InputIter first, InputIter last, size_t bucket_count,
+               const allocator_type& alloc)
+      : raw_hash_set(first, last, bucket_count, hasher(), key_equal(), alloc) {}
+
+  template <class InputIter>
+  raw_hash_set(InputIter first, InputIter last, const allocator_type& alloc)
+      : raw_hash_set(first, last, 0, hasher(), key_equal(), alloc) {}
+
+  raw_hash_set(std::initializer_list<init_type> init, size_t bucket_count = 0,
+               const hasher& hash = hasher(), const key_equal& eq = key_equal(),
+               const allocator_type& alloc = allocator_type())
+      : raw_hash_set(init.begin(), init.end(), bucket_count, hash, eq, alloc) {}
+
+  raw_hash_set(std::initializer_list<init_type> init, size_t bucket_count,
+               const hasher& hash, const allocator_type& alloc)
+      : raw_hash_set(init, bucket_count, hash, key_equal(), alloc) {}
+
+  raw_hash_set(std::initializer_list<init_type> init, size_t bucket_count,
+               const allocator_type& alloc)
+      : raw_hash_set(init, bucket_count, hasher(), key_equal(), alloc) {}
+
+  raw_hash_set(std::initializer_list<init_type> init,
+               const allocator_type& alloc)
+      : raw_hash_set(init, 0, hasher(), key_equal(), alloc) {}
+
+  raw_hash_set(const raw_hash_set& that)
+      : raw_hash_set(that, AllocTraits::select_on_container_copy_construction(
+                               that.alloc_)) {}
+
+  raw_hash_set(const raw_hash_set& that, const allocator_type& a)
+      : raw_hash_set(0, that.hash_, that.eq_, a) {
+    reserve(that.size());
+    // The elements are known to be distinct, so each one goes in the first
+    // free slot of its probe sequence without comparing keys.
+    for (const auto& v : that) {
+      const size_t hash = HashKey(Policy::key(v));
+      const size_t i = find_first_non_full(hash);
+      set_ctrl(i, H2(hash));
+      Policy::construct(&alloc_, slots_ + i, v);
+    }
+    size_ = that.size();
+    growth_left_ -= that.size();
+  }
+
+  raw_hash_set(raw_hash_set&& that) noexcept(
+      std::is_nothrow_copy_constructible<hasher>::value &&
+      std::is_nothrow_copy_constructible<key_equal>::value &&
+      std::is_nothrow_copy_constructible<allocator_type>::value)
+      : ctrl_(that.ctrl_),
+        slots_(that.slots_),
+        size_(that.size_),
+        capacity_(that.capacity_),
+        growth_left_(that.growth_left_),
+        hash_(that.hash_),
+        eq_(that.eq_),
+        alloc_(that.alloc_) {
+    that.reset_to_empty();
+  }
+
+  raw_hash_set(raw_hash_set&& that, const allocator_type& a)
+      : raw_hash_set(0, that.hash_, that.eq_, a) {
+    if (a == that.alloc_) {
+      swap_storage(that);
+    } else {
+      reserve(that.size());
+      for (size_t i = 0; i != that.capacity_; ++i) {
+        if (IsFull(that.ctrl_[i])) {
+          insert(std::move(Policy::element(that.slots_ + i)));
+        }
+      }
+    }
+  }
+
+  raw_hash_set& operator=(const raw_hash_set& that) {
+    raw_hash_set tmp(that,
+                     AllocTraits::propagate_on_container_copy_assignment::value
+                         ? that.alloc_
+                         : alloc_);
+    assign(tmp);
+    return *this;
+  }
+
+  raw_hash_set& operator=(raw_hash_set&& that) noexcept(
+      std::is_nothrow_copy_constructible<hasher>::value &&
+      std::is_nothrow_copy_constructible<key_equal>::value &&
+      AllocTraits::propagate_on_container_move_assignment::value) {
+    // Steals the storage of `that` if the allocators propagate or are equal,
+    // and moves its elements otherwise.
+    raw_hash_set tmp(std::move(that),
+                     AllocTraits::propagate_on_container_move_assignment::value
+                         ? that.alloc_
+                         : alloc_);
+    assign(tmp);
+    return *this;
+  }
+
+  ~raw_hash_set() { destroy_slots(); }
+
+  iterator begin() {
+    auto it = iterator_at(0);
+    it.skip_empty_or_deleted();
+    return it;
+  }
+  iterator end() { return iterator(); }
+
+  const_iterator begin() const {
+    return const_cast<raw_hash_set*>(this)->begin();
+  }
+  const_iterator end() const { return iterator(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool empty() const { return !size(); }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  size_t max_size() const { return (std::numeric_limits<size_t>::max)(); }
+
+  // Destroys the elements, and keeps the slots for reuse.
+  void clear() {
+    if (capacity_ == 0) return;
+    for (size_t i = 0; i != capacity_; ++i) {
+      if (IsFull(ctrl_[i])) Policy::destroy(&alloc_, slots_ + i);
+    }
+    size_ = 0;
+    reset_ctrl();
+    reset_growth_left();
+  }
+
+  // Inserts `value` unless an element with its key is present. Returns an
+  // iterator to the element with the key, and whether it was inserted.
+  //
+  // A value whose type is neither value_type nor init_type, such as a
+  // `const char*` for a set of strings, is converted to value_type first.
+  template <class T, RequiresInsertable<T> = 0>
+  std::pair<iterator, bool> insert(T&& value) {
+    return emplace(std::forward<T>(value));
+  }
+
+  // Takes `insert({...})`, which deduces no T for the above.
+  std::pair<iterator, bool> insert(const init_type& value) {
+    return emplace(value);
+  }
+  std::pair<iterator, bool> insert(init_type&& value) {
+    return emplace(std::move(value));
+  }
+
+  template <class T, RequiresInsertable<T> = 0>
+  iterator insert(const_iterator, T&& value) {
+    return insert(std::forward<T>(value)).first;
+  }
+  iterator insert(const_iterator, const init_type& value) {
+    return insert(value).first;
+  }
+  iterator insert(const_iterator, init_type&& value) {
+    return insert(std::move(value)).first;
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  void insert(std::initializer_list<init_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+  }
+
+  // Inserts an element built from `args` unless one with its key is present.
+  //
+  // An element is built from a single value_type or init_type only after its
+  // key is looked up; from other arguments, it is built first, and destroyed
+  // again if its key is present.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return emplace_impl(IsKeyed<Policy, Args...>(),
+                        std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args&&... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  // Erases the element with `key`, if any, and returns the number erased.
+  template <class K = key_type>
+  size_type erase(const key_arg<K>& key) {
+    auto it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  // Erases the element at `it`. Erasing invalidates no other iterator, but
+  // returns nothing, as finding the next element costs a scan that most
+  // callers don't need. To erase while iterating, write:
+  //
+  //   for (auto it = s.begin(); it != s.end();) {
+  //     if (ShouldErase(*it)) {
+  //       s.erase(it++);
+  //     } else {
+  //       ++it;
+  //     }
+  //   }
+  void erase(const_iterator cit) { erase(cit.inner_); }
+  void erase(iterator it) {
+    assert(it != end());
+    Policy::destroy(&alloc_, it.slot_);
+    erase_meta_only(it);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      erase(first++);
+    }
+    return last.inner_;
+  }
+
+  void swap(raw_hash_set& that) noexcept {
+    using std::swap;
+    swap_storage(that);
+    swap(hash_, that.hash_);
+    swap(eq_, that.eq_);
+    if (AllocTraits::propagate_on_container_swap::value) {
+      swap(alloc_, that.alloc_);
+    }
+  }
+
+  // Makes room for at least `n` elements and rehashes; `rehash(0)` shrinks
+  // the table to fit its elements and drops its tombstones.
+  void rehash(size_t n) {
+    if (n == 0 && capacity_ == 0) return;
+    if (n == 0 && size_ == 0) {
+      destroy_slots();
+      return;
+    }
+    auto m = NormalizeCapacity(
+        (std::max)(n, size_ == 0 ? size_t{0}
+                                 : GrowthToLowerboundCapacity(size_)));
+    if (n == 0 || m > capacity_) resize(m);
+  }
+
+  // Makes room for `n` elements in all, so that inserting up to that many
+  // neither rehashes nor invalidates iterators.
+  void reserve(size_t n) {
+    if (n > size_ + growth_left_) rehash(GrowthToLowerboundCapacity(n));
+  }
+
+  template <class K = key_type>
+  size_t count(const key_arg<K>& key) const {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  template <class K = key_type>
+  iterator find(const key_arg<K>& key) {
+    const size_t hash = HashKey(key);
+    auto seq = probe(hash);
+    while (true) {
+      Group g{ctrl_ + seq.offset()};
+      for (int i : g.Match(H2(hash))) {
+        if (ABSL_PREDICT_TRUE(
+                eq_(key, Policy::key(Policy::element(
+                             slots_ + seq.offset(i)))))) {
+          return iterator_at(seq.offset(i));
+        }
+      }
+      if (ABSL_PREDICT_TRUE(g.MatchEmpty())) return end();
+      seq.next();
+    }
+  }
+  template <class K = key_type>
+  const_iterator find(const key_arg<K>& key) const {
+    return const_cast<raw_hash_set*>(this)->find(key);
+  }
+
+  template <class K = key_type>
+  bool contains(const key_arg<K>& key) const {
+    return find(key) != end();
+  }
+
+  template <class K = key_type>
+  std::pair<iterator, iterator> equal_range(const key_arg<K>& key) {
+    auto it = find(key);
+    if (it != end()) return {it, std::next(it)};
+    return {it, it};
+  }
+  template <class K = key_type>
+  std::pair<const_iterator, const_iterator> equal_range(
+      const key_arg<K>& key) const {
+    auto it = find(key);
+    if (it != end()) return {it, std::next(it)};
+    return {it, it};
+  }
+
+  size_t bucket_count() const { return capacity_; }
+  float load_factor() const {
+    return capacity_ ? static_cast<double>(size()) / capacity_ : 0.0;
+  }
+  // The table grows at a load factor of 7/8, which can't be changed.
+  float max_load_factor() const { return 1.0f; }
+  void max_load_factor(float) {}
+
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return eq_; }
+  allocator_type get_allocator() const { return alloc_; }
+
+  friend bool operator==(const raw_hash_set& a, const raw_hash_set& b) {
+    if (a.size() != b.size()) return false;
+    const raw_hash_set* outer = &a;
+    const raw_hash_set* inner = &b;
+    if (outer->capacity() > inner->capacity()) std::swap(outer, inner);
+    for (const value_type& elem : *outer) {
+      auto it = inner->find(Policy::key(elem));
+      if (it == inner->end() || !(*it == elem)) return false;
+    }
+    return true;
+  }
+
+  friend bool operator!=(const raw_hash_set& a, const raw_hash_set& b) {
+    return !(a == b);
+  }
+
+  friend void swap(raw_hash_set& a, raw_hash_set& b) noexcept { a.swap(b); }
+
+ protected:
+  template <class K>
+  size_t HashKey(const K& key) const {
+    return MixHash(hash_(key));
+  }
+
+  // Returns the index of the slot with `key` and false, or of a slot
+  // prepared for it and true. A prepared slot must be constructed in before
+  // the table is used again.
+  template <class K>
+  std::pair<size_t, bool> find_or_prepare_insert(const K& key) {
+    const size_t hash = HashKey(key);
+    auto seq = probe(hash);
+    while (true) {
+      Group g{ctrl_ + seq.offset()};
+      for (int i : g.Match(H2(hash))) {
+        if (ABSL_PREDICT_TRUE(
+                eq_(key, Policy::key(Policy::element(
+                             slots_ + seq.offset(i)))))) {
+          return {seq.offset(i), false};
+        }
+      }
+      if (ABSL_PREDICT_TRUE(g.MatchEmpty())) break;
+      seq.next();
+    }
+    return {prepare_insert(hash), true};
+  }
+
+  iterator iterator_at(size_t i) { return {ctrl_ + i, slots_ + i}; }
+  const_iterator iterator_at(size_t i) const { return {ctrl_ + i, slots_ + i}; }
+
+  slot_type* slot_at(size_t i) { return slots_ + i; }
+  allocator_type* alloc() { return &alloc_; }
+
+ private:
+  template <class... Args>
+  std::pair<iterator, bool> emplace_impl(std::true_type, Args&&... args) {
+    return emplace_keyed(std::forward<Args>(args)...);
+  }
+
+  template <class T>
+  std::pair<iterator, bool> emplace_keyed(T&& value) {
+    auto res = find_or_prepare_insert(Policy::key(value));
+    if (res.second) {
+      Policy::construct(&alloc_, slots_ + res.first, std::forward<T>(value));
+    }
+    return {iterator_at(res.first), res.second};
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace_impl(std::false_type, Args&&... args) {
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* slot = reinterpret_cast<slot_type*>(&raw);
+    Policy::construct(&alloc_, slot, std::forward<Args>(args)...);
+    auto res = find_or_prepare_insert(Policy::key(Policy::element(slot)));
+    if (res.second) {
+      Policy::transfer(&alloc_, slots_ + res.first, slot);
+    } else {
+      Policy::destroy(&alloc_, slot);
+    }
+    return {iterator_at(res.first), res.second};
+  }
+
+  // Takes the contents of `tmp`, with the allocator they were allocated with,
+  // and leaves it ours to destroy.
+  void assign(raw_hash_set& tmp) {
+    using std::swap;
+    swap_storage(tmp);
+    swap(hash_, tmp.hash_);
+    swap(eq_, tmp.eq_);
+    swap(alloc_, tmp.alloc_);
+  }
+
+  probe_seq<Group::kWidth> probe(size_t hash) const {
+    return probe_seq<Group::kWidth>(H1(hash), capacity_);
+  }
+
+  // Sets the control byte of slot `i`, and its clone if it has one.
+  void set_ctrl(size_t i, ctrl_t h) {
+    assert(i < capacity_);
+    ctrl_[i] = h;
+    ctrl_[((i - NumClonedBytes()) & capacity_) +
+          (NumClonedBytes() & capacity_)] = h;
+  }
+
+  // Returns the index of the first empty or deleted slot in the probe
+  // sequence of `hash`. The table must have one.
+  size_t find_first_non_full(size_t hash) const {
+    auto seq = probe(hash);
+    while (true) {
+      Group g{ctrl_ + seq.offset()};
+      auto mask = g.MatchEmptyOrDeleted();
+      if (mask) return seq.offset(mask.LowestBitSet());
+      assert(seq.index() < capacity_ && "full table!");
+      seq.next();
+    }
+  }
+
+  size_t prepare_insert(size_t hash) {
+    size_t target = find_first_non_full(hash);
+    if (ABSL_PREDICT_FALSE(growth_left_ == 0 && !IsDeleted(ctrl_[target]))) {
+      rehash_and_grow_if_necessary();
+      target = find_first_non_full(hash);
+    }
+    ++size_;
+    growth_left_ -= IsEmpty(ctrl_[target]);
+    set_ctrl(target, H2(hash));
+    return target;
+  }
+
+  void erase_meta_only(const_iterator it) {
+    assert(IsFull(*it.inner_.ctrl_) && "erasing a dangling iterator");
+    --size_;
+    const size_t index = it.inner_.ctrl_ - ctrl_;
+    const size_t index_before = (index - Group::kWidth) & capacity_;
+    const auto empty_after = Group(it.inner_.ctrl_).MatchEmpty();
+    const auto empty_before = Group(ctrl_ + index_before).MatchEmpty();
+
+    // A probe that passed this slot read a full group around it. If no
+    // window of kWidth slots around it was ever full, there is no such probe,
+    // and the slot can be made empty again.
+    const bool was_never_full =
+        empty_before && empty_after &&
+        static_cast<size_t>(empty_after.TrailingZeros() +
+                            empty_before.LeadingZeros()) < Group::kWidth;
+
+    set_ctrl(index, was_never_full ? kEmpty : kDeleted);
+    growth_left_ += was_never_full;
+  }
+
+  void initialize_slots() {
+    assert(capacity_);
+    SlotAlloc alloc(alloc_);
+    auto* mem = SlotAllocTraits::allocate(alloc, AllocUnits(capacity_));
+    ctrl_ = reinterpret_cast<ctrl_t*>(mem);
+    slots_ = reinterpret_cast<slot_type*>(reinterpret_cast<char*>(mem) +
+                                          SlotOffset(capacity_));
+    reset_ctrl();
+    reset_growth_left();
+  }
+
+  void deallocate(ctrl_t* ctrl, size_t capacity) {
+    SlotAlloc alloc(alloc_);
+    SlotAllocTraits::deallocate(
+        alloc, reinterpret_cast<AlignedType<alignof(slot_type)>*>(ctrl),
+        AllocUnits(capacity));
+  }
+
+  void destroy_slots() {
+    if (!capacity_) return;
+    for (size_t i = 0; i != capacity_; ++i) {
+      if (IsFull(ctrl_[i])) Policy::destroy(&alloc_, slots_ + i);
+    }
+    deallocate(ctrl_, capacity_);
+    reset_to_empty();
+  }
+
+  void reset_to_empty() {
+    ctrl_ = EmptyGroup();
+    slots_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    growth_left_ = 0;
+  }
+
+  void resize(size_t new_capacity) {
+    assert(IsValidCapacity(new_capacity));
+    auto* old_ctrl = ctrl_;
+    auto* old_slots = slots_;
+    const size_t old_capacity = capacity_;
+    capacity_ = new_capacity;
+    initialize_slots();
+
+    for (size_t i = 0; i != old_capacity; ++i) {
+      if (IsFull(old_ctrl[i])) {
+        const size_t hash =
+            HashKey(Policy::key(Policy::element(old_slots + i)));
+        const size_t new_i = find_first_non_full(hash);
+        set_ctrl(new_i, H2(hash));
+        Policy::transfer(&alloc_, slots_ + new_i, old_slots + i);
+      }
+    }
+    if (old_capacity) deallocate(old_ctrl, old_capacity);
+  }
+
+  // Rehashes in place, putting each element back in the first free slot of
+  // its probe sequence and turning the tombstones back into empty slots.
+  void drop_deletes_without_resize() {
+    assert(IsValidCapacity(capacity_));
+    // Marks the full slots deleted, and the deleted ones empty; a slot still
+    // marked deleted below holds an element not yet placed.
+    for (ctrl_t* pos = ctrl_; pos < ctrl_ + capacity_ + 1;
+         pos += Group::kWidth) {
+      Group{pos}.ConvertSpecialToEmptyAndFullToDeleted(pos);
+    }
+    // Past a table smaller than a group, the bytes after the clones stay
+    // empty.
+    std::memset(ctrl_ + capacity_ + 1, kEmpty, NumClonedBytes());
+    std::memcpy(ctrl_ + capacity_ + 1, ctrl_,
+                (std::min)(capacity_, NumClonedBytes()));
+    ctrl_[capacity_] = kSentinel;
+
+    typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type
+        raw;
+    slot_type* tmp = reinterpret_cast<slot_type*>(&raw);
+    for (size_t i = 0; i != capacity_; ++i) {
+      if (!IsDeleted(ctrl_[i])) continue;
+      const size_t hash = HashKey(Policy::key(Policy::element(slots_ + i)));
+      const size_t new_i = find_first_non_full(hash);
+
+      // An element already in the first group of its probe sequence stays.
+      const auto probe_index = [&](size_t pos) {
+        return ((pos - probe(hash).offset()) & capacity_) / Group::kWidth;
+      };
+      if (ABSL_PREDICT_TRUE(probe_index(new_i) == probe_index(i))) {
+        set_ctrl(i, H2(hash));
+        continue;
+      }
+      if (IsEmpty(ctrl_[new_i])) {
+        set_ctrl(new_i, H2(hash));
+        Policy::transfer(&alloc_, slots_ + new_i, slots_ + i);
+        set_ctrl(i, kEmpty);
+      } else {
+        // The target holds an element not yet placed: swap the two, and
+        // place the one now in slot `i` on the next pass.
+        assert(IsDeleted(ctrl_[new_i]));
+        set_ctrl(new_i, H2(hash));
+        Policy::transfer(&alloc_, tmp, slots_ + i);
+        Policy::transfer(&alloc_, slots_ + i, slots_ + new_i);
+        Policy::transfer(&alloc_, slots_ + new_i, tmp);
+        --i;
+      }
+    }
+    reset_growth_left();
+  }
+
+  void rehash_and_grow_if_necessary() {
+    if (capacity_ == 0) {
+      resize(1);
+    } else if (size() <= CapacityToGrowth(capacity()) / 2) {
+      // At most half full: the rest is tombstones, so reclaim them.
+      drop_deletes_without_resize();
+    } else {
+      resize(capacity_ * 2 + 1);
+    }
+  }
+
+  void reset_ctrl() {
+    std::memset(ctrl_, kEmpty, capacity_ + Group::kWidth);
+    ctrl_[capacity_] = kSentinel;
+  }
+
+  void reset_growth_left() {
+    growth_left_ = CapacityToGrowth(capacity_) - size_;
+  }
+
+  void swap_storage(raw_hash_set& that) {
+    using std::swap;
+    swap(ctrl_, that.ctrl_);
+    swap(slots_, that.slots_);
+    swap(size_, that.size_);
+    swap(capacity_, that.capacity_);
+    swap(growth_left_, that.growth_left_);
+  }
+
+  // The control bytes and slots take one allocation, counted in units of
+  // the slots' alignment.
+  static size_t SlotOffset(size_t capacity) {
+    return (capacity + 1 + NumClonedBytes() + alignof(slot_type) - 1) &
+           ~(alignof(slot_type) - 1);
+  }
+  static size_t AllocUnits(size_t capacity) {
+    return (SlotOffset(capacity) + capacity * sizeof(slot_type) +
+            alignof(slot_type) - 1) /
+           alignof(slot_type);
+  }
+
+  ctrl_t* ctrl_ = EmptyGroup();  // [(capacity + 1 + kWidth - 1) * ctrl_t]
+  slot_type* slots_ = nullptr;   // [capacity * slot_type]
+  size_t size_ = 0;              // The number of full slots.
+  size_t capacity_ = 0;          // The total number of slots.
+  size_t growth_left_ = 0;       // Empty slots left before growing.
+  hasher hash_;
+  key_equal eq_;
+  allocator_type alloc_;
+};
+
+}  // namespace container_internal
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_INTERNAL_RAW_HASH_SET_H_
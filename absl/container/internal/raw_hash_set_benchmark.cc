@@ -0,0 +1,129 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/container/node_hash_set.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Keys spread over 64 bits, so that neither table benefits from sequential
+// integers.
+std::vector<uint64_t> RandomKeys(size_t n, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> keys(n);
+  for (auto& k : keys) k = gen();
+  return keys;
+}
+
+template <class Set>
+void BM_FindHit(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  Set set(keys.begin(), keys.end());
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(set.find(keys[i]));
+    if (++i == keys.size()) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_FindHit, absl::flat_hash_set<uint64_t>)
+    ->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindHit, absl::node_hash_set<uint64_t>)
+    ->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindHit, std::unordered_set<uint64_t>)
+    ->Range(16, 1 << 20);
+
+template <class Set>
+void BM_FindMiss(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  const auto misses = RandomKeys(state.range(0), 2);
+  Set set(keys.begin(), keys.end());
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(set.find(misses[i]));
+    if (++i == misses.size()) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_FindMiss, absl::flat_hash_set<uint64_t>)
+    ->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindMiss, absl::node_hash_set<uint64_t>)
+    ->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindMiss, std::unordered_set<uint64_t>)
+    ->Range(16, 1 << 20);
+
+template <class Set>
+void BM_InsertReserved(benchmark::State& state) {
+  const auto keys = RandomKeys(state.range(0), 1);
+  while (state.KeepRunning()) {
+    Set set;
+    set.reserve(keys.size());
+    for (uint64_t k : keys) set.insert(k);
+    benchmark::DoNotOptimize(set);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_TEMPLATE(BM_InsertReserved, absl::flat_hash_set<uint64_t>)
+    ->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_InsertReserved, std::unordered_set<uint64_t>)
+    ->Range(16, 1 << 16);
+
+// Erases and inserts at a steady size, which leaves tombstones behind.
+template <class Set>
+void BM_Churn(benchmark::State& state) {
+  const auto keys = RandomKeys(2 * state.range(0), 1);
+  const size_t n = state.range(0);
+  Set set(keys.begin(), keys.begin() + n);
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    set.erase(keys[i]);
+    set.insert(keys[i + n]);
+    set.erase(keys[i + n]);
+    set.insert(keys[i]);
+    if (++i == n) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_Churn, absl::flat_hash_set<uint64_t>)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Churn, std::unordered_set<uint64_t>)->Range(16, 1 << 16);
+
+template <class Map>
+void BM_StringFindHit(benchmark::State& state) {
+  std::vector<std::string> keys;
+  for (uint64_t k : RandomKeys(state.range(0), 1)) {
+    keys.push_back("key/" + std::to_string(k));
+  }
+  Map map;
+  for (const auto& k : keys) map[k] = 1;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(map.find(keys[i]));
+    if (++i == keys.size()) i = 0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_StringFindHit, absl::flat_hash_map<std::string, int>)
+    ->Range(16, 1 << 18);
+BENCHMARK_TEMPLATE(BM_StringFindHit, absl::node_hash_map<std::string, int>)
+    ->Range(16, 1 << 18);
+BENCHMARK_TEMPLATE(BM_StringFindHit, std::unordered_map<std::string, int>)
+    ->Range(16, 1 << 18);
+
+}  // namespace
@@ -0,0 +1,485 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/internal/raw_hash_set.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace absl {
+namespace container_internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::UnorderedElementsAre;
+
+TEST(Util, NormalizeCapacity) {
+  EXPECT_EQ(1, NormalizeCapacity(0));
+  EXPECT_EQ(1, NormalizeCapacity(1));
+  EXPECT_EQ(3, NormalizeCapacity(2));
+  EXPECT_EQ(3, NormalizeCapacity(3));
+  EXPECT_EQ(7, NormalizeCapacity(4));
+  EXPECT_EQ(7, NormalizeCapacity(7));
+  EXPECT_EQ(15, NormalizeCapacity(8));
+  EXPECT_EQ(15, NormalizeCapacity(15));
+  EXPECT_EQ(31, NormalizeCapacity(16));
+}
+
+TEST(Util, GrowthAndCapacity) {
+  // Verifies that GrowthToLowerboundCapacity() and CapacityToGrowth() are
+  // inverses.
+  for (size_t growth = 0; growth < 10000; ++growth) {
+    SCOPED_TRACE(growth);
+    size_t capacity = NormalizeCapacity(GrowthToLowerboundCapacity(growth));
+    // The capacity is large enough for `growth`...
+    EXPECT_GE(CapacityToGrowth(capacity), growth);
+    // ...and it is the smallest one that is.
+    if (capacity > 1) EXPECT_LT(CapacityToGrowth(capacity / 2), growth);
+  }
+}
+
+TEST(Util, ProbeSeqVisitsEveryGroup) {
+  // A table of 128 slots has 8 groups of 16 or 16 of 8.
+  constexpr size_t kCapacity = 127;
+  probe_seq<Group::kWidth> seq(0, kCapacity);
+  std::set<size_t> offsets;
+  for (size_t i = 0; i != (kCapacity + 1) / Group::kWidth; ++i) {
+    offsets.insert(seq.offset());
+    seq.next();
+  }
+  EXPECT_EQ((kCapacity + 1) / Group::kWidth, offsets.size());
+}
+
+TEST(BitMask, Smoke) {
+  EXPECT_FALSE((BitMask<uint8_t, 8>(0)));
+  EXPECT_TRUE((BitMask<uint8_t, 8>(5)));
+
+  EXPECT_THAT((BitMask<uint8_t, 8>(0)), ElementsAre());
+  EXPECT_THAT((BitMask<uint8_t, 8>(0x1)), ElementsAre(0));
+  EXPECT_THAT((BitMask<uint8_t, 8>(0x2)), ElementsAre(1));
+  EXPECT_THAT((BitMask<uint8_t, 8>(0x3)), ElementsAre(0, 1));
+  EXPECT_THAT((BitMask<uint8_t, 8>(0x4)), ElementsAre(2));
+  EXPECT_THAT((BitMask<uint8_t, 8>(0xAA)), ElementsAre(1, 3, 5, 7));
+  EXPECT_THAT((BitMask<uint8_t, 8>(0xFF)),
+              ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+TEST(BitMask, WithShift) {
+  // The portable group's mask: the high bit of each byte.
+  uint64_t ctrl = 0x1716151413121110;
+  uint64_t hash = 0x12;
+  constexpr uint64_t msbs = 0x8080808080808080ULL;
+  constexpr uint64_t lsbs = 0x0101010101010101ULL;
+  auto x = ctrl ^ (lsbs * hash);
+  uint64_t mask = (x - lsbs) & ~x & msbs;
+  EXPECT_EQ(0x0000000080800000, mask);
+
+  BitMask<uint64_t, 8, 3> b(mask);
+  EXPECT_EQ(*b, 2);
+}
+
+TEST(BitMask, LeadingTrailing) {
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00001a40).LeadingZeros()), 3);
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00001a40).TrailingZeros()), 6);
+
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00000001).LeadingZeros()), 15);
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00000001).TrailingZeros()), 0);
+
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00008000).LeadingZeros()), 0);
+  EXPECT_EQ((BitMask<uint32_t, 16>(0x00008000).TrailingZeros()), 15);
+
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x0000008080808000).LeadingZeros()), 3);
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x0000008080808000).TrailingZeros()), 1);
+
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x0000000000000080).LeadingZeros()), 7);
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x0000000000000080).TrailingZeros()), 0);
+
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x8000000000000000).LeadingZeros()), 0);
+  EXPECT_EQ((BitMask<uint64_t, 8, 3>(0x8000000000000000).TrailingZeros()), 7);
+}
+
+// Runs the group tests on both implementations where both are available.
+template <class GroupImpl>
+class GroupTest : public ::testing::Test {};
+
+#if ABSL_INTERNAL_RAW_HASH_SET_HAVE_SSE2
+using GroupImpls = ::testing::Types<GroupSse2Impl, GroupPortableImpl>;
+#else
+using GroupImpls = ::testing::Types<GroupPortableImpl>;
+#endif
+TYPED_TEST_CASE(GroupTest, GroupImpls);
+
+// The control bytes of a group: full slots with H2s 1, 2, 3, ... and the
+// special bytes at the given positions.
+template <class GroupImpl>
+std::vector<ctrl_t> MakeGroup(std::vector<std::pair<size_t, ctrl_t>> special) {
+  std::vector<ctrl_t> group(GroupImpl::kWidth);
+  std::iota(group.begin(), group.end(), 1);
+  for (const auto& s : special) group[s.first] = s.second;
+  return group;
+}
+
+TYPED_TEST(GroupTest, Match) {
+  using G = TypeParam;
+  std::vector<ctrl_t> group = MakeGroup<G>({{0, kEmpty}, {3, kDeleted}});
+  group[5] = 2;  // Two slots with H2 2.
+  // The portable group can report a byte of 3 after a 2 as a match too.
+  group[2] = 20;
+  EXPECT_THAT(G{group.data()}.Match(0), ElementsAre());
+  EXPECT_THAT(G{group.data()}.Match(1), ElementsAre());
+  EXPECT_THAT(G{group.data()}.Match(2), ElementsAre(1, 5));
+  EXPECT_THAT(G{group.data()}.Match(5), ElementsAre(4));
+}
+
+TYPED_TEST(GroupTest, MatchEmpty) {
+  using G = TypeParam;
+  std::vector<ctrl_t> group =
+      MakeGroup<G>({{0, kEmpty}, {2, kDeleted}, {4, kSentinel}, {6, kEmpty}});
+  EXPECT_THAT(G{group.data()}.MatchEmpty(), ElementsAre(0, 6));
+}
+
+TYPED_TEST(GroupTest, MatchEmptyOrDeleted) {
+  using G = TypeParam;
+  std::vector<ctrl_t> group =
+      MakeGroup<G>({{0, kEmpty}, {2, kDeleted}, {4, kSentinel}, {6, kEmpty}});
+  EXPECT_THAT(G{group.data()}.MatchEmptyOrDeleted(), ElementsAre(0, 2, 6));
+}
+
+TYPED_TEST(GroupTest, CountLeadingEmptyOrDeleted) {
+  using G = TypeParam;
+  for (ctrl_t special : {kEmpty, kDeleted}) {
+    for (size_t n = 0; n != G::kWidth; ++n) {
+      std::vector<ctrl_t> group = MakeGroup<G>({});
+      for (size_t i = 0; i != n; ++i) group[i] = special;
+      EXPECT_EQ(n, G{group.data()}.CountLeadingEmptyOrDeleted());
+    }
+  }
+  std::vector<ctrl_t> group = MakeGroup<G>({{0, kEmpty}, {1, kSentinel}});
+  EXPECT_EQ(1, G{group.data()}.CountLeadingEmptyOrDeleted());
+}
+
+TYPED_TEST(GroupTest, ConvertSpecialToEmptyAndFullToDeleted) {
+  using G = TypeParam;
+  std::vector<ctrl_t> group =
+      MakeGroup<G>({{0, kEmpty}, {2, kDeleted}, {4, kSentinel}});
+  std::vector<ctrl_t> converted(G::kWidth);
+  G{group.data()}.ConvertSpecialToEmptyAndFullToDeleted(converted.data());
+  for (size_t i = 0; i != G::kWidth; ++i) {
+    SCOPED_TRACE(i);
+    if (IsFull(group[i])) {
+      EXPECT_EQ(kDeleted, converted[i]);
+    } else {
+      EXPECT_EQ(kEmpty, converted[i]);
+    }
+  }
+}
+
+struct IntPolicy {
+  using slot_type = int64_t;
+  using key_type = int64_t;
+  using value_type = int64_t;
+  using init_type = int64_t;
+  static constexpr bool kConstantIterators = true;
+
+  template <class Alloc>
+  static void construct(Alloc*, int64_t* slot, int64_t v) {
+    *slot = v;
+  }
+  template <class Alloc>
+  static void destroy(Alloc*, int64_t*) {}
+  template <class Alloc>
+  static void transfer(Alloc*, int64_t* new_slot, int64_t* old_slot) {
+    *new_slot = *old_slot;
+  }
+  static int64_t& element(int64_t* slot) { return *slot; }
+  static const int64_t& key(const int64_t& v) { return v; }
+};
+
+struct IntTable : raw_hash_set<IntPolicy, std::hash<int64_t>,
+                               std::equal_to<int64_t>,
+                               std::allocator<int64_t>> {
+  using Base = typename IntTable::raw_hash_set;
+  IntTable() {}
+  using Base::Base;
+};
+
+// Hashes every key alike, so that every lookup probes the whole table.
+struct BadHash {
+  size_t operator()(int64_t) const { return 0; }
+};
+
+struct BadTable : raw_hash_set<IntPolicy, BadHash, std::equal_to<int64_t>,
+                               std::allocator<int64_t>> {
+  using Base = typename BadTable::raw_hash_set;
+  BadTable() {}
+  using Base::Base;
+};
+
+TEST(Table, Empty) {
+  IntTable t;
+  EXPECT_EQ(0, t.size());
+  EXPECT_TRUE(t.empty());
+  EXPECT_TRUE(t.begin() == t.end());
+  EXPECT_TRUE(t.find(0) == t.end());
+}
+
+TEST(Table, InsertFindErase) {
+  IntTable t;
+  auto res = t.emplace(0);
+  EXPECT_TRUE(res.second);
+  EXPECT_EQ(0, *res.first);
+  EXPECT_EQ(1, t.size());
+  EXPECT_FALSE(t.emplace(0).second);
+  EXPECT_EQ(1, t.size());
+  EXPECT_THAT(*t.find(0), 0);
+  EXPECT_TRUE(t.contains(0));
+  EXPECT_FALSE(t.contains(1));
+  EXPECT_EQ(1, t.erase(0));
+  EXPECT_EQ(0, t.erase(0));
+  EXPECT_TRUE(t.empty());
+  EXPECT_TRUE(t.find(0) == t.end());
+}
+
+TEST(Table, InsertWithinCapacity) {
+  IntTable t;
+  t.reserve(10);
+  const size_t original_capacity = t.capacity();
+  const auto addr = [&](int64_t i) {
+    return reinterpret_cast<uintptr_t>(&*t.find(i));
+  };
+  // Inserting within the reserved size neither rehashes nor moves anything.
+  t.insert(0);
+  const uintptr_t original_addr_0 = addr(0);
+  for (int64_t i = 1; i < 10; ++i) t.insert(i);
+  EXPECT_EQ(original_capacity, t.capacity());
+  EXPECT_EQ(original_addr_0, addr(0));
+}
+
+TEST(Table, ManyInsertsAndLookups) {
+  IntTable t;
+  for (int64_t i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(t.insert(i * 13).second) << i;
+    ASSERT_EQ(i + 1, t.size());
+  }
+  for (int64_t i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(t.contains(i * 13)) << i;
+    ASSERT_FALSE(t.contains(i * 13 + 1)) << i;
+  }
+  EXPECT_LE(t.size(), CapacityToGrowth(t.capacity()));
+  size_t n = 0;
+  for (int64_t v : t) {
+    EXPECT_EQ(0, v % 13);
+    ++n;
+  }
+  EXPECT_EQ(t.size(), n);
+}
+
+TEST(Table, CollidingKeys) {
+  BadTable t;
+  for (int64_t i = 0; i < 100; ++i) ASSERT_TRUE(t.insert(i).second);
+  for (int64_t i = 0; i < 100; ++i) ASSERT_TRUE(t.contains(i));
+  EXPECT_FALSE(t.contains(100));
+  for (int64_t i = 0; i < 100; i += 2) ASSERT_EQ(1, t.erase(i));
+  for (int64_t i = 0; i < 100; ++i) ASSERT_EQ(i % 2 == 1, t.contains(i));
+}
+
+TEST(Table, ChurnReusesTombstonesWithoutGrowing) {
+  // Inserting and erasing at a steady size leaves tombstones behind. Once the
+  // elements fill at most half of the growth allowed, the tombstones are
+  // reclaimed by rehashing in place rather than by growing.
+  IntTable t;
+  for (int64_t i = 0; i < 100; ++i) t.insert(i);
+  for (int64_t i = 100; i < 1000; ++i) {
+    t.erase(i - 100);
+    t.insert(i);
+  }
+  const size_t capacity = t.capacity();
+  EXPECT_LE(capacity, 255);
+  for (int64_t i = 1000; i < 100000; ++i) {
+    t.erase(i - 100);
+    t.insert(i);
+    ASSERT_EQ(100, t.size());
+  }
+  EXPECT_EQ(capacity, t.capacity());
+  for (int64_t i = 100000 - 100; i < 100000; ++i) EXPECT_TRUE(t.contains(i));
+}
+
+TEST(Table, ChurnWithCollisions) {
+  // The same with every key in one probe sequence, so that rehashing in
+  // place moves elements over one another.
+  BadTable t;
+  t.reserve(40);
+  const size_t capacity = t.capacity();
+  for (int64_t i = 0; i < 20; ++i) t.insert(i);
+  for (int64_t i = 20; i < 2000; ++i) {
+    t.erase(i - 20);
+    t.insert(i);
+  }
+  EXPECT_EQ(capacity, t.capacity());
+  std::vector<int64_t> values(t.begin(), t.end());
+  std::sort(values.begin(), values.end());
+  std::vector<int64_t> expected(20);
+  std::iota(expected.begin(), expected.end(), 2000 - 20);
+  EXPECT_THAT(values, ElementsAreArray(expected));
+}
+
+TEST(Table, SmallTablesAfterErase) {
+  // Tables smaller than a group see their slots through the cloned bytes.
+  for (size_t n = 1; n <= 8; ++n) {
+    SCOPED_TRACE(n);
+    IntTable t;
+    std::mt19937 gen(n);
+    std::set<int64_t> reference;
+    for (int i = 0; i < 1000; ++i) {
+      const int64_t v = gen() % (2 * n);
+      if (reference.count(v)) {
+        EXPECT_EQ(1, t.erase(v));
+        reference.erase(v);
+      } else if (reference.size() < n) {
+        EXPECT_TRUE(t.insert(v).second);
+        reference.insert(v);
+      }
+      ASSERT_EQ(reference.size(), t.size());
+    }
+    for (int64_t v = 0; v < static_cast<int64_t>(2 * n); ++v) {
+      EXPECT_EQ(reference.count(v) != 0, t.contains(v)) << v;
+    }
+    EXPECT_EQ(reference, std::set<int64_t>(t.begin(), t.end()));
+  }
+}
+
+TEST(Table, EraseWhileIterating) {
+  IntTable t;
+  for (int64_t i = 0; i < 1000; ++i) t.insert(i);
+  for (auto it = t.begin(); it != t.end();) {
+    if (*it % 3 != 0) {
+      t.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(334, t.size());
+  for (int64_t v : t) EXPECT_EQ(0, v % 3);
+}
+
+TEST(Table, EraseRange) {
+  IntTable t = {1, 2, 3, 4};
+  auto it = t.erase(t.begin(), t.end());
+  EXPECT_TRUE(it == t.end());
+  EXPECT_TRUE(t.empty());
+}
+
+TEST(Table, Clear) {
+  IntTable t;
+  for (int64_t i = 0; i < 100; ++i) t.insert(i);
+  const size_t capacity = t.capacity();
+  t.clear();
+  EXPECT_TRUE(t.empty());
+  EXPECT_EQ(capacity, t.capacity());
+  EXPECT_TRUE(t.begin() == t.end());
+  EXPECT_FALSE(t.contains(5));
+  t.insert(5);
+  EXPECT_TRUE(t.contains(5));
+}
+
+TEST(Table, RehashAndReserve) {
+  IntTable t;
+  t.rehash(0);
+  EXPECT_EQ(0, t.capacity());
+  t.reserve(1000);
+  EXPECT_GE(CapacityToGrowth(t.capacity()), 1000);
+  for (int64_t i = 0; i < 10; ++i) t.insert(i);
+  t.rehash(0);  // Shrinks to fit.
+  EXPECT_EQ(NormalizeCapacity(GrowthToLowerboundCapacity(10)), t.capacity());
+  for (int64_t i = 0; i < 10; ++i) EXPECT_TRUE(t.contains(i));
+  t.rehash(128);
+  EXPECT_EQ(255, t.capacity());
+  for (int64_t i = 0; i < 10; ++i) EXPECT_TRUE(t.contains(i));
+  t.clear();
+  t.rehash(0);  // Frees the slots.
+  EXPECT_EQ(0, t.capacity());
+}
+
+TEST(Table, InsertAfterShrinking) {
+  // Shrinking must leave room for exactly the growth the new capacity allows,
+  // or the table fills up without growing.
+  IntTable t;
+  for (int64_t i = 0; i < 200; ++i) t.insert(i);
+  EXPECT_EQ(255, t.capacity());
+  for (int64_t i = 0; i < 150; ++i) t.erase(i);
+  t.rehash(0);
+  EXPECT_EQ(63, t.capacity());
+  for (int64_t i = 0; i < 150; ++i) {
+    ASSERT_TRUE(t.insert(i).second) << i;
+    ASSERT_LE(t.size(), CapacityToGrowth(t.capacity())) << i;
+  }
+  for (int64_t i = 0; i < 200; ++i) EXPECT_TRUE(t.contains(i)) << i;
+}
+
+TEST(Table, CopyAndMove) {
+  IntTable t;
+  for (int64_t i = 0; i < 100; ++i) t.insert(i);
+  IntTable copy(t);
+  EXPECT_TRUE(copy == t);
+  IntTable moved(std::move(copy));
+  EXPECT_TRUE(moved == t);
+  EXPECT_TRUE(copy.empty());  // NOLINT(bugprone-use-after-move)
+  copy.insert(1);
+  EXPECT_TRUE(copy != t);
+
+  IntTable assigned;
+  assigned = t;
+  EXPECT_TRUE(assigned == t);
+  assigned.erase(50);
+  EXPECT_FALSE(assigned == t);
+  assigned = std::move(moved);
+  EXPECT_TRUE(assigned == t);
+  swap(assigned, copy);
+  EXPECT_THAT(assigned, UnorderedElementsAre(1));
+  EXPECT_TRUE(copy == t);
+}
+
+TEST(Table, EqualityIgnoresOrder) {
+  IntTable a, b;
+  for (int64_t i = 0; i < 100; ++i) a.insert(i);
+  for (int64_t i = 99; i >= 0; --i) b.insert(i);
+  b.reserve(1000);
+  EXPECT_TRUE(a == b);
+}
+
+TEST(Table, LoadFactor) {
+  IntTable t;
+  EXPECT_EQ(0.0, t.load_factor());
+  for (int64_t i = 0; i < 1000; ++i) {
+    t.insert(i);
+    // Tables of less than a group fill up; the group read past their end
+    // has empty slots in it. Larger ones hold 7/8 of `capacity() + 1`.
+    if (t.capacity() >= Group::kWidth) {
+      ASSERT_LE(t.load_factor() * t.capacity(), 7.0 / 8 * (t.capacity() + 1));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace container_internal
+}  // namespace absl
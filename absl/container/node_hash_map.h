@@ -0,0 +1,88 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: node_hash_map.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::node_hash_map<K, V>` is an unordered associative container with
+// the pointer stability of `std::unordered_map`: each element is allocated
+// in a node of its own and never moves, so pointers and references to keys
+// and values stay valid until the element is erased. The table of pointers
+// to the nodes is the one of `absl::flat_hash_map`, probed 16 slots at a
+// time, so lookups are faster than those of `std::unordered_map`.
+//
+// Prefer `absl::flat_hash_map` unless pointers or references to the elements
+// must stay valid across insertions and rehashing. Iterators still don't.
+//
+// Nodes come from `Allocator`, which can be an arena's; see
+// `node_hash_set.h`.
+//
+// Example:
+//
+//   absl::node_hash_map<std::string, Session> sessions;
+//   Session* s = &sessions["alice"];
+//   sessions["bob"];  // May rehash; `s` stays valid.
+
+#ifndef ABSL_CONTAINER_NODE_HASH_MAP_H_
+#define ABSL_CONTAINER_NODE_HASH_MAP_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/container/internal/hash_function_defaults.h"
+#include "absl/container/internal/node_hash_policy.h"
+#include "absl/container/internal/raw_hash_map.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class K, class V>
+struct NodeHashMapPolicy : NodeHashPolicy<std::pair<const K, V>> {
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<const K, V>;
+  using init_type = std::pair<K, V>;
+  static constexpr bool kConstantIterators = false;
+
+  template <class P>
+  static const K& key(const P& p) {
+    return p.first;
+  }
+};
+
+}  // namespace container_internal
+
+// -----------------------------------------------------------------------------
+// absl::node_hash_map
+// -----------------------------------------------------------------------------
+//
+// The interface is that of `absl::flat_hash_map`.
+template <class K, class V,
+          class Hash = container_internal::hash_default_hash<K>,
+          class Eq = container_internal::hash_default_eq<K>,
+          class Allocator = std::allocator<std::pair<const K, V>>>
+class node_hash_map : public container_internal::raw_hash_map<
+                          container_internal::NodeHashMapPolicy<K, V>, Hash,
+                          Eq, Allocator> {
+  using Base = typename node_hash_map::raw_hash_map;
+
+ public:
+  node_hash_map() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_NODE_HASH_MAP_H_
@@ -0,0 +1,88 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/node_hash_map.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/internal/test_instance_tracker.h"
+#include "absl/strings/string_view.h"
+
+namespace {
+
+using ::absl::test_internal::CopyableMovableInstance;
+using ::absl::test_internal::InstanceTracker;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(NodeHashMap, InsertFindErase) {
+  absl::node_hash_map<int, std::string> m;
+  EXPECT_TRUE(m.insert({1, "one"}).second);
+  EXPECT_FALSE(m.insert({1, "uno"}).second);
+  EXPECT_TRUE(m.emplace(2, "two").second);
+  EXPECT_THAT(m, UnorderedElementsAre(Pair(1, "one"), Pair(2, "two")));
+  EXPECT_EQ(1, m.erase(2));
+  EXPECT_TRUE(m.find(2) == m.end());
+}
+
+TEST(NodeHashMap, SubscriptAndAt) {
+  absl::node_hash_map<std::string, int> m;
+  ++m["a"];
+  m.insert_or_assign("b", 2);
+  EXPECT_TRUE(m.try_emplace(absl::string_view("c"), 3).second);
+  EXPECT_THAT(m, UnorderedElementsAre(Pair("a", 1), Pair("b", 2),
+                                      Pair("c", 3)));
+  EXPECT_EQ(2, m.at("b"));
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(m.at("d"), std::out_of_range,
+                                 "raw_hash_map<>::at");
+}
+
+TEST(NodeHashMap, ReferencesSurviveRehash) {
+  absl::node_hash_map<int, std::string> m;
+  std::vector<std::string*> values;
+  for (int i = 0; i < 1000; ++i) values.push_back(&m[i]);
+  for (int i = 0; i < 1000; ++i) *values[i] = std::to_string(i);
+  m.rehash(0);
+  m.reserve(10000);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(values[i], &m[i]);
+    EXPECT_EQ(std::to_string(i), m[i]);
+  }
+}
+
+TEST(NodeHashMap, RehashMovesNoElements) {
+  InstanceTracker tracker;
+  absl::node_hash_map<int, CopyableMovableInstance> m;
+  for (int i = 0; i < 100; ++i) m.try_emplace(i, i);
+  tracker.ResetCopiesMovesSwaps();
+  m.reserve(1000);
+  EXPECT_EQ(0, tracker.copies());
+  EXPECT_EQ(0, tracker.moves());
+}
+
+TEST(NodeHashMap, Equality) {
+  absl::node_hash_map<int, int> a = {{1, 1}, {2, 2}};
+  absl::node_hash_map<int, int> b = {{2, 2}, {1, 1}};
+  EXPECT_TRUE(a == b);
+  b[2] = 3;
+  EXPECT_TRUE(a != b);
+}
+
+}  // namespace
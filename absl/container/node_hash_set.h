@@ -0,0 +1,79 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: node_hash_set.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::node_hash_set<T>` is an unordered associative container of
+// unique values with the pointer stability of `std::unordered_set`: each
+// value is allocated in a node of its own and never moves. The table of
+// pointers to the nodes is the one of `absl::flat_hash_set`, probed 16 slots
+// at a time, so lookups are faster than those of `std::unordered_set`, which
+// follow a linked list per bucket.
+//
+// Prefer `absl::flat_hash_set` unless pointers or references to the values
+// must stay valid across insertions and rehashing. Iterators still don't.
+//
+// Nodes come from `Allocator`, which can be an arena's:
+//
+//   absl::node_hash_set<Request*, std::hash<Request*>,
+//                       std::equal_to<Request*>, ArenaAllocator<Request*>>
+//       pending(0, {}, {}, ArenaAllocator<Request*>(&arena));
+
+#ifndef ABSL_CONTAINER_NODE_HASH_SET_H_
+#define ABSL_CONTAINER_NODE_HASH_SET_H_
+
+#include <memory>
+
+#include "absl/container/internal/hash_function_defaults.h"
+#include "absl/container/internal/node_hash_policy.h"
+#include "absl/container/internal/raw_hash_set.h"
+
+namespace absl {
+namespace container_internal {
+
+template <class T>
+struct NodeHashSetPolicy : NodeHashPolicy<T> {
+  using key_type = T;
+  using value_type = T;
+  using init_type = T;
+  static constexpr bool kConstantIterators = true;
+
+  static const T& key(const T& v) { return v; }
+};
+
+}  // namespace container_internal
+
+// -----------------------------------------------------------------------------
+// absl::node_hash_set
+// -----------------------------------------------------------------------------
+//
+// The interface is that of `absl::flat_hash_set`.
+template <class T, class Hash = container_internal::hash_default_hash<T>,
+          class Eq = container_internal::hash_default_eq<T>,
+          class Allocator = std::allocator<T>>
+class node_hash_set
+    : public container_internal::raw_hash_set<
+          container_internal::NodeHashSetPolicy<T>, Hash, Eq, Allocator> {
+  using Base = typename node_hash_set::raw_hash_set;
+
+ public:
+  node_hash_set() {}
+  using Base::Base;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_NODE_HASH_SET_H_
@@ -0,0 +1,173 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/node_hash_set.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/internal/test_instance_tracker.h"
+
+namespace {
+
+using ::absl::test_internal::CopyableMovableInstance;
+using ::absl::test_internal::InstanceTracker;
+using ::absl::test_internal::MovableOnlyInstance;
+using ::testing::UnorderedElementsAre;
+
+TEST(NodeHashSet, InsertFindErase) {
+  absl::node_hash_set<int> s;
+  EXPECT_TRUE(s.insert(1).second);
+  EXPECT_FALSE(s.insert(1).second);
+  EXPECT_TRUE(s.emplace(2).second);
+  EXPECT_THAT(s, UnorderedElementsAre(1, 2));
+  EXPECT_EQ(1, s.erase(1));
+  EXPECT_EQ(0, s.count(1));
+  EXPECT_THAT(s, UnorderedElementsAre(2));
+}
+
+TEST(NodeHashSet, PointersSurviveRehash) {
+  absl::node_hash_set<std::string> s;
+  std::vector<const std::string*> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    ptrs.push_back(&*s.insert(std::to_string(i)).first);
+  }
+  s.reserve(10000);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(ptrs[i], &*s.find(std::to_string(i)));
+  }
+}
+
+TEST(NodeHashSet, RehashMovesNoElements) {
+  InstanceTracker tracker;
+  struct Hash {
+    size_t operator()(const CopyableMovableInstance& v) const {
+      return std::hash<int>()(v.value());
+    }
+  };
+  struct Eq {
+    bool operator()(const CopyableMovableInstance& a,
+                    const CopyableMovableInstance& b) const {
+      return a.value() == b.value();
+    }
+  };
+  absl::node_hash_set<CopyableMovableInstance, Hash, Eq> s;
+  for (int i = 0; i < 100; ++i) s.emplace(i);
+  tracker.ResetCopiesMovesSwaps();
+  s.reserve(1000);
+  for (int i = 0; i < 100; ++i) s.erase(CopyableMovableInstance(i));
+  EXPECT_EQ(0, tracker.copies());
+  EXPECT_EQ(0, tracker.moves());
+}
+
+TEST(NodeHashSet, MoveOnlyInstances) {
+  InstanceTracker tracker;
+  struct Hash {
+    size_t operator()(const MovableOnlyInstance& v) const {
+      return std::hash<int>()(v.value());
+    }
+  };
+  struct Eq {
+    bool operator()(const MovableOnlyInstance& a,
+                    const MovableOnlyInstance& b) const {
+      return a.value() == b.value();
+    }
+  };
+  {
+    absl::node_hash_set<MovableOnlyInstance, Hash, Eq> s;
+    for (int i = 0; i < 100; ++i) s.insert(MovableOnlyInstance(i));
+    const MovableOnlyInstance* first = &*s.find(MovableOnlyInstance(0));
+    absl::node_hash_set<MovableOnlyInstance, Hash, Eq> moved = std::move(s);
+    EXPECT_EQ(100, moved.size());
+    EXPECT_EQ(first, &*moved.find(MovableOnlyInstance(0)));
+    EXPECT_EQ(100, tracker.live_instances());
+  }
+  EXPECT_EQ(0, tracker.instances());
+}
+
+// Hands out memory from blocks that are freed together, as an arena does.
+class Arena {
+ public:
+  void* Allocate(size_t bytes) {
+    bytes = (bytes + kAlign - 1) & ~(kAlign - 1);
+    if (blocks_.empty() || used_ + bytes > kBlockSize) {
+      blocks_.emplace_back(new Block);
+      used_ = 0;
+    }
+    void* p = blocks_.back()->bytes + used_;
+    used_ += bytes;
+    ++allocations_;
+    return p;
+  }
+
+  size_t allocations() const { return allocations_; }
+  size_t blocks() const { return blocks_.size(); }
+
+ private:
+  static constexpr size_t kAlign = alignof(std::max_align_t);
+  static constexpr size_t kBlockSize = 1 << 16;
+  struct Block {
+    alignas(kAlign) char bytes[kBlockSize];
+  };
+
+  std::vector<std::unique_ptr<Block>> blocks_;
+  size_t used_ = 0;
+  size_t allocations_ = 0;
+};
+
+template <class T>
+struct ArenaAllocator {
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena(arena) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& x) : arena(x.arena) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena->Allocate(n * sizeof(T)));
+  }
+  void deallocate(T*, size_t) {}
+
+  template <class U>
+  friend bool operator==(const ArenaAllocator& a, const ArenaAllocator<U>& b) {
+    return a.arena == b.arena;
+  }
+  template <class U>
+  friend bool operator!=(const ArenaAllocator& a, const ArenaAllocator<U>& b) {
+    return a.arena != b.arena;
+  }
+
+  Arena* arena;
+};
+
+TEST(NodeHashSet, AllocatesNodesFromArena) {
+  Arena arena;
+  {
+    absl::node_hash_set<int64_t, std::hash<int64_t>, std::equal_to<int64_t>,
+                        ArenaAllocator<int64_t>>
+        s(0, std::hash<int64_t>(), std::equal_to<int64_t>(),
+          ArenaAllocator<int64_t>(&arena));
+    for (int64_t i = 0; i < 1000; ++i) s.insert(i);
+    for (int64_t i = 0; i < 1000; ++i) EXPECT_EQ(1, s.count(i));
+  }
+  // One allocation per node, plus one per table the set grew through.
+  EXPECT_GE(arena.allocations(), 1000);
+  EXPECT_LE(arena.allocations(), 1000 + 16);
+}
+
+}  // namespace
@@ -0,0 +1,648 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: segmented_vector.h
+// -----------------------------------------------------------------------------
+//
+// A `SegmentedVector<T>` is a sequence container that stores its elements in
+// fixed-size chunks, reached through a directory of chunk pointers. Unlike
+// `std::vector`, it never moves its elements when it grows: `push_back()`
+// allocates a new chunk when the last one is full, so growth costs one chunk
+// allocation rather than a reallocation and copy of everything so far, and
+// references, pointers and iterators to elements stay valid until the elements
+// are removed. Unlike `std::deque`, the chunk size is a template parameter and
+// a power of two, so indexing is a shift, a mask and two loads.
+//
+// This suits append-mostly sequences that grow large, such as logs, where the
+// latency spike of reallocating a `std::vector` is unacceptable.
+//
+// The chunks are exposed as `absl::Span`s through `num_chunks()` and
+// `chunk()`, so that a sequence can be processed a chunk at a time, for
+// instance in parallel:
+//
+//   absl::SegmentedVector<Event> log;
+//   ...
+//   for (size_t i = 0; i < log.num_chunks(); ++i) {
+//     pool.Schedule([&log, i] { Process(log.chunk(i)); });
+//   }
+
+#ifndef ABSL_CONTAINER_SEGMENTED_VECTOR_H_
+#define ABSL_CONTAINER_SEGMENTED_VECTOR_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/algorithm.h"
+#include "absl/base/internal/throw_delegate.h"
+#include "absl/base/optimization.h"
+#include "absl/types/span.h"
+
+namespace absl {
+namespace segmented_vector_internal {
+
+// Returns the largest power of two that is at most `n`, or 1 if `n` is 0.
+constexpr size_t FloorPow2(size_t n, size_t p = 1) {
+  return p <= n / 2 ? FloorPow2(n, p * 2) : p;
+}
+
+// Returns log2(n) for a power of two `n`.
+constexpr size_t Log2(size_t n) { return n <= 1 ? 0 : 1 + Log2(n / 2); }
+
+// The default number of elements per chunk: as many as fit in 4 KiB, rounded
+// down to a power of two.
+template <typename T>
+constexpr size_t DefaultChunkSize() {
+  return FloorPow2(4096 / sizeof(T));
+}
+
+}  // namespace segmented_vector_internal
+
+// -----------------------------------------------------------------------------
+// SegmentedVector
+// -----------------------------------------------------------------------------
+//
+// `ChunkSize` is the number of elements per chunk and must be a power of two.
+// All chunks but the last are full.
+//
+// `pop_back()` gives back a chunk as soon as a second chunk becomes unused, so
+// that memory follows the size of the sequence without reallocating every
+// time the size crosses a chunk boundary back and forth.
+template <typename T,
+          size_t ChunkSize = segmented_vector_internal::DefaultChunkSize<T>(),
+          typename A = std::allocator<T>>
+class SegmentedVector {
+  static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+                "ChunkSize must be a power of two");
+
+  using AllocatorTraits = std::allocator_traits<A>;
+  using ChunkAllocator = typename AllocatorTraits::template rebind_alloc<
+      typename AllocatorTraits::pointer>;
+
+  static constexpr size_t kShift = segmented_vector_internal::Log2(ChunkSize);
+  static constexpr size_t kMask = ChunkSize - 1;
+
+  template <bool IsConst>
+  class Iterator;
+
+ public:
+  using allocator_type = A;
+  using value_type = T;
+  using pointer = typename AllocatorTraits::pointer;
+  using const_pointer = typename AllocatorTraits::const_pointer;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using size_type = typename AllocatorTraits::size_type;
+  using difference_type = typename AllocatorTraits::difference_type;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type chunk_size = ChunkSize;
+
+  SegmentedVector() noexcept(noexcept(allocator_type()))
+      : SegmentedVector(allocator_type()) {}
+
+  explicit SegmentedVector(const allocator_type& alloc) noexcept
+      : rep_(alloc) {}
+
+  // Creates a vector of `n` value-initialized elements.
+  explicit SegmentedVector(size_type n,
+                           const allocator_type& alloc = allocator_type())
+      : rep_(alloc) {
+    resize(n);
+  }
+
+  // Creates a vector of `n` copies of `v`.
+  SegmentedVector(size_type n, const_reference v,
+                  const allocator_type& alloc = allocator_type())
+      : rep_(alloc) {
+    resize(n, v);
+  }
+
+  SegmentedVector(std::initializer_list<value_type> init,
+                  const allocator_type& alloc = allocator_type())
+      : rep_(alloc) {
+    AppendRange(init.begin(), init.end());
+  }
+
+  template <typename InputIterator,
+            typename = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<InputIterator>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+  SegmentedVector(InputIterator first, InputIterator last,
+                  const allocator_type& alloc = allocator_type())
+      : rep_(alloc) {
+    AppendRange(first, last);
+  }
+
+  SegmentedVector(const SegmentedVector& v)
+      : SegmentedVector(v, AllocatorTraits::select_on_container_copy_construction(
+                               v.get_allocator())) {}
+
+  SegmentedVector(const SegmentedVector& v, const allocator_type& alloc)
+      : rep_(alloc) {
+    AppendRange(v.begin(), v.end());
+  }
+
+  // Takes the chunks of `v`: no element is moved.
+  SegmentedVector(SegmentedVector&& v) noexcept
+      : rep_(std::move(v.rep_)) {}
+
+  SegmentedVector(SegmentedVector&& v, const allocator_type& alloc)
+      : rep_(alloc) {
+    if (alloc == v.get_allocator()) {
+      rep_.chunks.swap(v.rep_.chunks);
+      std::swap(rep_.size, v.rep_.size);
+    } else {
+      for (auto& e : v) emplace_back(std::move(e));
+    }
+  }
+
+  ~SegmentedVector() {
+    clear();
+    ReleaseChunks(0);
+  }
+
+  // Copy assignment copies the elements; the allocator is not propagated.
+  SegmentedVector& operator=(const SegmentedVector& v) {
+    if (this != &v) {
+      clear();
+      AppendRange(v.begin(), v.end());
+    }
+    return *this;
+  }
+
+  SegmentedVector& operator=(SegmentedVector&& v) {
+    if (this != &v) {
+      clear();
+      if (AllocatorTraits::propagate_on_container_move_assignment::value ||
+          get_allocator() == v.get_allocator()) {
+        ReleaseChunks(0);
+        rep_ = std::move(v.rep_);
+      } else {
+        for (auto& e : v) emplace_back(std::move(e));
+      }
+    }
+    return *this;
+  }
+
+  SegmentedVector& operator=(std::initializer_list<value_type> init) {
+    clear();
+    AppendRange(init.begin(), init.end());
+    return *this;
+  }
+
+  // SegmentedVector::size()
+  //
+  // Returns the number of elements in the vector.
+  size_type size() const noexcept { return rep_.size; }
+
+  // SegmentedVector::empty()
+  //
+  // Returns whether the vector is empty.
+  bool empty() const noexcept { return size() == 0; }
+
+  // SegmentedVector::max_size()
+  //
+  // Returns the largest possible value of `size()`.
+  size_type max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(value_type);
+  }
+
+  // SegmentedVector::capacity()
+  //
+  // Returns the number of elements that can be stored without allocating a
+  // chunk.
+  size_type capacity() const noexcept {
+    return rep_.chunks.size() * chunk_size;
+  }
+
+  // SegmentedVector::num_chunks()
+  //
+  // Returns the number of chunks holding elements.
+  size_type num_chunks() const noexcept {
+    return (size() + chunk_size - 1) >> kShift;
+  }
+
+  // SegmentedVector::chunk()
+  //
+  // Returns the elements of the `i`th chunk: `chunk_size` elements for all
+  // chunks but the last. Distinct chunks share no memory.
+  // REQUIRES: i < num_chunks()
+  absl::Span<value_type> chunk(size_type i) {
+    assert(i < num_chunks());
+    return absl::Span<value_type>(rep_.chunks[i], ChunkLength(i));
+  }
+
+  absl::Span<const value_type> chunk(size_type i) const {
+    assert(i < num_chunks());
+    return absl::Span<const value_type>(rep_.chunks[i], ChunkLength(i));
+  }
+
+  // SegmentedVector::operator[]
+  //
+  // Returns a reference to the `i`th element.
+  // REQUIRES: i < size()
+  reference operator[](size_type i) {
+    assert(i < size());
+    return rep_.chunks[i >> kShift][i & kMask];
+  }
+
+  const_reference operator[](size_type i) const {
+    assert(i < size());
+    return rep_.chunks[i >> kShift][i & kMask];
+  }
+
+  // SegmentedVector::at()
+  //
+  // Returns a reference to the `i`th element, or throws `std::out_of_range`.
+  reference at(size_type i) {
+    if (ABSL_PREDICT_FALSE(i >= size())) {
+      base_internal::ThrowStdOutOfRange(
+          "SegmentedVector::at() failed bounds check");
+    }
+    return (*this)[i];
+  }
+
+  const_reference at(size_type i) const {
+    if (ABSL_PREDICT_FALSE(i >= size())) {
+      base_internal::ThrowStdOutOfRange(
+          "SegmentedVector::at() failed bounds check");
+    }
+    return (*this)[i];
+  }
+
+  // SegmentedVector::front()
+  //
+  // Returns a reference to the first element.
+  reference front() {
+    assert(!empty());
+    return (*this)[0];
+  }
+
+  const_reference front() const {
+    assert(!empty());
+    return (*this)[0];
+  }
+
+  // SegmentedVector::back()
+  //
+  // Returns a reference to the last element.
+  reference back() {
+    assert(!empty());
+    return (*this)[size() - 1];
+  }
+
+  const_reference back() const {
+    assert(!empty());
+    return (*this)[size() - 1];
+  }
+
+  // SegmentedVector::begin()
+  //
+  // Returns an iterator to the first element.
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  // SegmentedVector::end()
+  //
+  // Returns an iterator past the last element.
+  iterator end() noexcept { return iterator(this, size()); }
+  const_iterator end() const noexcept { return const_iterator(this, size()); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // SegmentedVector::rbegin()
+  //
+  // Returns a reverse iterator from the last element.
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  // SegmentedVector::rend()
+  //
+  // Returns a reverse iterator past the first element.
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // SegmentedVector::emplace_back()
+  //
+  // Constructs an element at the end of the vector. No existing element is
+  // moved, and references to them stay valid.
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (ABSL_PREDICT_FALSE(size() == capacity())) AddChunk();
+    pointer p = Slot(size());
+    AllocatorTraits::construct(rep_.allocator(), p,
+                               std::forward<Args>(args)...);
+    ++rep_.size;
+    return *p;
+  }
+
+  // SegmentedVector::push_back()
+  //
+  // Appends a copy of `v`, or moves it in.
+  void push_back(const_reference v) { emplace_back(v); }
+  void push_back(value_type&& v) { emplace_back(std::move(v)); }
+
+  // SegmentedVector::pop_back()
+  //
+  // Destroys the last element. Gives back a chunk if two are now unused.
+  // REQUIRES: !empty()
+  void pop_back() noexcept {
+    assert(!empty());
+    --rep_.size;
+    AllocatorTraits::destroy(rep_.allocator(), Slot(size()));
+    if ((size() & kMask) == 0) ReleaseChunks(num_chunks() + 1);
+  }
+
+  // SegmentedVector::resize()
+  //
+  // Resizes the vector to `n` elements, appending value-initialized elements
+  // or copies of `v`, or popping elements from the back.
+  void resize(size_type n) {
+    while (size() > n) pop_back();
+    while (size() < n) emplace_back();
+  }
+
+  void resize(size_type n, const_reference v) {
+    while (size() > n) pop_back();
+    while (size() < n) emplace_back(v);
+  }
+
+  // SegmentedVector::clear()
+  //
+  // Destroys all elements. Keeps one chunk for reuse.
+  void clear() noexcept {
+    while (!empty()) {
+      --rep_.size;
+      AllocatorTraits::destroy(rep_.allocator(), Slot(size()));
+    }
+    ReleaseChunks(1);
+  }
+
+  // SegmentedVector::reserve()
+  //
+  // Allocates chunks until `capacity() >= n`. Later calls to `pop_back()`
+  // may give them back.
+  void reserve(size_type n) {
+    while (capacity() < n) AddChunk();
+  }
+
+  // SegmentedVector::shrink_to_fit()
+  //
+  // Gives back all chunks that hold no element.
+  void shrink_to_fit() {
+    ReleaseChunks(num_chunks());
+    rep_.chunks.shrink_to_fit();
+  }
+
+  // SegmentedVector::swap()
+  //
+  // Swaps the contents of two vectors. No element is moved. The allocators
+  // must compare equal.
+  void swap(SegmentedVector& other) noexcept {
+    using std::swap;
+    assert(get_allocator() == other.get_allocator());
+    rep_.chunks.swap(other.rep_.chunks);
+    swap(rep_.size, other.rep_.size);
+  }
+
+  // SegmentedVector::get_allocator()
+  //
+  // Returns a copy of the allocator.
+  allocator_type get_allocator() const { return rep_.allocator(); }
+
+ private:
+  // The chunk directory, with the allocator as an empty base.
+  struct Rep : allocator_type {
+    explicit Rep(const allocator_type& a)
+        : allocator_type(a), chunks(ChunkAllocator(a)) {}
+    Rep(Rep&& r) noexcept
+        : allocator_type(std::move(r.allocator())),
+          chunks(std::move(r.chunks)),
+          size(r.size) {
+      r.size = 0;
+    }
+    Rep& operator=(Rep&& r) noexcept {
+      if (AllocatorTraits::propagate_on_container_move_assignment::value) {
+        allocator() = std::move(r.allocator());
+      }
+      chunks = std::move(r.chunks);
+      r.chunks.clear();
+      size = r.size;
+      r.size = 0;
+      return *this;
+    }
+
+    allocator_type& allocator() { return *this; }
+    const allocator_type& allocator() const { return *this; }
+
+    std::vector<pointer, ChunkAllocator> chunks;
+    size_type size = 0;
+  };
+
+  template <typename Iter>
+  void AppendRange(Iter first, Iter last) {
+    for (; first != last; ++first) emplace_back(*first);
+  }
+
+  // Returns the address of the `i`th element, which need not be constructed.
+  pointer Slot(size_type i) const {
+    return rep_.chunks[i >> kShift] + (i & kMask);
+  }
+
+  size_type ChunkLength(size_type i) const {
+    return std::min<size_type>(chunk_size, size() - (i << kShift));
+  }
+
+  void AddChunk() {
+    // Grow the directory first, so that a failure to do so leaks no chunk.
+    // Doubling it keeps appending amortized constant time.
+    if (rep_.chunks.size() == rep_.chunks.capacity()) {
+      rep_.chunks.reserve(std::max<size_type>(2 * rep_.chunks.size(), 4));
+    }
+    rep_.chunks.push_back(AllocatorTraits::allocate(rep_.allocator(),
+                                                    chunk_size));
+  }
+
+  // Gives back chunks past the first `keep`.
+  void ReleaseChunks(size_type keep) noexcept {
+    while (rep_.chunks.size() > keep) {
+      AllocatorTraits::deallocate(rep_.allocator(), rep_.chunks.back(),
+                                  chunk_size);
+      rep_.chunks.pop_back();
+    }
+  }
+
+  Rep rep_;
+};
+
+// -----------------------------------------------------------------------------
+// SegmentedVector::Iterator
+// -----------------------------------------------------------------------------
+//
+// A random access iterator holding the vector and an index, so that it stays
+// valid as the vector grows.
+template <typename T, size_t N, typename A>
+template <bool IsConst>
+class SegmentedVector<T, N, A>::Iterator {
+  using Container = typename std::conditional<IsConst, const SegmentedVector,
+                                              SegmentedVector>::type;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename SegmentedVector::value_type;
+  using difference_type = typename SegmentedVector::difference_type;
+  using pointer =
+      typename std::conditional<IsConst, typename SegmentedVector::const_pointer,
+                                typename SegmentedVector::pointer>::type;
+  using reference = typename std::conditional<
+      IsConst, typename SegmentedVector::const_reference,
+      typename SegmentedVector::reference>::type;
+
+  Iterator() = default;
+
+  // Converts an iterator to a const_iterator.
+  template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+  Iterator(const Iterator<false>& it)  // NOLINT(runtime/explicit)
+      : v_(it.v_), i_(it.i_) {}
+
+  reference operator*() const { return (*v_)[i_]; }
+  pointer operator->() const { return &(*v_)[i_]; }
+  reference operator[](difference_type n) const { return (*v_)[i_ + n]; }
+
+  Iterator& operator++() {
+    ++i_;
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator tmp = *this;
+    ++i_;
+    return tmp;
+  }
+  Iterator& operator--() {
+    --i_;
+    return *this;
+  }
+  Iterator operator--(int) {
+    Iterator tmp = *this;
+    --i_;
+    return tmp;
+  }
+  Iterator& operator+=(difference_type n) {
+    i_ += n;
+    return *this;
+  }
+  Iterator& operator-=(difference_type n) {
+    i_ -= n;
+    return *this;
+  }
+
+  friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+  friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+  friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+  friend difference_type operator-(const Iterator& a, const Iterator& b) {
+    return static_cast<difference_type>(a.i_) -
+           static_cast<difference_type>(b.i_);
+  }
+
+  friend bool operator==(const Iterator& a, const Iterator& b) {
+    return a.i_ == b.i_;
+  }
+  friend bool operator!=(const Iterator& a, const Iterator& b) {
+    return a.i_ != b.i_;
+  }
+  friend bool operator<(const Iterator& a, const Iterator& b) {
+    return a.i_ < b.i_;
+  }
+  friend bool operator>(const Iterator& a, const Iterator& b) {
+    return a.i_ > b.i_;
+  }
+  friend bool operator<=(const Iterator& a, const Iterator& b) {
+    return a.i_ <= b.i_;
+  }
+  friend bool operator>=(const Iterator& a, const Iterator& b) {
+    return a.i_ >= b.i_;
+  }
+
+ private:
+  friend class SegmentedVector;
+  friend class Iterator<!IsConst>;
+
+  Iterator(Container* v, size_type i) : v_(v), i_(i) {}
+
+  Container* v_ = nullptr;
+  size_type i_ = 0;
+};
+
+template <typename T, size_t N, typename A>
+constexpr typename SegmentedVector<T, N, A>::size_type
+    SegmentedVector<T, N, A>::chunk_size;
+
+template <typename T, size_t N, typename A>
+constexpr size_t SegmentedVector<T, N, A>::kShift;
+
+template <typename T, size_t N, typename A>
+constexpr size_t SegmentedVector<T, N, A>::kMask;
+
+// -----------------------------------------------------------------------------
+// SegmentedVector Non-Member Functions
+// -----------------------------------------------------------------------------
+
+// swap()
+//
+// Swaps the contents of two segmented vectors.
+template <typename T, size_t N, typename A>
+void swap(SegmentedVector<T, N, A>& a,
+          SegmentedVector<T, N, A>& b) noexcept {
+  a.swap(b);
+}
+
+// operator==()
+//
+// Tests the equivalence of the contents of two segmented vectors.
+template <typename T, size_t N, typename A>
+bool operator==(const SegmentedVector<T, N, A>& a,
+                const SegmentedVector<T, N, A>& b) {
+  return absl::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// operator!=()
+//
+// Tests the inequality of the contents of two segmented vectors.
+template <typename T, size_t N, typename A>
+bool operator!=(const SegmentedVector<T, N, A>& a,
+                const SegmentedVector<T, N, A>& b) {
+  return !(a == b);
+}
+
+}  // namespace absl
+
+#endif  // ABSL_CONTAINER_SEGMENTED_VECTOR_H_
@@ -0,0 +1,82 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/container/segmented_vector.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+template <class T>
+T MakeElement(int i);
+
+template <>
+int64_t MakeElement<int64_t>(int i) {
+  return i;
+}
+
+template <>
+std::string MakeElement<std::string>(int i) {
+  return std::string(i % 32, 'x');
+}
+
+template <class T>
+using SegmentedVector = absl::SegmentedVector<T>;
+
+// Grows from empty, without reserving.
+template <template <class...> class C, class T>
+void BM_PushBack(benchmark::State& state) {
+  const int n = state.range(0);
+  while (state.KeepRunning()) {
+    C<T> c;
+    for (int i = 0; i < n; ++i) c.push_back(MakeElement<T>(i));
+    benchmark::DoNotOptimize(&c.back());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, std::vector, int64_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PushBack, std::deque, int64_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PushBack, SegmentedVector, int64_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PushBack, std::vector, std::string)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_PushBack, std::deque, std::string)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_PushBack, SegmentedVector, std::string)
+    ->Range(64, 1 << 16);
+
+// Reads elements in a scattered order through operator[].
+template <template <class...> class C>
+void BM_Index(benchmark::State& state) {
+  const int n = state.range(0);
+  C<int64_t> c;
+  for (int i = 0; i < n; ++i) c.push_back(i);
+  const int64_t stride = 7919;  // Prime, so every index is visited.
+  while (state.KeepRunning()) {
+    int64_t sum = 0;
+    int64_t j = 0;
+    for (int i = 0; i < n; ++i) {
+      sum += c[j];
+      j = (j + stride) % n;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_Index, std::vector)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Index, std::deque)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Index, SegmentedVector)->Range(1 << 10, 1 << 20);
+
+}  // namespace
@@ -0,0 +1,307 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/container/segmented_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+#include "absl/container/internal/test_instance_tracker.h"
+
+namespace {
+
+using absl::test_internal::CopyableMovableInstance;
+using absl::test_internal::InstanceTracker;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+using IntVec = absl::SegmentedVector<int, 4>;
+
+std::vector<int> Iota(int n) {
+  std::vector<int> v(n);
+  std::iota(v.begin(), v.end(), 0);
+  return v;
+}
+
+TEST(SegmentedVectorTest, DefaultChunkSize) {
+  EXPECT_EQ(absl::SegmentedVector<char>::chunk_size, 4096u);
+  EXPECT_EQ(absl::SegmentedVector<int64_t>::chunk_size, 512u);
+  struct Big {
+    char c[3000];
+  };
+  EXPECT_EQ(absl::SegmentedVector<Big>::chunk_size, 1u);
+  struct Odd {
+    char c[24];
+  };
+  EXPECT_EQ(absl::SegmentedVector<Odd>::chunk_size, 128u);
+}
+
+TEST(SegmentedVectorTest, PushBackAndIndex) {
+  IntVec v;
+  EXPECT_TRUE(v.empty());
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(i);
+    EXPECT_EQ(v.size(), static_cast<size_t>(i + 1));
+    EXPECT_EQ(v.back(), i);
+  }
+  EXPECT_EQ(v.capacity(), 100u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(v[i], i);
+  EXPECT_THAT(v, ElementsAreArray(Iota(100)));
+  EXPECT_EQ(v.front(), 0);
+}
+
+TEST(SegmentedVectorTest, GrowthNeverMovesElements) {
+  InstanceTracker tracker;
+  absl::SegmentedVector<CopyableMovableInstance, 8> v;
+  std::vector<const CopyableMovableInstance*> addresses;
+  for (int i = 0; i < 1000; ++i) {
+    v.emplace_back(i);
+    addresses.push_back(&v.back());
+  }
+  EXPECT_EQ(tracker.copies(), 0);
+  EXPECT_EQ(tracker.moves(), 0);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(&v[i], addresses[i]);
+    EXPECT_EQ(v[i].value(), i);
+  }
+}
+
+TEST(SegmentedVectorTest, IteratorsStayValidOnGrowth) {
+  IntVec v = {1, 2, 3};
+  IntVec::iterator it = v.begin() + 1;
+  const int* p = &v[2];
+  for (int i = 0; i < 100; ++i) v.push_back(i);
+  EXPECT_EQ(*it, 2);
+  EXPECT_EQ(*p, 3);
+}
+
+TEST(SegmentedVectorTest, Iterators) {
+  const std::vector<int> init = Iota(10);
+  IntVec v(init.begin(), init.end());
+  EXPECT_EQ(v.end() - v.begin(), 10);
+  EXPECT_EQ(*(v.begin() + 5), 5);
+  EXPECT_EQ(v.begin()[7], 7);
+  EXPECT_EQ(*(v.end() - 1), 9);
+  EXPECT_TRUE(v.begin() < v.end());
+
+  IntVec::const_iterator cit = v.begin();
+  EXPECT_TRUE(cit == v.cbegin());
+  EXPECT_EQ(*++cit, 1);
+
+  std::vector<int> reversed(v.rbegin(), v.rend());
+  EXPECT_THAT(reversed, ElementsAre(9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+
+  std::sort(v.begin(), v.end(), [](int a, int b) { return a > b; });
+  EXPECT_THAT(v, ElementsAre(9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  EXPECT_EQ(std::lower_bound(v.rbegin(), v.rend(), 4) - v.rbegin(), 4);
+}
+
+TEST(SegmentedVectorTest, Chunks) {
+  IntVec v;
+  EXPECT_EQ(v.num_chunks(), 0u);
+  for (int i = 0; i < 10; ++i) v.push_back(i);
+  ASSERT_EQ(v.num_chunks(), 3u);
+  EXPECT_THAT(v.chunk(0), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(v.chunk(1), ElementsAre(4, 5, 6, 7));
+  EXPECT_THAT(v.chunk(2), ElementsAre(8, 9));
+
+  for (size_t i = 0; i < v.num_chunks(); ++i) {
+    for (int& x : v.chunk(i)) x *= 2;
+  }
+  const IntVec& cv = v;
+  EXPECT_THAT(cv.chunk(2), ElementsAre(16, 18));
+}
+
+TEST(SegmentedVectorTest, PopBackReleasesChunks) {
+  const std::vector<int> init = Iota(16);
+  IntVec v(init.begin(), init.end());
+  EXPECT_EQ(v.capacity(), 16u);
+  for (int i = 0; i < 8; ++i) v.pop_back();
+  EXPECT_EQ(v.size(), 8u);
+  // One unused chunk is kept, so that pushing again doesn't allocate.
+  EXPECT_EQ(v.capacity(), 12u);
+  v.pop_back();
+  EXPECT_EQ(v.capacity(), 12u);
+  for (int i = 0; i < 3; ++i) v.pop_back();
+  EXPECT_EQ(v.capacity(), 8u);
+  EXPECT_THAT(v, ElementsAre(0, 1, 2, 3));
+
+  v.shrink_to_fit();
+  EXPECT_EQ(v.capacity(), 4u);
+  while (!v.empty()) v.pop_back();
+  EXPECT_EQ(v.capacity(), 4u);
+}
+
+TEST(SegmentedVectorTest, ReserveAndClear) {
+  IntVec v;
+  v.reserve(9);
+  EXPECT_EQ(v.capacity(), 12u);
+  EXPECT_TRUE(v.empty());
+  for (int i = 0; i < 9; ++i) v.push_back(i);
+  EXPECT_EQ(v.capacity(), 12u);
+  v.clear();
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(v.capacity(), 4u);
+}
+
+TEST(SegmentedVectorTest, Resize) {
+  IntVec v(3, 7);
+  EXPECT_THAT(v, ElementsAre(7, 7, 7));
+  v.resize(6);
+  EXPECT_THAT(v, ElementsAre(7, 7, 7, 0, 0, 0));
+  v.resize(2);
+  EXPECT_THAT(v, ElementsAre(7, 7));
+  v.resize(4, 1);
+  EXPECT_THAT(v, ElementsAre(7, 7, 1, 1));
+  EXPECT_THAT(IntVec(5), ElementsAre(0, 0, 0, 0, 0));
+}
+
+TEST(SegmentedVectorTest, At) {
+  IntVec v = {1, 2, 3};
+  EXPECT_EQ(v.at(2), 3);
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(v.at(3), std::out_of_range,
+                                 "failed bounds check");
+}
+
+TEST(SegmentedVectorTest, CopyAndAssign) {
+  absl::SegmentedVector<std::string, 2> v = {"a", "b", "c"};
+  absl::SegmentedVector<std::string, 2> copy(v);
+  EXPECT_EQ(copy, v);
+  copy.push_back("d");
+  EXPECT_NE(copy, v);
+  v = copy;
+  EXPECT_THAT(v, ElementsAre("a", "b", "c", "d"));
+  v = {"x"};
+  EXPECT_THAT(v, ElementsAre("x"));
+}
+
+TEST(SegmentedVectorTest, MoveTakesChunks) {
+  const std::vector<int> init = Iota(10);
+  IntVec v(init.begin(), init.end());
+  const int* p = &v[9];
+  IntVec moved(std::move(v));
+  EXPECT_EQ(&moved[9], p);
+  EXPECT_TRUE(v.empty());  // NOLINT(bugprone-use-after-move)
+
+  IntVec assigned = {1};
+  assigned = std::move(moved);
+  EXPECT_EQ(&assigned[9], p);
+  EXPECT_THAT(assigned, ElementsAreArray(Iota(10)));
+}
+
+TEST(SegmentedVectorTest, Swap) {
+  IntVec a = {1, 2, 3, 4, 5};
+  IntVec b = {6};
+  const int* p = &a[4];
+  swap(a, b);
+  EXPECT_THAT(a, ElementsAre(6));
+  EXPECT_THAT(b, ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_EQ(&b[4], p);
+}
+
+TEST(SegmentedVectorTest, DestroysElements) {
+  InstanceTracker tracker;
+  {
+    absl::SegmentedVector<CopyableMovableInstance, 4> v;
+    for (int i = 0; i < 10; ++i) v.emplace_back(i);
+    EXPECT_EQ(tracker.instances(), 10);
+    v.pop_back();
+    EXPECT_EQ(tracker.instances(), 9);
+    v.resize(5, CopyableMovableInstance(0));
+    EXPECT_EQ(tracker.instances(), 5);
+    v.clear();
+    EXPECT_EQ(tracker.instances(), 0);
+    v.emplace_back(1);
+  }
+  EXPECT_EQ(tracker.instances(), 0);
+}
+
+// Counts the allocations it has made and not yet freed, and optionally all
+// the allocations it has made.
+template <typename T>
+class CountingAllocator : public std::allocator<T> {
+ public:
+  template <typename U>
+  struct rebind {
+    using other = CountingAllocator<U>;
+  };
+
+  explicit CountingAllocator(int* live, int* total = nullptr)
+      : live_(live), total_(total) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& other)  // NOLINT
+      : live_(other.live_), total_(other.total_) {}
+
+  T* allocate(size_t n) {
+    ++*live_;
+    if (total_ != nullptr) ++*total_;
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    --*live_;
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  template <typename U>
+  friend class CountingAllocator;
+
+  friend bool operator==(const CountingAllocator& a,
+                         const CountingAllocator& b) {
+    return a.live_ == b.live_;
+  }
+  friend bool operator!=(const CountingAllocator& a,
+                         const CountingAllocator& b) {
+    return !(a == b);
+  }
+
+ private:
+  int* live_;
+  int* total_;
+};
+
+TEST(SegmentedVectorTest, AllocatesThroughAllocator) {
+  int live = 0;
+  {
+    absl::SegmentedVector<int, 4, CountingAllocator<int>> v(
+        (CountingAllocator<int>(&live)));
+    for (int i = 0; i < 10; ++i) v.push_back(i);
+    // Three chunks and the directory.
+    EXPECT_EQ(live, 4);
+  }
+  EXPECT_EQ(live, 0);
+}
+
+TEST(SegmentedVectorTest, DirectoryGrowsGeometrically) {
+  // One chunk per element. Growing the directory one entry at a time would
+  // reallocate it for every element, and make appending quadratic.
+  int live = 0;
+  int total = 0;
+  absl::SegmentedVector<int, 1, CountingAllocator<int>> v(
+      (CountingAllocator<int>(&live, &total)));
+  constexpr int kSize = 1 << 12;
+  for (int i = 0; i < kSize; ++i) v.push_back(i);
+  EXPECT_EQ(v.num_chunks(), kSize);
+  EXPECT_LE(total, kSize + 12);
+  for (int i = 0; i < kSize; ++i) ASSERT_EQ(v[i], i);
+}
+
+}  // namespace
@@ -0,0 +1,396 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/cpu_profiler.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(SIGEV_THREAD_ID)
+#define ABSL_HAVE_CPU_PROFILER 1
+#endif
+
+#ifdef ABSL_HAVE_CPU_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <utility>
+
+#include "absl/base/internal/sysinfo.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/debugging/internal/examine_stack.h"
+#include "absl/debugging/internal/profile_builder.h"
+#include "absl/debugging/internal/stack_depot.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+// Older C libraries do not name the thread ID field of struct sigevent.
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace absl {
+namespace {
+
+constexpr int kMaxThreads = 4096;
+constexpr int kMaxDepth = 64;
+constexpr int kMaxFrequencyHz = 1000;
+
+// Each thread's samples wait in a ring until the collector drains it, which
+// it does often enough that a thread using a whole CPU fills at most half its
+// ring in between (see DrainInterval()). Samples that still find the ring
+// full, e.g. because the collector was descheduled, are dropped and counted.
+// New and exited threads are looked for every kScanInterval.
+constexpr uint32_t kRingSize = 32;
+constexpr absl::Duration kScanInterval = absl::Milliseconds(100);
+
+// Returns how often to drain the rings when sampling at `frequency_hz`.
+absl::Duration DrainInterval(int frequency_hz) {
+  return std::min(kScanInterval,
+                  absl::Seconds(1) * (kRingSize / 2) / frequency_hz);
+}
+
+struct Sample {
+  int depth;
+  void* pcs[kMaxDepth];
+};
+
+// The samples of one thread. The thread's signal handler is the only writer
+// and the collector thread the only reader, so the ring needs no locks.
+struct ThreadBuffer {
+  std::atomic<uint32_t> head{0};  // Next sample to write.
+  std::atomic<uint32_t> tail{0};  // Next sample to read.
+  std::atomic<uint32_t> dropped{0};  // Samples that found the ring full.
+  Sample samples[kRingSize];
+};
+
+// Indexed by the slot number that each timer's signal carries. Buffers are
+// never freed, so a signal that arrives late never touches freed memory.
+std::atomic<ThreadBuffer*> g_buffers[kMaxThreads];
+std::atomic<bool> g_sampling;
+
+void ProfHandler(int, siginfo_t* info, void* uc) {
+  if (!g_sampling.load(std::memory_order_relaxed) || info == nullptr ||
+      info->si_code != SI_TIMER) {
+    return;
+  }
+  const int slot = info->si_value.sival_int;
+  if (slot < 0 || slot >= kMaxThreads) return;
+  ThreadBuffer* buffer = g_buffers[slot].load(std::memory_order_acquire);
+  if (buffer == nullptr) return;
+  const uint32_t head = buffer->head.load(std::memory_order_relaxed);
+  if (head - buffer->tail.load(std::memory_order_acquire) >= kRingSize) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const int saved_errno = errno;
+  Sample& sample = buffer->samples[head % kRingSize];
+  sample.depth =
+      debug_internal::GetSignalStackTrace(sample.pcs, kMaxDepth, uc);
+  buffer->head.store(head + 1, std::memory_order_release);
+  errno = saved_errno;
+}
+
+// Returns the CPU-time clock of thread `tid` of this process, in the
+// kernel's encoding (MAKE_THREAD_CPUCLOCK in linux/posix-timers.h).
+clockid_t ThreadCpuClock(pid_t tid) {
+  return static_cast<clockid_t>((~static_cast<unsigned>(tid) << 3) | 6u);
+}
+
+// Creates a timer that sends SIGPROF carrying `slot` to thread `tid` each time
+// the thread uses `period_ns` of CPU time.
+bool ArmTimer(pid_t tid, int slot, int64_t period_ns, timer_t* timer) {
+  struct sigevent event;
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = tid;
+  event.sigev_value.sival_int = slot;
+  if (timer_create(ThreadCpuClock(tid), &event, timer) != 0) return false;
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = period_ns / 1000000000;
+  spec.it_interval.tv_nsec = period_ns % 1000000000;
+  spec.it_value = spec.it_interval;
+  if (timer_settime(*timer, 0, &spec, nullptr) != 0) {
+    timer_delete(*timer);
+    return false;
+  }
+  return true;
+}
+
+// Installs ProfHandler for SIGPROF unless another handler is installed. The
+// handler stays installed for the life of the process, since a signal may be
+// pending after the profiler stops.
+bool InstallHandler() {
+  static bool installed = false;
+  if (installed) return true;
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = ProfHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  struct sigaction old_action;
+  if (sigaction(SIGPROF, &action, &old_action) != 0) return false;
+  if ((old_action.sa_flags & SA_SIGINFO) != 0 ||
+      (old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN)) {
+    sigaction(SIGPROF, &old_action, nullptr);
+    return false;
+  }
+  installed = true;
+  return true;
+}
+
+int64_t NowNanos() { return absl::GetCurrentTimeNanos(); }
+
+class Profiler {
+ public:
+  bool Start(int frequency_hz);
+  void Stop();
+  std::string Collect();
+
+ private:
+  // Body of the collector thread.
+  void Run();
+  // Moves samples from the thread buffers into counts_.
+  void Drain() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Arms timers for new threads and deletes those of exited threads.
+  void ScanThreads() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void DeleteTimers() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  absl::Mutex control_mu_;  // Serializes Start() and Stop().
+  std::thread collector_;   // Guarded by control_mu_.
+
+  absl::Mutex mu_;
+  bool running_ GUARDED_BY(mu_) = false;
+  bool stopping_ GUARDED_BY(mu_) = false;
+  int64_t period_ns_ GUARDED_BY(mu_) = 0;
+  absl::Duration drain_interval_ GUARDED_BY(mu_);
+  int64_t dropped_ GUARDED_BY(mu_) = 0;  // Samples dropped since Collect().
+  int64_t start_nanos_ GUARDED_BY(mu_) = 0;
+  int64_t stop_nanos_ GUARDED_BY(mu_) = 0;
+  pid_t collector_tid_ GUARDED_BY(mu_) = 0;
+  int num_buffers_ GUARDED_BY(mu_) = 0;
+  uint32_t scan_ GUARDED_BY(mu_) = 0;
+  std::unordered_map<pid_t, int> slots_ GUARDED_BY(mu_);
+  struct Slot {
+    pid_t tid;  // 0 if free.
+    timer_t timer;
+    uint32_t last_seen;  // The value of scan_ when the thread last existed.
+  };
+  Slot slot_info_[kMaxThreads] GUARDED_BY(mu_) = {};
+  std::unordered_map<uint32_t, int64_t> counts_ GUARDED_BY(mu_);
+};
+
+bool Profiler::Start(int frequency_hz) {
+  if (frequency_hz <= 0 || frequency_hz > kMaxFrequencyHz) return false;
+  absl::MutexLock control_lock(&control_mu_);
+  {
+    absl::MutexLock lock(&mu_);
+    if (running_ || !InstallHandler()) return false;
+    period_ns_ = 1000000000 / frequency_hz;
+    drain_interval_ = DrainInterval(frequency_hz);
+    if (counts_.empty()) start_nanos_ = NowNanos();
+    running_ = true;
+    stopping_ = false;
+    g_sampling.store(true, std::memory_order_relaxed);
+    ScanThreads();
+  }
+  collector_ = std::thread(&Profiler::Run, this);
+  return true;
+}
+
+void Profiler::Stop() {
+  absl::MutexLock control_lock(&control_mu_);
+  {
+    absl::MutexLock lock(&mu_);
+    if (!running_) return;
+    stopping_ = true;
+  }
+  collector_.join();
+  absl::MutexLock lock(&mu_);
+  g_sampling.store(false, std::memory_order_relaxed);
+  DeleteTimers();
+  Drain();
+  running_ = false;
+  stop_nanos_ = NowNanos();
+}
+
+std::string Profiler::Collect() {
+  std::unordered_map<uint32_t, int64_t> counts;
+  int64_t start_nanos;
+  int64_t end_nanos;
+  int64_t period_ns;
+  int64_t dropped;
+  {
+    absl::MutexLock lock(&mu_);
+    Drain();
+    counts.swap(counts_);
+    dropped = dropped_;
+    dropped_ = 0;
+    start_nanos = start_nanos_;
+    end_nanos = running_ ? NowNanos() : stop_nanos_;
+    start_nanos_ = end_nanos;
+    period_ns = period_ns_;
+  }
+
+  debug_internal::ProfileBuilder builder;
+  builder.AddSampleType("samples", "count");
+  builder.AddSampleType("cpu", "nanoseconds");
+  builder.SetPeriod("cpu", "nanoseconds", period_ns);
+  builder.SetTime(start_nanos, end_nanos - start_nanos);
+  if (dropped > 0) {
+    builder.AddComment(std::to_string(dropped) +
+                       " samples dropped: a thread's buffer was full");
+  }
+  for (const auto& stack_and_count : counts) {
+    void* const* pcs;
+    const int depth = debug_internal::StackDepotGet(stack_and_count.first, &pcs);
+    const int64_t values[] = {stack_and_count.second,
+                              stack_and_count.second * period_ns};
+    builder.AddSample(pcs, depth, values);
+  }
+  return builder.Emit();
+}
+
+void Profiler::Run() {
+  absl::MutexLock lock(&mu_);
+  collector_tid_ = base_internal::GetTID();
+  absl::Time next_scan = absl::Now() + kScanInterval;
+  while (!mu_.AwaitWithTimeout(absl::Condition(&stopping_),
+                               drain_interval_)) {
+    Drain();
+    if (absl::Now() >= next_scan) {
+      ScanThreads();
+      next_scan = absl::Now() + kScanInterval;
+    }
+  }
+}
+
+void Profiler::Drain() {
+  for (int i = 0; i < num_buffers_; ++i) {
+    ThreadBuffer* buffer = g_buffers[i].load(std::memory_order_relaxed);
+    const uint32_t head = buffer->head.load(std::memory_order_acquire);
+    uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      const Sample& sample = buffer->samples[tail % kRingSize];
+      ++counts_[debug_internal::StackDepotPut(sample.pcs, sample.depth)];
+    }
+    buffer->tail.store(tail, std::memory_order_release);
+    dropped_ += buffer->dropped.exchange(0, std::memory_order_relaxed);
+  }
+}
+
+void Profiler::ScanThreads() {
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) return;
+  ++scan_;
+  int free_slot = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    const pid_t tid = static_cast<pid_t>(atoi(entry->d_name));
+    if (tid <= 0 || tid == collector_tid_) continue;
+    auto it = slots_.find(tid);
+    if (it != slots_.end()) {
+      slot_info_[it->second].last_seen = scan_;
+      continue;
+    }
+    while (free_slot < kMaxThreads && slot_info_[free_slot].tid != 0) {
+      ++free_slot;
+    }
+    if (free_slot == kMaxThreads) break;
+    if (free_slot == num_buffers_) {
+      g_buffers[free_slot].store(new ThreadBuffer, std::memory_order_release);
+      ++num_buffers_;
+    }
+    Slot& slot = slot_info_[free_slot];
+    // The thread may exit before its timer is armed; it is then skipped.
+    if (ArmTimer(tid, free_slot, period_ns_, &slot.timer)) {
+      slot.tid = tid;
+      slot.last_seen = scan_;
+      slots_.emplace(tid, free_slot);
+    }
+  }
+  closedir(dir);
+
+  for (int i = 0; i < num_buffers_; ++i) {
+    Slot& slot = slot_info_[i];
+    if (slot.tid != 0 && slot.last_seen != scan_) {
+      timer_delete(slot.timer);
+      slots_.erase(slot.tid);
+      slot.tid = 0;
+    }
+  }
+}
+
+void Profiler::DeleteTimers() {
+  for (int i = 0; i < num_buffers_; ++i) {
+    Slot& slot = slot_info_[i];
+    if (slot.tid != 0) {
+      timer_delete(slot.timer);
+      slot.tid = 0;
+    }
+  }
+  slots_.clear();
+}
+
+Profiler* GetProfiler() {
+  static Profiler* profiler = new Profiler;
+  return profiler;
+}
+
+}  // namespace
+
+bool StartCpuProfiler(int frequency_hz) {
+  return GetProfiler()->Start(frequency_hz);
+}
+
+void StopCpuProfiler() { GetProfiler()->Stop(); }
+
+std::string CollectCpuProfile() { return GetProfiler()->Collect(); }
+
+}  // namespace absl
+
+#else  // ABSL_HAVE_CPU_PROFILER
+
+#include "absl/debugging/internal/examine_stack.h"
+#include "absl/debugging/internal/profile_builder.h"
+
+namespace absl {
+
+bool StartCpuProfiler(int) { return false; }
+
+void StopCpuProfiler() {}
+
+std::string CollectCpuProfile() {
+  debug_internal::ProfileBuilder builder;
+  builder.AddSampleType("samples", "count");
+  builder.AddSampleType("cpu", "nanoseconds");
+  return builder.Emit();
+}
+
+}  // namespace absl
+
+#endif  // ABSL_HAVE_CPU_PROFILER
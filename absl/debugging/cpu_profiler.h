@@ -0,0 +1,72 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: cpu_profiler.h
+// -----------------------------------------------------------------------------
+//
+// This file declares a sampling CPU profiler that is cheap enough to leave
+// running in production. While it runs, every thread in the process is
+// interrupted with SIGPROF each time it uses another 1/frequency seconds of
+// CPU time, and the signal handler records the thread's stack. A background
+// thread collects the stacks, and `absl::CollectCpuProfile()` returns them in
+// pprof's format.
+//
+// Example:
+//
+//   absl::StartCpuProfiler(100);
+//   ...
+//   std::string profile = absl::CollectCpuProfile();
+//   // Save `profile` and view it with `pprof -top profile.pb`.
+//
+// The profiler is only available on Linux. It owns SIGPROF while it runs, so
+// it cannot be combined with other users of that signal, such as setitimer()
+// based profilers.
+
+#ifndef ABSL_DEBUGGING_CPU_PROFILER_H_
+#define ABSL_DEBUGGING_CPU_PROFILER_H_
+
+#include <string>
+
+namespace absl {
+
+// StartCpuProfiler()
+//
+// Starts sampling the CPU time of every thread in the process, current and
+// future, `frequency_hz` times per CPU-second. Returns false if the profiler
+// is already running, `frequency_hz` is not in [1, 1000], or profiling is not
+// supported on this platform.
+bool StartCpuProfiler(int frequency_hz = 100);
+
+// StopCpuProfiler()
+//
+// Stops sampling. Samples taken so far remain available to
+// `CollectCpuProfile()`. Does nothing if the profiler is not running.
+void StopCpuProfiler();
+
+// CollectCpuProfile()
+//
+// Returns the samples taken since the profiler was started or since the
+// previous call, as a serialized pprof `Profile` protocol buffer
+// (github.com/google/pprof, proto/profile.proto), and discards them. Stack
+// frames are symbolized with `absl::Symbolize()`.
+//
+// Each sample has two values: "samples" (a count) and "cpu" (nanoseconds).
+// Samples taken faster than the profiler's background thread could collect
+// them are dropped; the profile then has a comment saying how many.
+std::string CollectCpuProfile();
+
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_CPU_PROFILER_H_
@@ -0,0 +1,83 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/cpu_profiler.h"
+
+#include <time.h>
+
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+
+#ifdef __linux__
+
+namespace {
+
+// Returns the CPU time used by the calling thread, in nanoseconds.
+int64_t ThreadCpuNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * int64_t{1000000000} + ts.tv_nsec;
+}
+
+// Spins until the calling thread has used `nanos` of CPU time.
+ABSL_ATTRIBUTE_NOINLINE void BusyLoopForProfilerTest(int64_t nanos) {
+  const int64_t end = ThreadCpuNanos() + nanos;
+  volatile int sink = 0;
+  while (ThreadCpuNanos() < end) {
+    for (int i = 0; i < 1000; ++i) sink = sink + i;
+  }
+}
+
+TEST(CpuProfiler, RejectsBadFrequency) {
+  EXPECT_FALSE(absl::StartCpuProfiler(0));
+  EXPECT_FALSE(absl::StartCpuProfiler(-1));
+  // Faster than the per-thread buffers can be collected, or than the timers'
+  // nanosecond resolution.
+  EXPECT_FALSE(absl::StartCpuProfiler(1001));
+  EXPECT_FALSE(absl::StartCpuProfiler(2000000000));
+}
+
+TEST(CpuProfiler, SamplesBusyThreads) {
+  ASSERT_TRUE(absl::StartCpuProfiler(1000));
+  EXPECT_FALSE(absl::StartCpuProfiler(1000));
+  // Threads started after the profiler are sampled too.
+  std::thread thread([]() { BusyLoopForProfilerTest(300000000); });
+  BusyLoopForProfilerTest(300000000);
+  thread.join();
+  absl::StopCpuProfiler();
+
+  const std::string profile = absl::CollectCpuProfile();
+  EXPECT_NE(std::string::npos, profile.find("BusyLoopForProfilerTest"));
+  EXPECT_NE(std::string::npos, profile.find("nanoseconds"));
+  // The samples were consumed by the first collection.
+  EXPECT_EQ(std::string::npos,
+            absl::CollectCpuProfile().find("BusyLoopForProfilerTest"));
+}
+
+TEST(CpuProfiler, Restarts) {
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(absl::StartCpuProfiler(1000));
+    BusyLoopForProfilerTest(50000000);
+    absl::StopCpuProfiler();
+  }
+  EXPECT_NE(std::string::npos,
+            absl::CollectCpuProfile().find("BusyLoopForProfilerTest"));
+}
+
+}  // namespace
+
+#endif  // __linux__
@@ -0,0 +1,363 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/failure_signal_handler.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/attributes.h"
+#include "absl/base/internal/raw_logging.h"
+#include "absl/base/internal/sysinfo.h"
+#include "absl/debugging/internal/examine_stack.h"
+#include "absl/synchronization/mutex.h"
+
+#if defined(__linux__) && defined(SYS_tgkill) && defined(SYS_getdents64)
+#define ABSL_HAVE_THREAD_DUMP 1
+#endif
+
+namespace absl {
+
+ABSL_CONST_INIT static FailureSignalHandlerOptions fsh_options;
+
+namespace {
+
+constexpr int kMaxFrames = 64;
+
+struct FailureSignalData {
+  const int signo;
+  const char* const as_string;
+  struct sigaction previous_action;
+};
+
+ABSL_CONST_INIT FailureSignalData failure_signal_data[] = {
+    {SIGSEGV, "SIGSEGV", {}},
+    {SIGILL, "SIGILL", {}},
+    {SIGFPE, "SIGFPE", {}},
+    {SIGABRT, "SIGABRT", {}},
+    {SIGBUS, "SIGBUS", {}},
+};
+
+void RaiseToDefaultHandler(int signo) {
+  signal(signo, SIG_DFL);
+  raise(signo);
+}
+
+void RaiseToPreviousHandler(int signo) {
+  for (const FailureSignalData& data : failure_signal_data) {
+    if (data.signo == signo) {
+      sigaction(signo, &data.previous_action, nullptr);
+      raise(signo);
+      return;
+    }
+  }
+  RaiseToDefaultHandler(signo);
+}
+
+const char* FailureSignalToString(int signo) {
+  for (const FailureSignalData& data : failure_signal_data) {
+    if (data.signo == signo) {
+      return data.as_string;
+    }
+  }
+  return "";
+}
+
+void WriteToStderr(const char* data) {
+  const int saved_errno = errno;
+  size_t size = strlen(data);
+  while (size > 0) {
+    const ssize_t written = write(STDERR_FILENO, data, size);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) break;
+    data += written;
+    size -= written;
+  }
+  errno = saved_errno;
+}
+
+void (*Writer())(const char*) {
+  return fsh_options.writerfn != nullptr ? fsh_options.writerfn
+                                         : &WriteToStderr;
+}
+
+// Appends the decimal digits of `value` at `p`, and returns the end.
+char* AppendDecimal(char* p, int64_t value) {
+  if (value < 0) {
+    *p++ = '-';
+    value = -value;
+  }
+  char digits[20];
+  int n = 0;
+  do {
+    digits[n++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  while (n > 0) *p++ = digits[--n];
+  return p;
+}
+
+char* AppendString(char* p, const char* s) {
+  const size_t size = strlen(s);
+  memcpy(p, s, size);
+  return p + size;
+}
+
+bool SetupAlternateStackOnce() {
+  const size_t page_mask = getpagesize() - 1;
+  const size_t stack_size =
+      (std::max<size_t>(SIGSTKSZ, 65536) + page_mask) & ~page_mask;
+  stack_t sigstk;
+  memset(&sigstk, 0, sizeof(sigstk));
+  sigstk.ss_size = stack_size;
+  sigstk.ss_sp = mmap(nullptr, stack_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (sigstk.ss_sp == MAP_FAILED) {
+    ABSL_RAW_LOG(FATAL, "mmap() for alternate signal stack failed");
+  }
+  if (sigaltstack(&sigstk, nullptr) != 0) {
+    ABSL_RAW_LOG(FATAL, "sigaltstack() failed with errno=%d", errno);
+  }
+  return true;
+}
+
+// Sets up an alternate stack for signal handlers once, and returns the
+// sigaction flag that makes a handler use it.
+int MaybeSetupAlternateStack() {
+  ABSL_ATTRIBUTE_UNUSED static const bool kOnce = SetupAlternateStackOnce();
+  return SA_ONSTACK;
+}
+
+void InstallOneFailureHandler(FailureSignalData* data,
+                              void (*handler)(int, siginfo_t*, void*)) {
+  struct sigaction act;
+  memset(&act, 0, sizeof(act));
+  sigemptyset(&act.sa_mask);
+  act.sa_flags |= SA_SIGINFO;
+  // SA_NODEFER is required to handle SIGABRT from
+  // ImmediateAbortSignalHandler().
+  act.sa_flags |= SA_NODEFER;
+  if (fsh_options.use_alternate_stack) {
+    act.sa_flags |= MaybeSetupAlternateStack();
+  }
+  act.sa_sigaction = handler;
+  ABSL_RAW_CHECK(sigaction(data->signo, &act, &data->previous_action) == 0,
+                 "sigaction() failed");
+}
+
+void ImmediateAbortSignalHandler(int) { RaiseToDefaultHandler(SIGABRT); }
+
+#ifdef ABSL_HAVE_THREAD_DUMP
+
+constexpr int kThreadDumpSignal = SIGURG;
+
+// The thread asked to dump its stack, until its handler claims the request
+// by resetting this to 0.
+std::atomic<pid_t> dump_tid(0);
+// The depth of dump_stack, or -1 until the claiming handler has filled it.
+std::atomic<int> dump_depth(-1);
+void* dump_stack[kMaxFrames];
+
+void ThreadDumpSignalHandler(int, siginfo_t* info, void* ucontext) {
+  if (info == nullptr || info->si_code != SI_TKILL ||
+      info->si_pid != getpid()) {
+    return;
+  }
+  pid_t tid = base_internal::GetTID();
+  if (!dump_tid.compare_exchange_strong(tid, 0, std::memory_order_acquire)) {
+    return;
+  }
+  const int saved_errno = errno;
+  const int depth =
+      debug_internal::GetSignalStackTrace(dump_stack, kMaxFrames, ucontext);
+  dump_depth.store(depth, std::memory_order_release);
+  errno = saved_errno;
+}
+
+void SleepOneMillisecond() {
+  const struct timespec ts = {0, 1000000};
+  nanosleep(&ts, nullptr);
+}
+
+// Interrupts thread `tid` and writes the stack it reports.
+void DumpThread(pid_t tid) {
+  char header[64];
+  char* p = AppendString(header, "Thread ");
+  p = AppendDecimal(p, tid);
+  p = AppendString(p, ":\n");
+  *p = '\0';
+  Writer()(header);
+
+  dump_depth.store(-1, std::memory_order_relaxed);
+  dump_tid.store(tid, std::memory_order_release);
+  if (syscall(SYS_tgkill, getpid(), tid, kThreadDumpSignal) != 0) {
+    dump_tid.store(0, std::memory_order_relaxed);
+    Writer()("    (exited)\n");
+    return;
+  }
+  for (int i = 0; i < 100 && dump_depth.load(std::memory_order_acquire) < 0;
+       ++i) {
+    SleepOneMillisecond();
+  }
+  pid_t expected = tid;
+  if (dump_tid.compare_exchange_strong(expected, 0,
+                                       std::memory_order_relaxed)) {
+    Writer()("    (did not respond)\n");
+    return;
+  }
+  // The thread has claimed the request; wait for it to finish.
+  int depth;
+  while ((depth = dump_depth.load(std::memory_order_acquire)) < 0) {
+    SleepOneMillisecond();
+  }
+  debug_internal::DumpStackTrace(dump_stack, depth,
+                                 fsh_options.symbolize_stacktrace, Writer());
+}
+
+// The layout of the records returned by getdents64(2).
+struct KernelDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;  // NOLINT(runtime/int)
+  unsigned char d_type;
+  char d_name[1];
+};
+
+// Dumps the stack of every thread but `this_tid`. opendir() allocates, so
+// /proc/self/task is read with the getdents64 system call instead.
+void DumpOtherThreads(pid_t this_tid) {
+  struct sigaction act;
+  memset(&act, 0, sizeof(act));
+  sigemptyset(&act.sa_mask);
+  act.sa_flags = SA_SIGINFO | SA_RESTART;
+  act.sa_sigaction = ThreadDumpSignalHandler;
+  if (sigaction(kThreadDumpSignal, &act, nullptr) != 0) return;
+
+  const int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return;
+  alignas(KernelDirent64) char buffer[4096];
+  long size;  // NOLINT(runtime/int)
+  while ((size = syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) > 0) {
+    for (long offset = 0; offset < size;) {  // NOLINT(runtime/int)
+      const KernelDirent64* entry =
+          reinterpret_cast<const KernelDirent64*>(buffer + offset);
+      offset += entry->d_reclen;
+      pid_t tid = 0;
+      const char* c = entry->d_name;
+      for (; *c >= '0' && *c <= '9'; ++c) tid = tid * 10 + (*c - '0');
+      if (*c != '\0' || tid <= 0 || tid == this_tid) continue;
+      DumpThread(tid);
+    }
+  }
+  close(fd);
+}
+
+#endif  // ABSL_HAVE_THREAD_DUMP
+
+std::atomic<pid_t> failed_tid(0);
+void* failure_stack[kMaxFrames];
+
+void AbslFailureSignalHandler(int signo, siginfo_t*, void* ucontext) {
+  const pid_t this_tid = base_internal::GetTID();
+  pid_t previous_failed_tid = 0;
+  if (!failed_tid.compare_exchange_strong(previous_failed_tid, this_tid,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+    if (previous_failed_tid != this_tid) {
+      // Another thread is reporting a failure and will end the process; let
+      // it finish. This thread can still dump its stack for it.
+      for (;;) pause();
+    }
+    // This thread failed again while reporting; give up on the report.
+    RaiseToDefaultHandler(signo);
+    return;
+  }
+
+  // Guarantee that the process ends even if reporting hangs.
+  if (fsh_options.alarm_on_failure_secs > 0) {
+    alarm(0);  // Cancel any existing alarms.
+    signal(SIGALRM, ImmediateAbortSignalHandler);
+    alarm(fsh_options.alarm_on_failure_secs);
+  }
+
+  // Symbolization and the caller's writerfn may take locks.
+  Mutex::InternalAttemptToUseMutexInFatalSignalHandler();
+
+  const int depth = debug_internal::GetSignalStackTrace(
+      failure_stack, kMaxFrames, ucontext);
+
+  char header[128];
+  char* p = AppendString(header, "*** ");
+  p = AppendString(p, FailureSignalToString(signo));
+  p = AppendString(p, " received at time=");
+  p = AppendDecimal(p, time(nullptr));
+  p = AppendString(p, " (pid ");
+  p = AppendDecimal(p, getpid());
+  p = AppendString(p, ", tid ");
+  p = AppendDecimal(p, this_tid);
+  p = AppendString(p, ") ***\n");
+  *p = '\0';
+  Writer()(header);
+  debug_internal::DumpStackTrace(failure_stack, depth,
+                                 fsh_options.symbolize_stacktrace, Writer());
+
+#ifdef ABSL_HAVE_THREAD_DUMP
+  if (fsh_options.dump_all_threads) {
+    DumpOtherThreads(this_tid);
+  }
+#endif
+
+  if (fsh_options.writerfn != nullptr) {
+    fsh_options.writerfn(nullptr);
+  }
+
+  if (fsh_options.call_previous_handler) {
+    RaiseToPreviousHandler(signo);
+  } else {
+    RaiseToDefaultHandler(signo);
+  }
+}
+
+}  // namespace
+
+void InstallFailureSignalHandler(const FailureSignalHandlerOptions& options) {
+  fsh_options = options;
+  for (FailureSignalData& data : failure_signal_data) {
+    InstallOneFailureHandler(&data, AbslFailureSignalHandler);
+  }
+}
+
+}  // namespace absl
+
+#else  // _WIN32
+
+namespace absl {
+
+void InstallFailureSignalHandler(const FailureSignalHandlerOptions&) {}
+
+}  // namespace absl
+
+#endif  // _WIN32
@@ -0,0 +1,103 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: failure_signal_handler.h
+// -----------------------------------------------------------------------------
+//
+// This file configures the Abseil *failure signal handler* to capture and dump
+// useful debugging information (such as a stacktrace) upon program failure.
+//
+// To use the failure signal handler, call `absl::InstallFailureSignalHandler()`
+// very early in your program, usually in the first few lines of main():
+//
+// int main(int argc, char** argv) {
+//   absl::FailureSignalHandlerOptions options;
+//   absl::InstallFailureSignalHandler(options);
+//   DoSomethingInteresting();
+//   return 0;
+// }
+//
+// Any program that raises a fatal signal (such as `SIGSEGV`, `SIGILL`,
+// `SIGFPE`, `SIGABRT` or `SIGBUS`) will then print the signal, the faulting
+// pc and the stack of the failing thread to stderr before dying:
+//
+//   *** SIGSEGV received at time=1521072375 (pid 3184, tid 3184) ***
+//       @ 0x000055b05a7ec9c0  DoSomethingInteresting()
+//       @ 0x000055b05a7ec8a4  main
+//       @ 0x00007f30cc7acb97  __libc_start_main
+//
+// The handler only writes with async-signal-safe functions, so it can report
+// failures that leave the heap or other locks in an inconsistent state.
+
+#ifndef ABSL_DEBUGGING_FAILURE_SIGNAL_HANDLER_H_
+#define ABSL_DEBUGGING_FAILURE_SIGNAL_HANDLER_H_
+
+namespace absl {
+
+// FailureSignalHandlerOptions
+//
+// Struct for holding `absl::InstallFailureSignalHandler()` configuration
+// options.
+struct FailureSignalHandlerOptions {
+  // If true, try to symbolize the stacktrace emitted on failure.
+  bool symbolize_stacktrace = true;
+
+  // If true, try to run signal handlers on an alternate stack (if supported on
+  // the given platform). An alternate stack is useful for program crashes due
+  // to a stack overflow; by running on a alternate stack, the signal handler
+  // may run even when normal stack space has been exhausted. The alternate
+  // stack is only installed for the thread that installs the handler.
+  bool use_alternate_stack = true;
+
+  // If positive, indicates the number of seconds after which the failure
+  // signal handler is invoked to abort the program. Setting such an alarm is
+  // useful in cases where the failure signal handler itself may become hung
+  // or deadlocked.
+  int alarm_on_failure_secs = 3;
+
+  // If true, call the previously registered signal handler for the signal
+  // that was received (if one was registered) after the failure signal
+  // handler runs. Otherwise the signal's default action, usually termination,
+  // is taken.
+  bool call_previous_handler = false;
+
+  // If true, also dump the stack of every other thread in the process. Each
+  // thread is interrupted in turn with `SIGURG`, whose handler is replaced at
+  // that point, and copies its stack into a buffer that the failing thread
+  // prints. Threads that do not respond within 100ms, for example because
+  // they block `SIGURG`, are reported as such.
+  bool dump_all_threads = false;
+
+  // If non-null, indicates a pointer to a callback function that will be
+  // called upon failure, with a string argument containing failure data. This
+  // function may be used as a hook to write failure data to a secondary
+  // location, such as a log file, instead of stderr. It is called once per
+  // line, and then once with nullptr when the report is complete. This
+  // function must only use async-signal-safe operations.
+  void (*writerfn)(const char*) = nullptr;
+};
+
+// InstallFailureSignalHandler()
+//
+// Installs a signal handler for the common failure signals `SIGSEGV`,
+// `SIGILL`, `SIGFPE`, `SIGABRT` and `SIGBUS`. Before reporting, the handler
+// calls `absl::Mutex::InternalAttemptToUseMutexInFatalSignalHandler()` so that
+// the report has the best chance of completing even if the failure happened
+// inside the `Mutex` implementation. Does nothing on Windows.
+void InstallFailureSignalHandler(const FailureSignalHandlerOptions& options);
+
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_FAILURE_SIGNAL_HANDLER_H_
@@ -0,0 +1,124 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/failure_signal_handler.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+
+#if !defined(_WIN32) && GTEST_HAS_DEATH_TEST
+
+namespace {
+
+using FailureSignalHandlerDeathTest = ::testing::TestWithParam<int>;
+
+void InstallHandlerAndRaise(int signo) {
+  absl::InstallFailureSignalHandler(absl::FailureSignalHandlerOptions());
+  raise(signo);
+}
+
+TEST_P(FailureSignalHandlerDeathTest, ReportsSignal) {
+  const int signo = GetParam();
+  const std::string name = signo == SIGSEGV   ? "SIGSEGV"
+                           : signo == SIGILL  ? "SIGILL"
+                           : signo == SIGFPE  ? "SIGFPE"
+                           : signo == SIGABRT ? "SIGABRT"
+                                              : "SIGBUS";
+  EXPECT_DEATH(InstallHandlerAndRaise(signo),
+               "\\*\\*\\* " + name + " received at time=[0-9]+ \\(pid [0-9]+, "
+                                     "tid [0-9]+\\) \\*\\*\\*");
+}
+
+INSTANTIATE_TEST_CASE_P(AbslDeathTest, FailureSignalHandlerDeathTest,
+                        ::testing::Values(SIGSEGV, SIGILL, SIGFPE, SIGABRT,
+                                          SIGBUS));
+
+int* volatile null_pointer = nullptr;
+
+ABSL_ATTRIBUTE_NOINLINE void CrashInThisFunction() {
+  *null_pointer = 1;
+}
+
+void InstallHandlerAndCrash(const absl::FailureSignalHandlerOptions& options) {
+  absl::InstallFailureSignalHandler(options);
+  CrashInThisFunction();
+}
+
+TEST(FailureSignalHandlerDeathTest, SymbolizesFaultingFunction) {
+  EXPECT_DEATH(InstallHandlerAndCrash(absl::FailureSignalHandlerOptions()),
+               "SIGSEGV.*\n    @ 0x[0-9a-f]+  [^\n]*CrashInThisFunction");
+}
+
+TEST(FailureSignalHandlerDeathTest, WithoutSymbolization) {
+  absl::FailureSignalHandlerOptions options;
+  options.symbolize_stacktrace = false;
+  EXPECT_DEATH(InstallHandlerAndCrash(options),
+               "SIGSEGV.*\n    @ 0x[0-9a-f]+  \\(unknown\\)");
+}
+
+void PrefixedWriter(const char* data) {
+  if (data == nullptr) data = "end of report\n";
+  const char kPrefix[] = "custom: ";
+  ssize_t ignored = write(STDERR_FILENO, kPrefix, strlen(kPrefix));
+  ignored = write(STDERR_FILENO, data, strlen(data));
+  static_cast<void>(ignored);
+}
+
+TEST(FailureSignalHandlerDeathTest, WriterFn) {
+  absl::FailureSignalHandlerOptions options;
+  options.writerfn = PrefixedWriter;
+  EXPECT_DEATH(InstallHandlerAndCrash(options),
+               "custom: \\*\\*\\* SIGSEGV.*custom: end of report");
+}
+
+std::atomic<bool> spinning(false);
+
+ABSL_ATTRIBUTE_NOINLINE void SpinInThisFunction() {
+  spinning.store(true);
+  for (;;) {
+    spinning.load(std::memory_order_relaxed);
+  }
+}
+
+void CrashWhileAnotherThreadSpins() {
+  absl::FailureSignalHandlerOptions options;
+  options.dump_all_threads = true;
+  absl::InstallFailureSignalHandler(options);
+  std::thread spinner(SpinInThisFunction);
+  while (!spinning.load()) {
+  }
+  CrashInThisFunction();
+  spinner.join();
+}
+
+TEST(FailureSignalHandlerDeathTest, DumpsOtherThreads) {
+  // The spinner may be interrupted in a function that SpinInThisFunction()
+  // calls, such as std::atomic<bool>::load() when it is not inlined.
+  EXPECT_DEATH(CrashWhileAnotherThreadSpins(),
+               "CrashInThisFunction.*\nThread [0-9]+:\n"
+               "(    @ [^\n]*\n)*"
+               "    @ 0x[0-9a-f]+  [^\n]*SpinInThisFunction");
+}
+
+}  // namespace
+
+#endif  // !defined(_WIN32) && GTEST_HAS_DEATH_TEST
@@ -25,19 +25,38 @@ namespace debug_internal {
 // On platforms other than Linux, just return true.
 bool AddressIsReadable(const void* /* addr */) { return true; }
 
+void AddressesAreReadable(const void* const* /* addrs */, int n,
+                          bool* readable) {
+  for (int i = 0; i < n; ++i) readable[i] = true;
+}
+
+bool EnableAddressIsReadableCache() { return false; }
+
+bool GetMappingContaining(const void* /* addr */, uintptr_t* /* start */,
+                          uintptr_t* /* end */) {
+  return false;
+}
+
 }  // namespace debug_internal
 }  // namespace absl
 
 #else
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
 #include <cstdint>
+#include <cstring>
 
+#include "absl/base/internal/malloc_hook.h"
 #include "absl/base/internal/raw_logging.h"
+#include "absl/base/internal/spinlock.h"
+#include "absl/base/thread_annotations.h"
 
 namespace absl {
 namespace debug_internal {
@@ -58,13 +77,11 @@ static void Unpack(uint64_t x, int *pid, int *read_fd, int *write_fd) {
   *write_fd = x & 0xffffff;
 }
 
-// Return whether the byte at *addr is readable, without faulting.
-// Save and restores errno.   Returns true on systems where
-// unimplemented.
+// Return whether the byte at *addr is readable, without faulting, by
+// writing it to a pipe. Clobbers errno.
 // This is a namespace-scoped variable for correct zero-initialization.
 static std::atomic<uint64_t> pid_and_fds;  // initially 0, an invalid pid.
-bool AddressIsReadable(const void *addr) {
-  int save_errno = errno;
+static bool ProbeWithPipe(const void *addr) {
   // We test whether a byte is readable by using write().  Normally, this would
   // be done via a cached file descriptor to /dev/null, but linux fails to
   // check whether the byte is readable when the destination is /dev/null, so
@@ -123,10 +140,378 @@ bool AddressIsReadable(const void *addr) {
                                           std::memory_order_relaxed);
     }
   } while (errno == EBADF);
-  errno = save_errno;
   return bytes_written == 1;
 }
 
+
+// Parses a hexadecimal number at *p, and advances *p past it.
+static uintptr_t ParseHex(const char **p, const char *end) {
+  uintptr_t value = 0;
+  for (; *p < end; ++*p) {
+    const char c = **p;
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else {
+      break;
+    }
+    value = (value << 4) | digit;
+  }
+  return value;
+}
+
+// Calls fn(line, end) for the start of each line [line, end) of
+// /proc/self/maps until it returns false, using only async-signal-safe calls.
+// Only the start of each line matters, so long lines are cut short.
+template <typename LineFn>
+static void ForEachMapsLine(LineFn fn) {
+  int fd;
+  do {
+    fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) return;
+  char buffer[1024];
+  size_t used = 0;
+  bool skipping = false;  // Discarding the rest of a long line.
+  for (;;) {
+    const ssize_t n = read(fd, buffer + used, sizeof(buffer) - used);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    used += n;
+    const char *line = buffer;
+    const char *const end = buffer + used;
+    while (const char *newline = static_cast<const char *>(
+               memchr(line, '\n', end - line))) {
+      if (!skipping && !fn(line, newline)) {
+        close(fd);
+        return;
+      }
+      skipping = false;
+      line = newline + 1;
+    }
+    if (line == buffer) {  // No newline in a full buffer.
+      if (!skipping && !fn(line, end)) {
+        close(fd);
+        return;
+      }
+      skipping = true;
+      used = 0;
+    } else {
+      used = end - line;
+      memmove(buffer, line, used);
+    }
+  }
+  close(fd);
+}
+
+bool GetMappingContaining(const void *addr, uintptr_t *start,
+                          uintptr_t *end) {
+  const int save_errno = errno;
+  const uintptr_t addr_u = reinterpret_cast<uintptr_t>(addr);
+  bool found = false;
+  ForEachMapsLine([&](const char *line, const char *line_end) {
+    const char *p = line;
+    const uintptr_t lo = ParseHex(&p, line_end);
+    if (p == line_end || *p++ != '-') return true;
+    const uintptr_t hi = ParseHex(&p, line_end);
+    if (p == line_end || *p++ != ' ' || p == line_end) return true;
+    if (addr_u < lo) return false;  // Lines are sorted by address.
+    if (addr_u >= hi) return true;
+    found = *p == 'r';
+    *start = lo;
+    *end = hi;
+    return false;
+  });
+  errno = save_errno;
+  return found;
+}
+
+// process_vm_readv() copies from many addresses in one system call, stopping
+// at the first one that can't be read. It may be missing from the kernel or
+// forbidden by a sandbox, in which case ProbeWithPipe() is used.
+#ifdef SYS_process_vm_readv
+static std::atomic<bool> vm_readv_unavailable(false);
+#endif
+
+// Sets readable[i] for each i in [0, n) by probing with system calls.
+// Clobbers errno.
+static void Probe(const void *const *addrs, int n, bool *readable) {
+  int i = 0;
+#ifdef SYS_process_vm_readv
+  static constexpr int kBatch = 64;
+  const pid_t pid = getpid();
+  while (i < n && !vm_readv_unavailable.load(std::memory_order_relaxed)) {
+    const int batch = std::min(n - i, kBatch);
+    char bytes[kBatch];
+    struct iovec local = {bytes, static_cast<size_t>(batch)};
+    struct iovec remote[kBatch];
+    for (int j = 0; j < batch; ++j) {
+      remote[j].iov_base = const_cast<void *>(addrs[i + j]);
+      remote[j].iov_len = 1;
+    }
+    // Use syscall() so that ASAN and other checkers don't complain about
+    // accesses to arbitrary memory.
+    const long copied =  // NOLINT(runtime/int)
+        syscall(SYS_process_vm_readv, pid, &local, 1, remote, batch, 0);
+    if (copied < 0 && errno != EFAULT) {
+      if (errno != EINTR) {
+        vm_readv_unavailable.store(true, std::memory_order_relaxed);
+      }
+      continue;
+    }
+    // The first `copied` addresses are readable, and the next one isn't.
+    const int good = copied < 0 ? 0 : static_cast<int>(copied);
+    for (int j = 0; j < good; ++j) readable[i + j] = true;
+    i += good;
+    if (good < batch) readable[i++] = false;
+  }
+#endif
+  for (; i < n; ++i) {
+    readable[i] = ProbeWithPipe(addrs[i]);
+  }
+}
+
+#ifdef ABSL_HAVE_MMAP_HOOKS
+
+// The table of mappings used once EnableAddressIsReadableCache() is called.
+// Readers only try to take table_lock, and probe instead if it is held, so
+// that a signal handler never waits for the thread it interrupted.
+//
+// Reading /proc/self/maps costs more than a few probes, so the table is read
+// again only when it is needed: when an address is not covered and mappings
+// have been added since the last read, or when enough ranges have been
+// unmapped that recent_unmaps below might no longer hold them all.
+namespace {
+struct Mapping {
+  uintptr_t start;
+  uintptr_t end;
+  bool readable;
+};
+}  // namespace
+
+static constexpr int kMaxMappings = 1024;
+static std::atomic<bool> cache_enabled(false);
+// Whether mappings may have been added since the table was read.
+static std::atomic<bool> table_stale(true);
+static base_internal::SpinLock table_lock(base_internal::kLinkerInitialized);
+// Sorted by address; adjacent mappings with the same readability are merged.
+static Mapping mappings[kMaxMappings] GUARDED_BY(table_lock);
+static int num_mappings GUARDED_BY(table_lock) = 0;
+// The value of next_unmap when the table was read.
+static uint32_t unmaps_at_refresh GUARDED_BY(table_lock) = 0;
+
+// The munmap hook runs before the mapping goes away, so a refresh that
+// starts at that moment still sees it. Lookups therefore ignore the table
+// for the most recently unmapped ranges, each guarded by a sequence lock.
+namespace {
+struct Unmapped {
+  std::atomic<uint32_t> version;  // Odd while being written.
+  std::atomic<uintptr_t> start;
+  std::atomic<uintptr_t> end;
+};
+}  // namespace
+
+static constexpr int kRecentUnmaps = 64;
+static Unmapped recent_unmaps[kRecentUnmaps];
+static std::atomic<uint32_t> next_unmap(0);
+
+static void NoteUnmap(const void *start, size_t size) {
+  Unmapped &slot =
+      recent_unmaps[next_unmap.fetch_add(1, std::memory_order_relaxed) %
+                    kRecentUnmaps];
+  const uint32_t version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const uintptr_t start_u = reinterpret_cast<uintptr_t>(start);
+  slot.start.store(start_u, std::memory_order_relaxed);
+  slot.end.store(start_u + size, std::memory_order_relaxed);
+  slot.version.store(version + 2, std::memory_order_release);
+}
+
+// Returns whether `addr` may be in a range that was unmapped recently.
+static bool MaybeRecentlyUnmapped(uintptr_t addr) {
+  for (Unmapped &slot : recent_unmaps) {
+    const uint32_t version = slot.version.load(std::memory_order_acquire);
+    const uintptr_t start = slot.start.load(std::memory_order_relaxed);
+    const uintptr_t end = slot.end.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((version & 1) != 0 ||
+        version != slot.version.load(std::memory_order_relaxed) ||
+        (start <= addr && addr < end)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void PreMmapHook(const void *start, size_t size, int, int flags, int,
+                        off_t) {
+  if (flags & MAP_FIXED) NoteUnmap(start, size);  // Replaces what was there.
+}
+
+static void MmapHook(const void *, const void *, size_t, int, int, int,
+                     off_t) {
+  table_stale.store(true, std::memory_order_release);
+}
+
+static void MunmapHook(const void *start, size_t size) {
+  NoteUnmap(start, size);
+}
+
+static void MremapHook(const void *, const void *old_addr, size_t old_size,
+                       size_t, int, const void *) {
+  NoteUnmap(old_addr, old_size);
+  table_stale.store(true, std::memory_order_release);
+}
+
+// Adds the mapping described by the /proc/self/maps line [line, end), e.g.
+// "7f0000001000-7f0000002000 r-xp ...". Returns false if the table is full.
+static bool AddMapping(const char *line, const char *end)
+    EXCLUSIVE_LOCKS_REQUIRED(table_lock) {
+  const char *p = line;
+  const uintptr_t start = ParseHex(&p, end);
+  if (p == end || *p++ != '-') return true;
+  const uintptr_t stop = ParseHex(&p, end);
+  if (p == end || *p++ != ' ' || p == end) return true;
+  const bool readable = *p == 'r';
+  if (num_mappings > 0) {
+    Mapping &last = mappings[num_mappings - 1];
+    if (last.end == start && last.readable == readable) {
+      last.end = stop;
+      return true;
+    }
+  }
+  if (num_mappings == kMaxMappings) return false;
+  mappings[num_mappings++] = {start, stop, readable};
+  return true;
+}
+
+// Reads /proc/self/maps into the table, using only async-signal-safe calls.
+// If the table fills, the addresses beyond it are left unknown.
+static void RefreshTable() EXCLUSIVE_LOCKS_REQUIRED(table_lock) {
+  table_stale.store(false, std::memory_order_relaxed);
+  unmaps_at_refresh = next_unmap.load(std::memory_order_acquire);
+  num_mappings = 0;
+  ForEachMapsLine(AddMapping);
+}
+
+enum Answer { kUnreadable, kReadable, kUnknown };
+
+static Answer LookupTable(const void *addr)
+    EXCLUSIVE_LOCKS_REQUIRED(table_lock) {
+  const uintptr_t addr_u = reinterpret_cast<uintptr_t>(addr);
+  const Mapping *const begin = mappings;
+  const Mapping *const end = begin + num_mappings;
+  const Mapping *it = std::upper_bound(
+      begin, end, addr_u,
+      [](uintptr_t a, const Mapping &m) { return a < m.end; });
+  if (it == end || addr_u < it->start) return kUnknown;
+  if (!it->readable) return kUnreadable;
+  return MaybeRecentlyUnmapped(addr_u) ? kUnknown : kReadable;
+}
+
+bool EnableAddressIsReadableCache() {
+  base_internal::SpinLockHolder l(&table_lock);
+  if (!cache_enabled.load(std::memory_order_relaxed)) {
+    if (!base_internal::MallocHook::AddPreMmapHook(&PreMmapHook) ||
+        !base_internal::MallocHook::AddMmapHook(&MmapHook) ||
+        !base_internal::MallocHook::AddMunmapHook(&MunmapHook) ||
+        !base_internal::MallocHook::AddMremapHook(&MremapHook)) {
+      base_internal::MallocHook::RemovePreMmapHook(&PreMmapHook);
+      base_internal::MallocHook::RemoveMmapHook(&MmapHook);
+      base_internal::MallocHook::RemoveMunmapHook(&MunmapHook);
+      return false;
+    }
+    cache_enabled.store(true, std::memory_order_release);
+  }
+  return true;
+}
+
+// Answers from the table where it can, and returns the number of addresses it
+// could not answer, whose indexes are stored in `unknown`.
+static int AnswerFromTable(const void *const *addrs, int n, bool *readable,
+                           int *unknown) {
+  if (!cache_enabled.load(std::memory_order_acquire) || !table_lock.TryLock()) {
+    for (int i = 0; i < n; ++i) unknown[i] = i;
+    return n;
+  }
+  if (next_unmap.load(std::memory_order_acquire) - unmaps_at_refresh >=
+      kRecentUnmaps / 2) {
+    RefreshTable();
+  }
+  int num_unknown = 0;
+  for (int i = 0; i < n; ++i) {
+    const Answer answer = LookupTable(addrs[i]);
+    if (answer == kUnknown) {
+      unknown[num_unknown++] = i;
+    } else {
+      readable[i] = answer == kReadable;
+    }
+  }
+  if (num_unknown > 0 && table_stale.load(std::memory_order_acquire)) {
+    RefreshTable();
+    int still_unknown = 0;
+    for (int j = 0; j < num_unknown; ++j) {
+      const int i = unknown[j];
+      const Answer answer = LookupTable(addrs[i]);
+      if (answer == kUnknown) {
+        unknown[still_unknown++] = i;
+      } else {
+        readable[i] = answer == kReadable;
+      }
+    }
+    num_unknown = still_unknown;
+  }
+  table_lock.Unlock();
+  return num_unknown;
+}
+
+#else  // ABSL_HAVE_MMAP_HOOKS
+
+bool EnableAddressIsReadableCache() { return false; }
+
+static int AnswerFromTable(const void *const *, int n, bool *, int *unknown) {
+  for (int i = 0; i < n; ++i) unknown[i] = i;
+  return n;
+}
+
+#endif  // ABSL_HAVE_MMAP_HOOKS
+
+void AddressesAreReadable(const void *const *addrs, int n, bool *readable) {
+  const int save_errno = errno;
+  static constexpr int kChunk = 64;
+  while (n > 0) {
+    const int chunk = std::min(n, kChunk);
+    int unknown[kChunk];
+    const int num_unknown = AnswerFromTable(addrs, chunk, readable, unknown);
+    if (num_unknown == chunk) {
+      Probe(addrs, chunk, readable);
+    } else {
+      const void *unknown_addrs[kChunk];
+      bool unknown_readable[kChunk];
+      for (int i = 0; i < num_unknown; ++i) {
+        unknown_addrs[i] = addrs[unknown[i]];
+      }
+      Probe(unknown_addrs, num_unknown, unknown_readable);
+      for (int i = 0; i < num_unknown; ++i) {
+        readable[unknown[i]] = unknown_readable[i];
+      }
+    }
+    addrs += chunk;
+    readable += chunk;
+    n -= chunk;
+  }
+  errno = save_errno;
+}
+
+bool AddressIsReadable(const void *addr) {
+  bool readable;
+  AddressesAreReadable(&addr, 1, &readable);
+  return readable;
+}
+
 }  // namespace debug_internal
 }  // namespace absl
 
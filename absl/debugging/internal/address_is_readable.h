@@ -16,6 +16,8 @@
 #ifndef ABSL_DEBUGGING_INTERNAL_ADDRESS_IS_READABLE_H_
 #define ABSL_DEBUGGING_INTERNAL_ADDRESS_IS_READABLE_H_
 
+#include <cstdint>
+
 namespace absl {
 namespace debug_internal {
 
@@ -23,6 +25,33 @@ namespace debug_internal {
 // Save and restores errno.
 bool AddressIsReadable(const void *addr);
 
+// Sets readable[i] to whether the byte at *addrs[i] is readable, without
+// faulting, for each i in [0, n). Where supported, readable addresses are
+// checked many at a time, so this makes fewer system calls than n calls to
+// AddressIsReadable(). Saves and restores errno.
+void AddressesAreReadable(const void *const *addrs, int n, bool *readable);
+
+// Makes AddressIsReadable() and AddressesAreReadable() answer from a table of
+// the process's mappings, read from /proc/self/maps, and make a system call
+// only for addresses the table does not cover. The table is read again after
+// mappings change through mmap(), munmap() or mremap(). Returns false, and
+// changes nothing, if those calls can't be observed on this platform.
+//
+// Mappings that change without going through those functions are not noticed
+// until the table is next read; among them are mprotect() calls and the C
+// library's own mappings for thread stacks and large malloc() blocks. Only
+// enable the table in processes where such mappings don't lose read access
+// while the table may be consulted, e.g. ones that allocate with an allocator
+// built on mmap().
+bool EnableAddressIsReadableCache();
+
+// If *addr is in a readable mapping, stores the mapping's bounds as
+// [*start, *end) and returns true. Reads /proc/self/maps with only
+// async-signal-safe calls and no allocation, so it may be used from signal
+// handlers and malloc hooks, but costs several system calls. Returns false
+// where /proc/self/maps is unavailable. Saves and restores errno.
+bool GetMappingContaining(const void *addr, uintptr_t *start, uintptr_t *end);
+
 }  // namespace debug_internal
 }  // namespace absl
 
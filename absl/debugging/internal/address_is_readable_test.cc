@@ -0,0 +1,157 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/address_is_readable.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+int global_variable = 1;
+
+// Pages with different access, and the addresses to check in them.
+class Mappings {
+ public:
+  Mappings() : page_size_(getpagesize()) {
+    char* pages = static_cast<char*>(mmap(nullptr, 3 * page_size_, PROT_READ,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    EXPECT_NE(MAP_FAILED, pages);
+    readable_ = pages;
+    protected_ = pages + page_size_;
+    unmapped_ = pages + 2 * page_size_;
+    EXPECT_EQ(0, mprotect(protected_, page_size_, PROT_NONE));
+    EXPECT_EQ(0, munmap(unmapped_, page_size_));
+  }
+  ~Mappings() { munmap(readable_, 2 * page_size_); }
+
+  std::vector<const void*> Addresses() const {
+    return {&global_variable, &page_size_, readable_,
+            readable_ + page_size_ - 1, protected_, unmapped_, nullptr};
+  }
+  std::vector<bool> Expected() const {
+    return {true, true, true, true, false, false, false};
+  }
+
+ private:
+  const size_t page_size_;
+  char* readable_;
+  char* protected_;
+  char* unmapped_;
+};
+
+std::vector<bool> CheckOneByOne(const std::vector<const void*>& addrs) {
+  std::vector<bool> readable;
+  for (const void* addr : addrs) readable.push_back(AddressIsReadable(addr));
+  return readable;
+}
+
+std::vector<bool> CheckAll(const std::vector<const void*>& addrs) {
+  std::unique_ptr<bool[]> readable(new bool[addrs.size()]);
+  AddressesAreReadable(addrs.data(), addrs.size(), readable.get());
+  return std::vector<bool>(readable.get(), readable.get() + addrs.size());
+}
+
+TEST(AddressIsReadable, ProbesMappings) {
+  Mappings mappings;
+  errno = 1234;
+  EXPECT_EQ(mappings.Expected(), CheckOneByOne(mappings.Addresses()));
+  EXPECT_EQ(1234, errno);
+}
+
+TEST(AddressIsReadable, Batch) {
+  Mappings mappings;
+  // Enough addresses to take several batches, unreadable ones included.
+  std::vector<const void*> addrs;
+  std::vector<bool> expected;
+  for (int i = 0; i < 100; ++i) {
+    for (const void* addr : mappings.Addresses()) addrs.push_back(addr);
+    for (bool readable : mappings.Expected()) expected.push_back(readable);
+  }
+  errno = 1234;
+  EXPECT_EQ(expected, CheckAll(addrs));
+  EXPECT_EQ(1234, errno);
+}
+
+TEST(AddressIsReadable, Cache) {
+  if (!EnableAddressIsReadableCache()) return;
+  {
+    Mappings mappings;
+    EXPECT_EQ(mappings.Expected(), CheckOneByOne(mappings.Addresses()));
+    EXPECT_EQ(mappings.Expected(), CheckAll(mappings.Addresses()));
+  }
+  // Pages that the table has seen stop being readable once unmapped, however
+  // many there are.
+  const size_t page_size = getpagesize();
+  for (int i = 0; i < 100; ++i) {
+    void* page = mmap(nullptr, page_size, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, page);
+    EXPECT_TRUE(AddressIsReadable(page));
+    ASSERT_EQ(0, munmap(page, page_size));
+    EXPECT_FALSE(AddressIsReadable(page));
+  }
+  // And so does one that was replaced.
+  void* page = mmap(nullptr, page_size, PROT_READ,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, page);
+  EXPECT_TRUE(AddressIsReadable(page));
+  ASSERT_EQ(page, mmap(page, page_size, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0));
+  EXPECT_FALSE(AddressIsReadable(page));
+  munmap(page, page_size);
+}
+
+TEST(GetMappingContaining, FindsReadableMappings) {
+  const size_t page_size = getpagesize();
+  char* pages = static_cast<char*>(mmap(nullptr, 2 * page_size, PROT_READ,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(MAP_FAILED, pages);
+  ASSERT_EQ(0, mprotect(pages + page_size, page_size, PROT_NONE));
+  const uintptr_t pages_u = reinterpret_cast<uintptr_t>(pages);
+  uintptr_t start;
+  uintptr_t end;
+  errno = 1234;
+  ASSERT_TRUE(GetMappingContaining(pages + 1, &start, &end));
+  // The kernel may merge the first page with a mapping below it.
+  EXPECT_LE(start, pages_u);
+  EXPECT_EQ(pages_u + page_size, end);
+  EXPECT_FALSE(GetMappingContaining(pages + page_size, &start, &end));
+
+  int local = 0;
+  const uintptr_t local_u = reinterpret_cast<uintptr_t>(&local);
+  ASSERT_TRUE(GetMappingContaining(&local, &start, &end));
+  EXPECT_LE(start, local_u);
+  EXPECT_LT(local_u, end);
+  EXPECT_FALSE(GetMappingContaining(nullptr, &start, &end));
+  EXPECT_EQ(1234, errno);
+  munmap(pages, 2 * page_size);
+}
+
+}  // namespace
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // defined(__linux__) && !defined(__ANDROID__)
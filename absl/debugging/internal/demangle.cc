@@ -0,0 +1,1472 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// For reference check out:
+// https://itanium-cxx-abi.github.io/cxx-abi/abi.html#mangling
+//
+// Note that we only have partial C++11 support yet.
+//
+// This is a recursive-descent parser over the grammar in the reference. Each
+// Parse*() member consumes one production and returns true, or restores the
+// parser state and returns false. Nothing here allocates memory, takes a lock
+// or calls into libc beyond trivial character handling, so Demangle() is safe
+// to call from a signal handler.
+
+#include "absl/debugging/internal/demangle.h"
+
+#include <cstdint>
+
+namespace absl {
+namespace debug_internal {
+
+namespace {
+
+struct AbbrevPair {
+  const char* abbrev;
+  const char* real_name;
+  // Number of operands, for operators in expressions.
+  int arity;
+};
+
+// List of operators from Itanium C++ ABI.
+const AbbrevPair kOperatorList[] = {
+    {"nw", "new", 0},      {"na", "new[]", 0},    {"dl", "delete", 1},
+    {"da", "delete[]", 1}, {"ps", "+", 1},        {"ng", "-", 1},
+    {"ad", "&", 1},        {"de", "*", 1},        {"co", "~", 1},
+    {"pl", "+", 2},        {"mi", "-", 2},        {"ml", "*", 2},
+    {"dv", "/", 2},        {"rm", "%", 2},        {"an", "&", 2},
+    {"or", "|", 2},        {"eo", "^", 2},        {"aS", "=", 2},
+    {"pL", "+=", 2},       {"mI", "-=", 2},       {"mL", "*=", 2},
+    {"dV", "/=", 2},       {"rM", "%=", 2},       {"aN", "&=", 2},
+    {"oR", "|=", 2},       {"eO", "^=", 2},       {"ls", "<<", 2},
+    {"rs", ">>", 2},       {"lS", "<<=", 2},      {"rS", ">>=", 2},
+    {"ss", "<=>", 2},      {"eq", "==", 2},       {"ne", "!=", 2},
+    {"lt", "<", 2},        {"gt", ">", 2},        {"le", "<=", 2},
+    {"ge", ">=", 2},       {"nt", "!", 1},        {"aa", "&&", 2},
+    {"oo", "||", 2},       {"pp", "++", 1},       {"mm", "--", 1},
+    {"cm", ",", 2},        {"pm", "->*", 2},      {"pt", "->", 0},
+    {"cl", "()", 0},       {"ix", "[]", 2},       {"qu", "?", 3},
+    {"sz", "sizeof", 1},   {"az", "alignof", 1},  {nullptr, nullptr, 0},
+};
+
+// List of builtin types from Itanium C++ ABI.
+const AbbrevPair kBuiltinTypeList[] = {
+    {"v", "void", 0},
+    {"w", "wchar_t", 0},
+    {"b", "bool", 0},
+    {"c", "char", 0},
+    {"a", "signed char", 0},
+    {"h", "unsigned char", 0},
+    {"s", "short", 0},
+    {"t", "unsigned short", 0},
+    {"i", "int", 0},
+    {"j", "unsigned int", 0},
+    {"l", "long", 0},
+    {"m", "unsigned long", 0},
+    {"x", "long long", 0},
+    {"y", "unsigned long long", 0},
+    {"n", "__int128", 0},
+    {"o", "unsigned __int128", 0},
+    {"f", "float", 0},
+    {"d", "double", 0},
+    {"e", "long double", 0},
+    {"g", "__float128", 0},
+    {"z", "...", 0},
+    {"Dd", "decimal64", 0},
+    {"De", "decimal128", 0},
+    {"Df", "decimal32", 0},
+    {"Dh", "half", 0},
+    {"Di", "char32_t", 0},
+    {"Ds", "char16_t", 0},
+    {"Du", "char8_t", 0},
+    {"Da", "auto", 0},
+    {"Dc", "decltype(auto)", 0},
+    {"Dn", "decltype(nullptr)", 0},
+    {nullptr, nullptr, 0},
+};
+
+// List of substitutions Itanium C++ ABI.
+struct SubstitutionAbbrev {
+  const char* abbrev;
+  const char* real_name;
+  // The name of the class's constructors, or null for a namespace.
+  const char* ctor_name;
+};
+
+const SubstitutionAbbrev kSubstitutionList[] = {
+    {"St", "std", nullptr},
+    {"Sa", "std::allocator", "allocator"},
+    {"Sb", "std::basic_string", "basic_string"},
+    {"Ss", "std::string", "basic_string"},
+    {"Si", "std::istream", "basic_istream"},
+    {"So", "std::ostream", "basic_ostream"},
+    {"Sd", "std::iostream", "basic_iostream"},
+    {nullptr, nullptr, nullptr},
+};
+
+// Limits that keep malicious or corrupt input from exhausting the stack or
+// taking quadratic time.
+constexpr int kMaxDepth = 256;
+constexpr int kMaxSteps = 1 << 17;
+
+// Substitution candidates past this many are treated as unprintable.
+constexpr int kMaxSubstitutions = 256;
+
+bool IsLower(char c) { return c >= 'a' && c <= 'z'; }
+bool IsUpper(char c) { return c >= 'A' && c <= 'Z'; }
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+bool IsAlpha(char c) { return IsLower(c) || IsUpper(c); }
+bool IsIdentifierChar(char c) { return IsAlpha(c) || IsDigit(c) || c == '_'; }
+
+// Returns true if `str` starts with `prefix`.
+bool StartsWith(const char* str, const char* prefix) {
+  for (; *prefix != '\0'; ++str, ++prefix) {
+    if (*str != *prefix) return false;
+  }
+  return true;
+}
+
+// Returns the length of `str`, which must be NUL-terminated.
+int StrLen(const char* str) {
+  int len = 0;
+  while (str[len] != '\0') ++len;
+  return len;
+}
+
+// The parts of the parser state that are rolled back when a production fails
+// to match.
+struct ParseState {
+  const char* mangled;  // The next character to parse.
+  int out_len;          // The length of the output so far.
+  int num_subs;         // The number of substitution candidates so far.
+  // The most recent source name, used to print constructors and destructors.
+  const char* prev_name;
+  int prev_name_length;
+  bool append;      // Whether names are being printed.
+  bool overflowed;  // Whether the output did not fit.
+  // Whether the most recent <name> was a const-qualified nested name, making
+  // its function a const member function.
+  bool const_name;
+};
+
+// A substitution candidate: the printed text of an earlier component, as a
+// range of the output, or [-1, -1) if it was not printed.
+struct Substitution {
+  int begin;
+  int end;
+};
+
+class Demangler {
+ public:
+  Demangler(const char* mangled, char* out, int out_size)
+      : out_(out), out_size_(out_size), depth_(0), steps_(0) {
+    state_.mangled = mangled;
+    state_.out_len = 0;
+    state_.num_subs = 0;
+    state_.prev_name = nullptr;
+    state_.prev_name_length = 0;
+    state_.append = true;
+    state_.overflowed = false;
+    state_.const_name = false;
+  }
+
+  Demangler(const Demangler&) = delete;
+  Demangler& operator=(const Demangler&) = delete;
+
+  bool Run();
+
+ private:
+  // Counts nested parse calls, failing when the input is too complex.
+  class ComplexityGuard {
+   public:
+    explicit ComplexityGuard(Demangler* d) : d_(d) {
+      ++d_->depth_;
+      ++d_->steps_;
+    }
+    ~ComplexityGuard() { --d_->depth_; }
+    bool TooComplex() const {
+      return d_->depth_ > kMaxDepth || d_->steps_ > kMaxSteps;
+    }
+
+   private:
+    Demangler* d_;
+  };
+
+  // Input helpers.
+  char Peek(int offset = 0) const { return state_.mangled[offset]; }
+  bool Consume(char c);
+  bool Consume(const char* two_chars);
+  bool Fail(const ParseState& saved) {
+    state_ = saved;
+    return false;
+  }
+
+  // Output helpers. These are no-ops while printing is disabled.
+  void Append(const char* str, int length);
+  void Append(const char* str) { Append(str, StrLen(str)); }
+  void AppendNumber(int n);
+  void AddSubstitution(int begin);
+  void AppendSubstitution(int index);
+
+  bool ParseMangledName();
+  bool ParseEncoding();
+  bool ParseName();
+  bool ParseUnscopedName();
+  bool ParseNestedName();
+  bool ParseUnqualifiedName();
+  bool ParseSourceName();
+  bool ParseLocalSourceName();
+  bool ParseUnnamedTypeName();
+  bool ParseAbiTags();
+  bool ParseNumber(int* number_out);
+  bool ParseSeqId(int* id_out);
+  bool ParseIdentifier(int length);
+  bool ParseOperatorName();
+  bool ParseSpecialName();
+  bool ParseCallOffset();
+  bool ParseCtorDtorName();
+  bool ParseDecltype();
+  bool ParseType();
+  bool ParseBuiltinType();
+  bool ParseFunctionType();
+  bool ParseBareFunctionType();
+  bool ParseArrayType();
+  bool ParsePointerToMemberType();
+  bool ParseTemplateParam();
+  bool ParseTemplateArgs();
+  bool ParseTemplateArg();
+  bool ParseUnresolvedType();
+  bool ParseSimpleId();
+  bool ParseBaseUnresolvedName();
+  bool ParseUnresolvedName();
+  bool ParseExpression();
+  bool ParseExprPrimary();
+  bool ParseLocalName();
+  bool ParseDiscriminator();
+  bool ParseSubstitution();
+
+  // Runs `parse` with printing disabled.
+  template <typename F>
+  bool Silently(F parse) {
+    const bool append = state_.append;
+    state_.append = false;
+    const bool result = (this->*parse)();
+    state_.append = append;
+    return result;
+  }
+
+  ParseState state_;
+  char* const out_;
+  const int out_size_;
+  int depth_;
+  int steps_;
+  Substitution subs_[kMaxSubstitutions];
+};
+
+bool Demangler::Consume(char c) {
+  if (Peek() != c) return false;
+  ++state_.mangled;
+  return true;
+}
+
+bool Demangler::Consume(const char* two_chars) {
+  if (Peek() != two_chars[0] || Peek(1) != two_chars[1]) return false;
+  state_.mangled += 2;
+  return true;
+}
+
+void Demangler::Append(const char* str, int length) {
+  if (!state_.append || state_.overflowed) return;
+  if (state_.out_len + length >= out_size_) {
+    state_.overflowed = true;
+    return;
+  }
+  for (int i = 0; i < length; ++i) out_[state_.out_len + i] = str[i];
+  state_.out_len += length;
+}
+
+void Demangler::AppendNumber(int n) {
+  char buf[16];
+  int i = sizeof(buf);
+  do {
+    buf[--i] = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  Append(buf + i, static_cast<int>(sizeof(buf)) - i);
+}
+
+void Demangler::AddSubstitution(int begin) {
+  if (state_.num_subs < kMaxSubstitutions) {
+    Substitution& sub = subs_[state_.num_subs];
+    if (state_.append && !state_.overflowed) {
+      sub.begin = begin;
+      sub.end = state_.out_len;
+    } else {
+      sub.begin = sub.end = -1;
+    }
+  }
+  ++state_.num_subs;
+}
+
+void Demangler::AppendSubstitution(int index) {
+  if (!state_.append) return;
+  if (index >= state_.num_subs || index >= kMaxSubstitutions ||
+      subs_[index].begin < 0) {
+    Append("?");
+    return;
+  }
+  // The candidate lies entirely before the current end of the output, so the
+  // copy never reads what it writes.
+  const Substitution sub = subs_[index];
+  Append(out_ + sub.begin, sub.end - sub.begin);
+}
+
+bool Demangler::Run() {
+  if (!ParseMangledName() || Peek() != '\0' || state_.overflowed) {
+    return false;
+  }
+  out_[state_.out_len] = '\0';
+  return true;
+}
+
+// <mangled-name> ::= _Z <encoding> [<clone-suffix>]*
+// <clone-suffix> ::= . <identifier chars>+
+//
+// Clone suffixes are added by optimizations such as ".isra.0",
+// ".constprop.1", ".part.2" or ".cold"; they are not printed.
+bool Demangler::ParseMangledName() {
+  if (!Consume("_Z") || !ParseEncoding()) return false;
+  while (Peek() == '.' && IsIdentifierChar(Peek(1))) {
+    ++state_.mangled;
+    while (IsIdentifierChar(Peek())) ++state_.mangled;
+  }
+  return true;
+}
+
+// <encoding> ::= <(function) name> <bare-function-type>
+//            ::= <(data) name>
+//            ::= <special-name>
+bool Demangler::ParseEncoding() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (ParseSpecialName()) return true;
+
+  const ParseState saved = state_;
+  if (!ParseName()) return Fail(saved);
+  const bool is_const = state_.const_name;
+  const char c = Peek();
+  if (c == '\0' || c == 'E' || c == '.') return true;  // A data name.
+  if (!Silently(&Demangler::ParseBareFunctionType)) return Fail(saved);
+  Append("()");
+  if (is_const) Append(" const");
+  return true;
+}
+
+// <name> ::= <nested-name>
+//        ::= <unscoped-template-name> <template-args>
+//        ::= <unscoped-name>
+//        ::= <local-name>
+//        ::= <substitution> <template-args>
+// <unscoped-template-name> ::= <unscoped-name>
+//                          ::= <substitution>
+bool Demangler::ParseName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  // Both of these set const_name from the name that they end with.
+  if (ParseNestedName() || ParseLocalName()) return true;
+
+  const ParseState saved = state_;
+  const int begin = state_.out_len;
+  if (ParseUnscopedName()) {
+    if (Peek() == 'I') {
+      AddSubstitution(begin);
+      if (!ParseTemplateArgs()) return Fail(saved);
+    }
+    state_.const_name = false;
+    return true;
+  }
+  if (Peek() == 'S' && ParseSubstitution() && ParseTemplateArgs()) {
+    state_.const_name = false;
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <unscoped-name> ::= <unqualified-name>
+//                 ::= St <unqualified-name>
+bool Demangler::ParseUnscopedName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (ParseUnqualifiedName()) return true;
+  const ParseState saved = state_;
+  if (Consume("St")) {
+    Append("std::");
+    if (ParseUnqualifiedName()) return true;
+  }
+  return Fail(saved);
+}
+
+// <nested-name> ::= N [<CV-qualifiers>] [<ref-qualifier>] <prefix>
+//                   <unqualified-name> E
+//               ::= N [<CV-qualifiers>] [<ref-qualifier>]
+//                   <template-prefix> <template-args> E
+// <prefix> ::= <prefix> <unqualified-name>
+//          ::= <template-prefix> <template-args>
+//          ::= <template-param>
+//          ::= <decltype>
+//          ::= <substitution>
+//          ::= # empty
+bool Demangler::ParseNestedName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (!Consume('N')) return false;
+  bool is_const = false;
+  while (Peek() == 'r' || Peek() == 'V' || Peek() == 'K') {
+    if (Peek() == 'K') is_const = true;
+    ++state_.mangled;
+  }
+  if (Peek() == 'R' || Peek() == 'O') ++state_.mangled;
+
+  const int begin = state_.out_len;
+  int components = 0;
+  while (!Consume('E')) {
+    bool is_substitution = false;
+    if (components > 0 && Peek() == 'I') {
+      if (!ParseTemplateArgs()) return Fail(saved);
+    } else if (components == 0 && Peek() == 'S') {
+      if (!ParseSubstitution()) return Fail(saved);
+      is_substitution = true;
+    } else if (Peek() == 'T') {
+      if (components > 0) Append("::");
+      if (!ParseTemplateParam()) return Fail(saved);
+    } else if (Peek() == 'D' && (Peek(1) == 't' || Peek(1) == 'T')) {
+      if (components > 0) Append("::");
+      if (!ParseDecltype()) return Fail(saved);
+    } else {
+      if (components > 0) Append("::");
+      if (!ParseUnqualifiedName()) return Fail(saved);
+    }
+    ++components;
+    // Every proper prefix is a substitution candidate, except one that is
+    // itself a substitution.
+    if (!is_substitution && Peek() != 'E') AddSubstitution(begin);
+  }
+  if (components == 0) return Fail(saved);
+  // Set last, as names nested in template arguments overwrite it.
+  state_.const_name = is_const;
+  return true;
+}
+
+// <unqualified-name> ::= <operator-name> [<abi-tags>]
+//                    ::= <ctor-dtor-name> [<abi-tags>]
+//                    ::= <source-name> [<abi-tags>]
+//                    ::= <local-source-name> [<abi-tags>]
+//                    ::= <unnamed-type-name> [<abi-tags>]
+bool Demangler::ParseUnqualifiedName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (ParseOperatorName() || ParseCtorDtorName() || ParseSourceName() ||
+      ParseLocalSourceName() || ParseUnnamedTypeName()) {
+    return ParseAbiTags();
+  }
+  return false;
+}
+
+// <abi-tags> ::= <abi-tag> [<abi-tags>]
+// <abi-tag>  ::= B <source-name>
+bool Demangler::ParseAbiTags() {
+  const char* prev_name = state_.prev_name;
+  const int prev_name_length = state_.prev_name_length;
+  while (Consume('B')) {
+    Append("[abi:");
+    if (!ParseSourceName()) return false;
+    Append("]");
+  }
+  // Constructors are named after the class, not its tags.
+  state_.prev_name = prev_name;
+  state_.prev_name_length = prev_name_length;
+  return true;
+}
+
+// <source-name> ::= <positive length number> <identifier>
+bool Demangler::ParseSourceName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  int length = -1;
+  if (IsDigit(Peek()) && ParseNumber(&length) && length > 0 &&
+      ParseIdentifier(length)) {
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <local-source-name> ::= L <source-name> [<discriminator>]
+//
+// This is not in the Itanium C++ ABI, but GCC uses it for names with
+// internal linkage in some contexts.
+bool Demangler::ParseLocalSourceName() {
+  const ParseState saved = state_;
+  if (Consume('L') && ParseSourceName()) {
+    ParseDiscriminator();
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <unnamed-type-name> ::= Ut [<(nonnegative) number>] _
+//                     ::= <closure-type-name>
+// <closure-type-name> ::= Ul <lambda-sig> E [<(nonnegative) number>] _
+// <lambda-sig>        ::= <(parameter) type>+
+bool Demangler::ParseUnnamedTypeName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  int which = -1;
+  if (Consume("Ut")) {
+    if (IsDigit(Peek()) && !ParseNumber(&which)) return Fail(saved);
+    if (!Consume('_')) return Fail(saved);
+    Append("{unnamed type#");
+    AppendNumber(which + 2);
+    Append("}");
+    return true;
+  }
+  if (Consume("Ul")) {
+    if (!Silently(&Demangler::ParseBareFunctionType) || !Consume('E')) {
+      return Fail(saved);
+    }
+    if (IsDigit(Peek()) && !ParseNumber(&which)) return Fail(saved);
+    if (!Consume('_')) return Fail(saved);
+    Append("{lambda()#");
+    AppendNumber(which + 2);
+    Append("}");
+    return true;
+  }
+  return false;
+}
+
+// <number> ::= [n] <non-negative decimal integer>
+//
+// Stores the value in `*number_out` (negated if it starts with 'n') if that
+// is non-null.
+bool Demangler::ParseNumber(int* number_out) {
+  const ParseState saved = state_;
+  bool negative = Consume('n');
+  const char* p = state_.mangled;
+  uint64_t number = 0;
+  for (; IsDigit(*p); ++p) {
+    if (number < (uint64_t{1} << 31)) number = number * 10 + (*p - '0');
+  }
+  if (p == state_.mangled) return Fail(saved);
+  state_.mangled = p;
+  if (number > INT32_MAX) number = INT32_MAX;
+  if (number_out != nullptr) {
+    *number_out = negative ? -static_cast<int>(number)
+                           : static_cast<int>(number);
+  }
+  return true;
+}
+
+// <seq-id> ::= <0-9A-Z>+
+//
+// Seq-ids are base 36 numbers.
+bool Demangler::ParseSeqId(int* id_out) {
+  const char* p = state_.mangled;
+  int id = 0;
+  for (; IsDigit(*p) || IsUpper(*p); ++p) {
+    const int digit = IsDigit(*p) ? *p - '0' : *p - 'A' + 10;
+    if (id > (INT32_MAX - digit) / 36) return false;
+    id = id * 36 + digit;
+  }
+  if (p == state_.mangled) return false;
+  state_.mangled = p;
+  *id_out = id;
+  return true;
+}
+
+// <identifier> ::= <unqualified source code identifier> (of given length)
+bool Demangler::ParseIdentifier(int length) {
+  for (int i = 0; i < length; ++i) {
+    if (Peek(i) == '\0') return false;
+  }
+  // GCC names anonymous namespaces "_GLOBAL_" followed by one of ".", "_"
+  // or "$" and "N".
+  if (length >= 10 && StartsWith(state_.mangled, "_GLOBAL_") &&
+      Peek(9) == 'N') {
+    Append("(anonymous namespace)");
+  } else {
+    Append(state_.mangled, length);
+  }
+  state_.prev_name = state_.mangled;
+  state_.prev_name_length = length;
+  state_.mangled += length;
+  return true;
+}
+
+// <operator-name> ::= nw, and other two letters cases
+//                 ::= cv <type>  # (cast)
+//                 ::= li <source-name>  # operator ""
+//                 ::= v  <digit> <source-name> # vendor extended operator
+bool Demangler::ParseOperatorName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (!IsLower(Peek()) || !IsAlpha(Peek(1))) return false;
+  const ParseState saved = state_;
+  if (Consume("cv")) {
+    Append("operator ");
+    if (ParseType()) return true;
+    return Fail(saved);
+  }
+  if (Consume("li")) {
+    Append("operator\"\" ");
+    if (ParseSourceName()) return true;
+    return Fail(saved);
+  }
+  if (Peek() == 'v' && IsDigit(Peek(1))) {
+    state_.mangled += 2;
+    Append("operator ");
+    if (ParseSourceName()) return true;
+    return Fail(saved);
+  }
+  for (const AbbrevPair* p = kOperatorList; p->abbrev != nullptr; ++p) {
+    if (Peek() == p->abbrev[0] && Peek(1) == p->abbrev[1]) {
+      state_.mangled += 2;
+      Append("operator");
+      if (IsLower(p->real_name[0])) Append(" ");
+      Append(p->real_name);
+      return true;
+    }
+  }
+  return false;
+}
+
+// <special-name> ::= TV <type>
+//                ::= TT <type>
+//                ::= TI <type>
+//                ::= TS <type>
+//                ::= TH <name>
+//                ::= TW <name>
+//                ::= Th <call-offset> <(base) encoding>
+//                ::= Tv <call-offset> <(base) encoding>
+//                ::= Tc <call-offset> <call-offset> <(base) encoding>
+//                ::= TC <type> <(offset) number> _ <(base) type>
+//                ::= GV <(object) name>
+//                ::= GR <(object) name> [<seq-id>] _
+//                ::= GA <encoding>
+//                ::= GTt <encoding>
+//                ::= GTn <encoding>
+bool Demangler::ParseSpecialName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  struct TypePrefix {
+    const char* abbrev;
+    const char* text;
+  };
+  static const TypePrefix kTypePrefixes[] = {
+      {"TV", "vtable for "},
+      {"TT", "VTT for "},
+      {"TI", "typeinfo for "},
+      {"TS", "typeinfo name for "},
+  };
+  for (const TypePrefix& prefix : kTypePrefixes) {
+    if (Consume(prefix.abbrev)) {
+      Append(prefix.text);
+      if (ParseType()) return true;
+      return Fail(saved);
+    }
+  }
+  if (Consume("TH") || Consume("TW")) {
+    Append(saved.mangled[1] == 'H' ? "TLS init function for "
+                                   : "TLS wrapper function for ");
+    if (ParseName()) return true;
+    return Fail(saved);
+  }
+  if (Peek() == 'T' && Peek(1) == 'h') {
+    ++state_.mangled;  // The 'h' is part of the call offset.
+    Append("non-virtual thunk to ");
+    if (ParseCallOffset() && ParseEncoding()) return true;
+    return Fail(saved);
+  }
+  if (Peek() == 'T' && Peek(1) == 'v') {
+    ++state_.mangled;
+    Append("virtual thunk to ");
+    if (ParseCallOffset() && ParseEncoding()) return true;
+    return Fail(saved);
+  }
+  if (Consume("Tc")) {
+    Append("covariant return thunk to ");
+    if (ParseCallOffset() && ParseCallOffset() && ParseEncoding()) return true;
+    return Fail(saved);
+  }
+  if (Consume("TC")) {
+    Append("construction vtable for ");
+    if (ParseType() && ParseNumber(nullptr) && Consume('_') &&
+        Silently(&Demangler::ParseType)) {
+      return true;
+    }
+    return Fail(saved);
+  }
+  if (Consume("GV")) {
+    Append("guard variable for ");
+    if (ParseName()) return true;
+    return Fail(saved);
+  }
+  if (Consume("GR")) {
+    Append("reference temporary for ");
+    if (ParseName()) {
+      int id;
+      ParseSeqId(&id);
+      if (Consume('_')) return true;
+    }
+    return Fail(saved);
+  }
+  if (Consume("GA")) {
+    Append("hidden alias for ");
+    if (ParseEncoding()) return true;
+    return Fail(saved);
+  }
+  if (Consume("GT")) {
+    Append("transaction clone for ");
+    if ((Consume('t') || Consume('n')) && ParseEncoding()) return true;
+    return Fail(saved);
+  }
+  return false;
+}
+
+// <call-offset> ::= h <nv-offset> _
+//               ::= v <v-offset> _
+// <nv-offset>   ::= <(offset) number>
+// <v-offset>    ::= <(offset) number> _ <(virtual offset) number>
+bool Demangler::ParseCallOffset() {
+  const ParseState saved = state_;
+  if (Consume('h') && ParseNumber(nullptr) && Consume('_')) return true;
+  state_ = saved;
+  if (Consume('v') && ParseNumber(nullptr) && Consume('_') &&
+      ParseNumber(nullptr) && Consume('_')) {
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <ctor-dtor-name> ::= C1 | C2 | C3 | C4 | C5
+//                  ::= CI1 <type> | CI2 <type>
+//                  ::= D0 | D1 | D2 | D4 | D5
+bool Demangler::ParseCtorDtorName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (state_.prev_name == nullptr) return false;
+  const ParseState saved = state_;
+  if (Consume('C')) {
+    if (Consume('I')) {
+      // An inheriting constructor, naming the base class it comes from.
+      if ((Consume('1') || Consume('2')) &&
+          Silently(&Demangler::ParseType)) {
+        Append(saved.prev_name, saved.prev_name_length);
+        return true;
+      }
+    } else if (Peek() >= '1' && Peek() <= '5') {
+      ++state_.mangled;
+      Append(state_.prev_name, state_.prev_name_length);
+      return true;
+    }
+    return Fail(saved);
+  }
+  if (Peek() == 'D' && (Peek(1) == '0' || Peek(1) == '1' || Peek(1) == '2' ||
+                        Peek(1) == '4' || Peek(1) == '5')) {
+    state_.mangled += 2;
+    Append("~");
+    Append(state_.prev_name, state_.prev_name_length);
+    return true;
+  }
+  return false;
+}
+
+// <decltype> ::= Dt <expression> E  # decltype of an id-expression or class
+//                                   # member access (C++0x)
+//            ::= DT <expression> E  # decltype of an expression (C++0x)
+bool Demangler::ParseDecltype() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if ((Consume("Dt") || Consume("DT")) &&
+      Silently(&Demangler::ParseExpression) && Consume('E')) {
+    Append("decltype(...)");
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <type> ::= <CV-qualifiers> <type>
+//        ::= P <type>   # pointer-to
+//        ::= R <type>   # reference-to
+//        ::= O <type>   # rvalue reference-to (C++0x)
+//        ::= C <type>   # complex pair (C 2000)
+//        ::= G <type>   # imaginary (C 2000)
+//        ::= U <source-name> [<template-args>] <type>  # vendor qualifier
+//        ::= <builtin-type>
+//        ::= <function-type>
+//        ::= <class-enum-type>  # note: just an alias for <name>
+//        ::= <array-type>
+//        ::= <pointer-to-member-type>
+//        ::= <template-template-param> <template-args>
+//        ::= <template-param>
+//        ::= <decltype>
+//        ::= <substitution>
+//        ::= Dp <type>          # pack expansion of (C++0x)
+//        ::= Dv <number> _ <type>  # vector type
+//
+// Only builtin types, class names, pointers, references and cv-qualifiers
+// are printed; everything else prints nothing. Types are only printed in
+// special names and conversion operators.
+bool Demangler::ParseType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  const int begin = state_.out_len;
+
+  // <CV-qualifiers> ::= [r] [V] [K]
+  if (Peek() == 'r' || Peek() == 'V' || Peek() == 'K') {
+    const char* quals = state_.mangled;
+    while (Peek() == 'r' || Peek() == 'V' || Peek() == 'K') ++state_.mangled;
+    const char* quals_end = state_.mangled;
+    if (!ParseType()) return Fail(saved);
+    for (const char* q = quals; q != quals_end; ++q) {
+      Append(*q == 'K' ? " const" : *q == 'V' ? " volatile" : " restrict");
+    }
+    AddSubstitution(begin);
+    return true;
+  }
+
+  if (ParseBuiltinType()) return true;
+
+  switch (Peek()) {
+    case 'P':
+    case 'R':
+    case 'O':
+    case 'C':
+    case 'G': {
+      const char c = Peek();
+      ++state_.mangled;
+      if (!ParseType()) return Fail(saved);
+      Append(c == 'P' ? "*"
+                      : c == 'R' ? "&"
+                                 : c == 'O' ? "&&"
+                                            : c == 'C' ? " _Complex"
+                                                       : " _Imaginary");
+      AddSubstitution(begin);
+      return true;
+    }
+    case 'F':
+      if (!Silently(&Demangler::ParseFunctionType)) return Fail(saved);
+      AddSubstitution(begin);
+      return true;
+    case 'A':
+      if (!Silently(&Demangler::ParseArrayType)) return Fail(saved);
+      AddSubstitution(begin);
+      return true;
+    case 'M':
+      if (!Silently(&Demangler::ParsePointerToMemberType)) return Fail(saved);
+      AddSubstitution(begin);
+      return true;
+    case 'T':
+      if (Peek(1) == 's' || Peek(1) == 'u' || Peek(1) == 'e') {
+        // An elaborated type specifier: struct, union or enum.
+        state_.mangled += 2;
+        if (!ParseName()) return Fail(saved);
+        AddSubstitution(begin);
+        return true;
+      }
+      if (!ParseTemplateParam()) return Fail(saved);
+      AddSubstitution(begin);
+      if (Peek() == 'I') {
+        // A template template parameter and its arguments.
+        if (!ParseTemplateArgs()) return Fail(saved);
+        AddSubstitution(begin);
+      }
+      return true;
+    case 'S':
+      if (Peek(1) == 't') break;  // A name in namespace std.
+      if (!ParseSubstitution()) return Fail(saved);
+      if (Peek() == 'I') {
+        if (!ParseTemplateArgs()) return Fail(saved);
+        AddSubstitution(begin);
+      }
+      return true;
+    case 'D':
+      if (Peek(1) == 'p') {
+        state_.mangled += 2;
+        if (!ParseType()) return Fail(saved);
+        Append("...");
+        AddSubstitution(begin);
+        return true;
+      }
+      if (Peek(1) == 't' || Peek(1) == 'T') {
+        if (!ParseDecltype()) return Fail(saved);
+        AddSubstitution(begin);
+        return true;
+      }
+      if (Peek(1) == 'v') {
+        state_.mangled += 2;
+        if (IsDigit(Peek())) {
+          if (!ParseNumber(nullptr) || !Consume('_')) return Fail(saved);
+        } else if (!Consume('_') || !Silently(&Demangler::ParseExpression) ||
+                   !Consume('_')) {
+          return Fail(saved);
+        }
+        if (!Silently(&Demangler::ParseType)) return Fail(saved);
+        AddSubstitution(begin);
+        return true;
+      }
+      if (Peek(1) == 'o' || Peek(1) == 'O' || Peek(1) == 'w' ||
+          Peek(1) == 'x') {
+        // Exception specifications and transaction safety, which prefix a
+        // function type.
+        if (!Silently(&Demangler::ParseFunctionType)) return Fail(saved);
+        AddSubstitution(begin);
+        return true;
+      }
+      return false;
+    case 'U':
+      ++state_.mangled;
+      if (!Silently(&Demangler::ParseSourceName)) return Fail(saved);
+      if (Peek() == 'I' && !ParseTemplateArgs()) return Fail(saved);
+      if (!ParseType()) return Fail(saved);
+      AddSubstitution(begin);
+      return true;
+    default:
+      break;
+  }
+
+  // <class-enum-type> ::= <name>
+  if (Peek() == 'N' || Peek() == 'Z' || Peek() == 'S' || IsDigit(Peek())) {
+    if (!ParseName()) return Fail(saved);
+    AddSubstitution(begin);
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <builtin-type> ::= v, etc.  # single-character builtin types
+//                ::= u <source-name>
+//                ::= Dd, etc.  # two-character builtin types
+//                ::= DF <number> _  # _FloatN
+bool Demangler::ParseBuiltinType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  for (const AbbrevPair* p = kBuiltinTypeList; p->abbrev != nullptr; ++p) {
+    if (p->abbrev[1] == '\0') {
+      if (Peek() == p->abbrev[0]) {
+        ++state_.mangled;
+        Append(p->real_name);
+        return true;
+      }
+    } else if (Peek() == p->abbrev[0] && Peek(1) == p->abbrev[1]) {
+      state_.mangled += 2;
+      Append(p->real_name);
+      return true;
+    }
+  }
+  if (Consume('u')) {
+    if (ParseSourceName()) return true;
+    return Fail(saved);
+  }
+  if (Consume("DF")) {
+    int bits;
+    if (ParseNumber(&bits) && (Consume('_') || Consume('x'))) {
+      Append("_Float");
+      AppendNumber(bits);
+      return true;
+    }
+    return Fail(saved);
+  }
+  return false;
+}
+
+// <function-type> ::= [<CV-qualifiers>] [<exception-spec>] [Dx] F [Y]
+//                     <bare-function-type> [<ref-qualifier>] E
+// <exception-spec> ::= Do                # non-throwing
+//                  ::= DO <expression> E # computed noexcept
+//                  ::= Dw <type>+ E      # dynamic exception specification
+bool Demangler::ParseFunctionType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (Consume("Do")) {
+  } else if (Consume("DO")) {
+    if (!ParseExpression() || !Consume('E')) return Fail(saved);
+  } else if (Consume("Dw")) {
+    if (!ParseType()) return Fail(saved);
+    while (!Consume('E')) {
+      if (!ParseType()) return Fail(saved);
+    }
+  }
+  Consume("Dx");
+  if (!Consume('F')) return Fail(saved);
+  Consume('Y');
+  if (!ParseBareFunctionType()) return Fail(saved);
+  if (Peek() == 'R' || Peek() == 'O') ++state_.mangled;
+  if (!Consume('E')) return Fail(saved);
+  return true;
+}
+
+// <bare-function-type> ::= <(signature) type>+
+bool Demangler::ParseBareFunctionType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  if (!ParseType()) return false;
+  while (ParseType()) {
+  }
+  return true;
+}
+
+// <array-type> ::= A <(positive dimension) number> _ <(element) type>
+//              ::= A [<(dimension) expression>] _ <(element) type>
+bool Demangler::ParseArrayType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (!Consume('A')) return false;
+  if (IsDigit(Peek())) {
+    if (!ParseNumber(nullptr)) return Fail(saved);
+  } else if (Peek() != '_') {
+    if (!ParseExpression()) return Fail(saved);
+  }
+  if (Consume('_') && ParseType()) return true;
+  return Fail(saved);
+}
+
+// <pointer-to-member-type> ::= M <(class) type> <(member) type>
+bool Demangler::ParsePointerToMemberType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (Consume('M') && ParseType() && ParseType()) return true;
+  return Fail(saved);
+}
+
+// <template-param> ::= T_
+//                  ::= T <parameter-2 non-negative number> _
+bool Demangler::ParseTemplateParam() {
+  const ParseState saved = state_;
+  if (!Consume('T')) return false;
+  if (Consume('_')) {
+    Append("?");
+    return true;
+  }
+  if (IsDigit(Peek()) && ParseNumber(nullptr) && Consume('_')) {
+    Append("?");
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <template-args> ::= I <template-arg>+ E
+bool Demangler::ParseTemplateArgs() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (!Consume('I')) return false;
+  state_.append = false;
+  if (!ParseTemplateArg()) return Fail(saved);
+  while (!Consume('E')) {
+    if (!ParseTemplateArg()) return Fail(saved);
+  }
+  // Constructors of a template are named after the template, not after the
+  // last name in its arguments.
+  state_.append = saved.append;
+  state_.prev_name = saved.prev_name;
+  state_.prev_name_length = saved.prev_name_length;
+  Append("<>");
+  return true;
+}
+
+// <template-arg> ::= <type>
+//                ::= <expr-primary>
+//                ::= J <template-arg>* E  # argument pack
+//                ::= X <expression> E
+bool Demangler::ParseTemplateArg() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (Consume('J')) {
+    while (!Consume('E')) {
+      if (!ParseTemplateArg()) return Fail(saved);
+    }
+    return true;
+  }
+  if (Consume('X')) {
+    if (ParseExpression() && Consume('E')) return true;
+    return Fail(saved);
+  }
+  if (Peek() == 'L') return ParseExprPrimary();
+  return ParseType();
+}
+
+// <unresolved-type> ::= <template-param> [<template-args>]
+//                   ::= <decltype>
+//                   ::= <substitution>
+bool Demangler::ParseUnresolvedType() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  const int begin = state_.out_len;
+  if (Peek() == 'T') {
+    if (!ParseTemplateParam()) return false;
+    AddSubstitution(begin);
+    if (Peek() == 'I' && !ParseTemplateArgs()) return Fail(saved);
+    return true;
+  }
+  if (Peek() == 'D' && (Peek(1) == 't' || Peek(1) == 'T')) {
+    if (!ParseDecltype()) return false;
+    AddSubstitution(begin);
+    return true;
+  }
+  if (Peek() == 'S') return ParseSubstitution();
+  return false;
+}
+
+// <simple-id> ::= <source-name> [<template-args>]
+bool Demangler::ParseSimpleId() {
+  const ParseState saved = state_;
+  if (!ParseSourceName()) return false;
+  if (Peek() == 'I' && !ParseTemplateArgs()) return Fail(saved);
+  return true;
+}
+
+// <base-unresolved-name> ::= <simple-id>
+//                        ::= on <operator-name> [<template-args>]
+//                        ::= dn <destructor-name>
+// <destructor-name> ::= <unresolved-type>
+//                   ::= <simple-id>
+bool Demangler::ParseBaseUnresolvedName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (ParseSimpleId()) return true;
+  if (Consume("on")) {
+    if (!ParseOperatorName()) return Fail(saved);
+    if (Peek() == 'I' && !ParseTemplateArgs()) return Fail(saved);
+    return true;
+  }
+  if (Consume("dn")) {
+    if (ParseUnresolvedType() || ParseSimpleId()) return true;
+    return Fail(saved);
+  }
+  return false;
+}
+
+// <unresolved-name> ::= [gs] <base-unresolved-name>
+//                   ::= sr <unresolved-type> <base-unresolved-name>
+//                   ::= srN <unresolved-type> <unresolved-qualifier-level>+ E
+//                         <base-unresolved-name>
+//                   ::= [gs] sr <unresolved-qualifier-level>+ E
+//                         <base-unresolved-name>
+// <unresolved-qualifier-level> ::= <simple-id>
+bool Demangler::ParseUnresolvedName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  Consume("gs");
+  if (Consume("sr")) {
+    if (Consume('N')) {
+      if (!ParseUnresolvedType()) return Fail(saved);
+      while (!Consume('E')) {
+        if (!ParseSimpleId()) return Fail(saved);
+      }
+    } else if (!ParseUnresolvedType()) {
+      if (!ParseSimpleId()) return Fail(saved);
+      while (!Consume('E')) {
+        if (!ParseSimpleId()) return Fail(saved);
+      }
+    }
+  }
+  if (ParseBaseUnresolvedName()) return true;
+  return Fail(saved);
+}
+
+// <expression> ::= <1-ary operator-name> <expression>
+//              ::= <2-ary operator-name> <expression> <expression>
+//              ::= <3-ary operator-name> <expression> <expression> <expression>
+//              ::= pp_ <expression>, mm_ <expression>
+//              ::= cl <expression>+ E
+//              ::= cv <type> <expression>
+//              ::= cv <type> _ <expression>* E
+//              ::= tl <type> <expression>* E
+//              ::= il <expression>* E
+//              ::= [gs] nw <expression>* _ <type> E
+//              ::= [gs] nw <expression>* _ <type> <initializer>
+//              ::= [gs] na ...
+//              ::= [gs] dl <expression>, [gs] da <expression>
+//              ::= dc|sc|cc|rc <type> <expression>
+//              ::= st <type>, at <type>, ti <type>
+//              ::= sz|az|te|nx|tw|sp <expression>
+//              ::= tr
+//              ::= sZ <template-param>, sZ <function-param>
+//              ::= sP <template-arg>* E
+//              ::= dt|pt <expression> <unresolved-name>
+//              ::= ds <expression> <expression>
+//              ::= fl|fr <binary operator-name> <expression>
+//              ::= fL|fR <binary operator-name> <expression> <expression>
+//              ::= <template-param>
+//              ::= <function-param>
+//              ::= <expr-primary>
+//              ::= <unresolved-name>
+// <function-param> ::= fp <CV-qualifiers> [<number>] _
+//                  ::= fL <number> p <CV-qualifiers> [<number>] _
+// <initializer> ::= pi <expression>* E
+bool Demangler::ParseExpression() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+
+  if (Peek() == 'T') return ParseTemplateParam();
+  if (Peek() == 'L') return ParseExprPrimary();
+
+  if (Consume("fp")) {
+    while (Peek() == 'r' || Peek() == 'V' || Peek() == 'K') ++state_.mangled;
+    if (IsDigit(Peek())) ParseNumber(nullptr);
+    if (Consume('_')) return true;
+    return Fail(saved);
+  }
+  if (Peek() == 'f' && Peek(1) == 'L' && IsDigit(Peek(2))) {
+    state_.mangled += 2;
+    if (!ParseNumber(nullptr) || !Consume('p')) return Fail(saved);
+    while (Peek() == 'r' || Peek() == 'V' || Peek() == 'K') ++state_.mangled;
+    if (IsDigit(Peek())) ParseNumber(nullptr);
+    if (Consume('_')) return true;
+    return Fail(saved);
+  }
+  if (Consume("fl") || Consume("fr")) {
+    if (ParseOperatorName() && ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("fL") || Consume("fR")) {
+    if (ParseOperatorName() && ParseExpression() && ParseExpression()) {
+      return true;
+    }
+    return Fail(saved);
+  }
+  if (Consume("cl")) {
+    if (!ParseExpression()) return Fail(saved);
+    while (!Consume('E')) {
+      if (!ParseExpression()) return Fail(saved);
+    }
+    return true;
+  }
+  if (Consume("cv")) {
+    if (!ParseType()) return Fail(saved);
+    if (Consume('_')) {
+      while (!Consume('E')) {
+        if (!ParseExpression()) return Fail(saved);
+      }
+      return true;
+    }
+    if (ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("tl")) {
+    if (!ParseType()) return Fail(saved);
+    while (!Consume('E')) {
+      if (!ParseExpression()) return Fail(saved);
+    }
+    return true;
+  }
+  if (Consume("il") || Consume("sP")) {
+    const bool is_pack = saved.mangled[0] == 's';
+    while (!Consume('E')) {
+      if (!(is_pack ? ParseTemplateArg() : ParseExpression())) {
+        return Fail(saved);
+      }
+    }
+    return true;
+  }
+  Consume("gs");
+  if (Consume("nw") || Consume("na")) {
+    while (!Consume('_')) {
+      if (!ParseExpression()) return Fail(saved);
+    }
+    if (!ParseType()) return Fail(saved);
+    if (Consume('E')) return true;
+    if (Consume("pi")) {
+      while (!Consume('E')) {
+        if (!ParseExpression()) return Fail(saved);
+      }
+      return true;
+    }
+    if (Peek() == 'i' && Peek(1) == 'l' && ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("dl") || Consume("da")) {
+    if (ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("dc") || Consume("sc") || Consume("cc") || Consume("rc")) {
+    if (ParseType() && ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("st") || Consume("at") || Consume("ti")) {
+    if (ParseType()) return true;
+    return Fail(saved);
+  }
+  if (Consume("te") || Consume("nx") || Consume("tw") || Consume("sp")) {
+    if (ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("tr")) return true;
+  if (Consume("sZ")) {
+    if (ParseExpression()) return true;
+    return Fail(saved);
+  }
+  if (Consume("dt") || Consume("pt")) {
+    if (ParseExpression() && ParseUnresolvedName()) return true;
+    return Fail(saved);
+  }
+  if (Consume("ds")) {
+    if (ParseExpression() && ParseExpression()) return true;
+    return Fail(saved);
+  }
+
+  // Operators, with their operands.
+  for (const AbbrevPair* p = kOperatorList; p->abbrev != nullptr; ++p) {
+    if (p->arity == 0) continue;
+    if (Peek() == p->abbrev[0] && Peek(1) == p->abbrev[1]) {
+      state_.mangled += 2;
+      // The prefix forms of ++ and -- are marked with a '_'.
+      if ((p->abbrev[0] == 'p' || p->abbrev[0] == 'm') &&
+          p->abbrev[0] == p->abbrev[1]) {
+        Consume('_');
+      }
+      for (int i = 0; i < p->arity; ++i) {
+        if (!ParseExpression()) return Fail(saved);
+      }
+      return true;
+    }
+  }
+
+  state_ = saved;
+  if (ParseUnresolvedName()) return true;
+  return Fail(saved);
+}
+
+// <expr-primary> ::= L <type> <(value) number> E
+//                ::= L <type> <(value) float> E
+//                ::= L <mangled-name> E
+//                ::= L <type> E  # e.g. nullptr
+bool Demangler::ParseExprPrimary() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (!Consume('L')) return false;
+  if (Consume("_Z")) {
+    if (ParseEncoding() && Consume('E')) return true;
+    return Fail(saved);
+  }
+  if (!ParseType()) return Fail(saved);
+  // Integer and (hexadecimal) floating point literals, optionally negated
+  // with 'n', and complex literals separated by '_'.
+  while (Peek() != 'E' && (IsIdentifierChar(Peek()) || Peek() == '.')) {
+    ++state_.mangled;
+  }
+  if (Consume('E')) return true;
+  return Fail(saved);
+}
+
+// <local-name> ::= Z <(function) encoding> E <(entity) name> [<discriminator>]
+//              ::= Z <(function) encoding> E s [<discriminator>]
+//              ::= Z <(function) encoding> E d [<(parameter) number>] _
+//                    <(entity) name>
+bool Demangler::ParseLocalName() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (!Consume('Z') || !ParseEncoding() || !Consume('E')) return Fail(saved);
+  if (Consume('s')) {
+    Append("::string literal");
+    ParseDiscriminator();
+    return true;
+  }
+  if (Consume('d')) {
+    if (IsDigit(Peek())) ParseNumber(nullptr);
+    if (!Consume('_')) return Fail(saved);
+    Append("::");
+    if (ParseName()) return true;
+    return Fail(saved);
+  }
+  Append("::");
+  if (!ParseName()) return Fail(saved);
+  ParseDiscriminator();
+  return true;
+}
+
+// <discriminator> := _ <(non-negative) number>  # when number < 10
+//                 := __ <(non-negative) number> _  # when number >= 10
+bool Demangler::ParseDiscriminator() {
+  const ParseState saved = state_;
+  if (Consume("__")) {
+    if (ParseNumber(nullptr) && Consume('_')) return true;
+    return Fail(saved);
+  }
+  if (Consume('_') && IsDigit(Peek())) {
+    ++state_.mangled;
+    return true;
+  }
+  return Fail(saved);
+}
+
+// <substitution> ::= S_
+//                ::= S <seq-id> _
+//                ::= St, etc.
+bool Demangler::ParseSubstitution() {
+  ComplexityGuard guard(this);
+  if (guard.TooComplex()) return false;
+  const ParseState saved = state_;
+  if (Consume("S_")) {
+    AppendSubstitution(0);
+    return true;
+  }
+  if (!Consume('S')) return false;
+  int id;
+  if (ParseSeqId(&id) && Consume('_')) {
+    AppendSubstitution(id + 1);
+    return true;
+  }
+  state_ = saved;
+  for (const SubstitutionAbbrev* p = kSubstitutionList; p->abbrev != nullptr;
+       ++p) {
+    if (Peek(1) == p->abbrev[1]) {
+      state_.mangled += 2;
+      Append(p->real_name);
+      if (p->ctor_name != nullptr) {
+        state_.prev_name = p->ctor_name;
+        state_.prev_name_length = StrLen(p->ctor_name);
+      }
+      return true;
+    }
+  }
+  return Fail(saved);
+}
+
+}  // namespace
+
+bool Demangle(const char* mangled, char* out, int out_size) {
+  if (mangled == nullptr || out == nullptr || out_size <= 0) return false;
+  Demangler demangler(mangled, out, out_size);
+  return demangler.Run();
+}
+
+}  // namespace debug_internal
+}  // namespace absl
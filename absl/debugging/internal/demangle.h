@@ -0,0 +1,51 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// An async-signal-safe and thread-safe demangler for Itanium C++ ABI
+// (aka G++ V3 ABI) mangled names.
+//
+// The demangler is implemented to be used in async signal handlers to
+// symbolize stack traces. We cannot use libstdc++'s abi::__cxa_demangle()
+// in such signal handlers since it's not async signal safe (it uses malloc()
+// internally).
+//
+// Note that this demangler doesn't support full demangling. More
+// specifically, it doesn't print types of function parameters or template
+// arguments; those are shown as "()" and "<>" respectively. In other words,
+// it's intended for symbolizing stack traces, where the parameter types are
+// rarely needed to tell two frames apart:
+//
+//   _ZN3FooC1Ev                        -> Foo::Foo()
+//   _ZN3foo3barIiEEvv                  -> foo::bar<>()
+//   _ZNSt6vectorIiSaIiEE9push_backERKi -> std::vector<>::push_back()
+//   _ZZ3foovE3bar                      -> foo()::bar
+//   _ZNK3Foo3getEv                     -> Foo::get() const
+//
+// Demangle() returns false if the input is not a mangled name this demangler
+// understands, or if the output does not fit in `out`.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_DEMANGLE_H_
+#define ABSL_DEBUGGING_INTERNAL_DEMANGLE_H_
+
+namespace absl {
+namespace debug_internal {
+
+// Demangles `mangled`, writing the NUL-terminated result to `out`, which is
+// `out_size` bytes long. On failure the contents of `out` are unspecified.
+bool Demangle(const char* mangled, char* out, int out_size);
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_DEMANGLE_H_
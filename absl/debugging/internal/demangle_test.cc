@@ -0,0 +1,133 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/demangle.h"
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+// Demangles `mangled` into a buffer of `size` bytes, returning "FAILED" if
+// Demangle() fails.
+std::string DemangleIt(const char* mangled, int size = 256) {
+  char buf[4096];
+  if (size > static_cast<int>(sizeof(buf))) size = sizeof(buf);
+  if (!Demangle(mangled, buf, size)) return "FAILED";
+  return buf;
+}
+
+TEST(Demangle, Names) {
+  EXPECT_EQ("foo()", DemangleIt("_Z3foov"));
+  EXPECT_EQ("foo()", DemangleIt("_Z3fooiPKc"));
+  EXPECT_EQ("foo", DemangleIt("_Z3foo"));
+  EXPECT_EQ("Foo::Foo()", DemangleIt("_ZN3FooC1Ev"));
+  EXPECT_EQ("Foo::~Foo()", DemangleIt("_ZN3FooD2Ev"));
+  EXPECT_EQ("Foo::get() const", DemangleIt("_ZNK3Foo3getEv"));
+  EXPECT_EQ("a::b::c()", DemangleIt("_ZN1a1b1cEv"));
+  EXPECT_EQ("(anonymous namespace)::foo()",
+            DemangleIt("_ZN12_GLOBAL__N_13fooEv"));
+  EXPECT_EQ("std::string::size() const",
+            DemangleIt("_ZNKSs4sizeEv"));
+  EXPECT_EQ("std::allocator<>::allocator()", DemangleIt("_ZNSaIcEC1Ev"));
+  EXPECT_EQ("std::iostream::~basic_iostream()", DemangleIt("_ZNSdD0Ev"));
+  // The constructor is named after the template, not its last argument.
+  EXPECT_EQ("std::basic_stringbuf<>::basic_stringbuf()",
+            DemangleIt("_ZNSt15basic_stringbufIcSt11char_traitsIcESaIcEEC2Ev"));
+}
+
+TEST(Demangle, Templates) {
+  EXPECT_EQ("foo::bar<>()", DemangleIt("_ZN3foo3barIiEEvv"));
+  EXPECT_EQ("std::vector<>::push_back()",
+            DemangleIt("_ZNSt6vectorIiSaIiEE9push_backERKi"));
+  EXPECT_EQ("max<>()", DemangleIt("_Z3maxIiET_S0_S0_"));
+  // An argument pack, a literal and an expression.
+  EXPECT_EQ("f<>()", DemangleIt("_Z1fIJidEEvDpT_"));
+  EXPECT_EQ("g<>()", DemangleIt("_Z1gILi3EEvv"));
+  EXPECT_EQ("h<>()", DemangleIt("_Z1hIiEDTcl1fIT_EEEv"));
+}
+
+TEST(Demangle, Operators) {
+  EXPECT_EQ("Foo::operator+()", DemangleIt("_ZN3FooplERKS_"));
+  EXPECT_EQ("operator new()", DemangleIt("_Znwm"));
+  EXPECT_EQ("Foo::operator()()", DemangleIt("_ZN3FooclEv"));
+  EXPECT_EQ("Foo::operator int()", DemangleIt("_ZN3FoocviEv"));
+  EXPECT_EQ("Foo::operator char const*()", DemangleIt("_ZN3FoocvPKcEv"));
+}
+
+TEST(Demangle, LocalNamesAndLambdas) {
+  EXPECT_EQ("foo()::bar", DemangleIt("_ZZ3foovE3bar"));
+  EXPECT_EQ("foo()::bar", DemangleIt("_ZZ3foovE3bar_0"));
+  EXPECT_EQ("foo()::{lambda()#1}::operator()() const",
+            DemangleIt("_ZZ3foovENKUlvE_clEv"));
+  EXPECT_EQ("foo()::{lambda()#2}::operator()() const",
+            DemangleIt("_ZZ3foovENKUliE0_clEi"));
+  EXPECT_EQ("A::f() const::g()", DemangleIt("_ZZNK1A1fEvE1gv"));
+  EXPECT_EQ("Foo::{unnamed type#1}::bar()",
+            DemangleIt("_ZN3FooUt_3barEv"));
+}
+
+TEST(Demangle, SpecialNames) {
+  EXPECT_EQ("vtable for Foo", DemangleIt("_ZTV3Foo"));
+  EXPECT_EQ("typeinfo for int", DemangleIt("_ZTIi"));
+  EXPECT_EQ("typeinfo name for a::b", DemangleIt("_ZTSN1a1bE"));
+  EXPECT_EQ("non-virtual thunk to Foo::bar()",
+            DemangleIt("_ZThn8_N3Foo3barEv"));
+  EXPECT_EQ("virtual thunk to Foo::~Foo()",
+            DemangleIt("_ZTv0_n24_N3FooD1Ev"));
+  EXPECT_EQ("guard variable for foo()::x", DemangleIt("_ZGVZ3foovE1x"));
+}
+
+TEST(Demangle, CloneSuffixes) {
+  EXPECT_EQ("foo()", DemangleIt("_Z3foov.isra.0"));
+  EXPECT_EQ("foo()", DemangleIt("_Z3foov.constprop.1.cold"));
+  EXPECT_EQ("FAILED", DemangleIt("_Z3foov."));
+}
+
+TEST(Demangle, Failures) {
+  EXPECT_EQ("FAILED", DemangleIt(""));
+  EXPECT_EQ("FAILED", DemangleIt("main"));
+  EXPECT_EQ("FAILED", DemangleIt("_Z"));
+  EXPECT_EQ("FAILED", DemangleIt("_Z3fo"));
+  EXPECT_EQ("FAILED", DemangleIt("_ZN3fooE3"));
+  EXPECT_EQ("FAILED", DemangleIt("_ZN3fooIiE"));
+}
+
+TEST(Demangle, SmallBuffers) {
+  EXPECT_EQ("FAILED", DemangleIt("_ZN3FooC1Ev", 10));
+  EXPECT_EQ("Foo::Foo()", DemangleIt("_ZN3FooC1Ev", 11));
+  EXPECT_EQ("FAILED", DemangleIt("_Z3foov", 0));
+}
+
+// Deeply nested input must fail rather than overflow the stack.
+TEST(Demangle, DeepNesting) {
+  std::string mangled = "_Z1f";
+  for (int i = 0; i < 100000; ++i) mangled += 'P';
+  mangled += 'v';
+  EXPECT_EQ("FAILED", DemangleIt(mangled.c_str()));
+
+  std::string templates = "_Z1f";
+  for (int i = 0; i < 10000; ++i) templates += "I1a";
+  for (int i = 0; i < 10000; ++i) templates += "E";
+  templates += "v";
+  EXPECT_EQ("FAILED", DemangleIt(templates.c_str()));
+}
+
+}  // namespace
+}  // namespace debug_internal
+}  // namespace absl
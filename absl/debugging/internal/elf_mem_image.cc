@@ -73,6 +73,52 @@ const T *GetTableElement(const ElfW(Ehdr) * ehdr, ElfW(Off) table_offset,
                                     + index * element_size);
 }
 
+// The hash function of DT_HASH tables, from the System V ABI.
+uint32_t ElfHash(const char *name) {
+  uint32_t h = 0;
+  for (const unsigned char *p = reinterpret_cast<const unsigned char *>(name);
+       *p; ++p) {
+    h = (h << 4) + *p;
+    const uint32_t g = h & 0xf0000000;
+    if (g) h ^= g >> 24;
+    h &= ~g;
+  }
+  return h;
+}
+
+// The hash function of DT_GNU_HASH tables (Bernstein's).
+uint32_t GnuHash(const char *name) {
+  uint32_t h = 5381;
+  for (const unsigned char *p = reinterpret_cast<const unsigned char *>(name);
+       *p; ++p) {
+    h = h * 33 + *p;
+  }
+  return h;
+}
+
+// The layout of a DT_GNU_HASH table: a header, then `bloom_size` bloom filter
+// words of ElfW(Addr) size, `nbuckets` buckets holding the first symbol index
+// of each chain, and one hash value per hashed symbol (from `symoffset` on).
+// The low bit of a hash value marks the end of its chain.
+struct GnuHashTable {
+  explicit GnuHashTable(const ElfW(Word) *table)
+      : nbuckets(table[0]),
+        symoffset(table[1]),
+        bloom_size(table[2]),
+        bloom_shift(table[3]),
+        bloom(reinterpret_cast<const ElfW(Addr) *>(table + 4)),
+        buckets(reinterpret_cast<const ElfW(Word) *>(bloom + bloom_size)),
+        chain(buckets + nbuckets) {}
+
+  const ElfW(Word) nbuckets;
+  const ElfW(Word) symoffset;
+  const ElfW(Word) bloom_size;
+  const ElfW(Word) bloom_shift;
+  const ElfW(Addr) *const bloom;
+  const ElfW(Word) *const buckets;
+  const ElfW(Word) *const chain;  // Indexed by symbol index - symoffset.
+};
+
 }  // namespace
 
 // The value of this variable doesn't matter; it's used only for its
@@ -85,11 +131,25 @@ ElfMemImage::ElfMemImage(const void *base) {
 }
 
 int ElfMemImage::GetNumSymbols() const {
-  if (!hash_) {
-    return 0;
+  return num_symbols_;
+}
+
+int ElfMemImage::CountGnuHashSymbols() const {
+  // DT_GNU_HASH doesn't record the number of symbols; it is one past the end
+  // of the chain that starts last.
+  const GnuHashTable table(gnu_hash_);
+  ElfW(Word) last_start = 0;
+  for (ElfW(Word) i = 0; i < table.nbuckets; ++i) {
+    if (table.buckets[i] > last_start) last_start = table.buckets[i];
   }
-  // See http://www.caldera.com/developers/gabi/latest/ch5.dynamic.html#hash
-  return hash_[1];
+  if (last_start < table.symoffset) {
+    return table.symoffset;
+  }
+  ElfW(Word) index = last_start;
+  while ((table.chain[index - table.symoffset] & 1) == 0) {
+    ++index;
+  }
+  return index + 1;
 }
 
 const ElfW(Sym) *ElfMemImage::GetDynsym(int index) const {
@@ -155,9 +215,13 @@ void ElfMemImage::Init(const void *base) {
   versym_    = nullptr;
   verdef_    = nullptr;
   hash_      = nullptr;
+  gnu_hash_  = nullptr;
   strsize_   = 0;
   verdefnum_ = 0;
   link_base_ = ~0L;  // Sentinel: PT_LOAD .p_vaddr can't possibly be this.
+  num_symbols_ = 0;
+  num_indexed_ = 0;
+  max_symbol_size_ = 0;
   if (!base) {
     return;
   }
@@ -243,6 +307,9 @@ void ElfMemImage::Init(const void *base) {
       case DT_HASH:
         hash_ = reinterpret_cast<ElfW(Word) *>(value);
         break;
+      case DT_GNU_HASH:
+        gnu_hash_ = reinterpret_cast<ElfW(Word) *>(value);
+        break;
       case DT_SYMTAB:
         dynsym_ = reinterpret_cast<ElfW(Sym) *>(value);
         break;
@@ -266,25 +333,106 @@ void ElfMemImage::Init(const void *base) {
         break;
     }
   }
-  if (!hash_ || !dynsym_ || !dynstr_ || !versym_ ||
+  if ((!hash_ && !gnu_hash_) || !dynsym_ || !dynstr_ || !versym_ ||
       !verdef_ || !verdefnum_ || !strsize_) {
     assert(false);  // invalid VDSO
     // Mark this image as not present. Can not recur infinitely.
     Init(nullptr);
     return;
   }
+  // See http://www.caldera.com/developers/gabi/latest/ch5.dynamic.html#hash
+  num_symbols_ = hash_ ? hash_[1] : CountGnuHashSymbols();
+  BuildAddressIndex();
+}
+
+void ElfMemImage::BuildAddressIndex() {
+  if (num_symbols_ > kMaxIndexedSymbols) {
+    num_indexed_ = -1;
+    return;
+  }
+  // Insertion sort: the index is small, and this may run in a signal handler.
+  for (int index = 0; index < num_symbols_; ++index) {
+    const ElfW(Sym) *symbol = GetDynsym(index);
+    if (symbol->st_size == 0) {
+      continue;  // Can't overlap any address.
+    }
+    const void *address = GetSymAddr(symbol);
+    int i = num_indexed_;
+    while (i > 0 && GetSymAddr(GetDynsym(by_address_[i - 1])) > address) {
+      by_address_[i] = by_address_[i - 1];
+      --i;
+    }
+    by_address_[i] = static_cast<uint16_t>(index);
+    ++num_indexed_;
+    if (symbol->st_size > max_symbol_size_) {
+      max_symbol_size_ = symbol->st_size;
+    }
+  }
+}
+
+bool ElfMemImage::MatchSymbol(int index, const char *name, const char *version,
+                              int type, SymbolInfo *info_out) const {
+  const ElfW(Sym) *symbol = GetDynsym(index);
+  if (ElfType(symbol) != type ||
+      strcmp(GetDynstr(symbol->st_name), name) != 0) {
+    return false;
+  }
+  SymbolInfo info;
+  GetSymbolInfo(index, &info);
+  if (strcmp(info.version, version) != 0) {
+    return false;
+  }
+  if (info_out) {
+    *info_out = info;
+  }
+  return true;
 }
 
 bool ElfMemImage::LookupSymbol(const char *name,
                                const char *version,
                                int type,
                                SymbolInfo *info_out) const {
-  for (const SymbolInfo& info : *this) {
-    if (strcmp(info.name, name) == 0 && strcmp(info.version, version) == 0 &&
-        ElfType(info.symbol) == type) {
-      if (info_out) {
-        *info_out = info;
+  if (!IsPresent()) {
+    return false;
+  }
+  if (gnu_hash_) {
+    const GnuHashTable table(gnu_hash_);
+    if (table.nbuckets == 0 || table.bloom_size == 0) {
+      return false;
+    }
+    const uint32_t hash = GnuHash(name);
+    constexpr uint32_t kBloomBits = 8 * sizeof(ElfW(Addr));
+    const ElfW(Addr) word = table.bloom[(hash / kBloomBits) % table.bloom_size];
+    const ElfW(Addr) mask =
+        (ElfW(Addr){1} << (hash % kBloomBits)) |
+        (ElfW(Addr){1} << ((hash >> table.bloom_shift) % kBloomBits));
+    if ((word & mask) != mask) {
+      return false;
+    }
+    ElfW(Word) index = table.buckets[hash % table.nbuckets];
+    if (index < table.symoffset) {
+      return false;
+    }
+    for (;; ++index) {
+      const ElfW(Word) chain_hash = table.chain[index - table.symoffset];
+      if ((chain_hash | 1) == (hash | 1) &&
+          MatchSymbol(index, name, version, type, info_out)) {
+        return true;
       }
+      if (chain_hash & 1) {
+        return false;
+      }
+    }
+  }
+  const ElfW(Word) nbucket = hash_[0];
+  if (nbucket == 0) {
+    return false;
+  }
+  const ElfW(Word) *const bucket = hash_ + 2;
+  const ElfW(Word) *const chain = bucket + nbucket;
+  for (ElfW(Word) index = bucket[ElfHash(name) % nbucket]; index != STN_UNDEF;
+       index = chain[index]) {
+    if (MatchSymbol(index, name, version, type, info_out)) {
       return true;
     }
   }
@@ -293,6 +441,53 @@ bool ElfMemImage::LookupSymbol(const char *name,
 
 bool ElfMemImage::LookupSymbolByAddress(const void *address,
                                         SymbolInfo *info_out) const {
+  if (num_indexed_ >= 0) {
+    const uintptr_t target = reinterpret_cast<uintptr_t>(address);
+    // Find the first symbol that starts after `address`.
+    int lo = 0;
+    int hi = num_indexed_;
+    while (lo < hi) {
+      const int mid = lo + (hi - lo) / 2;
+      const void *start = GetSymAddr(GetDynsym(by_address_[mid]));
+      if (reinterpret_cast<uintptr_t>(start) <= target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    // Symbols starting before it may overlap `address`; those starting more
+    // than max_symbol_size_ before it can't. As the scan below did, prefer
+    // the first strong symbol, else the last weak or local one.
+    int best = -1;
+    for (int i = lo - 1; i >= 0; --i) {
+      const int index = by_address_[i];
+      const ElfW(Sym) *symbol = GetDynsym(index);
+      const uintptr_t offset =
+          target - reinterpret_cast<uintptr_t>(GetSymAddr(symbol));
+      if (offset >= max_symbol_size_) {
+        break;
+      }
+      if (offset >= symbol->st_size) {
+        continue;
+      }
+      if (!info_out) {
+        // Client only cares if there is an overlapping symbol.
+        return true;
+      }
+      const bool strong = ElfBind(symbol) == STB_GLOBAL;
+      const bool best_strong =
+          best >= 0 && ElfBind(GetDynsym(best)) == STB_GLOBAL;
+      if (best < 0 || (strong && (!best_strong || index < best)) ||
+          (!strong && !best_strong && index > best)) {
+        best = index;
+      }
+    }
+    if (best < 0) {
+      return false;
+    }
+    GetSymbolInfo(best, info_out);
+    return true;
+  }
   for (const SymbolInfo& info : *this) {
     const char *const symbol_start =
         reinterpret_cast<const char *>(info.address);
@@ -363,10 +558,14 @@ void ElfMemImage::SymbolIterator::Update(int increment) {
     index_ = image->GetNumSymbols();
     return;
   }
-  const ElfW(Sym)    *symbol = image->GetDynsym(index_);
-  const ElfW(Versym) *version_symbol = image->GetVersym(index_);
+  image->GetSymbolInfo(index_, &info_);
+}
+
+void ElfMemImage::GetSymbolInfo(int index, SymbolInfo *info) const {
+  const ElfW(Sym)    *symbol = GetDynsym(index);
+  const ElfW(Versym) *version_symbol = GetVersym(index);
   ABSL_RAW_CHECK(symbol && version_symbol, "");
-  const char *const symbol_name = image->GetDynstr(symbol->st_name);
+  const char *const symbol_name = GetDynstr(symbol->st_name);
   const ElfW(Versym) version_index = version_symbol[0] & VERSYM_VERSION;
   const ElfW(Verdef) *version_definition = nullptr;
   const char *version_name = "";
@@ -375,7 +574,7 @@ void ElfMemImage::SymbolIterator::Update(int increment) {
     // version_index could well be greater than verdefnum_, so calling
     // GetVerdef(version_index) may trigger assertion.
   } else {
-    version_definition = image->GetVerdef(version_index);
+    version_definition = GetVerdef(version_index);
   }
   if (version_definition) {
     // I am expecting 1 or 2 auxiliary entries: 1 for the version itself,
@@ -383,13 +582,13 @@ void ElfMemImage::SymbolIterator::Update(int increment) {
     ABSL_RAW_CHECK(
         version_definition->vd_cnt == 1 || version_definition->vd_cnt == 2,
         "wrong number of entries");
-    const ElfW(Verdaux) *version_aux = image->GetVerdefAux(version_definition);
-    version_name = image->GetVerstr(version_aux->vda_name);
+    const ElfW(Verdaux) *version_aux = GetVerdefAux(version_definition);
+    version_name = GetVerstr(version_aux->vda_name);
   }
-  info_.name    = symbol_name;
-  info_.version = version_name;
-  info_.address = image->GetSymAddr(symbol);
-  info_.symbol  = symbol;
+  info->name    = symbol_name;
+  info->version = version_name;
+  info->address = GetSymAddr(symbol);
+  info->symbol  = symbol;
 }
 
 }  // namespace debug_internal
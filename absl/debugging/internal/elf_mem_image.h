@@ -38,6 +38,8 @@
 
 #include <link.h>  // for ElfW
 
+#include <cstdint>
+
 namespace absl {
 namespace debug_internal {
 
@@ -101,6 +103,8 @@ class ElfMemImage {
   // Returns false if image is not present, or doesn't contain given
   // symbol/version/type combination.
   // If info_out is non-null, additional details are filled in.
+  // Only the symbols on the image's DT_GNU_HASH or DT_HASH chain for `name`
+  // are examined.
   bool LookupSymbol(const char *name, const char *version,
                     int symbol_type, SymbolInfo *info_out) const;
 
@@ -108,18 +112,43 @@ class ElfMemImage {
   // Returns true if symbol was found; false if image isn't present
   // or doesn't have a symbol overlapping given address.
   // If info_out is non-null, additional details are filled in.
+  // Images with at most kMaxIndexedSymbols symbols are searched through an
+  // index sorted by address, which Init() builds; larger ones are scanned.
   bool LookupSymbolByAddress(const void *address, SymbolInfo *info_out) const;
 
+  // The largest number of symbols Init() indexes by address. The index is
+  // stored inline so that building it needs no allocation; the VDSO has a
+  // few dozen symbols.
+  static constexpr int kMaxIndexedSymbols = 128;
+
  private:
+  // Fills in *info for the symbol at `index`.
+  void GetSymbolInfo(int index, SymbolInfo *info) const;
+  // Returns true if symbol `index` has the given name, version and type, and
+  // if so fills in *info_out (if non-null).
+  bool MatchSymbol(int index, const char *name, const char *version, int type,
+                   SymbolInfo *info_out) const;
+  // Computes num_symbols_ from the DT_GNU_HASH table.
+  int CountGnuHashSymbols() const;
+  // Fills by_address_, or sets num_indexed_ to -1 if there are too many
+  // symbols.
+  void BuildAddressIndex();
+
   const ElfW(Ehdr) *ehdr_;
   const ElfW(Sym) *dynsym_;
   const ElfW(Versym) *versym_;
   const ElfW(Verdef) *verdef_;
-  const ElfW(Word) *hash_;
+  const ElfW(Word) *hash_;       // DT_HASH table, if any.
+  const ElfW(Word) *gnu_hash_;   // DT_GNU_HASH table, if any.
   const char *dynstr_;
   size_t strsize_;
   size_t verdefnum_;
   ElfW(Addr) link_base_;     // Link-time base (p_vaddr of first PT_LOAD).
+  int num_symbols_;
+  // Symbols with a non-zero size, sorted by address, then by index.
+  uint16_t by_address_[kMaxIndexedSymbols];
+  int num_indexed_;          // Entries in by_address_; -1 if not indexed.
+  ElfW(Xword) max_symbol_size_;  // Largest st_size in by_address_.
 };
 
 }  // namespace debug_internal
@@ -0,0 +1,217 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/examine_stack.h"
+
+#ifdef __linux__
+#include <ucontext.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
+#include "absl/debugging/internal/address_is_readable.h"
+#include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
+
+namespace absl {
+namespace debug_internal {
+
+void* GetProgramCounter(const void* vuc) {
+#ifdef __linux__
+  if (vuc != nullptr) {
+    const ucontext_t* uc = static_cast<const ucontext_t*>(vuc);
+#if defined(__x86_64__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__i386__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_EIP]);
+#elif defined(__aarch64__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.pc);
+#elif defined(__arm__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.arm_pc);
+#endif
+  }
+#endif
+  static_cast<void>(vuc);
+  return nullptr;
+}
+
+namespace {
+
+// Where the stack of the thread that a signal interrupted continues past the
+// interrupted pc.
+struct InterruptedCallers {
+  // The return address saved in the frame record that the interrupted frame
+  // pointer points to, or null if there isn't a readable one. The unwinder
+  // continues the interrupted stack from this frame.
+  void* frame_caller = nullptr;
+  // The return address into the interrupted function's caller, if it is not
+  // `frame_caller`: if the function had not yet set up its frame record, or
+  // had already torn it down, the frame pointer still points to its caller's.
+  void* entry_caller = nullptr;
+};
+
+// Returns the word at `addr`, or null if it is not readable.
+void* ReadWord(uintptr_t addr) {
+  void* const* p = reinterpret_cast<void* const*>(addr);
+  if (addr == 0 || addr % sizeof(void*) != 0 || !AddressIsReadable(p)) {
+    return nullptr;
+  }
+  return *p;
+}
+
+// Returns whether the code at `pc` starts with `insn[0, n)`.
+bool CodeMatches(uintptr_t pc, const unsigned char* insn, size_t n) {
+  const unsigned char* code = reinterpret_cast<const unsigned char*>(pc);
+  return AddressIsReadable(code) && AddressIsReadable(code + n - 1) &&
+         memcmp(code, insn, n) == 0;
+}
+
+InterruptedCallers GetInterruptedCallers(const void* vuc) {
+  InterruptedCallers callers;
+#ifdef __linux__
+  if (vuc == nullptr) return callers;
+  const ucontext_t* uc = static_cast<const ucontext_t*>(vuc);
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__x86_64__)
+  const uintptr_t pc = uc->uc_mcontext.gregs[REG_RIP];
+  const uintptr_t sp = uc->uc_mcontext.gregs[REG_RSP];
+  const uintptr_t fp = uc->uc_mcontext.gregs[REG_RBP];
+  static constexpr unsigned char kMovSpToFp[] = {0x48, 0x89, 0xe5};
+  static constexpr unsigned char kEndBr[] = {0xf3, 0x0f, 0x1e, 0xfa};
+#else
+  const uintptr_t pc = uc->uc_mcontext.gregs[REG_EIP];
+  const uintptr_t sp = uc->uc_mcontext.gregs[REG_ESP];
+  const uintptr_t fp = uc->uc_mcontext.gregs[REG_EBP];
+  static constexpr unsigned char kMovSpToFp[] = {0x89, 0xe5};
+  static constexpr unsigned char kEndBr[] = {0xf3, 0x0f, 0x1e, 0xfb};
+#endif
+  static constexpr unsigned char kPushFp[] = {0x55};
+  static constexpr unsigned char kRet[] = {0xc3};
+  static constexpr unsigned char kRetImm[] = {0xc2};
+  callers.frame_caller = ReadWord(fp + sizeof(void*));
+  // The frame is set up by "push %rbp; mov %rsp,%rbp" and torn down before
+  // "ret". Before the push and at the return, the return address is on top
+  // of the stack; between the push and the mov, it is just under the saved
+  // frame pointer. A leaf function built without that prologue can't be
+  // told apart from one past it.
+  if (CodeMatches(pc, kEndBr, sizeof(kEndBr)) ||
+      CodeMatches(pc, kPushFp, sizeof(kPushFp)) ||
+      CodeMatches(pc, kRet, sizeof(kRet)) ||
+      CodeMatches(pc, kRetImm, sizeof(kRetImm))) {
+    callers.entry_caller = ReadWord(sp);
+  } else if (CodeMatches(pc, kMovSpToFp, sizeof(kMovSpToFp)) &&
+             ReadWord(sp) == reinterpret_cast<void*>(fp)) {
+    callers.entry_caller = ReadWord(sp + sizeof(void*));
+  }
+#elif defined(__aarch64__)
+  const uintptr_t pc = uc->uc_mcontext.pc;
+  const uintptr_t fp = uc->uc_mcontext.regs[29];
+  callers.frame_caller = ReadWord(fp + sizeof(void*));
+  // The frame is set up by "stp x29, x30, [sp, #-n]!; mov x29, sp" and torn
+  // down before "ret". Until the mov and at the return, the link register
+  // holds the return address.
+  const void* const code = reinterpret_cast<const void*>(pc);
+  if (pc % 4 == 0 && AddressIsReadable(code)) {
+    const uint32_t insn = *static_cast<const uint32_t*>(code);
+    if ((insn & 0xffc07fff) == 0xa9807bfd ||  // stp x29, x30, [sp, #-n]!
+        insn == 0x910003fd ||                 // mov x29, sp
+        insn == 0xd65f03c0) {                 // ret
+      callers.entry_caller = reinterpret_cast<void*>(uc->uc_mcontext.regs[30]);
+    }
+  }
+#endif
+  if (callers.entry_caller == callers.frame_caller) {
+    callers.entry_caller = nullptr;
+  }
+#endif
+  static_cast<void>(vuc);
+  return callers;
+}
+
+}  // namespace
+
+ABSL_ATTRIBUTE_NOINLINE
+int GetSignalStackTrace(void** pcs, int max_depth, const void* vuc) {
+  if (max_depth <= 0) return 0;
+  int depth = 0;
+  void* pc = GetProgramCounter(vuc);
+  if (pc != nullptr) pcs[depth++] = pc;
+  const InterruptedCallers callers = GetInterruptedCallers(vuc);
+  if (callers.entry_caller != nullptr && depth < max_depth) {
+    pcs[depth++] = callers.entry_caller;
+  }
+#ifdef __GNUC__
+  // The unwinder starts from the frame pointer of this function. Asking for
+  // it keeps the compiler from using that register for anything else, as it
+  // otherwise might where frame pointers are omitted.
+  void* volatile frame = __builtin_frame_address(0);
+  static_cast<void>(frame);
+#endif
+  // Before the interrupted stack, the unwinder reports the returns into this
+  // function's caller, into the handler's and into the signal trampoline,
+  // though not those out of frames built without frame pointers. It picks up
+  // the interrupted stack at the frame caller, so drop everything before it,
+  // or just the handler's and the trampoline's if it can't be read.
+  const int n = absl::GetStackTraceWithContext(pcs + depth, max_depth - depth,
+                                               0, vuc, nullptr);
+  constexpr int kMaxSkip = 4;
+  int skip = 2;
+  if (callers.frame_caller != nullptr) {
+    for (int i = 0; i < n && i < kMaxSkip; ++i) {
+      if (pcs[depth + i] == callers.frame_caller) {
+        skip = i;
+        break;
+      }
+    }
+  }
+  if (skip > n) skip = n;
+  memmove(pcs + depth, pcs + depth + skip, (n - skip) * sizeof(pcs[0]));
+  depth += n - skip;
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return depth;
+}
+
+void DumpStackTrace(void* const* pcs, int depth, bool symbolize,
+                    void (*writerfn)(const char*)) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  for (int i = 0; i < depth; ++i) {
+    // "    @ 0x" + address + "  " + symbol + "\n"
+    char line[1024] = "    @ 0x";
+    char* p = line + strlen(line);
+    const uintptr_t pc = reinterpret_cast<uintptr_t>(pcs[i]);
+    for (int shift = 4 * (2 * sizeof(pc) - 1); shift >= 0; shift -= 4) {
+      *p++ = kDigits[(pc >> shift) & 0xf];
+    }
+    *p++ = ' ';
+    *p++ = ' ';
+    // A return address may be the first byte after its call instruction, and
+    // so after the end of the calling function.
+    const char* symbol_pc = reinterpret_cast<const char*>(pcs[i]);
+    if (i > 0) --symbol_pc;
+    const int symbol_size = static_cast<int>(line + sizeof(line) - p - 1);
+    if (!symbolize || !absl::Symbolize(symbol_pc, p, symbol_size)) {
+      strcpy(p, "(unknown)");  // NOLINT(runtime/printf)
+    }
+    p += strlen(p);
+    *p++ = '\n';
+    *p = '\0';
+    writerfn(line);
+  }
+}
+
+}  // namespace debug_internal
+}  // namespace absl
@@ -0,0 +1,51 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Helpers for signal handlers that report where a thread was interrupted.
+// Everything here is async-signal-safe.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_EXAMINE_STACK_H_
+#define ABSL_DEBUGGING_INTERNAL_EXAMINE_STACK_H_
+
+namespace absl {
+namespace debug_internal {
+
+// Returns the pc at which a signal interrupted the thread, given the
+// `ucontext_t*` passed to an SA_SIGINFO handler, or null if it is not known
+// on this platform.
+void* GetProgramCounter(const void* vuc);
+
+// Stores in `pcs` the stack of the thread that a signal interrupted: the
+// interrupted pc (if known), then the return addresses of its callers.
+// Returns the number of entries stored, at most `max_depth`. Must be called
+// directly from the SA_SIGINFO handler that was passed `vuc`.
+//
+// The caller of a function interrupted in its prologue or at its return is
+// found from the stack pointer or link register, but that of a leaf function
+// that never sets up a frame is missing from the trace.
+int GetSignalStackTrace(void** pcs, int max_depth, const void* vuc);
+
+// Writes the stack `pcs[0, depth)` through `writerfn`, one frame per line:
+//
+//     @ 0x00000000004005d2  main
+//
+// `pcs[0]` is the interrupted pc and the rest are return addresses. Frames
+// are named with absl::Symbolize() if `symbolize` is true.
+void DumpStackTrace(void* const* pcs, int depth, bool symbolize,
+                    void (*writerfn)(const char*));
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_EXAMINE_STACK_H_
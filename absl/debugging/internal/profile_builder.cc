@@ -0,0 +1,186 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/profile_builder.h"
+
+#include "absl/debugging/symbolize.h"
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+// Field numbers from profile.proto.
+enum ProfileField {
+  kProfileSampleType = 1,
+  kProfileSample = 2,
+  kProfileLocation = 4,
+  kProfileFunction = 5,
+  kProfileStringTable = 6,
+  kProfileTimeNanos = 9,
+  kProfileDurationNanos = 10,
+  kProfilePeriodType = 11,
+  kProfilePeriod = 12,
+  kProfileComment = 13,
+};
+enum ValueTypeField { kValueTypeType = 1, kValueTypeUnit = 2 };
+enum SampleField { kSampleLocationId = 1, kSampleValue = 2 };
+enum LocationField { kLocationId = 1, kLocationAddress = 3, kLocationLine = 4 };
+enum LineField { kLineFunctionId = 1 };
+enum FunctionField {
+  kFunctionId = 1,
+  kFunctionName = 2,
+  kFunctionSystemName = 3,
+};
+
+enum WireType { kVarint = 0, kLengthDelimited = 2 };
+
+void PutVarint(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutKey(std::string* out, int field, WireType type) {
+  PutVarint(out, (static_cast<uint64_t>(field) << 3) | type);
+}
+
+void PutInt(std::string* out, int field, uint64_t value) {
+  PutKey(out, field, kVarint);
+  PutVarint(out, value);
+}
+
+void PutBytes(std::string* out, int field, const std::string& bytes) {
+  PutKey(out, field, kLengthDelimited);
+  PutVarint(out, bytes.size());
+  out->append(bytes);
+}
+
+std::string ValueType(std::pair<int64_t, int64_t> type_and_unit) {
+  std::string value_type;
+  PutInt(&value_type, kValueTypeType, type_and_unit.first);
+  PutInt(&value_type, kValueTypeUnit, type_and_unit.second);
+  return value_type;
+}
+
+}  // namespace
+
+ProfileBuilder::ProfileBuilder()
+    : period_type_(0, 0), period_(0), time_nanos_(0), duration_nanos_(0) {
+  StringId("");  // The string table must start with "".
+}
+
+int64_t ProfileBuilder::StringId(const std::string& s) {
+  auto inserted = string_ids_.emplace(s, strings_.size());
+  if (inserted.second) strings_.push_back(s);
+  return inserted.first->second;
+}
+
+uint64_t ProfileBuilder::LocationId(uintptr_t address) {
+  auto inserted = location_ids_.emplace(address, locations_.size() + 1);
+  if (inserted.second) locations_.push_back(address);
+  return inserted.first->second;
+}
+
+void ProfileBuilder::AddSampleType(const std::string& type,
+                                   const std::string& unit) {
+  sample_types_.emplace_back(StringId(type), StringId(unit));
+}
+
+void ProfileBuilder::SetPeriod(const std::string& type,
+                               const std::string& unit, int64_t period) {
+  period_type_ = {StringId(type), StringId(unit)};
+  period_ = period;
+}
+
+void ProfileBuilder::SetTime(int64_t time_nanos, int64_t duration_nanos) {
+  time_nanos_ = time_nanos;
+  duration_nanos_ = duration_nanos;
+}
+
+void ProfileBuilder::AddSample(void* const* pcs, int depth,
+                               const int64_t* values) {
+  std::string location_ids;
+  for (int i = 0; i < depth; ++i) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pcs[i]);
+    // Attribute a return address to its call instruction, which is in the
+    // calling function even if the call is the function's last instruction.
+    if (i > 0 && address > 0) --address;
+    PutVarint(&location_ids, LocationId(address));
+  }
+  std::string packed_values;
+  for (size_t i = 0; i < sample_types_.size(); ++i) {
+    PutVarint(&packed_values, static_cast<uint64_t>(values[i]));
+  }
+  std::string sample;
+  PutBytes(&sample, kSampleLocationId, location_ids);
+  PutBytes(&sample, kSampleValue, packed_values);
+  PutBytes(&samples_, kProfileSample, sample);
+}
+
+void ProfileBuilder::AddComment(const std::string& comment) {
+  comments_.push_back(StringId(comment));
+}
+
+std::string ProfileBuilder::Emit() {
+  std::string functions;
+  std::string locations;
+  std::unordered_map<std::string, uint64_t> function_ids;
+  char name[1024];
+  for (size_t i = 0; i < locations_.size(); ++i) {
+    const uint64_t id = i + 1;
+    std::string location;
+    PutInt(&location, kLocationId, id);
+    PutInt(&location, kLocationAddress, locations_[i]);
+    if (absl::Symbolize(reinterpret_cast<const void*>(locations_[i]), name,
+                        sizeof(name))) {
+      auto inserted = function_ids.emplace(name, function_ids.size() + 1);
+      if (inserted.second) {
+        const int64_t name_id = StringId(name);
+        std::string function;
+        PutInt(&function, kFunctionId, inserted.first->second);
+        PutInt(&function, kFunctionName, name_id);
+        PutInt(&function, kFunctionSystemName, name_id);
+        PutBytes(&functions, kProfileFunction, function);
+      }
+      std::string line;
+      PutInt(&line, kLineFunctionId, inserted.first->second);
+      PutBytes(&location, kLocationLine, line);
+    }
+    PutBytes(&locations, kProfileLocation, location);
+  }
+
+  std::string profile;
+  for (const auto& type : sample_types_) {
+    PutBytes(&profile, kProfileSampleType, ValueType(type));
+  }
+  profile.append(samples_);
+  profile.append(locations);
+  profile.append(functions);
+  for (const std::string& s : strings_) {
+    PutBytes(&profile, kProfileStringTable, s);
+  }
+  PutInt(&profile, kProfileTimeNanos, time_nanos_);
+  PutInt(&profile, kProfileDurationNanos, duration_nanos_);
+  PutBytes(&profile, kProfilePeriodType, ValueType(period_type_));
+  PutInt(&profile, kProfilePeriod, period_);
+  for (int64_t comment : comments_) {
+    PutInt(&profile, kProfileComment, comment);
+  }
+  return profile;
+}
+
+}  // namespace debug_internal
+}  // namespace absl
@@ -0,0 +1,82 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// ProfileBuilder encodes stack samples in the protocol buffer format read by
+// pprof (github.com/google/pprof, proto/profile.proto), without depending on
+// the protobuf library. Functions are named with absl::Symbolize(), so the
+// output can be read without the binary.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_PROFILE_BUILDER_H_
+#define ABSL_DEBUGGING_INTERNAL_PROFILE_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace absl {
+namespace debug_internal {
+
+class ProfileBuilder {
+ public:
+  ProfileBuilder();
+
+  ProfileBuilder(const ProfileBuilder&) = delete;
+  ProfileBuilder& operator=(const ProfileBuilder&) = delete;
+
+  // Adds a kind of value recorded by every sample, such as ("samples",
+  // "count") or ("cpu", "nanoseconds"). Each sample has one value per type,
+  // in the order the types were added.
+  void AddSampleType(const std::string& type, const std::string& unit);
+
+  // Sets the sampling period, measured as `type` in `unit`.
+  void SetPeriod(const std::string& type, const std::string& unit,
+                 int64_t period);
+
+  // Sets when collection began and how long it lasted.
+  void SetTime(int64_t time_nanos, int64_t duration_nanos);
+
+  // Adds a sample for the stack `pcs[0, depth)`, innermost frame first.
+  // `pcs[0]` is the sampled pc; the rest are return addresses. `values` has
+  // one entry per sample type.
+  void AddSample(void* const* pcs, int depth, const int64_t* values);
+
+  // Adds a free-form note about the profile, which pprof shows with it.
+  void AddComment(const std::string& comment);
+
+  // Returns the serialized profile.
+  std::string Emit();
+
+ private:
+  int64_t StringId(const std::string& s);
+  uint64_t LocationId(uintptr_t address);
+
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, int64_t> string_ids_;
+  std::unordered_map<uintptr_t, uint64_t> location_ids_;
+  std::vector<uintptr_t> locations_;  // Address of location i + 1.
+  std::vector<std::pair<int64_t, int64_t>> sample_types_;
+  std::pair<int64_t, int64_t> period_type_;
+  int64_t period_;
+  int64_t time_nanos_;
+  int64_t duration_nanos_;
+  std::string samples_;  // Encoded Sample messages.
+  std::vector<int64_t> comments_;  // String ids.
+};
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_PROFILE_BUILDER_H_
@@ -0,0 +1,233 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/stack_depot.h"
+
+#include "absl/base/internal/low_level_alloc.h"
+
+#ifndef ABSL_LOW_LEVEL_ALLOC_MISSING
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+using base_internal::LowLevelAlloc;
+
+// Traces live in slabs obtained from LowLevelAlloc and carved up with a shared
+// bump pointer. A trace's ID encodes its slab and its offset in the slab, so
+// finding a trace from its ID takes two loads.
+constexpr int kSlabShift = 17;  // 128 KiB
+constexpr size_t kSlabBytes = size_t{1} << kSlabShift;
+constexpr int kAlignShift = 3;
+constexpr size_t kAlign = size_t{1} << kAlignShift;
+constexpr int kOffsetBits = kSlabShift - kAlignShift;
+constexpr uint32_t kMaxSlabs = 4096;  // 512 MiB of traces.
+
+// Each bucket holds the ID of the most recently added trace with a hash in
+// that bucket; the traces in a bucket are chained through Entry::next.
+constexpr uint32_t kNumBuckets = 1 << 15;
+
+#ifndef ABSL_LOW_LEVEL_ALLOC_ASYNC_SIGNAL_SAFE_MISSING
+constexpr int32_t kArenaFlags = LowLevelAlloc::kAsyncSignalSafe;
+#else
+constexpr int32_t kArenaFlags = 0;
+#endif
+
+// A stored trace. The pcs follow the header. An entry is never modified after
+// it is published in a bucket.
+struct Entry {
+  uint32_t next;  // ID of the next older trace in the same bucket, or 0.
+  uint32_t hash;
+  uint32_t depth;
+  uint32_t unused;
+};
+static_assert(sizeof(Entry) % kAlign == 0, "Entry breaks pc alignment");
+
+void** Pcs(Entry* entry) { return reinterpret_cast<void**>(entry + 1); }
+
+std::atomic<LowLevelAlloc::Arena*> g_arena;
+std::atomic<char*> g_slabs[kMaxSlabs];
+std::atomic<uint32_t> g_buckets[kNumBuckets];
+
+// The slab index in the high 32 bits, and the offset of the first free byte
+// in that slab in the low 32 bits.
+std::atomic<uint64_t> g_cursor;
+
+std::atomic<size_t> g_num_slabs;
+std::atomic<size_t> g_num_traces;
+
+LowLevelAlloc::Arena* GetArena() {
+  LowLevelAlloc::Arena* arena = g_arena.load(std::memory_order_acquire);
+  if (arena != nullptr) return arena;
+  LowLevelAlloc::Arena* created = LowLevelAlloc::NewArena(kArenaFlags);
+  if (g_arena.compare_exchange_strong(arena, created,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+    return created;
+  }
+  LowLevelAlloc::DeleteArena(created);
+  return arena;
+}
+
+// Returns the memory of slab `slab`, allocating it if no thread has yet.
+char* GetSlab(uint32_t slab) {
+  char* base = g_slabs[slab].load(std::memory_order_acquire);
+  if (base != nullptr) return base;
+  char* created = static_cast<char*>(
+      LowLevelAlloc::AllocWithArena(kSlabBytes, GetArena()));
+  if (g_slabs[slab].compare_exchange_strong(base, created,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+    g_num_slabs.fetch_add(1, std::memory_order_relaxed);
+    return created;
+  }
+  LowLevelAlloc::Free(created);
+  return base;
+}
+
+// Reserves `size` bytes for a new entry and stores its ID in `*id`. Returns
+// null if the depot is full.
+Entry* Allocate(size_t size, uint32_t* id) {
+  size = (size + kAlign - 1) & ~(kAlign - 1);
+  uint64_t cursor = g_cursor.load(std::memory_order_relaxed);
+  for (;;) {
+    const uint32_t slab = static_cast<uint32_t>(cursor >> 32);
+    const uint32_t offset = static_cast<uint32_t>(cursor);
+    if (offset + size > kSlabBytes) {
+      // Move on to the next slab. If another thread got there first, the
+      // failed exchange reloads the cursor.
+      if (slab + 1 >= kMaxSlabs) return nullptr;
+      g_cursor.compare_exchange_weak(cursor, uint64_t{slab + 1} << 32,
+                                     std::memory_order_relaxed);
+      continue;
+    }
+    char* base = GetSlab(slab);
+    if (g_cursor.compare_exchange_weak(cursor, cursor + size,
+                                       std::memory_order_relaxed)) {
+      // Offset by one so that no trace has ID 0.
+      *id = ((slab << kOffsetBits) | (offset >> kAlignShift)) + 1;
+      return reinterpret_cast<Entry*>(base + offset);
+    }
+  }
+}
+
+Entry* EntryFor(uint32_t id) {
+  if (id == 0) return nullptr;
+  --id;
+  const uint32_t slab = id >> kOffsetBits;
+  const size_t offset = size_t{id & ((1u << kOffsetBits) - 1)} << kAlignShift;
+  if (slab >= kMaxSlabs) return nullptr;
+  char* base = g_slabs[slab].load(std::memory_order_acquire);
+  if (base == nullptr) return nullptr;
+  return reinterpret_cast<Entry*>(base + offset);
+}
+
+uint32_t Hash(void* const* pcs, int depth) {
+  uint64_t h = static_cast<uint64_t>(depth);
+  for (int i = 0; i < depth; ++i) {
+    h = (h ^ reinterpret_cast<uintptr_t>(pcs[i])) * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 29;
+  }
+  return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// Returns the ID of a trace equal to `pcs[0, depth)` in the chain starting at
+// `first`, looking no further than `last`, or 0 if there is none.
+uint32_t FindInChain(uint32_t first, uint32_t last, uint32_t hash,
+                     void* const* pcs, int depth) {
+  for (uint32_t id = first; id != last && id != 0;) {
+    Entry* entry = EntryFor(id);
+    if (entry->hash == hash && entry->depth == static_cast<uint32_t>(depth) &&
+        memcmp(Pcs(entry), pcs, depth * sizeof(void*)) == 0) {
+      return id;
+    }
+    id = entry->next;
+  }
+  return 0;
+}
+
+}  // namespace
+
+uint32_t StackDepotPut(void* const* pcs, int depth) {
+  if (depth <= 0) return 0;
+  if (depth > kMaxStackDepotDepth) depth = kMaxStackDepotDepth;
+  const uint32_t hash = Hash(pcs, depth);
+  std::atomic<uint32_t>& bucket = g_buckets[hash & (kNumBuckets - 1)];
+  uint32_t head = bucket.load(std::memory_order_acquire);
+  uint32_t id = FindInChain(head, 0, hash, pcs, depth);
+  if (id != 0) return id;
+
+  Entry* entry = Allocate(sizeof(Entry) + depth * sizeof(void*), &id);
+  if (entry == nullptr) return 0;
+  new (entry) Entry;
+  entry->hash = hash;
+  entry->depth = depth;
+  memcpy(Pcs(entry), pcs, depth * sizeof(void*));
+  for (;;) {
+    entry->next = head;
+    if (bucket.compare_exchange_weak(head, id, std::memory_order_release,
+                                     std::memory_order_acquire)) {
+      g_num_traces.fetch_add(1, std::memory_order_relaxed);
+      return id;
+    }
+    // Other traces were added to the bucket; one may equal ours, in which
+    // case our entry is abandoned.
+    const uint32_t found = FindInChain(head, entry->next, hash, pcs, depth);
+    if (found != 0) return found;
+  }
+}
+
+int StackDepotGet(uint32_t id, void* const** pcs) {
+  Entry* entry = EntryFor(id);
+  if (entry == nullptr) {
+    *pcs = nullptr;
+    return 0;
+  }
+  *pcs = Pcs(entry);
+  return entry->depth;
+}
+
+StackDepotStats GetStackDepotStats() {
+  StackDepotStats stats;
+  stats.num_traces = g_num_traces.load(std::memory_order_relaxed);
+  stats.allocated_bytes =
+      g_num_slabs.load(std::memory_order_relaxed) * kSlabBytes;
+  return stats;
+}
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#else  // ABSL_LOW_LEVEL_ALLOC_MISSING
+
+namespace absl {
+namespace debug_internal {
+
+uint32_t StackDepotPut(void* const*, int) { return 0; }
+
+int StackDepotGet(uint32_t, void* const** pcs) {
+  *pcs = nullptr;
+  return 0;
+}
+
+StackDepotStats GetStackDepotStats() { return StackDepotStats{0, 0}; }
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_LOW_LEVEL_ALLOC_MISSING
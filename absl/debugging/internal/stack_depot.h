@@ -0,0 +1,61 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The stack depot stores each distinct stack trace once and names it with a
+// 32-bit ID. Code that records a trace per event, such as a profiler or the
+// deadlock detector, can keep the ID instead of an array of pcs; two traces
+// are equal exactly when their IDs are.
+//
+// The depot is a single process-wide table. It is append-only: traces are
+// never removed and their memory is never returned.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_STACK_DEPOT_H_
+#define ABSL_DEBUGGING_INTERNAL_STACK_DEPOT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace absl {
+namespace debug_internal {
+
+// The most frames stored for one trace. Deeper traces keep their innermost
+// kMaxStackDepotDepth frames.
+constexpr int kMaxStackDepotDepth = 256;
+
+// Stores the trace `pcs[0, depth)` unless an equal trace is already stored,
+// and returns the ID of the stored trace. Returns 0, which names the empty
+// trace, if `depth` is zero or the depot is out of memory.
+//
+// Thread-safe and async-signal-safe where LowLevelAlloc supports
+// kAsyncSignalSafe arenas. Takes no locks, except inside LowLevelAlloc when a
+// new slab of storage is needed.
+uint32_t StackDepotPut(void* const* pcs, int depth);
+
+// Sets `*pcs` to the trace named by `id`, which must be 0 or a value returned
+// by StackDepotPut(), and returns its depth. The trace is never modified or
+// freed. Thread-safe and async-signal-safe.
+int StackDepotGet(uint32_t id, void* const** pcs);
+
+struct StackDepotStats {
+  size_t num_traces;       // Distinct traces stored.
+  size_t allocated_bytes;  // Memory obtained for storing them.
+};
+
+// Returns a snapshot of the depot's size.
+StackDepotStats GetStackDepotStats();
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_STACK_DEPOT_H_
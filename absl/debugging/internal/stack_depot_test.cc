@@ -0,0 +1,124 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/stack_depot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/internal/low_level_alloc.h"
+
+#ifndef ABSL_LOW_LEVEL_ALLOC_MISSING
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+// Returns a trace of `depth` made-up pcs that differs for each `seed`.
+std::vector<void*> MakeTrace(uintptr_t seed, int depth) {
+  std::vector<void*> pcs;
+  for (int i = 0; i < depth; ++i) {
+    pcs.push_back(reinterpret_cast<void*>(seed * 0x10000 + i * 8 + 0x400000));
+  }
+  return pcs;
+}
+
+std::vector<void*> Get(uint32_t id) {
+  void* const* pcs;
+  const int depth = StackDepotGet(id, &pcs);
+  return std::vector<void*>(pcs, pcs + depth);
+}
+
+TEST(StackDepot, RoundTrip) {
+  const std::vector<void*> trace = MakeTrace(1, 10);
+  const uint32_t id = StackDepotPut(trace.data(), trace.size());
+  EXPECT_NE(0, id);
+  EXPECT_EQ(trace, Get(id));
+}
+
+TEST(StackDepot, EqualTracesShareAnId) {
+  const std::vector<void*> a = MakeTrace(2, 10);
+  const std::vector<void*> b = MakeTrace(2, 10);
+  const std::vector<void*> prefix = MakeTrace(2, 9);
+  const std::vector<void*> other = MakeTrace(3, 10);
+  const uint32_t id = StackDepotPut(a.data(), a.size());
+  EXPECT_EQ(id, StackDepotPut(b.data(), b.size()));
+  EXPECT_NE(id, StackDepotPut(prefix.data(), prefix.size()));
+  EXPECT_NE(id, StackDepotPut(other.data(), other.size()));
+}
+
+TEST(StackDepot, EmptyTrace) {
+  EXPECT_EQ(0, StackDepotPut(nullptr, 0));
+  void* const* pcs;
+  EXPECT_EQ(0, StackDepotGet(0, &pcs));
+}
+
+TEST(StackDepot, DeepTracesAreTruncated) {
+  const std::vector<void*> trace = MakeTrace(4, kMaxStackDepotDepth + 10);
+  const uint32_t id = StackDepotPut(trace.data(), trace.size());
+  const std::vector<void*> stored = Get(id);
+  ASSERT_EQ(kMaxStackDepotDepth, stored.size());
+  EXPECT_TRUE(std::equal(stored.begin(), stored.end(), trace.begin()));
+}
+
+// Enough traces to fill several slabs.
+TEST(StackDepot, ManyTraces) {
+  const StackDepotStats before = GetStackDepotStats();
+  constexpr int kNumTraces = 20000;
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < kNumTraces; ++i) {
+    const std::vector<void*> trace = MakeTrace(1000 + i, 1 + i % 32);
+    ids.push_back(StackDepotPut(trace.data(), trace.size()));
+  }
+  EXPECT_EQ(kNumTraces, std::set<uint32_t>(ids.begin(), ids.end()).size());
+  for (int i = 0; i < kNumTraces; ++i) {
+    EXPECT_EQ(MakeTrace(1000 + i, 1 + i % 32), Get(ids[i]));
+  }
+  const StackDepotStats after = GetStackDepotStats();
+  EXPECT_EQ(before.num_traces + kNumTraces, after.num_traces);
+  EXPECT_GT(after.allocated_bytes, before.allocated_bytes);
+}
+
+// Threads adding the same traces at once must agree on their IDs.
+TEST(StackDepot, ConcurrentPuts) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumTraces = 2000;
+  std::vector<std::vector<uint32_t>> ids(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([t, &ids]() {
+      for (int i = 0; i < kNumTraces; ++i) {
+        const std::vector<void*> trace = MakeTrace(100000 + i, 8);
+        ids[t].push_back(StackDepotPut(trace.data(), trace.size()));
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int t = 1; t < kNumThreads; ++t) {
+    EXPECT_EQ(ids[0], ids[t]);
+  }
+  for (int i = 0; i < kNumTraces; ++i) {
+    EXPECT_EQ(MakeTrace(100000 + i, 8), Get(ids[0][i]));
+  }
+}
+
+}  // namespace
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_LOW_LEVEL_ALLOC_MISSING
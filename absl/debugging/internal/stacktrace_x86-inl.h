@@ -21,15 +21,22 @@
 #include <ucontext.h>  // for ucontext_t
 #endif
 
+#if defined(__linux__)
+#include <signal.h>  // for sigaltstack()
+#endif
+
 #if !defined(_WIN32)
 #include <unistd.h>
 #endif
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 
+#include "absl/base/attributes.h"
 #include "absl/base/macros.h"
 #include "absl/base/port.h"
+#include "absl/base/internal/per_thread_tls.h"
 #include "absl/debugging/internal/address_is_readable.h"
 #include "absl/debugging/internal/vdso_support.h"  // a no-op on non-elf or non-glibc systems
 #include "absl/debugging/stacktrace.h"
@@ -149,14 +156,93 @@ static uintptr_t GetFP(const void *vuc) {
   return 0;
 }
 
+// The part of the current thread's stack that may hold live frames: from the
+// frame the unwinder starts in up to the base of the stack. Empty if the
+// thread's stack bounds are not known.
+struct StackBounds {
+  uintptr_t lo;
+  uintptr_t hi;
+
+  // Returns true if a whole frame record (saved frame pointer and return
+  // address) at `fp` lies within the bounds.
+  bool Contains(uintptr_t fp) const {
+    return lo <= fp && fp < hi && hi - fp >= 2 * sizeof(void *);
+  }
+};
+
+#if ABSL_PER_THREAD_TLS && defined(__linux__)
+// The bounds of the mapping holding the current thread's stack, looked up
+// the first time the thread unwinds on that stack. Only the owning thread
+// writes them; a signal handler that interrupts the write sees kUnknown and
+// ignores lo and hi.
+struct CachedStackBounds {
+  enum State : char { kUnknown = 0, kKnown, kUnavailable };
+  uintptr_t lo;
+  uintptr_t hi;
+  State state;
+};
+static ABSL_PER_THREAD_TLS_KEYWORD CachedStackBounds cached_stack_bounds
+    ABSL_ATTRIBUTE_INITIAL_EXEC;
+
+// Looks up the bounds of the current thread's stack if that has not been
+// done, using only async-signal-safe calls that do not allocate. Nothing is
+// cached while on an alternate signal stack, which would be mistaken for the
+// thread's own; the next unwind on the thread's stack tries again.
+static void LookUpStackBounds(uintptr_t fp) {
+  CachedStackBounds &cached = cached_stack_bounds;
+  if (cached.state != CachedStackBounds::kUnknown) return;
+  stack_t ss;
+  if (sigaltstack(nullptr, &ss) == 0 && (ss.ss_flags & SS_ONSTACK) != 0) {
+    return;
+  }
+  uintptr_t lo;
+  uintptr_t hi;
+  if (!absl::debug_internal::GetMappingContaining(
+          reinterpret_cast<const void *>(fp), &lo, &hi)) {
+    cached.state = CachedStackBounds::kUnavailable;
+    return;
+  }
+  cached.lo = lo;
+  cached.hi = hi;
+  std::atomic_signal_fence(std::memory_order_release);
+  cached.state = CachedStackBounds::kKnown;
+}
+
+// Returns the cached bounds of the current thread's stack above `start_fp`.
+// This needs no system call and is safe in a signal handler.
+static StackBounds CurrentStackBounds(uintptr_t start_fp) {
+  StackBounds bounds = {0, 0};
+  const CachedStackBounds &cached = cached_stack_bounds;
+  if (cached.state != CachedStackBounds::kKnown) return bounds;
+  std::atomic_signal_fence(std::memory_order_acquire);
+  // A thread that switches stacks keeps the bounds of the first one it
+  // unwound on, and falls back to heuristics on the others.
+  if (cached.lo <= start_fp && start_fp < cached.hi) {
+    // Frames below the one we start in are not ours to follow.
+    bounds.lo = start_fp;
+    bounds.hi = cached.hi;
+  }
+  return bounds;
+}
+#else
+static void LookUpStackBounds(uintptr_t) {}
+
+static StackBounds CurrentStackBounds(uintptr_t) {
+  StackBounds bounds = {0, 0};
+  return bounds;
+}
+#endif
+
 // Given a pointer to a stack frame, locate and return the calling
 // stackframe, or return null if no stackframe can be found. Perform sanity
 // checks (the strictness of which is controlled by the boolean parameter
 // "STRICT_UNWINDING") to reduce the chance that a bad pointer is returned.
+// Frames within `bounds` are checked with range compares alone.
 template <bool STRICT_UNWINDING, bool WITH_CONTEXT>
 ABSL_ATTRIBUTE_NO_SANITIZE_ADDRESS  // May read random elements from stack.
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY   // May read random elements from stack.
-static void **NextStackFrame(void **old_fp, const void *uc) {
+static void **NextStackFrame(void **old_fp, const void *uc,
+                             const StackBounds &bounds) {
   void **new_fp = (void **)*old_fp;
 
 #if defined(__linux__) && defined(__i386__)
@@ -250,7 +336,13 @@ static void **NextStackFrame(void **old_fp, const void *uc) {
     // With the stack growing downwards, older stack frame must be
     // at a greater address that the current one.
     if (new_fp_u <= old_fp_u) return nullptr;
-    if (new_fp_u - old_fp_u > kMaxFrameBytes) return nullptr;
+    if (bounds.Contains(old_fp_u)) {
+      // A frame on a stack of known extent can be as large as the stack, but
+      // its caller's frame must be on the same stack.
+      if (!bounds.Contains(new_fp_u)) return nullptr;
+    } else if (new_fp_u - old_fp_u > kMaxFrameBytes) {
+      return nullptr;
+    }
   } else {
     if (new_fp == nullptr) return nullptr;  // skip AddressIsReadable() below
     // In the non-strict mode, allow discontiguous stack frames.
@@ -273,7 +365,8 @@ static void **NextStackFrame(void **old_fp, const void *uc) {
     // Note: NextStackFrame<false>() is only called while the program
     //       is already on its last leg, so it's ok to be slow here.
 
-    if (!absl::debug_internal::AddressIsReadable(new_fp)) {
+    if (!bounds.Contains(new_fp_u) &&
+        !absl::debug_internal::AddressIsReadable(new_fp)) {
       return nullptr;
     }
   }
@@ -281,7 +374,13 @@ static void **NextStackFrame(void **old_fp, const void *uc) {
   return new_fp;
 }
 
-template <bool IS_STACK_FRAMES, bool IS_WITH_CONTEXT>
+// UnwindImpl<false, false, false> is the unwinder behind
+// absl::GetStackTraceFast(): it uses the stack bounds only if they are
+// already cached, so it makes no system calls.
+#define ABSL_STACKTRACE_HAVE_FAST_UNWIND 1
+
+template <bool IS_STACK_FRAMES, bool IS_WITH_CONTEXT,
+          bool LOOK_UP_BOUNDS = true>
 ABSL_ATTRIBUTE_NO_SANITIZE_ADDRESS  // May read random elements from stack.
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY   // May read random elements from stack.
 ABSL_ATTRIBUTE_NOINLINE
@@ -289,6 +388,9 @@ static int UnwindImpl(void **result, int *sizes, int max_depth, int skip_count,
                       const void *ucp, int *min_dropped_frames) {
   int n = 0;
   void **fp = reinterpret_cast<void **>(__builtin_frame_address(0));
+  if (LOOK_UP_BOUNDS) LookUpStackBounds(reinterpret_cast<uintptr_t>(fp));
+  const StackBounds bounds =
+      CurrentStackBounds(reinterpret_cast<uintptr_t>(fp));
 
   while (fp && n < max_depth) {
     if (*(fp + 1) == reinterpret_cast<void *>(0)) {
@@ -296,7 +398,8 @@ static int UnwindImpl(void **result, int *sizes, int max_depth, int skip_count,
       // points to itself and has a return address of 0.
       break;
     }
-    void **next_fp = NextStackFrame<!IS_STACK_FRAMES, IS_WITH_CONTEXT>(fp, ucp);
+    void **next_fp =
+        NextStackFrame<!IS_STACK_FRAMES, IS_WITH_CONTEXT>(fp, ucp, bounds);
     if (skip_count > 0) {
       skip_count--;
     } else {
@@ -319,7 +422,7 @@ static int UnwindImpl(void **result, int *sizes, int max_depth, int skip_count,
     const int kMaxUnwind = 1000;
     int j = 0;
     for (; fp != nullptr && j < kMaxUnwind; j++) {
-      fp = NextStackFrame<!IS_STACK_FRAMES, IS_WITH_CONTEXT>(fp, ucp);
+      fp = NextStackFrame<!IS_STACK_FRAMES, IS_WITH_CONTEXT>(fp, ucp, bounds);
     }
     *min_dropped_frames = j;
   }
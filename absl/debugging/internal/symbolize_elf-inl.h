@@ -0,0 +1,537 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Symbol lookup for ELF platforms. This header is "private" to symbolize.cc.
+//
+// The executable mapping containing a pc is found in /proc/self/maps. Its file
+// is mapped read-only and the symbol table is read in place; the first lookup
+// in each object also sorts the table's symbols by address into an index,
+// which later lookups binary search. Objects are published in a fixed table
+// that readers scan without locking. Only the thread that holds the table's
+// spinlock adds to it; a lookup that cannot take the lock maps the file, scans
+// its symbol table linearly and unmaps it again.
+//
+// Everything here uses only async-signal-safe system calls (open, read,
+// fstat, mmap, munmap, close) and no heap.
+//
+// Objects that are unloaded with dlclose() are not removed from the table, so
+// a later object mapped at the same address may be misattributed.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_ELF_INL_H_
+#define ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_ELF_INL_H_
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/attributes.h"
+#include "absl/base/internal/spinlock.h"
+#include "absl/debugging/internal/vdso_support.h"
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+#if __WORDSIZE == 32
+const int kElfClass = ELFCLASS32;
+int ElfBind(const ElfW(Sym) &symbol) { return ELF32_ST_BIND(symbol.st_info); }
+int ElfType(const ElfW(Sym) &symbol) { return ELF32_ST_TYPE(symbol.st_info); }
+#else
+const int kElfClass = ELFCLASS64;
+int ElfBind(const ElfW(Sym) &symbol) { return ELF64_ST_BIND(symbol.st_info); }
+int ElfType(const ElfW(Sym) &symbol) { return ELF64_ST_TYPE(symbol.st_info); }
+#endif
+
+// One entry of an object's symbol index.
+struct SymbolIndexEntry {
+  uintptr_t addr;  // Link-time address.
+  uintptr_t size;
+  uint32_t name;  // Offset of the name in the string table.
+  // Orders symbols at the same address: sized symbols win over unsized ones,
+  // and global symbols over local ones.
+  uint32_t rank;
+};
+
+// An executable mapping of an ELF file, with the file's symbol table.
+struct ObjectFile {
+  uintptr_t start;  // The mapping covers [start, end).
+  uintptr_t end;
+  uintptr_t bias;     // Runtime address minus link-time address.
+  const char* image;  // The whole file, mapped read-only; null if unusable.
+  size_t image_size;
+  const ElfW(Sym) * symtab;
+  size_t num_symbols;
+  const char* strtab;
+  size_t strtab_size;
+  const SymbolIndexEntry* index;  // Sorted by (addr, rank); may be null.
+  size_t index_size;
+};
+
+// An executable mapping from /proc/self/maps.
+struct Mapping {
+  uintptr_t start;
+  uintptr_t end;
+  uintptr_t offset;  // File offset of `start`.
+  const char* path;  // Points into the reader's buffer.
+};
+
+// The number of objects whose symbols are kept. Lookups in objects beyond
+// this many take the slow path every time.
+constexpr int kMaxObjects = 256;
+
+// The number of symbols before the closest one that are checked for a
+// containing symbol, to skip unsized labels inside functions.
+constexpr int kMaxBacktrack = 16;
+
+ABSL_CONST_INIT base_internal::SpinLock g_objects_lock(
+    base_internal::kLinkerInitialized);
+ObjectFile g_objects[kMaxObjects];
+ABSL_CONST_INIT std::atomic<int> g_num_objects(0);
+
+// Reads a file line by line into a fixed buffer. Lines that do not fit are
+// skipped.
+class LineReader {
+ public:
+  explicit LineReader(int fd) : fd_(fd), begin_(0), end_(0), eof_(false) {}
+
+  LineReader(const LineReader&) = delete;
+  LineReader& operator=(const LineReader&) = delete;
+
+  // Returns the next line, NUL-terminated and without its newline, or null at
+  // the end of the file.
+  char* Next() {
+    bool skipping = false;
+    for (;;) {
+      char* newline = static_cast<char*>(
+          memchr(buf_ + begin_, '\n', end_ - begin_));
+      if (newline != nullptr) {
+        char* line = buf_ + begin_;
+        *newline = '\0';
+        begin_ = newline + 1 - buf_;
+        if (!skipping) return line;
+        skipping = false;
+        continue;
+      }
+      if (eof_) return nullptr;  // Drops a final line without a newline.
+      if (begin_ > 0) {
+        memmove(buf_, buf_ + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+      }
+      if (end_ == static_cast<int>(sizeof(buf_))) {
+        // An overlong line; drop what we have of it.
+        skipping = true;
+        end_ = 0;
+      }
+      ssize_t n;
+      do {
+        n = read(fd_, buf_ + end_, sizeof(buf_) - end_);
+      } while (n < 0 && errno == EINTR);
+      if (n <= 0) {
+        eof_ = true;
+      } else {
+        end_ += static_cast<int>(n);
+      }
+    }
+  }
+
+ private:
+  const int fd_;
+  char buf_[1024];
+  int begin_;  // The unread data is buf_[begin_, end_).
+  int end_;
+  bool eof_;
+};
+
+// Parses a hexadecimal number at `*p`, advancing `*p` past it.
+bool ParseHex(const char** p, uintptr_t* value) {
+  const char* s = *p;
+  uintptr_t v = 0;
+  for (;; ++s) {
+    int digit;
+    if (*s >= '0' && *s <= '9') {
+      digit = *s - '0';
+    } else if (*s >= 'a' && *s <= 'f') {
+      digit = *s - 'a' + 10;
+    } else if (*s >= 'A' && *s <= 'F') {
+      digit = *s - 'A' + 10;
+    } else {
+      break;
+    }
+    v = (v << 4) | static_cast<uintptr_t>(digit);
+  }
+  if (s == *p) return false;
+  *p = s;
+  *value = v;
+  return true;
+}
+
+// Skips the field at `*p` and the spaces after it.
+void SkipField(const char** p) {
+  while (**p != ' ' && **p != '\0') ++*p;
+  while (**p == ' ') ++*p;
+}
+
+// Parses a line of /proc/self/maps:
+//   start-end perms offset dev inode [path]
+// Returns false if the line is malformed or the mapping is not executable.
+bool ParseMapsLine(const char* line, Mapping* mapping) {
+  const char* p = line;
+  if (!ParseHex(&p, &mapping->start) || *p++ != '-' ||
+      !ParseHex(&p, &mapping->end) || *p++ != ' ') {
+    return false;
+  }
+  const bool executable = p[0] != '\0' && p[1] != '\0' && p[2] == 'x';
+  SkipField(&p);  // perms
+  if (!ParseHex(&p, &mapping->offset)) return false;
+  while (*p == ' ') ++p;
+  SkipField(&p);  // dev
+  SkipField(&p);  // inode
+  mapping->path = p;
+  return executable;
+}
+
+// Calls `fn` on the executable mapping containing `pc`, if there is one.
+// `fn` must be done with the mapping's path when it returns.
+template <typename Fn>
+bool WithMapping(uintptr_t pc, Fn fn) {
+  int fd;
+  do {
+    fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) return false;
+  bool found = false;
+  LineReader reader(fd);
+  for (const char* line = reader.Next(); line != nullptr;
+       line = reader.Next()) {
+    Mapping mapping;
+    if (ParseMapsLine(line, &mapping) && mapping.start <= pc &&
+        pc < mapping.end) {
+      fn(mapping);
+      found = true;
+      break;
+    }
+  }
+  close(fd);
+  return found;
+}
+
+// Returns true if [offset, offset + size) lies within an image of
+// `image_size` bytes.
+bool InImage(uint64_t offset, uint64_t size, size_t image_size) {
+  return offset <= image_size && size <= image_size - offset;
+}
+
+// Maps the file of `mapping` and locates its symbol table, filling in `obj`.
+// Returns false, leaving nothing mapped, if the file is not an ELF file with
+// symbols.
+bool MapObjectFile(const Mapping& mapping, ObjectFile* obj) {
+  if (mapping.path[0] != '/') return false;  // Anonymous, or [vdso] etc.
+  int fd;
+  do {
+    fd = open(mapping.path, O_RDONLY | O_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) return false;
+  struct stat st;
+  void* image = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    image = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (image == MAP_FAILED) return false;
+
+  const char* base = static_cast<const char*>(image);
+  const size_t size = st.st_size;
+  const ElfW(Ehdr)* ehdr = reinterpret_cast<const ElfW(Ehdr)*>(base);
+  const ElfW(Phdr)* phdrs = nullptr;
+  const ElfW(Shdr)* shdrs = nullptr;
+  if (size >= sizeof(*ehdr) && memcmp(ehdr->e_ident, ELFMAG, SELFMAG) == 0 &&
+      ehdr->e_ident[EI_CLASS] == kElfClass &&
+      ehdr->e_phentsize == sizeof(ElfW(Phdr)) &&
+      InImage(ehdr->e_phoff, uint64_t{ehdr->e_phnum} * sizeof(ElfW(Phdr)),
+              size) &&
+      ehdr->e_shentsize == sizeof(ElfW(Shdr)) &&
+      InImage(ehdr->e_shoff, uint64_t{ehdr->e_shnum} * sizeof(ElfW(Shdr)),
+              size)) {
+    phdrs = reinterpret_cast<const ElfW(Phdr)*>(base + ehdr->e_phoff);
+    shdrs = reinterpret_cast<const ElfW(Shdr)*>(base + ehdr->e_shoff);
+  }
+
+  // The load bias follows from the segment that this mapping is part of.
+  bool have_bias = false;
+  for (int i = 0; phdrs != nullptr && i < ehdr->e_phnum; ++i) {
+    const ElfW(Phdr)& phdr = phdrs[i];
+    if (phdr.p_type == PT_LOAD && phdr.p_offset <= mapping.offset &&
+        mapping.offset < phdr.p_offset + phdr.p_filesz) {
+      obj->bias = mapping.start - mapping.offset + phdr.p_offset -
+                  phdr.p_vaddr;
+      have_bias = true;
+      break;
+    }
+  }
+
+  // Prefer the full symbol table, falling back to the dynamic one.
+  const ElfW(Shdr)* symtab = nullptr;
+  for (int i = 0; have_bias && shdrs != nullptr && i < ehdr->e_shnum; ++i) {
+    if (shdrs[i].sh_type == SHT_SYMTAB) {
+      symtab = &shdrs[i];
+      break;
+    }
+    if (shdrs[i].sh_type == SHT_DYNSYM) symtab = &shdrs[i];
+  }
+  const ElfW(Shdr)* strtab =
+      symtab != nullptr && symtab->sh_link < ehdr->e_shnum
+          ? &shdrs[symtab->sh_link]
+          : nullptr;
+  if (strtab == nullptr || symtab->sh_entsize != sizeof(ElfW(Sym)) ||
+      !InImage(symtab->sh_offset, symtab->sh_size, size) ||
+      !InImage(strtab->sh_offset, strtab->sh_size, size)) {
+    munmap(image, size);
+    return false;
+  }
+
+  obj->image = base;
+  obj->image_size = size;
+  obj->symtab = reinterpret_cast<const ElfW(Sym)*>(base + symtab->sh_offset);
+  obj->num_symbols = symtab->sh_size / sizeof(ElfW(Sym));
+  obj->strtab = base + strtab->sh_offset;
+  obj->strtab_size = strtab->sh_size;
+  return true;
+}
+
+// Returns true if `sym` names code or data that a pc can fall into.
+bool IsLookupCandidate(const ObjectFile& obj, const ElfW(Sym)& sym) {
+  const int type = ElfType(sym);
+  return sym.st_shndx != SHN_UNDEF && sym.st_value != 0 &&
+         sym.st_name != 0 && sym.st_name < obj.strtab_size &&
+         (type == STT_FUNC || type == STT_OBJECT || type == STT_NOTYPE ||
+          type == STT_GNU_IFUNC);
+}
+
+SymbolIndexEntry MakeIndexEntry(const ElfW(Sym)& sym) {
+  SymbolIndexEntry entry;
+  entry.addr = sym.st_value;
+  entry.size = sym.st_size;
+  entry.name = sym.st_name;
+  entry.rank = (sym.st_size > 0 ? 2 : 0) +
+               (ElfBind(sym) != STB_LOCAL ? 1 : 0);
+  return entry;
+}
+
+bool IndexEntryLess(const SymbolIndexEntry& a, const SymbolIndexEntry& b) {
+  return a.addr != b.addr ? a.addr < b.addr : a.rank < b.rank;
+}
+
+// Returns true if a pc at link-time address `addr` can be attributed to
+// `entry`: either it lies inside the symbol, or the symbol has no size.
+bool Covers(const SymbolIndexEntry& entry, uintptr_t addr) {
+  return entry.addr <= addr &&
+         (entry.size == 0 || addr - entry.addr < entry.size);
+}
+
+// Sorts `entries` in place. A heapsort, since std::sort is not guaranteed to
+// avoid the heap.
+void SortIndex(SymbolIndexEntry* entries, size_t n) {
+  auto sift_down = [entries](size_t root, size_t end) {
+    for (;;) {
+      size_t child = 2 * root + 1;
+      if (child >= end) return;
+      if (child + 1 < end && IndexEntryLess(entries[child], entries[child + 1])) {
+        ++child;
+      }
+      if (!IndexEntryLess(entries[root], entries[child])) return;
+      const SymbolIndexEntry tmp = entries[root];
+      entries[root] = entries[child];
+      entries[child] = tmp;
+      root = child;
+    }
+  };
+  for (size_t i = n / 2; i-- > 0;) sift_down(i, n);
+  for (size_t end = n; end > 1; --end) {
+    const SymbolIndexEntry tmp = entries[0];
+    entries[0] = entries[end - 1];
+    entries[end - 1] = tmp;
+    sift_down(0, end - 1);
+  }
+}
+
+// Builds the sorted symbol index of `obj` in anonymous memory. Lookups fall
+// back to scanning the symbol table if this fails.
+void BuildIndex(ObjectFile* obj) {
+  size_t n = 0;
+  for (size_t i = 0; i < obj->num_symbols; ++i) {
+    if (IsLookupCandidate(*obj, obj->symtab[i])) ++n;
+  }
+  if (n == 0) return;
+  const size_t bytes = n * sizeof(SymbolIndexEntry);
+  void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) return;
+  SymbolIndexEntry* entries = static_cast<SymbolIndexEntry*>(memory);
+  size_t j = 0;
+  for (size_t i = 0; i < obj->num_symbols; ++i) {
+    if (IsLookupCandidate(*obj, obj->symtab[i])) {
+      entries[j++] = MakeIndexEntry(obj->symtab[i]);
+    }
+  }
+  SortIndex(entries, n);
+  obj->index = entries;
+  obj->index_size = n;
+}
+
+// Copies the NUL-terminated string at `name`, which must lie within
+// [name, limit), to `out`, truncating it if necessary.
+void CopyName(const char* name, const char* limit, char* out, int out_size) {
+  int i = 0;
+  for (; i < out_size - 1 && name + i < limit && name[i] != '\0'; ++i) {
+    out[i] = name[i];
+  }
+  out[i] = '\0';
+}
+
+// Looks up `pc` among the symbols of `obj`.
+bool FindSymbolInObject(const ObjectFile& obj, uintptr_t pc, char* out,
+                        int out_size) {
+  const uintptr_t addr = pc - obj.bias;
+  const SymbolIndexEntry* found = nullptr;
+  SymbolIndexEntry scanned;
+  if (obj.index != nullptr) {
+    // Find the last entry at or below `addr`, then walk back from it to the
+    // closest symbol that covers `addr`.
+    size_t lo = 0;
+    size_t hi = obj.index_size;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (obj.index[mid].addr <= addr) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    for (size_t i = lo; i > 0 && lo - i < kMaxBacktrack; --i) {
+      if (Covers(obj.index[i - 1], addr)) {
+        found = &obj.index[i - 1];
+        break;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < obj.num_symbols; ++i) {
+      if (!IsLookupCandidate(obj, obj.symtab[i])) continue;
+      const SymbolIndexEntry entry = MakeIndexEntry(obj.symtab[i]);
+      if (Covers(entry, addr) &&
+          (found == nullptr || IndexEntryLess(*found, entry))) {
+        scanned = entry;
+        found = &scanned;
+      }
+    }
+  }
+  if (found == nullptr) return false;
+  CopyName(obj.strtab + found->name, obj.strtab + obj.strtab_size, out,
+           out_size);
+  return true;
+}
+
+// Returns the published object whose mapping contains `pc`, or null.
+const ObjectFile* FindObject(uintptr_t pc, int num_objects) {
+  for (int i = 0; i < num_objects; ++i) {
+    if (g_objects[i].start <= pc && pc < g_objects[i].end) {
+      return &g_objects[i];
+    }
+  }
+  return nullptr;
+}
+
+// Adds the object containing `pc` to the table, unless it is already there
+// or `pc` is not in an executable mapping. Returns false if the table is full.
+// Requires g_objects_lock.
+bool AddObjectLocked(uintptr_t pc) {
+  const int n = g_num_objects.load(std::memory_order_relaxed);
+  if (FindObject(pc, n) != nullptr) return true;
+  if (n == kMaxObjects) return false;
+  WithMapping(pc, [n](const Mapping& mapping) {
+    ObjectFile& obj = g_objects[n];
+    obj = ObjectFile();
+    obj.start = mapping.start;
+    obj.end = mapping.end;
+    // An object without symbols is still recorded, so that it is not opened
+    // again.
+    if (MapObjectFile(mapping, &obj)) BuildIndex(&obj);
+    g_num_objects.store(n + 1, std::memory_order_release);
+  });
+  return true;
+}
+
+// Looks up `pc` without the object table, mapping its file for the duration
+// of the call.
+bool FindSymbolUncached(uintptr_t pc, char* out, int out_size) {
+  bool found = false;
+  WithMapping(pc, [pc, out, out_size, &found](const Mapping& mapping) {
+    ObjectFile obj = ObjectFile();
+    if (!MapObjectFile(mapping, &obj)) return;
+    found = FindSymbolInObject(obj, pc, out, out_size);
+    munmap(const_cast<char*>(obj.image), obj.image_size);
+  });
+  return found;
+}
+
+}  // namespace
+
+// Writes the raw (mangled) name of the symbol containing `pc` to `out`,
+// truncating it if necessary.
+bool FindSymbol(const void* pc, char* out, int out_size) {
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(pc);
+  const ObjectFile* obj =
+      FindObject(addr, g_num_objects.load(std::memory_order_acquire));
+  if (obj != nullptr && obj->image != nullptr) {
+    return FindSymbolInObject(*obj, addr, out, out_size);
+  }
+
+#ifdef ABSL_HAVE_VDSO_SUPPORT
+  // The vDSO has no file to map, but is already an ELF image in memory.
+  VDSOSupport vdso;
+  VDSOSupport::SymbolInfo info;
+  if (vdso.IsPresent() && vdso.LookupSymbolByAddress(pc, &info)) {
+    const char* name = info.name;
+    CopyName(name, name + strlen(name) + 1, out, out_size);
+    return true;
+  }
+#endif
+
+  if (obj != nullptr) return false;  // An object without symbols.
+  if (g_objects_lock.TryLock()) {
+    const bool added = AddObjectLocked(addr);
+    g_objects_lock.Unlock();
+    if (added) {
+      obj = FindObject(addr, g_num_objects.load(std::memory_order_acquire));
+      if (obj == nullptr || obj->image == nullptr) return false;
+      return FindSymbolInObject(*obj, addr, out, out_size);
+    }
+  }
+  // The table is full, or another lookup is adding to it, possibly in the
+  // code that this signal handler interrupted.
+  return FindSymbolUncached(addr, out, out_size);
+}
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_ELF_INL_H_
@@ -0,0 +1,28 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_UNIMPLEMENTED_INL_H_
+#define ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_UNIMPLEMENTED_INL_H_
+
+namespace absl {
+namespace debug_internal {
+
+bool FindSymbol(const void* /* pc */, char* /* out */, int /* out_size */) {
+  return false;
+}
+
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_INTERNAL_SYMBOLIZE_UNIMPLEMENTED_INL_H_
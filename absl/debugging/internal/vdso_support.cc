@@ -25,6 +25,8 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 
+#include <new>
+
 #if __GLIBC_PREREQ(2, 16)  // GLIBC-2.16 implements getauxval.
 #include <sys/auxv.h>
 #endif
@@ -48,10 +50,38 @@ std::atomic<VDSOSupport::GetCpuFn> VDSOSupport::getcpu_fn_(&InitAndGetCPU);
 VDSOSupport::VDSOSupport()
     // If vdso_base_ is still set to kInvalidBase, we got here
     // before VDSOSupport::Init has been called. Call it now.
-    : image_(vdso_base_.load(std::memory_order_relaxed) ==
-                     debug_internal::ElfMemImage::kInvalidBase
-                 ? Init()
-                 : vdso_base_.load(std::memory_order_relaxed)) {}
+    : image_(ImageAt(vdso_base_.load(std::memory_order_relaxed) ==
+                             debug_internal::ElfMemImage::kInvalidBase
+                         ? Init()
+                         : vdso_base_.load(std::memory_order_relaxed))) {}
+
+namespace {
+
+// The first image parsed by VDSOSupport::ImageAt(), and its base. The cache
+// is filled at most once, without locks, since it may be used from a signal
+// handler: kImageEmpty -> kImageFilling -> kImageFull.
+enum { kImageEmpty, kImageFilling, kImageFull };
+ABSL_CONST_INIT std::atomic<int> cached_image_state(kImageEmpty);
+const void *cached_image_base;
+alignas(ElfMemImage) char cached_image[sizeof(ElfMemImage)];
+
+}  // namespace
+
+ElfMemImage VDSOSupport::ImageAt(const void *base) {
+  if (cached_image_state.load(std::memory_order_acquire) == kImageFull &&
+      cached_image_base == base) {
+    return *reinterpret_cast<const ElfMemImage *>(cached_image);
+  }
+  ElfMemImage image(base);
+  int state = kImageEmpty;
+  if (cached_image_state.compare_exchange_strong(state, kImageFilling,
+                                                 std::memory_order_relaxed)) {
+    cached_image_base = base;
+    new (cached_image) ElfMemImage(image);
+    cached_image_state.store(kImageFull, std::memory_order_release);
+  }
+  return image;
+}
 
 // NOTE: we can't use GoogleOnceInit() below, because we can be
 // called by tcmalloc, and none of the *once* stuff may be functional yet.
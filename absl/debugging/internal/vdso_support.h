@@ -108,6 +108,11 @@ class VDSOSupport {
   // image_.ehdr_ == nullptr implies there is no VDSO.
   ElfMemImage image_;
 
+  // Returns the image at `base`. The first image parsed is kept, so that
+  // constructing a VDSOSupport normally copies it rather than parsing and
+  // indexing the VDSO again.
+  static ElfMemImage ImageAt(const void *base);
+
   // Cached value of auxv AT_SYSINFO_EHDR, computed once.
   // This is a tri-state:
   //   kInvalidBase   => value hasn't been determined yet.
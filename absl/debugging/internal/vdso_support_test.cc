@@ -0,0 +1,105 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/internal/vdso_support.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#ifdef ABSL_HAVE_VDSO_SUPPORT
+
+namespace absl {
+namespace debug_internal {
+namespace {
+
+// The symbol LookupSymbolByAddress() should find for `address`, found by
+// scanning every symbol: the first strong one, else the last weak or local
+// one. Returns nullptr if no symbol overlaps `address`.
+const ElfW(Sym)* ScanForAddress(const VDSOSupport& vdso, const char* address) {
+  const ElfW(Sym)* found = nullptr;
+  for (const VDSOSupport::SymbolInfo& info : vdso) {
+    const char* start = static_cast<const char*>(info.address);
+    if (start <= address && address < start + info.symbol->st_size) {
+      found = info.symbol;
+      if (ELF64_ST_BIND(info.symbol->st_info) == STB_GLOBAL) break;
+    }
+  }
+  return found;
+}
+
+TEST(VDSOSupport, LookupSymbolFindsEveryExportedSymbol) {
+  VDSOSupport vdso;
+  if (!vdso.IsPresent()) return;
+  int exported = 0;
+  for (const VDSOSupport::SymbolInfo& info : vdso) {
+    if (info.symbol->st_shndx == SHN_UNDEF ||
+        ELF64_ST_BIND(info.symbol->st_info) == STB_LOCAL) {
+      continue;  // Not in the hash table.
+    }
+    ++exported;
+    VDSOSupport::SymbolInfo found;
+    ASSERT_TRUE(vdso.LookupSymbol(info.name, info.version,
+                                  ELF64_ST_TYPE(info.symbol->st_info), &found))
+        << info.name << "@" << info.version;
+    EXPECT_STREQ(info.name, found.name);
+    EXPECT_STREQ(info.version, found.version);
+    EXPECT_EQ(info.address, found.address);
+  }
+  EXPECT_GT(exported, 0);
+}
+
+TEST(VDSOSupport, LookupSymbolRejectsMismatches) {
+  VDSOSupport vdso;
+  if (!vdso.IsPresent()) return;
+  for (const VDSOSupport::SymbolInfo& info : vdso) {
+    if (info.symbol->st_shndx == SHN_UNDEF || info.name[0] == '\0') continue;
+    const int type = ELF64_ST_TYPE(info.symbol->st_info);
+    EXPECT_FALSE(vdso.LookupSymbol(info.name, "NO_SUCH_VERSION", type,
+                                   nullptr));
+    EXPECT_FALSE(vdso.LookupSymbol(info.name, info.version, type + 1,
+                                   nullptr));
+  }
+  EXPECT_FALSE(vdso.LookupSymbol("__vdso_no_such_symbol", "LINUX_2.6",
+                                 VDSOSupport::kVDSOSymbolType, nullptr));
+}
+
+TEST(VDSOSupport, LookupSymbolByAddressMatchesScan) {
+  VDSOSupport vdso;
+  if (!vdso.IsPresent()) return;
+  for (const VDSOSupport::SymbolInfo& info : vdso) {
+    const char* start = static_cast<const char*>(info.address);
+    const ElfW(Xword) size = info.symbol->st_size;
+    for (const char* address :
+         {start - 1, start, start + size / 2, start + size - 1, start + size}) {
+      const ElfW(Sym)* expected = ScanForAddress(vdso, address);
+      VDSOSupport::SymbolInfo found;
+      ASSERT_EQ(expected != nullptr,
+                vdso.LookupSymbolByAddress(address, &found))
+         
+          << info.name;
+      EXPECT_EQ(expected != nullptr,
+                vdso.LookupSymbolByAddress(address, nullptr));
+      if (expected != nullptr) {
+        EXPECT_EQ(expected, found.symbol) << info.name;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace debug_internal
+}  // namespace absl
+
+#endif  // ABSL_HAVE_VDSO_SUPPORT
@@ -0,0 +1,372 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/leak_check_registry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/base/attributes.h"
+#include "absl/base/internal/low_level_alloc.h"
+#include "absl/base/internal/raw_logging.h"
+#include "absl/base/internal/spinlock.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/debugging/leak_check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace absl {
+namespace {
+
+using base_internal::LowLevelAlloc;
+
+struct Range {
+  uintptr_t start;
+  uintptr_t end;  // One past the last byte.
+};
+
+bool StartsBefore(const Range& a, const Range& b) { return a.start < b.start; }
+
+// Registered ranges are kept in memory from LowLevelAlloc, so that arenas
+// and allocators can register their memory without recursing into malloc().
+base_internal::SpinLock registry_lock(base_internal::kLinkerInitialized);
+
+// Held by GetArenaReachability() while it scans a copy of the registered
+// ranges, and by unregistration, so that memory being scanned is not
+// unregistered and unmapped. Acquired before registry_lock.
+base_internal::SpinLock scan_lock(base_internal::kLinkerInitialized);
+LowLevelAlloc::Arena* registry_arena GUARDED_BY(registry_lock) = nullptr;
+
+void* RegistryAlloc(size_t bytes) EXCLUSIVE_LOCKS_REQUIRED(registry_lock) {
+  if (registry_arena == nullptr) {
+    registry_arena = LowLevelAlloc::NewArena(0);
+  }
+  return LowLevelAlloc::AllocWithArena(bytes, registry_arena);
+}
+
+// A multiset of ranges sorted by start. A batch of ranges is merged in, or
+// removed, in one pass over the set.
+class RangeSet {
+ public:
+  size_t size() const { return size_; }
+  const Range* data() const { return ranges_; }
+  const Range& operator[](size_t i) const { return ranges_[i]; }
+
+  // Adds `batch[0, n)`, which must be sorted by start.
+  void Insert(const Range* batch, size_t n)
+      EXCLUSIVE_LOCKS_REQUIRED(registry_lock);
+
+  // Removes every range that lies within one of `batch[0, n)`, which must be
+  // sorted by start, and unregisters it from the leak sanitizer.
+  void RemoveWithin(const Range* batch, size_t n);
+
+ private:
+  Range* ranges_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+void RangeSet::Insert(const Range* batch, size_t n) {
+  if (n == 0) return;
+  if (size_ + n > capacity_) {
+    const size_t capacity =
+        std::max(std::max<size_t>(2 * capacity_, 64), size_ + n);
+    Range* ranges =
+        static_cast<Range*>(RegistryAlloc(capacity * sizeof(Range)));
+    std::merge(ranges_, ranges_ + size_, batch, batch + n, ranges,
+               StartsBefore);
+    if (ranges_ != nullptr) LowLevelAlloc::Free(ranges_);
+    ranges_ = ranges;
+    capacity_ = capacity;
+    size_ += n;
+    return;
+  }
+  // Merge from the back, so that when memory is registered in address order
+  // no range already in the set moves.
+  size_t i = size_;
+  size_t j = n;
+  size_t k = size_ + n;
+  while (j > 0) {
+    if (i > 0 && StartsBefore(batch[j - 1], ranges_[i - 1])) {
+      ranges_[--k] = ranges_[--i];
+    } else {
+      ranges_[--k] = batch[--j];
+    }
+  }
+  size_ += n;
+}
+
+void RangeSet::RemoveWithin(const Range* batch, size_t n) {
+  if (n == 0) return;
+  // No range starting before the first of the batch lies within it.
+  size_t out =
+      std::lower_bound(ranges_, ranges_ + size_, batch[0], StartsBefore) -
+      ranges_;
+  size_t j = 0;
+  uintptr_t covered_end = 0;  // Furthest end of a batch range started so far.
+  for (size_t i = out; i < size_; ++i) {
+    const Range r = ranges_[i];
+    while (j < n && batch[j].start <= r.start) {
+      covered_end = std::max(covered_end, batch[j].end);
+      ++j;
+    }
+    if (r.end <= covered_end) {
+      // The leak sanitizer forgets only ranges exactly as registered.
+      UnRegisterLivePointers(reinterpret_cast<const void*>(r.start),
+                             r.end - r.start);
+    } else {
+      ranges_[out++] = r;
+    }
+  }
+  size_ = out;
+}
+
+// Returns the index of a range in `ranges[0, n)`, which must be sorted by
+// start and not overlap, that contains `address`, or -1 if there is none.
+ptrdiff_t FindRange(const Range* ranges, size_t n, uintptr_t address) {
+  const Range key = {address, address};
+  const Range* next = std::upper_bound(ranges, ranges + n, key, StartsBefore);
+  if (next == ranges) return -1;
+  const Range* r = next - 1;
+  return address < r->end ? r - ranges : -1;
+}
+
+RangeSet live_ranges GUARDED_BY(registry_lock);
+RangeSet arena_blocks GUARDED_BY(registry_lock);
+
+// Returns `ranges[0, n)`, without the empty ones, as Ranges sorted by start
+// in memory from the registry arena, and sets `*m` to their number.
+Range* SortRanges(const LeakCheckRange* ranges, size_t n, size_t* m)
+    EXCLUSIVE_LOCKS_REQUIRED(registry_lock) {
+  Range* sorted = static_cast<Range*>(RegistryAlloc(n * sizeof(Range)));
+  *m = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (ranges[i].size == 0) continue;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(ranges[i].ptr);
+    sorted[(*m)++] = {start, start + ranges[i].size};
+  }
+  std::sort(sorted, sorted + *m, StartsBefore);
+  return sorted;
+}
+
+void Register(RangeSet* set, const LeakCheckRange* ranges, size_t n) {
+  if (n == 0) return;
+  base_internal::SpinLockHolder l(&registry_lock);
+  size_t m;
+  Range* sorted = SortRanges(ranges, n, &m);
+  set->Insert(sorted, m);
+  LowLevelAlloc::Free(sorted);
+  // The leak sanitizer has no batch interface.
+  for (size_t i = 0; i < n; ++i) {
+    if (ranges[i].size != 0) {
+      RegisterLivePointers(ranges[i].ptr, ranges[i].size);
+    }
+  }
+}
+
+void UnRegister(RangeSet* set, const LeakCheckRange* ranges, size_t n) {
+  if (n == 0) return;
+  base_internal::SpinLockHolder s(&scan_lock);
+  base_internal::SpinLockHolder l(&registry_lock);
+  size_t m;
+  Range* sorted = SortRanges(ranges, n, &m);
+  set->RemoveWithin(sorted, m);
+  LowLevelAlloc::Free(sorted);
+}
+
+void RegisterRegion(const void* region, size_t size) {
+  const LeakCheckRange range = {region, size};
+  RegisterLivePointerRanges(&range, 1);
+}
+
+void UnRegisterRegion(const void* region, size_t size) {
+  const LeakCheckRange range = {region, size};
+  UnRegisterLivePointerRanges(&range, 1);
+}
+
+// The state of one GetArenaReachability() scan.
+struct Scan {
+  const Range* blocks;  // A copy of the arena blocks, sorted by start.
+  size_t num_blocks;
+  uintptr_t lo;         // No arena block starts below `lo`...
+  uintptr_t hi;         // ...or ends above `hi`.
+  bool* marked;         // Whether each arena block has been reached.
+  size_t* reached;      // The indices of the reached blocks, in order reached.
+  size_t num_reached;
+};
+
+// Marks the arena blocks that the aligned words of `r` point into.
+ABSL_ATTRIBUTE_NO_SANITIZE_ADDRESS
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY
+void ScanRange(const Range& r, Scan* scan) EXCLUSIVE_LOCKS_REQUIRED(scan_lock) {
+  constexpr uintptr_t kAlign = alignof(void*);
+  for (uintptr_t p = (r.start + kAlign - 1) & ~(kAlign - 1);
+       p + sizeof(void*) <= r.end; p += kAlign) {
+    const uintptr_t value = *reinterpret_cast<const uintptr_t*>(p);
+    if (value < scan->lo || value >= scan->hi) continue;
+    const ptrdiff_t block = FindRange(scan->blocks, scan->num_blocks, value);
+    if (block < 0 || scan->marked[block]) continue;
+    scan->marked[block] = true;
+    scan->reached[scan->num_reached++] = block;
+  }
+}
+
+class Accountant {
+ public:
+  // Starts accounting, unless it is running already.
+  bool Start(absl::Duration period,
+             void (*callback)(const ArenaReachability&));
+  void Stop();
+
+ private:
+  // Body of the accounting thread.
+  void Run(absl::Duration period, void (*callback)(const ArenaReachability&));
+
+  absl::Mutex control_mu_;  // Serializes Start() and Stop().
+  std::thread thread_;      // Guarded by control_mu_.
+
+  absl::Mutex mu_;
+  bool stopping_ GUARDED_BY(mu_) = false;
+};
+
+bool Accountant::Start(absl::Duration period,
+                       void (*callback)(const ArenaReachability&)) {
+  absl::MutexLock control_lock(&control_mu_);
+  if (thread_.joinable()) return false;
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&Accountant::Run, this, period, callback);
+  return true;
+}
+
+void Accountant::Stop() {
+  absl::MutexLock control_lock(&control_mu_);
+  if (!thread_.joinable()) return;
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  thread_.join();
+}
+
+void Accountant::Run(absl::Duration period,
+                     void (*callback)(const ArenaReachability&)) {
+  absl::MutexLock lock(&mu_);
+  while (!mu_.AwaitWithTimeout(absl::Condition(&stopping_), period)) {
+    const ArenaReachability result = GetArenaReachability();
+    if (callback != nullptr) {
+      callback(result);
+      continue;
+    }
+    ABSL_RAW_LOG(INFO,
+                 "Arena leak accounting: %zu of %zu bytes in %zu of %zu arena "
+                 "blocks reachable from %zu bytes of roots",
+                 result.reachable_bytes, result.arena_bytes,
+                 result.reachable_blocks, result.arena_blocks,
+                 result.root_bytes);
+  }
+}
+
+Accountant* GetAccountant() {
+  static Accountant* accountant = new Accountant;
+  return accountant;
+}
+
+}  // namespace
+
+void RegisterLivePointerRanges(const LeakCheckRange* ranges, size_t n) {
+  Register(&live_ranges, ranges, n);
+}
+
+void UnRegisterLivePointerRanges(const LeakCheckRange* ranges, size_t n) {
+  UnRegister(&live_ranges, ranges, n);
+}
+
+void RegisterArenaBlocks(const LeakCheckRange* ranges, size_t n) {
+  Register(&arena_blocks, ranges, n);
+}
+
+void UnRegisterArenaBlocks(const LeakCheckRange* ranges, size_t n) {
+  UnRegister(&arena_blocks, ranges, n);
+}
+
+void RegisterLowLevelAllocArenas() {
+  LowLevelAlloc::SetRegionHooks(RegisterRegion, UnRegisterRegion);
+}
+
+ArenaReachability GetArenaReachability() {
+  ArenaReachability result = {};
+  base_internal::SpinLockHolder s(&scan_lock);
+  // Scan a copy of the ranges, so that arenas registering memory as they
+  // allocate don't wait for the scan.
+  size_t num_roots;
+  Range* ranges;
+  Scan scan;
+  {
+    base_internal::SpinLockHolder l(&registry_lock);
+    num_roots = live_ranges.size();
+    for (size_t i = 0; i < num_roots; ++i) {
+      result.root_bytes += live_ranges[i].end - live_ranges[i].start;
+    }
+    scan.num_blocks = arena_blocks.size();
+    if (scan.num_blocks == 0) return result;
+    ranges = static_cast<Range*>(
+        RegistryAlloc((num_roots + scan.num_blocks) * sizeof(Range)));
+    std::copy(live_ranges.data(), live_ranges.data() + num_roots, ranges);
+    std::copy(arena_blocks.data(), arena_blocks.data() + scan.num_blocks,
+              ranges + num_roots);
+    scan.marked =
+        static_cast<bool*>(RegistryAlloc(scan.num_blocks * sizeof(bool)));
+    scan.reached =
+        static_cast<size_t*>(RegistryAlloc(scan.num_blocks * sizeof(size_t)));
+  }
+  scan.blocks = ranges + num_roots;
+  result.arena_blocks = scan.num_blocks;
+  scan.lo = scan.blocks[0].start;
+  scan.hi = 0;
+  for (size_t i = 0; i < scan.num_blocks; ++i) {
+    result.arena_bytes += scan.blocks[i].end - scan.blocks[i].start;
+    scan.hi = std::max(scan.hi, scan.blocks[i].end);
+  }
+  memset(scan.marked, 0, scan.num_blocks * sizeof(bool));
+  scan.num_reached = 0;
+  // Reach blocks from the roots, then from the reached blocks in turn.
+  for (size_t i = 0; i < num_roots; ++i) {
+    ScanRange(ranges[i], &scan);
+  }
+  for (size_t i = 0; i < scan.num_reached; ++i) {
+    ScanRange(scan.blocks[scan.reached[i]], &scan);
+  }
+  result.reachable_blocks = scan.num_reached;
+  for (size_t i = 0; i < scan.num_reached; ++i) {
+    const Range& block = scan.blocks[scan.reached[i]];
+    result.reachable_bytes += block.end - block.start;
+  }
+  LowLevelAlloc::Free(scan.reached);
+  LowLevelAlloc::Free(scan.marked);
+  LowLevelAlloc::Free(ranges);
+  return result;
+}
+
+bool StartArenaLeakAccounting(absl::Duration period,
+                              void (*callback)(const ArenaReachability&)) {
+  return GetAccountant()->Start(period, callback);
+}
+
+void StopArenaLeakAccounting() { GetAccountant()->Stop(); }
+
+}  // namespace absl
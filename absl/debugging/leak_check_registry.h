@@ -0,0 +1,137 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: leak_check_registry.h
+// -----------------------------------------------------------------------------
+//
+// This file declares a registry of memory that a leak checker can't see into
+// by itself: memory mapped outside of malloc() that holds pointers, and the
+// blocks of arenas that carve many objects out of one allocation.
+//
+// Ranges of memory that hold pointers are registered as "live pointer
+// ranges", which, like `RegisterLivePointers()`, keep what they point to from
+// being reported as leaks by the LeakSanitizer. Arenas register the blocks
+// they allocate objects from as "arena blocks". In any build, with or without
+// a leak sanitizer, `GetArenaReachability()` then counts the arena bytes that
+// can still be reached from the live pointer ranges; the rest has leaked.
+//
+// Example:
+//
+//   // In an arena that has just allocated `block`.
+//   absl::LeakCheckRange range = {block, block_size};
+//   absl::RegisterArenaBlocks(&range, 1);
+//
+//   // Report the arena memory reachable from registered roots every minute.
+//   absl::StartArenaLeakAccounting(absl::Minutes(1), nullptr);
+//
+// Ranges are kept sorted, so registering or unregistering many at once costs
+// about as much as registering one.
+
+#ifndef ABSL_DEBUGGING_LEAK_CHECK_REGISTRY_H_
+#define ABSL_DEBUGGING_LEAK_CHECK_REGISTRY_H_
+
+#include <cstddef>
+
+#include "absl/time/time.h"
+
+namespace absl {
+
+// LeakCheckRange
+//
+// The `size` bytes of memory at `ptr`.
+struct LeakCheckRange {
+  const void* ptr;
+  size_t size;
+};
+
+// RegisterLivePointerRanges()
+//
+// Registers each of `ranges[0, n)` as with `RegisterLivePointers()`: as memory
+// holding pointers that keep what they point to alive. The ranges are also
+// the roots from which `GetArenaReachability()` looks for arena blocks. They
+// must stay readable until they are unregistered.
+void RegisterLivePointerRanges(const LeakCheckRange* ranges, size_t n);
+
+// UnRegisterLivePointerRanges()
+//
+// Unregisters every live pointer range that lies within one of
+// `ranges[0, n)`.
+void UnRegisterLivePointerRanges(const LeakCheckRange* ranges, size_t n);
+
+// RegisterArenaBlocks()
+//
+// Registers each of `ranges[0, n)` as a block that an arena allocates objects
+// from. Under a leak sanitizer, pointers in the blocks keep what they point
+// to alive, as they would if the objects had come from malloc(); blocks that
+// have leaked are found by `GetArenaReachability()` instead. Arena blocks
+// must not overlap one another, and must stay readable until they are
+// unregistered.
+void RegisterArenaBlocks(const LeakCheckRange* ranges, size_t n);
+
+// UnRegisterArenaBlocks()
+//
+// Unregisters every arena block that lies within one of `ranges[0, n)`.
+void UnRegisterArenaBlocks(const LeakCheckRange* ranges, size_t n);
+
+// RegisterLowLevelAllocArenas()
+//
+// Registers the regions that Abseil's internal arenas created with
+// `LowLevelAlloc::kReportRegions` map from now on as live pointer ranges,
+// and unregisters them as the arenas are deleted. The arena holding the
+// graph that Mutex deadlock detection keeps is one of them.
+void RegisterLowLevelAllocArenas();
+
+// ArenaReachability
+//
+// The result of `GetArenaReachability()`.
+struct ArenaReachability {
+  size_t root_bytes;        // Bytes in live pointer ranges.
+  size_t arena_blocks;      // Registered arena blocks.
+  size_t arena_bytes;       // Bytes in registered arena blocks.
+  size_t reachable_blocks;  // Arena blocks reachable from the roots.
+  size_t reachable_bytes;   // Bytes in the reachable arena blocks.
+};
+
+// GetArenaReachability()
+//
+// Scans the live pointer ranges for pointers into arena blocks, and the
+// blocks so found for pointers into others, and returns how much of the
+// arena memory was reached. Any pointer into a block reaches all of it.
+//
+// A block that can't be reached has leaked, unless the program keeps a
+// pointer to it somewhere that isn't registered, such as the stack, a global
+// variable or the heap. The scan works on a copy of the registered ranges:
+// ranges registered meanwhile are not scanned, and unregistering ranges waits
+// for it to finish. The memory scanned may change, so the result is
+// approximate while other threads run.
+ArenaReachability GetArenaReachability();
+
+// StartArenaLeakAccounting()
+//
+// Starts a thread that calls `GetArenaReachability()` every `period` and
+// passes the result to `callback`, or logs it if `callback` is null. Returns
+// false if accounting is already running.
+bool StartArenaLeakAccounting(absl::Duration period,
+                              void (*callback)(const ArenaReachability&));
+
+// StopArenaLeakAccounting()
+//
+// Stops the thread started by `StartArenaLeakAccounting()` and waits for any
+// call to its callback to return. Does nothing if accounting isn't running.
+void StopArenaLeakAccounting();
+
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_LEAK_CHECK_REGISTRY_H_
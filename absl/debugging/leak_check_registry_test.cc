@@ -0,0 +1,228 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/leak_check_registry.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "absl/base/internal/low_level_alloc.h"
+#include "absl/synchronization/internal/graphcycles.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+
+namespace {
+
+using absl::base_internal::LowLevelAlloc;
+
+// Blocks of a pretend arena, each able to hold pointers to others.
+struct Block {
+  Block* next[4];
+  char payload[64];
+};
+
+TEST(LeakCheckRegistryTest, ReachabilityFollowsPointersFromRoots) {
+  static Block blocks[8];
+  static Block* roots[2];
+  memset(blocks, 0, sizeof(blocks));
+  absl::LeakCheckRange block_ranges[8];
+  for (int i = 0; i < 8; ++i) {
+    // Registered in reverse order, which the registry sorts out.
+    block_ranges[i] = {&blocks[7 - i], sizeof(Block)};
+  }
+  absl::RegisterArenaBlocks(block_ranges, 8);
+
+  // roots -> 0 -> 1 -> 2, 0 -> 3 (interior pointer), 4 -> 5 with 4 and 5
+  // unreachable, and 6 and 7 referenced by nothing.
+  roots[0] = &blocks[0];
+  roots[1] = nullptr;
+  blocks[0].next[0] = &blocks[1];
+  blocks[1].next[0] = &blocks[2];
+  blocks[0].next[1] =
+      reinterpret_cast<Block*>(&blocks[3].payload[10]);
+  blocks[4].next[0] = &blocks[5];
+  const absl::LeakCheckRange root_range = {roots, sizeof(roots)};
+  absl::RegisterLivePointerRanges(&root_range, 1);
+
+  absl::ArenaReachability result = absl::GetArenaReachability();
+  EXPECT_EQ(sizeof(roots), result.root_bytes);
+  EXPECT_EQ(8u, result.arena_blocks);
+  EXPECT_EQ(8 * sizeof(Block), result.arena_bytes);
+  EXPECT_EQ(4u, result.reachable_blocks);
+  EXPECT_EQ(4 * sizeof(Block), result.reachable_bytes);
+
+  // A second root reaches the rest of the 4 -> 5 chain.
+  roots[1] = &blocks[4];
+  result = absl::GetArenaReachability();
+  EXPECT_EQ(6u, result.reachable_blocks);
+
+  // Cutting the chain from the first root leaks its tail.
+  blocks[0].next[0] = nullptr;
+  result = absl::GetArenaReachability();
+  EXPECT_EQ(4u, result.reachable_blocks);
+
+  absl::UnRegisterLivePointerRanges(&root_range, 1);
+  result = absl::GetArenaReachability();
+  EXPECT_EQ(0u, result.root_bytes);
+  EXPECT_EQ(0u, result.reachable_blocks);
+
+  // All the blocks lie within one range spanning the array.
+  const absl::LeakCheckRange all = {blocks, sizeof(blocks)};
+  absl::UnRegisterArenaBlocks(&all, 1);
+  result = absl::GetArenaReachability();
+  EXPECT_EQ(0u, result.arena_blocks);
+  EXPECT_EQ(0u, result.arena_bytes);
+}
+
+TEST(LeakCheckRegistryTest, UnRegisterRemovesOnlyRangesWithin) {
+  static char memory[1024];
+  absl::LeakCheckRange ranges[4] = {{memory, 100},
+                                    {memory + 100, 100},
+                                    {memory + 500, 200},
+                                    {memory + 900, 100}};
+  absl::RegisterArenaBlocks(ranges, 4);
+  EXPECT_EQ(4u, absl::GetArenaReachability().arena_blocks);
+
+  // Covers the first two blocks and part of the third.
+  const absl::LeakCheckRange prefix = {memory, 600};
+  absl::UnRegisterArenaBlocks(&prefix, 1);
+  absl::ArenaReachability result = absl::GetArenaReachability();
+  EXPECT_EQ(2u, result.arena_blocks);
+  EXPECT_EQ(300u, result.arena_bytes);
+
+  absl::UnRegisterArenaBlocks(&ranges[2], 2);
+  EXPECT_EQ(0u, absl::GetArenaReachability().arena_blocks);
+}
+
+TEST(LeakCheckRegistryTest, ManyRangesInBulk) {
+  constexpr int kBlocks = 1000;
+  static Block blocks[kBlocks];
+  static absl::LeakCheckRange ranges[kBlocks];
+  for (int i = 0; i < kBlocks; ++i) {
+    // An order that is neither sorted nor reversed.
+    const int b = (i * 337) % kBlocks;
+    ranges[i] = {&blocks[b], sizeof(Block)};
+  }
+  // Registers in batches of different sizes, so that the set grows both in
+  // place and by reallocation.
+  absl::RegisterArenaBlocks(ranges, 1);
+  absl::RegisterArenaBlocks(ranges + 1, 10);
+  absl::RegisterArenaBlocks(ranges + 11, kBlocks - 11);
+  ASSERT_EQ(static_cast<size_t>(kBlocks),
+            absl::GetArenaReachability().arena_blocks);
+
+  // Unregisters every other block.
+  static absl::LeakCheckRange odd[kBlocks / 2];
+  for (int i = 0; i < kBlocks / 2; ++i) {
+    odd[i] = {&blocks[2 * i + 1], sizeof(Block)};
+  }
+  absl::UnRegisterArenaBlocks(odd, kBlocks / 2);
+  ASSERT_EQ(static_cast<size_t>(kBlocks / 2),
+            absl::GetArenaReachability().arena_blocks);
+
+  const absl::LeakCheckRange all = {blocks, sizeof(blocks)};
+  absl::UnRegisterArenaBlocks(&all, 1);
+  EXPECT_EQ(0u, absl::GetArenaReachability().arena_blocks);
+}
+
+TEST(LeakCheckRegistryTest, LowLevelAllocRegionsAreRoots) {
+  static Block block;
+  const absl::LeakCheckRange block_range = {&block, sizeof(block)};
+  absl::RegisterArenaBlocks(&block_range, 1);
+
+  absl::RegisterLowLevelAllocArenas();
+  LowLevelAlloc::Arena* arena =
+      LowLevelAlloc::NewArena(LowLevelAlloc::kReportRegions);
+  Block** holder =
+      static_cast<Block**>(LowLevelAlloc::AllocWithArena(sizeof(Block*), arena));
+  *holder = &block;
+  absl::ArenaReachability result = absl::GetArenaReachability();
+  EXPECT_GT(result.root_bytes, 0u);
+  EXPECT_EQ(1u, result.reachable_blocks);
+
+  *holder = nullptr;
+  EXPECT_EQ(0u, absl::GetArenaReachability().reachable_blocks);
+
+  // Deleting the arena unregisters its regions.
+  LowLevelAlloc::Free(holder);
+  ASSERT_TRUE(LowLevelAlloc::DeleteArena(arena));
+  EXPECT_EQ(0u, absl::GetArenaReachability().root_bytes);
+
+  // Arenas without kReportRegions are not reported.
+  arena = LowLevelAlloc::NewArena(0);
+  void* p = LowLevelAlloc::AllocWithArena(64, arena);
+  EXPECT_EQ(0u, absl::GetArenaReachability().root_bytes);
+  LowLevelAlloc::Free(p);
+  ASSERT_TRUE(LowLevelAlloc::DeleteArena(arena));
+
+  absl::UnRegisterArenaBlocks(&block_range, 1);
+}
+
+TEST(LeakCheckRegistryTest, DeadlockGraphRegionsAreRoots) {
+  absl::RegisterLowLevelAllocArenas();
+  const size_t root_bytes = absl::GetArenaReachability().root_bytes;
+  // Enough nodes to make the graph's arena map more memory.
+  static char nodes[10000];
+  absl::synchronization_internal::GraphCycles graph;
+  for (char& node : nodes) graph.GetId(&node);
+  EXPECT_GT(absl::GetArenaReachability().root_bytes, root_bytes);
+}
+
+#if GTEST_HAS_DEATH_TEST && \
+    !defined(ABSL_LOW_LEVEL_ALLOC_ASYNC_SIGNAL_SAFE_MISSING)
+TEST(LeakCheckRegistryDeathTest, ReportRegionsIsNotAsyncSignalSafe) {
+  // The region hooks lock and allocate, which a signal handler can't do.
+  EXPECT_DEATH(LowLevelAlloc::NewArena(LowLevelAlloc::kAsyncSignalSafe |
+                                       LowLevelAlloc::kReportRegions),
+               "kReportRegions");
+}
+#endif
+
+std::atomic<int> accounting_calls(0);
+absl::Notification* accounted = nullptr;
+
+void CountAccounting(const absl::ArenaReachability& result) {
+  EXPECT_EQ(1u, result.arena_blocks);
+  if (accounting_calls.fetch_add(1) == 1) accounted->Notify();
+}
+
+TEST(LeakCheckRegistryTest, PeriodicAccounting) {
+  static Block block;
+  const absl::LeakCheckRange block_range = {&block, sizeof(block)};
+  absl::RegisterArenaBlocks(&block_range, 1);
+
+  absl::Notification notification;
+  accounted = &notification;
+  ASSERT_TRUE(
+      absl::StartArenaLeakAccounting(absl::Milliseconds(1), CountAccounting));
+  EXPECT_FALSE(
+      absl::StartArenaLeakAccounting(absl::Milliseconds(1), CountAccounting));
+  notification.WaitForNotification();
+  absl::StopArenaLeakAccounting();
+  const int calls = accounting_calls.load();
+  EXPECT_GE(calls, 2);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(calls, accounting_calls.load());
+  absl::StopArenaLeakAccounting();  // Does nothing.
+
+  // Accounting can be restarted, and logs without a callback.
+  ASSERT_TRUE(absl::StartArenaLeakAccounting(absl::Milliseconds(1), nullptr));
+  absl::SleepFor(absl::Milliseconds(5));
+  absl::StopArenaLeakAccounting();
+
+  absl::UnRegisterArenaBlocks(&block_range, 1);
+}
+
+}  // namespace
@@ -103,6 +103,19 @@ int GetStackTraceWithContext(void** result, int max_depth, int skip_count,
                              min_dropped_frames);
 }
 
+int GetStackTraceFast(void** result, int max_depth, int skip_count) {
+  // Add 1 to skip count for this function, the first frame UnwindImpl sees.
+#ifdef ABSL_STACKTRACE_HAVE_FAST_UNWIND
+  int size = UnwindImpl<false, false, false>(result, nullptr, max_depth,
+                                             skip_count + 1, nullptr, nullptr);
+#else
+  int size = UnwindImpl<false, false>(result, nullptr, max_depth,
+                                      skip_count + 1, nullptr, nullptr);
+#endif
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return size;
+}
+
 void SetStackUnwinder(Unwinder w) {
   custom.store(w, std::memory_order_release);
 }
@@ -104,6 +104,20 @@ extern int GetStackTraceWithContext(void** result, int max_depth,
                                     int skip_count, const void* uc,
                                     int* min_dropped_frames);
 
+// Same as absl::GetStackTrace(), but for callers that take stack traces very
+// often, such as sampling profilers. Where the built-in unwinder follows frame
+// pointers (x86), this follows them alone: it makes no system calls, does not
+// consult the vDSO, and stops at the first frame that does not look like a
+// caller's frame on the current thread's stack. It ignores any unwinder set
+// with absl::SetStackUnwinder(). Elsewhere it is equivalent to
+// absl::DefaultStackUnwinder() with null "sizes" and "uc".
+//
+// The functions above look up the bounds of the current thread's stack the
+// first time they unwind it; after that, this function follows frames of any
+// size within them. Until then, a frame larger than 100,000 bytes ends the
+// trace, as does code built without frame pointers.
+extern int GetStackTraceFast(void** result, int max_depth, int skip_count);
+
 // Call this to provide a custom function for unwinding stack frames
 // that will be used every time someone invokes one of the static
 // GetStack{Frames,Trace}{,WithContext}() functions above.
@@ -0,0 +1,265 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the frame-pointer unwinder against glibc's backtrace(), which
+// unwinds with DWARF CFI, on generated call chains and through signal frames.
+// Both must be built with frame pointers for the two to agree.
+
+#include "absl/debugging/stacktrace.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
+#include "absl/debugging/internal/examine_stack.h"
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace absl {
+namespace debugging_internal {
+bool StackTraceWorksForTest();
+}  // namespace debugging_internal
+}  // namespace absl
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+struct Traces {
+  void* pcs[kMaxDepth];
+  int depth;
+  void* frames[kMaxDepth];
+  int sizes[kMaxDepth];
+  int frames_depth;
+  void* backtrace[kMaxDepth];
+  int backtrace_depth;
+};
+Traces traces;
+
+// Records the stack with each unwinder.
+ABSL_ATTRIBUTE_NOINLINE int CaptureAll() {
+  traces.depth = absl::GetStackTrace(traces.pcs, kMaxDepth, 0);
+  traces.frames_depth =
+      absl::GetStackFrames(traces.frames, traces.sizes, kMaxDepth, 0);
+  traces.backtrace_depth = backtrace(traces.backtrace, kMaxDepth);
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return 0;
+}
+
+using Leaf = int (*)();
+
+// A generated call chain is `depth` frames of SmallFrame() and LargeFrame(),
+// chosen by the low bits of `shape`, with `leaf` called from the innermost.
+int SmallFrame(int depth, unsigned shape, Leaf leaf);
+int LargeFrame(int depth, unsigned shape, Leaf leaf);
+
+ABSL_ATTRIBUTE_ALWAYS_INLINE inline int Next(int depth, unsigned shape,
+                                             Leaf leaf) {
+  if (depth == 0) return leaf();
+  return (shape & 1) ? LargeFrame(depth - 1, shape >> 1, leaf)
+                     : SmallFrame(depth - 1, shape >> 1, leaf);
+}
+
+ABSL_ATTRIBUTE_NOINLINE int SmallFrame(int depth, unsigned shape, Leaf leaf) {
+  int result = Next(depth, shape, leaf);
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return result;
+}
+
+ABSL_ATTRIBUTE_NOINLINE int LargeFrame(int depth, unsigned shape, Leaf leaf) {
+  volatile char buffer[4096];
+  buffer[0] = static_cast<char>(depth);
+  int result = Next(depth, shape, leaf) + buffer[0];
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return result;
+}
+
+// The outermost frame of a chain, so that every chain ends in a return
+// address in code built with frame pointers.
+ABSL_ATTRIBUTE_NOINLINE int RunChain(int depth, unsigned shape, Leaf leaf) {
+  int result = Next(depth, shape, leaf);
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return result;
+}
+
+// Returns the index of `pc` in `pcs[0, depth)`, or `depth` if it is absent.
+int Find(void* const* pcs, int depth, void* pc) {
+  int i = 0;
+  while (i < depth && pcs[i] != pc) ++i;
+  return i;
+}
+
+// Expects `pcs[from, from + n)` to equal `expected[expected_from, ...)`.
+void ExpectFramesMatch(void* const* pcs, int depth, int from,
+                       void* const* expected, int expected_depth,
+                       int expected_from, int n) {
+  ASSERT_LE(from + n, depth);
+  ASSERT_LE(expected_from + n, expected_depth);
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(expected[expected_from + i], pcs[from + i]) << "frame " << i;
+  }
+}
+
+TEST(StackTraceBacktrace, GeneratedChains) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  void* warm[1];
+  backtrace(warm, 1);  // Loads libgcc_s.
+  for (int depth : {0, 1, 2, 7, 20, 50}) {
+    for (unsigned shape : {0x0u, 0xffffffffu, 0x5555u, 0x9c3au}) {
+      SCOPED_TRACE(testing::Message() << "depth " << depth << " shape "
+                                      << shape);
+      memset(&traces, 0, sizeof(traces));
+      RunChain(depth, shape, CaptureAll);
+      // backtrace() starts with its call site in CaptureAll(). Whether the
+      // unwinders include the call site of theirs depends on whether they
+      // were built with frame pointers, so compare from the return address
+      // into the chain, through the one into RunChain().
+      ASSERT_GE(traces.backtrace_depth, 2);
+      const int from = Find(traces.pcs, traces.depth, traces.backtrace[1]);
+      ASSERT_LE(from, 1);
+      ExpectFramesMatch(traces.pcs, traces.depth, from, traces.backtrace,
+                        traces.backtrace_depth, 1, depth + 1);
+      const int frames_from =
+          Find(traces.frames, traces.frames_depth, traces.backtrace[1]);
+      ASSERT_EQ(from, frames_from);
+      ExpectFramesMatch(traces.frames, traces.frames_depth, from,
+                        traces.backtrace, traces.backtrace_depth, 1,
+                        depth + 1);
+      // The frame of a LargeFrame() holds its buffer. The i-th innermost
+      // chain frame was chosen by bit `depth - 1 - i` of `shape`; frames past
+      // the 32nd are all SmallFrame()s.
+      for (int i = 0; i < depth; ++i) {
+        const int bit = depth - 1 - i;
+        if (bit < 32 && ((shape >> bit) & 1)) {
+          EXPECT_GE(traces.sizes[from + i], 4096) << "frame " << i;
+        }
+      }
+    }
+  }
+}
+
+// A signal delivered to a thread spinning at the end of a call chain.
+struct SignalTrace {
+  void* pcs[kMaxDepth];
+  int depth;
+  void* backtrace[kMaxDepth];
+  int backtrace_depth;
+};
+SignalTrace signal_trace;
+std::atomic<bool> spinning(false);
+std::atomic<bool> captured(false);
+
+void CaptureSignalStack(int, siginfo_t*, void* vuc) {
+  signal_trace.depth = absl::debug_internal::GetSignalStackTrace(
+      signal_trace.pcs, kMaxDepth, vuc);
+  signal_trace.backtrace_depth = backtrace(signal_trace.backtrace, kMaxDepth);
+  captured.store(true, std::memory_order_release);
+}
+
+ABSL_ATTRIBUTE_NOINLINE void StartSpinning() {
+  spinning.store(true, std::memory_order_release);
+}
+
+// Spins until the signal handler has run. Spin() calls a function so that it
+// sets up a frame: the caller of a leaf function without one can't be seen
+// from the signal handler.
+ABSL_ATTRIBUTE_NOINLINE int Spin() {
+  StartSpinning();
+  while (!captured.load(std::memory_order_acquire)) {
+  }
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return 0;
+}
+
+// Interrupts a thread spinning at the end of a chain of `depth` frames and
+// checks that GetSignalStackTrace() agrees with backtrace() from the
+// interrupted pc to RunChain(). backtrace() also reports the handler and
+// the signal trampoline, which GetSignalStackTrace() omits.
+void CheckSignalStack(int depth, unsigned shape, bool alternate_stack) {
+  SCOPED_TRACE(testing::Message() << "depth " << depth << " shape " << shape);
+  memset(&signal_trace, 0, sizeof(signal_trace));
+  spinning.store(false);
+  captured.store(false);
+
+  struct sigaction action, old_action;
+  memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_sigaction = CaptureSignalStack;
+  action.sa_flags = SA_SIGINFO | (alternate_stack ? SA_ONSTACK : 0);
+  ASSERT_EQ(0, sigaction(SIGUSR2, &action, &old_action));
+
+  std::vector<char> altstack(1 << 16);
+  std::thread thread([&]() {
+    if (alternate_stack) {
+      stack_t ss;
+      memset(&ss, 0, sizeof(ss));
+      ss.ss_sp = altstack.data();
+      ss.ss_size = altstack.size();
+      sigaltstack(&ss, nullptr);
+    }
+    RunChain(depth, shape, Spin);
+    if (alternate_stack) {
+      stack_t ss;
+      memset(&ss, 0, sizeof(ss));
+      ss.ss_flags = SS_DISABLE;
+      sigaltstack(&ss, nullptr);
+    }
+  });
+  while (!spinning.load(std::memory_order_acquire)) {
+  }
+  pthread_kill(thread.native_handle(), SIGUSR2);
+  thread.join();
+  sigaction(SIGUSR2, &old_action, nullptr);
+
+  // backtrace() reports the interrupted pc itself, not a return address.
+  const int start = Find(signal_trace.backtrace, signal_trace.backtrace_depth,
+                         signal_trace.pcs[0]);
+  ASSERT_LT(start, signal_trace.backtrace_depth)
+      << "backtrace() did not reach the interrupted pc";
+  // The interrupted pc in Spin(), the return addresses into the chain, and
+  // the return address into RunChain().
+  ExpectFramesMatch(signal_trace.pcs, signal_trace.depth, 0,
+                    signal_trace.backtrace, signal_trace.backtrace_depth,
+                    start, depth + 2);
+}
+
+TEST(StackTraceBacktrace, SignalFrames) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  void* warm[1];
+  backtrace(warm, 1);  // Loads libgcc_s outside the signal handler.
+  for (int depth : {0, 3, 20}) {
+    CheckSignalStack(depth, 0x5555u, false);
+  }
+}
+
+TEST(StackTraceBacktrace, SignalFramesOnAlternateStack) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  void* warm[1];
+  backtrace(warm, 1);
+  for (int depth : {0, 3, 20}) {
+    CheckSignalStack(depth, 0x5555u, true);
+  }
+}
+
+}  // namespace
+
+#endif  // defined(__linux__) && defined(__GLIBC__)
@@ -0,0 +1,218 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/stacktrace.h"
+
+#if defined(__linux__)
+#include <ucontext.h>
+#endif
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+#include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
+#include "absl/debugging/internal/vdso_support.h"
+#include "absl/debugging/symbolize.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Large enough to hold every frame at the deepest benchmarked depth, plus
+// those of the benchmark library and main().
+constexpr int kMaxDepth = 128;
+
+using Body = void (*)(benchmark::State&);
+
+// Calls `body` from `depth` frames below the caller, so that every
+// benchmark below unwinds through state.range(0) frames more than the
+// benchmark library's own.
+ABSL_ATTRIBUTE_NOINLINE void AtDepth(benchmark::State& state, int depth,
+                                     Body body) {
+  if (depth > 0) {
+    AtDepth(state, depth - 1, body);
+  } else {
+    body(state);
+  }
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+}
+
+void StackDepths(benchmark::internal::Benchmark* benchmark) {
+  for (int depth : {1, 8, 32, 64}) benchmark->Arg(depth);
+}
+
+void GetStackTraceBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::GetStackTrace(pcs, kMaxDepth, 0));
+  }
+}
+
+void BM_GetStackTrace(benchmark::State& state) {
+  AtDepth(state, state.range(0), GetStackTraceBody);
+}
+BENCHMARK(BM_GetStackTrace)->Apply(StackDepths);
+
+void GetStackTraceFastBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::GetStackTraceFast(pcs, kMaxDepth, 0));
+  }
+}
+
+void BM_GetStackTraceFast(benchmark::State& state) {
+  AtDepth(state, state.range(0), GetStackTraceFastBody);
+}
+BENCHMARK(BM_GetStackTraceFast)->Apply(StackDepths);
+
+void GetStackFramesBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  int sizes[kMaxDepth];
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::GetStackFrames(pcs, sizes, kMaxDepth, 0));
+  }
+}
+
+void BM_GetStackFrames(benchmark::State& state) {
+  AtDepth(state, state.range(0), GetStackFramesBody);
+}
+BENCHMARK(BM_GetStackFrames)->Apply(StackDepths);
+
+// Passing a context selects the unwinder that checks each frame for the
+// signal trampoline. A context from getcontext() has no signal frame in it,
+// so this measures only that overhead.
+#if defined(__linux__)
+void GetStackTraceWithContextBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  ucontext_t uc;
+  getcontext(&uc);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::GetStackTraceWithContext(pcs, kMaxDepth, 0, &uc, nullptr));
+  }
+}
+
+void BM_GetStackTraceWithContext(benchmark::State& state) {
+  AtDepth(state, state.range(0), GetStackTraceWithContextBody);
+}
+BENCHMARK(BM_GetStackTraceWithContext)->Apply(StackDepths);
+#endif  // __linux__
+
+// Keeps only the innermost frames but counts the rest, as a sampling
+// profiler with a small buffer would.
+void GetStackTraceCountDroppedBody(benchmark::State& state) {
+  void* pcs[4];
+  int dropped;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::GetStackTraceWithContext(pcs, 4, 0, nullptr, &dropped));
+  }
+}
+
+void BM_GetStackTraceCountDropped(benchmark::State& state) {
+  AtDepth(state, state.range(0), GetStackTraceCountDroppedBody);
+}
+BENCHMARK(BM_GetStackTraceCountDropped)->Apply(StackDepths);
+
+// glibc's backtrace() unwinds with DWARF CFI, as a baseline for the above.
+#if defined(__GLIBC__)
+void BacktraceBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(backtrace(pcs, kMaxDepth));
+  }
+}
+
+void BM_Backtrace(benchmark::State& state) {
+  AtDepth(state, state.range(0), BacktraceBody);
+}
+BENCHMARK(BM_Backtrace)->Apply(StackDepths);
+#endif  // __GLIBC__
+
+void BM_Symbolize(benchmark::State& state) {
+  char name[1024];
+  const void* pc = reinterpret_cast<const void*>(&BM_Symbolize);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::Symbolize(pc, name, sizeof(name)));
+  }
+}
+BENCHMARK(BM_Symbolize);
+
+// Symbolizes a whole stack, most of whose frames are in other objects.
+void SymbolizeStackBody(benchmark::State& state) {
+  void* pcs[kMaxDepth];
+  const int depth = absl::GetStackTrace(pcs, kMaxDepth, 0);
+  char name[1024];
+  while (state.KeepRunning()) {
+    for (int i = 0; i < depth; ++i) {
+      benchmark::DoNotOptimize(absl::Symbolize(pcs[i], name, sizeof(name)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+
+void BM_SymbolizeStack(benchmark::State& state) {
+  AtDepth(state, state.range(0), SymbolizeStackBody);
+}
+BENCHMARK(BM_SymbolizeStack)->Arg(8);
+
+#ifdef ABSL_HAVE_VDSO_SUPPORT
+
+// The unwinder looks up the signal trampoline in the vDSO, and GetCPU()
+// looks up __vdso_getcpu.
+void BM_VDSOSupport_Construct(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    absl::debug_internal::VDSOSupport vdso;
+    benchmark::DoNotOptimize(vdso.IsPresent());
+  }
+}
+BENCHMARK(BM_VDSOSupport_Construct);
+
+void BM_VDSOSupport_LookupSymbol(benchmark::State& state) {
+  absl::debug_internal::VDSOSupport vdso;
+  absl::debug_internal::VDSOSupport::SymbolInfo info;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(vdso.LookupSymbol(
+        "__vdso_getcpu", "LINUX_2.6",
+        absl::debug_internal::VDSOSupport::kVDSOSymbolType, &info));
+  }
+}
+BENCHMARK(BM_VDSOSupport_LookupSymbol);
+
+void BM_VDSOSupport_LookupSymbolByAddress(benchmark::State& state) {
+  absl::debug_internal::VDSOSupport vdso;
+  absl::debug_internal::VDSOSupport::SymbolInfo info;
+  if (!vdso.LookupSymbol("__vdso_getcpu", "LINUX_2.6",
+                         absl::debug_internal::VDSOSupport::kVDSOSymbolType,
+                         &info)) {
+    state.SkipWithError("no __vdso_getcpu");
+    return;
+  }
+  const void* address = info.address;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(vdso.LookupSymbolByAddress(address, &info));
+  }
+}
+BENCHMARK(BM_VDSOSupport_LookupSymbolByAddress);
+
+void BM_GetCPU(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::debug_internal::GetCPU());
+  }
+}
+BENCHMARK(BM_GetCPU);
+
+#endif  // ABSL_HAVE_VDSO_SUPPORT
+
+}  // namespace
@@ -0,0 +1,130 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/stacktrace.h"
+
+#if defined(__linux__)
+#include <alloca.h>
+#endif
+
+#include <cstddef>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+#include "absl/base/optimization.h"
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+// Records the stack twice, once with each unwinder, and checks that they
+// agree on every frame but the first, whose pc is the call site itself.
+ABSL_ATTRIBUTE_NOINLINE void CheckFastMatchesDefault() {
+  void* fast[kMaxDepth];
+  void* slow[kMaxDepth];
+  const int fast_depth = absl::GetStackTraceFast(fast, kMaxDepth, 0);
+  const int slow_depth = absl::GetStackTrace(slow, kMaxDepth, 0);
+  ASSERT_EQ(fast_depth, slow_depth);
+  for (int i = 1; i < fast_depth; ++i) {
+    EXPECT_EQ(fast[i], slow[i]) << "frame " << i;
+  }
+}
+
+ABSL_ATTRIBUTE_NOINLINE void RecurseAndCheck(int n) {
+  if (n == 0) {
+    CheckFastMatchesDefault();
+  } else {
+    RecurseAndCheck(n - 1);
+  }
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+}
+
+TEST(StackTrace, FastMatchesDefault) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  RecurseAndCheck(8);
+}
+
+TEST(StackTrace, FastMatchesDefaultOnNewThread) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  std::thread thread([]() { RecurseAndCheck(8); });
+  thread.join();
+}
+
+TEST(StackTrace, FastRespectsLimits) {
+  void* result[kMaxDepth];
+  EXPECT_EQ(0, absl::GetStackTraceFast(result, 0, 0));
+  const int depth = absl::GetStackTraceFast(result, kMaxDepth, 0);
+  EXPECT_LE(absl::GetStackTraceFast(result, kMaxDepth, 1),
+            depth > 0 ? depth - 1 : 0);
+  EXPECT_LE(absl::GetStackTraceFast(result, 1, 0), 1);
+}
+
+#if defined(__linux__) && defined(__x86_64__)
+// Larger than any frame the unwinder accepts without knowing the stack bounds.
+constexpr size_t kLargeFrameBytes = 1 << 18;
+
+using TraceFunction = int (*)(void**, int, int);
+
+// Returns a trace, taken with `trace`, from below a frame of at least
+// `frame_bytes` bytes.
+ABSL_ATTRIBUTE_NOINLINE int TraceBelowFrameOf(size_t frame_bytes,
+                                              TraceFunction trace,
+                                              void** result) {
+  volatile char* buffer = static_cast<volatile char*>(alloca(frame_bytes));
+  buffer[0] = 0;
+  const int depth = trace(result, kMaxDepth, 0);
+  ABSL_BLOCK_TAIL_CALL_OPTIMIZATION();
+  return depth;
+}
+
+// The bounds of a thread's stack are looked up the first time it unwinds, so
+// later unwinds follow frames larger than the heuristics allow.
+TEST(StackTrace, CachedBoundsAllowLargeFramesOnNewThread) {
+  if (!absl::debugging_internal::StackTraceWorksForTest()) return;
+  std::thread thread([]() {
+    struct {
+      size_t frame_bytes;
+      TraceFunction trace;
+    } const kTraces[] = {
+        // GetStackTraceFast() does not look up the bounds, so until something
+        // else does, a large frame ends its trace.
+        {kLargeFrameBytes, absl::GetStackTraceFast},
+        {16, absl::GetStackTrace},
+        {kLargeFrameBytes, absl::GetStackTrace},
+        {kLargeFrameBytes, absl::GetStackTraceFast},
+    };
+    constexpr int kNumTraces = sizeof(kTraces) / sizeof(kTraces[0]);
+    void* results[kNumTraces][kMaxDepth];
+    int depths[kNumTraces];
+    for (int i = 0; i < kNumTraces; ++i) {
+      depths[i] = TraceBelowFrameOf(kTraces[i].frame_bytes, kTraces[i].trace,
+                                    results[i]);
+    }
+    // At least the frames of TraceBelowFrameOf() and its caller.
+    ASSERT_GE(depths[1], 2);
+    EXPECT_LT(depths[0], depths[1]);
+    for (int i = 2; i < kNumTraces; ++i) {
+      ASSERT_EQ(depths[i], depths[1]) << "trace " << i;
+      for (int j = 0; j < depths[i]; ++j) {
+        EXPECT_EQ(results[i][j], results[1][j])
+            << "trace " << i << ", frame " << j;
+      }
+    }
+  });
+  thread.join();
+}
+#endif
+
+}  // namespace
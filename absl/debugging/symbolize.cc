@@ -0,0 +1,143 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/symbolize.h"
+
+#include <errno.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/debugging/internal/demangle.h"
+#include "absl/debugging/internal/elf_mem_image.h"
+
+// The platform-specific part of the symbolizer defines
+//   bool debug_internal::FindSymbol(const void* pc, char* out, int out_size);
+// which writes the raw name of the symbol containing `pc` to `out`.
+#if defined(ABSL_HAVE_ELF_MEM_IMAGE) && defined(__linux__)
+#include "absl/debugging/internal/symbolize_elf-inl.h"
+#else
+#include "absl/debugging/internal/symbolize_unimplemented-inl.h"
+#endif
+
+namespace absl {
+namespace {
+
+// A cache of recent results, indexed by a hash of the pc. Each entry is a
+// seqlock: a writer makes `seq` odd while it fills in the entry, and readers
+// retry nothing, treating a torn read as a miss. Writers that find an entry
+// busy simply do not cache their result, so no one ever waits.
+//
+// The name is stored as atomic words so that a reader racing with a writer is
+// not a data race.
+constexpr int kCacheBits = 9;
+constexpr int kCacheSize = 1 << kCacheBits;
+constexpr int kCacheNameWords = 16;
+constexpr int kCacheNameLen = kCacheNameWords * sizeof(uint64_t);
+
+struct CacheEntry {
+  std::atomic<uint32_t> seq;  // Odd while being written; 0 if never written.
+  std::atomic<uintptr_t> pc;
+  std::atomic<uint64_t> name[kCacheNameWords];  // NUL-terminated.
+};
+
+CacheEntry g_cache[kCacheSize];
+
+CacheEntry& CacheEntryFor(uintptr_t pc) {
+  // Fibonacci hashing spreads nearby pcs over the table.
+  const uint64_t h = static_cast<uint64_t>(pc) * 0x9E3779B97F4A7C15ull;
+  return g_cache[h >> (64 - kCacheBits)];
+}
+
+// Copies the cached name of `pc` to `out`, truncating it if necessary.
+bool LookupCache(uintptr_t pc, char* out, int out_size) {
+  CacheEntry& entry = CacheEntryFor(pc);
+  const uint32_t seq = entry.seq.load(std::memory_order_acquire);
+  if (seq == 0 || (seq & 1) != 0) return false;
+  if (entry.pc.load(std::memory_order_relaxed) != pc) return false;
+  uint64_t words[kCacheNameWords];
+  for (int i = 0; i < kCacheNameWords; ++i) {
+    words[i] = entry.name[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (entry.seq.load(std::memory_order_relaxed) != seq) return false;
+
+  const char* name = reinterpret_cast<const char*>(words);
+  int i = 0;
+  for (; i < out_size - 1 && i < kCacheNameLen && name[i] != '\0'; ++i) {
+    out[i] = name[i];
+  }
+  out[i] = '\0';
+  return true;
+}
+
+// Caches `name` as the name of `pc`, unless it is too long or the entry is
+// being written by another thread.
+void InsertCache(uintptr_t pc, const char* name) {
+  const size_t len = strlen(name);
+  if (len >= static_cast<size_t>(kCacheNameLen)) return;
+  CacheEntry& entry = CacheEntryFor(pc);
+  uint32_t seq = entry.seq.load(std::memory_order_relaxed);
+  if ((seq & 1) != 0 ||
+      !entry.seq.compare_exchange_strong(seq, seq + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  uint64_t words[kCacheNameWords] = {};
+  memcpy(words, name, len + 1);
+  entry.pc.store(pc, std::memory_order_relaxed);
+  for (int i = 0; i < kCacheNameWords; ++i) {
+    entry.name[i].store(words[i], std::memory_order_relaxed);
+  }
+  entry.seq.store(seq + 2, std::memory_order_release);
+}
+
+// Saves and restores errno, which the system calls made while symbolizing
+// may change under code interrupted by a signal handler.
+class ErrnoSaver {
+ public:
+  ErrnoSaver() : saved_errno_(errno) {}
+  ~ErrnoSaver() { errno = saved_errno_; }
+
+ private:
+  const int saved_errno_;
+};
+
+}  // namespace
+
+bool Symbolize(const void* pc, char* out, int out_size) {
+  if (out == nullptr || out_size <= 0) return false;
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(pc);
+  if (LookupCache(addr, out, out_size)) return true;
+
+  ErrnoSaver errno_saver;
+  char mangled[1024];
+  if (!debug_internal::FindSymbol(pc, mangled, sizeof(mangled))) return false;
+  char demangled[1024];
+  const char* name =
+      debug_internal::Demangle(mangled, demangled, sizeof(demangled))
+          ? demangled
+          : mangled;
+  InsertCache(addr, name);
+
+  int i = 0;
+  for (; i < out_size - 1 && name[i] != '\0'; ++i) out[i] = name[i];
+  out[i] = '\0';
+  return true;
+}
+
+}  // namespace absl
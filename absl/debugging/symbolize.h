@@ -0,0 +1,66 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: symbolize.h
+// -----------------------------------------------------------------------------
+//
+// This file declares `absl::Symbolize()`, which maps a program counter, as
+// returned by `absl::GetStackTrace()`, to the name of the function that
+// contains it. It is meant for printing stack traces from places where little
+// else is allowed, such as signal handlers and the deadlock detector.
+//
+// On ELF platforms the symbolizer reads the symbol table (`.symtab`, or
+// `.dynsym` if the object is stripped) of each loaded object straight from a
+// read-only mapping of its file, indexes it once, and remembers recent
+// results in a small lock-free cache. On other platforms `Symbolize()` always
+// fails.
+
+#ifndef ABSL_DEBUGGING_SYMBOLIZE_H_
+#define ABSL_DEBUGGING_SYMBOLIZE_H_
+
+namespace absl {
+
+// Symbolize()
+//
+// Writes the demangled name of the symbol containing `pc` to `out`, which is
+// `out_size` bytes long, and returns true. The name is truncated if it does
+// not fit, and is always NUL-terminated. Returns false if no symbol could be
+// found.
+//
+// Names are demangled in the abbreviated form produced for stack traces, with
+// parameter lists shown as "()" and template arguments as "<>". Names that
+// cannot be demangled are returned as they appear in the symbol table.
+//
+// This function is thread-safe and async-signal-safe: it does not allocate
+// from the heap or block on locks. The first lookup in each loaded object
+// opens and maps its file and builds an index of its symbols; a lookup that
+// finds that work already in progress (for example, in a signal handler that
+// interrupted it) scans the symbol table directly instead.
+//
+// Example:
+//
+//   void* pcs[10];
+//   int depth = absl::GetStackTrace(pcs, 10, 0);
+//   char name[256];
+//   for (int i = 0; i < depth; ++i) {
+//     if (absl::Symbolize(pcs[i], name, sizeof(name))) {
+//       ABSL_RAW_LOG(INFO, "%p %s", pcs[i], name);
+//     }
+//   }
+bool Symbolize(const void* pc, char* out, int out_size);
+
+}  // namespace absl
+
+#endif  // ABSL_DEBUGGING_SYMBOLIZE_H_
@@ -0,0 +1,137 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/debugging/symbolize.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/attributes.h"
+#include "absl/debugging/internal/elf_mem_image.h"
+
+#if defined(ABSL_HAVE_ELF_MEM_IMAGE) && defined(__linux__)
+
+namespace symbolize_test {
+
+ABSL_ATTRIBUTE_NOINLINE int NonInlineFunction(int x) {
+  // Keep the function from being folded into a caller or another function.
+  static volatile int sink;
+  sink = x;
+  return sink + 1;
+}
+
+}  // namespace symbolize_test
+
+extern "C" ABSL_ATTRIBUTE_NOINLINE int SymbolizeTestCFunction(int x) {
+  static volatile int sink;
+  sink = x;
+  return sink * 2;
+}
+
+namespace {
+
+std::string SymbolizeIt(const void* pc, int size = 256) {
+  char buf[256];
+  if (!absl::Symbolize(pc, buf, size)) return "FAILED";
+  return buf;
+}
+
+const void* FunctionPc(int (*fn)(int)) {
+  return reinterpret_cast<const void*>(fn);
+}
+
+TEST(Symbolize, Functions) {
+  EXPECT_EQ("symbolize_test::NonInlineFunction()",
+            SymbolizeIt(FunctionPc(&symbolize_test::NonInlineFunction)));
+  EXPECT_EQ("SymbolizeTestCFunction",
+            SymbolizeIt(FunctionPc(&SymbolizeTestCFunction)));
+  // A pc inside the function, as found in a stack trace.
+  EXPECT_EQ("SymbolizeTestCFunction",
+            SymbolizeIt(reinterpret_cast<const char*>(
+                            FunctionPc(&SymbolizeTestCFunction)) + 1));
+}
+
+TEST(Symbolize, SharedLibrary) {
+  // A function in libc, whose symbols come from a separate object.
+  const std::string name =
+      SymbolizeIt(reinterpret_cast<const void*>(&getpid));
+  EXPECT_NE(std::string::npos, name.find("getpid")) << name;
+}
+
+TEST(Symbolize, Truncation) {
+  const void* pc = FunctionPc(&SymbolizeTestCFunction);
+  EXPECT_EQ("Symb", SymbolizeIt(pc, 5));
+  EXPECT_EQ("", SymbolizeIt(pc, 1));
+  char buf[1];
+  EXPECT_FALSE(absl::Symbolize(pc, buf, 0));
+  // Truncated lookups neither come from nor poison the cache.
+  EXPECT_EQ("SymbolizeTestCFunction", SymbolizeIt(pc));
+  EXPECT_EQ("Symb", SymbolizeIt(pc, 5));
+}
+
+TEST(Symbolize, Failures) {
+  EXPECT_EQ("FAILED", SymbolizeIt(nullptr));
+  int local = 0;
+  EXPECT_EQ("FAILED", SymbolizeIt(&local));
+}
+
+TEST(Symbolize, Threads) {
+  std::vector<std::thread> threads;
+  std::vector<std::string> results(8);
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([i, &results] {
+      for (int j = 0; j < 1000; ++j) {
+        results[i] = SymbolizeIt(
+            i % 2 == 0 ? FunctionPc(&SymbolizeTestCFunction)
+                       : FunctionPc(&symbolize_test::NonInlineFunction));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(i % 2 == 0 ? "SymbolizeTestCFunction"
+                         : "symbolize_test::NonInlineFunction()",
+              results[i]);
+  }
+}
+
+char signal_result[256];
+
+void SymbolizeSignalHandler(int) {
+  if (!absl::Symbolize(FunctionPc(&symbolize_test::NonInlineFunction),
+                       signal_result, sizeof(signal_result))) {
+    strcpy(signal_result, "FAILED");  // NOLINT(runtime/printf)
+  }
+}
+
+TEST(Symbolize, InSignalHandler) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SymbolizeSignalHandler;
+  struct sigaction old_sa;
+  ASSERT_EQ(0, sigaction(SIGUSR1, &sa, &old_sa));
+  raise(SIGUSR1);
+  ASSERT_EQ(0, sigaction(SIGUSR1, &old_sa, nullptr));
+  EXPECT_STREQ("symbolize_test::NonInlineFunction()", signal_result);
+}
+
+}  // namespace
+
+#endif  // ABSL_HAVE_ELF_MEM_IMAGE && __linux__
@@ -0,0 +1,106 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/memory/arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <limits>
+
+namespace absl {
+
+constexpr size_t Arena::kDefaultBlockSize;
+
+namespace {
+
+// Block headers are padded so that block data is maximally aligned.
+constexpr size_t kHeaderSize =
+    (2 * sizeof(void*) + alignof(std::max_align_t) - 1) &
+    ~(alignof(std::max_align_t) - 1);
+
+}  // namespace
+
+Arena::Arena(size_t block_size)
+    : block_size_(std::max(block_size, 4 * alignof(std::max_align_t))) {}
+
+Arena::~Arena() {
+  for (Block* list : {blocks_, large_blocks_}) {
+    while (list != nullptr) {
+      Block* next = list->next;
+      ::operator delete(list);
+      list = next;
+    }
+  }
+}
+
+char* Arena::BlockData(Block* b) {
+  return reinterpret_cast<char*>(b) + kHeaderSize;
+}
+
+Arena::Block* Arena::NewBlock(size_t size) {
+  if (size > std::numeric_limits<size_t>::max() - kHeaderSize) {
+    base_internal::ThrowStdBadAlloc();
+  }
+  Block* b = static_cast<Block*>(::operator new(kHeaderSize + size));
+  b->size = size;
+  bytes_reserved_ += size;
+  return b;
+}
+
+void* Arena::AllocateSlow(size_t bytes, size_t alignment) {
+  assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  assert(alignment <= alignof(std::max_align_t));
+
+  if (bytes > block_size_ / 4) {
+    // A block of its own, so that the rest of the current block isn't wasted.
+    Block* b = NewBlock(bytes);
+    b->next = large_blocks_;
+    large_blocks_ = b;
+    bytes_allocated_ += bytes;
+    return BlockData(b);
+  }
+
+  Block* b = NewBlock(block_size_);
+  b->next = blocks_;
+  blocks_ = b;
+  ptr_ = BlockData(b) + bytes;
+  limit_ = BlockData(b) + block_size_;
+  bytes_allocated_ += bytes;
+  return BlockData(b);
+}
+
+void Arena::Reset() {
+  while (large_blocks_ != nullptr) {
+    Block* next = large_blocks_->next;
+    bytes_reserved_ -= large_blocks_->size;
+    ::operator delete(large_blocks_);
+    large_blocks_ = next;
+  }
+  if (blocks_ != nullptr) {
+    // Keep the current block and free the others.
+    Block* b = blocks_->next;
+    while (b != nullptr) {
+      Block* next = b->next;
+      bytes_reserved_ -= b->size;
+      ::operator delete(b);
+      b = next;
+    }
+    blocks_->next = nullptr;
+    ptr_ = BlockData(blocks_);
+  }
+  bytes_allocated_ = 0;
+}
+
+}  // namespace absl
@@ -0,0 +1,197 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: arena.h
+// -----------------------------------------------------------------------------
+//
+// An `absl::Arena` hands out memory by bumping a pointer through large blocks
+// and frees all of it at once, when the arena is reset or destroyed. It suits
+// scratch memory whose lifetime ends at a known point, such as the end of a
+// request: allocating is a few instructions and there is no per-object free.
+//
+// `absl::ArenaAllocator<T>` adapts an arena to the standard allocator
+// interface, for use with `absl::FixedArray`, `absl::InlinedVector` and the
+// standard containers:
+//
+//   absl::Arena arena;
+//   absl::ArenaAllocator<int> alloc(&arena);
+//   absl::FixedArray<int, 0, absl::ArenaAllocator<int>> scratch(n, alloc);
+//   absl::InlinedVector<int, 4, absl::ArenaAllocator<int>> ids(alloc);
+//
+// Deallocating through an `ArenaAllocator` only gives the memory back if it
+// was the arena's most recent allocation; otherwise it is reclaimed with the
+// rest of the arena. Destructors are the containers' business: the arena never
+// runs any.
+//
+// An `Arena` is not thread-safe.
+
+#ifndef ABSL_MEMORY_ARENA_H_
+#define ABSL_MEMORY_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+#include "absl/base/internal/throw_delegate.h"
+#include "absl/base/optimization.h"
+
+namespace absl {
+
+// -----------------------------------------------------------------------------
+// Arena
+// -----------------------------------------------------------------------------
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 4096;
+
+  // Creates an arena that allocates blocks of `block_size` bytes as it needs
+  // them. Requests larger than a quarter of a block get a block of their own.
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena();
+
+  // Arena::Allocate()
+  //
+  // Returns `bytes` bytes aligned to `alignment`, which must be a power of two
+  // no larger than `alignof(std::max_align_t)`.
+  void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    const uintptr_t p =
+        (reinterpret_cast<uintptr_t>(ptr_) + alignment - 1) & ~(alignment - 1);
+    const uintptr_t limit = reinterpret_cast<uintptr_t>(limit_);
+    if (ABSL_PREDICT_TRUE(p != 0 && p <= limit && bytes <= limit - p)) {
+      ptr_ = reinterpret_cast<char*>(p + bytes);
+      bytes_allocated_ += bytes;
+      return reinterpret_cast<void*>(p);
+    }
+    return AllocateSlow(bytes, alignment);
+  }
+
+  // Arena::Deallocate()
+  //
+  // Gives back `bytes` bytes at `p`, which `Allocate()` returned, if nothing
+  // has been allocated since. Otherwise does nothing; the memory is reclaimed
+  // by `Reset()` or the destructor.
+  void Deallocate(void* p, size_t bytes) {
+    if (static_cast<char*>(p) + bytes == ptr_) {
+      ptr_ = static_cast<char*>(p);
+      bytes_allocated_ -= bytes;
+    }
+  }
+
+  // Arena::Reset()
+  //
+  // Frees everything allocated from the arena. The most recent block is kept
+  // for reuse, so that an arena reset at the end of each request doesn't call
+  // into the system allocator in the steady state.
+  void Reset();
+
+  // Arena::bytes_allocated()
+  //
+  // Returns the number of bytes handed out and not given back since the arena
+  // was created or reset.
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+  // Arena::bytes_reserved()
+  //
+  // Returns the number of bytes in the blocks that the arena holds.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  struct Block {
+    Block* next;
+    size_t size;
+  };
+
+  void* AllocateSlow(size_t bytes, size_t alignment);
+  Block* NewBlock(size_t size);
+  static char* BlockData(Block* b);
+
+  const size_t block_size_;
+  char* ptr_ = nullptr;
+  char* limit_ = nullptr;
+  // Blocks that `ptr_` has bumped through, the current one first.
+  Block* blocks_ = nullptr;
+  // Blocks dedicated to single large requests.
+  Block* large_blocks_ = nullptr;
+  size_t bytes_allocated_ = 0;
+  size_t bytes_reserved_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// ArenaAllocator
+// -----------------------------------------------------------------------------
+//
+// A standard allocator that allocates from an `absl::Arena`. Copies, including
+// rebound ones, allocate from the same arena and compare equal. Like the
+// arena, it cannot allocate types aligned beyond `alignof(std::max_align_t)`;
+// trying to does not compile.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+
+  template <typename U>
+  struct rebind {
+    using other = ArenaAllocator<U>;
+  };
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT(runtime/explicit)
+      : arena_(other.arena()) {}
+
+  // Throws std::bad_alloc, or aborts without exceptions, if `n` is more than
+  // `max_size()`.
+  T* allocate(size_type n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "Arena does not support over-aligned types");
+    if (ABSL_PREDICT_FALSE(n > max_size())) base_internal::ThrowStdBadAlloc();
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, size_type n) { arena_->Deallocate(p, n * sizeof(T)); }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+  }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() != b.arena();
+}
+
+}  // namespace absl
+
+#endif  // ABSL_MEMORY_ARENA_H_
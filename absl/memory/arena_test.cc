@@ -0,0 +1,143 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/memory/arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/internal/exception_testing.h"
+
+namespace {
+
+bool IsAligned(const void* p, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+TEST(ArenaTest, AllocationsAreDistinctAndAligned) {
+  absl::Arena arena(256);
+  std::vector<char*> ptrs;
+  for (size_t i = 0; i < 100; ++i) {
+    const size_t alignment = size_t{1} << (i % 4);
+    char* p = static_cast<char*>(arena.Allocate(i % 17 + 1, alignment));
+    EXPECT_TRUE(IsAligned(p, alignment));
+    memset(p, static_cast<int>(i), i % 17 + 1);
+    ptrs.push_back(p);
+  }
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    for (size_t j = 0; j < i % 17 + 1; ++j) {
+      EXPECT_EQ(ptrs[i][j], static_cast<char>(i));
+    }
+  }
+  EXPECT_TRUE(IsAligned(arena.Allocate(1), alignof(std::max_align_t)));
+}
+
+TEST(ArenaTest, ZeroSizedAllocationsAreNotNull) {
+  absl::Arena arena;
+  EXPECT_NE(arena.Allocate(0), nullptr);
+  EXPECT_NE(arena.Allocate(0), nullptr);
+}
+
+TEST(ArenaTest, Accounting) {
+  absl::Arena arena(1024);
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+
+  arena.Allocate(100, 1);
+  EXPECT_EQ(arena.bytes_allocated(), 100u);
+  EXPECT_EQ(arena.bytes_reserved(), 1024u);
+
+  // Larger than a quarter of a block: gets its own block.
+  arena.Allocate(1000, 1);
+  EXPECT_EQ(arena.bytes_allocated(), 1100u);
+  EXPECT_EQ(arena.bytes_reserved(), 2024u);
+
+  // Still fits in the first block.
+  arena.Allocate(200, 1);
+  EXPECT_EQ(arena.bytes_reserved(), 2024u);
+
+  arena.Reset();
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+  EXPECT_EQ(arena.bytes_reserved(), 1024u);
+}
+
+TEST(ArenaTest, DeallocateRollsBackOnlyTheLastAllocation) {
+  absl::Arena arena;
+  void* a = arena.Allocate(16);
+  void* b = arena.Allocate(16);
+  arena.Deallocate(a, 16);
+  EXPECT_EQ(arena.bytes_allocated(), 32u);
+  arena.Deallocate(b, 16);
+  EXPECT_EQ(arena.bytes_allocated(), 16u);
+  EXPECT_EQ(arena.Allocate(16), b);
+}
+
+TEST(ArenaTest, ResetReusesTheCurrentBlock) {
+  absl::Arena arena(512);
+  for (int i = 0; i < 10; ++i) arena.Allocate(100);
+  EXPECT_GT(arena.bytes_reserved(), 512u);
+  arena.Reset();
+  EXPECT_EQ(arena.bytes_reserved(), 512u);
+  void* p = arena.Allocate(100);
+  arena.Reset();
+  EXPECT_EQ(arena.Allocate(100), p);
+  EXPECT_EQ(arena.bytes_reserved(), 512u);
+}
+
+TEST(ArenaAllocatorTest, CopiesCompareEqual) {
+  absl::Arena arena, other_arena;
+  absl::ArenaAllocator<int> a(&arena);
+  absl::ArenaAllocator<double> b(a);
+  EXPECT_EQ(b.arena(), &arena);
+  EXPECT_TRUE(a == b);
+  EXPECT_TRUE(a != absl::ArenaAllocator<int>(&other_arena));
+}
+
+TEST(ArenaAllocatorTest, StandardContainers) {
+  absl::Arena arena;
+  using String =
+      std::basic_string<char, std::char_traits<char>,
+                        absl::ArenaAllocator<char>>;
+  std::vector<String, absl::ArenaAllocator<String>> v{
+      absl::ArenaAllocator<String>(&arena)};
+  std::list<int, absl::ArenaAllocator<int>> l{
+      absl::ArenaAllocator<int>(&arena)};
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(64, static_cast<char>('a' + i % 26),
+                   absl::ArenaAllocator<char>(&arena));
+    l.push_back(i);
+  }
+  EXPECT_EQ(v[27], String(64, 'b', absl::ArenaAllocator<char>(&arena)));
+  EXPECT_EQ(l.back(), 99);
+  EXPECT_GT(arena.bytes_allocated(), 100 * 64u);
+}
+
+TEST(ArenaAllocatorTest, AllocatingTooMuchFails) {
+  absl::Arena arena;
+  absl::ArenaAllocator<int64_t> a(&arena);
+  EXPECT_EQ(a.max_size(), SIZE_MAX / 8);
+  // The size in bytes would wrap around to a small number.
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(a.allocate(a.max_size() + 1), std::bad_alloc,
+                                 "");
+  absl::ArenaAllocator<char> b(&arena);
+  ABSL_BASE_INTERNAL_EXPECT_FAIL(b.allocate(b.max_size()), std::bad_alloc, "");
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+}
+
+}  // namespace
@@ -36,6 +36,7 @@
 #define ABSL_META_TYPE_TRAITS_H_
 
 #include <stddef.h>
+#include <memory>
 #include <type_traits>
 
 #include "absl/base/config.h"
@@ -274,6 +275,34 @@ struct is_trivially_copy_assignable
 #endif  // ABSL_HAVE_STD_IS_TRIVIALLY_ASSIGNABLE
 };
 
+// is_trivially_relocatable()
+//
+// Determines whether an object of type `T` may be moved to new storage by
+// copying its bytes, after which the old storage is treated as raw memory and
+// no destructor runs on it. Containers such as `absl::InlinedVector` use this
+// to grow, shift and swap their elements with `memcpy()` and `memmove()`.
+//
+// Types that are trivially copy constructible and trivially destructible are
+// trivially relocatable. Other types may opt in by specializing this trait,
+// provided that no pointer to the object, including one held by the object
+// itself, outlives a move:
+//
+//   namespace absl {
+//   template <>
+//   struct is_trivially_relocatable<MyHandle> : std::true_type {};
+//   }  // namespace absl
+//
+// `std::unique_ptr` with the default deleter is opted in below. `std::string`
+// is not: with libstdc++, a short string points into its own inline buffer.
+template <typename T>
+struct is_trivially_relocatable
+    : std::integral_constant<bool, is_trivially_copy_constructible<T>::value &&
+                                       is_trivially_destructible<T>::value> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>>
+    : std::true_type {};
+
 // -----------------------------------------------------------------------------
 // C++14 "_t" trait aliases
 // -----------------------------------------------------------------------------
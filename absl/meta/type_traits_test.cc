@@ -15,6 +15,7 @@
 #include "absl/meta/type_traits.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -22,6 +23,20 @@
 
 #include "gtest/gtest.h"
 
+// A type whose copy constructor is not trivial but which holds nothing that
+// depends on its address, so it opts in to trivial relocation.
+struct RelocatableHandle {
+  RelocatableHandle() = default;
+  RelocatableHandle(const RelocatableHandle& h) : fd(h.fd) {}
+  ~RelocatableHandle() {}
+  int fd = -1;
+};
+
+namespace absl {
+template <>
+struct is_trivially_relocatable<RelocatableHandle> : std::true_type {};
+}  // namespace absl
+
 namespace {
 
 using ::testing::StaticAssertTypeEq;
@@ -530,6 +545,31 @@ TEST(TypeTraitsTest, TestTrivialCopyAssign) {
   EXPECT_FALSE(absl::is_trivially_copy_assignable<int10>::value);
 }
 
+TEST(TypeTraitsTest, TestTrivialRelocation) {
+  EXPECT_TRUE(absl::is_trivially_relocatable<int>::value);
+  EXPECT_TRUE(absl::is_trivially_relocatable<double>::value);
+  EXPECT_TRUE(absl::is_trivially_relocatable<std::string*>::value);
+  EXPECT_TRUE(absl::is_trivially_relocatable<Trivial>::value);
+  EXPECT_TRUE((absl::is_trivially_relocatable<simple_pair<int, char*>>::value));
+
+  // Types with a nontrivial copy constructor or destructor need to opt in.
+  EXPECT_FALSE(absl::is_trivially_relocatable<NontrivialCopyCtor>::value);
+  EXPECT_FALSE(absl::is_trivially_relocatable<NontrivialDestructor>::value);
+  EXPECT_FALSE(absl::is_trivially_relocatable<Base>::value);
+  EXPECT_FALSE(absl::is_trivially_relocatable<std::string>::value);
+  EXPECT_FALSE(absl::is_trivially_relocatable<std::vector<int>>::value);
+  EXPECT_TRUE(absl::is_trivially_relocatable<RelocatableHandle>::value);
+
+  EXPECT_TRUE(absl::is_trivially_relocatable<std::unique_ptr<int>>::value);
+  EXPECT_TRUE(
+      absl::is_trivially_relocatable<std::unique_ptr<std::string>>::value);
+  struct Deleter {
+    void operator()(int* p) const { delete p; }
+  };
+  EXPECT_FALSE(
+      (absl::is_trivially_relocatable<std::unique_ptr<int, Deleter>>::value));
+}
+
 #define ABSL_INTERNAL_EXPECT_ALIAS_EQUIVALENCE(trait_name, ...)          \
   EXPECT_TRUE((std::is_same<typename std::trait_name<__VA_ARGS__>::type, \
                             absl::trait_name##_t<__VA_ARGS__>>::value))
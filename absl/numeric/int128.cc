@@ -125,17 +125,28 @@ uint128::uint128(double v) : uint128(Initialize128FromFloat(v)) {}
 uint128::uint128(long double v) : uint128(Initialize128FromFloat(v)) {}
 
 uint128& uint128::operator/=(uint128 other) {
+#if defined(ABSL_HAVE_INTRINSIC_INT128)
+  // The compiler's 128-bit division is much faster than DivModImpl().
+  *this = static_cast<unsigned __int128>(*this) /
+          static_cast<unsigned __int128>(other);
+#else   // ABSL_HAVE_INTRINSIC_INT128
   uint128 quotient = 0;
   uint128 remainder = 0;
   DivModImpl(*this, other, &quotient, &remainder);
   *this = quotient;
+#endif  // ABSL_HAVE_INTRINSIC_INT128
   return *this;
 }
 uint128& uint128::operator%=(uint128 other) {
+#if defined(ABSL_HAVE_INTRINSIC_INT128)
+  *this = static_cast<unsigned __int128>(*this) %
+          static_cast<unsigned __int128>(other);
+#else   // ABSL_HAVE_INTRINSIC_INT128
   uint128 quotient = 0;
   uint128 remainder = 0;
   DivModImpl(*this, other, &quotient, &remainder);
   *this = remainder;
+#endif  // ABSL_HAVE_INTRINSIC_INT128
   return *this;
 }
 
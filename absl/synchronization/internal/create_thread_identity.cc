@@ -24,6 +24,7 @@
 #include "absl/base/attributes.h"
 #include "absl/base/internal/spinlock.h"
 #include "absl/base/internal/thread_identity.h"
+#include "absl/synchronization/internal/create_thread_identity.h"
 #include "absl/synchronization/internal/per_thread_sem.h"
 
 namespace absl {
@@ -43,7 +44,7 @@ static void ReclaimThreadIdentity(void* v) {
   // all_locks might have been allocated by the Mutex implementation.
   // We free it here when we are notified that our thread is dying.
   if (identity->per_thread_synch.all_locks != nullptr) {
-    base_internal::LowLevelAlloc::Free(identity->per_thread_synch.all_locks);
+    FreeSynchLocksHeld(identity->per_thread_synch.all_locks);
   }
 
   // We must explicitly clear the current thread's identity:
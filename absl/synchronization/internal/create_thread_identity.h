@@ -35,6 +35,10 @@ namespace synchronization_internal {
 // For private use only.
 base_internal::ThreadIdentity* CreateThreadIdentity();
 
+// Frees the held-locks record that the Mutex implementation attached to a
+// ThreadIdentity (PerThreadSynch::all_locks).  Defined in mutex.cc.
+void FreeSynchLocksHeld(SynchLocksHeld* locks);
+
 // Returns the ThreadIdentity object representing the calling thread; guaranteed
 // to be unique for its lifetime.  The returned object will remain valid for the
 // program's lifetime; although it may be re-assigned to a subsequent thread.
@@ -39,6 +39,7 @@
 #include <array>
 #include "absl/base/internal/raw_logging.h"
 #include "absl/base/internal/spinlock.h"
+#include "absl/debugging/internal/stack_depot.h"
 
 // Do not use STL.   This module does not use standard memory allocation.
 
@@ -48,7 +49,8 @@ namespace synchronization_internal {
 namespace {
 
 // Avoid LowLevelAlloc's default arena since it calls malloc hooks in
-// which people are doing things like acquiring Mutexes.
+// which people are doing things like acquiring Mutexes.  The arena reports
+// its regions, so that a leak checker can account for the graph's memory.
 static absl::base_internal::SpinLock arena_mu(
     absl::base_internal::kLinkerInitialized);
 static base_internal::LowLevelAlloc::Arena* arena;
@@ -56,7 +58,8 @@ static base_internal::LowLevelAlloc::Arena* arena;
 static void InitArenaIfNecessary() {
   arena_mu.Lock();
   if (arena == nullptr) {
-    arena = base_internal::LowLevelAlloc::NewArena(0);
+    arena = base_internal::LowLevelAlloc::NewArena(
+        base_internal::LowLevelAlloc::kReportRegions);
   }
   arena_mu.Unlock();
 }
@@ -297,8 +300,7 @@ struct Node {
   NodeSet in;                 // List of immediate predecessor nodes in graph
   NodeSet out;                // List of immediate successor nodes in graph
   int priority;               // Priority of recorded stack trace.
-  int nstack;                 // Depth of recorded stack trace.
-  void* stack[40];            // stack[0,nstack-1] holds stack trace for node.
+  uint32_t stack_id;          // Stack depot ID of recorded stack trace.
 };
 
 // Hash table for pointer to node index lookups.
@@ -428,7 +430,7 @@ GraphId GraphCycles::GetId(void* ptr) {
     n->visited = false;
     n->rank = rep_->nodes_.size();
     n->masked_ptr = MaskPtr(ptr);
-    n->nstack = 0;
+    n->stack_id = 0;
     n->priority = 0;
     rep_->nodes_.push_back(n);
     rep_->ptrmap_.Add(ptr, n->rank);
@@ -440,7 +442,7 @@ GraphId GraphCycles::GetId(void* ptr) {
     rep_->free_nodes_.pop_back();
     Node* n = rep_->nodes_[r];
     n->masked_ptr = MaskPtr(ptr);
-    n->nstack = 0;
+    n->stack_id = 0;
     n->priority = 0;
     rep_->ptrmap_.Add(ptr, r);
     return MakeId(r, n->version);
@@ -688,18 +690,19 @@ void GraphCycles::UpdateStackTrace(GraphId id, int priority,
   if (n == nullptr || n->priority >= priority) {
     return;
   }
-  n->nstack = (*get_stack_trace)(n->stack, ABSL_ARRAYSIZE(n->stack));
+  void* stack[40];
+  const int depth = (*get_stack_trace)(stack, ABSL_ARRAYSIZE(stack));
+  n->stack_id = debug_internal::StackDepotPut(stack, depth);
   n->priority = priority;
 }
 
-int GraphCycles::GetStackTrace(GraphId id, void*** ptr) {
+int GraphCycles::GetStackTrace(GraphId id, void* const** ptr) {
   Node* n = FindNode(rep_, id);
   if (n == nullptr) {
     *ptr = nullptr;
     return 0;
   } else {
-    *ptr = n->stack;
-    return n->nstack;
+    return debug_internal::StackDepotGet(n->stack_id, ptr);
   }
 }
 
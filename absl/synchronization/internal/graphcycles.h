@@ -117,7 +117,9 @@ class GraphCycles {
 
   // Set *ptr to the beginning of the array that holds the recorded
   // stack trace for id and return the depth of the stack trace.
-  int GetStackTrace(GraphId id, void*** ptr);
+  // Traces are kept in the stack depot, so a trace recorded for many
+  // nodes is stored once, and *ptr stays valid after the node is removed.
+  int GetStackTrace(GraphId id, void* const** ptr);
 
   // Check internal invariants. Crashes on failure, returns true on success.
   // Expensive: should only be called from graphcycles_test.cc.
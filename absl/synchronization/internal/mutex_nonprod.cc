@@ -252,6 +252,7 @@ void Mutex::ForgetDeadlockInfo() {}
 void Mutex::AssertHeld() const {}
 void Mutex::AssertReaderHeld() const {}
 void Mutex::AssertNotHeld() const {}
+void Mutex::SetLockOrderName(const char*) {}
 
 CondVar::CondVar() {}
 
@@ -36,7 +36,9 @@
 #include <algorithm>
 #include <atomic>
 #include <cinttypes>
+#include <new>
 #include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/base/config.h"
@@ -50,7 +52,9 @@
 #include "absl/base/internal/thread_identity.h"
 #include "absl/base/internal/tsan_mutex_interface.h"
 #include "absl/base/port.h"
+#include "absl/debugging/internal/stack_depot.h"
 #include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
 #include "absl/synchronization/internal/graphcycles.h"
 #include "absl/synchronization/internal/per_thread_sem.h"
 #include "absl/time/time.h"
@@ -82,6 +86,13 @@ constexpr OnDeadlockCycle kDeadlockDetectionDefault = OnDeadlockCycle::kAbort;
 ABSL_CONST_INIT std::atomic<OnDeadlockCycle> synch_deadlock_detection(
     kDeadlockDetectionDefault);
 ABSL_CONST_INIT std::atomic<bool> synch_check_invariants(false);
+ABSL_CONST_INIT std::atomic<OnDeadlockCycle> synch_lock_order(
+    OnDeadlockCycle::kIgnore);
+// Set by EnableHeldMutexTracking().
+ABSL_CONST_INIT std::atomic<bool> synch_held_lock_tracking_enabled(false);
+// Whether to record held locks in all build modes: true iff
+// synch_held_lock_tracking_enabled is set or the lock-order checker is on.
+ABSL_CONST_INIT std::atomic<bool> synch_held_lock_tracking(false);
 
 // ------------------------------------------ spinlock support
 
@@ -470,20 +481,39 @@ struct SynchWaitParams {
                                   // to contend for the mutex.
 };
 
+// Protects the list of all SynchLocksHeld structs, for DumpHeldMutexes().
+static absl::base_internal::SpinLock all_locks_list_mu(
+    absl::base_internal::kLinkerInitialized);
+
+// Only the owning thread writes the fields below.  DumpHeldMutexes() reads
+// n, overflow, and each entry's mu and count from other threads, so those are
+// atomic; all accesses to them are relaxed.
 struct SynchLocksHeld {
-  int n;              // number of valid entries in locks[]
-  bool overflow;      // true iff we overflowed the array at some point
+  std::atomic<int> n;         // number of valid entries in locks[]
+  std::atomic<bool> overflow;  // true iff we overflowed the array at some point
   struct {
-    Mutex *mu;        // lock acquired
-    int32_t count;      // times acquired
-    GraphId id;       // deadlock_graph id of acquired lock
+    std::atomic<Mutex *> mu;    // lock acquired
+    std::atomic<int32_t> count;  // times acquired
+    GraphId id;       // deadlock_graph id of acquired lock, or
+                      // InvalidGraphId() if only tracking held locks
   } locks[40];
   // If a thread overfills the array during deadlock detection, we
   // continue, discarding information as needed.  If no overflow has
   // taken place, we can provide more error checking, such as
   // detecting when a thread releases a lock it does not hold.
+
+  // What the thread is blocked on, if anything, while tracking held locks.
+  std::atomic<const Mutex *> waiting_for;
+  std::atomic<const CondVar *> waiting_on_cv;
+
+  pid_t tid;  // thread that allocated this struct
+  SynchLocksHeld *prev GUARDED_BY(all_locks_list_mu);
+  SynchLocksHeld *next GUARDED_BY(all_locks_list_mu);
 };
 
+// Doubly linked list of the SynchLocksHeld structs of all live threads.
+static SynchLocksHeld *all_locks_list GUARDED_BY(all_locks_list_mu);
+
 // A sentinel value in lists that is not 0.
 // A 0 value is used to mean "not on a list".
 static PerThreadSynch *const kPerThreadSynchNull =
@@ -492,11 +522,34 @@ static PerThreadSynch *const kPerThreadSynchNull =
 static SynchLocksHeld *LocksHeldAlloc() {
   SynchLocksHeld *ret = reinterpret_cast<SynchLocksHeld *>(
       base_internal::LowLevelAlloc::Alloc(sizeof(SynchLocksHeld)));
-  ret->n = 0;
-  ret->overflow = false;
+  new (&ret->n) std::atomic<int>(0);
+  new (&ret->overflow) std::atomic<bool>(false);
+  new (&ret->waiting_for) std::atomic<const Mutex *>(nullptr);
+  new (&ret->waiting_on_cv) std::atomic<const CondVar *>(nullptr);
+  ret->tid = base_internal::GetTID();
+  absl::base_internal::SpinLockHolder l(&all_locks_list_mu);
+  ret->prev = nullptr;
+  ret->next = all_locks_list;
+  if (all_locks_list != nullptr) all_locks_list->prev = ret;
+  all_locks_list = ret;
   return ret;
 }
 
+namespace synchronization_internal {
+void FreeSynchLocksHeld(SynchLocksHeld *locks) {
+  {
+    absl::base_internal::SpinLockHolder l(&all_locks_list_mu);
+    if (locks->prev != nullptr) {
+      locks->prev->next = locks->next;
+    } else {
+      all_locks_list = locks->next;
+    }
+    if (locks->next != nullptr) locks->next->prev = locks->prev;
+  }
+  base_internal::LowLevelAlloc::Free(locks);
+}
+}  // namespace synchronization_internal
+
 // Return the PerThreadSynch-struct for this thread.
 static PerThreadSynch *Synch_GetPerThread() {
   ThreadIdentity *identity = GetOrCreateCurrentThreadIdentity();
@@ -581,8 +634,7 @@ static absl::Time DeadlineFromTimeout(absl::Duration timeout) {
 
 // --------------------------Mutexes
 
-// In the layout below, the msb of the bottom byte is currently unused.  Also,
-// the following constraints were considered in choosing the layout:
+// The following constraints were considered in choosing the layout below:
 //  o Both the debug allocator's "uninitialized" and "freed" patterns (0xab and
 //    0xcd) are illegal: reader and writer lock both held.
 //  o kMuWriter and kMuEvent should exceed kMuDesig and kMuWait, to enable the
@@ -605,6 +657,7 @@ static const intptr_t kMuEvent       = 0x0010L;  // record this mutex's events
 static const intptr_t kMuWrWait      = 0x0020L;  // runnable writer is waiting
                                                  // for a reader
 static const intptr_t kMuSpin        = 0x0040L;  // spinlock protects wait list
+static const intptr_t kMuNamed       = 0x0080L;  // has a lock-order name
 static const intptr_t kMuLow         = 0x00ffL;  // mask all mutex bits
 static const intptr_t kMuHigh        = ~kMuLow;  // mask pointer/reader count
 
@@ -617,6 +670,7 @@ enum {
   kGdbMuDesig = kMuDesig,
   kGdbMuWrWait = kMuWrWait,
   kGdbMuReader = kMuReader,
+  kGdbMuNamed = kMuNamed,
   kGdbMuLow = kMuLow,
 };
 
@@ -691,6 +745,8 @@ Mutex::Mutex() : mu_(0) {
   ABSL_TSAN_MUTEX_CREATE(this, __tsan_mutex_not_static);
 }
 
+static void ForgetLockOrderName(const Mutex *mu);
+
 static bool DebugOnlyIsExiting() {
   return false;
 }
@@ -703,6 +759,9 @@ Mutex::~Mutex() {
   if (kDebugMode) {
     this->ForgetDeadlockInfo();
   }
+  if ((v & kMuNamed) != 0) {
+    ForgetLockOrderName(this);
+  }
   ABSL_TSAN_MUTEX_DESTROY(this, __tsan_mutex_not_static);
 }
 
@@ -731,6 +790,14 @@ void SetMutexDeadlockDetectionMode(OnDeadlockCycle mode) {
   synch_deadlock_detection.store(mode, std::memory_order_release);
 }
 
+void EnableHeldMutexTracking(bool enabled) {
+  synch_held_lock_tracking_enabled.store(enabled, std::memory_order_relaxed);
+  synch_held_lock_tracking.store(
+      enabled || synch_lock_order.load(std::memory_order_relaxed) !=
+                     OnDeadlockCycle::kIgnore,
+      std::memory_order_release);
+}
+
 // Return true iff threads x and y are waiting on the same condition for the
 // same type of lock.  Requires that x and y be waiting on the same Mutex
 // queue.
@@ -1068,7 +1135,7 @@ void Mutex::TryRemove(PerThreadSynch *s) {
     intptr_t nv;
     do {                        // release spinlock and lock
       v = mu_.load(std::memory_order_relaxed);
-      nv = v & (kMuDesig | kMuEvent);
+      nv = v & (kMuDesig | kMuEvent | kMuNamed);
       if (h != nullptr) {
         nv |= kMuWait | reinterpret_cast<intptr_t>(h);
         h->readers = 0;            // we hold writer lock
@@ -1140,26 +1207,43 @@ static GraphId GetGraphId(Mutex *mu) LOCKS_EXCLUDED(deadlock_graph_mu) {
   return id;
 }
 
-// Record a lock acquisition.  This is used in debug mode for deadlock
-// detection.  The held_locks pointer points to the relevant data
-// structure for each case.
-static void LockEnter(Mutex* mu, GraphId id, SynchLocksHeld *held_locks) {
-  int n = held_locks->n;
+// Return the index of mu's entry in held_locks, or held_locks->n if there is
+// none.  Entries are matched by deadlock_graph id, or by address when id is
+// InvalidGraphId() because only held locks are being tracked.
+static int FindHeldLock(const Mutex *mu, GraphId id,
+                        const SynchLocksHeld *held_locks) {
+  const bool by_address = id == InvalidGraphId();
+  int n = held_locks->n.load(std::memory_order_relaxed);
   int i = 0;
-  while (i != n && held_locks->locks[i].id != id) {
+  while (i != n &&
+         (by_address
+              ? held_locks->locks[i].mu.load(std::memory_order_relaxed) != mu
+              : held_locks->locks[i].id != id)) {
     i++;
   }
+  return i;
+}
+
+// Record a lock acquisition.  This is used in debug mode for deadlock
+// detection, and in any mode for held-lock tracking.  The held_locks pointer
+// points to the relevant data structure for each case.
+static void LockEnter(Mutex* mu, GraphId id, SynchLocksHeld *held_locks) {
+  int n = held_locks->n.load(std::memory_order_relaxed);
+  int i = FindHeldLock(mu, id, held_locks);
   if (i == n) {
     if (n == ABSL_ARRAYSIZE(held_locks->locks)) {
-      held_locks->overflow = true;  // lost some data
+      // lost some data
+      held_locks->overflow.store(true, std::memory_order_relaxed);
     } else {                        // we have room for lock
-      held_locks->locks[i].mu = mu;
-      held_locks->locks[i].count = 1;
+      held_locks->locks[i].mu.store(mu, std::memory_order_relaxed);
+      held_locks->locks[i].count.store(1, std::memory_order_relaxed);
       held_locks->locks[i].id = id;
-      held_locks->n = n + 1;
+      held_locks->n.store(n + 1, std::memory_order_relaxed);
     }
   } else {
-    held_locks->locks[i].count++;
+    held_locks->locks[i].count.store(
+        held_locks->locks[i].count.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
   }
 }
 
@@ -1167,79 +1251,100 @@ static void LockEnter(Mutex* mu, GraphId id, SynchLocksHeld *held_locks) {
 // eventually followed by a call to LockLeave(mu, id, x) by the same thread.
 // It does not process the event if is not needed when deadlock detection is
 // disabled.
+// A lock released without a deadlock_graph id may have been acquired before
+// held-lock tracking was enabled, so it is not reported.
 static void LockLeave(Mutex* mu, GraphId id, SynchLocksHeld *held_locks) {
-  int n = held_locks->n;
-  int i = 0;
-  while (i != n && held_locks->locks[i].id != id) {
-    i++;
+  int n = held_locks->n.load(std::memory_order_relaxed);
+  int i = FindHeldLock(mu, id, held_locks);
+  if (i == n && id != InvalidGraphId()) {
+    // The deadlock id may have been reassigned after ForgetDeadlockInfo,
+    // but in that case mu should still be present.
+    i = FindHeldLock(mu, InvalidGraphId(), held_locks);
+    if (i == n && !held_locks->overflow.load(std::memory_order_relaxed)) {
+      // mu missing means releasing unheld lock
+      SynchEvent *mu_events = GetSynchEvent(mu);
+      ABSL_RAW_LOG(FATAL,
+                   "thread releasing lock it does not hold: %p %s; "
+                   ,
+                   static_cast<void *>(mu),
+                   mu_events == nullptr ? "" : mu_events->name);
+    }
   }
   if (i == n) {
-    if (!held_locks->overflow) {
-      // The deadlock id may have been reassigned after ForgetDeadlockInfo,
-      // but in that case mu should still be present.
-      i = 0;
-      while (i != n && held_locks->locks[i].mu != mu) {
-        i++;
-      }
-      if (i == n) {  // mu missing means releasing unheld lock
-        SynchEvent *mu_events = GetSynchEvent(mu);
-        ABSL_RAW_LOG(FATAL,
-                     "thread releasing lock it does not hold: %p %s; "
-                     ,
-                     static_cast<void *>(mu),
-                     mu_events == nullptr ? "" : mu_events->name);
-      }
-    }
-  } else if (held_locks->locks[i].count == 1) {
-    held_locks->n = n - 1;
-    held_locks->locks[i] = held_locks->locks[n - 1];
-    held_locks->locks[n - 1].id = InvalidGraphId();
-    held_locks->locks[n - 1].mu =
-        nullptr;  // clear mu to please the leak detector.
+    // Not recorded, because of overflow or because it was acquired before
+    // held locks were tracked.
   } else {
-    assert(held_locks->locks[i].count > 0);
-    held_locks->locks[i].count--;
+    const int32_t count =
+        held_locks->locks[i].count.load(std::memory_order_relaxed);
+    assert(count > 0);
+    if (count == 1) {
+      held_locks->n.store(n - 1, std::memory_order_relaxed);
+      held_locks->locks[i].mu.store(
+          held_locks->locks[n - 1].mu.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      held_locks->locks[i].count.store(
+          held_locks->locks[n - 1].count.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      held_locks->locks[i].id = held_locks->locks[n - 1].id;
+      held_locks->locks[n - 1].id = InvalidGraphId();
+      // clear mu to please the leak detector.
+      held_locks->locks[n - 1].mu.store(nullptr, std::memory_order_relaxed);
+    } else {
+      held_locks->locks[i].count.store(count - 1, std::memory_order_relaxed);
+    }
   }
 }
 
-// Call LockEnter() if in debug mode and deadlock detection is enabled.
-static inline void DebugOnlyLockEnter(Mutex *mu) {
-  if (kDebugMode) {
-    if (synch_deadlock_detection.load(std::memory_order_acquire) !=
-        OnDeadlockCycle::kIgnore) {
-      LockEnter(mu, GetGraphId(mu), Synch_GetAllLocks());
-    }
+// Return whether we're in debug mode and deadlock detection is enabled.
+static inline bool DebugOnlyDeadlockDetection() {
+  return kDebugMode &&
+         synch_deadlock_detection.load(std::memory_order_acquire) !=
+             OnDeadlockCycle::kIgnore;
+}
+
+// Return whether LockEnter() and LockLeave() should be called: in debug mode
+// with deadlock detection enabled, or when tracking held locks.
+static inline bool TrackingHeldLocks() {
+  return DebugOnlyDeadlockDetection() ||
+         synch_held_lock_tracking.load(std::memory_order_relaxed);
+}
+
+// Call LockEnter() if held locks are being tracked.
+static inline void MaybeLockEnter(Mutex *mu) {
+  if (TrackingHeldLocks()) {
+    LockEnter(mu,
+              DebugOnlyDeadlockDetection() ? GetGraphId(mu) : InvalidGraphId(),
+              Synch_GetAllLocks());
   }
 }
 
-// Call LockEnter() if in debug mode and deadlock detection is enabled.
-static inline void DebugOnlyLockEnter(Mutex *mu, GraphId id) {
-  if (kDebugMode) {
-    if (synch_deadlock_detection.load(std::memory_order_acquire) !=
-        OnDeadlockCycle::kIgnore) {
-      LockEnter(mu, id, Synch_GetAllLocks());
-    }
+// Call LockEnter() if held locks are being tracked.  id is the result of
+// MaybeDeadlockCheck(mu).
+static inline void MaybeLockEnter(Mutex *mu, GraphId id) {
+  if (TrackingHeldLocks()) {
+    LockEnter(mu, id, Synch_GetAllLocks());
   }
 }
 
-// Call LockLeave() if in debug mode and deadlock detection is enabled.
-static inline void DebugOnlyLockLeave(Mutex *mu) {
-  if (kDebugMode) {
-    if (synch_deadlock_detection.load(std::memory_order_acquire) !=
-        OnDeadlockCycle::kIgnore) {
-      LockLeave(mu, GetGraphId(mu), Synch_GetAllLocks());
-    }
+// Call LockLeave() if held locks are being tracked.
+static inline void MaybeLockLeave(Mutex *mu) {
+  if (TrackingHeldLocks()) {
+    LockLeave(mu,
+              DebugOnlyDeadlockDetection() ? GetGraphId(mu) : InvalidGraphId(),
+              Synch_GetAllLocks());
   }
 }
 
-static char *StackString(void **pcs, int n, char *buf, int maxlen,
+static char *StackString(void *const *pcs, int n, char *buf, int maxlen,
                          bool symbolize) {
   static const int kSymLen = 200;
   char sym[kSymLen];
   int len = 0;
   for (int i = 0; i != n; i++) {
     if (symbolize) {
-      if (!symbolizer(pcs[i], sym, kSymLen)) {
+      bool (*symbolize_fn)(const void *, char *, int) = symbolizer.Load();
+      if (symbolize_fn == nullptr) symbolize_fn = absl::Symbolize;
+      if (!symbolize_fn(pcs[i], sym, kSymLen)) {
         sym[0] = '\0';
       }
       snprintf(buf + len, maxlen - len, "%s\t@ %p %s\n",
@@ -1296,8 +1401,9 @@ static GraphId DeadlockCheck(Mutex *mu) {
 
   absl::base_internal::SpinLockHolder lock(&deadlock_graph_mu);
   const GraphId mu_id = GetGraphIdLocked(mu);
+  const int n = all_locks->n.load(std::memory_order_relaxed);
 
-  if (all_locks->n == 0) {
+  if (n == 0) {
     // There are no other locks held. Return now so that we don't need to
     // call GetSynchEvent(). This way we do not record the stack trace
     // for this Mutex. It's ok, since if this Mutex is involved in a deadlock,
@@ -1309,10 +1415,10 @@ static GraphId DeadlockCheck(Mutex *mu) {
   // as many locks as possible.  This increases the chances that a given edge
   // in the acquires-before graph will be represented in the stack traces
   // recorded for the locks.
-  deadlock_graph->UpdateStackTrace(mu_id, all_locks->n + 1, GetStack);
+  deadlock_graph->UpdateStackTrace(mu_id, n + 1, GetStack);
 
   // For each other mutex already held by this thread:
-  for (int i = 0; i != all_locks->n; i++) {
+  for (int i = 0; i != n; i++) {
     const GraphId other_node_id = all_locks->locks[i].id;
     const Mutex *other =
         static_cast<const Mutex *>(deadlock_graph->Ptr(other_node_id));
@@ -1332,7 +1438,7 @@ static GraphId DeadlockCheck(Mutex *mu) {
       ABSL_RAW_LOG(ERROR, "Potential Mutex deadlock: %s",
                    CurrentStackString(b->buf, sizeof (b->buf), symbolize));
       int len = 0;
-      for (int j = 0; j != all_locks->n; j++) {
+      for (int j = 0; j != n; j++) {
         void* pr = deadlock_graph->Ptr(all_locks->locks[j].id);
         if (pr != nullptr) {
           snprintf(b->buf + len, sizeof (b->buf) - len, " %p", pr);
@@ -1348,7 +1454,7 @@ static GraphId DeadlockCheck(Mutex *mu) {
         GraphId id = b->path[j];
         Mutex *path_mu = static_cast<Mutex *>(deadlock_graph->Ptr(id));
         if (path_mu == nullptr) continue;
-        void** stack;
+        void* const* stack;
         int depth = deadlock_graph->GetStackTrace(id, &stack);
         snprintf(b->buf, sizeof(b->buf),
                  "mutex@%p stack: ", static_cast<void *>(path_mu));
@@ -1370,17 +1476,525 @@ static GraphId DeadlockCheck(Mutex *mu) {
   return mu_id;
 }
 
-// Invoke DeadlockCheck() iff we're in debug mode and
-// deadlock checking has been enabled.
-static inline GraphId DebugOnlyDeadlockCheck(Mutex *mu) {
-  if (kDebugMode && synch_deadlock_detection.load(std::memory_order_acquire) !=
-                        OnDeadlockCycle::kIgnore) {
+//------------------------------------------------------------------
+// Lock-order checking.  Named Mutexes are grouped into classes by name, and
+// lock_order_graph has an edge from class A to class B once a thread has
+// acquired a B while holding an A.  Unlike deadlock_graph, whose nodes are
+// Mutex instances, the classes are the same from run to run, so the learned
+// order can be exported and checked against later.
+//
+// Every acquisition of a named Mutex is checked, so the check finds names and
+// known edges without locking, and takes lock_order_mu only to learn an edge.
+
+// Protects the lock-order state.  Readers of lock_order_names and
+// lock_order_edge_set need not hold it.
+static absl::base_internal::SpinLock lock_order_mu(
+    absl::base_internal::kLinkerInitialized);
+
+namespace {
+struct LockOrderClass {
+  LockOrderClass *next;  // in lock_order_classes
+  char name[1];          // actually longer---null-terminated std::string
+};
+
+// The class of a named Mutex, hashed into lock_order_names by address.
+// Entries are never freed, so that they can be read without lock_order_mu; an
+// entry whose Mutex is destroyed has masked_addr 0 until it is reused.
+struct LockOrderName {
+  LockOrderName *next;  // immutable once the entry is in lock_order_names
+  std::atomic<uintptr_t> masked_addr;
+  std::atomic<const LockOrderClass *> cls;
+};
+
+// An edge of lock_order_graph.
+struct LockOrderEdge {
+  LockOrderEdge *next;  // in lock_order_edges, oldest first
+  const LockOrderClass *before;
+  const LockOrderClass *after;
+  uint32_t stack_id;  // stack depot id of the first acquisition in this
+                      // order, or 0 if the edge was imported
+};
+
+// An open-addressing hash set of the edges of lock_order_graph.  Slots only
+// go from empty to full, so readers need no lock.  When the set is half full,
+// the edges are copied to a new set twice the size; the old one is never
+// freed, as readers may still be using it.
+struct LockOrderEdgeSet {
+  size_t mask;  // the number of slots, a power of 2, minus 1
+  struct Slot {
+    std::atomic<const LockOrderClass *> before;  // null if the slot is empty
+    std::atomic<const LockOrderClass *> after;
+  } slots[1];  // actually mask + 1 slots
+};
+}  // namespace
+
+static LockOrderClass *lock_order_classes GUARDED_BY(lock_order_mu);
+static std::atomic<LockOrderName *> lock_order_names[kNSynchEvent];
+static LockOrderEdge *lock_order_edges GUARDED_BY(lock_order_mu);
+static LockOrderEdge **lock_order_edges_end GUARDED_BY(lock_order_mu) =
+    &lock_order_edges;
+static size_t lock_order_num_edges GUARDED_BY(lock_order_mu);
+static std::atomic<LockOrderEdgeSet *> lock_order_edge_set;
+static GraphCycles *lock_order_graph GUARDED_BY(lock_order_mu)
+    PT_GUARDED_BY(lock_order_mu);
+
+// Return the class called name, creating it if necessary.
+static const LockOrderClass *InternLockOrderClass(const char *name)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  LockOrderClass *c = lock_order_classes;
+  while (c != nullptr && strcmp(c->name, name) != 0) {
+    c = c->next;
+  }
+  if (c == nullptr) {
+    c = reinterpret_cast<LockOrderClass *>(
+        base_internal::LowLevelAlloc::Alloc(sizeof(*c) + strlen(name)));
+    strcpy(c->name, name);  // NOLINT(runtime/printf)
+    c->next = lock_order_classes;
+    lock_order_classes = c;
+  }
+  return c;
+}
+
+// Return the entry in lock_order_names whose address is masked_addr, or null.
+// An entry for a Mutex changes only while the Mutex is named or destroyed, so
+// the caller needs no lock to look up one that it holds or is acquiring.
+static LockOrderName *FindLockOrderName(uintptr_t masked_addr, uint32_t h) {
+  for (LockOrderName *e = lock_order_names[h].load(std::memory_order_acquire);
+       e != nullptr; e = e->next) {
+    if (e->masked_addr.load(std::memory_order_acquire) == masked_addr) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+
+static uint32_t LockOrderNameHash(const Mutex *mu) {
+  return reinterpret_cast<uintptr_t>(mu) % kNSynchEvent;
+}
+
+// Return the class of mu, or null if it is not named.
+static const LockOrderClass *LockOrderClassOf(const Mutex *mu) {
+  LockOrderName *e = FindLockOrderName(MaskMu(mu), LockOrderNameHash(mu));
+  return e == nullptr ? nullptr : e->cls.load(std::memory_order_relaxed);
+}
+
+// Forget the name of mu, if it has one.
+static void ForgetLockOrderName(const Mutex *mu) {
+  absl::base_internal::SpinLockHolder l(&lock_order_mu);
+  LockOrderName *e = FindLockOrderName(MaskMu(mu), LockOrderNameHash(mu));
+  if (e != nullptr) {
+    e->masked_addr.store(0, std::memory_order_relaxed);  // free for reuse
+  }
+}
+
+static GraphId LockOrderId(const LockOrderClass *c)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  if (lock_order_graph == nullptr) {
+    lock_order_graph =
+        new (base_internal::LowLevelAlloc::Alloc(sizeof(*lock_order_graph)))
+            GraphCycles;
+  }
+  return lock_order_graph->GetId(const_cast<LockOrderClass *>(c));
+}
+
+static size_t LockOrderEdgeHash(const LockOrderClass *before,
+                                const LockOrderClass *after) {
+  size_t h = reinterpret_cast<uintptr_t>(before) * 0x9E3779B9u ^
+             reinterpret_cast<uintptr_t>(after);
+  return h ^ (h >> 16);
+}
+
+// Return whether before is already known to be acquired before after.  Needs
+// no lock; an edge being learned concurrently may be missed.
+static bool KnownLockOrderEdge(const LockOrderClass *before,
+                               const LockOrderClass *after) {
+  const LockOrderEdgeSet *set =
+      lock_order_edge_set.load(std::memory_order_acquire);
+  if (set == nullptr) return false;
+  for (size_t i = LockOrderEdgeHash(before, after);; i++) {
+    const LockOrderEdgeSet::Slot &slot = set->slots[i & set->mask];
+    const LockOrderClass *b = slot.before.load(std::memory_order_acquire);
+    if (b == nullptr) return false;
+    if (b == before && slot.after.load(std::memory_order_relaxed) == after) {
+      return true;
+    }
+  }
+}
+
+// Add e to set, which has room for it.
+static void InsertLockOrderEdge(LockOrderEdgeSet *set, const LockOrderEdge *e)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  for (size_t i = LockOrderEdgeHash(e->before, e->after);; i++) {
+    LockOrderEdgeSet::Slot &slot = set->slots[i & set->mask];
+    if (slot.before.load(std::memory_order_relaxed) == nullptr) {
+      slot.after.store(e->after, std::memory_order_relaxed);
+      slot.before.store(e->before, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+// Make e, the newest of lock_order_edges, visible to KnownLockOrderEdge().
+static void PublishLockOrderEdge(const LockOrderEdge *e)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  LockOrderEdgeSet *set = lock_order_edge_set.load(std::memory_order_relaxed);
+  if (set != nullptr && 2 * lock_order_num_edges <= set->mask + 1) {
+    InsertLockOrderEdge(set, e);
+    return;
+  }
+  size_t num_slots = set == nullptr ? 64 : 2 * (set->mask + 1);
+  while (2 * lock_order_num_edges > num_slots) num_slots *= 2;
+  set = reinterpret_cast<LockOrderEdgeSet *>(
+      base_internal::LowLevelAlloc::Alloc(
+          sizeof(*set) + (num_slots - 1) * sizeof(set->slots[0])));
+  set->mask = num_slots - 1;
+  for (size_t i = 0; i != num_slots; i++) {
+    set->slots[i].before.store(nullptr, std::memory_order_relaxed);
+    set->slots[i].after.store(nullptr, std::memory_order_relaxed);
+  }
+  for (const LockOrderEdge *old = lock_order_edges; old != nullptr;
+       old = old->next) {
+    InsertLockOrderEdge(set, old);
+  }
+  lock_order_edge_set.store(set, std::memory_order_release);
+}
+
+// Record that before is acquired before after, first at the stack named by
+// stack_id.  Return false, changing nothing, if that contradicts the order
+// already known.
+static bool AddLockOrderEdge(const LockOrderClass *before,
+                             const LockOrderClass *after, uint32_t stack_id)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  const GraphId before_id = LockOrderId(before);
+  const GraphId after_id = LockOrderId(after);
+  if (lock_order_graph->HasEdge(before_id, after_id)) {
+    return true;
+  }
+  if (!lock_order_graph->InsertEdge(before_id, after_id)) {
+    return false;
+  }
+  LockOrderEdge *e = reinterpret_cast<LockOrderEdge *>(
+      base_internal::LowLevelAlloc::Alloc(sizeof(*e)));
+  e->next = nullptr;
+  e->before = before;
+  e->after = after;
+  e->stack_id = stack_id;
+  *lock_order_edges_end = e;
+  lock_order_edges_end = &e->next;
+  lock_order_num_edges++;
+  PublishLockOrderEdge(e);
+  return true;
+}
+
+// Log why acquiring a mutex of class after while holding one of class before
+// contradicts the learned lock order.
+static void ReportLockOrderViolation(const Mutex *mu,
+                                     const LockOrderClass *before,
+                                     const LockOrderClass *after)
+    EXCLUSIVE_LOCKS_REQUIRED(lock_order_mu) {
+  ScopedDeadlockReportBuffers scoped_buffers;
+  DeadlockReportBuffers *b = scoped_buffers.b;
+  static int number_of_reported_violations = 0;
+  number_of_reported_violations++;
+  // Symbolize only the first 2 reports to avoid huge slowdowns.
+  bool symbolize = number_of_reported_violations <= 2;
+  ABSL_RAW_LOG(ERROR,
+               "Mutex lock-order violation: acquiring %p \"%s\" while "
+               "holding \"%s\": %s",
+               static_cast<const void *>(mu), after->name, before->name,
+               CurrentStackString(b->buf, sizeof (b->buf), symbolize));
+  ABSL_RAW_LOG(ERROR, "Learned order: ");
+  int path_len =
+      lock_order_graph->FindPath(LockOrderId(after), LockOrderId(before),
+                                 ABSL_ARRAYSIZE(b->path), b->path);
+  path_len = std::min<int>(path_len, ABSL_ARRAYSIZE(b->path));
+  for (int j = 0; j + 1 < path_len; j++) {
+    const LockOrderClass *x =
+        static_cast<const LockOrderClass *>(lock_order_graph->Ptr(b->path[j]));
+    const LockOrderClass *y = static_cast<const LockOrderClass *>(
+        lock_order_graph->Ptr(b->path[j + 1]));
+    uint32_t stack_id = 0;
+    for (const LockOrderEdge *e = lock_order_edges; e != nullptr;
+         e = e->next) {
+      if (e->before == x && e->after == y) stack_id = e->stack_id;
+    }
+    snprintf(b->buf, sizeof(b->buf), "\"%s\" before \"%s\", %s", x->name,
+             y->name, stack_id == 0 ? "imported" : "first seen at:");
+    void *const *stack;
+    int depth = debug_internal::StackDepotGet(stack_id, &stack);
+    StackString(stack, depth, b->buf + strlen(b->buf),
+                static_cast<int>(sizeof(b->buf) - strlen(b->buf)),
+                symbolize);
+    ABSL_RAW_LOG(ERROR, "%s", b->buf);
+  }
+}
+
+// Helper to record the stack of a new lock-order edge.
+static uint32_t CurrentStackId() {
+  void *pcs[40];
+  return debug_internal::StackDepotPut(
+      pcs, absl::GetStackTrace(pcs, ABSL_ARRAYSIZE(pcs), 2));
+}
+
+// Learn that a mutex of class before is held while mu, of class after, is
+// acquired, first at the stack named by stack_id, and report a violation if
+// that contradicts the learned order.  Return false if it does.
+static bool LearnLockOrderEdge(Mutex *mu, const LockOrderClass *before,
+                               const LockOrderClass *after, uint32_t stack_id) {
+  lock_order_mu.Lock();
+  if (AddLockOrderEdge(before, after, stack_id)) {
+    lock_order_mu.Unlock();
+    return true;
+  }
+  ReportLockOrderViolation(mu, before, after);
+  lock_order_mu.Unlock();
+  if (synch_lock_order.load(std::memory_order_acquire) ==
+      OnDeadlockCycle::kAbort) {
+    ABSL_RAW_LOG(FATAL, "dying due to lock-order violation");
+  }
+  return false;
+}
+
+// Called when the lock-order checker is on and a thread is about to acquire
+// the named Mutex mu, whether or not it will block.  Orders already learned
+// are checked without locking; lock_order_mu is taken only for a new one.
+static void LockOrderCheck(Mutex *mu) {
+  SynchLocksHeld *all_locks = Synch_GetAllLocks();
+  const int n = all_locks->n.load(std::memory_order_relaxed);
+  if (n == 0) {
+    return;
+  }
+  const LockOrderClass *cls = LockOrderClassOf(mu);
+  for (int i = 0; cls != nullptr && i != n; i++) {
+    const LockOrderClass *before = LockOrderClassOf(
+        all_locks->locks[i].mu.load(std::memory_order_relaxed));
+    if (before == nullptr || before == cls ||
+        KnownLockOrderEdge(before, cls)) {
+      continue;
+    }
+    if (!LearnLockOrderEdge(mu, before, cls, CurrentStackId())) {
+      break;  // report at most one violation per acquisition
+    }
+  }
+}
+
+// Invoke LockOrderCheck() if the lock-order checker is on and mu, whose state
+// word is *mu_word, is named, and DeadlockCheck() iff we're in debug mode and
+// deadlock checking has been enabled.  Checking the kMuNamed bit first saves
+// acquisitions of unnamed Mutexes the lookup of their names.
+static inline GraphId MaybeDeadlockCheck(
+    Mutex *mu, const std::atomic<intptr_t> *mu_word) {
+  if (synch_lock_order.load(std::memory_order_relaxed) !=
+          OnDeadlockCycle::kIgnore &&
+      (mu_word->load(std::memory_order_relaxed) & kMuNamed) != 0) {
+    LockOrderCheck(mu);
+  }
+  if (DebugOnlyDeadlockDetection()) {
     return DeadlockCheck(mu);
   } else {
     return InvalidGraphId();
   }
 }
 
+void Mutex::SetLockOrderName(const char *name) {
+  {
+    absl::base_internal::SpinLockHolder l(&lock_order_mu);
+    const LockOrderClass *cls = InternLockOrderClass(name);
+    const uint32_t h = LockOrderNameHash(this);
+    LockOrderName *e = FindLockOrderName(MaskMu(this), h);
+    if (e == nullptr) {
+      e = FindLockOrderName(0, h);  // reuse the entry of a destroyed Mutex
+      if (e == nullptr) {
+        e = reinterpret_cast<LockOrderName *>(
+            base_internal::LowLevelAlloc::Alloc(sizeof(*e)));
+        e->next = lock_order_names[h].load(std::memory_order_relaxed);
+        e->masked_addr.store(0, std::memory_order_relaxed);
+        lock_order_names[h].store(e, std::memory_order_release);
+      }
+      e->cls.store(cls, std::memory_order_relaxed);
+      e->masked_addr.store(MaskMu(this), std::memory_order_release);
+    } else {
+      e->cls.store(cls, std::memory_order_relaxed);
+    }
+  }
+  // Set the bit only once the name can be found, so that LockOrderCheck() and
+  // ~Mutex() look it up only for named Mutexes.
+  AtomicSetBits(&this->mu_, kMuNamed, kMuSpin);
+}
+
+void SetMutexLockOrderMode(OnDeadlockCycle mode) {
+  synch_lock_order.store(mode, std::memory_order_release);
+  synch_held_lock_tracking.store(
+      mode != OnDeadlockCycle::kIgnore ||
+          synch_held_lock_tracking_enabled.load(std::memory_order_relaxed),
+      std::memory_order_release);
+}
+
+std::string ExportMutexLockOrder() {
+  std::string order;
+  absl::base_internal::SpinLockHolder l(&lock_order_mu);
+  for (const LockOrderEdge *e = lock_order_edges; e != nullptr; e = e->next) {
+    order.append(e->before->name);
+    order.push_back('\t');
+    order.append(e->after->name);
+    order.push_back('\n');
+  }
+  return order;
+}
+
+bool ImportMutexLockOrder(const std::string &order) {
+  absl::base_internal::SpinLockHolder l(&lock_order_mu);
+  size_t pos = 0;
+  while (pos < order.size()) {
+    size_t eol = order.find('\n', pos);
+    if (eol == std::string::npos) eol = order.size();
+    const std::string line = order.substr(pos, eol - pos);
+    pos = eol + 1;
+    if (line.empty() || line[0] == '#') continue;
+    size_t tab = line.find('\t');
+    if (tab == 0 || tab == std::string::npos || tab + 1 == line.size() ||
+        line.find('\t', tab + 1) != std::string::npos) {
+      return false;
+    }
+    const LockOrderClass *before =
+        InternLockOrderClass(line.substr(0, tab).c_str());
+    const LockOrderClass *after =
+        InternLockOrderClass(line.substr(tab + 1).c_str());
+    if (before == after || !AddLockOrderEdge(before, after, 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int GetHeldMutexes(const Mutex **mutexes, int max_mutexes) {
+  ThreadIdentity *identity = CurrentThreadIdentityIfPresent();
+  if (!TrackingHeldLocks() || identity == nullptr ||
+      identity->per_thread_synch.all_locks == nullptr) {
+    return 0;
+  }
+  const SynchLocksHeld *all_locks = identity->per_thread_synch.all_locks;
+  const int n = all_locks->n.load(std::memory_order_relaxed);
+  for (int i = 0; i != n && i != max_mutexes; i++) {
+    mutexes[i] = all_locks->locks[i].mu.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+// Append the address of the Mutex or CondVar obj to *out, with its name if
+// it has one.
+static void AppendSynchName(const void *obj, std::string *out) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%p", obj);
+  out->append(buf);
+  const char *name = nullptr;
+  SynchEvent *e = GetSynchEvent(obj);
+  if (e != nullptr && e->name[0] != '\0') {
+    name = e->name;
+  } else {
+    absl::base_internal::SpinLockHolder l(&lock_order_mu);
+    const LockOrderClass *cls =
+        LockOrderClassOf(static_cast<const Mutex *>(obj));
+    if (cls != nullptr) name = cls->name;  // classes are never freed
+  }
+  if (name != nullptr) {
+    out->append(" \"");
+    out->append(name);
+    out->append("\"");
+  }
+  UnrefSynchEvent(e);
+}
+
+namespace {
+// A copy of one thread's SynchLocksHeld, taken by DumpHeldMutexes().
+struct HeldMutexesSnapshot {
+  pid_t tid;
+  int n;
+  bool overflow;
+  struct {
+    const Mutex *mu;
+    int32_t count;
+  } locks[ABSL_ARRAYSIZE(SynchLocksHeld::locks)];
+  const Mutex *waiting_for;
+  const CondVar *waiting_on_cv;
+};
+}  // namespace
+
+// Copy the entries of t that DumpHeldMutexes() reports into *snapshot.
+static void SnapshotHeldMutexes(const SynchLocksHeld *t,
+                                HeldMutexesSnapshot *snapshot) {
+  snapshot->tid = t->tid;
+  // t's thread may be changing its entries, so clamp the count.
+  snapshot->n = std::min<int>(std::max(t->n.load(std::memory_order_relaxed), 0),
+                              ABSL_ARRAYSIZE(t->locks));
+  snapshot->overflow = t->overflow.load(std::memory_order_relaxed);
+  for (int i = 0; i != snapshot->n; i++) {
+    snapshot->locks[i].mu = t->locks[i].mu.load(std::memory_order_relaxed);
+    snapshot->locks[i].count =
+        t->locks[i].count.load(std::memory_order_relaxed);
+  }
+  snapshot->waiting_for = t->waiting_for.load(std::memory_order_relaxed);
+  snapshot->waiting_on_cv = t->waiting_on_cv.load(std::memory_order_relaxed);
+}
+
+void DumpHeldMutexes(void (*writerfn)(const char *)) {
+  // Copy every thread's entries while holding all_locks_list_mu, and format
+  // them after releasing it, so that nothing allocates under the spinlock.
+  // If threads were added since the snapshots were sized, try again.
+  std::vector<HeldMutexesSnapshot> snapshots;
+  size_t num_threads;
+  for (;;) {
+    num_threads = 0;
+    {
+      absl::base_internal::SpinLockHolder l(&all_locks_list_mu);
+      for (const SynchLocksHeld *t = all_locks_list; t != nullptr;
+           t = t->next) {
+        if (num_threads < snapshots.size()) {
+          SnapshotHeldMutexes(t, &snapshots[num_threads]);
+        }
+        num_threads++;
+      }
+    }
+    if (num_threads <= snapshots.size()) break;
+    snapshots.resize(num_threads + num_threads / 8 + 1);
+  }
+  snapshots.resize(num_threads);
+
+  std::string dump;
+  for (const HeldMutexesSnapshot &t : snapshots) {
+    if (t.n == 0 && t.waiting_for == nullptr && t.waiting_on_cv == nullptr) {
+      continue;
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "Thread %d:\n", static_cast<int>(t.tid));
+    dump.append(buf);
+    for (int i = 0; i != t.n; i++) {
+      dump.append("  holds ");
+      AppendSynchName(t.locks[i].mu, &dump);
+      if (t.locks[i].count > 1) {
+        snprintf(buf, sizeof(buf), " (%d times)",
+                 static_cast<int>(t.locks[i].count));
+        dump.append(buf);
+      }
+      dump.append("\n");
+    }
+    if (t.overflow) {
+      dump.append("  (some held Mutexes were not recorded)\n");
+    }
+    if (t.waiting_for != nullptr) {
+      dump.append("  blocked on Mutex ");
+      AppendSynchName(t.waiting_for, &dump);
+      dump.append("\n");
+    }
+    if (t.waiting_on_cv != nullptr) {
+      dump.append("  blocked on CondVar ");
+      AppendSynchName(t.waiting_on_cv, &dump);
+      dump.append("\n");
+    }
+  }
+  if (!dump.empty()) writerfn(dump.c_str());
+}
+
 void Mutex::ForgetDeadlockInfo() {
   if (kDebugMode && synch_deadlock_detection.load(std::memory_order_acquire) !=
                         OnDeadlockCycle::kIgnore) {
@@ -1401,7 +2015,8 @@ void Mutex::AssertNotHeld() const {
           OnDeadlockCycle::kIgnore) {
     GraphId id = GetGraphId(const_cast<Mutex *>(this));
     SynchLocksHeld *locks = Synch_GetAllLocks();
-    for (int i = 0; i != locks->n; i++) {
+    const int n = locks->n.load(std::memory_order_relaxed);
+    for (int i = 0; i != n; i++) {
       if (locks->locks[i].id == id) {
         SynchEvent *mu_events = GetSynchEvent(this);
         ABSL_RAW_LOG(FATAL, "thread should not hold mutex %p %s",
@@ -1434,7 +2049,7 @@ static bool TryAcquireWithSpinning(std::atomic<intptr_t>* mu) {
 
 ABSL_XRAY_LOG_ARGS(1) void Mutex::Lock() {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, 0);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   intptr_t v = mu_.load(std::memory_order_relaxed);
   // try fast acquire, then spin loop
   if ((v & (kMuWriter | kMuReader | kMuEvent)) != 0 ||
@@ -1446,13 +2061,13 @@ ABSL_XRAY_LOG_ARGS(1) void Mutex::Lock() {
       this->LockSlow(kExclusive, nullptr, 0);
     }
   }
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, 0, 0);
 }
 
 ABSL_XRAY_LOG_ARGS(1) void Mutex::ReaderLock() {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, __tsan_mutex_read_lock);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   intptr_t v = mu_.load(std::memory_order_relaxed);
   // try fast acquire, then slow loop
   if ((v & (kMuWriter | kMuWait | kMuEvent)) != 0 ||
@@ -1461,15 +2076,15 @@ ABSL_XRAY_LOG_ARGS(1) void Mutex::ReaderLock() {
                                    std::memory_order_relaxed)) {
     this->LockSlow(kShared, nullptr, 0);
   }
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, __tsan_mutex_read_lock, 0);
 }
 
 void Mutex::LockWhen(const Condition &cond) {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, 0);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   this->LockSlow(kExclusive, &cond, 0);
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, 0, 0);
 }
 
@@ -1479,19 +2094,19 @@ bool Mutex::LockWhenWithTimeout(const Condition &cond, absl::Duration timeout) {
 
 bool Mutex::LockWhenWithDeadline(const Condition &cond, absl::Time deadline) {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, 0);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   bool res = LockSlowWithDeadline(kExclusive, &cond,
                                   KernelTimeout(deadline), 0);
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, 0, 0);
   return res;
 }
 
 void Mutex::ReaderLockWhen(const Condition &cond) {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, __tsan_mutex_read_lock);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   this->LockSlow(kShared, &cond, 0);
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, __tsan_mutex_read_lock, 0);
 }
 
@@ -1503,9 +2118,9 @@ bool Mutex::ReaderLockWhenWithTimeout(const Condition &cond,
 bool Mutex::ReaderLockWhenWithDeadline(const Condition &cond,
                                        absl::Time deadline) {
   ABSL_TSAN_MUTEX_PRE_LOCK(this, __tsan_mutex_read_lock);
-  GraphId id = DebugOnlyDeadlockCheck(this);
+  GraphId id = MaybeDeadlockCheck(this, &this->mu_);
   bool res = LockSlowWithDeadline(kShared, &cond, KernelTimeout(deadline), 0);
-  DebugOnlyLockEnter(this, id);
+  MaybeLockEnter(this, id);
   ABSL_TSAN_MUTEX_POST_LOCK(this, __tsan_mutex_read_lock, 0);
   return res;
 }
@@ -1570,7 +2185,7 @@ ABSL_XRAY_LOG_ARGS(1) bool Mutex::TryLock() {
       mu_.compare_exchange_strong(v, kMuWriter | v,
                                   std::memory_order_acquire,
                                   std::memory_order_relaxed)) {
-    DebugOnlyLockEnter(this);
+    MaybeLockEnter(this);
     ABSL_TSAN_MUTEX_POST_LOCK(this, __tsan_mutex_try_lock, 0);
     return true;
   }
@@ -1579,7 +2194,7 @@ ABSL_XRAY_LOG_ARGS(1) bool Mutex::TryLock() {
         mu_.compare_exchange_strong(
             v, (kExclusive->fast_or | v) + kExclusive->fast_add,
             std::memory_order_acquire, std::memory_order_relaxed)) {
-      DebugOnlyLockEnter(this);
+      MaybeLockEnter(this);
       PostSynchEvent(this, SYNCH_EV_TRYLOCK_SUCCESS);
       ABSL_TSAN_MUTEX_POST_LOCK(this, __tsan_mutex_try_lock, 0);
       return true;
@@ -1604,7 +2219,7 @@ ABSL_XRAY_LOG_ARGS(1) bool Mutex::ReaderTryLock() {
     if (mu_.compare_exchange_strong(v, (kMuReader | v) + kMuOne,
                                     std::memory_order_acquire,
                                     std::memory_order_relaxed)) {
-      DebugOnlyLockEnter(this);
+      MaybeLockEnter(this);
       ABSL_TSAN_MUTEX_POST_LOCK(
           this, __tsan_mutex_read_lock | __tsan_mutex_try_lock, 0);
       return true;
@@ -1618,7 +2233,7 @@ ABSL_XRAY_LOG_ARGS(1) bool Mutex::ReaderTryLock() {
       if (mu_.compare_exchange_strong(v, (kMuReader | v) + kMuOne,
                                       std::memory_order_acquire,
                                       std::memory_order_relaxed)) {
-        DebugOnlyLockEnter(this);
+        MaybeLockEnter(this);
         PostSynchEvent(this, SYNCH_EV_READERTRYLOCK_SUCCESS);
         ABSL_TSAN_MUTEX_POST_LOCK(
             this, __tsan_mutex_read_lock | __tsan_mutex_try_lock, 0);
@@ -1640,7 +2255,7 @@ ABSL_XRAY_LOG_ARGS(1) bool Mutex::ReaderTryLock() {
 
 ABSL_XRAY_LOG_ARGS(1) void Mutex::Unlock() {
   ABSL_TSAN_MUTEX_PRE_UNLOCK(this, 0);
-  DebugOnlyLockLeave(this);
+  MaybeLockLeave(this);
   intptr_t v = mu_.load(std::memory_order_relaxed);
 
   if (kDebugMode && ((v & (kMuWriter | kMuReader)) != kMuWriter)) {
@@ -1692,7 +2307,7 @@ static bool ExactlyOneReader(intptr_t v) {
 
 ABSL_XRAY_LOG_ARGS(1) void Mutex::ReaderUnlock() {
   ABSL_TSAN_MUTEX_PRE_UNLOCK(this, __tsan_mutex_read_lock);
-  DebugOnlyLockLeave(this);
+  MaybeLockLeave(this);
   intptr_t v = mu_.load(std::memory_order_relaxed);
   assert((v & (kMuWriter|kMuReader)) == kMuReader);
   if ((v & (kMuReader|kMuWait|kMuEvent)) == kMuReader) {
@@ -1868,6 +2483,16 @@ static void CheckForMutexCorruption(intptr_t v, const char* label) {
 
 void Mutex::LockSlowLoop(SynchWaitParams *waitp, int flags) {
   int c = 0;
+  // Note what this thread is blocked on for DumpHeldMutexes().  A Condition
+  // evaluated below may block on another Mutex, so restore the previous
+  // value on return.
+  SynchLocksHeld *held_locks = nullptr;
+  const Mutex *was_waiting_for = nullptr;
+  if (TrackingHeldLocks()) {
+    held_locks = Synch_GetAllLocks();
+    was_waiting_for =
+        held_locks->waiting_for.exchange(this, std::memory_order_relaxed);
+  }
   intptr_t v = mu_.load(std::memory_order_relaxed);
   if ((v & kMuEvent) != 0) {
     PostSynchEvent(this,
@@ -1976,6 +2601,9 @@ void Mutex::LockSlowLoop(SynchWaitParams *waitp, int flags) {
                    waitp->how == kExclusive? SYNCH_EV_LOCK_RETURNING :
                                       SYNCH_EV_READERLOCK_RETURNING);
   }
+  if (held_locks != nullptr) {
+    held_locks->waiting_for.store(was_waiting_for, std::memory_order_relaxed);
+  }
 }
 
 // Unlock this mutex, which is held by the current thread.
@@ -2236,7 +2864,7 @@ void Mutex::UnlockSlow(SynchWaitParams *waitp) {
       // singly-linked list wake_list.  Returns the new head.
       h = DequeueAllWakeable(h, pw, &wake_list);
 
-      intptr_t nv = (v & kMuEvent) | kMuDesig;
+      intptr_t nv = (v & (kMuEvent | kMuNamed)) | kMuDesig;
                                              // assume no waiters left,
                                              // set kMuDesig for INV1a
 
@@ -2490,6 +3118,12 @@ bool CondVar::WaitCommon(Mutex *mutex, KernelTimeout t) {
     PostSynchEvent(this, SYNCH_EV_WAIT);
   }
 
+  SynchLocksHeld *held_locks = nullptr;
+  if (TrackingHeldLocks()) {
+    held_locks = Synch_GetAllLocks();
+    held_locks->waiting_on_cv.store(this, std::memory_order_relaxed);
+  }
+
   // Release mu and wait on condition variable.
   SynchWaitParams waitp(mutex_how, nullptr, t, mutex,
                         Synch_GetPerThreadAnnotated(mutex), &cv_);
@@ -2509,6 +3143,9 @@ bool CondVar::WaitCommon(Mutex *mutex, KernelTimeout t) {
 
   ABSL_RAW_CHECK(waitp.thread->waitp != nullptr, "not waiting when should be");
   waitp.thread->waitp = nullptr;  // cleanup
+  if (held_locks != nullptr) {
+    held_locks->waiting_on_cv.store(nullptr, std::memory_order_relaxed);
+  }
 
   // maybe trace this call
   cond_var_tracer("Unwait", this);
@@ -420,6 +420,14 @@ class LOCKABLE Mutex {
   // are true.
   void AssertNotHeld() const;
 
+  // Mutex::SetLockOrderName()
+  //
+  // Names the lock-order class of this `Mutex` for the lock-order checker
+  // (see `SetMutexLockOrderMode()` below). Mutexes with the same name share
+  // a class, so the order learned for one instance applies to all of them.
+  // `name` is copied. Unnamed mutexes are ignored by the checker.
+  void SetLockOrderName(const char *name);
+
   // Special cases.
 
   // A `MuHow` is a constant that indicates how a lock should be acquired.
@@ -956,7 +964,7 @@ void RegisterCondVarTracer(void (*fn)(const char *msg, const void *cv));
 // 'pc' is the program counter being symbolized, 'out' is the buffer to write
 // into, and 'out_size' is the size of the buffer.  This function can return
 // false if symbolizing failed, or true if a null-terminated symbol was written
-// to 'out.'
+// to 'out.'  If no hook is registered, absl::Symbolize() is used.
 //
 // This has the same memory ordering concerns as RegisterMutexProfiler() above.
 void RegisterSymbolizer(bool (*fn)(const void *pc, char *out, int out_size));
@@ -988,6 +996,67 @@ enum class OnDeadlockCycle {
 // the manner chosen here.
 void SetMutexDeadlockDetectionMode(OnDeadlockCycle mode);
 
+// Held-lock introspection
+
+// EnableHeldMutexTracking()
+//
+// Enable or disable recording, in all build modes, of the Mutexes each thread
+// holds and the Mutex or CondVar it is blocked on.  Recording costs a few
+// instructions per acquire and release.  Debug builds with deadlock detection
+// enabled record held Mutexes regardless of this setting.  Mutexes acquired
+// before recording was enabled are not reported.
+void EnableHeldMutexTracking(bool enabled);
+
+// GetHeldMutexes()
+//
+// Stores up to `max_mutexes` pointers to the Mutexes the calling thread holds
+// into `mutexes`, and returns how many it holds, which may exceed
+// `max_mutexes`.  Returns 0 unless held Mutexes are being recorded (see
+// `EnableHeldMutexTracking()`).  At most 40 Mutexes per thread are recorded.
+int GetHeldMutexes(const Mutex **mutexes, int max_mutexes);
+
+// DumpHeldMutexes()
+//
+// Describes, for each thread that holds or is blocked on a Mutex, the Mutexes
+// it holds and what it is blocked on, and passes the description to
+// `writerfn` in nul-terminated pieces.  Intended for diagnosing hangs: other
+// threads' state is read without stopping them, so a thread that is not
+// stuck may be described inconsistently.  Not async-signal-safe.
+void DumpHeldMutexes(void (*writerfn)(const char *));
+
+// Lock-order checking
+
+// SetMutexLockOrderMode()
+//
+// Enable or disable the lock-order checker, in all build modes.  While it is
+// enabled, each time a thread blocks to acquire a named Mutex (see
+// `Mutex::SetLockOrderName()`) while holding another, the checker learns that
+// the held Mutex's class is acquired before the new one's.  An acquisition
+// that contradicts the learned order is reported in the manner chosen here,
+// together with the stacks where the contradicted order was first seen.
+// 'kIgnore' disables the checker, but keeps what it has learned.
+//
+// The learned order can be saved with `ExportMutexLockOrder()` and, in a
+// later run such as a test, loaded with `ImportMutexLockOrder()` so that new
+// code which inverts it is reported.  Acquiring or destroying an unnamed Mutex
+// costs only flag checks; only acquisitions of named Mutexes made while
+// holding another Mutex consult the shared lock-order state.
+void SetMutexLockOrderMode(OnDeadlockCycle mode);
+
+// ExportMutexLockOrder()
+//
+// Returns the lock order learned or imported so far, as one
+// "<before>\t<after>\n" line per pair of lock-order class names.
+std::string ExportMutexLockOrder();
+
+// ImportMutexLockOrder()
+//
+// Adds the pairs in `order`, in the format produced by
+// `ExportMutexLockOrder()`, to the learned lock order.  Blank lines and lines
+// starting with '#' are ignored.  Returns false if a line is malformed or
+// contradicts the order already known; the pairs before it are kept.
+bool ImportMutexLockOrder(const std::string &order);
+
 }  // namespace absl
 
 // In some build configurations we pass --detect-odr-violations to the
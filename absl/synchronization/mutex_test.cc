@@ -1141,6 +1141,239 @@ TEST(Mutex, DeadlockIdBug) NO_THREAD_SAFETY_ANALYSIS {
   c.Lock();
   c.Unlock();
 }
+
+// The held-lock tests below run on new threads, because tests above destroy
+// Mutexes while holding them, which leaves them recorded as held.
+
+TEST(Mutex, GetHeldMutexes) NO_THREAD_SAFETY_ANALYSIS {
+  absl::Mutex before_tracking;
+  absl::Mutex a;
+  absl::Mutex b;
+  std::thread([&] {
+    before_tracking.Lock();
+    absl::EnableHeldMutexTracking(true);
+    before_tracking.Unlock();  // must not be reported as an error
+
+    const absl::Mutex *held[2] = {nullptr, nullptr};
+    EXPECT_EQ(0, absl::GetHeldMutexes(held, 2));
+    a.Lock();
+    b.ReaderLock();
+    EXPECT_EQ(2, absl::GetHeldMutexes(held, 2));
+    EXPECT_TRUE((held[0] == &a && held[1] == &b) ||
+                (held[0] == &b && held[1] == &a));
+    EXPECT_EQ(2, absl::GetHeldMutexes(held, 1));
+    b.ReaderUnlock();
+    EXPECT_EQ(1, absl::GetHeldMutexes(held, 2));
+    EXPECT_EQ(&a, held[0]);
+    a.Unlock();
+    EXPECT_EQ(0, absl::GetHeldMutexes(held, 2));
+    absl::EnableHeldMutexTracking(false);
+  }).join();
+}
+
+static std::string *dumped_mutexes;
+static void AppendToDump(const char *s) { dumped_mutexes->append(s); }
+
+static std::string DumpHeldMutexes() {
+  std::string dump;
+  dumped_mutexes = &dump;
+  absl::DumpHeldMutexes(AppendToDump);
+  dumped_mutexes = nullptr;
+  return dump;
+}
+
+static std::string Describe(const void *mu, const char *name) {
+  char buf[100];
+  snprintf(buf, sizeof(buf), "%p \"%s\"", mu, name);
+  return buf;
+}
+
+TEST(Mutex, DumpHeldMutexes) {
+  absl::EnableHeldMutexTracking(true);
+  absl::Mutex a;
+  absl::Mutex b;
+  a.SetLockOrderName("DumpHeldMutexes.a");
+  b.SetLockOrderName("DumpHeldMutexes.b");
+
+  // holder holds b until released, while waiter holds a and blocks on b.
+  absl::Mutex mu;
+  bool b_held = false;
+  bool release = false;
+  std::thread holder([&] {
+    absl::MutexLock lb(&b);
+    mu.Lock();
+    b_held = true;
+    mu.Await(absl::Condition(&release));
+    mu.Unlock();
+  });
+  mu.LockWhen(absl::Condition(&b_held));
+  mu.Unlock();
+  std::thread waiter([&] {
+    absl::MutexLock la(&a);
+    absl::MutexLock lb(&b);
+  });
+
+  const std::string blocked =
+      "  blocked on Mutex " + Describe(&b, "DumpHeldMutexes.b") + "\n";
+  std::string dump;
+  while ((dump = DumpHeldMutexes()).find(blocked) == std::string::npos) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_NE(std::string::npos,
+            dump.find("  holds " + Describe(&a, "DumpHeldMutexes.a") + "\n" +
+                      blocked))
+      << dump;
+  EXPECT_NE(std::string::npos,
+            dump.find("  holds " + Describe(&b, "DumpHeldMutexes.b") + "\n"))
+      << dump;
+
+  mu.Lock();
+  release = true;
+  mu.Unlock();
+  holder.join();
+  waiter.join();
+  absl::EnableHeldMutexTracking(false);
+}
+
+TEST(Mutex, LockOrderChecker) NO_THREAD_SAFETY_ANALYSIS {
+  absl::Mutex a;
+  absl::Mutex b;
+  absl::Mutex c;
+  absl::Mutex unnamed;
+  a.SetLockOrderName("LockOrderChecker.a");
+  b.SetLockOrderName("LockOrderChecker.b");
+  c.SetLockOrderName("LockOrderChecker.c");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kAbort);
+  std::thread([&] {
+    {
+      absl::MutexLock la(&a);
+      absl::MutexLock lb(&b);
+    }
+    {
+      absl::MutexLock lb(&b);
+      absl::MutexLock lc(&c);
+      absl::MutexLock lu(&unnamed);
+    }
+    {
+      // Another Mutex with the same name shares the class's order.
+      absl::Mutex a2;
+      a2.SetLockOrderName("LockOrderChecker.a");
+      absl::MutexLock la2(&a2);
+      absl::MutexLock lc(&c);
+    }
+  }).join();
+  const std::string order = absl::ExportMutexLockOrder();
+  EXPECT_NE(std::string::npos,
+            order.find("LockOrderChecker.a\tLockOrderChecker.b\n"));
+  EXPECT_NE(std::string::npos,
+            order.find("LockOrderChecker.b\tLockOrderChecker.c\n"));
+  EXPECT_NE(std::string::npos,
+            order.find("LockOrderChecker.a\tLockOrderChecker.c\n"));
+  EXPECT_DEATH(std::thread([&] {
+                 c.Lock();
+                 b.Lock();
+               }).join(),
+               "lock-order violation");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kIgnore);
+}
+
+TEST(Mutex, ImportMutexLockOrder) NO_THREAD_SAFETY_ANALYSIS {
+  EXPECT_TRUE(absl::ImportMutexLockOrder(
+      "# Learned order\n"
+      "ImportMutexLockOrder.x\tImportMutexLockOrder.y\n"
+      "\n"
+      "ImportMutexLockOrder.y\tImportMutexLockOrder.z"));
+  EXPECT_FALSE(absl::ImportMutexLockOrder(
+      "ImportMutexLockOrder.z\tImportMutexLockOrder.x\n"));
+  EXPECT_FALSE(absl::ImportMutexLockOrder("ImportMutexLockOrder.x\n"));
+  EXPECT_NE(std::string::npos,
+            absl::ExportMutexLockOrder().find(
+                "ImportMutexLockOrder.x\tImportMutexLockOrder.y\n"
+                "ImportMutexLockOrder.y\tImportMutexLockOrder.z\n"));
+
+  absl::Mutex x;
+  absl::Mutex z;
+  x.SetLockOrderName("ImportMutexLockOrder.x");
+  z.SetLockOrderName("ImportMutexLockOrder.z");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kAbort);
+  std::thread([&] {
+    absl::MutexLock lx(&x);
+    absl::MutexLock lz(&z);
+  }).join();
+  EXPECT_DEATH(std::thread([&] {
+                 z.Lock();
+                 x.Lock();
+               }).join(),
+               "lock-order violation");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kIgnore);
+}
+
+// Orders already learned are looked up without locking, in a set that grows
+// as edges are learned, under names whose entries are reused once their
+// Mutexes are destroyed.  Check that none of this loses an edge.
+TEST(Mutex, LockOrderCheckerManyEdges) NO_THREAD_SAFETY_ANALYSIS {
+  constexpr int kClasses = 100;
+  std::vector<std::string> names;
+  for (int i = 0; i != kClasses; i++) {
+    names.push_back("LockOrderCheckerManyEdges." + std::to_string(i));
+  }
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kAbort);
+  for (int round = 0; round != 2; round++) {
+    std::thread([&] {
+      for (int i = 0; i + 1 != kClasses; i++) {
+        absl::Mutex before;
+        absl::Mutex after;
+        before.SetLockOrderName(names[i].c_str());
+        after.SetLockOrderName(names[i + 1].c_str());
+        absl::MutexLock lb(&before);
+        absl::MutexLock la(&after);
+      }
+    }).join();
+  }
+  const std::string order = absl::ExportMutexLockOrder();
+  for (int i = 0; i + 1 != kClasses; i++) {
+    const std::string edge = names[i] + "\t" + names[i + 1] + "\n";
+    const size_t pos = order.find(edge);
+    EXPECT_NE(std::string::npos, pos) << edge;
+    EXPECT_EQ(std::string::npos, order.find(edge, pos + 1)) << edge;
+  }
+  absl::Mutex first;
+  absl::Mutex last;
+  first.SetLockOrderName(names.front().c_str());
+  last.SetLockOrderName(names.back().c_str());
+  EXPECT_DEATH(std::thread([&] {
+                 last.Lock();
+                 first.Lock();
+               }).join(),
+               "lock-order violation");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kIgnore);
+}
+
+// A Mutex's name is recorded in its state word, which Unlock() rewrites when
+// it wakes a waiter.  Check that this does not lose it.
+TEST(Mutex, LockOrderNameSurvivesWakeup) NO_THREAD_SAFETY_ANALYSIS {
+  EXPECT_TRUE(absl::ImportMutexLockOrder(
+      "LockOrderNameSurvivesWakeup.x\t"
+      "LockOrderNameSurvivesWakeup.y\n"));
+  absl::Mutex x;
+  absl::Mutex y;
+  x.SetLockOrderName("LockOrderNameSurvivesWakeup.x");
+  y.SetLockOrderName("LockOrderNameSurvivesWakeup.y");
+  x.Lock();
+  std::thread waiter([&] {
+    absl::MutexLock l(&x);
+  });
+  absl::SleepFor(absl::Milliseconds(100));  // let waiter block on x
+  x.Unlock();
+  waiter.join();
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kAbort);
+  EXPECT_DEATH(std::thread([&] {
+                 y.Lock();
+                 x.Lock();
+               }).join(),
+               "lock-order violation");
+  absl::SetMutexLockOrderMode(absl::OnDeadlockCycle::kIgnore);
+}
 #endif  // !defined(ABSL_INTERNAL_USE_NONPROD_MUTEX)
 
 // --------------------------------------------------------
@@ -0,0 +1,160 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares absl::GetCurrentTimeNanos(), which interpolates between kernel
+// clock samples using the cycle counter on most platforms, against
+// CLOCK_REALTIME, and reports the offset between the two clocks, the drift
+// of that offset over time, and the size of the steps taken when the
+// interpolation is recalibrated.
+//
+// The comparison runs for 5 seconds by default, which covers a couple of
+// recalibrations. Set ABSL_CLOCK_ACCURACY_TEST_SECONDS in the environment to
+// run for longer when validating a change to clock.cc.
+
+#include "absl/time/clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/base/internal/raw_logging.h"
+#include "absl/time/time.h"
+
+#if !defined(_WIN32)
+
+namespace {
+
+// A reading of GetCurrentTimeNanos() bracketed by two readings of
+// CLOCK_REALTIME.
+struct Sample {
+  int64_t real_ns;  // midpoint of the bracketing CLOCK_REALTIME readings
+  int64_t absl_ns;  // GetCurrentTimeNanos()
+};
+
+int64_t RealtimeNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return int64_t{ts.tv_sec} * 1000000000 + ts.tv_nsec;
+}
+
+absl::Duration TestDuration() {
+  const char* env = std::getenv("ABSL_CLOCK_ACCURACY_TEST_SECONDS");
+  int seconds = env != nullptr ? std::atoi(env) : 0;
+  return absl::Seconds(seconds > 0 ? seconds : 5);
+}
+
+// Samples whose CLOCK_REALTIME bracket is wider than this were probably
+// preempted and say nothing about the accuracy of the clock under test.
+constexpr int64_t kMaxBracketNs = 20000;
+
+// Collects samples for `duration`, alternating bursts of back-to-back reads
+// (which expose small steps) with short sleeps (which let the interpolation
+// recalibrate).
+std::vector<Sample> CollectSamples(absl::Duration duration, int* rejected) {
+  std::vector<Sample> samples;
+  *rejected = 0;
+  const int64_t deadline = RealtimeNanos() + absl::ToInt64Nanoseconds(duration);
+  while (RealtimeNanos() < deadline) {
+    for (int i = 0; i < 100; ++i) {
+      const int64_t before = RealtimeNanos();
+      const int64_t absl_ns = absl::GetCurrentTimeNanos();
+      const int64_t after = RealtimeNanos();
+      if (after - before > kMaxBracketNs) {
+        ++*rejected;
+        continue;
+      }
+      samples.push_back({before + (after - before) / 2, absl_ns});
+    }
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  return samples;
+}
+
+TEST(ClockAccuracy, GetCurrentTimeNanosTracksRealtime) {
+  const absl::Duration duration = TestDuration();
+  int rejected = 0;
+  const std::vector<Sample> samples = CollectSamples(duration, &rejected);
+  ASSERT_GT(samples.size(), 1u);
+
+  // Offsets of GetCurrentTimeNanos() from CLOCK_REALTIME.
+  int64_t min_offset = INT64_MAX;
+  int64_t max_offset = INT64_MIN;
+  double sum_offset = 0;
+
+  // Least-squares fit of offset against elapsed time, giving the drift.
+  const int64_t t0 = samples.front().real_ns;
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+  // Steps between consecutive readings, relative to CLOCK_REALTIME.
+  int64_t max_forward_step = 0;
+  int64_t max_backward_step = 0;
+  int64_t backward_steps = 0;
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const Sample& s = samples[i];
+    const int64_t offset = s.absl_ns - s.real_ns;
+    min_offset = std::min(min_offset, offset);
+    max_offset = std::max(max_offset, offset);
+    sum_offset += offset;
+
+    const double x = (s.real_ns - t0) * 1e-9;
+    sx += x;
+    sy += offset;
+    sxx += x * x;
+    sxy += x * offset;
+
+    if (i > 0) {
+      const Sample& prev = samples[i - 1];
+      const int64_t step = s.absl_ns - prev.absl_ns;
+      if (step < 0) ++backward_steps;
+      const int64_t error = step - (s.real_ns - prev.real_ns);
+      max_forward_step = std::max(max_forward_step, error);
+      max_backward_step = std::min(max_backward_step, error);
+    }
+  }
+
+  const double n = samples.size();
+  const double mean_offset = sum_offset / n;
+  const double denom = n * sxx - sx * sx;
+  const double drift_ns_per_s = denom != 0 ? (n * sxy - sx * sy) / denom : 0;
+
+  ABSL_RAW_LOG(INFO,
+               "ClockAccuracy over %.1fs: %zu samples (%d rejected); offset "
+               "min=%lldns max=%lldns mean=%.0fns; drift=%.3fppm; step error "
+               "max_forward=%lldns max_backward=%lldns; backward steps=%lld",
+               absl::ToDoubleSeconds(duration), samples.size(), rejected,
+               static_cast<long long>(min_offset),  // NOLINT(runtime/int)
+               static_cast<long long>(max_offset),
+               mean_offset, drift_ns_per_s / 1e3,
+               static_cast<long long>(max_forward_step),
+               static_cast<long long>(max_backward_step),
+               static_cast<long long>(backward_steps));
+
+  // These bounds are loose enough to tolerate a loaded machine and a
+  // CLOCK_REALTIME that is being slewed, but catch a broken interpolation.
+  const int64_t kMaxOffsetNs = 1000000;
+  EXPECT_LT(max_offset, kMaxOffsetNs);
+  EXPECT_GT(min_offset, -kMaxOffsetNs);
+  EXPECT_LT(std::abs(drift_ns_per_s), 1000.0 * 1e3);  // 1000ppm
+  EXPECT_LT(max_forward_step, kMaxOffsetNs);
+  EXPECT_GT(max_backward_step, -kMaxOffsetNs);
+}
+
+}  // namespace
+
+#endif  // !_WIN32
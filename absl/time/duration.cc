@@ -62,7 +62,10 @@
 #include <limits>
 #include <string>
 
+#include "absl/base/optimization.h"
 #include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "absl/time/time.h"
 
 namespace absl {
@@ -165,6 +168,29 @@ inline Duration MakeDurationFromU128(uint128 u128, bool is_neg) {
   return time_internal::MakeDuration(rep_hi, rep_lo);
 }
 
+#if defined(ABSL_HAVE_INTRINSIC_INT128)
+// Makes a signed 128-bit count of ticks out of a finite Duration.
+inline __int128 MakeI128Ticks(Duration d) {
+  return static_cast<__int128>(time_internal::GetRepHi(d)) * kTicksPerSecond +
+         time_internal::GetRepLo(d);
+}
+
+// Breaks a signed 128-bit count of ticks into a Duration, saturating at
+// +/- InfiniteDuration().
+inline Duration MakeDurationFromI128(__int128 ticks) {
+  __int128 hi = ticks / kTicksPerSecond;
+  __int128 lo = ticks % kTicksPerSecond;
+  if (lo < 0) {
+    hi -= 1;
+    lo += kTicksPerSecond;
+  }
+  if (hi > kint64max) return InfiniteDuration();
+  if (hi < kint64min) return -InfiniteDuration();
+  return time_internal::MakeDuration(static_cast<int64_t>(hi),
+                                     static_cast<uint32_t>(lo));
+}
+#endif  // ABSL_HAVE_INTRINSIC_INT128
+
 // Convert int64_t to uint64_t in twos-complement system.
 inline uint64_t EncodeTwosComp(int64_t v) { return static_cast<uint64_t>(v); }
 
@@ -253,6 +279,54 @@ inline Duration ScaleDouble(Duration d, double r) {
   return time_internal::MakeDuration(hi64, lo64);
 }
 
+// Tries to scale the finite Duration d by the double r using a single
+// floating-point operation on its tick count.  Tick counts below 2^53 (about
+// 26 days) are exact as doubles, so the result is the correctly rounded
+// product or quotient.  Returns false if the duration or the result is too
+// large for that, in which case ScaleDouble() must be used instead.
+template <template <typename> class Operation>
+inline bool ScaleDoubleFastPath(Duration d, double r, Duration* ans) {
+  const int64_t kMaxHi = int64_t{1} << 21;  // 2^21 * kTicksPerSecond < 2^53
+  const double kMaxTicks = static_cast<double>(int64_t{1} << 53);
+  const int64_t rep_hi = time_internal::GetRepHi(d);
+  if (rep_hi >= kMaxHi || rep_hi < -kMaxHi) return false;
+  const double ticks = static_cast<double>(rep_hi * kTicksPerSecond +
+                                           time_internal::GetRepLo(d));
+  const double scaled = Round(Operation<double>()(ticks, r));
+  if (!(scaled > -kMaxTicks && scaled < kMaxTicks)) return false;  // or NaN
+  const int64_t scaled_ticks = static_cast<int64_t>(scaled);
+  int64_t hi = scaled_ticks / kTicksPerSecond;
+  int64_t lo = scaled_ticks % kTicksPerSecond;
+  NormalizeTicks(&hi, &lo);
+  *ans = time_internal::MakeDuration(hi, lo);
+  return true;
+}
+
+// Divides the finite Duration {num_hi, num_lo} by a sub-second unit of
+// kTicksPerUnit ticks, truncating toward zero.  Returns false if the quotient
+// might overflow.  As the divisor is a compile-time constant, the compiler
+// replaces the divisions below with multiplications by precomputed
+// reciprocals.
+template <int64_t kTicksPerUnit>
+inline bool IDivByUnit(int64_t num_hi, uint32_t num_lo, int64_t* q,
+                       Duration* rem) {
+  constexpr int64_t kUnitsPerSecond = kTicksPerSecond / kTicksPerUnit;
+  constexpr int64_t kMaxHi = (kint64max - kTicksPerSecond) / kUnitsPerSecond;
+  if (num_hi >= kMaxHi || num_hi <= -kMaxHi) return false;
+  const uint32_t rem_ticks = num_lo % kTicksPerUnit;
+  *q = num_hi * kUnitsPerSecond + num_lo / kTicksPerUnit;
+  if (num_hi < 0 && rem_ticks != 0) {
+    // Rounds the floored quotient toward zero, which leaves a remainder with
+    // the same sign as the numerator.
+    *q += 1;
+    *rem = time_internal::MakeDuration(
+        -1, static_cast<uint32_t>(kTicksPerSecond - kTicksPerUnit + rem_ticks));
+  } else {
+    *rem = time_internal::MakeDuration(0, rem_ticks);
+  }
+  return true;
+}
+
 // Tries to divide num by den as fast as possible by looking for common, easy
 // cases. If the division was done, the quotient is in *q and the remainder is
 // in *rem and true will be returned.
@@ -270,32 +344,16 @@ inline bool IDivFastPath(const Duration num, const Duration den, int64_t* q,
 
   if (den_hi == 0 && den_lo == kTicksPerNanosecond) {
     // Dividing by 1ns
-    if (num_hi >= 0 && num_hi < (kint64max - kTicksPerSecond) / 1000000000) {
-      *q = num_hi * 1000000000 + num_lo / kTicksPerNanosecond;
-      *rem = time_internal::MakeDuration(0, num_lo % den_lo);
-      return true;
-    }
+    return IDivByUnit<kTicksPerNanosecond>(num_hi, num_lo, q, rem);
   } else if (den_hi == 0 && den_lo == 100 * kTicksPerNanosecond) {
     // Dividing by 100ns (common when converting to Universal time)
-    if (num_hi >= 0 && num_hi < (kint64max - kTicksPerSecond) / 10000000) {
-      *q = num_hi * 10000000 + num_lo / (100 * kTicksPerNanosecond);
-      *rem = time_internal::MakeDuration(0, num_lo % den_lo);
-      return true;
-    }
+    return IDivByUnit<100 * kTicksPerNanosecond>(num_hi, num_lo, q, rem);
   } else if (den_hi == 0 && den_lo == 1000 * kTicksPerNanosecond) {
     // Dividing by 1us
-    if (num_hi >= 0 && num_hi < (kint64max - kTicksPerSecond) / 1000000) {
-      *q = num_hi * 1000000 + num_lo / (1000 * kTicksPerNanosecond);
-      *rem = time_internal::MakeDuration(0, num_lo % den_lo);
-      return true;
-    }
+    return IDivByUnit<1000 * kTicksPerNanosecond>(num_hi, num_lo, q, rem);
   } else if (den_hi == 0 && den_lo == 1000000 * kTicksPerNanosecond) {
     // Dividing by 1ms
-    if (num_hi >= 0 && num_hi < (kint64max - kTicksPerSecond) / 1000) {
-      *q = num_hi * 1000 + num_lo / (1000000 * kTicksPerNanosecond);
-      *rem = time_internal::MakeDuration(0, num_lo % den_lo);
-      return true;
-    }
+    return IDivByUnit<1000000 * kTicksPerNanosecond>(num_hi, num_lo, q, rem);
   } else if (den_hi > 0 && den_lo == 0) {
     // Dividing by positive multiple of 1s
     if (num_hi >= 0) {
@@ -356,6 +414,20 @@ int64_t IDivDuration(bool satq, const Duration num, const Duration den,
     return 0;
   }
 
+#if defined(ABSL_HAVE_INTRINSIC_INT128)
+  // Every finite Duration is a signed 128-bit count of ticks, so the native
+  // 128-bit division (which truncates toward zero) does all the work.
+  const __int128 a = MakeI128Ticks(num);
+  const __int128 b = MakeI128Ticks(den);
+  __int128 quotient128 = a / b;
+  if (satq) {
+    // Limits the quotient to the range of int64_t.
+    quotient128 = std::min<__int128>(quotient128, kint64max);
+    quotient128 = std::max<__int128>(quotient128, kint64min);
+  }
+  *rem = MakeDurationFromI128(a - quotient128 * b);
+  return static_cast<int64_t>(quotient128);
+#else   // ABSL_HAVE_INTRINSIC_INT128
   const uint128 a = MakeU128Ticks(num);
   const uint128 b = MakeU128Ticks(den);
   uint128 quotient128 = a / b;
@@ -377,6 +449,7 @@ int64_t IDivDuration(bool satq, const Duration num, const Duration den,
   // The quotient needs to be negated, but we need to carefully handle
   // quotient128s with the top bit on.
   return -static_cast<int64_t>(Uint128Low64(quotient128 - 1) & kint64max) - 1;
+#endif  // ABSL_HAVE_INTRINSIC_INT128
 }
 
 }  // namespace time_internal
@@ -438,6 +511,7 @@ Duration& Duration::operator*=(double r) {
     const bool is_neg = (std::signbit(r) != 0) != (rep_hi_ < 0);
     return *this = is_neg ? -InfiniteDuration() : InfiniteDuration();
   }
+  if (ScaleDoubleFastPath<std::multiplies>(*this, r, this)) return *this;
   return *this = ScaleDouble<std::multiplies>(*this, r);
 }
 
@@ -454,6 +528,7 @@ Duration& Duration::operator/=(double r) {
     const bool is_neg = (std::signbit(r) != 0) != (rep_hi_ < 0);
     return *this = is_neg ? -InfiniteDuration() : InfiniteDuration();
   }
+  if (ScaleDoubleFastPath<std::divides>(*this, r, this)) return *this;
   return *this = ScaleDouble<std::divides>(*this, r);
 }
 
@@ -584,6 +659,86 @@ double ToDoubleHours(Duration d) {
   return FDivDuration(d, Hours(1));
 }
 
+//
+// Batch conversions.
+//
+
+namespace {
+
+// Converts each Duration in 'in' to an integral count of units, truncating
+// toward zero.  A unit is kTicksPerSecond / kUnitsPerSecond ticks, and rep_hi
+// values in [-2^kHiBits, 2^kHiBits) must not overflow when scaled by
+// kUnitsPerSecond.  The first loop has no data-dependent branches so that it
+// can be vectorized; the rare out-of-range values (including the infinities)
+// are recomputed afterwards by the scalar 'slow' conversion.
+template <int64_t kUnitsPerSecond, int kHiBits>
+void BatchToInt64(absl::Span<const Duration> in, absl::Span<int64_t> out,
+                  int64_t (*slow)(Duration)) {
+  assert(out.size() >= in.size());
+  constexpr int64_t kTicksPerUnit = kTicksPerSecond / kUnitsPerSecond;
+  constexpr uint64_t kBias = uint64_t{1} << kHiBits;
+  const Duration* const ip = in.data();
+  int64_t* const op = out.data();
+  const size_t n = in.size();
+  uint64_t out_of_range = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const int64_t hi = time_internal::GetRepHi(ip[i]);
+    const int64_t lo = time_internal::GetRepLo(ip[i]);
+    out_of_range |= (EncodeTwosComp(hi) + kBias) >> (kHiBits + 1);
+    // floor(d) plus one for negative non-integral counts.
+    const uint64_t q = EncodeTwosComp(hi) * kUnitsPerSecond +
+                       static_cast<uint64_t>(lo / kTicksPerUnit) +
+                       ((hi < 0) & (lo % kTicksPerUnit != 0));
+    op[i] = DecodeTwosComp(q);
+  }
+  if (ABSL_PREDICT_FALSE(out_of_range != 0)) {
+    for (size_t i = 0; i < n; ++i) {
+      const int64_t hi = time_internal::GetRepHi(ip[i]);
+      if ((EncodeTwosComp(hi) + kBias) >> (kHiBits + 1)) op[i] = slow(ip[i]);
+    }
+  }
+}
+
+template <Duration (*kFactory)(int64_t)>
+void BatchFromInt64(absl::Span<const int64_t> in, absl::Span<Duration> out) {
+  assert(out.size() >= in.size());
+  const int64_t* const ip = in.data();
+  Duration* const op = out.data();
+  const size_t n = in.size();
+  for (size_t i = 0; i < n; ++i) op[i] = kFactory(ip[i]);
+}
+
+}  // namespace
+
+void ToInt64Nanoseconds(absl::Span<const Duration> in,
+                        absl::Span<int64_t> out) {
+  BatchToInt64<1000 * 1000 * 1000, 33>(in, out, ToInt64Nanoseconds);
+}
+void ToInt64Microseconds(absl::Span<const Duration> in,
+                         absl::Span<int64_t> out) {
+  BatchToInt64<1000 * 1000, 43>(in, out, ToInt64Microseconds);
+}
+void ToInt64Milliseconds(absl::Span<const Duration> in,
+                         absl::Span<int64_t> out) {
+  BatchToInt64<1000, 53>(in, out, ToInt64Milliseconds);
+}
+void ToInt64Seconds(absl::Span<const Duration> in, absl::Span<int64_t> out) {
+  BatchToInt64<1, 62>(in, out, ToInt64Seconds);
+}
+
+void Nanoseconds(absl::Span<const int64_t> in, absl::Span<Duration> out) {
+  BatchFromInt64<Nanoseconds>(in, out);
+}
+void Microseconds(absl::Span<const int64_t> in, absl::Span<Duration> out) {
+  BatchFromInt64<Microseconds>(in, out);
+}
+void Milliseconds(absl::Span<const int64_t> in, absl::Span<Duration> out) {
+  BatchFromInt64<Milliseconds>(in, out);
+}
+void Seconds(absl::Span<const int64_t> in, absl::Span<Duration> out) {
+  BatchFromInt64<Seconds>(in, out);
+}
+
 timespec ToTimespec(Duration d) {
   timespec ts;
   if (!time_internal::IsInfiniteDuration(d)) {
@@ -678,62 +833,113 @@ char* Format64(char* ep, int width, int64_t v) {
   return ep;
 }
 
-// Helpers for FormatDuration() that format 'n' and append it to 'out'
+// Helpers for FormatDuration() that format 'n' and write it to 'out'
 // followed by the given 'unit'.  If 'n' formats to "0", nothing is
-// appended (not even the unit).
+// written (not even the unit).  Each returns the new end of the output.
 
 // A type that encapsulates how to display a value of a particular unit. For
 // values that are displayed with fractional parts, the precision indicates
-// where to round the value. The precision varies with the display unit because
-// a Duration can hold only quarters of a nanosecond, so displaying information
-// beyond that is just noise.
+// how many fractional digits are needed to show the value exactly. The
+// precision varies with the display unit because a Duration can hold only
+// quarters of a nanosecond, so displaying information beyond that is just
+// noise.
 //
 // For example, a microsecond value of 42.00025xxxxx should not display beyond 5
 // fractional digits, because it is in the noise of what a Duration can
 // represent.
+//
+// Because each unit is a multiple of 1000 quarter-nanosecond ticks, a
+// fractional tick count 'f' of a unit is exactly 'f * 25' at the given
+// precision, so no floating-point rounding is involved.
 struct DisplayUnit {
   const char* abbr;
   int prec;
-  double pow10;
+  int64_t ticks;  // ticks per unit, for the sub-second units
 };
-const DisplayUnit kDisplayNano = {"ns", 2, 1e2};
-const DisplayUnit kDisplayMicro = {"us", 5, 1e5};
-const DisplayUnit kDisplayMilli = {"ms", 8, 1e8};
-const DisplayUnit kDisplaySec = {"s", 11, 1e11};
-const DisplayUnit kDisplayMin = {"m", -1, 0.0};   // prec ignored
-const DisplayUnit kDisplayHour = {"h", -1, 0.0};  // prec ignored
-
-void AppendNumberUnit(std::string* out, int64_t n, DisplayUnit unit) {
+const DisplayUnit kDisplayNano = {"ns", 2, kTicksPerNanosecond};
+const DisplayUnit kDisplayMicro = {"us", 5, 1000 * kTicksPerNanosecond};
+const DisplayUnit kDisplayMilli = {"ms", 8, 1000000 * kTicksPerNanosecond};
+const DisplayUnit kDisplaySec = {"s", 11, kTicksPerSecond};
+const DisplayUnit kDisplayMin = {"m", -1, 0};   // prec ignored
+const DisplayUnit kDisplayHour = {"h", -1, 0};  // prec ignored
+
+char* AppendUnit(char* out, DisplayUnit unit) {
+  for (const char* p = unit.abbr; *p != '\0'; ++p) *out++ = *p;
+  return out;
+}
+
+char* AppendDigits(char* out, const char* bp, const char* ep) {
+  while (bp != ep) *out++ = *bp++;
+  return out;
+}
+
+char* AppendNumberUnit(char* out, int64_t n, DisplayUnit unit) {
   char buf[sizeof("2562047788015216")];  // hours in max duration
   char* const ep = buf + sizeof(buf);
   char* bp = Format64(ep, 0, n);
   if (*bp != '0' || bp + 1 != ep) {
-    out->append(bp, ep - bp);
-    out->append(unit.abbr);
+    out = AppendDigits(out, bp, ep);
+    out = AppendUnit(out, unit);
   }
+  return out;
 }
 
-// Note: unit.prec is limited to double's digits10 value (typically 15) so it
-// always fits in buf[].
-void AppendNumberUnit(std::string* out, double n, DisplayUnit unit) {
-  const int buf_size = std::numeric_limits<double>::digits10;
-  const int prec = std::min(buf_size, unit.prec);
-  char buf[buf_size];  // also large enough to hold integer part
+// Writes 'ticks' (which must be non-negative and less than the number of
+// ticks in 60 units) as a possibly fractional count of 'unit'.
+char* AppendFractionalUnit(char* out, int64_t ticks, DisplayUnit unit) {
+  char buf[sizeof("59.99999999975")];
   char* ep = buf + sizeof(buf);
-  double d = 0;
-  int64_t frac_part = Round(std::modf(n, &d) * unit.pow10);
-  int64_t int_part = d;
+  const int64_t int_part = ticks / unit.ticks;
+  const int64_t frac_part = (ticks % unit.ticks) * 25;
   if (int_part != 0 || frac_part != 0) {
     char* bp = Format64(ep, 0, int_part);  // always < 1000
-    out->append(bp, ep - bp);
+    out = AppendDigits(out, bp, ep);
     if (frac_part != 0) {
-      out->push_back('.');
-      bp = Format64(ep, prec, frac_part);
+      *out++ = '.';
+      bp = Format64(ep, unit.prec, frac_part);
       while (ep[-1] == '0') --ep;
-      out->append(bp, ep - bp);
+      out = AppendDigits(out, bp, ep);
     }
-    out->append(unit.abbr);
+    out = AppendUnit(out, unit);
   }
+  return out;
+}
+
+// Writes "inf" or "-inf" if 'd' is infinite, returning the number of chars
+// written, or 0 otherwise.
+int FormatInfiniteDuration(Duration d, char* buf) {
+  if (!time_internal::IsInfiniteDuration(d)) return 0;
+  const char* s = d < ZeroDuration() ? "-inf" : "inf";
+  char* out = buf;
+  while (*s != '\0') *out++ = *s++;
+  *out = '\0';
+  return static_cast<int>(out - buf);
+}
+
+// Writes the (possibly saturated) integral count 'n' followed by 'abbr'.
+int FormatIntegralDuration(int64_t n, const char* abbr, char* buf) {
+  if (n == 0) {
+    buf[0] = '0';
+    buf[1] = '\0';
+    return 1;
+  }
+  char digits[sizeof("9223372036854775808")];
+  char* const ep = digits + sizeof(digits);
+  char* bp = ep;
+  char* out = buf;
+  // Works on the magnitude as a uint64_t because 'n' may be kint64min.
+  uint64_t u = static_cast<uint64_t>(n);
+  if (n < 0) {
+    *out++ = '-';
+    u = 0 - u;
+  }
+  do {
+    *--bp = '0' + (u % 10);  // contiguous digits
+  } while (u /= 10);
+  out = AppendDigits(out, bp, ep);
+  while (*abbr != '\0') *out++ = *abbr++;
+  *out = '\0';
+  return static_cast<int>(out - buf);
 }
 
 }  // namespace
@@ -744,102 +950,121 @@ void AppendNumberUnit(std::string* out, double n, DisplayUnit unit) {
 //   case, durations less than one second format use a smaller unit
 //   (milli-, micro-, or nanoseconds) to ensure that the leading digit
 //   is non-zero.  The zero duration formats as 0, with no unit.
-std::string FormatDuration(Duration d) {
+int FormatDuration(Duration d, char* buf) {
   const Duration min_duration = Seconds(kint64min);
   if (d == min_duration) {
     // Avoid needing to negate kint64min by directly returning what the
     // following code should produce in that case.
-    return "-2562047788015215h30m8s";
+    static const char kMinDuration[] = "-2562047788015215h30m8s";
+    std::memcpy(buf, kMinDuration, sizeof(kMinDuration));
+    return sizeof(kMinDuration) - 1;
   }
-  std::string s;
+  if (int n = FormatInfiniteDuration(d, buf)) return n;
+  char* out = buf;
   if (d < ZeroDuration()) {
-    s.append("-");
+    *out++ = '-';
     d = -d;
   }
-  if (d == InfiniteDuration()) {
-    s.append("inf");
-  } else if (d < Seconds(1)) {
+  char* const start = out;
+  const int64_t rep_hi = time_internal::GetRepHi(d);
+  const int64_t rep_lo = time_internal::GetRepLo(d);
+  if (rep_hi == 0) {
     // Special case for durations with a magnitude < 1 second.  The duration
     // is printed as a fraction of a single unit, e.g., "1.2ms".
     if (d < Microseconds(1)) {
-      AppendNumberUnit(&s, FDivDuration(d, Nanoseconds(1)), kDisplayNano);
+      out = AppendFractionalUnit(out, rep_lo, kDisplayNano);
     } else if (d < Milliseconds(1)) {
-      AppendNumberUnit(&s, FDivDuration(d, Microseconds(1)), kDisplayMicro);
+      out = AppendFractionalUnit(out, rep_lo, kDisplayMicro);
     } else {
-      AppendNumberUnit(&s, FDivDuration(d, Milliseconds(1)), kDisplayMilli);
+      out = AppendFractionalUnit(out, rep_lo, kDisplayMilli);
     }
   } else {
-    AppendNumberUnit(&s, IDivDuration(d, Hours(1), &d), kDisplayHour);
-    AppendNumberUnit(&s, IDivDuration(d, Minutes(1), &d), kDisplayMin);
-    AppendNumberUnit(&s, FDivDuration(d, Seconds(1)), kDisplaySec);
+    out = AppendNumberUnit(out, rep_hi / (60 * 60), kDisplayHour);
+    out = AppendNumberUnit(out, rep_hi / 60 % 60, kDisplayMin);
+    out = AppendFractionalUnit(out, rep_hi % 60 * kTicksPerSecond + rep_lo,
+                               kDisplaySec);
   }
-  if (s.empty() || s == "-") {
-    s = "0";
+  if (out == start) {
+    out = buf;
+    *out++ = '0';
   }
-  return s;
+  *out = '\0';
+  return static_cast<int>(out - buf);
+}
+
+std::string FormatDuration(Duration d) {
+  char buf[kFormatDurationBufferSize];
+  return std::string(buf, FormatDuration(d, buf));
+}
+
+int FormatDurationNanoseconds(Duration d, char* buf) {
+  if (int n = FormatInfiniteDuration(d, buf)) return n;
+  return FormatIntegralDuration(ToInt64Nanoseconds(d), "ns", buf);
+}
+
+int FormatDurationMilliseconds(Duration d, char* buf) {
+  if (int n = FormatInfiniteDuration(d, buf)) return n;
+  return FormatIntegralDuration(ToInt64Milliseconds(d), "ms", buf);
 }
 
 namespace {
 
 // A helper for ParseDuration() that parses a leading number from the given
 // std::string and stores the result in *int_part/*frac_part/*frac_scale.  The
-// given std::string pointer is modified to point to the first unconsumed char.
-bool ConsumeDurationNumber(const char** dpp, int64_t* int_part,
+// given string_view is modified to start at the first unconsumed char.
+bool ConsumeDurationNumber(absl::string_view* dur, int64_t* int_part,
                            int64_t* frac_part, int64_t* frac_scale) {
   *int_part = 0;
   *frac_part = 0;
   *frac_scale = 1;  // invariant: *frac_part < *frac_scale
-  const char* start = *dpp;
-  for (; std::isdigit(**dpp); *dpp += 1) {
-    const int d = **dpp - '0';  // contiguous digits
+  const char* dp = dur->data();
+  const char* const ep = dp + dur->size();
+  const char* const start = dp;
+  for (; dp != ep && std::isdigit(*dp); ++dp) {
+    const int d = *dp - '0';  // contiguous digits
     if (*int_part > kint64max / 10) return false;
     *int_part *= 10;
     if (*int_part > kint64max - d) return false;
     *int_part += d;
   }
-  const bool int_part_empty = (*dpp == start);
-  if (**dpp != '.') return !int_part_empty;
-  for (*dpp += 1; std::isdigit(**dpp); *dpp += 1) {
-    const int d = **dpp - '0';  // contiguous digits
+  const bool int_part_empty = (dp == start);
+  if (dp == ep || *dp != '.') {
+    dur->remove_prefix(dp - start);
+    return !int_part_empty;
+  }
+  for (++dp; dp != ep && std::isdigit(*dp); ++dp) {
+    const int d = *dp - '0';  // contiguous digits
     if (*frac_scale <= kint64max / 10) {
       *frac_part *= 10;
       *frac_part += d;
       *frac_scale *= 10;
     }
   }
+  dur->remove_prefix(dp - start);
   return !int_part_empty || *frac_scale != 1;
 }
 
 // A helper for ParseDuration() that parses a leading unit designator (e.g.,
 // ns, us, ms, s, m, h) from the given std::string and stores the resulting unit
-// in "*unit".  The given std::string pointer is modified to point to the first
+// in "*unit".  The given string_view is modified to start at the first
 // unconsumed char.
-bool ConsumeDurationUnit(const char** start, Duration* unit) {
-  const char *s = *start;
-  bool ok = true;
-  if (strncmp(s, "ns", 2) == 0) {
-    s += 2;
+bool ConsumeDurationUnit(absl::string_view* dur, Duration* unit) {
+  if (absl::ConsumePrefix(dur, "ns")) {
     *unit = Nanoseconds(1);
-  } else if (strncmp(s, "us", 2) == 0) {
-    s += 2;
+  } else if (absl::ConsumePrefix(dur, "us")) {
     *unit = Microseconds(1);
-  } else if (strncmp(s, "ms", 2) == 0) {
-    s += 2;
+  } else if (absl::ConsumePrefix(dur, "ms")) {
     *unit = Milliseconds(1);
-  } else if (strncmp(s, "s", 1) == 0) {
-    s += 1;
+  } else if (absl::ConsumePrefix(dur, "s")) {
     *unit = Seconds(1);
-  } else if (strncmp(s, "m", 1) == 0) {
-    s += 1;
+  } else if (absl::ConsumePrefix(dur, "m")) {
     *unit = Minutes(1);
-  } else if (strncmp(s, "h", 1) == 0) {
-    s += 1;
+  } else if (absl::ConsumePrefix(dur, "h")) {
     *unit = Hours(1);
   } else {
-    ok = false;
+    return false;
   }
-  *start = s;
-  return ok;
+  return true;
 }
 
 }  // namespace
@@ -849,39 +1074,39 @@ bool ConsumeDurationUnit(const char** start, Duration* unit) {
 //   a possibly signed sequence of decimal numbers, each with optional
 //   fraction and a unit suffix, such as "300ms", "-1.5h" or "2h45m".
 //   Valid time units are "ns", "us" "ms", "s", "m", "h".
-bool ParseDuration(const std::string& dur_string, Duration* d) {
-  const char* start = dur_string.c_str();
+bool ParseDuration(absl::string_view dur_string, Duration* d) {
   int sign = 1;
-
-  if (*start == '-' || *start == '+') {
-    sign = *start == '-' ? -1 : 1;
-    ++start;
+  if (absl::ConsumePrefix(&dur_string, "-")) {
+    sign = -1;
+  } else {
+    absl::ConsumePrefix(&dur_string, "+");
   }
 
   // Can't parse a duration from an empty std::string.
-  if (*start == '\0') {
+  if (dur_string.empty()) {
     return false;
   }
 
   // Special case for a std::string of "0".
-  if (*start == '0' && *(start + 1) == '\0') {
+  if (dur_string == "0") {
     *d = ZeroDuration();
     return true;
   }
 
-  if (strcmp(start, "inf") == 0) {
+  if (dur_string == "inf") {
     *d = sign * InfiniteDuration();
     return true;
   }
 
   Duration dur;
-  while (*start != '\0') {
+  while (!dur_string.empty()) {
     int64_t int_part;
     int64_t frac_part;
     int64_t frac_scale;
     Duration unit;
-    if (!ConsumeDurationNumber(&start, &int_part, &frac_part, &frac_scale) ||
-        !ConsumeDurationUnit(&start, &unit)) {
+    if (!ConsumeDurationNumber(&dur_string, &int_part, &frac_part,
+                               &frac_scale) ||
+        !ConsumeDurationUnit(&dur_string, &unit)) {
       return false;
     }
     if (int_part != 0) dur += sign * int_part * unit;
@@ -0,0 +1,332 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <string>
+
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+//
+// Division by a Duration
+//
+
+// The numerators for the division benchmarks.  Each one exercises a
+// different path through IDivDuration().
+absl::Duration DivisionNumerator(int kind) {
+  switch (kind) {
+    case 0:  // small and positive
+      return absl::Seconds(5) + absl::Nanoseconds(123456789);
+    case 1:  // small and negative
+      return -(absl::Seconds(5) + absl::Nanoseconds(123456789));
+    case 2:  // just past the fast path for integral nanoseconds
+      return absl::Seconds(std::numeric_limits<int64_t>::max() / 1000000000);
+    default:  // needs more than 64 bits of ticks
+      return absl::Hours(1000000000) + absl::Nanoseconds(1) / 4;
+  }
+}
+
+const char* const kNumeratorLabels[] = {"small", "negative", "boundary",
+                                        "huge"};
+
+void BM_Duration_IDivDuration_Nanoseconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  absl::Duration rem;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::IDivDuration(d, absl::Nanoseconds(1), &rem));
+    benchmark::DoNotOptimize(rem);
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_IDivDuration_Nanoseconds)->DenseRange(0, 3);
+
+void BM_Duration_IDivDuration_Microseconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  absl::Duration rem;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::IDivDuration(d, absl::Microseconds(1), &rem));
+    benchmark::DoNotOptimize(rem);
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_IDivDuration_Microseconds)->DenseRange(0, 3);
+
+void BM_Duration_IDivDuration_Milliseconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  absl::Duration rem;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::IDivDuration(d, absl::Milliseconds(1), &rem));
+    benchmark::DoNotOptimize(rem);
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_IDivDuration_Milliseconds)->DenseRange(0, 3);
+
+void BM_Duration_IDivDuration_Seconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  absl::Duration rem;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::IDivDuration(d, absl::Seconds(1), &rem));
+    benchmark::DoNotOptimize(rem);
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_IDivDuration_Seconds)->DenseRange(0, 3);
+
+// A denominator that is not one of the common units, which always takes the
+// 128-bit path.
+void BM_Duration_IDivDuration_Arbitrary(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  absl::Duration den = absl::Milliseconds(3) + absl::Nanoseconds(7);
+  absl::Duration rem;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::IDivDuration(d, den, &rem));
+    benchmark::DoNotOptimize(rem);
+    benchmark::DoNotOptimize(d);
+    benchmark::DoNotOptimize(den);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_IDivDuration_Arbitrary)->DenseRange(0, 3);
+
+void BM_Duration_Modulo(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(d % absl::Microseconds(1));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_Modulo)->DenseRange(0, 3);
+
+void BM_Duration_ToInt64Nanoseconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToInt64Nanoseconds(d));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_ToInt64Nanoseconds)->DenseRange(0, 3);
+
+//
+// Conversions
+//
+
+void BM_Duration_FromInt64Nanoseconds(benchmark::State& state) {
+  int64_t i = 123456789;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::Nanoseconds(i));
+    benchmark::DoNotOptimize(i);
+  }
+}
+BENCHMARK(BM_Duration_FromInt64Nanoseconds);
+
+void BM_Duration_FromInt64Seconds(benchmark::State& state) {
+  int64_t i = 123456789;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::Seconds(i));
+    benchmark::DoNotOptimize(i);
+  }
+}
+BENCHMARK(BM_Duration_FromInt64Seconds);
+
+void BM_Duration_FromInt64Hours(benchmark::State& state) {
+  int64_t i = 123456;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::Hours(i));
+    benchmark::DoNotOptimize(i);
+  }
+}
+BENCHMARK(BM_Duration_FromInt64Hours);
+
+void BM_Duration_FromDoubleSeconds(benchmark::State& state) {
+  double x = 1234.56789;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::Seconds(x));
+    benchmark::DoNotOptimize(x);
+  }
+}
+BENCHMARK(BM_Duration_FromDoubleSeconds);
+
+void BM_Duration_ToInt64Microseconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToInt64Microseconds(d));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_ToInt64Microseconds)->DenseRange(0, 3);
+
+void BM_Duration_ToInt64Seconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToInt64Seconds(d));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_ToInt64Seconds)->DenseRange(0, 3);
+
+void BM_Duration_ToDoubleSeconds(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToDoubleSeconds(d));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_ToDoubleSeconds)->DenseRange(0, 3);
+
+void BM_Duration_ToTimespec(benchmark::State& state) {
+  absl::Duration d = absl::Seconds(1234) + absl::Nanoseconds(567);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToTimespec(d));
+    benchmark::DoNotOptimize(d);
+  }
+}
+BENCHMARK(BM_Duration_ToTimespec);
+
+void BM_Duration_FromTimespec(benchmark::State& state) {
+  timespec ts;
+  ts.tv_sec = 1234;
+  ts.tv_nsec = 567;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::DurationFromTimespec(ts));
+    benchmark::DoNotOptimize(ts);
+  }
+}
+BENCHMARK(BM_Duration_FromTimespec);
+
+void BM_Duration_ToChronoNanoseconds(benchmark::State& state) {
+  absl::Duration d = absl::Seconds(1234) + absl::Nanoseconds(567);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToChronoNanoseconds(d));
+    benchmark::DoNotOptimize(d);
+  }
+}
+BENCHMARK(BM_Duration_ToChronoNanoseconds);
+
+void BM_Duration_FormatDuration(benchmark::State& state) {
+  absl::Duration d = DivisionNumerator(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::FormatDuration(d));
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_FormatDuration)->DenseRange(0, 3);
+
+void BM_Duration_ParseDuration(benchmark::State& state) {
+  const std::string s = absl::FormatDuration(DivisionNumerator(state.range(0)));
+  absl::Duration d;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ParseDuration(s, &d));
+    benchmark::DoNotOptimize(d);
+  }
+  state.SetLabel(kNumeratorLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_ParseDuration)->DenseRange(0, 3);
+
+//
+// Scaling
+//
+
+// Durations on either side of the limit for the single-operation double
+// scaling path, and one that overflows to infinity.
+absl::Duration ScalingDuration(int kind) {
+  switch (kind) {
+    case 0:  // well within the fast path
+      return absl::Milliseconds(1500) + absl::Nanoseconds(1) / 4;
+    case 1:  // just within the fast path
+      return absl::Seconds((int64_t{1} << 21) - 1);
+    case 2:  // just past the fast path
+      return absl::Seconds(int64_t{1} << 21);
+    default:  // overflows when scaled
+      return absl::Seconds(std::numeric_limits<int64_t>::max() / 2);
+  }
+}
+
+const char* const kScalingLabels[] = {"small", "fast_limit", "slow",
+                                      "overflow"};
+
+void BM_Duration_MultiplyDouble(benchmark::State& state) {
+  const absl::Duration d = ScalingDuration(state.range(0));
+  double r = 3.25;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(d * r);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetLabel(kScalingLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_MultiplyDouble)->DenseRange(0, 3);
+
+void BM_Duration_DivideDouble(benchmark::State& state) {
+  const absl::Duration d = ScalingDuration(state.range(0));
+  double r = 0.3;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(d / r);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetLabel(kScalingLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_DivideDouble)->DenseRange(0, 3);
+
+void BM_Duration_MultiplyInt64(benchmark::State& state) {
+  const absl::Duration d = ScalingDuration(state.range(0));
+  int64_t r = 3;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(d * r);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetLabel(kScalingLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_MultiplyInt64)->DenseRange(0, 3);
+
+void BM_Duration_DivideInt64(benchmark::State& state) {
+  const absl::Duration d = ScalingDuration(state.range(0));
+  int64_t r = 3;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(d / r);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetLabel(kScalingLabels[state.range(0)]);
+}
+BENCHMARK(BM_Duration_DivideInt64)->DenseRange(0, 3);
+
+// A typical rate computation: bytes per second over a measured interval.
+void BM_Duration_Rate(benchmark::State& state) {
+  absl::Duration elapsed = absl::Milliseconds(1234) + absl::Nanoseconds(567);
+  int64_t bytes = 123456789;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(bytes / absl::ToDoubleSeconds(elapsed));
+    benchmark::DoNotOptimize(elapsed / absl::Microseconds(1));
+    benchmark::DoNotOptimize(bytes);
+    benchmark::DoNotOptimize(elapsed);
+  }
+}
+BENCHMARK(BM_Duration_Rate);
+
+}  // namespace
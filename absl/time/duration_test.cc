@@ -18,6 +18,7 @@
 #include <ctime>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -133,6 +134,53 @@ TEST(Duration, ToConversion) {
 #undef TEST_DURATION_CONVERSION
 }
 
+TEST(Duration, BatchConversion) {
+  const absl::Duration qns = absl::Nanoseconds(1) / 4;
+  const absl::Duration inf = absl::InfiniteDuration();
+  std::vector<absl::Duration> durations = {
+      absl::ZeroDuration(), qns, -qns, absl::Nanoseconds(3) / 2,
+      -absl::Nanoseconds(3) / 2, absl::Microseconds(-1999),
+      absl::Milliseconds(-1) - qns, absl::Seconds(-1) - qns, absl::Hours(-5),
+      inf, -inf, absl::Seconds(kint64max), absl::Seconds(kint64min),
+      absl::Seconds(kint64min) + qns};
+  // Durations around the edges of each fast path.
+  for (int bits : {33, 43, 53, 62}) {
+    for (int64_t sec : {int64_t{1} << bits, -(int64_t{1} << bits)}) {
+      for (int64_t delta : {-1, 0, 1}) {
+        durations.push_back(absl::Seconds(sec + delta) - qns);
+        durations.push_back(absl::Seconds(sec + delta));
+        durations.push_back(absl::Seconds(sec + delta) + qns);
+      }
+    }
+  }
+
+  std::vector<int64_t> out(durations.size());
+#define TEST_BATCH_CONVERSION(UNIT)                              \
+  do {                                                           \
+    absl::ToInt64##UNIT(durations, absl::MakeSpan(out));         \
+    for (size_t i = 0; i < durations.size(); ++i) {              \
+      EXPECT_EQ(absl::ToInt64##UNIT(durations[i]), out[i]) << i; \
+    }                                                            \
+    std::vector<absl::Duration> back(out.size());                \
+    absl::UNIT(out, absl::MakeSpan(back));                       \
+    for (size_t i = 0; i < out.size(); ++i) {                    \
+      EXPECT_EQ(absl::UNIT(out[i]), back[i]) << i;               \
+    }                                                            \
+  } while (0)
+
+  TEST_BATCH_CONVERSION(Nanoseconds);
+  TEST_BATCH_CONVERSION(Microseconds);
+  TEST_BATCH_CONVERSION(Milliseconds);
+  TEST_BATCH_CONVERSION(Seconds);
+
+#undef TEST_BATCH_CONVERSION
+
+  // Only the first in.size() elements of out are written.
+  out.assign(3, 42);
+  absl::ToInt64Milliseconds({absl::Seconds(1), -inf}, absl::MakeSpan(out));
+  EXPECT_THAT(out, testing::ElementsAre(1000, kint64min, 42));
+}
+
 template <int64_t N>
 void TestToConversion() {
   constexpr absl::Duration nano = absl::Nanoseconds(N);
@@ -1094,6 +1142,60 @@ TEST(Duration, Multiplication) {
 #undef TEST_MOD_IDENTITY
 }
 
+TEST(Duration, DivisionByCommonUnits) {
+  const absl::Duration qns = absl::Nanoseconds(1) / 4;
+  const absl::Duration units[] = {absl::Nanoseconds(1), absl::Nanoseconds(100),
+                                  absl::Microseconds(1), absl::Milliseconds(1),
+                                  absl::Seconds(1)};
+  const absl::Duration nums[] = {
+      qns,
+      -qns,
+      absl::Nanoseconds(-7) - qns,
+      absl::Microseconds(-1999) - qns,
+      absl::Seconds(-5) - absl::Nanoseconds(123456789) - qns,
+      absl::Hours(-100000) - qns,
+      absl::Seconds(kint64min / 1000000000) + qns,
+      absl::Seconds(kint64max / 1000000000 - 1) - qns,
+  };
+  for (const absl::Duration unit : units) {
+    for (const absl::Duration num : nums) {
+      absl::Duration rem;
+      const int64_t q = absl::IDivDuration(num, unit, &rem);
+      // The remainder has the sign of the numerator and is less than a unit.
+      EXPECT_EQ(num, q * unit + rem) << num << " / " << unit;
+      EXPECT_LT(absl::AbsDuration(rem), unit) << num << " / " << unit;
+      if (rem != absl::ZeroDuration()) {
+        EXPECT_EQ(num < absl::ZeroDuration(), rem < absl::ZeroDuration());
+      }
+      EXPECT_EQ(rem, num % unit);
+      EXPECT_EQ(-q, absl::IDivDuration(num, -unit, &rem));
+    }
+  }
+}
+
+TEST(Duration, ScalingByDouble) {
+  const absl::Duration qns = absl::Nanoseconds(1) / 4;
+  // Around the largest duration that is scaled with a single double
+  // operation on its tick count.
+  for (int64_t sec : {(int64_t{1} << 21) - 1, int64_t{1} << 21}) {
+    for (const absl::Duration d : {absl::Seconds(sec) - absl::Nanoseconds(1),
+                                   absl::Nanoseconds(1) - absl::Seconds(sec)}) {
+      EXPECT_EQ(d + d, d * 2.0);
+      EXPECT_EQ(d + d, 2.0 * d);
+      EXPECT_EQ(d + d, d / 0.5);
+      EXPECT_EQ(d / 4, d * 0.25);
+      EXPECT_EQ(d / 4, d / 4.0);
+      EXPECT_EQ(-d, d * -1.0);
+    }
+  }
+  EXPECT_EQ(absl::Nanoseconds(1) + qns, absl::Nanoseconds(5) / 4.0);
+  EXPECT_EQ(-qns, absl::Nanoseconds(-1) * 0.3);  // -1.2 ticks
+  EXPECT_EQ(-qns - qns, absl::Nanoseconds(-1) * 0.375);  // -1.5 ticks
+  EXPECT_EQ(absl::Hours(2), absl::Hours(1) * 2.0);
+  EXPECT_EQ(absl::InfiniteDuration(), absl::Hours(1) * 1e300);
+  EXPECT_EQ(-absl::InfiniteDuration(), absl::Hours(1) / -1e-300);
+}
+
 TEST(Duration, Truncation) {
   const absl::Duration d = absl::Nanoseconds(1234567890);
   const absl::Duration inf = absl::InfiniteDuration();
@@ -1537,6 +1639,80 @@ TEST(Duration, FormatDuration) {
                 -huge_range - (absl::Seconds(1) - absl::Nanoseconds(1) / 4)));
 }
 
+TEST(Duration, FormatDurationBuffer) {
+  char buf[absl::kFormatDurationBufferSize];
+
+  EXPECT_EQ(4, absl::FormatDuration(absl::Milliseconds(1500), buf));
+  EXPECT_STREQ("1.5s", buf);
+  EXPECT_EQ(1, absl::FormatDuration(absl::ZeroDuration(), buf));
+  EXPECT_STREQ("0", buf);
+  EXPECT_EQ(4, absl::FormatDuration(-absl::InfiniteDuration(), buf));
+  EXPECT_STREQ("-inf", buf);
+
+  // The longest possible outputs must fit.
+  const absl::Duration qns = absl::Nanoseconds(1) / 4;
+  const absl::Duration max_dur =
+      absl::Seconds(kint64max) + (absl::Seconds(1) - qns);
+  EXPECT_EQ(35, absl::FormatDuration(-max_dur, buf));
+  EXPECT_STREQ("-2562047788015215h30m7.99999999975s", buf);
+  const absl::Duration long_dur =
+      absl::Hours(2562047788015214) + (absl::Hours(1) - qns);
+  EXPECT_EQ(absl::kFormatDurationBufferSize - 1,
+            absl::FormatDuration(-long_dur, buf));
+  EXPECT_STREQ("-2562047788015214h59m59.99999999975s", buf);
+  EXPECT_EQ(23, absl::FormatDuration(absl::Seconds(kint64min), buf));
+  EXPECT_STREQ("-2562047788015215h30m8s", buf);
+
+  // Agrees with the std::string version.
+  const absl::Duration samples[] = {
+      absl::Nanoseconds(1) + qns,
+      absl::Microseconds(55) + qns,
+      absl::Milliseconds(-55) - qns,
+      absl::Hours(1) + absl::Nanoseconds(500),
+      absl::Minutes(-3) - absl::Seconds(4),
+      absl::Hours(72) + absl::Minutes(3),
+  };
+  for (const absl::Duration d : samples) {
+    const int n = absl::FormatDuration(d, buf);
+    EXPECT_EQ(absl::FormatDuration(d), std::string(buf, n));
+  }
+}
+
+TEST(Duration, FormatDurationIntegral) {
+  char buf[absl::kFormatDurationBufferSize];
+
+  EXPECT_EQ(12, absl::FormatDurationNanoseconds(absl::Milliseconds(1500), buf));
+  EXPECT_STREQ("1500000000ns", buf);
+  EXPECT_EQ(6, absl::FormatDurationMilliseconds(absl::Milliseconds(1500), buf));
+  EXPECT_STREQ("1500ms", buf);
+
+  // Sub-unit remainders truncate toward zero.
+  absl::FormatDurationNanoseconds(
+      absl::Nanoseconds(-7) - absl::Nanoseconds(1) / 2, buf);
+  EXPECT_STREQ("-7ns", buf);
+  absl::FormatDurationMilliseconds(absl::Microseconds(-1999), buf);
+  EXPECT_STREQ("-1ms", buf);
+  absl::FormatDurationMilliseconds(absl::Microseconds(999), buf);
+  EXPECT_STREQ("0", buf);
+
+  // Out-of-range counts saturate, infinities are spelled out.
+  absl::FormatDurationNanoseconds(absl::Hours(-3000000), buf);
+  EXPECT_STREQ("-9223372036854775808ns", buf);
+  absl::FormatDurationNanoseconds(absl::Hours(3000000), buf);
+  EXPECT_STREQ("9223372036854775807ns", buf);
+  absl::FormatDurationMilliseconds(absl::InfiniteDuration(), buf);
+  EXPECT_STREQ("inf", buf);
+  absl::FormatDurationNanoseconds(-absl::InfiniteDuration(), buf);
+  EXPECT_STREQ("-inf", buf);
+
+  // The output parses back to the truncated duration.
+  absl::Duration d;
+  absl::FormatDurationMilliseconds(absl::Minutes(-2) - absl::Microseconds(5),
+                                   buf);
+  EXPECT_TRUE(absl::ParseDuration(buf, &d));
+  EXPECT_EQ(absl::Milliseconds(-120000), d);
+}
+
 TEST(Duration, ParseDuration) {
   absl::Duration d;
 
@@ -1645,6 +1821,20 @@ TEST(Duration, ParseDuration) {
   EXPECT_FALSE(absl::ParseDuration("1h-2s", &d));
   EXPECT_FALSE(absl::ParseDuration("-1h-2s", &d));
   EXPECT_FALSE(absl::ParseDuration("-1h -2s", &d));
+
+  // Input that is not NUL-terminated.
+  const char kBuf[] = "1h30m5s";
+  EXPECT_TRUE(absl::ParseDuration(absl::string_view(kBuf, 5), &d));
+  EXPECT_EQ(absl::Hours(1) + absl::Minutes(30), d);
+  EXPECT_TRUE(absl::ParseDuration(absl::string_view(kBuf + 2, 3), &d));
+  EXPECT_EQ(absl::Minutes(30), d);
+  EXPECT_FALSE(absl::ParseDuration(absl::string_view(kBuf, 1), &d));
+  EXPECT_FALSE(absl::ParseDuration(absl::string_view(kBuf, 0), &d));
+  EXPECT_TRUE(absl::ParseDuration(absl::string_view("0s", 1), &d));
+  EXPECT_EQ(absl::ZeroDuration(), d);
+  EXPECT_FALSE(absl::ParseDuration(absl::string_view("infinity", 4), &d));
+  EXPECT_TRUE(absl::ParseDuration(absl::string_view("-infinity", 4), &d));
+  EXPECT_EQ(-absl::InfiniteDuration(), d);
 }
 
 TEST(Duration, FormatParseRoundTrip) {
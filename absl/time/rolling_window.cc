@@ -0,0 +1,219 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/time/rolling_window.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace absl {
+namespace time_internal {
+
+namespace {
+
+// Returns the floor modulus of `a` by `b > 0`.
+inline int64_t FloorMod(int64_t a, int64_t b) {
+  const int64_t r = a % b;
+  return r < 0 ? r + b : r;
+}
+
+}  // namespace
+
+RollingCells::RollingCells(int64_t ticks_per_bucket, int num_buckets,
+                           int cells_per_bucket)
+    : ticks_per_bucket_(ticks_per_bucket),
+      num_buckets_(num_buckets),
+      cells_per_bucket_(cells_per_bucket),
+      buckets_(new std::atomic<int64_t>[num_buckets]),
+      cells_(new std::atomic<int64_t>[static_cast<size_t>(num_buckets) *
+                                      cells_per_bucket]) {
+  assert(ticks_per_bucket > 0);
+  assert(num_buckets > 0);
+  assert(cells_per_bucket > 0);
+  // Every slot starts out holding an empty bucket older than any other.
+  for (int i = 0; i < num_buckets; ++i) {
+    buckets_[i].store(std::numeric_limits<int64_t>::min(),
+                      std::memory_order_relaxed);
+  }
+  const size_t n = static_cast<size_t>(num_buckets) * cells_per_bucket;
+  for (size_t i = 0; i < n; ++i) {
+    cells_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+int64_t RollingCells::BucketOf(int64_t tick) const {
+  const int64_t q = tick / ticks_per_bucket_;
+  return (tick % ticks_per_bucket_ < 0) ? q - 1 : q;
+}
+
+size_t RollingCells::SlotOf(int64_t bucket) const {
+  return static_cast<size_t>(FloorMod(bucket, num_buckets_));
+}
+
+void RollingCells::Add(int64_t bucket, int cell, int64_t n) {
+  assert(n >= 0);
+  assert(cell >= 0 && cell < cells_per_bucket_);
+  const size_t slot = SlotOf(bucket);
+  std::atomic<int64_t>& held = buckets_[slot];
+  int64_t b = held.load(std::memory_order_acquire);
+  while (b < bucket) {
+    // The slot holds an older bucket, which has left every window ending at
+    // or after `bucket`. Clear it before claiming the slot, so that readers
+    // never count the older bucket's events as `bucket`'s.
+    for (int i = 0; i < cells_per_bucket_; ++i) {
+      Cell(slot, i).store(0, std::memory_order_relaxed);
+    }
+    if (held.compare_exchange_weak(b, bucket, std::memory_order_acq_rel,
+                                   std::memory_order_acquire)) {
+      b = bucket;
+    }
+  }
+  // Otherwise the slot has been reused by a newer bucket, so `bucket` has
+  // fallen out of every window that can still be queried.
+  if (b != bucket) return;
+  Cell(slot, cell).fetch_add(n, std::memory_order_relaxed);
+}
+
+int64_t RollingCells::Sum(int64_t bucket, int cell) const {
+  assert(cell >= 0 && cell < cells_per_bucket_);
+  // Walk the ring backwards from `bucket`. Unsigned arithmetic keeps the walk
+  // well-defined for buckets near the minimum representable tick.
+  size_t slot = SlotOf(bucket);
+  uint64_t b = static_cast<uint64_t>(bucket);
+  int64_t sum = 0;
+  for (int k = 0; k < num_buckets_; ++k) {
+    if (static_cast<uint64_t>(buckets_[slot].load(
+            std::memory_order_acquire)) == b) {
+      sum += Cell(slot, cell).load(std::memory_order_relaxed);
+    }
+    --b;
+    slot = (slot == 0 ? num_buckets_ : slot) - 1;
+  }
+  return sum;
+}
+
+}  // namespace time_internal
+
+//
+// RollingWindowCounter
+//
+
+RollingWindowCounter::RollingWindowCounter(Duration bucket_width,
+                                           int num_buckets)
+    : RollingWindowCounter(ToInt64Nanoseconds(bucket_width), 1e9,
+                           num_buckets) {}
+
+RollingWindowCounter::RollingWindowCounter(int64_t ticks_per_bucket,
+                                           double ticks_per_second,
+                                           int num_buckets)
+    : cells_(ticks_per_bucket, num_buckets, 1),
+      ticks_per_second_(ticks_per_second) {
+  assert(ticks_per_second > 0);
+}
+
+void RollingWindowCounter::AddAt(int64_t tick, int64_t n) {
+  cells_.Add(cells_.BucketOf(tick), 0, n);
+}
+
+int64_t RollingWindowCounter::SumAt(int64_t tick) const {
+  return cells_.Sum(cells_.BucketOf(tick), 0);
+}
+
+double RollingWindowCounter::RateAt(int64_t tick) const {
+  const double window_ticks =
+      static_cast<double>(cells_.ticks_per_bucket()) * cells_.num_buckets();
+  return SumAt(tick) * ticks_per_second_ / window_ticks;
+}
+
+Duration RollingWindowCounter::window() const {
+  const double window_ticks =
+      static_cast<double>(cells_.ticks_per_bucket()) * cells_.num_buckets();
+  return Seconds(window_ticks / ticks_per_second_);
+}
+
+//
+// RollingWindowHistogram
+//
+
+RollingWindowHistogram::RollingWindowHistogram(Duration bucket_width,
+                                               int num_buckets,
+                                               std::vector<int64_t> bounds)
+    : RollingWindowHistogram(ToInt64Nanoseconds(bucket_width), num_buckets,
+                             std::move(bounds)) {}
+
+RollingWindowHistogram::RollingWindowHistogram(int64_t ticks_per_bucket,
+                                               int num_buckets,
+                                               std::vector<int64_t> bounds)
+    : bounds_(std::move(bounds)),
+      cells_(ticks_per_bucket, num_buckets,
+             static_cast<int>(bounds_.size()) + 1) {
+  assert(!bounds_.empty());
+  assert(std::adjacent_find(bounds_.begin(), bounds_.end(),
+                            [](int64_t a, int64_t b) { return a >= b; }) ==
+         bounds_.end());
+}
+
+void RollingWindowHistogram::RecordAt(int64_t tick, int64_t value) {
+  const int bin = static_cast<int>(
+      std::lower_bound(bounds_.begin(), bounds_.end(), value) -
+      bounds_.begin());
+  cells_.Add(cells_.BucketOf(tick), bin, 1);
+}
+
+int64_t RollingWindowHistogram::CountAt(int64_t tick) const {
+  const int64_t bucket = cells_.BucketOf(tick);
+  int64_t count = 0;
+  for (size_t bin = 0; bin <= bounds_.size(); ++bin) {
+    count += cells_.Sum(bucket, static_cast<int>(bin));
+  }
+  return count;
+}
+
+void RollingWindowHistogram::BinCountsAt(int64_t tick,
+                                         absl::Span<int64_t> counts) const {
+  assert(counts.size() == bounds_.size() + 1);
+  const int64_t bucket = cells_.BucketOf(tick);
+  for (size_t bin = 0; bin < counts.size(); ++bin) {
+    counts[bin] = cells_.Sum(bucket, static_cast<int>(bin));
+  }
+}
+
+int64_t RollingWindowHistogram::PercentileAt(int64_t tick, double p) const {
+  std::vector<int64_t> counts(bounds_.size() + 1);
+  BinCountsAt(tick, absl::MakeSpan(counts));
+  int64_t total = 0;
+  for (int64_t c : counts) total += c;
+  if (total == 0) return 0;
+
+  const double rank = std::min(std::max(p, 0.0), 100.0) / 100.0 * total;
+  double before = 0;
+  for (size_t bin = 0; bin < counts.size(); ++bin) {
+    if (counts[bin] == 0) continue;
+    if (before + counts[bin] >= rank) {
+      if (bin == 0) return bounds_.front();
+      if (bin == bounds_.size()) return bounds_.back();
+      const double lo = static_cast<double>(bounds_[bin - 1]);
+      const double hi = static_cast<double>(bounds_[bin]);
+      const double fraction = (rank - before) / counts[bin];
+      return static_cast<int64_t>(std::round(lo + fraction * (hi - lo)));
+    }
+    before += counts[bin];
+  }
+  return bounds_.back();
+}
+
+}  // namespace absl
@@ -0,0 +1,236 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// -----------------------------------------------------------------------------
+// File: rolling_window.h
+// -----------------------------------------------------------------------------
+//
+// This header file defines lock-free counters and histograms that aggregate
+// events over a sliding window of time, such as the number of requests
+// received in the last minute or the 99th percentile latency over the last ten
+// seconds.
+//
+// A window is divided into a fixed ring of equally-sized buckets. An event at
+// time `t` is recorded into bucket `Floor(t - UnixEpoch(), bucket_width)`;
+// buckets that have fallen out of the window are not cleared eagerly but are
+// recognized as stale and reset by the first write that reuses them. No
+// operation takes a lock, and recording never allocates memory, so these
+// classes are suitable for use on request paths (e.g. adaptive load shedding).
+//
+// Example:
+//
+//   absl::RollingWindowCounter qps(absl::Seconds(1), 10);
+//   ...
+//   qps.Add(absl::Now());
+//   ...
+//   if (qps.Rate(absl::Now()) > kMaxQps) return Overloaded();
+//
+// Both classes may also be keyed by a raw tick count (such as the value of
+// `absl::base_internal::CycleClock::Now()`) instead of an `absl::Time`, for
+// callers that cannot afford a call to `absl::Now()`:
+//
+//   absl::RollingWindowCounter qps(
+//       static_cast<int64_t>(CycleClock::Frequency()),  // ticks per bucket
+//       CycleClock::Frequency(),                         // ticks per second
+//       10);
+//   qps.AddAt(CycleClock::Now());
+//
+// Counts are approximate at the edges of the window: the current bucket is
+// only partially elapsed, and writes that race with the reuse of a bucket by a
+// newer time may be dropped or counted in the newer bucket.
+#ifndef ABSL_TIME_ROLLING_WINDOW_H_
+#define ABSL_TIME_ROLLING_WINDOW_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace absl {
+namespace time_internal {
+
+// A ring of `num_buckets` slots of `cells_per_bucket` 64-bit counts. Each slot
+// records the full index of the bucket it holds. The first write to a newer
+// bucket clears the slot's counts and then claims the slot for the bucket;
+// after that, writes are a single atomic add.
+class RollingCells {
+ public:
+  RollingCells(int64_t ticks_per_bucket, int num_buckets, int cells_per_bucket);
+
+  RollingCells(const RollingCells&) = delete;
+  RollingCells& operator=(const RollingCells&) = delete;
+
+  // Returns the bucket index holding `tick`, i.e. floor(tick / width).
+  int64_t BucketOf(int64_t tick) const;
+
+  // Adds `n` to cell `cell` of the bucket with index `bucket`.
+  void Add(int64_t bucket, int cell, int64_t n);
+
+  // Adds the counts of cell `cell` in the `num_buckets()` buckets ending at
+  // index `bucket` (inclusive).
+  int64_t Sum(int64_t bucket, int cell) const;
+
+  int num_buckets() const { return num_buckets_; }
+  int64_t ticks_per_bucket() const { return ticks_per_bucket_; }
+
+ private:
+  // Returns the slot of the ring that holds bucket `bucket`.
+  size_t SlotOf(int64_t bucket) const;
+
+  std::atomic<int64_t>& Cell(size_t slot, int cell) const {
+    return cells_[slot * cells_per_bucket_ + cell];
+  }
+
+  const int64_t ticks_per_bucket_;
+  const int num_buckets_;
+  const int cells_per_bucket_;
+  // buckets_[slot] is the index of the bucket whose counts the slot holds.
+  std::unique_ptr<std::atomic<int64_t>[]> buckets_;
+  std::unique_ptr<std::atomic<int64_t>[]> cells_;
+};
+
+}  // namespace time_internal
+
+// RollingWindowCounter
+//
+// Counts events over the last `num_buckets * bucket_width` of time. All member
+// functions are thread-safe and lock-free.
+class RollingWindowCounter {
+ public:
+  // Creates a counter keyed by `absl::Time`. `bucket_width` must be at least
+  // one nanosecond and `num_buckets` must be positive.
+  RollingWindowCounter(Duration bucket_width, int num_buckets);
+
+  // Creates a counter keyed by raw ticks, which advance by `ticks_per_second`
+  // every second. `ticks_per_bucket` must be positive.
+  RollingWindowCounter(int64_t ticks_per_bucket, double ticks_per_second,
+                       int num_buckets);
+
+  RollingWindowCounter(const RollingWindowCounter&) = delete;
+  RollingWindowCounter& operator=(const RollingWindowCounter&) = delete;
+
+  // RollingWindowCounter::Add()
+  //
+  // Records `n` events at time `now`. `n` must be non-negative.
+  void Add(Time now, int64_t n = 1) { AddAt(ToTick(now), n); }
+  void AddAt(int64_t tick, int64_t n = 1);
+
+  // RollingWindowCounter::Sum()
+  //
+  // Returns the number of events recorded in the window ending at `now`.
+  int64_t Sum(Time now) const { return SumAt(ToTick(now)); }
+  int64_t SumAt(int64_t tick) const;
+
+  // RollingWindowCounter::Rate()
+  //
+  // Returns the average number of events per second over the window ending at
+  // `now`.
+  double Rate(Time now) const { return RateAt(ToTick(now)); }
+  double RateAt(int64_t tick) const;
+
+  // RollingWindowCounter::window()
+  //
+  // Returns the span of time covered by the window.
+  Duration window() const;
+
+ private:
+  static int64_t ToTick(Time t) { return ToUnixNanos(t); }
+
+  time_internal::RollingCells cells_;
+  const double ticks_per_second_;
+};
+
+// RollingWindowHistogram
+//
+// Tracks the distribution of values recorded over the last
+// `num_buckets * bucket_width` of time. Values are counted into bins delimited
+// by a sorted list of upper bounds: bin `i` holds the values `v` with
+// `bounds[i - 1] < v <= bounds[i]`, and a final overflow bin holds the values
+// greater than `bounds.back()`. All member functions are thread-safe and
+// lock-free.
+//
+// Example:
+//
+//   // Latencies in microseconds, aggregated over the last 10 seconds.
+//   absl::RollingWindowHistogram latency(
+//       absl::Seconds(1), 10, {100, 200, 500, 1000, 2000, 5000, 10000});
+//   ...
+//   latency.Record(absl::Now(), absl::ToInt64Microseconds(elapsed));
+//   ...
+//   int64_t p99 = latency.Percentile(absl::Now(), 99.0);
+class RollingWindowHistogram {
+ public:
+  // Creates a histogram keyed by `absl::Time`. `bucket_width` must be at least
+  // one nanosecond, `num_buckets` must be positive and `bounds` must be
+  // non-empty and strictly increasing.
+  RollingWindowHistogram(Duration bucket_width, int num_buckets,
+                         std::vector<int64_t> bounds);
+
+  // Creates a histogram keyed by raw ticks. `ticks_per_bucket` must be
+  // positive.
+  RollingWindowHistogram(int64_t ticks_per_bucket, int num_buckets,
+                         std::vector<int64_t> bounds);
+
+  RollingWindowHistogram(const RollingWindowHistogram&) = delete;
+  RollingWindowHistogram& operator=(const RollingWindowHistogram&) = delete;
+
+  // RollingWindowHistogram::Record()
+  //
+  // Records one occurrence of `value` at time `now`.
+  void Record(Time now, int64_t value) { RecordAt(ToTick(now), value); }
+  void RecordAt(int64_t tick, int64_t value);
+
+  // RollingWindowHistogram::Count()
+  //
+  // Returns the number of values recorded in the window ending at `now`.
+  int64_t Count(Time now) const { return CountAt(ToTick(now)); }
+  int64_t CountAt(int64_t tick) const;
+
+  // RollingWindowHistogram::Percentile()
+  //
+  // Returns an estimate of the `p`th percentile (0 <= p <= 100) of the values
+  // recorded in the window ending at `now`, interpolating linearly within the
+  // bin that contains it. Values in the first bin are reported as `bounds[0]`
+  // and values in the overflow bin as `bounds.back()`. Returns 0 if the
+  // window is empty.
+  int64_t Percentile(Time now, double p) const {
+    return PercentileAt(ToTick(now), p);
+  }
+  int64_t PercentileAt(int64_t tick, double p) const;
+
+  // RollingWindowHistogram::BinCounts()
+  //
+  // Writes the per-bin counts of the window ending at `now` into `counts`,
+  // which must hold `bounds().size() + 1` elements.
+  void BinCounts(Time now, absl::Span<int64_t> counts) const {
+    BinCountsAt(ToTick(now), counts);
+  }
+  void BinCountsAt(int64_t tick, absl::Span<int64_t> counts) const;
+
+  const std::vector<int64_t>& bounds() const { return bounds_; }
+
+ private:
+  static int64_t ToTick(Time t) { return ToUnixNanos(t); }
+
+  const std::vector<int64_t> bounds_;
+  time_internal::RollingCells cells_;
+};
+
+}  // namespace absl
+
+#endif  // ABSL_TIME_ROLLING_WINDOW_H_
@@ -0,0 +1,145 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/time/rolling_window.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace {
+
+const absl::Time kStart = absl::FromUnixSeconds(1500000000);
+
+TEST(RollingWindowCounter, SumAndExpiry) {
+  absl::RollingWindowCounter counter(absl::Seconds(1), 10);
+  EXPECT_EQ(absl::Seconds(10), counter.window());
+  EXPECT_EQ(0, counter.Sum(kStart));
+
+  counter.Add(kStart);
+  counter.Add(kStart + absl::Milliseconds(999), 2);
+  counter.Add(kStart + absl::Seconds(1), 4);
+  EXPECT_EQ(7, counter.Sum(kStart + absl::Seconds(1)));
+  EXPECT_EQ(7, counter.Sum(kStart + absl::Seconds(9)));
+  EXPECT_DOUBLE_EQ(0.7, counter.Rate(kStart + absl::Seconds(9)));
+
+  // The first bucket falls out of the window, then the second.
+  EXPECT_EQ(4, counter.Sum(kStart + absl::Seconds(10)));
+  EXPECT_EQ(0, counter.Sum(kStart + absl::Seconds(11)));
+
+  // Reusing a ring slot discards its old contents.
+  counter.Add(kStart + absl::Seconds(10), 8);
+  EXPECT_EQ(12, counter.Sum(kStart + absl::Seconds(10)));
+  EXPECT_EQ(8, counter.Sum(kStart + absl::Seconds(11)));
+
+  // A query far in the future sees an empty window even though the ring still
+  // holds old counts.
+  EXPECT_EQ(0, counter.Sum(kStart + absl::Hours(24 * 365)));
+}
+
+TEST(RollingWindowCounter, StaleWritesAreDropped) {
+  absl::RollingWindowCounter counter(absl::Seconds(1), 4);
+  counter.Add(kStart + absl::Seconds(4), 1);
+  // Same ring slot as above, but four buckets older.
+  counter.Add(kStart, 100);
+  EXPECT_EQ(1, counter.Sum(kStart + absl::Seconds(4)));
+  EXPECT_EQ(0, counter.Sum(kStart + absl::Seconds(3)));
+}
+
+TEST(RollingWindowCounter, BeforeUnixEpoch) {
+  absl::RollingWindowCounter counter(absl::Seconds(1), 2);
+  const absl::Time t = absl::UnixEpoch() - absl::Milliseconds(1);
+  counter.Add(t);
+  counter.Add(absl::UnixEpoch());
+  EXPECT_EQ(1, counter.Sum(t));
+  EXPECT_EQ(2, counter.Sum(absl::UnixEpoch()));
+  EXPECT_EQ(1, counter.Sum(absl::UnixEpoch() + absl::Seconds(1)));
+}
+
+TEST(RollingWindowCounter, Ticks) {
+  // 1000 ticks per second, 100 ticks per bucket.
+  absl::RollingWindowCounter counter(100, 1000.0, 5);
+  EXPECT_EQ(absl::Milliseconds(500), counter.window());
+  for (int64_t tick = 0; tick < 500; tick += 10) counter.AddAt(tick);
+  EXPECT_EQ(50, counter.SumAt(499));
+  EXPECT_DOUBLE_EQ(100.0, counter.RateAt(499));
+  EXPECT_EQ(40, counter.SumAt(500));
+}
+
+TEST(RollingWindowCounter, LongIdleGaps) {
+  // One tick per bucket. Slots left idle for any number of buckets, including
+  // multiples of 2^24, are neither mistaken for newer buckets nor counted
+  // again.
+  absl::RollingWindowCounter counter(1, 1.0, 4);
+  int64_t last = 0;
+  counter.AddAt(last, 5);
+  for (int64_t gap : {int64_t{1} << 23, (int64_t{1} << 23) + 4,
+                      int64_t{1} << 24, int64_t{1} << 40}) {
+    const int64_t t = last + gap;
+    EXPECT_EQ(0, counter.SumAt(t)) << gap;
+    counter.AddAt(t, 1);
+    EXPECT_EQ(1, counter.SumAt(t)) << gap;
+    counter.AddAt(t + 1, 2);
+    EXPECT_EQ(3, counter.SumAt(t + 1)) << gap;
+    last = t + 1;
+  }
+}
+
+TEST(RollingWindowCounter, ConcurrentAdds) {
+  absl::RollingWindowCounter counter(absl::Milliseconds(1), 64);
+  constexpr int kThreads = 4;
+  constexpr int kAddsPerThread = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&counter] {
+      for (int j = 0; j < kAddsPerThread; ++j) {
+        counter.Add(kStart + absl::Microseconds(j));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(kThreads * kAddsPerThread,
+            counter.Sum(kStart + absl::Milliseconds(9)));
+}
+
+TEST(RollingWindowHistogram, Percentiles) {
+  absl::RollingWindowHistogram histogram(absl::Seconds(1), 10,
+                                         {10, 20, 30, 40});
+  EXPECT_EQ(0, histogram.Percentile(kStart, 50));
+
+  for (int v = 11; v <= 20; ++v) histogram.Record(kStart, v);
+  EXPECT_EQ(10, histogram.Count(kStart));
+  EXPECT_EQ(15, histogram.Percentile(kStart, 50));
+  EXPECT_EQ(20, histogram.Percentile(kStart, 100));
+
+  histogram.Record(kStart, 5);
+  histogram.Record(kStart, 100);
+  std::vector<int64_t> counts(5);
+  histogram.BinCounts(kStart, absl::MakeSpan(counts));
+  EXPECT_EQ((std::vector<int64_t>{1, 10, 0, 0, 1}), counts);
+  EXPECT_EQ(10, histogram.Percentile(kStart, 0));
+  EXPECT_EQ(40, histogram.Percentile(kStart, 100));
+
+  // Values recorded in later buckets are combined until the earlier ones
+  // expire.
+  for (int i = 0; i < 12; ++i) histogram.Record(kStart + absl::Seconds(5), 35);
+  EXPECT_EQ(24, histogram.Count(kStart + absl::Seconds(9)));
+  EXPECT_EQ(36, histogram.Percentile(kStart + absl::Seconds(9), 75));
+  EXPECT_EQ(12, histogram.Count(kStart + absl::Seconds(10)));
+  EXPECT_EQ(40, histogram.Percentile(kStart + absl::Seconds(10), 100));
+}
+
+}  // namespace
@@ -32,10 +32,12 @@
 
 #include "absl/time/time.h"
 
+#include <cassert>
 #include <cstring>
 #include <ctime>
 #include <limits>
 
+#include "absl/base/optimization.h"
 #include "cctz/civil_time.h"
 #include "cctz/time_zone.h"
 namespace absl {
@@ -367,6 +369,81 @@ int64_t ToUniversal(absl::Time t) {
   return absl::FloorToUnit(t - absl::UniversalEpoch(), absl::Nanoseconds(100));
 }
 
+//
+// Batch conversions.
+//
+
+namespace {
+
+// Converts each Time in 'in' to an integral count of units since the epoch,
+// flooring toward negative infinity.  See BatchToInt64() in duration.cc: the
+// first loop is branch-free for rep_hi values in [-2^kHiBits, 2^kHiBits), and
+// anything else (including the infinities) is redone by the scalar 'slow'.
+template <int64_t kUnitsPerSecond, int kHiBits>
+void BatchToUnix(absl::Span<const Time> in, absl::Span<int64_t> out,
+                 int64_t (*slow)(Time)) {
+  assert(out.size() >= in.size());
+  constexpr int64_t kTicksPerUnit =
+      time_internal::kTicksPerSecond / kUnitsPerSecond;
+  constexpr uint64_t kBias = uint64_t{1} << kHiBits;
+  const Time* const ip = in.data();
+  int64_t* const op = out.data();
+  const size_t n = in.size();
+  uint64_t out_of_range = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const absl::Duration d = time_internal::ToUnixDuration(ip[i]);
+    const uint64_t hi = static_cast<uint64_t>(time_internal::GetRepHi(d));
+    const uint32_t lo = time_internal::GetRepLo(d);
+    out_of_range |= (hi + kBias) >> (kHiBits + 1);
+    op[i] = static_cast<int64_t>(hi * kUnitsPerSecond + lo / kTicksPerUnit);
+  }
+  if (ABSL_PREDICT_FALSE(out_of_range != 0)) {
+    for (size_t i = 0; i < n; ++i) {
+      const uint64_t hi = static_cast<uint64_t>(
+          time_internal::GetRepHi(time_internal::ToUnixDuration(ip[i])));
+      if ((hi + kBias) >> (kHiBits + 1)) op[i] = slow(ip[i]);
+    }
+  }
+}
+
+template <Time (*kFactory)(int64_t)>
+void BatchFromUnix(absl::Span<const int64_t> in, absl::Span<Time> out) {
+  assert(out.size() >= in.size());
+  const int64_t* const ip = in.data();
+  Time* const op = out.data();
+  const size_t n = in.size();
+  for (size_t i = 0; i < n; ++i) op[i] = kFactory(ip[i]);
+}
+
+}  // namespace
+
+void FromUnixNanos(absl::Span<const int64_t> in, absl::Span<Time> out) {
+  BatchFromUnix<FromUnixNanos>(in, out);
+}
+void FromUnixMicros(absl::Span<const int64_t> in, absl::Span<Time> out) {
+  BatchFromUnix<FromUnixMicros>(in, out);
+}
+void FromUnixMillis(absl::Span<const int64_t> in, absl::Span<Time> out) {
+  BatchFromUnix<FromUnixMillis>(in, out);
+}
+void FromUnixSeconds(absl::Span<const int64_t> in, absl::Span<Time> out) {
+  BatchFromUnix<FromUnixSeconds>(in, out);
+}
+
+void ToUnixNanos(absl::Span<const Time> in, absl::Span<int64_t> out) {
+  BatchToUnix<1000 * 1000 * 1000, 33>(in, out, ToUnixNanos);
+}
+void ToUnixMicros(absl::Span<const Time> in, absl::Span<int64_t> out) {
+  BatchToUnix<1000 * 1000, 43>(in, out, ToUnixMicros);
+}
+void ToUnixMillis(absl::Span<const Time> in, absl::Span<int64_t> out) {
+  BatchToUnix<1000, 53>(in, out, ToUnixMillis);
+}
+void ToUnixSeconds(absl::Span<const Time> in, absl::Span<int64_t> out) {
+  assert(out.size() >= in.size());
+  for (size_t i = 0; i < in.size(); ++i) out[i] = ToUnixSeconds(in[i]);
+}
+
 Time FromChrono(const std::chrono::system_clock::time_point& tp) {
   return time_internal::FromUnixDuration(time_internal::FromChrono(
       tp - std::chrono::system_clock::from_time_t(0)));
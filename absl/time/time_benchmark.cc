@@ -0,0 +1,178 @@
+// Copyright 2018 The Abseil Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/time/time.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "absl/time/clock.h"
+#include "absl/time/internal/test_util.h"
+#include "benchmark/benchmark.h"
+
+namespace {
+
+//
+// Time zones
+//
+
+// Loading an already-loaded zone, which only consults the zone cache.
+void BM_Time_LoadTimeZone(benchmark::State& state) {
+  absl::TimeZone tz;
+  if (!absl::LoadTimeZone("America/Los_Angeles", &tz)) {
+    state.SkipWithError("America/Los_Angeles is not installed");
+    return;
+  }
+  const std::string name = "America/Los_Angeles";
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::LoadTimeZone(name, &tz));
+  }
+}
+BENCHMARK(BM_Time_LoadTimeZone);
+
+void BM_Time_LoadTimeZone_UTC(benchmark::State& state) {
+  absl::TimeZone tz;
+  const std::string name = "UTC";
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::LoadTimeZone(name, &tz));
+  }
+}
+BENCHMARK(BM_Time_LoadTimeZone_UTC);
+
+void BM_Time_LoadTimeZone_Fixed(benchmark::State& state) {
+  absl::TimeZone tz;
+  const std::string name = "Fixed/UTC-08:00:00";
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::LoadTimeZone(name, &tz));
+  }
+}
+BENCHMARK(BM_Time_LoadTimeZone_Fixed);
+
+//
+// Breakdown and civil-time conversion
+//
+
+void BM_Time_In_UTC(benchmark::State& state) {
+  const absl::TimeZone tz = absl::UTCTimeZone();
+  absl::Time t = absl::FromUnixSeconds(1500000000);
+  while (state.KeepRunning()) {
+    t += absl::Seconds(1);
+    benchmark::DoNotOptimize(t.In(tz));
+  }
+}
+BENCHMARK(BM_Time_In_UTC);
+
+void BM_Time_In_LosAngeles(benchmark::State& state) {
+  const absl::TimeZone tz =
+      absl::time_internal::LoadTimeZone("America/Los_Angeles");
+  absl::Time t = absl::FromUnixSeconds(1500000000);
+  while (state.KeepRunning()) {
+    t += absl::Seconds(1);
+    benchmark::DoNotOptimize(t.In(tz));
+  }
+}
+BENCHMARK(BM_Time_In_LosAngeles);
+
+void BM_Time_FromDateTime_UTC(benchmark::State& state) {
+  const absl::TimeZone tz = absl::UTCTimeZone();
+  int i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::FromDateTime(2014, 12, 18, 20, 16, i++ % 60, tz));
+  }
+}
+BENCHMARK(BM_Time_FromDateTime_UTC);
+
+void BM_Time_FromDateTime_LosAngeles(benchmark::State& state) {
+  const absl::TimeZone tz =
+      absl::time_internal::LoadTimeZone("America/Los_Angeles");
+  int i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        absl::FromDateTime(2014, 12, 18, 20, 16, i++ % 60, tz));
+  }
+}
+BENCHMARK(BM_Time_FromDateTime_LosAngeles);
+
+void BM_Time_ToTM(benchmark::State& state) {
+  const absl::TimeZone tz =
+      absl::time_internal::LoadTimeZone("America/Los_Angeles");
+  absl::Time t = absl::FromUnixSeconds(1500000000);
+  while (state.KeepRunning()) {
+    t += absl::Seconds(1);
+    benchmark::DoNotOptimize(absl::ToTM(t, tz));
+  }
+}
+BENCHMARK(BM_Time_ToTM);
+
+//
+// Unix conversions
+//
+
+void BM_Time_ToUnixNanos(benchmark::State& state) {
+  const absl::Time t = absl::UnixEpoch() + absl::Seconds(123);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(t);
+    benchmark::DoNotOptimize(absl::ToUnixNanos(t));
+  }
+}
+BENCHMARK(BM_Time_ToUnixNanos);
+
+void BM_Time_ToUnixSeconds(benchmark::State& state) {
+  const absl::Time t = absl::UnixEpoch() + absl::Seconds(123);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(t);
+    benchmark::DoNotOptimize(absl::ToUnixSeconds(t));
+  }
+}
+BENCHMARK(BM_Time_ToUnixSeconds);
+
+void BM_Time_FromUnixNanos(benchmark::State& state) {
+  int64_t ns = 1500000000123456789;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ns);
+    benchmark::DoNotOptimize(absl::FromUnixNanos(ns));
+  }
+}
+BENCHMARK(BM_Time_FromUnixNanos);
+
+void BM_Time_ToTimespec(benchmark::State& state) {
+  absl::Time now = absl::Now();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToTimespec(now));
+    benchmark::DoNotOptimize(now);
+  }
+}
+BENCHMARK(BM_Time_ToTimespec);
+
+void BM_Time_FromTimespec(benchmark::State& state) {
+  timespec ts = absl::ToTimespec(absl::Now());
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::TimeFromTimespec(ts));
+    benchmark::DoNotOptimize(ts);
+  }
+}
+BENCHMARK(BM_Time_FromTimespec);
+
+void BM_Time_ToChronoTime(benchmark::State& state) {
+  absl::Time now = absl::Now();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(absl::ToChronoTime(now));
+    benchmark::DoNotOptimize(now);
+  }
+}
+BENCHMARK(BM_Time_ToChronoTime);
+
+}  // namespace
@@ -20,6 +20,7 @@
 #include <iomanip>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -347,6 +348,49 @@ TEST(Time, FloorConversion) {
                 std::numeric_limits<int64_t>::max()) - absl::Nanoseconds(1) / 2));
 }
 
+TEST(Time, BatchConversion) {
+  const absl::Duration qns = absl::Nanoseconds(1) / 4;
+  const int64_t kint64max = std::numeric_limits<int64_t>::max();
+  const int64_t kint64min = std::numeric_limits<int64_t>::min();
+  std::vector<absl::Time> times = {
+      absl::UnixEpoch(), absl::UnixEpoch() + qns, absl::UnixEpoch() - qns,
+      absl::UnixEpoch() - absl::Microseconds(1001), absl::Now(),
+      absl::InfiniteFuture(), absl::InfinitePast(),
+      absl::FromUnixSeconds(kint64max), absl::FromUnixSeconds(kint64min),
+      absl::FromUnixSeconds(kint64min) + qns};
+  // Times around the edges of each fast path.
+  for (int bits : {33, 43, 53}) {
+    for (int64_t sec : {int64_t{1} << bits, -(int64_t{1} << bits)}) {
+      for (int64_t delta : {-1, 0, 1}) {
+        times.push_back(absl::FromUnixSeconds(sec + delta) - qns);
+        times.push_back(absl::FromUnixSeconds(sec + delta));
+        times.push_back(absl::FromUnixSeconds(sec + delta) + qns);
+      }
+    }
+  }
+
+  std::vector<int64_t> out(times.size());
+#define TEST_BATCH_CONVERSION(UNIT)                          \
+  do {                                                       \
+    absl::ToUnix##UNIT(times, absl::MakeSpan(out));          \
+    for (size_t i = 0; i < times.size(); ++i) {              \
+      EXPECT_EQ(absl::ToUnix##UNIT(times[i]), out[i]) << i;  \
+    }                                                        \
+    std::vector<absl::Time> back(out.size());                \
+    absl::FromUnix##UNIT(out, absl::MakeSpan(back));         \
+    for (size_t i = 0; i < out.size(); ++i) {                \
+      EXPECT_EQ(absl::FromUnix##UNIT(out[i]), back[i]) << i; \
+    }                                                        \
+  } while (0)
+
+  TEST_BATCH_CONVERSION(Nanos);
+  TEST_BATCH_CONVERSION(Micros);
+  TEST_BATCH_CONVERSION(Millis);
+  TEST_BATCH_CONVERSION(Seconds);
+
+#undef TEST_BATCH_CONVERSION
+}
+
 TEST(Time, RoundtripConversion) {
 #define TEST_CONVERSION_ROUND_TRIP(SOURCE, FROM, TO, MATCHER) \
   EXPECT_THAT(TO(FROM(SOURCE)), MATCHER(SOURCE))